@@ -0,0 +1,64 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+#include "loki/worker.h"
+#include "odin/directionsbuilder.h"
+#include "thor/worker.h"
+
+#include "test.h"
+
+using namespace valhalla;
+
+namespace {
+
+// Routes across Utrecht of increasing length
+const std::vector<std::string> kLocations = {
+    R"([{"lat":52.09620,"lon":5.11385},{"lat":52.09110,"lon":5.11860}])",
+    R"([{"lat":52.09620,"lon":5.11385},{"lat":52.07893,"lon":5.11532}])",
+    R"([{"lat":52.12160,"lon":5.10700},{"lat":52.06580,"lon":5.07760}])",
+    R"([{"lat":52.12160,"lon":5.14930},{"lat":52.06580,"lon":5.07760}])",
+};
+
+// Build the directions of the route of the first argument with the directions type of the second
+void BM_DirectionsUtrecht(benchmark::State& state) {
+  const auto& locations = kLocations[state.range(0)];
+  const auto directions_type = static_cast<DirectionsType>(state.range(1));
+
+  const auto config =
+      test::make_config("test/data/utrecht_tiles", {},
+                        {{"additional_data", "mjolnir.traffic_extract", "mjolnir.tile_extract"}});
+  loki::loki_worker_t loki_worker(config);
+  thor::thor_worker_t thor_worker(config);
+
+  Api request;
+  ParseApi(R"({"locations":)" + locations + R"(,"costing":"auto"})", Options::route, request);
+  loki_worker.route(request);
+  thor_worker.route(request);
+  request.mutable_options()->set_directions_type(directions_type);
+
+  size_t nodes = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    Api api(request);
+    state.ResumeTiming();
+    odin::DirectionsBuilder::Build(api);
+    nodes += api.trip().routes(0).legs(0).node_size();
+  }
+  state.counters["nodes"] = benchmark::Counter(nodes, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_DirectionsUtrecht)
+    ->Unit(benchmark::kMicrosecond)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+      for (int route = 0; route < static_cast<int>(kLocations.size()); ++route) {
+        for (int type : {DirectionsType::none, DirectionsType::maneuvers,
+                         DirectionsType::instructions}) {
+          b->Args({route, type});
+        }
+      }
+    });
+
+} // namespace
+
+BENCHMARK_MAIN();
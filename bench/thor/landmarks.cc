@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "baldr/graphreader.h"
+#include "baldr/landmarks.h"
+#include "loki/search.h"
+#include "midgard/logging.h"
+#include "mjolnir/landmarkbuilder.h"
+#include "sif/costfactory.h"
+#include "test.h"
+#include "thor/bidirectional_astar.h"
+
+using namespace valhalla;
+
+namespace {
+
+const std::string kLandmarkFile = "test/data/utrecht_landmarks.bin";
+
+boost::property_tree::ptree landmark_config() {
+  return test::make_config("test/data/utrecht_tiles",
+                           {{"mjolnir.landmark_file", kLandmarkFile},
+                            {"mjolnir.landmark_count", "16"}},
+                           {{"additional_data", "mjolnir.traffic_extract", "mjolnir.tile_extract"}});
+}
+
+// Builds the landmarks of the extract the first time they are asked for
+std::shared_ptr<const baldr::Landmarks> get_landmarks(const boost::property_tree::ptree& config) {
+  static const auto landmarks = [&config]() {
+    mjolnir::LandmarkBuilder::Build(config);
+    return std::make_shared<const baldr::Landmarks>(baldr::Landmarks::Load(kLandmarkFile));
+  }();
+  return landmarks;
+}
+
+// Routes from one side of the Utrecht extract to the other
+const std::vector<std::pair<midgard::PointLL, midgard::PointLL>> kRoutes = {
+    {{5.025595, 52.067372}, {5.135983, 52.110116}},
+    {{5.110077, 52.062043}, {5.095273, 52.108956}},
+    {{5.112481, 52.074073}, {5.135983, 52.110116}},
+    {{5.135983, 52.110116}, {5.025595, 52.067372}},
+};
+
+// Counts the edges the searches settle on the routes above, the fewer the better the heuristic
+void BM_UtrechtLandmarks(benchmark::State& state, const Costing costing, const bool use_landmarks) {
+  const auto config = landmark_config();
+  const auto landmarks = use_landmarks ? get_landmarks(config) : nullptr;
+  auto reader = test::make_clean_graphreader(config.get_child("mjolnir"));
+
+  Options options;
+  options.set_costing(costing);
+  rapidjson::Document doc;
+  sif::ParseCostingOptions(doc, "/costing_options", options);
+  sif::TravelMode mode;
+  auto costs = sif::CostFactory().CreateModeCosting(options, mode);
+  auto cost = costs[static_cast<size_t>(mode)];
+
+  std::vector<std::pair<valhalla::Location, valhalla::Location>> routes;
+  for (const auto& route : kRoutes) {
+    std::vector<baldr::Location> locations{route.first, route.second};
+    const auto projections = loki::Search(locations, *reader, cost);
+    if (projections.size() != 2) {
+      throw std::runtime_error("Found no matching locations");
+    }
+    routes.emplace_back();
+    baldr::PathLocation::toPBF(projections.at(locations[0]), &routes.back().first, *reader);
+    baldr::PathLocation::toPBF(projections.at(locations[1]), &routes.back().second, *reader);
+  }
+
+  thor::BidirectionalAStar astar;
+  astar.set_landmarks(landmarks);
+  size_t settled = 0;
+  astar.set_track_expansion([&settled](baldr::GraphReader&, const char*, baldr::GraphId,
+                                       const char* status, bool) {
+    if (status[0] == 's') {
+      ++settled;
+    }
+  });
+  for (auto _ : state) {
+    for (auto& route : routes) {
+      auto result = astar.GetBestPath(route.first, route.second, *reader, costs, mode, options);
+      if (result.empty()) {
+        throw std::runtime_error("Failed a route");
+      }
+      astar.Clear();
+    }
+  }
+  state.counters["Settled"] = benchmark::Counter(settled, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK_CAPTURE(BM_UtrechtLandmarks, auto_great_circle, Costing::auto_, false)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_UtrechtLandmarks, auto_landmarks, Costing::auto_, true)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_UtrechtLandmarks, pedestrian_great_circle, Costing::pedestrian, false)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_UtrechtLandmarks, pedestrian_landmarks, Costing::pedestrian, true)
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+int main(int argc, char** argv) {
+  logging::Configure({{"type", ""}});
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
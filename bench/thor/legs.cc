@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+#include <string>
+
+#include "loki/worker.h"
+#include "thor/worker.h"
+
+#include "test.h"
+
+using namespace valhalla;
+
+namespace {
+
+// A tour around Utrecht with a break at every location so there is a leg between each of them
+constexpr char kLocations[] = R"("locations":[
+  {"lat":52.09620,"lon":5.11385},{"lat":52.07893,"lon":5.11532},{"lat":52.06580,"lon":5.07760},
+  {"lat":52.08550,"lon":5.05970},{"lat":52.11000,"lon":5.07480},{"lat":52.12160,"lon":5.10700},
+  {"lat":52.10700,"lon":5.14930},{"lat":52.08250,"lon":5.16410},{"lat":52.09620,"lon":5.11385}])";
+
+// Compute the legs of the route with as many threads as the first argument, the second argument
+// makes the route time dependent so the legs have to agree on the departure of the next one
+void BM_LegsUtrecht(benchmark::State& state) {
+  const auto concurrency = std::to_string(state.range(0));
+  const bool depart_at = state.range(1);
+
+  const auto config =
+      test::make_config("test/data/utrecht_tiles", {{"thor.leg_concurrency", concurrency}},
+                        {{"additional_data", "mjolnir.traffic_extract", "mjolnir.tile_extract"}});
+  loki::loki_worker_t loki_worker(config);
+  thor::thor_worker_t thor_worker(config);
+
+  const auto request_json = std::string("{") + kLocations + R"(,"costing":"auto")" +
+                            (depart_at ? R"(,"date_time":{"type":1,"value":"2021-08-02T08:00"}})"
+                                       : "}");
+  Api request;
+  ParseApi(request_json, Options::route, request);
+  loki_worker.route(request);
+
+  for (auto _ : state) {
+    Api api(request);
+    thor_worker.route(api);
+    thor_worker.cleanup();
+    benchmark::DoNotOptimize(api);
+  }
+}
+
+BENCHMARK(BM_LegsUtrecht)
+    ->Unit(benchmark::kMillisecond)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+      for (int concurrency : {1, 2, 4, 8}) {
+        b->Args({concurrency, 0});
+        b->Args({concurrency, 1});
+      }
+    })
+    ->Repetitions(5);
+
+} // namespace
+
+BENCHMARK_MAIN();
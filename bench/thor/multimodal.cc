@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+#include "baldr/transitdepartureindex.h"
+
+using namespace valhalla::baldr;
+
+namespace {
+
+// The test data has no transit so we make a timetable that looks like a busy city tile: a few
+// hundred lines with departures spread over the day, some frequency based, and a handful of
+// schedules. Every transit edge the multimodal expansion settles asks for the next departure of its
+// line at the current time so that is what we measure
+constexpr uint32_t kLines = 400;
+constexpr uint32_t kSchedules = 32;
+constexpr uint32_t kQueries = 4096;
+
+struct timetable_t {
+  std::vector<TransitSchedule> schedules;
+  std::vector<TransitDeparture> departures;
+  std::vector<std::pair<uint32_t, uint32_t>> queries; // line and time
+  std::vector<std::pair<uint32_t, uint32_t>> follows; // departure and time, to follow its trip
+};
+
+timetable_t make_timetable(uint32_t departures_per_line) {
+  std::mt19937 generator(3);
+  auto random = [&generator](uint32_t n) {
+    return std::uniform_int_distribution<uint32_t>(0, n - 1)(generator);
+  };
+
+  timetable_t timetable;
+  for (uint32_t i = 0; i < kSchedules; ++i) {
+    timetable.schedules.emplace_back((uint64_t(generator()) << 32) | generator(),
+                                     random(128) | kMonday, 30 + random(30));
+  }
+  for (uint32_t lineid = 0; lineid < kLines; ++lineid) {
+    for (uint32_t i = 0; i < departures_per_line; ++i) {
+      uint32_t departure_time = 18000 + random(72000);
+      if (random(10) == 0) {
+        timetable.departures.emplace_back(lineid, i, 1, 1, 0, departure_time,
+                                          departure_time + 3600, 300 + random(600), 120,
+                                          random(kSchedules), random(2), random(2));
+      } else {
+        timetable.departures.emplace_back(lineid, i, 1, 1, 0, departure_time, 120,
+                                          random(kSchedules), random(2), random(2));
+      }
+    }
+  }
+  std::sort(timetable.departures.begin(), timetable.departures.end());
+  for (uint32_t i = 0; i < kQueries; ++i) {
+    timetable.queries.emplace_back(random(kLines), 18000 + random(72000));
+  }
+  // a trip is followed from the edge before, so it is asked for a little before it leaves
+  for (uint32_t i = 0; i < kQueries; ++i) {
+    uint32_t departure = random(timetable.departures.size());
+    timetable.follows.emplace_back(departure,
+                                   timetable.departures[departure].departure_time() - random(300));
+  }
+  return timetable;
+}
+
+// How GraphTile::GetNextDeparture found departures before the index, frequency based departures
+// are not materialized since both ways do that the same
+const TransitDeparture* find_by_searching(const timetable_t& timetable,
+                                          const uint32_t lineid,
+                                          const uint32_t current_time,
+                                          const uint32_t day,
+                                          const uint32_t dow) {
+  const auto* departures = timetable.departures.data();
+  int32_t count = timetable.departures.size();
+  int32_t low = 0, high = count - 1, found = count;
+  while (low <= high) {
+    int32_t mid = (low + high) / 2;
+    const auto& dep = departures[mid];
+    if (lineid == dep.lineid() &&
+        ((current_time <= dep.departure_time() && dep.type() == kFixedSchedule) ||
+         (current_time <= dep.end_time() && dep.type() == kFrequencySchedule))) {
+      found = mid;
+      high = mid - 1;
+    } else if (lineid < dep.lineid()) {
+      high = mid - 1;
+    } else {
+      low = mid + 1;
+    }
+  }
+  for (; found < count && departures[found].lineid() == lineid; ++found) {
+    const auto& dep = departures[found];
+    if (!timetable.schedules[dep.schedule_index()].IsValid(day, dow, false)) {
+      continue;
+    }
+    if (dep.type() == kFixedSchedule) {
+      if (dep.departure_time() >= current_time) {
+        return &dep;
+      }
+      continue;
+    }
+    uint32_t departure_time = dep.departure_time();
+    while (departure_time < current_time && departure_time < dep.end_time()) {
+      departure_time += dep.frequency();
+    }
+    if (departure_time >= current_time && departure_time < dep.end_time()) {
+      return &dep;
+    }
+  }
+  return nullptr;
+}
+
+void BM_NextDepartureSearch(benchmark::State& state) {
+  const auto timetable = make_timetable(state.range(0));
+  size_t found = 0;
+  for (auto _ : state) {
+    for (const auto& query : timetable.queries) {
+      found += find_by_searching(timetable, query.first, query.second, 12, kMonday) != nullptr;
+    }
+  }
+  benchmark::DoNotOptimize(found);
+  state.SetItemsProcessed(state.iterations() * timetable.queries.size());
+}
+
+void BM_NextDepartureIndex(benchmark::State& state) {
+  const auto timetable = make_timetable(state.range(0));
+  TransitDepartureIndex index(timetable.departures.data(), timetable.departures.size(),
+                              timetable.schedules.data(), timetable.schedules.size());
+  size_t found = 0;
+  uint32_t departure_time;
+  for (auto _ : state) {
+    for (const auto& query : timetable.queries) {
+      found += index.Find(query.first, query.second, 12, kMonday, false, false, false,
+                          departure_time) != TransitDepartureIndex::kNotFound;
+    }
+  }
+  benchmark::DoNotOptimize(found);
+  state.SetItemsProcessed(state.iterations() * timetable.queries.size());
+}
+
+// How GraphTile::GetTransitDeparture followed a trip onto the next edge of its line before the
+// index, which both algorithms do on every transit edge after boarding and raptor does for every
+// stop of every trip it rides
+const TransitDeparture* follow_by_searching(const timetable_t& timetable,
+                                            const uint32_t lineid,
+                                            const uint32_t tripid,
+                                            const uint32_t current_time) {
+  const auto* departures = timetable.departures.data();
+  int32_t count = timetable.departures.size();
+  int32_t low = 0, high = count - 1, found = count;
+  while (low <= high) {
+    int32_t mid = (low + high) / 2;
+    const auto& dep = departures[mid];
+    if (lineid == dep.lineid() &&
+        ((current_time <= dep.departure_time() && dep.type() == kFixedSchedule) ||
+         (current_time <= dep.end_time() && dep.type() == kFrequencySchedule))) {
+      found = mid;
+      high = mid - 1;
+    } else if (lineid < dep.lineid()) {
+      high = mid - 1;
+    } else {
+      low = mid + 1;
+    }
+  }
+  for (; found < count && departures[found].lineid() == lineid; ++found) {
+    if (departures[found].tripid() == tripid) {
+      return &departures[found];
+    }
+  }
+  return nullptr;
+}
+
+void BM_FollowTripSearch(benchmark::State& state) {
+  const auto timetable = make_timetable(state.range(0));
+  size_t found = 0;
+  for (auto _ : state) {
+    for (const auto& follow : timetable.follows) {
+      const auto& departure = timetable.departures[follow.first];
+      found += follow_by_searching(timetable, departure.lineid(), departure.tripid(),
+                                   follow.second) != nullptr;
+    }
+  }
+  benchmark::DoNotOptimize(found);
+  state.SetItemsProcessed(state.iterations() * timetable.follows.size());
+}
+
+void BM_FollowTripIndex(benchmark::State& state) {
+  const auto timetable = make_timetable(state.range(0));
+  TransitDepartureIndex index(timetable.departures.data(), timetable.departures.size(),
+                              timetable.schedules.data(), timetable.schedules.size());
+  size_t found = 0;
+  uint32_t departure_time;
+  for (auto _ : state) {
+    for (const auto& follow : timetable.follows) {
+      const auto& departure = timetable.departures[follow.first];
+      found += index.FindTrip(departure.lineid(), departure.tripid(), follow.second,
+                              departure_time) != TransitDepartureIndex::kNotFound;
+    }
+  }
+  benchmark::DoNotOptimize(found);
+  state.SetItemsProcessed(state.iterations() * timetable.follows.size());
+}
+
+BENCHMARK(BM_NextDepartureSearch)->RangeMultiplier(4)->Range(16, 1024);
+BENCHMARK(BM_NextDepartureIndex)->RangeMultiplier(4)->Range(16, 1024);
+BENCHMARK(BM_FollowTripSearch)->RangeMultiplier(4)->Range(16, 1024);
+BENCHMARK(BM_FollowTripIndex)->RangeMultiplier(4)->Range(16, 1024);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -83,7 +83,9 @@ boost::property_tree::ptree build_config(const char* live_traffic_tar) {
 
 constexpr float kMaxRange = 256;
 
-static void BM_UtrechtBidirectionalAstar(benchmark::State& state) {
+// when time dependent the routes depart on a weekday morning so the predicted speeds of the edges are
+// used, which means decoding them for every edge that is costed
+static void BM_UtrechtBidirectionalAstar(benchmark::State& state, const bool time_dependent) {
   const auto config = build_config("generated-live-data.tar");
   test::build_live_traffic_data(config);
 
@@ -147,6 +149,9 @@ static void BM_UtrechtBidirectionalAstar(benchmark::State& state) {
     }
     while (true) {
       auto origin = valhalla::Location{};
+      if (time_dependent) {
+        origin.set_date_time("2021-04-01T08:00");
+      }
       baldr::PathLocation::toPBF(it->second, &origin, *clean_reader);
       ++it;
       if (it == projections.cend()) {
@@ -201,7 +206,8 @@ void customize_traffic(const boost::property_tree::ptree& config,
   test::customize_live_traffic_data(config, generate_traffic);
 }
 
-BENCHMARK(BM_UtrechtBidirectionalAstar)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_UtrechtBidirectionalAstar, undated, false)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_UtrechtBidirectionalAstar, time_dependent, true)->Unit(benchmark::kMillisecond);
 
 /*
  * A set of fixed random routes across the globe.  Taken from test_requests/random.txt
@@ -341,6 +347,38 @@ static void BM_GetSpeed(benchmark::State& state) {
 
 BENCHMARK(BM_GetSpeed)->Unit(benchmark::kNanosecond);
 
+/** Benchmarks the GetSpeed function on predicted speeds, decoding them each time or caching them */
+static void BM_GetPredictedSpeed(benchmark::State& state, const bool cached) {
+  const auto config = build_config("get-speed.tar");
+  auto clean_reader = test::make_clean_graphreader(config.get_child("mjolnir"));
+
+  auto tile = clean_reader->GetGraphTile(baldr::GraphId(3196, 0, 0));
+  if (tile == nullptr) {
+    throw std::runtime_error("Target tile not found");
+  }
+  std::vector<const baldr::DirectedEdge*> edges;
+  for (const auto& edge : tile->GetDirectedEdges()) {
+    if (edge.has_predicted_speed()) {
+      edges.push_back(&edge);
+    }
+  }
+  if (edges.empty()) {
+    throw std::runtime_error("Target tile has no predicted speeds");
+  }
+
+  // a search goes over the same edges in the same bucket again and again
+  baldr::PredictedSpeedCache cache;
+  const uint32_t seconds = 8 * 3600;
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tile->GetSpeed(edges[i++ % edges.size()], baldr::kPredictedFlowMask,
+                                            seconds, false, nullptr, cached ? &cache : nullptr));
+  }
+}
+
+BENCHMARK_CAPTURE(BM_GetPredictedSpeed, decoded, false)->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(BM_GetPredictedSpeed, cached, true)->Unit(benchmark::kNanosecond);
+
 /** Benchmarks the Allowed function */
 static void BM_Sif_Allowed(benchmark::State& state) {
 
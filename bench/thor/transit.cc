@@ -0,0 +1,143 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gurka.h"
+#include "loki/worker.h"
+#include "mjolnir/servicedays.h"
+#include "thor/worker.h"
+
+using namespace valhalla;
+
+namespace {
+
+// The test data has no transit so we build a small city: a grid of streets with a station at
+// every crossing, a line along every street and a trip every 10 minutes in both directions
+constexpr uint32_t kGridSize = 7;
+constexpr uint32_t kBlock = 5; // in 100m grid cells
+constexpr uint32_t kQueries = 64;
+const std::string kNames = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+std::string name(uint32_t row, uint32_t column) {
+  return std::string(1, kNames[row * kGridSize + column]);
+}
+
+// the trips of a line through the stations, one every 10 minutes from 6am to 10am, each stop a
+// minute after the one before
+void add_line(const std::vector<std::string>& stations, gurka::transit::feed& feed) {
+  const uint32_t route = feed.routes.size();
+  feed.routes.push_back(route % 2 ? baldr::TransitType::kBus : baldr::TransitType::kTram);
+  for (uint32_t start = 6 * 3600; start < 10 * 3600; start += 600) {
+    const uint32_t trip = feed.stop_pairs.size() + 1;
+    for (uint32_t i = 0; i + 1 < stations.size(); ++i) {
+      feed.stop_pairs.push_back(
+          {trip, route, stations[i], start + i * 60, stations[i + 1], start + (i + 1) * 60});
+    }
+  }
+}
+
+const gurka::map& city() {
+  static const gurka::map map = [] {
+    std::string ascii_map;
+    gurka::ways ways;
+    gurka::transit::feed feed;
+    for (uint32_t row = 0; row < kGridSize; ++row) {
+      std::string street, avenue;
+      for (uint32_t column = 0; column < kGridSize; ++column) {
+        ascii_map += name(row, column) + std::string(column + 1 < kGridSize ? kBlock - 1 : 0, '-');
+        street += name(row, column);
+        avenue += name(column, row);
+        feed.stations.push_back(name(row, column));
+      }
+      ascii_map += "\n";
+      for (uint32_t i = 1; row + 1 < kGridSize && i < kBlock; ++i) {
+        for (uint32_t column = 0; column < kGridSize; ++column) {
+          ascii_map += "|" + std::string(column + 1 < kGridSize ? kBlock - 1 : 0, ' ');
+        }
+        ascii_map += "\n";
+      }
+      ways[street] = {{"highway", "residential"}};
+      ways[avenue] = {{"highway", "residential"}};
+      for (const auto& stations : {street, avenue}) {
+        std::vector<std::string> forward, backward;
+        for (const char station : stations) {
+          forward.emplace_back(1, station);
+        }
+        backward.assign(forward.rbegin(), forward.rend());
+        add_line(forward, feed);
+        add_line(backward, feed);
+      }
+    }
+    const auto layout = gurka::detail::map_to_coordinates(ascii_map, 100, {-73.95, 40.7});
+    return gurka::buildtiles(layout, ways, {}, {}, feed, "test/data/bench_transit",
+                             {{"mjolnir.concurrency", "1"},
+                              {"mjolnir.timezone", "test/data/tz.sqlite"}});
+  }();
+  return map;
+}
+
+// The same random trips across the city between 7am and 9am for both algorithms
+std::vector<std::string> make_requests() {
+  const auto& map = city();
+  const auto date = mjolnir::get_testing_date_time().substr(0, 10);
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<uint32_t> station(0, kGridSize * kGridSize - 1);
+  std::uniform_int_distribution<uint32_t> minutes(0, 120);
+  std::vector<std::string> requests;
+  for (uint32_t i = 0; i < kQueries; ++i) {
+    const auto& origin = map.nodes.at(std::string(1, kNames[station(generator)]));
+    const auto& destination = map.nodes.at(std::string(1, kNames[station(generator)]));
+    const uint32_t minute = minutes(generator);
+    char time[6];
+    snprintf(time, sizeof(time), "%02u:%02u", 7 + minute / 60, minute % 60);
+    requests.push_back(R"({"locations":[{"lat":)" + std::to_string(origin.lat()) +
+                       R"(,"lon":)" + std::to_string(origin.lng()) + R"(},{"lat":)" +
+                       std::to_string(destination.lat()) + R"(,"lon":)" +
+                       std::to_string(destination.lng()) +
+                       R"(}],"costing":"multimodal","date_time":{"type":1,"value":")" + date +
+                       "T" + time + R"("}})");
+  }
+  return requests;
+}
+
+// Route the same requests with the multimodal astar (0) or raptor (1), timing only thor
+void BM_TransitRoutes(benchmark::State& state) {
+  auto config = city().config;
+  config.put("thor.multimodal_algorithm", state.range(0) ? "raptor" : "multimodal");
+  loki::loki_worker_t loki_worker(config);
+  thor::thor_worker_t thor_worker(config);
+
+  std::vector<Api> requests;
+  for (const auto& request_json : make_requests()) {
+    Api request;
+    ParseApi(request_json, Options::route, request);
+    try {
+      loki_worker.route(request);
+      requests.emplace_back(std::move(request));
+    } catch (...) {}
+  }
+
+  if (requests.empty()) {
+    state.SkipWithError("No transit requests could be located");
+    return;
+  }
+
+  size_t failed = 0, i = 0;
+  for (auto _ : state) {
+    Api api(requests[i++ % requests.size()]);
+    try {
+      thor_worker.route(api);
+    } catch (...) { ++failed; }
+    thor_worker.cleanup();
+    benchmark::DoNotOptimize(api);
+  }
+  state.counters["failed"] = failed;
+}
+
+BENCHMARK(BM_TransitRoutes)->Unit(benchmark::kMillisecond)->Arg(0)->Arg(1);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,222 @@
+#include "admission_control.h"
+#include "midgard/constants.h"
+#include "midgard/logging.h"
+#include "midgard/pointll.h"
+#include "midgard/util.h"
+#include "proto_conversions.h"
+#include "worker.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// how often waiting requests check whether their client is still there
+constexpr auto kWaitSlice = std::chrono::milliseconds(50);
+// how much each finished request moves the latency estimate of its lane
+constexpr float kLatencySmoothing = 0.2f;
+// how many requests may wait for a slot if the config doesnt say
+constexpr size_t kDefaultMaxQueue = 64;
+
+void add_stat(valhalla::Api& request,
+              const std::string& key,
+              float value,
+              valhalla::StatisticType type) {
+  auto* stat = request.mutable_info()->mutable_statistics()->Add();
+  stat->set_key(key);
+  stat->set_value(value);
+  stat->set_type(type);
+}
+
+} // namespace
+
+namespace valhalla {
+
+struct admission_control_t::lane_t {
+  // limits
+  size_t concurrency;
+  size_t max_queue;
+  std::chrono::milliseconds max_wait;
+  float expensive_cost;
+  float latency_slo_ms;
+
+  // state
+  std::mutex mutex;
+  std::condition_variable slot_freed;
+  size_t running = 0;
+  size_t cheap_waiting = 0;
+  size_t expensive_waiting = 0;
+  float latency_ms = 0.f;
+};
+
+admission_control_t::ticket_t::~ticket_t() {
+  if (!lane) {
+    return;
+  }
+  // the latency of the request includes the time it spent waiting for its slot
+  auto elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - arrived);
+  {
+    std::lock_guard<std::mutex> lock(lane->mutex);
+    --lane->running;
+    lane->latency_ms += (elapsed.count() - lane->latency_ms) * kLatencySmoothing;
+  }
+  lane->slot_freed.notify_all();
+}
+
+admission_control_t::admission_control_t(const boost::property_tree::ptree& config) {
+  auto admission = config.get_child_optional("httpd.service.admission");
+  if (!admission) {
+    return;
+  }
+  // waiting requests block worker threads of this process so there can only be as many as the
+  // running ones leave over, anything beyond that is shed
+  const auto worker_concurrency = config.get<size_t>("httpd.service.worker_concurrency",
+                                                     std::thread::hardware_concurrency());
+  for (const auto& kv : *admission) {
+    Options::Action action;
+    if (!Options_Action_Enum_Parse(kv.first, &action)) {
+      throw std::runtime_error("Admission control for unknown action " + kv.first);
+    }
+    // no limit on concurrency means no lane at all
+    auto concurrency = kv.second.get<size_t>("concurrency", 0);
+    if (concurrency == 0) {
+      continue;
+    }
+    std::unique_ptr<lane_t> lane(new lane_t);
+    lane->concurrency = concurrency;
+    lane->max_queue = std::min(kv.second.get<size_t>("max_queue", kDefaultMaxQueue),
+                               worker_concurrency > concurrency ? worker_concurrency - concurrency
+                                                                : 0);
+    lane->max_wait = std::chrono::milliseconds(kv.second.get<size_t>("max_wait_ms", 0));
+    lane->expensive_cost = kv.second.get<float>("expensive_cost", 0.f);
+    lane->latency_slo_ms = kv.second.get<float>("latency_slo_ms", 0.f);
+    lanes.emplace(action, std::move(lane));
+  }
+}
+
+admission_control_t::~admission_control_t() {
+}
+
+std::shared_ptr<admission_control_t>
+admission_control_t::get_instance(const boost::property_tree::ptree& config) {
+  static std::shared_ptr<admission_control_t> instance = [&config]() {
+    std::shared_ptr<admission_control_t> admission(new admission_control_t(config));
+    return admission->lanes.empty() ? nullptr : admission;
+  }();
+  return instance;
+}
+
+float admission_control_t::estimate_cost(const Options& options) {
+  // how many things we have to find paths between
+  float pairs = 1.f;
+  switch (options.action()) {
+    case Options::sources_to_targets:
+      pairs = std::max(options.sources_size(), 1) * std::max(options.targets_size(), 1);
+      break;
+    case Options::trace_route:
+    case Options::trace_attributes:
+      pairs = std::max(options.shape_size(), 1);
+      break;
+    case Options::isochrone: {
+      // the contours reach out from the location rather than between locations so the largest
+      // one is what decides how far the search goes
+      float reach = 1.f;
+      for (const auto& contour : options.contours()) {
+        reach = std::max({reach, contour.distance(), contour.time()});
+      }
+      return std::max(options.locations_size(), 1) * reach;
+    }
+    default:
+      pairs = std::max(options.locations_size(), 1);
+      break;
+  }
+
+  // and how far apart those are
+  double min_lat = 90, max_lat = -90, min_lng = 180, max_lng = -180;
+  for (const auto* locations : {&options.locations(), &options.sources(), &options.targets(),
+                                &options.shape()}) {
+    for (const auto& location : *locations) {
+      min_lat = std::min(min_lat, location.ll().lat());
+      max_lat = std::max(max_lat, location.ll().lat());
+      min_lng = std::min(min_lng, location.ll().lng());
+      max_lng = std::max(max_lng, location.ll().lng());
+    }
+  }
+  float span = 0.f;
+  if (min_lat <= max_lat) {
+    span = midgard::PointLL(min_lng, min_lat).Distance(midgard::PointLL(max_lng, max_lat)) *
+           midgard::kKmPerMeter;
+  }
+  return pairs * std::max(span, 1.f);
+}
+
+admission_control_t::ticket_t admission_control_t::admit(Api& request,
+                                                         const std::function<void()>* interrupt) {
+  ticket_t ticket;
+  auto found = lanes.find(request.options().action());
+  if (found == lanes.cend()) {
+    return ticket;
+  }
+  auto& lane = *found->second;
+  const auto& action = Options_Action_Enum_Name(request.options().action());
+  const auto cost = estimate_cost(request.options());
+  const bool expensive = lane.expensive_cost > 0.f && cost >= lane.expensive_cost;
+
+  std::unique_lock<std::mutex> lock(lane.mutex);
+  auto waiting = lane.cheap_waiting + lane.expensive_waiting;
+  add_stat(request, action + ".info.admission.queue_depth", waiting, gauge);
+
+  auto admissible = [&lane, expensive]() {
+    return lane.running < lane.concurrency && (!expensive || lane.cheap_waiting == 0);
+  };
+
+  // if the lane is already behind we dont make it worse with expensive work and we dont let the
+  // queue grow past the worker threads it may block either. with nothing running the latency
+  // estimate is stale though
+  bool behind =
+      lane.latency_slo_ms > 0.f && lane.running > 0 && lane.latency_ms > lane.latency_slo_ms;
+  if ((expensive && behind) || (!admissible() && waiting >= lane.max_queue)) {
+    add_stat(request, action + ".info.admission.shed", 1, count);
+    LOG_WARN("Shedding " + action + " request with cost " + std::to_string(cost));
+    throw valhalla_exception_t{103};
+  }
+
+  // cheap requests go ahead of expensive ones
+  auto& waiting_here = expensive ? lane.expensive_waiting : lane.cheap_waiting;
+  ++waiting_here;
+  midgard::Finally<std::function<void()>> stop_waiting([&waiting_here]() { --waiting_here; });
+  auto start = std::chrono::steady_clock::now();
+  while (!lane.slot_freed.wait_for(lock, kWaitSlice, admissible)) {
+    // give up if we waited too long
+    if (lane.max_wait.count() && std::chrono::steady_clock::now() - start > lane.max_wait) {
+      add_stat(request, action + ".info.admission.shed", 1, count);
+      LOG_WARN("Shedding " + action + " request after waiting too long");
+      throw valhalla_exception_t{103};
+    }
+    // or if the client did, we have the lock though so let it go first
+    if (interrupt) {
+      lock.unlock();
+      try {
+        (*interrupt)();
+      } catch (...) {
+        lock.lock();
+        throw;
+      }
+      lock.lock();
+    }
+  }
+
+  // take the slot
+  ++lane.running;
+  ticket.lane = &lane;
+  ticket.arrived = start;
+  add_stat(request, action + ".info.admission.wait_ms",
+           std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start)
+               .count(),
+           timing);
+  return ticket;
+}
+
+} // namespace valhalla
@@ -0,0 +1,159 @@
+#include "baldr/arcflags.h"
+#include "midgard/constants.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+// "VARC" and the version of the file layout
+constexpr uint32_t kArcFlagsMagic = 0x43524156;
+constexpr uint32_t kArcFlagsVersion = 1;
+
+struct header_t {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t costing;
+  uint32_t tile_count;
+  double min_lng, min_lat, max_lng, max_lat;
+  uint32_t edge_count;
+  uint32_t spare;
+};
+
+template <typename T> void write(std::ofstream& file, const T* data, size_t count) {
+  file.write(reinterpret_cast<const char*>(data), count * sizeof(T));
+}
+
+template <typename T> void read(std::ifstream& file, T* data, size_t count) {
+  file.read(reinterpret_cast<char*>(data), count * sizeof(T));
+}
+
+// The cell of a coordinate in a range split into count cells, clamped to the range
+uint32_t cell_of(const double value, const double min, const double max, const uint32_t count) {
+  if (max <= min) {
+    return 0;
+  }
+  const auto cell = static_cast<int64_t>(std::floor((value - min) / (max - min) * count));
+  return static_cast<uint32_t>(std::max<int64_t>(0, std::min<int64_t>(count - 1, cell)));
+}
+
+} // namespace
+
+namespace valhalla {
+namespace baldr {
+
+constexpr uint32_t ArcFlags::kRegionColumns;
+constexpr uint32_t ArcFlags::kRegionRows;
+constexpr ArcFlags::flags_t ArcFlags::kAllRegions;
+
+ArcFlags::ArcFlags()
+    : costing_(static_cast<uint32_t>(Costing::auto_)), min_lng_(0), min_lat_(0), max_lng_(0),
+      max_lat_(0) {
+}
+
+ArcFlags::ArcFlags(const Costing costing,
+                   const midgard::AABB2<midgard::PointLL>& bounds,
+                   std::vector<tile_t> tiles)
+    : costing_(static_cast<uint32_t>(costing)), min_lng_(bounds.minx()), min_lat_(bounds.miny()),
+      max_lng_(bounds.maxx()), max_lat_(bounds.maxy()), tiles_(std::move(tiles)) {
+  std::sort(tiles_.begin(), tiles_.end(),
+            [](const tile_t& a, const tile_t& b) { return a.id < b.id; });
+  uint32_t edge_count = 0;
+  for (auto& tile : tiles_) {
+    tile.offset = edge_count;
+    edge_count += tile.edge_count;
+  }
+  flags_.resize(edge_count, {0, 0});
+}
+
+ArcFlags ArcFlags::Load(const std::string& file_name) {
+  std::ifstream file(file_name, std::ios::in | std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("Could not open arc flag file " + file_name);
+  }
+  header_t header{};
+  read(file, &header, 1);
+  if (!file || header.magic != kArcFlagsMagic || header.version != kArcFlagsVersion) {
+    throw std::runtime_error(file_name + " is not an arc flag file of version " +
+                             std::to_string(kArcFlagsVersion));
+  }
+
+  ArcFlags arc_flags;
+  arc_flags.costing_ = header.costing;
+  arc_flags.min_lng_ = header.min_lng;
+  arc_flags.min_lat_ = header.min_lat;
+  arc_flags.max_lng_ = header.max_lng;
+  arc_flags.max_lat_ = header.max_lat;
+  arc_flags.tiles_.resize(header.tile_count);
+  arc_flags.flags_.resize(header.edge_count);
+  read(file, arc_flags.tiles_.data(), arc_flags.tiles_.size());
+  read(file, arc_flags.flags_.data(), arc_flags.flags_.size());
+  if (!file) {
+    throw std::runtime_error("Arc flag file " + file_name + " is truncated");
+  }
+
+  // the tiles have to number the edges without gaps for the flags to be usable
+  uint32_t offset = 0;
+  for (size_t i = 0; i < arc_flags.tiles_.size(); ++i) {
+    const auto& tile = arc_flags.tiles_[i];
+    if (tile.offset != offset || (i > 0 && arc_flags.tiles_[i - 1].id >= tile.id)) {
+      throw std::runtime_error("Arc flag file " + file_name + " has bad tile " +
+                               std::to_string(GraphId(tile.id)));
+    }
+    offset += tile.edge_count;
+  }
+  if (offset != header.edge_count) {
+    throw std::runtime_error("Arc flag file " + file_name + " has bad tiles");
+  }
+  return arc_flags;
+}
+
+void ArcFlags::Save(const std::string& file_name) const {
+  std::ofstream file(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+  const header_t header{kArcFlagsMagic, kArcFlagsVersion, costing_,
+                        static_cast<uint32_t>(tiles_.size()), min_lng_, min_lat_, max_lng_, max_lat_,
+                        edge_count(), 0};
+  write(file, &header, 1);
+  write(file, tiles_.data(), tiles_.size());
+  write(file, flags_.data(), flags_.size());
+  if (!file) {
+    throw std::runtime_error("Could not write arc flag file " + file_name);
+  }
+}
+
+uint32_t ArcFlags::Region(const midgard::PointLL& ll) const {
+  return cell_of(ll.lat(), min_lat_, max_lat_, kRegionRows) * kRegionColumns +
+         cell_of(ll.lng(), min_lng_, max_lng_, kRegionColumns);
+}
+
+ArcFlags::flags_t ArcFlags::Regions(const midgard::PointLL& ll, const float radius) const {
+  const double lat_radius = radius / midgard::kMetersPerDegreeLat;
+  const double lng_radius =
+      radius / (midgard::kMetersPerDegreeLat *
+                std::max(0.01, std::cos(ll.lat() * midgard::kRadPerDegD)));
+  const auto first_row = cell_of(ll.lat() - lat_radius, min_lat_, max_lat_, kRegionRows);
+  const auto last_row = cell_of(ll.lat() + lat_radius, min_lat_, max_lat_, kRegionRows);
+  const auto first_column = cell_of(ll.lng() - lng_radius, min_lng_, max_lng_, kRegionColumns);
+  const auto last_column = cell_of(ll.lng() + lng_radius, min_lng_, max_lng_, kRegionColumns);
+  flags_t regions = 0;
+  for (auto row = first_row; row <= last_row; ++row) {
+    for (auto column = first_column; column <= last_column; ++column) {
+      regions |= flags_t(1) << (row * kRegionColumns + column);
+    }
+  }
+  return regions;
+}
+
+const ArcFlags::edge_flags_t* ArcFlags::flags(const GraphId& edgeid) const {
+  const uint64_t tile_id = edgeid.Tile_Base().value;
+  auto tile = std::lower_bound(tiles_.cbegin(), tiles_.cend(), tile_id,
+                               [](const tile_t& t, uint64_t id) { return t.id < id; });
+  return tile != tiles_.cend() && tile->id == tile_id && edgeid.id() < tile->edge_count
+             ? &flags_[tile->offset + edgeid.id()]
+             : nullptr;
+}
+
+} // namespace baldr
+} // namespace valhalla
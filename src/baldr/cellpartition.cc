@@ -0,0 +1,210 @@
+#include "baldr/cellpartition.h"
+#include "baldr/tilehierarchy.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+// "VCPT" and the version of the file layout
+constexpr uint32_t kPartitionMagic = 0x54504356;
+constexpr uint32_t kPartitionVersion = 1;
+
+struct header_t {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t cell_count;
+  uint32_t cut_edge_count;
+};
+
+template <typename T> void write(std::ofstream& file, const T* data, size_t count) {
+  file.write(reinterpret_cast<const char*>(data), count * sizeof(T));
+}
+
+template <typename T> void read(std::ifstream& file, T* data, size_t count) {
+  file.read(reinterpret_cast<char*>(data), count * sizeof(T));
+}
+
+} // namespace
+
+namespace valhalla {
+namespace baldr {
+
+constexpr uint32_t CellPartition::kInvalidCell;
+
+CellPartition::CellPartition() : cells_{{kInvalidCell, 0, 0}} {
+}
+
+CellPartition::CellPartition(std::vector<cut_edge_t> cut_edges) {
+  // group the edges by the cell they enter
+  std::sort(cut_edges.begin(), cut_edges.end(), [](const cut_edge_t& a, const cut_edge_t& b) {
+    return a.to_cell < b.to_cell || (a.to_cell == b.to_cell && a.edgeid.value < b.edgeid.value);
+  });
+  cut_edges.erase(std::unique(cut_edges.begin(), cut_edges.end(),
+                              [](const cut_edge_t& a, const cut_edge_t& b) {
+                                return a.edgeid == b.edgeid;
+                              }),
+                  cut_edges.end());
+  std::vector<uint32_t> ids;
+  ids.reserve(cut_edges.size() * 2);
+  for (const auto& cut_edge : cut_edges) {
+    if (cut_edge.from_cell == cut_edge.to_cell) {
+      throw std::runtime_error("Edge " + std::to_string(cut_edge.edgeid) +
+                               " starts and ends in the same cell");
+    }
+    ids.push_back(cut_edge.from_cell);
+    ids.push_back(cut_edge.to_cell);
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+  // entries come in cell order, exits need their own pass
+  entries_.reserve(cut_edges.size());
+  for (const auto& cut_edge : cut_edges) {
+    entries_.push_back(cut_edge.edgeid);
+  }
+  std::vector<uint32_t> entry_begins;
+  entry_begins.reserve(ids.size());
+  auto entry = cut_edges.cbegin();
+  for (auto id : ids) {
+    entry_begins.push_back(entry - cut_edges.cbegin());
+    while (entry != cut_edges.cend() && entry->to_cell == id) {
+      ++entry;
+    }
+  }
+
+  std::sort(cut_edges.begin(), cut_edges.end(), [](const cut_edge_t& a, const cut_edge_t& b) {
+    return a.from_cell < b.from_cell ||
+           (a.from_cell == b.from_cell && a.edgeid.value < b.edgeid.value);
+  });
+  exits_.reserve(cut_edges.size());
+  for (const auto& cut_edge : cut_edges) {
+    exits_.push_back(cut_edge.edgeid);
+  }
+  cells_.reserve(ids.size() + 1);
+  auto exit = cut_edges.cbegin();
+  for (size_t i = 0; i < ids.size(); ++i) {
+    cells_.push_back(
+        {ids[i], entry_begins[i], static_cast<uint32_t>(exit - cut_edges.cbegin())});
+    while (exit != cut_edges.cend() && exit->from_cell == ids[i]) {
+      ++exit;
+    }
+  }
+  cells_.push_back(
+      {kInvalidCell, static_cast<uint32_t>(entries_.size()), static_cast<uint32_t>(exits_.size())});
+  Index();
+}
+
+CellPartition CellPartition::Load(const std::string& file_name) {
+  std::ifstream file(file_name, std::ios::in | std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("Could not open partition file " + file_name);
+  }
+  header_t header{};
+  read(file, &header, 1);
+  if (!file || header.magic != kPartitionMagic || header.version != kPartitionVersion) {
+    throw std::runtime_error(file_name + " is not a partition file of version " +
+                             std::to_string(kPartitionVersion));
+  }
+
+  CellPartition partition;
+  partition.cells_.resize(header.cell_count + 1);
+  partition.entries_.resize(header.cut_edge_count);
+  partition.exits_.resize(header.cut_edge_count);
+  read(file, partition.cells_.data(), partition.cells_.size());
+  read(file, partition.entries_.data(), partition.entries_.size());
+  read(file, partition.exits_.data(), partition.exits_.size());
+  if (!file) {
+    throw std::runtime_error("Partition file " + file_name + " is truncated");
+  }
+
+  // the offsets have to stay within the edges for the cells to be usable
+  for (uint32_t i = 0; i < header.cell_count; ++i) {
+    const auto &cell = partition.cells_[i], &next = partition.cells_[i + 1];
+    if (cell.entry_begin > next.entry_begin || cell.exit_begin > next.exit_begin ||
+        (i > 0 && partition.cells_[i - 1].id >= cell.id)) {
+      throw std::runtime_error("Partition file " + file_name + " has bad cell " +
+                               std::to_string(cell.id));
+    }
+  }
+  if (partition.cells_.back().entry_begin != header.cut_edge_count ||
+      partition.cells_.back().exit_begin != header.cut_edge_count) {
+    throw std::runtime_error("Partition file " + file_name + " has bad cells");
+  }
+  partition.Index();
+  return partition;
+}
+
+void CellPartition::Save(const std::string& file_name) const {
+  std::ofstream file(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+  header_t header{kPartitionMagic, kPartitionVersion, cell_count(), cut_edge_count()};
+  write(file, &header, 1);
+  write(file, cells_.data(), cells_.size());
+  write(file, entries_.data(), entries_.size());
+  write(file, exits_.data(), exits_.size());
+  if (!file) {
+    throw std::runtime_error("Could not write partition file " + file_name);
+  }
+}
+
+bool CellPartition::Partitions(const DirectedEdge* edge) {
+  return !edge->is_shortcut() && !edge->IsTransitLine() &&
+         edge->endnode().level() != TileHierarchy::GetTransitLevel().level &&
+         edge->use() != Use::kTransitConnection && edge->use() != Use::kEgressConnection &&
+         edge->use() != Use::kPlatformConnection;
+}
+
+uint32_t CellPartition::CellOf(const GraphId& node, const midgard::PointLL& ll) {
+  const auto& local = TileHierarchy::levels().back();
+  return node.level() == local.level ? node.tileid() : local.tiles.TileId(ll);
+}
+
+uint32_t CellPartition::Find(const uint32_t cell_id) const {
+  auto cell = std::lower_bound(cells_.cbegin(), cells_.cend() - 1, cell_id,
+                               [](const cell_t& c, uint32_t id) { return c.id < id; });
+  return cell != cells_.cend() - 1 && cell->id == cell_id ? cell - cells_.cbegin() : kInvalidCell;
+}
+
+bool CellPartition::FindEntry(const GraphId& edgeid, uint32_t& cell, uint32_t& index) const {
+  auto found = std::lower_bound(entry_lookup_.cbegin(), entry_lookup_.cend(), edgeid.value,
+                                [](const boundary_t& b, uint64_t id) { return b.edgeid < id; });
+  if (found == entry_lookup_.cend() || found->edgeid != edgeid.value) {
+    return false;
+  }
+  cell = found->cell;
+  index = found->index;
+  return true;
+}
+
+bool CellPartition::FindExit(const GraphId& edgeid, uint32_t& cell, uint32_t& index) const {
+  auto found = std::lower_bound(exit_lookup_.cbegin(), exit_lookup_.cend(), edgeid.value,
+                                [](const boundary_t& b, uint64_t id) { return b.edgeid < id; });
+  if (found == exit_lookup_.cend() || found->edgeid != edgeid.value) {
+    return false;
+  }
+  cell = found->cell;
+  index = found->index;
+  return true;
+}
+
+void CellPartition::Index() {
+  entry_lookup_.clear();
+  exit_lookup_.clear();
+  entry_lookup_.reserve(entries_.size());
+  exit_lookup_.reserve(exits_.size());
+  for (uint32_t cell = 0; cell < cell_count(); ++cell) {
+    for (uint32_t i = 0; i < entry_count(cell); ++i) {
+      entry_lookup_.push_back({entries(cell)[i].value, cell, i});
+    }
+    for (uint32_t i = 0; i < exit_count(cell); ++i) {
+      exit_lookup_.push_back({exits(cell)[i].value, cell, i});
+    }
+  }
+  auto by_edge = [](const boundary_t& a, const boundary_t& b) { return a.edgeid < b.edgeid; };
+  std::sort(entry_lookup_.begin(), entry_lookup_.end(), by_edge);
+  std::sort(exit_lookup_.begin(), exit_lookup_.end(), by_edge);
+}
+
+} // namespace baldr
+} // namespace valhalla
@@ -11,6 +11,7 @@
 #include "incident_singleton.h"
 #include "midgard/encoded.h"
 #include "midgard/logging.h"
+#include "midgard/profiling.h"
 #include "shortcut_recovery.h"
 
 using namespace valhalla::midgard;
@@ -509,8 +510,11 @@ graph_tile_ptr GraphReader::GetGraphTile(const GraphId& graphid) {
   auto base = graphid.Tile_Base();
   if (const auto& cached = cache_->Get(base)) {
     // LOG_DEBUG("Memory cache hit " + GraphTile::FileSuffix(base));
+    midgard::profiling::count(midgard::profiling::Counter::kTileCacheHit);
     return cached;
   }
+  midgard::profiling::count(midgard::profiling::Counter::kTileCacheMiss);
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kTileLoad);
 
   // Try getting it from the memmapped tar extract
   if (!tile_extract_->tiles.empty()) {
@@ -913,39 +917,36 @@ int GraphReader::GetTimezone(const baldr::GraphId& node, graph_tile_ptr& tile) {
   return (tile == nullptr) ? 0 : tile->node(node)->timezone();
 }
 
+std::shared_ptr<const IncidentIndex> GraphReader::GetIncidentIndex(const GraphId& tile_id) const {
+  return enable_incidents_ ? incident_singleton_t::get(tile_id.Tile_Base())
+                           : std::shared_ptr<const IncidentIndex>{};
+}
+
 std::shared_ptr<const valhalla::IncidentsTile>
 GraphReader::GetIncidentTile(const GraphId& tile_id) const {
-  return enable_incidents_ ? incident_singleton_t::get(tile_id.Tile_Base())
-                           : std::shared_ptr<valhalla::IncidentsTile>{};
+  auto index = GetIncidentIndex(tile_id);
+  return index ? index->tile() : std::shared_ptr<const valhalla::IncidentsTile>{};
 }
 
 IncidentResult GraphReader::GetIncidents(const GraphId& edge_id, graph_tile_ptr& tile) {
   // if we are not doing this for any reason then bail
-  std::shared_ptr<const valhalla::IncidentsTile> itile;
+  std::shared_ptr<const IncidentIndex> index;
   if (!enable_incidents_ || !GetGraphTile(edge_id, tile) ||
       !tile->trafficspeed(tile->directededge(edge_id)).has_incidents ||
-      !(itile = GetIncidentTile(edge_id))) {
+      !(index = GetIncidentIndex(edge_id))) {
     return {};
   }
 
-  // get the range of incidents we care about and hand it back, equal_range has no lambda option
-  auto begin = std::partition_point(itile->locations().begin(), itile->locations().end(),
-                                    [&edge_id](const valhalla::IncidentsTile::Location& candidate) {
-                                      // first one that is >= the id we want
-                                      bool is_found = candidate.edge_index() < edge_id.id();
-                                      return is_found;
-                                    });
-  auto end = std::partition_point(begin, itile->locations().end(),
-                                  [&edge_id](const valhalla::IncidentsTile::Location& candidate) {
-                                    // first one that is > the id we want
-                                    bool is_found = candidate.edge_index() <= edge_id.id();
-                                    return is_found;
-                                  });
-
-  int begin_index = begin - itile->locations().begin();
-  int end_index = end - itile->locations().begin();
-
-  return {itile, begin_index, end_index};
+  // get the range of incidents we care about and hand it back
+  auto range = index->find(edge_id.id());
+  return {index->tile(), range.first, range.second};
+}
+
+bool GraphReader::IsClosedByIncident(const GraphId& edge_id, graph_tile_ptr& tile) {
+  std::shared_ptr<const IncidentIndex> index;
+  return enable_incidents_ && GetGraphTile(edge_id, tile) &&
+         tile->trafficspeed(tile->directededge(edge_id)).has_incidents &&
+         (index = GetIncidentIndex(edge_id)) && index->closed(edge_id.id());
 }
 
 const valhalla::IncidentsTile::Metadata&
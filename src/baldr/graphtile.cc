@@ -365,6 +365,12 @@ void GraphTile::Initialize(const GraphId& graphid) {
   if (graphid.level() == 3) {
     AssociateOneStopIds(graphid);
   }
+
+  // Lay the departures out for finding the next one on a line
+  if (header_->departurecount() > 0) {
+    departure_index_ = TransitDepartureIndex(departures_, header_->departurecount(),
+                                             transit_schedules_, header_->schedulecount());
+  }
 }
 
 // For transit tiles we need to save off the pair<tileid,lineid> lookup via
@@ -794,70 +800,22 @@ const TransitDeparture* GraphTile::GetNextDeparture(const uint32_t lineid,
                                                     bool date_before_tile,
                                                     bool wheelchair,
                                                     bool bicycle) const {
-  uint32_t count = header_->departurecount();
-  if (count == 0) {
-    return nullptr;
-  }
-
-  // Departures are sorted by edge Id and then by departure time.
-  // Binary search to find a departure with matching line Id.
-  int32_t low = 0;
-  int32_t high = count - 1;
-  int32_t mid;
-  int32_t found = count;
-  while (low <= high) {
-    mid = (low + high) / 2;
-    const auto& dep = departures_[mid];
-    // matching lineid and a workable time
-    if (lineid == dep.lineid() &&
-        ((current_time <= dep.departure_time() && dep.type() == kFixedSchedule) ||
-         (current_time <= dep.end_time() && dep.type() == kFrequencySchedule))) {
-      found = mid;
-      high = mid - 1;
-    } // need a smaller lineid
-    else if (lineid < dep.lineid()) {
-      high = mid - 1;
-    } // either need a bigger lineid or a later time
-    else {
-      low = mid + 1;
+  uint32_t departure_time;
+  uint32_t found = departure_index_.Find(lineid, current_time, day, dow, date_before_tile,
+                                         wheelchair, bicycle, departure_time);
+  if (found != TransitDepartureIndex::kNotFound) {
+    const auto& d = departures_[found];
+    if (d.type() == kFixedSchedule) {
+      return &d;
     }
-  }
-
-  // Iterate through departures until one is found with valid date, dow or
-  // calendar date, and does not have a calendar exception.
-  for (; found < count && departures_[found].lineid() == lineid; ++found) {
-    // Make sure valid departure time
-    if (departures_[found].type() == kFixedSchedule) {
-      if (departures_[found].departure_time() >= current_time &&
-          GetTransitSchedule(departures_[found].schedule_index())
-              ->IsValid(day, dow, date_before_tile) &&
-          (!wheelchair || departures_[found].wheelchair_accessible()) &&
-          (!bicycle || departures_[found].bicycle_accessible())) {
-        return &departures_[found];
-      }
-    } else {
-      uint32_t departure_time = departures_[found].departure_time();
-      uint32_t end_time = departures_[found].end_time();
-      uint32_t frequency = departures_[found].frequency();
-      while (departure_time < current_time && departure_time < end_time) {
-        departure_time += frequency;
-      }
 
-      if (departure_time >= current_time && departure_time < end_time &&
-          GetTransitSchedule(departures_[found].schedule_index())
-              ->IsValid(day, dow, date_before_tile) &&
-          (!wheelchair || departures_[found].wheelchair_accessible()) &&
-          (!bicycle || departures_[found].bicycle_accessible())) {
-
-        const auto& d = departures_[found];
-        const TransitDeparture* dep =
-            new TransitDeparture(d.lineid(), d.tripid(), d.routeid(), d.blockid(),
-                                 d.headsign_offset(), departure_time, d.end_time(), d.frequency(),
-                                 d.elapsed_time(), d.schedule_index(), d.wheelchair_accessible(),
-                                 d.bicycle_accessible());
-        return dep;
-      }
-    }
+    // Frequency based departures are returned for the trip that was found
+    const TransitDeparture* dep =
+        new TransitDeparture(d.lineid(), d.tripid(), d.routeid(), d.blockid(), d.headsign_offset(),
+                             departure_time, d.end_time(), d.frequency(), d.elapsed_time(),
+                             d.schedule_index(), d.wheelchair_accessible(),
+                             d.bicycle_accessible());
+    return dep;
   }
 
   // TODO - maybe wrap around, try next day?
@@ -870,64 +828,26 @@ const TransitDeparture* GraphTile::GetNextDeparture(const uint32_t lineid,
 const TransitDeparture* GraphTile::GetTransitDeparture(const uint32_t lineid,
                                                        const uint32_t tripid,
                                                        const uint32_t current_time) const {
-  uint32_t count = header_->departurecount();
-  if (count == 0) {
-    return nullptr;
-  }
-
-  // Departures are sorted by edge Id and then by departure time.
-  // Binary search to find a departure with matching line Id.
-  int32_t low = 0;
-  int32_t high = count - 1;
-  int32_t mid;
-  int32_t found = count;
-  while (low <= high) {
-    mid = (low + high) / 2;
-    const auto& dep = departures_[mid];
-    // find the first matching lineid in the list
-    if (lineid == dep.lineid() &&
-        ((current_time <= dep.departure_time() && dep.type() == kFixedSchedule) ||
-         (current_time <= dep.end_time() && dep.type() == kFrequencySchedule))) {
-      found = mid;
-      high = mid - 1;
-    } // need a smaller lineid
-    else if (lineid < dep.lineid()) {
-      high = mid - 1;
-    } // need a bigger lineid
-    else {
-      low = mid + 1;
+  uint32_t departure_time;
+  uint32_t found = departure_index_.FindTrip(lineid, tripid, current_time, departure_time);
+  if (found != TransitDepartureIndex::kNotFound) {
+    const auto& d = departures_[found];
+    if (d.type() == kFixedSchedule) {
+      return &d;
     }
-  }
-
-  // Iterate through departures until one is found with matching trip id
-  for (; found < count && departures_[found].lineid() == lineid; ++found) {
-    if (departures_[found].tripid() == tripid) {
-
-      if (departures_[found].type() == kFixedSchedule) {
-        return &departures_[found];
-      }
-
-      uint32_t departure_time = departures_[found].departure_time();
-      uint32_t end_time = departures_[found].end_time();
-      uint32_t frequency = departures_[found].frequency();
-      while (departure_time < current_time && departure_time < end_time) {
-        departure_time += frequency;
-      }
 
-      if (departure_time >= current_time && departure_time < end_time) {
-        const auto& d = departures_[found];
-        const TransitDeparture* dep =
-            new TransitDeparture(d.lineid(), d.tripid(), d.routeid(), d.blockid(),
-                                 d.headsign_offset(), departure_time, d.end_time(), d.frequency(),
-                                 d.elapsed_time(), d.schedule_index(), d.wheelchair_accessible(),
-                                 d.bicycle_accessible());
-        return dep;
-      }
-    }
+    // Frequency based departures are returned for the trip that was found
+    const TransitDeparture* dep =
+        new TransitDeparture(d.lineid(), d.tripid(), d.routeid(), d.blockid(), d.headsign_offset(),
+                             departure_time, d.end_time(), d.frequency(), d.elapsed_time(),
+                             d.schedule_index(), d.wheelchair_accessible(),
+                             d.bicycle_accessible());
+    return dep;
   }
 
-  LOG_INFO("No departures found for lineid = " + std::to_string(lineid) +
-           " and tripid = " + std::to_string(tripid));
+  // A trip ending here is not unusual so this is not worth more than a debug message
+  LOG_DEBUG("No departures found for lineid = " + std::to_string(lineid) +
+            " and tripid = " + std::to_string(tripid));
   return nullptr;
 }
 
@@ -985,6 +905,14 @@ const TransitRoute* GraphTile::GetTransitRoute(const uint32_t idx) const {
   throw std::runtime_error("GraphTile GetTransitRoute index out of bounds");
 }
 
+// Get the transit departure given its index within the tile
+const TransitDeparture* GraphTile::GetTransitDepartureAt(const uint32_t idx) const {
+  if (idx < header_->departurecount()) {
+    return &departures_[idx];
+  }
+  throw std::runtime_error("GraphTile GetTransitDepartureAt index out of bounds");
+}
+
 // Get the transit schedule given its schedule index.
 const TransitSchedule* GraphTile::GetTransitSchedule(const uint32_t idx) const {
   uint32_t count = header_->schedulecount();
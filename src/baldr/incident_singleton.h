@@ -1,10 +1,15 @@
 #pragma once
 
 #include "baldr/graphreader.h"
+#include "baldr/incidentindex.h"
 #include "midgard/sequence.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <climits>
 #include <condition_variable>
+#include <cstring>
 #include <ctime>
 #include <memory>
 #include <mutex>
@@ -13,6 +18,12 @@
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
 namespace {
 
 #ifdef _WIN32
@@ -26,6 +37,168 @@ namespace {
 constexpr time_t DEFAULT_MAX_LOADING_LATENCY = 60;
 constexpr size_t DEFAULT_MAX_LATENT_COUNT = 5;
 
+// milliseconds since the epoch, used to measure how stale incident tiles are when they are loaded
+inline int64_t now_ms() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// a tile whose file changed and when it changed (ms since the epoch). the path is empty when the
+// tile was removed. keyed by tile so that a tile written many times between loads is parsed once
+struct change_t {
+  std::string path;
+  int64_t when;
+};
+using changes_t = std::unordered_map<uint64_t, change_t>;
+
+#ifdef __linux__
+/**
+ * Watches a directory tree with inotify so that we are told which tiles were written, moved or
+ * removed rather than having to stat every file in the tree to find out. Files are only reported
+ * once they are closed after writing (or moved into place) so we never parse a half written tile.
+ */
+class dir_watcher_t {
+public:
+  explicit dir_watcher_t(const filesystem::path& root)
+      : fd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {
+    if (fd_ == -1) {
+      throw std::runtime_error("Could not initialize inotify: " + std::string(strerror(errno)));
+    }
+    // usually this fails because we would need more than fs.inotify.max_user_watches
+    bool watching = watch(root);
+    if (watching) {
+      add(root, nullptr);
+    }
+    if (!watching || lost_) {
+      auto error = std::string(strerror(errno));
+      close(fd_);
+      throw std::runtime_error("Could not watch " + root.string() + ": " + error);
+    }
+  }
+  ~dir_watcher_t() {
+    close(fd_);
+  }
+  dir_watcher_t(const dir_watcher_t&) = delete;
+  dir_watcher_t& operator=(const dir_watcher_t&) = delete;
+
+  /**
+   * Blocks until there is something to read or the timeout expires
+   * @param seconds  how long to wait at most
+   */
+  void wait(time_t seconds) {
+    pollfd p{fd_, POLLIN, 0};
+    poll(&p, 1, static_cast<int>(seconds * 1000));
+  }
+
+  /**
+   * Drains the pending events into the set of changes
+   * @param changes  the tiles which were written or removed
+   * @return false if events were lost and the whole tree needs to be scanned again
+   */
+  bool read(changes_t& changes) {
+    alignas(inotify_event) char buffer[sizeof(inotify_event) * 64 + NAME_MAX + 1];
+    ssize_t length;
+    while ((length = ::read(fd_, buffer, sizeof(buffer))) > 0) {
+      auto now = now_ms();
+      for (const char* pos = buffer; pos < buffer + length;) {
+        const auto* event = reinterpret_cast<const inotify_event*>(pos);
+        pos += sizeof(inotify_event) + event->len;
+        // the kernel ran out of room for events or a directory we watched is gone
+        if (event->mask & IN_Q_OVERFLOW) {
+          lost_ = true;
+          continue;
+        }
+        if (event->mask & IN_IGNORED) {
+          dirs_.erase(event->wd);
+          continue;
+        }
+        auto dir = dirs_.find(event->wd);
+        if (dir == dirs_.cend() || event->len == 0) {
+          continue;
+        }
+        filesystem::path path(dir->second);
+        path /= std::string(event->name);
+
+        // new directories may already have tiles in them by the time we watch them. directories
+        // moved away take their tiles with them without telling us which ones they were
+        if (event->mask & IN_ISDIR) {
+          if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+            lost_ |= !watch(path);
+            add(path, &changes);
+          } else if (event->mask & IN_MOVED_FROM) {
+            lost_ = true;
+          }
+          continue;
+        }
+
+        // a file that was just created is still being written, we hear about it again once it
+        // is closed. otherwise something that looks like a tile was written or removed
+        if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM)) {
+          record(path, event->mask & (IN_DELETE | IN_MOVED_FROM), now, changes);
+        }
+      }
+    }
+    // nothing left to watch means the directory itself went away
+    return !lost_ && !dirs_.empty();
+  }
+
+protected:
+  static constexpr uint32_t kEvents =
+      IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_CREATE | IN_ONLYDIR;
+
+  // starts watching a single directory
+  bool watch(const filesystem::path& dir) {
+    auto wd = inotify_add_watch(fd_, dir.c_str(), kEvents);
+    if (wd == -1) {
+      return false;
+    }
+    dirs_[wd] = dir;
+    return true;
+  }
+
+  // watches everything below a directory and optionally records the tiles already in there
+  void add(const filesystem::path& dir, changes_t* changes) {
+    auto now = now_ms();
+    for (filesystem::recursive_directory_iterator i(dir), end; i != end; ++i) {
+      if (i->is_directory()) {
+        lost_ |= !watch(i->path());
+      } else if (changes && i->is_regular_file()) {
+        record(i->path(), false, now, *changes);
+      }
+    }
+  }
+
+  // records a tile as changed if the file looks like a tile
+  static void record(const filesystem::path& path, bool removed, int64_t when, changes_t& changes) {
+    try {
+      auto tile_id = valhalla::baldr::GraphTile::GetTileId(path.string());
+      if (tile_id.Is_Valid()) {
+        changes[tile_id] = {removed ? std::string() : path.string(), when};
+      }
+    } // happens when there is a file in the directory that doesnt have a tile-looking name
+    catch (...) {}
+  }
+
+  int fd_;
+  std::unordered_map<int, filesystem::path> dirs_;
+  bool lost_ = false;
+};
+#else
+// there is no change notification here that we use so the directory is always scanned
+class dir_watcher_t {
+public:
+  explicit dir_watcher_t(const filesystem::path&) {
+    throw std::runtime_error("File system notifications are not supported on this platform");
+  }
+  void wait(time_t) {
+  }
+  bool read(changes_t&) {
+    return false;
+  }
+};
+#endif
+
 struct incident_singleton_t {
 protected:
   // parameter pack to share state between daemon thread and singleton instance
@@ -34,8 +207,10 @@ protected:
     std::atomic<bool> lock_free;    // whether or not we can skip locking around cache operations
     std::condition_variable signal; // how the watcher tells the main thread its done its first load
     std::mutex mutex;               // for locking on cache operations
-    // the actual cache where tiles are stored
-    std::unordered_map<uint64_t, std::shared_ptr<const valhalla::IncidentsTile>> cache;
+    // how long (ms) the stalest change in the last batch of updates waited before it was loaded
+    std::atomic<int64_t> update_latency;
+    // the actual cache where tiles are stored, indexed for lookups by edge
+    std::unordered_map<uint64_t, std::shared_ptr<const valhalla::baldr::IncidentIndex>> cache;
   };
   // we use a shared_ptr to wrap the state between the watcher thread and the main threads singleton
   // instance. this gives the responsibility to the last living thread to deallocate the state object.
@@ -118,6 +293,11 @@ protected:
       return {};
     }
 
+    // lookups by edge need the locations in edge order
+    if (valhalla::baldr::IncidentIndex::sort_locations(*tile)) {
+      LOG_WARN("Incident Watcher sorted the unsorted locations of " + filename);
+    }
+
     // hand back something that isnt modifyable
     return std::const_pointer_cast<const valhalla::IncidentsTile>(tile);
   }
@@ -126,13 +306,13 @@ protected:
    * Updates the tile in the states cache
    * @param state     the state to update
    * @param tile_id   the tile id we are loading
-   * @param path      the path to the tile file
+   * @param tile      the index of the tile, null when the tile has no incidents
    * @param hint      a pointer to an existing iterator into the cache
-   * @return the shared_ptr that owns the tile memory
+   * @return whether or not the tile was updated
    */
   static bool update_tile(const std::shared_ptr<state_t>& state,
                           const valhalla::baldr::GraphId& tile_id,
-                          std::shared_ptr<const valhalla::IncidentsTile>&& tile,
+                          std::shared_ptr<const valhalla::baldr::IncidentIndex>&& tile,
                           decltype(state_t::cache)::iterator* hint = nullptr) {
     // see if we have a slot
     auto found = hint ? *hint : state->cache.find(tile_id);
@@ -160,19 +340,65 @@ protected:
     return true;
   }
 
+  /**
+   * Parses and indexes all of the changed tiles and only then swaps them into the cache. The parsing
+   * is the slow part so doing it up front keeps the time between the first and the last tile of a
+   * batch being swapped in short and means we only take the lock (when we need it at all) to make
+   * new slots
+   * @param state      the state to update
+   * @param changes    the tiles to load or unload
+   * @param measure    whether to record how stale the changes were by the time they were loaded
+   * @return the number of tiles that were updated
+   */
+  static size_t load_changes(const std::shared_ptr<state_t>& state,
+                             const changes_t& changes,
+                             bool measure) {
+    std::vector<
+        std::pair<valhalla::baldr::GraphId, std::shared_ptr<const valhalla::baldr::IncidentIndex>>>
+        tiles;
+    tiles.reserve(changes.size());
+    int64_t oldest = now_ms();
+    for (const auto& change : changes) {
+      auto tile = change.second.path.empty() ? nullptr : read_tile(change.second.path);
+      tiles.emplace_back(valhalla::baldr::GraphId(change.first),
+                         tile ? std::make_shared<const valhalla::baldr::IncidentIndex>(tile)
+                              : nullptr);
+      oldest = std::min(oldest, change.second.when);
+    }
+
+    size_t update_count = 0;
+    for (auto& tile : tiles) {
+      update_count += update_tile(state, tile.first, std::move(tile.second));
+    }
+
+    // the first load is everything on disk, how long that sat there before we started isnt latency
+    if (measure && !changes.empty()) {
+      state->update_latency.store(std::max(now_ms() - oldest, int64_t(0)));
+    }
+    return update_count;
+  }
+
   /**
    * Thread work function that continually checks for updates to incident tiles. The thread begins by
-   * deciding whether its just scanning the directory (works for a small number of incidents) or using
-   * a memory mapped changelog to communicate about which incidents changed when.
+   * deciding whether its watching a directory (works for a small number of incidents or on linux
+   * where the file system tells us what changed) or using a memory mapped changelog to communicate
+   * about which incidents changed when. In either mode the changed tiles are collected first and
+   * then loaded in one batch, see load_changes.
    *
-   * Directory Scanning Mode:
+   * Directory Mode:
    *
-   * In this mode the thread will continually loop over the entire contents of the directory provided.
-   * Any file in the directory which has a timestamp later or equal to the timestamp of the last scan
-   * that was performed will be read into the incident cache. Tiles which are in the cache but were
-   * not found on the disk in the last scan will be purged as they have been removed from the disk. If
-   * a static tileset was provided any tiles which are found in the directory but are not part of the
-   * tileset will be ignored.
+   * On linux the thread scans the directory once and from then on uses inotify to be told which
+   * files were written, moved or removed. Only those tiles are reloaded and the thread sleeps until
+   * something happens rather than for a fixed interval. If events are lost (the kernel queue
+   * overflowed or a directory was moved away) the thread scans the directory again. Notifications
+   * can be disabled with incident_dir_notify, eg. for network file systems which dont deliver them.
+   *
+   * Otherwise, or if notifications cant be set up, the thread will continually loop over the entire
+   * contents of the directory provided. Any file in the directory which has a timestamp later or
+   * equal to the timestamp of the last scan that was performed will be read into the incident cache.
+   * Tiles which are in the cache but were not found on the disk in the last scan will be purged as
+   * they have been removed from the disk. If a static tileset was provided any tiles which are found
+   * in the directory but are not part of the tileset will be ignored.
    *
    * Memory Mapped Log Mode:
    *
@@ -185,7 +411,7 @@ protected:
    * they have been removed from the log. If a static tileset was provided any tiles which are found
    * in the log but are nto part of the tileset will be ignored. When the timestamp for the last check
    * is older than a timestamp for a given file that file is replaced with whatever its contents are
-   * on disk.
+   * on disk. Writes to a mapped file dont produce file system notifications so this mode always polls
    *
    * @param config     lets the function know where to look for incidents and desired update frequency
    * @param tileset    if not empty, the static list of tiles to track (other tiles will be ignored).
@@ -211,7 +437,7 @@ protected:
       if (!filesystem::is_directory(inc_dir)) {
         inc_dir = {};
       } else {
-        LOG_INFO("Incident watcher configured for directory scan mode");
+        LOG_INFO("Incident watcher configured for directory mode");
       }
     }
 
@@ -231,6 +457,21 @@ protected:
       state->cache[tile_id] = {};
     }
 
+    // in directory mode we'd rather be told what changed than go and look. we start watching before
+    // the first scan so that nothing which changes during the scan goes unnoticed
+    std::unique_ptr<dir_watcher_t> dir_watcher;
+    auto start_watching = [&]() {
+      try {
+        dir_watcher.reset();
+        dir_watcher.reset(new dir_watcher_t(inc_dir));
+      } catch (const std::exception& e) {
+        LOG_WARN("Incident watcher falling back to directory scans: " + std::string(e.what()));
+      }
+    };
+    if (!inc_dir.string().empty() && config.get<bool>("incident_dir_notify", true)) {
+      start_watching();
+    }
+
     // some setup for continuous operation
     size_t run_count = 0;
     time_t last_scan = 0;
@@ -238,6 +479,7 @@ protected:
         config.get<time_t>("incident_max_loading_latency", DEFAULT_MAX_LOADING_LATENCY);
     std::unordered_set<uint64_t> seen;
     seen.reserve(tileset.size());
+    changes_t changes;
 
     // wait for someone to tell us to stop
     do {
@@ -245,8 +487,10 @@ protected:
       // this happens when the tile is updated during the loop. in that case its possible that
       // the current iteration will load the tile and that it will again be loaded in the next
       auto current_scan = time(nullptr);
-      size_t update_count = 0;
+      auto since = last_scan;
+      bool scanned = true;
       seen.clear();
+      changes.clear();
 
       // we are in memory map mode
       if (changelog) {
@@ -272,12 +516,23 @@ protected:
             auto file_location = inc_log_path;
             file_location.replace_filename(
                 valhalla::baldr::GraphTile::FileSuffix(tile_id, ".pbf", true));
-            // update the tile
-            update_count += update_tile(state, tile_id, read_tile(file_location.string()));
+            changes[tile_id] = {file_location.string(), timestamp * 1000};
           }
         }
+      } // we are being told what changed
+      else if (run_count > 0 && dir_watcher && dir_watcher->read(changes)) {
+        scanned = false;
       } // we are in directory scan mode
-      else if (!inc_dir.string().empty()) {
+      else {
+        // we were watching but missed something, watch afresh and look at everything again because
+        // tiles that moved in with a directory kept their old timestamps
+        if (run_count > 0 && dir_watcher) {
+          LOG_WARN("Incident watcher missed changes in " + inc_dir.string() + ", rescanning");
+          start_watching();
+          changes.clear();
+          since = 0;
+        }
+
         // check all of the files
         for (filesystem::recursive_directory_iterator i(inc_dir), end; i != end; ++i) {
           try {
@@ -288,9 +543,8 @@ protected:
               // and if the tile was updated since the last time we scanned we load it
               seen.insert(tile_id);
               struct stat s;
-              if (stat(i->path().c_str(), &s) == 0 && last_scan <= MTIME(s)) {
-                // update the tile
-                update_count += update_tile(state, tile_id, read_tile(i->path().string()));
+              if (stat(i->path().c_str(), &s) == 0 && since <= MTIME(s)) {
+                changes[tile_id] = {i->path().string(), int64_t(MTIME(s)) * 1000};
               }
             }
           } // happens when there is a file in the directory that doesnt have a tile-looking name
@@ -299,14 +553,17 @@ protected:
       }
 
       // for all the ones we didnt see, they have been removed from the filesystem or changelog
-      // no locking is needed because we don't realloc here we just null out some values
-      for (auto entry = state->cache.begin(); entry != state->cache.end(); ++entry) {
-        auto found = seen.find(entry->first);
-        if (found == seen.cend() && entry->second) {
-          update_count += update_tile(state, valhalla::baldr::GraphId(entry->first), nullptr, &entry);
+      if (scanned) {
+        for (const auto& entry : state->cache) {
+          if (entry.second && seen.find(entry.first) == seen.cend()) {
+            changes[entry.first] = {{}, current_scan * int64_t(1000)};
+          }
         }
       }
 
+      // load everything that changed
+      auto update_count = load_changes(state, changes, run_count > 0);
+
       // if this round finished but was slower than we want
       last_scan = current_scan;
       auto latency = time(nullptr) - current_scan;
@@ -317,8 +574,11 @@ protected:
       else {
         wait = max_loading_latency - latency;
       }
-      LOG_INFO("Incident watcher updated " + std::to_string(update_count) + " tiles in " +
-               std::to_string(latency) + " seconds");
+      if (update_count > 0 || scanned) {
+        LOG_INFO("Incident watcher updated " + std::to_string(update_count) + " tiles in " +
+                 std::to_string(latency) + " seconds with an update latency of " +
+                 std::to_string(state->update_latency.load()) + " ms");
+      }
 
       // signal to the constructor that we completed our first batch
       if (run_count++ == 0) {
@@ -327,8 +587,12 @@ protected:
         state->signal.notify_one();
       }
 
-      // wait just a little before we check again
-      std::this_thread::sleep_for(std::chrono::seconds(wait));
+      // wait just a little before we check again, or until we are told something changed
+      if (dir_watcher) {
+        dir_watcher->wait(wait);
+      } else {
+        std::this_thread::sleep_for(std::chrono::seconds(wait));
+      }
     } while (!interrupt || !interrupt(run_count));
 
     LOG_INFO("Incident watcher has stopped");
@@ -336,13 +600,13 @@ protected:
 
 public:
   /**
-   * Get an incident tile, this method is never called unless the config dictates it
+   * Get the index of an incident tile, this method is never called unless the config dictates it
    * @param tile_id   the tile id specifies which tile you want
    * @param config    only needed on first call, configures the incident loading
    * @param tileset   only needed on first call, configures the incident loading
-   * @return a shared_ptr to the incident tile or an empty shared_ptr when none exists
+   * @return a shared_ptr to the indexed incident tile or an empty shared_ptr when none exists
    */
-  static std::shared_ptr<const valhalla::IncidentsTile>
+  static std::shared_ptr<const valhalla::baldr::IncidentIndex>
   get(const valhalla::baldr::GraphId& tile_id,
       const boost::property_tree::ptree& config = {},
       const std::unordered_set<valhalla::baldr::GraphId>& tileset = {}) {
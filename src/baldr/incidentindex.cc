@@ -0,0 +1,81 @@
+#include "baldr/incidentindex.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+bool by_edge(const valhalla::IncidentsTile::Location& a, const valhalla::IncidentsTile::Location& b) {
+  return a.edge_index() < b.edge_index();
+}
+
+} // namespace
+
+namespace valhalla {
+namespace baldr {
+
+IncidentIndex::IncidentIndex(std::shared_ptr<const IncidentsTile> tile) : tile_(std::move(tile)) {
+  if (!tile_) {
+    throw std::invalid_argument("Cannot index a null incidents tile");
+  }
+  const auto& locations = tile_->locations();
+  if (static_cast<uint64_t>(locations.size()) >= (uint64_t(1) << 31)) {
+    throw std::runtime_error("Too many incident locations to index");
+  }
+
+  // one entry at the start of each run of locations on the same edge
+  for (int i = 0; i < locations.size(); ++i) {
+    const auto& location = locations.Get(i);
+    if (entries_.empty() || entries_.back().edge_index != location.edge_index()) {
+      if (!entries_.empty() && entries_.back().edge_index > location.edge_index()) {
+        throw std::runtime_error("Incident locations must be sorted by edge index");
+      }
+      entries_.push_back({location.edge_index(), static_cast<uint32_t>(i), false});
+    }
+    // an invalid metadata index is reported when someone goes to look at the metadata
+    if (location.metadata_index() < static_cast<uint32_t>(tile_->metadata_size()) &&
+        tile_->metadata(location.metadata_index()).road_closed()) {
+      entries_.back().closed = true;
+    }
+  }
+
+  // the last range ends at the end of the locations
+  entries_.push_back(
+      {std::numeric_limits<uint32_t>::max(), static_cast<uint32_t>(locations.size()), false});
+  entries_.shrink_to_fit();
+}
+
+bool IncidentIndex::sort_locations(IncidentsTile& tile) {
+  auto* locations = tile.mutable_locations();
+  if (std::is_sorted(locations->begin(), locations->end(), by_edge)) {
+    return false;
+  }
+  std::stable_sort(locations->begin(), locations->end(), by_edge);
+  return true;
+}
+
+std::vector<IncidentIndex::entry_t>::const_iterator
+IncidentIndex::lower_bound(uint32_t edge_index) const {
+  // the sentinel is never a match so we dont search it
+  return std::lower_bound(entries_.cbegin(), entries_.cend() - 1, edge_index,
+                          [](const entry_t& entry, uint32_t edge_index) {
+                            return entry.edge_index < edge_index;
+                          });
+}
+
+std::pair<int, int> IncidentIndex::find(uint32_t edge_index) const {
+  auto found = lower_bound(edge_index);
+  if (found == entries_.cend() - 1 || found->edge_index != edge_index) {
+    return {0, 0};
+  }
+  return {static_cast<int>(found->location), static_cast<int>((found + 1)->location)};
+}
+
+bool IncidentIndex::closed(uint32_t edge_index) const {
+  auto found = lower_bound(edge_index);
+  return found != entries_.cend() - 1 && found->edge_index == edge_index && found->closed;
+}
+
+} // namespace baldr
+} // namespace valhalla
@@ -0,0 +1,137 @@
+#include "baldr/landmarks.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+// "VLMK" and the version of the file layout
+constexpr uint32_t kLandmarksMagic = 0x4b4d4c56;
+constexpr uint32_t kLandmarksVersion = 1;
+
+struct header_t {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t costing_count;
+  uint32_t landmark_count;
+  uint32_t tile_count;
+  uint32_t node_count;
+};
+
+template <typename T> void write(std::ofstream& file, const T* data, size_t count) {
+  file.write(reinterpret_cast<const char*>(data), count * sizeof(T));
+}
+
+template <typename T> void read(std::ifstream& file, T* data, size_t count) {
+  file.read(reinterpret_cast<char*>(data), count * sizeof(T));
+}
+
+} // namespace
+
+namespace valhalla {
+namespace baldr {
+
+constexpr uint32_t Landmarks::kInvalidTable;
+constexpr uint32_t Landmarks::kInvalidNode;
+constexpr float Landmarks::kUnreachable;
+
+Landmarks::Landmarks() : landmark_count_(0), node_count_(0) {
+}
+
+Landmarks::Landmarks(const std::vector<Costing>& costings,
+                     const uint32_t landmark_count,
+                     std::vector<tile_t> tiles)
+    : landmark_count_(landmark_count), node_count_(0), tiles_(std::move(tiles)) {
+  for (auto costing : costings) {
+    costings_.push_back(static_cast<uint32_t>(costing));
+  }
+  std::sort(tiles_.begin(), tiles_.end(),
+            [](const tile_t& a, const tile_t& b) { return a.id < b.id; });
+  for (auto& tile : tiles_) {
+    tile.offset = node_count_;
+    node_count_ += tile.node_count;
+  }
+  landmarks_.resize(costings_.size() * landmark_count_);
+  distances_.resize(costings_.size() * static_cast<size_t>(node_count_) * landmark_count_,
+                    {kUnreachable, kUnreachable});
+}
+
+Landmarks Landmarks::Load(const std::string& file_name) {
+  std::ifstream file(file_name, std::ios::in | std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("Could not open landmark file " + file_name);
+  }
+  header_t header{};
+  read(file, &header, 1);
+  if (!file || header.magic != kLandmarksMagic || header.version != kLandmarksVersion) {
+    throw std::runtime_error(file_name + " is not a landmark file of version " +
+                             std::to_string(kLandmarksVersion));
+  }
+
+  Landmarks landmarks;
+  landmarks.landmark_count_ = header.landmark_count;
+  landmarks.node_count_ = header.node_count;
+  landmarks.costings_.resize(header.costing_count);
+  landmarks.tiles_.resize(header.tile_count);
+  landmarks.landmarks_.resize(static_cast<size_t>(header.costing_count) * header.landmark_count);
+  landmarks.distances_.resize(static_cast<size_t>(header.costing_count) * header.node_count *
+                              header.landmark_count);
+  read(file, landmarks.costings_.data(), landmarks.costings_.size());
+  read(file, landmarks.tiles_.data(), landmarks.tiles_.size());
+  read(file, landmarks.landmarks_.data(), landmarks.landmarks_.size());
+  read(file, landmarks.distances_.data(), landmarks.distances_.size());
+  if (!file) {
+    throw std::runtime_error("Landmark file " + file_name + " is truncated");
+  }
+
+  // the tiles have to number the nodes without gaps for the distances to be usable
+  uint32_t offset = 0;
+  for (size_t i = 0; i < landmarks.tiles_.size(); ++i) {
+    const auto& tile = landmarks.tiles_[i];
+    if (tile.offset != offset || (i > 0 && landmarks.tiles_[i - 1].id >= tile.id)) {
+      throw std::runtime_error("Landmark file " + file_name + " has bad tile " +
+                               std::to_string(GraphId(tile.id)));
+    }
+    offset += tile.node_count;
+  }
+  if (offset != header.node_count) {
+    throw std::runtime_error("Landmark file " + file_name + " has bad tiles");
+  }
+  return landmarks;
+}
+
+void Landmarks::Save(const std::string& file_name) const {
+  std::ofstream file(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+  header_t header{kLandmarksMagic,
+                  kLandmarksVersion,
+                  static_cast<uint32_t>(costings_.size()),
+                  landmark_count_,
+                  static_cast<uint32_t>(tiles_.size()),
+                  node_count_};
+  write(file, &header, 1);
+  write(file, costings_.data(), costings_.size());
+  write(file, tiles_.data(), tiles_.size());
+  write(file, landmarks_.data(), landmarks_.size());
+  write(file, distances_.data(), distances_.size());
+  if (!file) {
+    throw std::runtime_error("Could not write landmark file " + file_name);
+  }
+}
+
+uint32_t Landmarks::table(const Costing costing) const {
+  auto found = std::find(costings_.cbegin(), costings_.cend(), static_cast<uint32_t>(costing));
+  return found == costings_.cend() ? kInvalidTable : found - costings_.cbegin();
+}
+
+uint32_t Landmarks::index(const GraphId& node) const {
+  const uint64_t tile_id = node.Tile_Base().value;
+  auto tile = std::lower_bound(tiles_.cbegin(), tiles_.cend(), tile_id,
+                               [](const tile_t& t, uint64_t id) { return t.id < id; });
+  return tile != tiles_.cend() && tile->id == tile_id && node.id() < tile->node_count
+             ? tile->offset + node.id()
+             : kInvalidNode;
+}
+
+} // namespace baldr
+} // namespace valhalla
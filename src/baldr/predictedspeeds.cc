@@ -1,5 +1,10 @@
 #include "baldr/predictedspeeds.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BALDR_USE_SSE2
+#endif
+
 namespace valhalla {
 namespace baldr {
 
@@ -47,8 +52,9 @@ private:
   BucketCosTable(BucketCosTable&&) = delete;
   BucketCosTable& operator=(BucketCosTable&&) = delete;
 
-  // cos table (this uses about 1.6MB of memory)
-  float table_[kCosBucketTableSize];
+  // cos table (this uses about 1.6MB of memory). Each bucket is 200 floats so every bucket starts
+  // on a 16 byte boundary as well
+  alignas(16) float table_[kCosBucketTableSize];
 };
 
 std::array<int16_t, kCoefficientCount> compress_speed_buckets(const float* speeds) {
@@ -76,12 +82,31 @@ float decompress_speed_bucket(const int16_t* coefficients, uint32_t bucket_idx)
   // Get a pointer to the precomputed cos values for this bucket
   const float* b = BucketCosTable::GetInstance().get(bucket_idx);
 
-  // DCT-III with speed normalization
-  float speed = *coefficients * k1OverSqrt2;
-  const auto* coef_end = coefficients + kCoefficientCount;
-  for (++b, ++coefficients; coefficients < coef_end; ++coefficients, ++b) {
-    speed += *coefficients * *b;
+  // DCT-III with speed normalization. The first cos value is always 1 so the dot product takes all
+  // of the first coefficient and we take some of it back afterwards
+  float speed = 0.f;
+  uint32_t c = 0;
+#ifdef BALDR_USE_SSE2
+  static_assert(kCoefficientCount % 8 == 0, "Coefficients are decoded 8 at a time");
+  __m128 sum_lo = _mm_setzero_ps();
+  __m128 sum_hi = _mm_setzero_ps();
+  for (; c < kCoefficientCount; c += 8) {
+    // widen 8 int16 coefficients to floats, unpacking a value with itself and shifting it back
+    // down sign extends it
+    const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefficients + c));
+    const __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16));
+    const __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16));
+    sum_lo = _mm_add_ps(sum_lo, _mm_mul_ps(lo, _mm_load_ps(b + c)));
+    sum_hi = _mm_add_ps(sum_hi, _mm_mul_ps(hi, _mm_load_ps(b + c + 4)));
+  }
+  alignas(16) float sums[4];
+  _mm_store_ps(sums, _mm_add_ps(sum_lo, sum_hi));
+  speed = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+#endif
+  for (; c < kCoefficientCount; ++c) {
+    speed += coefficients[c] * b[c];
   }
+  speed += *coefficients * (k1OverSqrt2 - 1.f);
   return speed * kSpeedNormalization;
 }
 
@@ -0,0 +1,161 @@
+#include "baldr/transitdepartureindex.h"
+#include "midgard/logging.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// The first element whose key is not less than the one given. The trip count of the loop only
+// depends on the length and the ternary compiles to a conditional move so there is nothing for the
+// branch predictor to get wrong, which is most of the cost of a normal binary search this small
+template <typename T, typename key_t>
+const T* branchless_lower_bound(const T* base, uint32_t count, uint32_t key, key_t get_key) {
+  if (count == 0) {
+    return base;
+  }
+  while (count > 1) {
+    const uint32_t half = count / 2;
+    base = get_key(base[half - 1]) < key ? base + half : base;
+    count -= half;
+  }
+  return base + (get_key(*base) < key);
+}
+
+} // namespace
+
+namespace valhalla {
+namespace baldr {
+
+constexpr uint32_t TransitDepartureIndex::kNotFound;
+
+TransitDepartureIndex::TransitDepartureIndex(const TransitDeparture* departures,
+                                             uint32_t count,
+                                             const TransitSchedule* schedules,
+                                             uint32_t schedule_count) {
+  lines_.reserve(count / 8 + 1);
+  latest_.reserve(count);
+  services_.reserve(count);
+  trips_.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    const auto& departure = departures[i];
+    const bool frequency_based = departure.type() == kFrequencySchedule;
+    const uint32_t latest = frequency_based ? departure.end_time() : departure.departure_time();
+
+    // a new line starts its own running maximum
+    if (lines_.empty() || lines_.back().lineid != departure.lineid()) {
+      if (!lines_.empty() && lines_.back().lineid > departure.lineid()) {
+        throw std::runtime_error("Transit departures must be sorted by line id");
+      }
+      lines_.push_back({departure.lineid(), i});
+      latest_.push_back(latest);
+    } else {
+      latest_.push_back(std::max(latest_.back(), latest));
+    }
+
+    // a departure whose schedule is missing can never be taken
+    service_t service{};
+    if (departure.schedule_index() < schedule_count) {
+      const auto& schedule = schedules[departure.schedule_index()];
+      service.days = schedule.days();
+      service.end_day = schedule.end_day();
+      service.days_of_week = schedule.days_of_week();
+    } else {
+      LOG_WARN("Transit departure " + std::to_string(i) + " has an invalid schedule index " +
+               std::to_string(departure.schedule_index()));
+    }
+    service.departure_time = departure.departure_time();
+    service.wheelchair = departure.wheelchair_accessible();
+    service.bicycle = departure.bicycle_accessible();
+    service.frequency_based = frequency_based;
+    if (frequency_based) {
+      service.end_time = departure.end_time();
+      service.frequency = departure.frequency();
+    }
+    services_.push_back(service);
+    trips_.push_back(departure.tripid());
+  }
+
+  // the last line ends at the end of the departures
+  lines_.push_back({std::numeric_limits<uint32_t>::max(), count});
+  lines_.shrink_to_fit();
+}
+
+std::pair<uint32_t, uint32_t> TransitDepartureIndex::Candidates(const uint32_t lineid,
+                                                                const uint32_t current_time) const {
+  if (lines_.size() < 2) {
+    return {0, 0};
+  }
+
+  // find the line, the sentinel is never a match so we dont search it
+  const auto* line = branchless_lower_bound(lines_.data(), lines_.size() - 1, lineid,
+                                            [](const line_t& l) { return l.lineid; });
+  if (line == &lines_.back() || line->lineid != lineid) {
+    return {0, 0};
+  }
+
+  // the latest times only ever grow along the line so the first departure that could still be
+  // taken is a lower bound. nothing before it can be taken and the rest are checked in order
+  const uint32_t begin = line->begin, end = (line + 1)->begin;
+  const auto* first = branchless_lower_bound(latest_.data() + begin, end - begin, current_time,
+                                             [](uint32_t latest) { return latest; });
+  return {static_cast<uint32_t>(first - latest_.data()), end};
+}
+
+bool TransitDepartureIndex::Departs(const service_t& service,
+                                    const uint32_t current_time,
+                                    uint32_t& departure_time) {
+  // fixed departures just have to leave late enough
+  uint32_t time = service.departure_time;
+  if (!service.frequency_based) {
+    departure_time = time;
+    return time >= current_time;
+  }
+
+  // the first trip of a frequency based departure that leaves late enough
+  if (time < current_time && service.frequency > 0) {
+    time += (current_time - time + service.frequency - 1) / service.frequency * service.frequency;
+  }
+  departure_time = time;
+  return time >= current_time && time < service.end_time;
+}
+
+uint32_t TransitDepartureIndex::Find(const uint32_t lineid,
+                                     const uint32_t current_time,
+                                     const uint32_t day,
+                                     const uint32_t dow,
+                                     bool date_before_tile,
+                                     bool wheelchair,
+                                     bool bicycle,
+                                     uint32_t& departure_time) const {
+  const auto candidates = Candidates(lineid, current_time);
+  const bool use_days = !date_before_tile;
+  for (uint32_t i = candidates.first; i < candidates.second; ++i) {
+    const auto& service = services_[i];
+    // same as TransitSchedule::IsValid
+    const bool runs = (use_days && day <= service.end_day) ? ((service.days >> day) & 1)
+                                                           : (service.days_of_week & dow) != 0;
+    if (runs && (!wheelchair || service.wheelchair) && (!bicycle || service.bicycle) &&
+        Departs(service, current_time, departure_time)) {
+      return i;
+    }
+  }
+  return kNotFound;
+}
+
+uint32_t TransitDepartureIndex::FindTrip(const uint32_t lineid,
+                                         const uint32_t tripid,
+                                         const uint32_t current_time,
+                                         uint32_t& departure_time) const {
+  const auto candidates = Candidates(lineid, current_time);
+  for (uint32_t i = candidates.first; i < candidates.second; ++i) {
+    if (trips_[i] == tripid && Departs(services_[i], current_time, departure_time)) {
+      return i;
+    }
+  }
+  return kNotFound;
+}
+
+} // namespace baldr
+} // namespace valhalla
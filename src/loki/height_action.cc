@@ -75,7 +75,7 @@ std::string loki_worker_t::height(Api& request) {
 
   auto shape = init_height(request);
   // get the elevation of each posting
-  std::vector<double> heights = sample.get_all(shape);
+  std::vector<double> heights = sample->get_all(shape);
 
   // get the distances between the postings if desired
   std::vector<double> ranges;
@@ -4,6 +4,7 @@
 #include "loki/reach.h"
 #include "midgard/distanceapproximator.h"
 #include "midgard/linesegment2.h"
+#include "midgard/profiling.h"
 #include "midgard/util.h"
 
 #include <algorithm>
@@ -785,6 +786,7 @@ std::unordered_map<valhalla::baldr::Location, PathLocation>
 Search(const std::vector<valhalla::baldr::Location>& locations,
        GraphReader& reader,
        const std::shared_ptr<DynamicCost>& costing) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kSearch);
   // we cannot continue without costing
   if (!costing)
     throw std::runtime_error("No costing was provided for edge candidate search");
@@ -1,6 +1,8 @@
 #include <boost/property_tree/ptree.hpp>
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -28,6 +30,27 @@ using namespace valhalla::baldr;
 using namespace valhalla::sif;
 using namespace valhalla::loki;
 
+namespace {
+
+// The elevation tiles of a data source are mapped once and shared, along with the cache of
+// decompressed tiles, by all the workers of the process
+std::shared_ptr<const skadi::sample> get_sample(const boost::property_tree::ptree& config) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::weak_ptr<const skadi::sample>> samples;
+  const auto data_source = config.get<std::string>("additional_data.elevation", "");
+  std::lock_guard<std::mutex> lock(mutex);
+  auto sample = samples[data_source].lock();
+  if (!sample) {
+    sample = std::make_shared<const skadi::sample>(
+        data_source, config.get<size_t>("additional_data.elevation_cache_size",
+                                        skadi::sample::kDefaultCacheSize));
+    samples[data_source] = sample;
+  }
+  return sample;
+}
+
+} // namespace
+
 namespace valhalla {
 namespace loki {
 void loki_worker_t::parse_locations(google::protobuf::RepeatedPtrField<valhalla::Location>* locations,
@@ -157,7 +180,7 @@ loki_worker_t::loki_worker_t(const boost::property_tree::ptree& config,
       max_contour_min(config.get<size_t>("service_limits.isochrone.max_time_contour")),
       max_contour_km(config.get<size_t>("service_limits.isochrone.max_distance_contour")),
       max_trace_shape(config.get<size_t>("service_limits.trace.max_shape")),
-      sample(config.get<std::string>("additional_data.elevation", "")),
+      sample(get_sample(config)),
       max_elevation_shape(config.get<size_t>("service_limits.skadi.max_shape")),
       min_resample(config.get<float>("service_limits.skadi.min_resample")) {
   // If we weren't provided with a graph reader make our own
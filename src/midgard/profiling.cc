@@ -0,0 +1,55 @@
+#include "midgard/profiling.h"
+
+namespace valhalla {
+namespace midgard {
+namespace profiling {
+
+const char* to_string(Stage stage) {
+  switch (stage) {
+    case Stage::kTileLoad:
+      return "tile_load";
+    case Stage::kSearch:
+      return "search";
+    case Stage::kExpansion:
+      return "expansion";
+    case Stage::kPathFormation:
+      return "path_formation";
+    case Stage::kTripLeg:
+      return "trip_leg";
+    case Stage::kNarrative:
+      return "narrative";
+    case Stage::kSerialization:
+      return "serialization";
+    default:
+      return "unknown";
+  }
+}
+
+const char* to_string(Counter counter) {
+  switch (counter) {
+    case Counter::kTileCacheHit:
+      return "tile_cache_hit";
+    case Counter::kTileCacheMiss:
+      return "tile_cache_miss";
+    default:
+      return "unknown";
+  }
+}
+
+bool start() {
+  auto& profile = thread_profile();
+  if (profile.enabled) {
+    return false;
+  }
+  profile = Profile{};
+  profile.enabled = true;
+  return true;
+}
+
+void stop() {
+  thread_profile().enabled = false;
+}
+
+} // namespace profiling
+} // namespace midgard
+} // namespace valhalla
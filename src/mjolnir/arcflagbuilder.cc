@@ -0,0 +1,489 @@
+#include "mjolnir/arcflagbuilder.h"
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "baldr/arcflags.h"
+#include "baldr/graphreader.h"
+#include "baldr/tilehierarchy.h"
+#include "midgard/logging.h"
+#include "sif/costfactory.h"
+#include "sif/edgelabel.h"
+
+using namespace valhalla::baldr;
+using namespace valhalla::midgard;
+using namespace valhalla::sif;
+
+namespace {
+
+// The edges that aren't part of a search path, like the ones the costing cant use
+constexpr uint32_t kNoEdge = std::numeric_limits<uint32_t>::max();
+
+// An edge from one region to another, the shortest paths into the region it enters or out of the
+// one it leaves are searched from it
+struct boundary_t {
+  uint64_t edge;
+  bool into;
+  uint32_t region;
+  bool operator<(const boundary_t& other) const {
+    return edge < other.edge || (edge == other.edge && into < other.into);
+  }
+  bool operator==(const boundary_t& other) const {
+    return edge == other.edge && into == other.into;
+  }
+};
+
+/**
+ * Numbers the edges of the flagged levels in the order of the arc flags and after them the edges
+ * of the local level, which the searches go over but which dont get flags of their own
+ */
+class numbering_t {
+public:
+  numbering_t(const ArcFlags& arc_flags, GraphReader& reader)
+      : arc_flags_(arc_flags), edge_count_(arc_flags.edge_count()) {
+    for (const auto& id : reader.GetTileSet(TileHierarchy::levels().back().level)) {
+      graph_tile_ptr tile = reader.GetGraphTile(id);
+      if (tile == nullptr) {
+        continue;
+      }
+      local_.push_back({id.value, 0, tile->header()->directededgecount()});
+      if (reader.OverCommitted()) {
+        reader.Trim();
+      }
+    }
+    // in the order of their ids, like the flagged tiles, so both can be looked up either way
+    std::sort(local_.begin(), local_.end(),
+              [](const ArcFlags::tile_t& a, const ArcFlags::tile_t& b) { return a.id < b.id; });
+    for (auto& tile : local_) {
+      tile.offset = edge_count_;
+      edge_count_ += tile.edge_count;
+    }
+  }
+
+  // The number of an edge, kNoEdge if it isn't in any of the tiles
+  uint32_t edge(const GraphId& id) const {
+    const auto& tiles =
+        id.level() == TileHierarchy::levels().back().level ? local_ : arc_flags_.tiles();
+    const uint64_t tile_id = id.Tile_Base().value;
+    auto tile = std::lower_bound(tiles.cbegin(), tiles.cend(), tile_id,
+                                 [](const ArcFlags::tile_t& t, uint64_t i) { return t.id < i; });
+    return tile != tiles.cend() && tile->id == tile_id ? tile->offset + id.id() : kNoEdge;
+  }
+
+  // The edge with a number
+  GraphId id(const uint32_t edge) const {
+    const auto& tiles = edge < arc_flags_.edge_count() ? arc_flags_.tiles() : local_;
+    auto tile = std::upper_bound(tiles.cbegin(), tiles.cend(), edge,
+                                 [](uint32_t e, const ArcFlags::tile_t& t) {
+                                   return e < t.offset;
+                                 }) -
+                1;
+    return GraphId(tile->id) + (edge - tile->offset);
+  }
+
+  // Whether an edge with a number gets flags
+  bool flagged(const uint32_t edge) const {
+    return edge < arc_flags_.edge_count();
+  }
+
+  uint32_t edge_count() const {
+    return edge_count_;
+  }
+
+protected:
+  const ArcFlags& arc_flags_;
+  std::vector<ArcFlags::tile_t> local_;
+  uint32_t edge_count_;
+};
+
+/**
+ * Grows shortest path trees over the edges of all levels, with the costs, turn costs and complex
+ * restrictions of the costing, from boundary edges and flags the edges of the flagged levels on
+ * them with the region of the boundary edge. The edges into a region are searched against the
+ * edges from an edge entering it, the ones out of a region along them from an edge leaving it
+ */
+class flag_search_t {
+public:
+  flag_search_t(const boost::property_tree::ptree& pt,
+                const valhalla::CostingOptions& costing_options,
+                const ArcFlags& arc_flags,
+                const numbering_t& numbering)
+      : reader_(pt.get_child("mjolnir")), costing_(CostFactory().Create(costing_options)),
+        arc_flags_(arc_flags), numbering_(numbering), costs_(numbering.edge_count()),
+        parents_(numbering.edge_count()), into_(arc_flags.edge_count(), 0),
+        out_of_(arc_flags.edge_count(), 0) {
+  }
+
+  void Run(const boundary_t& boundary) {
+    std::fill(costs_.begin(), costs_.end(), -1.0f);
+    std::fill(parents_.begin(), parents_.end(), kNoEdge);
+
+    const GraphId start(boundary.edge);
+    graph_tile_ptr tile = reader_.GetGraphTile(start);
+    if (tile == nullptr) {
+      return;
+    }
+    Relax(start, costing_->EdgeCost(tile->directededge(start), tile).cost, kNoEdge);
+
+    while (!queue_.empty()) {
+      const auto label = queue_.top();
+      queue_.pop();
+      const GraphId edgeid(label.second);
+      const uint32_t index = numbering_.edge(edgeid);
+      if (label.first > costs_[index]) {
+        continue;
+      }
+      if (boundary.into) {
+        ExpandReverse(edgeid, index);
+      } else {
+        ExpandForward(edgeid, index);
+      }
+      if (reader_.OverCommitted()) {
+        reader_.Trim();
+      }
+    }
+
+    // The boundary edge and every edge some other edge is best followed by, or best comes after,
+    // is on a shortest path into or out of the region. Only the flagged levels keep that
+    auto& flags = boundary.into ? into_ : out_of_;
+    const auto bit = ArcFlags::flags_t(1) << boundary.region;
+    flags[numbering_.edge(start)] |= bit;
+    for (const auto parent : parents_) {
+      if (parent != kNoEdge && numbering_.flagged(parent)) {
+        flags[parent] |= bit;
+      }
+    }
+  }
+
+  const std::vector<ArcFlags::flags_t>& into() const {
+    return into_;
+  }
+
+  const std::vector<ArcFlags::flags_t>& out_of() const {
+    return out_of_;
+  }
+
+protected:
+  // labels an edge if it is cheaper than it was
+  void Relax(const GraphId& edgeid, const float cost, const uint32_t parent) {
+    const auto index = numbering_.edge(edgeid);
+    if (index != kNoEdge && (costs_[index] < 0.0f || cost < costs_[index])) {
+      costs_[index] = cost;
+      parents_[index] = parent;
+      queue_.emplace(cost, edgeid.value);
+    }
+  }
+
+  // Whether a complex restriction forbids taking an edge after the path to a settled one, like
+  // DynamicCost::Restricted does for the untimed routes the flags are for. Going forward the path
+  // leads up to the edge, in reverse it goes on from it and the restrictions are the ones of the
+  // opposing edges
+  bool Restricted(const DirectedEdge* edge,
+                  const GraphId& edgeid,
+                  const graph_tile_ptr& tile,
+                  const uint32_t pred_index,
+                  const bool forward) {
+    const auto mode = costing_->access_mode();
+    if (!((forward ? edge->end_restriction() : edge->start_restriction()) & mode)) {
+      return false;
+    }
+    auto path_edge = [this, forward](const uint32_t index) {
+      const GraphId id = numbering_.id(index);
+      return forward ? id : reader_.GetOpposingEdgeId(id);
+    };
+    for (const auto* cr : tile->GetRestrictions(forward, edgeid, mode)) {
+      if (cr->has_dt()) {
+        continue;
+      }
+      bool match = true;
+      uint32_t index = pred_index;
+      cr->WalkVias([&](const GraphId* via) {
+        if (index == kNoEdge || *via != path_edge(index)) {
+          match = false;
+          return WalkingVia::StopWalking;
+        }
+        index = parents_[index];
+        return WalkingVia::KeepWalking;
+      });
+      if (match && index != kNoEdge &&
+          path_edge(index) == (forward ? cr->from_graphid() : cr->to_graphid())) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // the nodes at the same place on the other levels, where a path can go on without cost
+  template <typename expand_t>
+  void ForEachLevel(const GraphId& node, const expand_t& expand) {
+    graph_tile_ptr tile = reader_.GetGraphTile(node);
+    if (tile == nullptr) {
+      return;
+    }
+    const NodeInfo* nodeinfo = tile->node(node);
+    expand(node, nodeinfo, tile);
+    for (const auto& transition : tile->GetNodeTransitions(nodeinfo)) {
+      graph_tile_ptr trans_tile = reader_.GetGraphTile(transition.endnode());
+      if (trans_tile != nullptr) {
+        expand(transition.endnode(), trans_tile->node(transition.endnode()), trans_tile);
+      }
+    }
+  }
+
+  // labels the edges that can follow the one that was settled
+  void ExpandForward(const GraphId& pred_id, const uint32_t pred_index) {
+    graph_tile_ptr tile = reader_.GetGraphTile(pred_id);
+    if (tile == nullptr) {
+      return;
+    }
+    const DirectedEdge* pred_edge = tile->directededge(pred_id);
+    const EdgeLabel pred(kInvalidLabel, pred_id, pred_edge, {}, 0.0f, 0.0f,
+                         costing_->travel_mode(), 0, {}, -1, true, false, InternalTurn::kNoTurn);
+    const GraphId end_node = pred_edge->endnode();
+    ForEachLevel(end_node, [&](const GraphId& node, const NodeInfo* nodeinfo,
+                               const graph_tile_ptr& node_tile) {
+      if (!costing_->Allowed(nodeinfo)) {
+        return;
+      }
+      GraphId edgeid(node.tileid(), node.level(), nodeinfo->edge_index());
+      const DirectedEdge* edge = node_tile->directededge(nodeinfo->edge_index());
+      for (uint32_t i = 0; i < nodeinfo->edge_count(); ++i, ++edge, ++edgeid) {
+        uint8_t restriction_idx = -1;
+        if ((node == end_node && edge->localedgeidx() == pred_edge->opp_local_idx()) ||
+            edge->is_shortcut() ||
+            !costing_->Allowed(edge, false, pred, node_tile, edgeid, 0, 0, restriction_idx) ||
+            Restricted(edge, edgeid, node_tile, pred_index, true)) {
+          continue;
+        }
+        const float cost = costs_[pred_index] +
+                           costing_->TransitionCost(edge, nodeinfo, pred).cost +
+                           costing_->EdgeCost(edge, node_tile).cost;
+        Relax(edgeid, cost, pred_index);
+      }
+    });
+  }
+
+  // labels the edges that can come before the one that was settled
+  void ExpandReverse(const GraphId& pred_id, const uint32_t pred_index) {
+    graph_tile_ptr tile = reader_.GetGraphTile(pred_id);
+    if (tile == nullptr) {
+      return;
+    }
+    const DirectedEdge* pred_edge = tile->directededge(pred_id);
+    const DirectedEdge* opp_pred_edge = nullptr;
+    graph_tile_ptr opp_pred_tile = tile;
+    const GraphId opp_pred_id = reader_.GetOpposingEdgeId(pred_id, opp_pred_edge, opp_pred_tile);
+    if (opp_pred_edge == nullptr) {
+      return;
+    }
+    const EdgeLabel pred(kInvalidLabel, opp_pred_id, opp_pred_edge, {}, 0.0f, 0.0f,
+                         costing_->travel_mode(), 0, {}, -1, true, false, InternalTurn::kNoTurn);
+    const GraphId begin_node = opp_pred_edge->endnode();
+    ForEachLevel(begin_node, [&](const GraphId& node, const NodeInfo* nodeinfo,
+                                 const graph_tile_ptr& node_tile) {
+      if (!costing_->Allowed(nodeinfo)) {
+        return;
+      }
+      GraphId edgeid(node.tileid(), node.level(), nodeinfo->edge_index());
+      const DirectedEdge* edge = node_tile->directededge(nodeinfo->edge_index());
+      for (uint32_t i = 0; i < nodeinfo->edge_count(); ++i, ++edge, ++edgeid) {
+        if ((node == begin_node && edge->localedgeidx() == pred_edge->opp_local_idx()) ||
+            edge->is_shortcut()) {
+          continue;
+        }
+        // the edge that comes in to the node is the opposing edge of the one that leaves it
+        const DirectedEdge* opp_edge = nullptr;
+        graph_tile_ptr opp_tile = node_tile;
+        const GraphId opp_id = reader_.GetOpposingEdgeId(edgeid, opp_edge, opp_tile);
+        uint8_t restriction_idx = -1;
+        if (opp_edge == nullptr ||
+            !costing_->AllowedReverse(edge, pred, opp_edge, opp_tile, opp_id, 0, 0,
+                                      restriction_idx) ||
+            Restricted(edge, edgeid, node_tile, pred_index, false)) {
+          continue;
+        }
+        const float cost =
+            costs_[pred_index] +
+            costing_->TransitionCostReverse(edge->localedgeidx(), nodeinfo, opp_edge, pred_edge)
+                .cost +
+            costing_->EdgeCost(opp_edge, opp_tile).cost;
+        Relax(opp_id, cost, pred_index);
+      }
+    });
+  }
+
+  using label_t = std::pair<float, uint64_t>;
+
+  GraphReader reader_;
+  std::shared_ptr<DynamicCost> costing_;
+  const ArcFlags& arc_flags_;
+  const numbering_t& numbering_;
+  std::priority_queue<label_t, std::vector<label_t>, std::greater<label_t>> queue_;
+  std::vector<float> costs_;
+  std::vector<uint32_t> parents_;
+  std::vector<ArcFlags::flags_t> into_;
+  std::vector<ArcFlags::flags_t> out_of_;
+};
+
+// Searches from the boundary edges in the queue until it runs out, each thread flags the edges in
+// arrays of its own which are merged once they are all done
+void flag_edges(const boost::property_tree::ptree& pt,
+                const valhalla::CostingOptions& costing_options,
+                const ArcFlags& arc_flags,
+                const numbering_t& numbering,
+                std::vector<boundary_t>& boundaries,
+                std::mutex& lock,
+                std::promise<std::pair<std::vector<ArcFlags::flags_t>,
+                                       std::vector<ArcFlags::flags_t>>>& result) {
+  try {
+    flag_search_t search(pt, costing_options, arc_flags, numbering);
+    while (true) {
+      boundary_t boundary;
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        if (boundaries.empty()) {
+          break;
+        }
+        boundary = boundaries.back();
+        boundaries.pop_back();
+        if (boundaries.size() % 1000 == 0) {
+          LOG_INFO(std::to_string(boundaries.size()) + " boundary edges left to search from");
+        }
+      }
+      search.Run(boundary);
+    }
+    result.set_value({search.into(), search.out_of()});
+  } catch (...) { result.set_exception(std::current_exception()); }
+}
+
+} // namespace
+
+namespace valhalla {
+namespace mjolnir {
+
+void ArcFlagBuilder::Build(const boost::property_tree::ptree& pt) {
+  const auto arc_flags_file = pt.get<std::string>("mjolnir.arc_flags_file");
+
+  // The highway and arterial levels get flags, the local level is left to the hierarchy limits but
+  // the paths over it are searched all the same
+  std::vector<ArcFlags::tile_t> tiles;
+  AABB2<PointLL> bounds(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+                        std::numeric_limits<double>::lowest(),
+                        std::numeric_limits<double>::lowest());
+  GraphReader reader(pt.get_child("mjolnir"));
+  const auto& levels = TileHierarchy::levels();
+  for (size_t l = 0; l + 1 < levels.size(); ++l) {
+    for (const auto& id : reader.GetTileSet(levels[l].level)) {
+      graph_tile_ptr tile = reader.GetGraphTile(id);
+      if (tile == nullptr) {
+        continue;
+      }
+      tiles.push_back({id.value, 0, tile->header()->directededgecount()});
+      for (const auto& nodeinfo : tile->GetNodes()) {
+        bounds.Expand(nodeinfo.latlng(tile->header()->base_ll()));
+      }
+      if (reader.OverCommitted()) {
+        reader.Trim();
+      }
+    }
+  }
+  if (tiles.empty()) {
+    LOG_WARN("No highway or arterial tiles to flag");
+    return;
+  }
+  ArcFlags arc_flags(valhalla::Costing::auto_, bounds, std::move(tiles));
+
+  // Give every edge the regions of its own nodes and find the boundary edges that cross from one
+  // region into another
+  // The flags are for the auto costing with the options of a request that leaves them all out, the
+  // routes that prune with them have to ask for exactly those
+  const auto costing_options = DefaultCostingOptions(valhalla::Costing::auto_);
+  const auto costing = CostFactory().Create(costing_options);
+  std::vector<boundary_t> boundaries;
+  for (const auto& t : arc_flags.tiles()) {
+    graph_tile_ptr tile = reader.GetGraphTile(GraphId(t.id));
+    const auto base_ll = tile->header()->base_ll();
+    for (uint32_t n = 0; n < tile->header()->nodecount(); ++n) {
+      const NodeInfo& nodeinfo = *tile->node(n);
+      const auto begin_region = arc_flags.Region(nodeinfo.latlng(base_ll));
+      for (uint32_t i = 0; i < nodeinfo.edge_count(); ++i) {
+        const GraphId edgeid(GraphId(t.id).tileid(), GraphId(t.id).level(),
+                             nodeinfo.edge_index() + i);
+        const DirectedEdge* edge = tile->directededge(edgeid);
+        auto& flags = arc_flags.flags(t.offset + edgeid.id());
+        if (edge->is_shortcut() || !costing->Allowed(edge, tile)) {
+          flags = {ArcFlags::kAllRegions, ArcFlags::kAllRegions};
+          continue;
+        }
+        graph_tile_ptr end_tile = tile;
+        const NodeInfo* end_node = reader.nodeinfo(edge->endnode(), end_tile);
+        if (end_node == nullptr) {
+          flags = {ArcFlags::kAllRegions, ArcFlags::kAllRegions};
+          continue;
+        }
+        const auto end_region = arc_flags.Region(end_node->latlng(end_tile->header()->base_ll()));
+        flags.to |= ArcFlags::flags_t(1) << end_region;
+        flags.from |= ArcFlags::flags_t(1) << begin_region;
+        if (begin_region != end_region) {
+          boundaries.push_back({edgeid.value, true, end_region});
+          boundaries.push_back({edgeid.value, false, begin_region});
+        }
+        // The searches keep one path per edge so the way around a complex restriction they find
+        // isnt always the one a route would take, the edges it starts or ends on are never pruned
+        if ((edge->start_restriction() | edge->end_restriction()) & costing->access_mode()) {
+          flags = {ArcFlags::kAllRegions, ArcFlags::kAllRegions};
+        }
+      }
+    }
+    if (reader.OverCommitted()) {
+      reader.Trim();
+    }
+  }
+  std::sort(boundaries.begin(), boundaries.end());
+  boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+  numbering_t numbering(arc_flags, reader);
+
+  // Setup threads
+  uint32_t nthreads =
+      std::max(static_cast<unsigned int>(1),
+               pt.get<unsigned int>("mjolnir.concurrency", std::thread::hardware_concurrency()));
+  std::vector<std::shared_ptr<std::thread>> threads(nthreads);
+  std::vector<
+      std::promise<std::pair<std::vector<ArcFlags::flags_t>, std::vector<ArcFlags::flags_t>>>>
+      results(nthreads);
+  std::mutex lock;
+
+  LOG_INFO("Flagging " + std::to_string(arc_flags.edge_count()) + " edges from " +
+           std::to_string(boundaries.size()) + " boundary edges with " + std::to_string(nthreads) +
+           " threads...");
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i].reset(new std::thread(flag_edges, std::cref(pt), std::cref(costing_options),
+                                     std::cref(arc_flags), std::cref(numbering),
+                                     std::ref(boundaries), std::ref(lock), std::ref(results[i])));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+
+  // Merge the flags of all the threads
+  for (auto& result : results) {
+    const auto flags = result.get_future().get();
+    for (uint32_t i = 0; i < arc_flags.edge_count(); ++i) {
+      arc_flags.flags(i).to |= flags.first[i];
+      arc_flags.flags(i).from |= flags.second[i];
+    }
+  }
+
+  arc_flags.Save(arc_flags_file);
+  LOG_INFO("Wrote arc flags to " + arc_flags_file);
+}
+
+} // namespace mjolnir
+} // namespace valhalla
@@ -0,0 +1,1658 @@
+#include "mjolnir/compiledtagtransform.h"
+#include "midgard/logging.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace valhalla::mjolnir;
+
+namespace {
+
+// stands in for lua's nil in the numeric rule tables, note that 0 is truthy in lua
+constexpr int kNil = -1;
+
+/**
+ * A static string -> value table which finds a hash seed at construction time for which none of
+ * its keys collide, lookups are then a single hash and string compare.
+ */
+template <typename value_t> class perfect_hash_t {
+public:
+  perfect_hash_t(std::initializer_list<std::pair<const char*, value_t>> entries) {
+    size_t size = 1;
+    while (size < entries.size() * 2) {
+      size <<= 1;
+    }
+    for (seed_ = 0;; ++seed_) {
+      // widen the table every so often if we cant find a seed
+      if (seed_ && seed_ % 1024 == 0) {
+        size <<= 1;
+      }
+      slots_.assign(size, {std::string(), value_t{}});
+      used_.assign(size, false);
+      bool collision = false;
+      for (const auto& entry : entries) {
+        auto slot = hash(entry.first, strlen(entry.first)) & (size - 1);
+        if (used_[slot]) {
+          collision = true;
+          break;
+        }
+        used_[slot] = true;
+        slots_[slot] = {entry.first, entry.second};
+      }
+      if (!collision) {
+        break;
+      }
+    }
+  }
+
+  const value_t* find(const std::string* key) const {
+    if (key == nullptr) {
+      return nullptr;
+    }
+    auto slot = hash(key->data(), key->size()) & (slots_.size() - 1);
+    return used_[slot] && slots_[slot].first == *key ? &slots_[slot].second : nullptr;
+  }
+
+  // mimics table[key] in lua where a missing key or nil key is nil
+  value_t get(const std::string* key, const value_t& nil) const {
+    const auto* value = find(key);
+    return value ? *value : nil;
+  }
+
+private:
+  uint64_t hash(const char* key, size_t length) const {
+    // fnv-1a seeded
+    uint64_t hash = 14695981039346656037ull ^ (seed_ * 0x9E3779B97F4A7C15ull);
+    for (size_t i = 0; i < length; ++i) {
+      hash ^= static_cast<uint8_t>(key[i]);
+      hash *= 1099511628211ull;
+    }
+    return hash ^ (hash >> 29);
+  }
+
+  uint64_t seed_;
+  std::vector<std::pair<std::string, value_t>> slots_;
+  std::vector<bool> used_;
+};
+
+// lua truthiness of a tag is just its existence
+const std::string* find(const Tags& tags, const char* key) {
+  auto tag = tags.find(key);
+  return tag == tags.cend() ? nullptr : &tag->second;
+}
+
+bool equals(const Tags& tags, const char* key, const char* value) {
+  const auto* tag = find(tags, key);
+  return tag && *tag == value;
+}
+
+// lua's a or b
+int either(int a, int b) {
+  return a != kNil ? a : b;
+}
+
+// assigning nil to a key in lua removes it
+void assign(Tags& tags, const char* key, int value) {
+  if (value == kNil) {
+    tags.erase(key);
+  } else {
+    tags[key] = std::to_string(value);
+  }
+}
+
+// see restriction_prefix in lua/graph.lua, returns the restriction type before the @
+bool restriction_prefix(const std::string* restriction, std::string& prefix) {
+  if (restriction == nullptr) {
+    return false;
+  }
+  size_t index = 0;
+  for (const char c : *restriction) {
+    if (c == '@') {
+      prefix = restriction->substr(0, index);
+      return true;
+    }
+    if (c != ' ') {
+      ++index;
+    }
+  }
+  return false;
+}
+
+// see restriction_suffix in lua/graph.lua, returns the conditions after the @
+bool restriction_suffix(const std::string* restriction, std::string& suffix) {
+  if (restriction == nullptr) {
+    return false;
+  }
+  // index is the 1-based lua position
+  size_t index = 0;
+  bool found = false;
+  for (const char c : *restriction) {
+    if (found) {
+      if (c != ' ') {
+        ++index;
+        break;
+      }
+    } else if (c == '@') {
+      found = true;
+    }
+    ++index;
+  }
+  if (!found) {
+    return false;
+  }
+  suffix = restriction->substr(index - 1);
+  return true;
+}
+
+// lua's a or b for strings, nullptr standing in for nil
+const char* either(const char* a, const char* b) {
+  return a ? a : b;
+}
+
+// the lua value of a tag, nil if it isnt there
+const char* value(const Tags& tags, const char* key) {
+  const auto* tag = find(tags, key);
+  return tag ? tag->c_str() : nullptr;
+}
+
+// the "true"/"false" strings the way rule tables of the lua hold, any non zero mask is true
+const char* boolean(int value) {
+  return value == kNil ? nullptr : (value ? "true" : "false");
+}
+
+// kv[key] = value in lua where nil removes the key
+void set(Tags& tags, const char* key, const char* value) {
+  if (value == nullptr) {
+    tags.erase(key);
+    return;
+  }
+  auto& tag = tags[key];
+  if (tag.c_str() != value) {
+    tag = value;
+  }
+}
+
+// same as above for the normalized numbers, which are empty when they are nil
+void set_number(Tags& tags, const char* key, const std::string& value) {
+  if (value.empty()) {
+    tags.erase(key);
+  } else {
+    tags[key] = value;
+  }
+}
+
+// swaps two values in lua, either of which may be nil
+void swap(Tags& tags, const char* a, const char* b) {
+  auto first = tags.find(a);
+  auto second = tags.find(b);
+  if (first != tags.end() && second != tags.end()) {
+    std::swap(first->second, second->second);
+  } else if (first != tags.end() || second != tags.end()) {
+    auto existing = first != tags.end() ? first : second;
+    std::string value = std::move(existing->second);
+    tags.erase(existing);
+    tags.emplace(first != tags.end() ? b : a, std::move(value));
+  }
+}
+
+// lua converts numbers to strings with %.14g
+std::string number(double value) {
+  if (std::isnan(value)) {
+    return "nan";
+  }
+  if (std::isinf(value)) {
+    return value < 0 ? "-inf" : "inf";
+  }
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.14g", value);
+  return buffer;
+}
+
+// see round in lua/graph.lua
+double round_to(double value, int places) {
+  const double scale = std::pow(10.0, places);
+  return std::floor(value * scale + 0.5) / scale;
+}
+
+// lua's %s
+bool is_space(char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+bool is_digit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+// lua's tonumber, surrounding whitespace is allowed but nothing else
+bool to_number(const std::string& str, double& number) {
+  auto begin = str.cbegin();
+  auto end = str.cend();
+  while (begin != end && is_space(*begin)) {
+    ++begin;
+  }
+  while (end != begin && is_space(*(end - 1))) {
+    --end;
+  }
+  if (begin == end) {
+    return false;
+  }
+  const std::string trimmed(begin, end);
+  char* parsed = nullptr;
+  number = strtod(trimmed.c_str(), &parsed);
+  return parsed == trimmed.c_str() + trimmed.size();
+}
+
+// see numeric_prefix in lua/graph.lua, empty if there were no numbers
+std::string numeric_prefix(const std::string& str, bool allow_decimals) {
+  size_t index = 0;
+  bool seen_dot = false;
+  for (const char c : str) {
+    if (!is_digit(c)) {
+      if (c != '.' || !allow_decimals || seen_dot) {
+        break;
+      }
+      seen_dot = true;
+    }
+    ++index;
+  }
+  return str.substr(0, index);
+}
+
+bool ends_with(const std::string& str, const char* suffix) {
+  const size_t length = strlen(suffix);
+  return str.size() >= length && str.compare(str.size() - length, length, suffix) == 0;
+}
+
+// see normalize_speed in lua/graph.lua, empty if there is no sensible speed
+std::string normalize_speed(const std::string* speed) {
+  double num;
+  if (speed == nullptr || !to_number(numeric_prefix(*speed, false), num)) {
+    return {};
+  }
+  if (ends_with(*speed, "mph")) {
+    num = std::floor(num * 1.609344 + 0.5);
+  }
+  // if num > 150kph or num < 10kph....toss
+  return num > 150 || num < 10 ? std::string() : number(num);
+}
+
+// see normalize_weight in lua/graph.lua, empty if there is no weight
+std::string normalize_weight(const std::string* weight) {
+  if (weight == nullptr) {
+    return {};
+  }
+  std::string w;
+  std::copy_if(weight->cbegin(), weight->cend(), std::back_inserter(w),
+               [](char c) { return !is_space(c); });
+  const auto num = numeric_prefix(w, true);
+  if (num.empty()) {
+    return {};
+  }
+  // a lone decimal point makes the lua fail and the way is dropped, see TransformWay
+  double tons;
+  if (!to_number(num, tons)) {
+    throw std::runtime_error("attempt to perform arithmetic on a nil value in normalize_weight");
+  }
+  if (w == num + "lb" || w == num + "lbs") {
+    tons /= 2000;
+  } else if (w == num + "kg") {
+    tons /= 1000;
+  }
+  return number(round_to(tons, 2));
+}
+
+// see normalize_measurement in lua/graph.lua, meters or empty if it doesnt parse
+std::string normalize_measurement(const std::string* measurement) {
+  if (measurement == nullptr) {
+    return {};
+  }
+  // turn commas into dots to handle European-style decimal separators
+  std::string m = *measurement;
+  std::replace(m.begin(), m.end(), ',', '.');
+
+  // handle the simple case: it's just a plain number
+  double num;
+  if (to_number(m, num)) {
+    return number(round_to(num, 2));
+  }
+
+  // otherwise sum up the terms matching (%d+[.,]?%d*) *([a-zA-Z\"\']*) in meters
+  double sum = 0;
+  size_t count = 0;
+  for (size_t i = 0; i < m.size();) {
+    if (!is_digit(m[i])) {
+      ++i;
+      continue;
+    }
+    size_t j = i;
+    while (j < m.size() && is_digit(m[j])) {
+      ++j;
+    }
+    if (j < m.size() && m[j] == '.') {
+      ++j;
+      while (j < m.size() && is_digit(m[j])) {
+        ++j;
+      }
+    }
+    double item = 0;
+    to_number(m.substr(i, j - i), item);
+    while (j < m.size() && m[j] == ' ') {
+      ++j;
+    }
+    std::string unit;
+    for (; j < m.size() && (std::isalpha(static_cast<unsigned char>(m[j])) || m[j] == '"' ||
+                            m[j] == '\'');
+         ++j) {
+      unit.push_back(std::tolower(static_cast<unsigned char>(m[j])));
+    }
+    i = j;
+
+    if (unit == "m" || unit == "meter" || unit == "meters") {
+      sum += item;
+    } else if (unit == "cm") {
+      sum += item * 0.01;
+    } else if (unit == "ft" || unit == "feet" || unit == "foot" || unit == "'") {
+      sum += item * 0.3048;
+    } else if (unit == "in" || unit == "inches" || unit == "inch" || unit == "\"" ||
+               unit == "''") {
+      sum += item * 0.0254;
+    } else {
+      // unknown unit! bail!
+      return {};
+    }
+    ++count;
+  }
+  return count > 0 ? number(round_to(sum, 2)) : std::string();
+}
+
+// the access keys of the way modes in the order of the masks in the highway rule table
+constexpr size_t kModeCount = 8;
+const char* const kForward[kModeCount] = {"auto_forward",       "truck_forward",
+                                          "bus_forward",        "taxi_forward",
+                                          "moped_forward",      "motorcycle_forward",
+                                          "pedestrian_forward", "bike_forward"};
+const char* const kBackward[kModeCount] = {"auto_backward",       "truck_backward",
+                                           "bus_backward",        "taxi_backward",
+                                           "moped_backward",      "motorcycle_backward",
+                                           "pedestrian_backward", "bike_backward"};
+constexpr size_t kPedestrian = 6;
+
+// whether all of the keys are "false", nil is not
+bool all_false(const Tags& tags, std::initializer_list<const char*> keys) {
+  return std::all_of(keys.begin(), keys.end(),
+                     [&tags](const char* key) { return equals(tags, key, "false"); });
+}
+
+} // namespace
+
+namespace valhalla {
+namespace mjolnir {
+
+// the rule tables from lua/graph.lua that nodes_proc, ways_proc and rels_proc consult. the way
+// tables for modes that have a node mask table with the same keys (motor_vehicle, bicycle, foot
+// etc) use the mask table, any non zero mask being "true"
+struct CompiledTagTransform::rules_t {
+  // 1 for "true" and 0 for "false"
+  perfect_hash_t<int> access{
+      {"yes", 1},          {"private", 1},     {"no", 0},         {"permissive", 1},
+      {"agricultural", 0}, {"use_sidepath", 1}, {"delivery", 1},  {"designated", 1},
+      {"dismount", 1},     {"discouraged", 0}, {"forestry", 0},   {"destination", 1},
+      {"customers", 1},    {"official", 0},    {"public", 1},     {"restricted", 1},
+      {"allowed", 1},      {"emergency", 0},   {"psv", 0},        {"permit", 1},
+      {"residents", 1},
+  };
+  perfect_hash_t<int> privately{
+      {"private", 1},  {"destination", 1}, {"customers", 1},
+      {"delivery", 1}, {"permit", 1},      {"residents", 1},
+  };
+  perfect_hash_t<int> toll{
+      {"yes", 1}, {"no", 0},       {"true", 1},       {"false", 0},
+      {"1", 1},   {"interval", 1}, {"snowmobile", 1},
+  };
+  perfect_hash_t<int> restriction{
+      {"no_left_turn", 0},     {"no_right_turn", 1},  {"no_straight_on", 2},
+      {"no_u_turn", 3},        {"only_right_turn", 4}, {"only_left_turn", 5},
+      {"only_straight_on", 6}, {"no_entry", 7},       {"no_exit", 8},
+      {"no_turn", 9},
+  };
+  perfect_hash_t<int> motor_vehicle_node{
+      {"yes", 1},         {"private", 1},    {"no", 0},         {"permissive", 1},
+      {"agricultural", 0}, {"delivery", 1},  {"designated", 1}, {"discouraged", 0},
+      {"forestry", 0},    {"destination", 1}, {"customers", 1}, {"official", 0},
+      {"public", 1},      {"restricted", 1}, {"allowed", 1},    {"permit", 1},
+      {"residents", 1},
+  };
+  perfect_hash_t<int> bicycle_node{
+      {"yes", 4},         {"designated", 4}, {"use_sidepath", 4}, {"no", 0},
+      {"permissive", 4},  {"destination", 4}, {"dismount", 4},   {"lane", 4},
+      {"track", 4},       {"shared", 4},     {"shared_lane", 4}, {"sidepath", 4},
+      {"share_busway", 4}, {"none", 0},      {"allowed", 4},     {"private", 4},
+      {"official", 4},    {"permit", 4},     {"residents", 4},
+  };
+  perfect_hash_t<int> foot_node{
+      {"yes", 2},         {"private", 2},     {"no", 0},         {"permissive", 2},
+      {"agricultural", 0}, {"use_sidepath", 2}, {"delivery", 2}, {"designated", 2},
+      {"discouraged", 0}, {"forestry", 0},    {"destination", 2}, {"customers", 2},
+      {"official", 2},    {"public", 2},      {"restricted", 2}, {"crossing", 2},
+      {"sidewalk", 2},    {"allowed", 2},     {"passable", 2},   {"footway", 2},
+      {"permit", 2},      {"residents", 2},
+  };
+  perfect_hash_t<int> wheelchair_node{
+      {"no", 0},         {"yes", 256},     {"designated", 256}, {"limited", 256},
+      {"official", 256}, {"destination", 256}, {"public", 256}, {"permissive", 256},
+      {"only", 256},     {"private", 256}, {"impassable", 0},   {"partial", 0},
+      {"bad", 0},        {"half", 0},      {"assisted", 256},   {"permit", 256},
+      {"residents", 256},
+  };
+  perfect_hash_t<int> moped_node{
+      {"yes", 512},         {"designated", 512}, {"private", 512}, {"permissive", 512},
+      {"destination", 512}, {"delivery", 512},   {"dismount", 512}, {"no", 0},
+      {"unknown", 0},       {"agricultural", 0}, {"permit", 512},  {"residents", 512},
+  };
+  perfect_hash_t<int> motor_cycle_node{
+      {"yes", 1024},        {"private", 1024},   {"no", 0},          {"permissive", 1024},
+      {"agricultural", 0},  {"delivery", 1024},  {"designated", 1024}, {"discouraged", 0},
+      {"forestry", 0},      {"destination", 1024}, {"customers", 1024}, {"official", 0},
+      {"public", 1024},     {"restricted", 1024}, {"allowed", 1024},
+  };
+  perfect_hash_t<int> bus_node{
+      {"no", 0},          {"yes", 64},        {"designated", 64}, {"urban", 64}, {"permissive", 64},
+      {"restricted", 64}, {"destination", 64}, {"delivery", 0},   {"official", 0},
+  };
+  perfect_hash_t<int> taxi_node{
+      {"no", 0},          {"yes", 32},        {"designated", 32}, {"urban", 32}, {"permissive", 32},
+      {"restricted", 32}, {"destination", 32}, {"delivery", 0},   {"official", 0},
+  };
+  perfect_hash_t<int> truck_node{
+      {"designated", 8},  {"yes", 8},          {"no", 0},
+      {"destination", 8}, {"delivery", 8},     {"local", 8},
+      {"agricultural", 0}, {"private", 8},     {"discouraged", 0},
+      {"permissive", 0},  {"unsuitable", 0},   {"agricultural;forestry", 0},
+      {"official", 0},    {"forestry", 0},     {"destination;delivery", 8},
+      {"permit", 8},      {"residents", 8},
+  };
+  perfect_hash_t<int> psv_bus_node{
+      {"bus", 64},        {"no", 0}, {"yes", 64}, {"designated", 64},
+      {"permissive", 64}, {"1", 64}, {"2", 64},
+  };
+  perfect_hash_t<int> psv_taxi_node{
+      {"taxi", 32},       {"no", 0}, {"yes", 32}, {"designated", 32},
+      {"permissive", 32}, {"1", 32}, {"2", 32},
+  };
+  // the default access of the modes as bits in the order of kForward
+  perfect_hash_t<int> highway{
+      {"motorway", 47},      {"motorway_link", 47},     {"trunk", 255},
+      {"trunk_link", 255},   {"primary", 255},          {"primary_link", 255},
+      {"secondary", 255},    {"secondary_link", 255},   {"residential", 255},
+      {"residential_link", 255}, {"service", 255},      {"tertiary", 255},
+      {"tertiary_link", 255}, {"road", 255},            {"track", 255},
+      {"unclassified", 255}, {"undefined", 0},          {"unknown", 0},
+      {"living_street", 255}, {"footway", 64},          {"pedestrian", 64},
+      {"steps", 192},        {"bridleway", 0},          {"construction", 0},
+      {"cycleway", 128},     {"path", 192},             {"bus_guideway", 4},
+  };
+  perfect_hash_t<int> road_class{
+      {"motorway", 0},       {"motorway_link", 0},  {"trunk", 1},          {"trunk_link", 1},
+      {"primary", 2},        {"primary_link", 2},   {"secondary", 3},      {"secondary_link", 3},
+      {"tertiary", 4},       {"tertiary_link", 4},  {"unclassified", 5},   {"residential", 6},
+      {"residential_link", 6},
+  };
+  perfect_hash_t<int> no_thru_traffic{
+      {"destination", 1}, {"customers", 1}, {"delivery", 1}, {"permit", 1}, {"residents", 1},
+  };
+  perfect_hash_t<int> use{
+      {"driveway", 4},         {"alley", 5},         {"parking_aisle", 6},
+      {"emergency_access", 7}, {"drive-through", 8},
+  };
+  perfect_hash_t<int> psv{
+      {"bus", 1},        {"taxi", 1}, {"no", 0}, {"yes", 1}, {"designated", 1},
+      {"permissive", 1}, {"1", 1},    {"2", 1},
+  };
+  perfect_hash_t<int> hazmat{
+      {"designated", 1}, {"yes", 1}, {"no", 0}, {"destination", 1}, {"delivery", 1},
+  };
+  perfect_hash_t<int> shoulder{
+      {"yes", 1},
+      {"both", 1},
+      {"no", 0},
+  };
+  perfect_hash_t<int> cycleway{
+      {"yes", 1},         {"designated", 1},  {"use_sidepath", 1}, {"permissive", 1},
+      {"destination", 1}, {"dismount", 1},    {"lane", 1},         {"track", 1},
+      {"shared", 1},      {"shared_lane", 1}, {"sidepath", 1},     {"share_busway", 1},
+      {"allowed", 1},     {"private", 1},     {"cyclestreet", 1},  {"crossing", 1},
+  };
+  perfect_hash_t<int> bike_reverse{
+      {"opposite", 1},
+      {"opposite_lane", 1},
+      {"opposite_track", 1},
+  };
+  perfect_hash_t<int> bus_reverse{
+      {"opposite", 1},
+      {"opposite_lane", 1},
+  };
+  // the shared, dedicated and separated tables, their keys dont overlap
+  perfect_hash_t<int> cycle_lane{
+      {"shared_lane", 1},   {"share_busway", 1}, {"shared", 1},        {"opposite_lane", 2},
+      {"lane", 2},          {"buffered_lane", 2}, {"opposite_track", 3}, {"track", 3},
+  };
+  perfect_hash_t<int> oneway{
+      {"no", 0}, {"-1", 1}, {"yes", 1}, {"true", 1}, {"1", 1},
+  };
+  perfect_hash_t<int> bridge{
+      {"yes", 1},
+      {"no", 0},
+      {"1", 1},
+  };
+  perfect_hash_t<int> tunnel{
+      {"yes", 1},
+      {"no", 0},
+      {"1", 1},
+      {"building_passage", 1},
+  };
+};
+
+CompiledTagTransform::CompiledTagTransform() : rules_(new rules_t) {
+}
+
+CompiledTagTransform::~CompiledTagTransform() {
+}
+
+Tags CompiledTagTransform::Transform(OSMType type, uint64_t osmid, const Tags& tags) const {
+  switch (type) {
+    case OSMType::kNode:
+      return TransformNode(tags);
+    case OSMType::kWay:
+      return TransformWay(osmid, tags);
+    default:
+      return TransformRelation(tags);
+  }
+}
+
+// see nodes_proc in lua/graph.lua
+Tags CompiledTagTransform::TransformNode(const Tags& tags) const {
+  Tags kv = tags;
+  const auto& r = *rules_;
+
+  if (const auto* iso_tag = find(kv, "iso:3166_2")) {
+    const std::string iso = *iso_tag;
+    const auto dash = iso.find('-');
+    if (dash == 2) {
+      if (iso.size() == 6 || iso.size() == 5) {
+        kv["state_iso_code"] = iso.substr(3);
+      }
+    } else if (dash == std::string::npos) {
+      if (iso.size() == 2 || iso.size() == 3) {
+        kv["state_iso_code"] = iso;
+      } else if (iso.size() == 4 || iso.size() == 5) {
+        kv["state_iso_code"] = iso.substr(2);
+      }
+    }
+  }
+
+  // normalize a few tags that we care about
+  const auto* access_tag = find(kv, "access");
+  const int initial_access = r.access.get(access_tag, kNil);
+  bool access = initial_access != 0;
+  if (equals(kv, "impassable", "yes") ||
+      (equals(kv, "access", "private") &&
+       (equals(kv, "emergency", "yes") || equals(kv, "service", "emergency_access")))) {
+    access = false;
+  }
+
+  int hov_tag = kNil;
+  const auto* hov_value = find(kv, "hov");
+  if ((hov_value && *hov_value != "no") || find(kv, "hov:lanes") || find(kv, "hov:minimum")) {
+    hov_tag = 128;
+  }
+
+  const auto* psv = find(kv, "psv");
+  int foot_tag = r.foot_node.get(find(kv, "foot"), kNil);
+  int wheelchair_tag = r.wheelchair_node.get(find(kv, "wheelchair"), kNil);
+  int bike_tag = r.bicycle_node.get(find(kv, "bicycle"), kNil);
+  int truck_tag = r.truck_node.get(find(kv, "hgv"), kNil);
+  int auto_tag = r.motor_vehicle_node.get(find(kv, "motorcar"), kNil);
+  const int motor_vehicle_tag = r.motor_vehicle_node.get(find(kv, "motor_vehicle"), kNil);
+  int moped_tag = either(r.moped_node.get(find(kv, "moped"), kNil),
+                         r.moped_node.get(find(kv, "mofa"), kNil));
+  int motorcycle_tag = r.motor_cycle_node.get(find(kv, "motorcycle"), kNil);
+  auto_tag = either(auto_tag, motor_vehicle_tag);
+
+  int bus_tag = kNil, taxi_tag = kNil;
+  if (equals(kv, "access", "psv")) {
+    bus_tag = 64;
+    taxi_tag = 32;
+  } else {
+    bus_tag = r.bus_node.get(find(kv, "bus"), kNil);
+    taxi_tag = r.taxi_node.get(find(kv, "taxi"), kNil);
+  }
+
+  bus_tag = either(bus_tag, r.psv_bus_node.get(psv, kNil));
+  // if bus was not set and car is
+  if (bus_tag == kNil && auto_tag == 1) {
+    bus_tag = 64;
+  }
+  // if wheelchair was not set and foot is
+  if (wheelchair_tag == kNil && foot_tag == 2) {
+    wheelchair_tag = 256;
+  }
+  // if hov was not set and car is
+  if (hov_tag == kNil && auto_tag == 1) {
+    hov_tag = 128;
+  }
+  taxi_tag = either(taxi_tag, r.psv_taxi_node.get(psv, kNil));
+  // if taxi was not set and car is
+  if (taxi_tag == kNil && auto_tag == 1) {
+    taxi_tag = 32;
+  }
+  // if truck was not set and car is
+  if (truck_tag == kNil && auto_tag == 1) {
+    truck_tag = 8;
+  }
+
+  // must shut these off if motor_vehicle = 0
+  if (motor_vehicle_tag == 0) {
+    hov_tag = either(hov_tag, 0);
+    bus_tag = either(bus_tag, 0);
+    taxi_tag = either(taxi_tag, 0);
+    truck_tag = either(truck_tag, 0);
+    moped_tag = either(moped_tag, 0);
+    motorcycle_tag = either(motorcycle_tag, 0);
+  }
+
+  int emergency_tag = kNil;
+  if (equals(kv, "access", "emergency") || equals(kv, "emergency", "yes") ||
+      equals(kv, "service", "emergency_access")) {
+    emergency_tag = 16;
+  }
+
+  // do not shut off bike access if there is a highway crossing
+  if (bike_tag == 0 && equals(kv, "highway", "crossing")) {
+    bike_tag = 4;
+  }
+
+  // if tag exists use it, otherwise access allowed for all modes unless access = false or
+  // hov = designated or vehicle = no
+  int auto_mask = either(auto_tag, 1);
+  int truck = either(truck_tag, 8);
+  int bus = either(bus_tag, 64);
+  int taxi = either(taxi_tag, either(auto_tag, 32));
+  int foot = either(foot_tag, 2);
+  int wheelchair = either(wheelchair_tag, 256);
+  int bike = either(bike_tag, 4);
+  int emergency = either(emergency_tag, 16);
+  int hov = either(hov_tag, either(auto_tag, 128));
+  int moped = either(moped_tag, 512);
+  int motorcycle = either(motorcycle_tag, 1024);
+
+  // if access = false use tag if exists, otherwise no access for that mode
+  if (!access || equals(kv, "vehicle", "no") || equals(kv, "hov", "designated")) {
+    auto_mask = either(auto_tag, 0);
+    truck = either(truck_tag, 0);
+    bus = either(bus_tag, 0);
+    taxi = either(taxi_tag, 0);
+    // don't change ped if vehicle = no
+    if (!access || equals(kv, "hov", "designated")) {
+      foot = either(foot_tag, 0);
+    }
+    wheelchair = either(wheelchair_tag, 0);
+    bike = either(bike_tag, 0);
+    moped = either(moped_tag, 0);
+    motorcycle = either(motorcycle_tag, 0);
+    emergency = either(emergency_tag, 0);
+    hov = either(hov_tag, 0);
+  }
+
+  // check for gates, bollards, and sump_busters
+  const auto* barrier = find(kv, "barrier");
+  auto is_barrier = [barrier](const char* value) { return barrier && *barrier == value; };
+  bool gate = is_barrier("gate") || is_barrier("yes") || is_barrier("lift_gate") ||
+              is_barrier("swing_gate");
+  bool bollard = false;
+  bool sump_buster = false;
+  if (!gate) {
+    // if there was a bollard cars can't get through it
+    bollard = is_barrier("bollard") || is_barrier("block") || is_barrier("jersey_barrier") ||
+              equals(kv, "bollard", "removable");
+    // if sump_buster then no access for auto, hov, and taxi unless a tag exists
+    sump_buster = is_barrier("sump_buster");
+
+    // save the following as gates
+    if (bollard && equals(kv, "bollard", "rising")) {
+      gate = true;
+      bollard = false;
+    }
+
+    // bollard = true shuts off access when access is not originally specified
+    if (bollard && initial_access == kNil) {
+      auto_mask = either(auto_tag, 0);
+      truck = either(truck_tag, 0);
+      bus = either(bus_tag, 0);
+      taxi = either(taxi_tag, 0);
+      foot = either(foot_tag, 2);
+      wheelchair = either(wheelchair_tag, 256);
+      bike = either(bike_tag, 4);
+      moped = either(moped_tag, 0);
+      motorcycle = either(motorcycle_tag, 0);
+      emergency = either(emergency_tag, 0);
+      hov = either(hov_tag, 0);
+    } // sump_buster = true shuts off access unless the tag exists
+    else if (sump_buster) {
+      auto_mask = either(auto_tag, 0);
+      truck = either(truck_tag, 8);
+      bus = either(bus_tag, 64);
+      taxi = either(taxi_tag, 0);
+      foot = either(foot_tag, 2);
+      wheelchair = either(wheelchair_tag, 256);
+      bike = either(bike_tag, 4);
+      moped = either(moped_tag, 512);
+      motorcycle = either(motorcycle_tag, 1024);
+      emergency = either(emergency_tag, 16);
+      hov = either(hov_tag, 0);
+    }
+  }
+
+  // if nothing blocks access at this node assume access is allowed
+  if (!gate && !bollard && !sump_buster && access) {
+    if (equals(kv, "highway", "crossing") || equals(kv, "railway", "crossing") ||
+        equals(kv, "footway", "crossing") || equals(kv, "cycleway", "crossing") ||
+        equals(kv, "foot", "crossing") || equals(kv, "bicycle", "crossing") ||
+        equals(kv, "pedestrian", "crossing") || find(kv, "crossing")) {
+      auto_mask = either(auto_tag, 1);
+      truck = either(truck_tag, 8);
+      bus = either(bus_tag, 64);
+      taxi = either(taxi_tag, 32);
+      foot = either(foot_tag, 2);
+      wheelchair = either(wheelchair_tag, 256);
+      bike = either(bike_tag, 4);
+      moped = either(moped_tag, 512);
+      motorcycle = either(motorcycle_tag, 1024);
+      emergency = either(emergency_tag, 16);
+      hov = either(hov_tag, 128);
+    }
+  }
+
+  // store the gate and bollard info
+  kv["gate"] = gate ? "true" : "false";
+  kv["bollard"] = bollard ? "true" : "false";
+  kv["sump_buster"] = sump_buster ? "true" : "false";
+
+  if (is_barrier("border_control")) {
+    kv["border_control"] = "true";
+  } else if (is_barrier("toll_booth")) {
+    kv["toll_booth"] = "true";
+  } else if (equals(kv, "highway", "toll_gantry")) {
+    kv["toll_gantry"] = "true";
+  }
+
+  const bool coins = r.toll.get(find(kv, "payment:coins"), 0) == 1;
+  const bool notes = r.toll.get(find(kv, "payment:notes"), 0) == 1;
+
+  // assume cash for toll, toll:*, and fee
+  int cash = kNil;
+  for (const char* key : {"toll", "toll:hgv", "toll:bicycle", "toll:hov", "toll:motorcar",
+                          "toll:motor_vehicle", "toll:bus", "toll:motorcycle", "payment:cash",
+                          "fee"}) {
+    cash = either(cash, r.toll.get(find(kv, key), kNil));
+  }
+  int etc = kNil;
+  for (const char* key :
+       {"payment:e_zpass", "payment:e_zpass:name", "payment:pikepass", "payment:via_verde"}) {
+    etc = either(etc, r.toll.get(find(kv, key), kNil));
+  }
+
+  int cash_payment = 0;
+  if (cash == 1 || (coins && notes)) {
+    cash_payment = 3;
+  } else if (coins) {
+    cash_payment = 1;
+  } else if (notes) {
+    cash_payment = 2;
+  }
+  const int etc_payment = etc == 1 ? 4 : 0;
+
+  // store a mask denoting payment type
+  kv["payment_mask"] = std::to_string(cash_payment | etc_payment);
+
+  if (equals(kv, "amenity", "bicycle_rental") ||
+      (equals(kv, "shop", "bicycle") && equals(kv, "service:bicycle:rental", "yes"))) {
+    kv["bicycle_rental"] = "true";
+  }
+
+  const bool named = find(kv, "public_transport") == nullptr && find(kv, "name") != nullptr;
+  if (equals(kv, "traffic_signals:direction", "forward")) {
+    kv["forward_signal"] = "true";
+    if (named) {
+      kv["junction"] = "named";
+    }
+  }
+  if (equals(kv, "traffic_signals:direction", "backward")) {
+    kv["backward_signal"] = "true";
+    if (named) {
+      kv["junction"] = "named";
+    }
+  }
+  if (named) {
+    if (equals(kv, "highway", "traffic_signals")) {
+      if (!equals(kv, "junction", "yes")) {
+        kv["junction"] = "named";
+      }
+    } else if (equals(kv, "junction", "yes") || equals(kv, "reference_point", "yes")) {
+      kv["junction"] = "named";
+    }
+  }
+
+  const int is_private = either(r.privately.get(find(kv, "access"), kNil),
+                                r.privately.get(find(kv, "motor_vehicle"), kNil));
+  kv["private"] = is_private == 1 ? "true" : "false";
+
+  // store a mask denoting access
+  kv["access_mask"] = std::to_string(auto_mask | emergency | truck | bike | foot | wheelchair |
+                                     bus | hov | moped | motorcycle | taxi);
+
+  // if no information about access is given
+  const bool untagged = initial_access == kNil && auto_tag == kNil && truck_tag == kNil &&
+                        bus_tag == kNil && taxi_tag == kNil && foot_tag == kNil &&
+                        wheelchair_tag == kNil && bike_tag == kNil && moped_tag == kNil &&
+                        motorcycle_tag == kNil && emergency_tag == kNil && hov_tag == kNil;
+  kv["tagged_access"] = untagged ? "0" : "1";
+
+  return kv;
+}
+
+// see ways_proc in lua/graph.lua
+Tags CompiledTagTransform::TransformWay(uint64_t osmid, const Tags& tags) const {
+  // if there were no tags passed in, ie keyvalues is empty
+  if (tags.empty()) {
+    return {};
+  }
+  Tags kv = tags;
+  try {
+    return FilterWay(kv) ? Tags{} : kv;
+  } catch (const std::exception& e) {
+    // the lua fails on the same values and the way gets no tags
+    LOG_ERROR("Exception in compiled tag transform for way " + std::to_string(osmid) + ": " +
+              e.what());
+  }
+  return {};
+}
+
+// see filter_tags_generic in lua/graph.lua
+bool CompiledTagTransform::FilterWay(Tags& kv) const {
+  const auto& r = *rules_;
+  if (equals(kv, "highway", "construction") || equals(kv, "highway", "proposed")) {
+    return true;
+  }
+
+  // figure out what basic type of road it is
+  const bool highway = find(kv, "highway") != nullptr;
+  const int forward = r.highway.get(find(kv, "highway"), kNil);
+  const bool ferry = equals(kv, "route", "ferry");
+  const bool rail = equals(kv, "route", "shuttle_train");
+  const int access = r.access.get(find(kv, "access"), kNil);
+
+  kv["emergency_forward"] = "false";
+  kv["emergency_backward"] = "false";
+
+  if (ferry || rail || highway) {
+    if (equals(kv, "access", "emergency") || equals(kv, "emergency", "yes") ||
+        equals(kv, "service", "emergency_access")) {
+      kv["emergency_forward"] = "true";
+      kv["emergency_tag"] = "true";
+    }
+    if (equals(kv, "emergency", "no")) {
+      kv["emergency_tag"] = "false";
+    }
+  }
+
+  const bool blocked =
+      equals(kv, "impassable", "yes") || access == 0 ||
+      (equals(kv, "access", "private") &&
+       (equals(kv, "emergency", "yes") || equals(kv, "service", "emergency_access")));
+  auto shut_off = [&kv](bool pedestrian) {
+    for (size_t i = 0; i < kModeCount; ++i) {
+      if (pedestrian || i != kPedestrian) {
+        kv[kForward[i]] = "false";
+        kv[kBackward[i]] = "false";
+      }
+    }
+  };
+
+  // the tags that override the default access of each mode
+  const char* motor_vehicle = boolean(r.motor_vehicle_node.get(find(kv, "motor_vehicle"), kNil));
+  const char* auto_tag =
+      either(boolean(r.motor_vehicle_node.get(find(kv, "motorcar"), kNil)), motor_vehicle);
+  const char* hgv = boolean(r.truck_node.get(find(kv, "hgv"), kNil));
+  const char* truck_tag = either(hgv, motor_vehicle);
+  const char* psv = either(boolean(r.psv.get(find(kv, "psv"), kNil)),
+                           boolean(r.psv.get(find(kv, "lanes:psv:forward"), kNil)));
+  const char* bus_tag =
+      either(boolean(r.bus_node.get(find(kv, "bus"), kNil)), either(psv, motor_vehicle));
+  const char* taxi_tag =
+      either(boolean(r.taxi_node.get(find(kv, "taxi"), kNil)), either(psv, motor_vehicle));
+  const char* foot_tag = either(boolean(r.foot_node.get(find(kv, "foot"), kNil)),
+                                boolean(r.foot_node.get(find(kv, "pedestrian"), kNil)));
+  const char* bike_tag =
+      either(either(boolean(r.bicycle_node.get(find(kv, "bicycle"), kNil)),
+                    boolean(r.cycleway.get(find(kv, "cycleway"), kNil))),
+             either(boolean(r.bicycle_node.get(find(kv, "bicycle_road"), kNil)),
+                    boolean(r.bicycle_node.get(find(kv, "cyclestreet"), kNil))));
+  const char* moped_tag = either(boolean(r.moped_node.get(find(kv, "moped"), kNil)),
+                                 either(boolean(r.moped_node.get(find(kv, "mofa"), kNil)),
+                                        motor_vehicle));
+  const char* motorcycle_tag =
+      either(boolean(r.motor_vehicle_node.get(find(kv, "motorcycle"), kNil)), motor_vehicle);
+
+  bool overrides = true;
+  if (forward != kNil) {
+    for (size_t i = 0; i < kModeCount; ++i) {
+      kv[kForward[i]] = (forward & (1 << i)) ? "true" : "false";
+    }
+    if (blocked) {
+      shut_off(true);
+    } else if (equals(kv, "vehicle", "no")) { // don't change ped access.
+      shut_off(false);
+    }
+
+    // the tags override the access of the highway type
+    set(kv, "auto_forward", either(auto_tag, value(kv, "auto_forward")));
+    set(kv, "truck_forward", either(truck_tag, value(kv, "truck_forward")));
+    set(kv, "bus_forward", either(bus_tag, value(kv, "bus_forward")));
+    set(kv, "taxi_forward", either(taxi_tag, value(kv, "taxi_forward")));
+    set(kv, "pedestrian_forward", either(foot_tag, value(kv, "pedestrian_forward")));
+    set(kv, "bike_forward", either(bike_tag, value(kv, "bike_forward")));
+    set(kv, "moped_forward", either(moped_tag, value(kv, "moped_forward")));
+    set(kv, "motorcycle_forward", either(motorcycle_tag, value(kv, "motorcycle_forward")));
+  } else if ((!ferry && !rail) || blocked) {
+    shut_off(true);
+    overrides = false;
+  } else {
+    // if its a ferry and these tags dont show up we want to set them to true
+    const char* default_val = equals(kv, "vehicle", "no") ? "false" : "true";
+    set(kv, "auto_forward", either(auto_tag, default_val));
+    set(kv, "truck_forward", either(hgv, either(value(kv, "truck_forward"),
+                                                either(motor_vehicle, default_val))));
+    set(kv, "bus_forward", either(bus_tag, default_val));
+    set(kv, "taxi_forward", either(taxi_tag, default_val));
+    set(kv, "pedestrian_forward", either(foot_tag, "true"));
+    set(kv, "bike_forward", either(bike_tag, default_val));
+    set(kv, "moped_forward", either(moped_tag, default_val));
+    set(kv, "motorcycle_forward", either(motorcycle_tag, default_val));
+  }
+
+  if (overrides) {
+    set(kv, "auto_tag", auto_tag);
+    set(kv, "truck_tag", truck_tag);
+    set(kv, "bus_tag", bus_tag);
+    set(kv, "taxi_tag", taxi_tag);
+    set(kv, "foot_tag", foot_tag);
+    set(kv, "bike_tag", bike_tag);
+    set(kv, "moped_tag", moped_tag);
+    set(kv, "motorcycle_tag", motorcycle_tag);
+
+    if (!find(kv, "bike_tag")) {
+      if (equals(kv, "sac_scale", "hiking")) {
+        kv["bike_forward"] = "true";
+        kv["bike_tag"] = "true";
+      } else if (find(kv, "sac_scale")) {
+        kv["bike_forward"] = "false";
+      }
+    }
+
+    if (equals(kv, "access", "psv")) {
+      kv["taxi_forward"] = "true";
+      kv["taxi_tag"] = "true";
+      kv["bus_forward"] = "true";
+      kv["bus_tag"] = "true";
+    }
+
+    if (equals(kv, "motorroad", "yes")) {
+      kv["motorroad_tag"] = "true";
+    }
+  }
+
+  // TODO: handle Time conditional restrictions if available for HOVs with oneway = reversible
+  if ((equals(kv, "access", "permissive") || equals(kv, "access", "hov") ||
+       equals(kv, "access", "taxi")) &&
+      equals(kv, "oneway", "reversible")) {
+    // for now enable only for buses if the tag exists and they are allowed.
+    if (!equals(kv, "bus_forward", "true")) {
+      return true;
+    }
+    for (const char* key : {"auto_forward", "truck_forward", "pedestrian_forward", "bike_forward",
+                            "moped_forward", "motorcycle_forward"}) {
+      kv[key] = "false";
+    }
+  }
+
+  // service=driveway means all are routable
+  if (equals(kv, "service", "driveway") && !find(kv, "access")) {
+    for (const char* key : kForward) {
+      kv[key] = "true";
+    }
+  }
+
+  // check the oneway-ness and traversability against the direction of the geom
+  if ((equals(kv, "oneway", "yes") && equals(kv, "oneway:bicycle", "no")) ||
+      equals(kv, "bicycle:backward", "yes") || equals(kv, "bicycle:backward", "no")) {
+    kv["bike_backward"] = "true";
+  }
+  if (!find(kv, "bike_backward") || equals(kv, "bike_backward", "false")) {
+    const int reverse = either(r.bike_reverse.get(find(kv, "cycleway"), kNil),
+                               either(r.bike_reverse.get(find(kv, "cycleway:left"), kNil),
+                                      r.bike_reverse.get(find(kv, "cycleway:right"), kNil)));
+    kv["bike_backward"] = boolean(either(reverse, 0));
+  }
+  int oneway_bike = kNil;
+  if (equals(kv, "bike_backward", "true")) {
+    oneway_bike = r.oneway.get(find(kv, "oneway:bicycle"), kNil);
+  }
+
+  if (!find(kv, "oneway:bus") && find(kv, "oneway:psv")) {
+    kv["oneway:bus"] = kv["oneway:psv"];
+  }
+  if ((equals(kv, "oneway", "yes") && equals(kv, "oneway:bus", "no")) ||
+      equals(kv, "bus:backward", "yes") || equals(kv, "bus:backward", "designated")) {
+    kv["bus_backward"] = "true";
+  }
+  if (!find(kv, "bus_backward") || equals(kv, "bus_backward", "false")) {
+    const int reverse = either(either(r.bus_reverse.get(find(kv, "busway"), kNil),
+                                      r.bus_reverse.get(find(kv, "busway:left"), kNil)),
+                               either(r.bus_reverse.get(find(kv, "busway:right"), kNil),
+                                      r.psv.get(find(kv, "lanes:psv:backward"), kNil)));
+    kv["bus_backward"] = boolean(either(reverse, 0));
+  }
+  int oneway_bus = kNil;
+  if (equals(kv, "bus_backward", "true")) {
+    oneway_bus = r.oneway.get(find(kv, "oneway:bus"), kNil);
+    if (oneway_bus == 0 && equals(kv, "bus:backward", "yes")) {
+      oneway_bus = 1;
+    }
+  }
+
+  if (!find(kv, "oneway:taxi") && find(kv, "oneway:psv")) {
+    kv["oneway:taxi"] = kv["oneway:psv"];
+  }
+  if ((equals(kv, "oneway", "yes") && equals(kv, "oneway:taxi", "no")) ||
+      equals(kv, "taxi:backward", "yes") || equals(kv, "taxi:backward", "designated")) {
+    kv["taxi_backward"] = "true";
+  }
+  if (!find(kv, "taxi_backward") || equals(kv, "taxi_backward", "false")) {
+    kv["taxi_backward"] = boolean(either(r.psv.get(find(kv, "lanes:psv:backward"), kNil), 0));
+  }
+  int oneway_taxi = kNil;
+  if (equals(kv, "taxi_backward", "true")) {
+    oneway_taxi = r.oneway.get(find(kv, "oneway:taxi"), kNil);
+    if (oneway_taxi == 0 && equals(kv, "taxi:backward", "yes")) {
+      oneway_taxi = 1;
+    }
+  }
+
+  if (!find(kv, "moped_backward")) {
+    kv["moped_backward"] = "false";
+  }
+  if ((equals(kv, "oneway", "yes") &&
+       (equals(kv, "oneway:moped", "no") || equals(kv, "oneway:mofa", "no"))) ||
+      equals(kv, "moped:backward", "yes") || equals(kv, "mofa:backward", "yes")) {
+    kv["moped_backward"] = "true";
+  }
+  int oneway_moped = kNil;
+  if (equals(kv, "moped_backward", "true")) {
+    oneway_moped = either(r.oneway.get(find(kv, "oneway:moped"), kNil),
+                          r.oneway.get(find(kv, "oneway:mofa"), kNil));
+  }
+
+  if (!find(kv, "motorcycle_backward")) {
+    kv["motorcycle_backward"] = "false";
+  }
+  if ((equals(kv, "oneway", "yes") && equals(kv, "oneway:motorcycle", "no")) ||
+      equals(kv, "motorcycle:backward", "yes")) {
+    kv["motorcycle_backward"] = "true";
+  }
+  int oneway_motorcycle = kNil;
+  if (equals(kv, "motorcycle_backward", "true")) {
+    oneway_motorcycle = r.oneway.get(find(kv, "oneway:motorcycle"), kNil);
+  }
+
+  if (!find(kv, "pedestrian_backward")) {
+    kv["pedestrian_backward"] = "false";
+  }
+  if ((equals(kv, "oneway", "yes") && equals(kv, "oneway:foot", "no")) ||
+      equals(kv, "foot:backward", "yes")) {
+    kv["pedestrian_backward"] = "true";
+  }
+  int oneway_foot = kNil;
+  if (equals(kv, "pedestrian_backward", "true")) {
+    oneway_foot = r.oneway.get(find(kv, "oneway:foot"), kNil);
+  }
+
+  // a oneway only in one direction for the mode (1) shuts off the other, a oneway that isnt
+  // for the mode (0) opens it
+  auto apply_oneway = [&kv](const char* forward_key, const char* backward_key, int oneway) {
+    if (equals(kv, backward_key, "true")) {
+      if (oneway == 1) {
+        kv[forward_key] = "false";
+      } else if (oneway == 0) {
+        kv[forward_key] = "true";
+      }
+    }
+  };
+
+  const bool oneway_reverse = equals(kv, "oneway", "-1");
+  int oneway_norm = r.oneway.get(find(kv, "oneway"), kNil);
+  if (equals(kv, "junction", "roundabout") || equals(kv, "junction", "circular")) {
+    oneway_norm = 1;
+    kv["roundabout"] = "true";
+  } else {
+    kv["roundabout"] = "false";
+  }
+  set(kv, "oneway", boolean(oneway_norm));
+  if (oneway_norm == 1) {
+    kv["auto_backward"] = "false";
+    kv["truck_backward"] = "false";
+    kv["emergency_backward"] = "false";
+    apply_oneway("bike_forward", "bike_backward", oneway_bike);
+    apply_oneway("bus_forward", "bus_backward", oneway_bus);
+    apply_oneway("taxi_forward", "taxi_backward", oneway_taxi);
+    apply_oneway("moped_forward", "moped_backward", oneway_moped);
+    apply_oneway("motorcycle_forward", "motorcycle_backward", oneway_motorcycle);
+    // don't apply oneway tag unless oneway:foot or pedestrian only way
+    if (equals(kv, "highway", "footway") || equals(kv, "highway", "pedestrian") ||
+        equals(kv, "highway", "steps") || equals(kv, "highway", "path") ||
+        find(kv, "oneway:foot")) {
+      apply_oneway("pedestrian_forward", "pedestrian_backward", oneway_foot);
+    } else {
+      set(kv, "pedestrian_backward", value(kv, "pedestrian_forward"));
+    }
+  } else {
+    set(kv, "auto_backward", value(kv, "auto_forward"));
+    set(kv, "truck_backward", value(kv, "truck_forward"));
+    set(kv, "emergency_backward", value(kv, "emergency_forward"));
+
+    // the lua also checks oneway[tag] == false which compares a string to a boolean and never
+    // holds, so only a missing tag or "no" opens the backward direction
+    auto two_way = [&kv](const char* key) { return !find(kv, key) || equals(kv, key, "no"); };
+    if (equals(kv, "bike_backward", "false") && two_way("oneway:bicycle")) {
+      set(kv, "bike_backward", value(kv, "bike_forward"));
+    }
+    if (equals(kv, "bus_backward", "false") && !find(kv, "oneway:bus")) {
+      set(kv, "bus_backward", value(kv, "bus_forward"));
+    }
+    if (equals(kv, "taxi_backward", "false") && !find(kv, "oneway:taxi")) {
+      set(kv, "taxi_backward", value(kv, "taxi_forward"));
+    }
+    if (equals(kv, "moped_backward", "false") && two_way("oneway:moped") &&
+        two_way("oneway:mofa")) {
+      set(kv, "moped_backward", value(kv, "moped_forward"));
+    }
+    if (equals(kv, "motorcycle_backward", "false") && two_way("oneway:motorcycle")) {
+      set(kv, "motorcycle_backward", value(kv, "motorcycle_forward"));
+    }
+    if (equals(kv, "pedestrian_backward", "false") && two_way("oneway:foot")) {
+      set(kv, "pedestrian_backward", value(kv, "pedestrian_forward"));
+    }
+  }
+
+  // Bike forward / backward overrides.
+  auto has_lane = [&kv, &r](const char* key) { return r.cycle_lane.find(find(kv, key)); };
+  if (has_lane("cycleway:both") || (has_lane("cycleway:right") && has_lane("cycleway:left"))) {
+    kv["bike_forward"] = "true";
+    kv["bike_backward"] = "true";
+  }
+  if (equals(kv, "busway", "lane") ||
+      (equals(kv, "busway:left", "lane") && equals(kv, "busway:right", "lane"))) {
+    kv["bus_forward"] = "true";
+    kv["bus_backward"] = "true";
+  }
+
+  // flip the onewayness
+  kv["oneway_reverse"] = oneway_reverse ? "true" : "false";
+  if (oneway_reverse) {
+    for (const char* mode : {"auto", "truck", "emergency", "bus", "taxi", "bike", "moped",
+                             "motorcycle", "pedestrian"}) {
+      swap(kv, (std::string(mode) + "_forward").c_str(), (std::string(mode) + "_backward").c_str());
+    }
+  }
+  if (equals(kv, "oneway:bicycle", "-1")) {
+    swap(kv, "bike_forward", "bike_backward");
+  }
+  if (equals(kv, "oneway:moped", "-1") || equals(kv, "oneway:mofa", "-1")) {
+    swap(kv, "moped_forward", "moped_backward");
+  }
+  if (equals(kv, "oneway:motorcycle", "-1")) {
+    swap(kv, "motorcycle_forward", "motorcycle_backward");
+  }
+  if (equals(kv, "oneway:foot", "-1")) {
+    swap(kv, "pedestrian_forward", "pedestrian_backward");
+  }
+  if (equals(kv, "oneway:bus", "-1")) {
+    swap(kv, "bus_forward", "bus_backward");
+  }
+
+  // bus only logic
+  if (equals(kv, "lanes:bus", "1")) {
+    kv["bus_forward"] = "true";
+    kv["bus_backward"] = "false";
+  } else if (equals(kv, "lanes:bus", "2")) {
+    kv["bus_forward"] = "true";
+    kv["bus_backward"] = "true";
+  }
+  if (equals(kv, "oneway:taxi", "-1")) {
+    swap(kv, "taxi_forward", "taxi_backward");
+  }
+  if (equals(kv, "lanes:psv", "1")) {
+    kv["taxi_forward"] = "true";
+    kv["taxi_backward"] = "false";
+  } else if (equals(kv, "lanes:psv", "2")) {
+    kv["taxi_forward"] = "true";
+    kv["taxi_backward"] = "true";
+  }
+
+  // if none of the modes were set we are done looking at this, but save bridleways for country
+  // access logic
+  if (all_false(kv, {"auto_forward", "truck_forward", "bus_forward", "bike_forward",
+                     "emergency_forward", "moped_forward", "motorcycle_forward",
+                     "pedestrian_forward", "auto_backward", "truck_backward", "bus_backward",
+                     "bike_backward", "emergency_backward", "moped_backward",
+                     "motorcycle_backward", "pedestrian_backward"}) &&
+      !equals(kv, "highway", "bridleway")) {
+    return true;
+  }
+
+  // toss actual areas
+  if (equals(kv, "area", "yes")) {
+    return true;
+  }
+
+  kv.erase("FIXME");
+  kv.erase("note");
+  kv.erase("source");
+
+  // set a few flags
+  int road_class = r.road_class.get(find(kv, "highway"), kNil);
+  if (!highway && ferry) {
+    road_class = 2; // TODO:  can we weight based on ferry types?
+  } else if (!highway && (find(kv, "railway") || equals(kv, "route", "shuttle_train"))) {
+    road_class = 2; // TODO:  can we weight based on rail types?
+  } else if (road_class == kNil) { // service and other = 7
+    road_class = 7;
+  }
+  kv["road_class"] = std::to_string(road_class);
+
+  // the default speed for tracks is lowered further below
+  constexpr int kDefaultSpeed[] = {105, 90, 75, 60, 50, 40, 35, 25};
+  int default_speed = kDefaultSpeed[road_class];
+  // lower the default speed for driveways
+  if (equals(kv, "service", "driveway")) {
+    default_speed /= 2;
+  }
+  kv["default_speed"] = std::to_string(default_speed);
+
+  int use = r.use.get(find(kv, "service"), kNil);
+  const auto vehicles_off = [&kv]() {
+    return all_false(kv, {"auto_forward", "auto_backward", "truck_forward", "truck_backward",
+                          "bus_forward", "bus_backward", "bike_forward", "bike_backward",
+                          "moped_forward", "moped_backward", "motorcycle_forward",
+                          "motorcycle_backward"});
+  };
+  if (highway) {
+    if (equals(kv, "highway", "track")) {
+      use = 3;
+    } else if (equals(kv, "highway", "living_street")) {
+      use = 10;
+    } else if (use == kNil && equals(kv, "highway", "service")) {
+      use = 11;
+    } else if (equals(kv, "highway", "cycleway")) {
+      use = 20;
+    } else if (all_false(kv, {"pedestrian_forward", "auto_forward", "auto_backward"}) &&
+               (equals(kv, "bike_forward", "true") || equals(kv, "bike_backward", "true"))) {
+      use = 20;
+    } else if (equals(kv, "highway", "footway") && equals(kv, "footway", "sidewalk")) {
+      use = 24;
+    } else if (equals(kv, "highway", "footway") && equals(kv, "footway", "crossing")) {
+      use = 32;
+    } else if (equals(kv, "highway", "footway")) {
+      use = 25;
+    } else if (equals(kv, "highway", "steps")) {
+      use = 26; // steps/stairs
+    } else if (equals(kv, "highway", "path")) {
+      use = 27;
+    } else if (equals(kv, "highway", "pedestrian")) {
+      use = 28;
+    } else if (equals(kv, "pedestrian_forward", "true") && vehicles_off()) {
+      use = 28;
+    } else if (equals(kv, "highway", "bridleway")) {
+      use = 29;
+    }
+  }
+  if (use == kNil) {
+    use = find(kv, "service") ? 40 : 0; // other or general road, no special use
+  }
+  if ((equals(kv, "access", "emergency") || equals(kv, "emergency", "yes")) && vehicles_off()) {
+    use = 7;
+  }
+  kv["use"] = std::to_string(use);
+
+  int r_shoulder = either(r.shoulder.get(find(kv, "shoulder"), kNil),
+                          r.shoulder.get(find(kv, "shoulder:both"), kNil));
+  int l_shoulder = r_shoulder;
+  if (r_shoulder == kNil) {
+    r_shoulder = either(r.shoulder.get(find(kv, "shoulder:right"), kNil),
+                        equals(kv, "shoulder", "right") ? 1 : 0);
+    l_shoulder = either(r.shoulder.get(find(kv, "shoulder:left"), kNil),
+                        equals(kv, "shoulder", "left") ? 1 : 0);
+    // If the road is oneway and one shoulder is tagged but not the other, we set both to true so
+    // that when setting the shoulder in graphbuilder, driving on the right side vs the left side
+    // doesn't cause the edge to miss the shoulder tag
+    if (oneway_norm == 1 && r_shoulder != l_shoulder) {
+      r_shoulder = l_shoulder = 1;
+    }
+  }
+  kv["shoulder_right"] = boolean(r_shoulder);
+  kv["shoulder_left"] = boolean(l_shoulder);
+
+  int cycle_lane_right_opposite = 0;
+  int cycle_lane_left_opposite = 0;
+  int cycle_lane_right = 0;
+  int cycle_lane_left = 0;
+  // We have special use cases for cycle lanes when on a cycleway, footway, or path
+  if ((use == 20 || use == 25 || use == 27) &&
+      (equals(kv, "bike_forward", "true") || equals(kv, "bike_backward", "true"))) {
+    if (equals(kv, "pedestrian_forward", "false")) {
+      cycle_lane_right = 3; // separated
+    } else if (equals(kv, "segregated", "yes")) {
+      cycle_lane_right = 2; // dedicated
+    } else if (equals(kv, "segregated", "no")) {
+      cycle_lane_right = 1; // shared
+    } else {
+      // without a segregated tag cycleways are assumed to be separated, footways and paths shared
+      cycle_lane_right = use == 20 ? 2 : 1;
+    }
+    cycle_lane_left = cycle_lane_right;
+  } else {
+    // Set flags if any of the lanes are marked "opposite" (contraflow)
+    cycle_lane_right_opposite = either(r.bike_reverse.get(find(kv, "cycleway"), kNil), 0);
+    cycle_lane_left_opposite = cycle_lane_right_opposite;
+    if (cycle_lane_right_opposite == 0) {
+      cycle_lane_right_opposite = either(r.bike_reverse.get(find(kv, "cycleway:right"), kNil), 0);
+      cycle_lane_left_opposite = either(r.bike_reverse.get(find(kv, "cycleway:left"), kNil), 0);
+    }
+
+    // Figure out which side of the road has what cyclelane
+    auto cycle_lane = [&kv, &r](const char* key, const char* buffer) {
+      return either(r.cycle_lane.get(find(kv, key), kNil), equals(kv, buffer, "yes") ? 2 : 0);
+    };
+    cycle_lane_right = cycle_lane("cycleway", "cycleway:both:buffer");
+    cycle_lane_left = cycle_lane_right;
+    if (cycle_lane_right == 0) {
+      cycle_lane_right = cycle_lane("cycleway:right", "cycleway:right:buffer");
+      cycle_lane_left = cycle_lane("cycleway:left", "cycleway:left:buffer");
+    }
+
+    // If we have the oneway:bicycle=no tag and there are not "opposite_lane/opposite_track" tags
+    // then there are certain situations where the cyclelane is considered a two-way. (Based off
+    // of some examples on wiki.openstreetmap.org/wiki/Bicycle)
+    if (equals(kv, "oneway:bicycle", "no") && cycle_lane_right_opposite == 0 &&
+        cycle_lane_left_opposite == 0) {
+      if (cycle_lane_right == 2 || cycle_lane_right == 3) {
+        if (oneway_norm == 1) { // Example M1 or M2d but on the right side
+          cycle_lane_left = cycle_lane_right;
+          cycle_lane_left_opposite = 1;
+        } else if (cycle_lane_left == 0) { // Example L1b
+          cycle_lane_left = cycle_lane_right;
+        }
+      } else if (cycle_lane_left == 2 || cycle_lane_left == 3) {
+        if (oneway_norm == 1) { // Example M2d
+          cycle_lane_right = cycle_lane_left;
+          cycle_lane_right_opposite = 1;
+        } else if (cycle_lane_right == 0) { // Example L1b but on the left side
+          cycle_lane_right = cycle_lane_left;
+        }
+      }
+    }
+  }
+  kv["cycle_lane_right"] = std::to_string(cycle_lane_right);
+  kv["cycle_lane_left"] = std::to_string(cycle_lane_left);
+  kv["cycle_lane_right_opposite"] = boolean(cycle_lane_right_opposite);
+  kv["cycle_lane_left_opposite"] = boolean(cycle_lane_left_opposite);
+
+  if (highway && find(kv, "highway")->find("_link") != std::string::npos) {
+    kv["link"] = "true";
+  }
+
+  kv["private"] = boolean(either(r.privately.get(find(kv, "access"), kNil),
+                                 either(r.privately.get(find(kv, "motor_vehicle"), kNil), 0)));
+  kv["no_thru_traffic"] = boolean(either(r.no_thru_traffic.get(find(kv, "access"), kNil), 0));
+  kv["ferry"] = ferry ? "true" : "false";
+  kv["rail"] = equals(kv, "auto_forward", "true") &&
+                       (equals(kv, "railway", "rail") || equals(kv, "route", "shuttle_train"))
+                   ? "true"
+                   : "false";
+
+  if (equals(kv, "maxspeed", "none")) {
+    // special case unlimited speed limit (german autobahn)
+    kv["max_speed"] = "unlimited";
+  } else {
+    set_number(kv, "max_speed", normalize_speed(find(kv, "maxspeed")));
+  }
+  set_number(kv, "advisory_speed", normalize_speed(find(kv, "maxspeed:advisory")));
+  set_number(kv, "average_speed", normalize_speed(find(kv, "maxspeed:practical")));
+  set_number(kv, "backward_speed", normalize_speed(find(kv, "maxspeed:backward")));
+  set_number(kv, "forward_speed", normalize_speed(find(kv, "maxspeed:forward")));
+  set(kv, "wheelchair", boolean(r.wheelchair_node.get(find(kv, "wheelchair"), kNil)));
+
+  // lower the default speed for tracks
+  if (equals(kv, "highway", "track")) {
+    const auto* tracktype = find(kv, "tracktype");
+    const int speed = !tracktype                ? 5
+                      : *tracktype == "grade1" ? 20
+                      : *tracktype == "grade2" ? 15
+                      : *tracktype == "grade3" ? 12
+                      : *tracktype == "grade4" ? 10
+                                               : 5;
+    kv["default_speed"] = std::to_string(speed);
+  }
+
+  // use unsigned_ref if all the conditions are met.
+  if (!find(kv, "name") && !find(kv, "name:en") && !find(kv, "alt_name") &&
+      !find(kv, "official_name") && !find(kv, "ref") && !find(kv, "int_ref") &&
+      (equals(kv, "highway", "motorway") || equals(kv, "highway", "trunk") ||
+       equals(kv, "highway", "primary")) &&
+      find(kv, "unsigned_ref")) {
+    kv["ref"] = kv["unsigned_ref"];
+  }
+
+  auto lane_count = [&kv](const char* key) {
+    double count;
+    const auto* lanes = find(kv, key);
+    if (!lanes || !to_number(numeric_prefix(*lanes, false), count) || count > 15) {
+      return std::string();
+    }
+    return number(count);
+  };
+  set_number(kv, "lanes", lane_count("lanes"));
+  set_number(kv, "forward_lanes", lane_count("lanes:forward"));
+  set_number(kv, "backward_lanes", lane_count("lanes:backward"));
+
+  kv["bridge"] = boolean(either(r.bridge.get(find(kv, "bridge"), kNil), 0));
+
+  // TODO access:conditional
+  if (find(kv, "seasonal") && !equals(kv, "seasonal", "no")) {
+    kv["seasonal"] = "true";
+  }
+
+  if (equals(kv, "hov", "no")) {
+    kv["hov_tag"] = "false";
+    kv["hov_forward"] = "false";
+    kv["hov_backward"] = "false";
+  } else {
+    set(kv, "hov_forward", value(kv, "auto_forward"));
+    set(kv, "hov_backward", value(kv, "auto_backward"));
+  }
+
+  // hov restrictions
+  if ((find(kv, "hov") && !equals(kv, "hov", "no")) || find(kv, "hov:lanes") ||
+      find(kv, "hov:minimum")) {
+    kv["hov_tag"] = "true";
+
+    bool only_hov_allowed = equals(kv, "hov", "designated");
+    if (only_hov_allowed && find(kv, "hov:lanes")) {
+      const std::string lanes = *find(kv, "hov:lanes") + '|';
+      for (size_t begin = 0, end; (end = lanes.find('|', begin)) != std::string::npos;
+           begin = end + 1) {
+        if (lanes.compare(begin, end - begin, "designated") != 0) {
+          only_hov_allowed = false;
+        }
+      }
+    }
+
+    if (only_hov_allowed) {
+      for (const auto& mode : {std::make_pair("auto_tag", "auto"),
+                               std::make_pair("truck_tag", "truck"),
+                               std::make_pair("foot_tag", "pedestrian"),
+                               std::make_pair("bike_tag", "bike")}) {
+        if (!find(kv, mode.first)) {
+          kv[std::string(mode.second) + "_forward"] = "false";
+          kv[std::string(mode.second) + "_backward"] = "false";
+        }
+      }
+    }
+  }
+
+  kv["tunnel"] = boolean(either(r.tunnel.get(find(kv, "tunnel"), kNil), 0));
+  kv["toll"] = boolean(either(r.toll.get(find(kv, "toll"), kNil), 0));
+
+  // truck goodies
+  auto maxheight = normalize_measurement(find(kv, "maxheight"));
+  if (maxheight.empty()) {
+    maxheight = normalize_measurement(find(kv, "maxheight:physical"));
+  }
+  set_number(kv, "maxheight", maxheight);
+  auto maxwidth = normalize_measurement(find(kv, "maxwidth"));
+  if (maxwidth.empty()) {
+    maxwidth = normalize_measurement(find(kv, "maxwidth:physical"));
+  }
+  set_number(kv, "maxwidth", maxwidth);
+  set_number(kv, "maxlength", normalize_measurement(find(kv, "maxlength")));
+  set_number(kv, "maxweight", normalize_weight(find(kv, "maxweight")));
+  set_number(kv, "maxaxleload", normalize_weight(find(kv, "maxaxleload")));
+
+  // TODO: hazmat really should have subcategories
+  int hazmat = kNil;
+  for (const char* key :
+       {"hazmat", "hazmat:water", "hazmat:A", "hazmat:B", "hazmat:C", "hazmat:D", "hazmat:E"}) {
+    hazmat = either(hazmat, r.hazmat.get(find(kv, key), kNil));
+  }
+  set(kv, "hazmat", boolean(hazmat));
+  set_number(kv, "maxspeed:hgv", normalize_speed(find(kv, "maxspeed:hgv")));
+
+  if (find(kv, "hgv:national_network") || find(kv, "hgv:state_network") ||
+      equals(kv, "hgv", "local") || equals(kv, "hgv", "designated")) {
+    kv["truck_route"] = "true";
+  }
+
+  int bike_mask = 0;
+  if (find(kv, "ncn_ref") || equals(kv, "ncn", "yes")) {
+    bike_mask = 1;
+  }
+  if (find(kv, "rcn_ref") || equals(kv, "rcn", "yes")) {
+    bike_mask |= 2;
+  }
+  if (find(kv, "lcn_ref") || equals(kv, "lcn", "yes")) {
+    bike_mask |= 4;
+  }
+  if (equals(kv, "mtb", "yes")) {
+    bike_mask |= 8;
+  }
+  set(kv, "bike_national_ref", value(kv, "ncn_ref"));
+  set(kv, "bike_regional_ref", value(kv, "rcn_ref"));
+  set(kv, "bike_local_ref", value(kv, "lcn_ref"));
+  kv["bike_network_mask"] = std::to_string(bike_mask);
+
+  return false;
+}
+
+// see rels_proc in lua/graph.lua
+Tags CompiledTagTransform::TransformRelation(const Tags& tags) const {
+  const auto& r = *rules_;
+  const auto* type = find(tags, "type");
+  if (type && *type == "connectivity") {
+    return tags;
+  }
+  if (!type || (*type != "route" && *type != "restriction")) {
+    return {};
+  }
+
+  Tags kv = tags;
+  std::string prefix;
+  int restrict = either(r.restriction.get(find(kv, "restriction"), kNil),
+                        restriction_prefix(find(kv, "restriction:conditional"), prefix)
+                            ? r.restriction.get(&prefix, kNil)
+                            : kNil);
+
+  static const char* kTypedRestrictions[] = {"restriction:hgv",        "restriction:emergency",
+                                             "restriction:taxi",       "restriction:motorcar",
+                                             "restriction:bus",        "restriction:bicycle",
+                                             "restriction:hazmat",     "restriction:motorcycle",
+                                             "restriction:foot"};
+  int restrict_type = kNil;
+  for (const char* key : kTypedRestrictions) {
+    restrict_type = either(restrict_type, r.restriction.get(find(kv, key), kNil));
+  }
+
+  // restrictions with type win over just restriction key. people enter both
+  if (restrict_type != kNil) {
+    restrict = restrict_type;
+  }
+
+  if (*type == "restriction" || find(kv, "restriction:conditional")) {
+    if (restrict == kNil) {
+      return {};
+    }
+
+    std::string suffix;
+    if (restriction_suffix(find(kv, "restriction:conditional"), suffix)) {
+      kv["restriction:conditional"] = suffix;
+    } else {
+      kv.erase("restriction:conditional");
+    }
+    for (const char* key : kTypedRestrictions) {
+      assign(kv, key, r.restriction.get(find(kv, key), kNil));
+    }
+    assign(kv, "restriction", restrict_type == kNil ? restrict : kNil);
+    return kv;
+  } else if (equals(kv, "route", "bicycle") || equals(kv, "route", "mtb")) {
+    int bike_mask = 0;
+    if (equals(kv, "network", "mtb") || equals(kv, "route", "mtb")) {
+      bike_mask = 8;
+    }
+    if (equals(kv, "network", "ncn")) {
+      bike_mask |= 1;
+    } else if (equals(kv, "network", "rcn")) {
+      bike_mask |= 2;
+    } else if (equals(kv, "network", "lcn")) {
+      bike_mask |= 4;
+    }
+    kv["bike_network_mask"] = std::to_string(bike_mask);
+  } else if (restrict != kNil) {
+    // has a restriction but type is not restriction...ignore
+    return {};
+  }
+
+  kv.erase("day_on");
+  kv.erase("day_off");
+  kv.erase("restriction");
+  return kv;
+}
+
+} // namespace mjolnir
+} // namespace valhalla
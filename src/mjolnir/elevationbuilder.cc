@@ -176,7 +176,9 @@ void ElevationBuilder::Build(const boost::property_tree::ptree& pt) {
   boost::optional<std::string> elevation = pt.get_optional<std::string>("additional_data.elevation");
   std::unique_ptr<const skadi::sample> sample;
   if (elevation && filesystem::exists(*elevation)) {
-    sample.reset(new skadi::sample(*elevation));
+    sample.reset(new skadi::sample(*elevation,
+                                   pt.get<size_t>("additional_data.elevation_cache_size",
+                                                  skadi::sample::kDefaultCacheSize)));
   } else {
     LOG_INFO("ElevationBuilder: no elevation data, skipping");
     return;
@@ -219,6 +221,10 @@ void ElevationBuilder::Build(const boost::property_tree::ptree& pt) {
     thread->join();
   }
 
+  auto stats = sample->cache_stats();
+  LOG_INFO("Elevation tile cache hits: " + std::to_string(stats.hits) +
+           " misses: " + std::to_string(stats.misses));
+
   /** // Get the promise from the future
   for (auto& result : results) {
     auto data = result.get_future().get();
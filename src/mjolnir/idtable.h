@@ -4,12 +4,15 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <vector>
 
 #include <robin_hood.h>
 
 #include <midgard/logging.h>
+#include <midgard/sequence.h>
 
 namespace valhalla {
 namespace mjolnir {
@@ -107,6 +110,474 @@ private:
   robin_hood::unordered_map<uint64_t, uint64_t> bitmarkers_;
 };
 
+namespace detail {
+inline uint32_t popcount64(uint64_t word) {
+#if defined(_MSC_VER)
+  return static_cast<uint32_t>(__popcnt64(word));
+#else
+  return static_cast<uint32_t>(__builtin_popcountll(word));
+#endif
+}
+
+inline uint32_t ctz64(uint64_t word) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward64(&index, word);
+  return static_cast<uint32_t>(index);
+#else
+  return static_cast<uint32_t>(__builtin_ctzll(word));
+#endif
+}
+} // namespace detail
+
+/**
+ * A succinct set of OSM ids stored as a sequence of fixed size Elias-Fano encoded chunks. Each
+ * chunk holds kChunkSize sorted ids (the last one may hold fewer) and picks its own number of
+ * low bits from the id range it covers, so the table can be built in a single streaming pass
+ * without knowing the number of ids or the largest id up front. Dense OSM id ranges cost a few
+ * bits per id rather than the 16+ bytes per 64 id bucket of the hash based table above.
+ *
+ * Because every chunk but the last is full, the position of an id within the set is also a
+ * dense index (0..size()-1) which can be used to address side arrays instead of keeping a
+ * separate id->index map.
+ *
+ * The table can be written to disk and memory mapped back readonly so that it does not have to
+ * live on the heap at all once built.
+ */
+class CompactIdTable final {
+public:
+  static constexpr uint64_t npos = std::numeric_limits<uint64_t>::max();
+  static constexpr uint32_t kChunkSize = 512;
+
+  /**
+   * Constructor
+   * @param   pending_limit  How many unsorted ids set() buffers before merging them into the
+   *                         compact representation.
+   */
+  explicit CompactIdTable(const size_t pending_limit = 1 << 23)
+      : pending_limit_(std::max(pending_limit, static_cast<size_t>(1))) {
+    reset_views();
+  }
+
+  CompactIdTable(const CompactIdTable&) = delete;
+  CompactIdTable& operator=(const CompactIdTable&) = delete;
+
+  /**
+   * Appends an id to the table. Ids must be appended in ascending order, repeated ids are
+   * ignored. Call finish() once all ids have been appended.
+   * @param   id   OSM Id of the way/node/relation.
+   */
+  void push_back(const uint64_t id) {
+    if (!staging_.empty() && id <= staging_.back()) {
+      if (id == staging_.back()) {
+        return;
+      }
+      throw std::logic_error("CompactIdTable ids must be pushed in ascending order");
+    }
+    if (staging_.empty() && size_ > 0 && id <= last_) {
+      if (id == last_) {
+        return;
+      }
+      throw std::logic_error("CompactIdTable ids must be pushed in ascending order");
+    }
+    staging_.push_back(id);
+    if (staging_.size() == kChunkSize) {
+      encode_chunk();
+    }
+  }
+
+  /**
+   * Encodes any ids still buffered by push_back and merges in the ones buffered by set. The table
+   * can only be read once it is finished, so this has to be called between adding ids and looking
+   * them up.
+   */
+  void finish() {
+    if (!staging_.empty()) {
+      encode_chunk();
+    }
+    compact();
+  }
+
+  /**
+   * Sets the OSM Id as used. Unlike push_back the ids may come in any order, they are buffered
+   * and periodically merged into the compact representation. Call finish() once all ids are set.
+   * @param   id   OSM Id of the way/node/relation.
+   */
+  void set(const uint64_t id) {
+    pending_.push_back(id);
+    if (pending_.size() >= pending_limit_) {
+      compact();
+    }
+  }
+
+  /**
+   * Test if the OSM Id is used / set in the table.
+   * @param  id  OSM Id
+   * @return  Returns true if the OSM Id is used. False if not.
+   */
+  bool get(const uint64_t id) const {
+    return index(id) != npos;
+  }
+
+  /**
+   * Returns the dense index of the id, ie the number of ids in the table smaller than it.
+   * @param  id  OSM Id
+   * @return the dense index or npos if the id is not in the table
+   */
+  uint64_t index(const uint64_t id) const {
+    finish_check();
+    if (chunk_count_ == 0 || id < chunks_[0].first_id) {
+      return npos;
+    }
+
+    // find the last chunk starting at or before the id
+    const chunk_t* chunk =
+        std::upper_bound(chunks_, chunks_ + chunk_count_, id,
+                         [](uint64_t i, const chunk_t& c) { return i < c.first_id; }) -
+        1;
+    auto offset = find_in_chunk(*chunk, id - chunk->first_id);
+    return offset == npos ? npos : static_cast<uint64_t>(chunk - chunks_) * kChunkSize + offset;
+  }
+
+  /**
+   * @return the number of unique ids in the table
+   */
+  uint64_t size() const {
+    finish_check();
+    return size_;
+  }
+
+  /**
+   * @return the number of bytes used by the encoded ids and chunk directory
+   */
+  size_t encoded_size() const {
+    return chunk_count_ * sizeof(chunk_t) + word_count_ * sizeof(uint64_t);
+  }
+
+  /**
+   * Calls the functor with every id in the table in ascending order
+   * @param func  functor taking a uint64_t id
+   */
+  template <typename func_t> void for_each(const func_t& func) const {
+    finish_check();
+    for (size_t c = 0; c < chunk_count_; ++c) {
+      decode_chunk(chunks_[c], func);
+    }
+  }
+
+  /**
+   * Serializes the table to file
+   * @param file_name  the file to which we should serialize the table
+   * @return true if the table could be serialized
+   */
+  bool serialize(const std::string& file_name) const {
+    finish_check();
+    std::ofstream file(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      return false;
+    }
+    header_t header{{}, size_, chunk_count_, word_count_, last_};
+    std::memcpy(header.magic, kMagic, sizeof(header.magic));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(chunks_), chunk_count_ * sizeof(chunk_t));
+    file.write(reinterpret_cast<const char*>(words_), word_count_ * sizeof(uint64_t));
+    return static_cast<bool>(file);
+  }
+
+  /**
+   * Deserializes the table from file into memory
+   * @param file_name  the file from which to deserialize the table
+   * @return true if it was succesfully deserialized
+   */
+  bool deserialize(const std::string& file_name) {
+    std::ifstream file(file_name, std::ios::in | std::ios::binary);
+    header_t header;
+    if (!file.is_open() || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kMagic, sizeof(header.magic))) {
+      return false;
+    }
+    clear();
+    owned_chunks_.resize(header.chunk_count);
+    owned_words_.resize(header.word_count);
+    file.read(reinterpret_cast<char*>(owned_chunks_.data()), header.chunk_count * sizeof(chunk_t));
+    file.read(reinterpret_cast<char*>(owned_words_.data()), header.word_count * sizeof(uint64_t));
+    if (!file) {
+      clear();
+      return false;
+    }
+    size_ = header.size;
+    last_ = header.last_id;
+    reset_views();
+    return true;
+  }
+
+  /**
+   * Memory maps a previously serialized table readonly. The table cannot be modified afterwards
+   * (other than by clearing it) but costs no heap memory.
+   * @param file_name  the file which was written by serialize()
+   * @return true if it was succesfully mapped
+   */
+  bool map(const std::string& file_name) {
+    clear();
+    filesystem::directory_entry entry(file_name);
+    if (!entry.is_regular_file() || entry.file_size() < sizeof(header_t)) {
+      return false;
+    }
+    const auto file_size = entry.file_size();
+    mapped_.map(file_name, file_size, POSIX_MADV_RANDOM, true);
+    const auto* header = reinterpret_cast<const header_t*>(mapped_.get());
+    if (std::memcmp(header->magic, kMagic, sizeof(header->magic)) ||
+        file_size != sizeof(header_t) + header->chunk_count * sizeof(chunk_t) +
+                         header->word_count * sizeof(uint64_t)) {
+      clear();
+      return false;
+    }
+    size_ = header->size;
+    last_ = header->last_id;
+    chunk_count_ = header->chunk_count;
+    word_count_ = header->word_count;
+    chunks_ = reinterpret_cast<const chunk_t*>(mapped_.get() + sizeof(header_t));
+    words_ = reinterpret_cast<const uint64_t*>(mapped_.get() + sizeof(header_t) +
+                                               chunk_count_ * sizeof(chunk_t));
+    return true;
+  }
+
+  /**
+   * Drops all ids (and any memory map) from the table
+   */
+  void clear() {
+    mapped_.unmap();
+    owned_chunks_.clear();
+    owned_words_.clear();
+    staging_.clear();
+    pending_.clear();
+    size_ = last_ = 0;
+    reset_views();
+  }
+
+  /**
+   * For unit tests only
+   * @param other
+   * @return
+   */
+  bool operator==(const CompactIdTable& other) const {
+    if (size() != other.size() || chunk_count_ != other.chunk_count_ ||
+        word_count_ != other.word_count_) {
+      return false;
+    }
+    for (size_t i = 0; i < chunk_count_; ++i) {
+      if (std::memcmp(&chunks_[i], &other.chunks_[i], sizeof(chunk_t))) {
+        return false;
+      }
+    }
+    return std::equal(words_, words_ + word_count_, other.words_);
+  }
+
+private:
+  // the directory entry of one encoded chunk, the words at word_offset hold the upper bits
+  // bitvector followed by the packed low bits
+  struct chunk_t {
+    uint64_t first_id;
+    uint64_t word_offset;
+    uint32_t count;
+    uint16_t upper_words;
+    uint16_t low_bits;
+  };
+  static_assert(sizeof(chunk_t) == 24, "CompactIdTable chunk must be tightly packed");
+
+  struct header_t {
+    char magic[8];
+    uint64_t size;
+    uint64_t chunk_count;
+    uint64_t word_count;
+    uint64_t last_id;
+  };
+  static constexpr const char* kMagic = "VHIDTBL1";
+
+  void finish_check() const {
+    if (!staging_.empty() || !pending_.empty()) {
+      throw std::logic_error("CompactIdTable::finish must be called before reading the table");
+    }
+  }
+
+  void reset_views() {
+    chunks_ = owned_chunks_.data();
+    chunk_count_ = owned_chunks_.size();
+    words_ = owned_words_.data();
+    word_count_ = owned_words_.size();
+  }
+
+  // encodes the ids in staging_ as a new chunk
+  void encode_chunk() {
+    if (mapped_) {
+      throw std::logic_error("CompactIdTable cannot be modified while memory mapped");
+    }
+    const uint64_t first = staging_.front();
+    const uint64_t range = staging_.back() - first;
+    const uint32_t count = static_cast<uint32_t>(staging_.size());
+    uint16_t low_bits = 0;
+    while (low_bits < 63 && (range / count) >> (low_bits + 1)) {
+      ++low_bits;
+    }
+    const uint64_t upper_bits = count + (range >> low_bits) + 1;
+    const uint64_t upper_words = (upper_bits + 63) / 64;
+    const uint64_t low_words = (static_cast<uint64_t>(count) * low_bits + 63) / 64;
+
+    chunk_t chunk{first, owned_words_.size(), count, static_cast<uint16_t>(upper_words), low_bits};
+    owned_words_.resize(owned_words_.size() + upper_words + low_words, 0);
+    uint64_t* upper = owned_words_.data() + chunk.word_offset;
+    uint64_t* lower = upper + upper_words;
+    const uint64_t low_mask = low_bits ? (~uint64_t(0) >> (64 - low_bits)) : 0;
+    for (uint32_t i = 0; i < count; ++i) {
+      const uint64_t value = staging_[i] - first;
+      const uint64_t bit = (value >> low_bits) + i;
+      upper[bit / 64] |= uint64_t(1) << (bit % 64);
+      if (low_bits) {
+        const uint64_t pos = static_cast<uint64_t>(i) * low_bits;
+        const uint64_t low = value & low_mask;
+        lower[pos / 64] |= low << (pos % 64);
+        if (pos % 64 + low_bits > 64) {
+          lower[pos / 64 + 1] |= low >> (64 - pos % 64);
+        }
+      }
+    }
+
+    owned_chunks_.push_back(chunk);
+    size_ += count;
+    last_ = staging_.back();
+    staging_.clear();
+    reset_views();
+  }
+
+  uint64_t low_value(const chunk_t& chunk, const uint64_t* lower, uint32_t i) const {
+    const uint64_t pos = static_cast<uint64_t>(i) * chunk.low_bits;
+    uint64_t value = lower[pos / 64] >> (pos % 64);
+    if (pos % 64 + chunk.low_bits > 64) {
+      value |= lower[pos / 64 + 1] << (64 - pos % 64);
+    }
+    return value & (~uint64_t(0) >> (64 - chunk.low_bits));
+  }
+
+  // returns the offset of the value within the chunk or npos if its not there
+  uint64_t find_in_chunk(const chunk_t& chunk, const uint64_t value) const {
+    const uint64_t* upper = words_ + chunk.word_offset;
+    const uint64_t* lower = upper + chunk.upper_words;
+    const uint64_t high = value >> chunk.low_bits;
+    const uint64_t upper_bits = static_cast<uint64_t>(chunk.upper_words) * 64;
+
+    // skip to just past the high-th zero in the upper bits, this is where the bucket starts
+    uint64_t pos = 0;
+    uint64_t zeros = high;
+    for (uint32_t w = 0; zeros && w < chunk.upper_words; ++w) {
+      uint64_t inverted = ~upper[w];
+      const uint32_t in_word = detail::popcount64(inverted);
+      if (in_word < zeros) {
+        zeros -= in_word;
+        continue;
+      }
+      while (--zeros) {
+        inverted &= inverted - 1;
+      }
+      pos = w * uint64_t(64) + detail::ctz64(inverted) + 1;
+      break;
+    }
+    if (zeros) {
+      return npos;
+    }
+
+    // walk the ones of this bucket comparing the low bits which are sorted within it
+    const uint64_t low = chunk.low_bits ? value & (~uint64_t(0) >> (64 - chunk.low_bits)) : 0;
+    for (; pos < upper_bits && (upper[pos / 64] >> (pos % 64)) & 1; ++pos) {
+      const uint64_t i = pos - high;
+      if (i >= chunk.count) {
+        break;
+      }
+      const uint64_t candidate = chunk.low_bits ? low_value(chunk, lower, i) : 0;
+      if (candidate == low) {
+        return i;
+      }
+      if (candidate > low) {
+        break;
+      }
+    }
+    return npos;
+  }
+
+  template <typename func_t> void decode_chunk(const chunk_t& chunk, const func_t& func) const {
+    const uint64_t* upper = words_ + chunk.word_offset;
+    const uint64_t* lower = upper + chunk.upper_words;
+    uint32_t i = 0;
+    for (uint32_t w = 0; w < chunk.upper_words && i < chunk.count; ++w) {
+      uint64_t word = upper[w];
+      while (word && i < chunk.count) {
+        const uint64_t pos = w * uint64_t(64) + detail::ctz64(word);
+        const uint64_t high = pos - i;
+        const uint64_t low = chunk.low_bits ? low_value(chunk, lower, i) : 0;
+        func(chunk.first_id + ((high << chunk.low_bits) | low));
+        word &= word - 1;
+        ++i;
+      }
+    }
+  }
+
+  // merges the unsorted pending ids with whatever is already encoded
+  void compact() {
+    if (pending_.empty()) {
+      return;
+    }
+    if (!staging_.empty()) {
+      throw std::logic_error("CompactIdTable cannot mix push_back and set without finish");
+    }
+    std::sort(pending_.begin(), pending_.end());
+    pending_.erase(std::unique(pending_.begin(), pending_.end()), pending_.end());
+
+    // move the old encoding aside and re-encode the merge of the two sorted streams
+    std::vector<chunk_t> old_chunks;
+    std::vector<uint64_t> old_words;
+    old_chunks.swap(owned_chunks_);
+    old_words.swap(owned_words_);
+    CompactIdTable old;
+    old.owned_chunks_.swap(old_chunks);
+    old.owned_words_.swap(old_words);
+    old.size_ = size_;
+    old.reset_views();
+    size_ = last_ = 0;
+    reset_views();
+
+    std::vector<uint64_t> pending;
+    pending.swap(pending_);
+    auto next = pending.cbegin();
+    old.for_each([this, &next, &pending](uint64_t id) {
+      for (; next != pending.cend() && *next < id; ++next) {
+        push_back(*next);
+      }
+      push_back(id);
+    });
+    for (; next != pending.cend(); ++next) {
+      push_back(*next);
+    }
+    finish();
+  }
+
+  // ids waiting to be encoded into the next chunk (push_back) or merged in (set)
+  std::vector<uint64_t> staging_;
+  std::vector<uint64_t> pending_;
+  size_t pending_limit_;
+
+  // the heap backed encoding, empty when memory mapped
+  std::vector<chunk_t> owned_chunks_;
+  std::vector<uint64_t> owned_words_;
+  midgard::mem_map<char> mapped_;
+
+  // views of the encoding whether its on the heap or mapped
+  const chunk_t* chunks_;
+  size_t chunk_count_;
+  const uint64_t* words_;
+  size_t word_count_;
+  uint64_t size_ = 0;
+  uint64_t last_ = 0;
+};
+
 } // namespace mjolnir
 } // namespace valhalla
 
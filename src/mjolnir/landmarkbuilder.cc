@@ -0,0 +1,234 @@
+#include "mjolnir/landmarkbuilder.h"
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "baldr/graphreader.h"
+#include "baldr/landmarks.h"
+#include "baldr/tilehierarchy.h"
+#include "midgard/logging.h"
+
+using namespace valhalla::baldr;
+
+namespace {
+
+// The costings that get landmarks, the ones most routes are asked for, and the access their default
+// options need on an edge
+struct landmark_costing_t {
+  valhalla::Costing costing;
+  uint32_t access;
+  const char* name;
+};
+const std::vector<landmark_costing_t> kLandmarkCostings{
+    {valhalla::Costing::auto_, kAutoAccess, "auto"},
+    {valhalla::Costing::pedestrian, kPedestrianAccess, "pedestrian"},
+};
+
+// How many random nodes we try to find one that reaches most of the graph to start from
+constexpr uint32_t kMaxStartTries = 10;
+
+/**
+ * Measures the distances between one node and all the others over the edges with the access a
+ * costing needs, either from the node along the edges or to it against them
+ */
+class landmark_search_t {
+public:
+  landmark_search_t(const boost::property_tree::ptree& pt,
+                    const Landmarks& landmarks,
+                    const uint32_t access)
+      : reader_(pt.get_child("mjolnir")), landmarks_(landmarks), access_(access),
+        distances_(landmarks.node_count()) {
+  }
+
+  /**
+   * Runs Dijkstra from the landmark
+   * @param landmark  the node to measure from or to
+   * @param from      true to measure from the landmark, false to measure to it
+   * @return the distance of each node, Landmarks::kUnreachable if there is no path
+   */
+  const std::vector<float>& Run(const GraphId& landmark, const bool from) {
+    std::fill(distances_.begin(), distances_.end(), Landmarks::kUnreachable);
+    using label_t = std::pair<float, uint64_t>;
+    std::priority_queue<label_t, std::vector<label_t>, std::greater<label_t>> queue;
+    auto relax = [this, &queue](const GraphId& node, const float distance) {
+      const auto index = landmarks_.index(node);
+      if (index != Landmarks::kInvalidNode &&
+          (distances_[index] == Landmarks::kUnreachable || distance < distances_[index])) {
+        distances_[index] = distance;
+        queue.emplace(distance, node.value);
+      }
+    };
+    relax(landmark, 0.0f);
+
+    while (!queue.empty()) {
+      const auto label = queue.top();
+      queue.pop();
+      const GraphId node(label.second);
+      if (label.first > distances_[landmarks_.index(node)]) {
+        continue;
+      }
+      graph_tile_ptr tile = reader_.GetGraphTile(node);
+      if (tile == nullptr) {
+        continue;
+      }
+
+      // Moving between levels is free both ways
+      const NodeInfo* nodeinfo = tile->node(node);
+      for (const auto& transition : tile->GetNodeTransitions(nodeinfo)) {
+        relax(transition.endnode(), label.first);
+      }
+
+      // Going from the landmark we need access along the edge, going to it against the edge
+      const DirectedEdge* edge = tile->directededge(nodeinfo->edge_index());
+      for (uint32_t i = 0; i < nodeinfo->edge_count(); ++i, ++edge) {
+        if (!((from ? edge->forwardaccess() : edge->reverseaccess()) & access_) ||
+            edge->is_shortcut() ||
+            edge->endnode().level() == TileHierarchy::GetTransitLevel().level) {
+          continue;
+        }
+        relax(edge->endnode(), label.first + edge->length());
+      }
+
+      // Check if we need to clear the tile cache
+      if (reader_.OverCommitted()) {
+        reader_.Trim();
+      }
+    }
+    return distances_;
+  }
+
+protected:
+  GraphReader reader_;
+  const Landmarks& landmarks_;
+  uint32_t access_;
+  std::vector<float> distances_;
+};
+
+// The node numbered index by the landmarks
+GraphId node_at(const Landmarks& landmarks, const uint32_t index) {
+  const auto& tiles = landmarks.tiles();
+  auto tile = std::upper_bound(tiles.cbegin(), tiles.cend(), index,
+                               [](uint32_t i, const Landmarks::tile_t& t) { return i < t.offset; });
+  --tile;
+  return GraphId(GraphId(tile->id).tileid(), GraphId(tile->id).level(), index - tile->offset);
+}
+
+/**
+ * Picks the landmarks of a costing and measures the distances of all nodes to and from them. The
+ * first landmark is the node farthest from a random start, every one after that is the node
+ * farthest from the landmarks before it so that they end up spread around the edge of the graph
+ */
+void measure_landmarks(const boost::property_tree::ptree& pt,
+                       Landmarks& landmarks,
+                       const uint32_t table,
+                       std::promise<void>& result) {
+  try {
+    const auto access = kLandmarkCostings[table].access;
+    landmark_search_t from_search(pt, landmarks, access), to_search(pt, landmarks, access);
+
+    // Find a start that reaches most of the graph rather than an island
+    std::mt19937 generator(table);
+    std::uniform_int_distribution<uint32_t> any_node(0, landmarks.node_count() - 1);
+    std::vector<float> farthest;
+    size_t most_reached = 0;
+    for (uint32_t tries = 0; tries < kMaxStartTries && most_reached * 2 <= landmarks.node_count();
+         ++tries) {
+      const auto& distances = from_search.Run(node_at(landmarks, any_node(generator)), true);
+      const size_t reached = std::count_if(distances.cbegin(), distances.cend(),
+                                           [](float d) { return d != Landmarks::kUnreachable; });
+      if (reached > most_reached) {
+        farthest = distances;
+        most_reached = reached;
+      }
+    }
+
+    // Each node keeps the distance from the closest landmark so far
+    for (uint32_t l = 0; l < landmarks.landmark_count(); ++l) {
+      auto next = std::max_element(farthest.cbegin(), farthest.cend());
+      if (next == farthest.cend() || *next <= 0.0f) {
+        LOG_WARN("Only found " + std::to_string(l) + " landmarks");
+        break;
+      }
+      const auto landmark = node_at(landmarks, next - farthest.cbegin());
+      landmarks.landmarks(table)[l] = landmark;
+
+      auto to = std::async(std::launch::async,
+                           [&to_search, &landmark]() -> const std::vector<float>& {
+                             return to_search.Run(landmark, false);
+                           });
+      const auto& from_distances = from_search.Run(landmark, true);
+      const auto& to_distances = to.get();
+      for (uint32_t i = 0; i < landmarks.node_count(); ++i) {
+        landmarks.distances(table, i)[l] = {from_distances[i], to_distances[i]};
+        if (from_distances[i] != Landmarks::kUnreachable) {
+          farthest[i] = std::min(farthest[i], from_distances[i]);
+        }
+      }
+      LOG_INFO("Measured landmark " + std::to_string(l + 1) + " of " +
+               std::to_string(landmarks.landmark_count()) + " for " +
+               kLandmarkCostings[table].name);
+    }
+    result.set_value();
+  } catch (...) { result.set_exception(std::current_exception()); }
+}
+
+} // namespace
+
+namespace valhalla {
+namespace mjolnir {
+
+void LandmarkBuilder::Build(const boost::property_tree::ptree& pt) {
+  const auto landmark_file = pt.get<std::string>("mjolnir.landmark_file");
+  const auto landmark_count = pt.get<uint32_t>("mjolnir.landmark_count", 16);
+
+  // Number the nodes of the road levels
+  std::vector<Landmarks::tile_t> tiles;
+  GraphReader reader(pt.get_child("mjolnir"));
+  for (const auto& level : TileHierarchy::levels()) {
+    for (const auto& id : reader.GetTileSet(level.level)) {
+      graph_tile_ptr tile = reader.GetGraphTile(id);
+      if (tile != nullptr) {
+        tiles.push_back({id.value, 0, tile->header()->nodecount()});
+      }
+      if (reader.OverCommitted()) {
+        reader.Trim();
+      }
+    }
+  }
+  std::vector<valhalla::Costing> costings;
+  for (const auto& landmark_costing : kLandmarkCostings) {
+    costings.push_back(landmark_costing.costing);
+  }
+  Landmarks landmarks(costings, landmark_count, std::move(tiles));
+  if (landmarks.node_count() == 0) {
+    LOG_WARN("No nodes to measure landmarks for");
+    return;
+  }
+  LOG_INFO("Measuring " + std::to_string(landmark_count) + " landmarks for " +
+           std::to_string(landmarks.node_count()) + " nodes...");
+
+  // Each costing gets a thread, which runs its searches to and from a landmark side by side
+  std::vector<std::promise<void>> results(kLandmarkCostings.size());
+  std::vector<std::shared_ptr<std::thread>> threads(kLandmarkCostings.size());
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i].reset(new std::thread(measure_landmarks, std::cref(pt), std::ref(landmarks), i,
+                                     std::ref(results[i])));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  for (auto& result : results) {
+    result.get_future().get();
+  }
+
+  landmarks.Save(landmark_file);
+  LOG_INFO("Wrote landmarks to " + landmark_file);
+}
+
+} // namespace mjolnir
+} // namespace valhalla
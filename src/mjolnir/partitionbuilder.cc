@@ -0,0 +1,140 @@
+#include "mjolnir/partitionbuilder.h"
+
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "baldr/cellpartition.h"
+#include "baldr/graphreader.h"
+#include "baldr/tilehierarchy.h"
+#include "midgard/logging.h"
+
+using namespace valhalla::baldr;
+
+namespace {
+
+/**
+ * Finds the edges that leave the cells of a set of tiles. Each thread pulls a tile of the queue
+ */
+void find_cut_edges(const boost::property_tree::ptree& pt,
+                    std::deque<GraphId>& tilequeue,
+                    std::mutex& lock,
+                    std::promise<std::vector<CellPartition::cut_edge_t>>& result) {
+  // Local Graphreader
+  GraphReader graphreader(pt.get_child("mjolnir"));
+  std::vector<CellPartition::cut_edge_t> cut_edges;
+
+  // Check for more tiles
+  while (true) {
+    lock.lock();
+    if (tilequeue.empty()) {
+      lock.unlock();
+      break;
+    }
+    // Get the next tile Id
+    GraphId tile_id = tilequeue.front();
+    tilequeue.pop_front();
+    lock.unlock();
+
+    graph_tile_ptr tile = graphreader.GetGraphTile(tile_id);
+    if (tile == nullptr) {
+      continue;
+    }
+    GraphId nodeid = tile_id;
+    for (const auto& node : tile->GetNodes()) {
+      const auto from_cell = CellPartition::CellOf(nodeid, node.latlng(tile->header()->base_ll()));
+      GraphId edgeid(tile_id.tileid(), tile_id.level(), node.edge_index());
+      for (uint32_t i = 0; i < node.edge_count(); ++i, ++edgeid) {
+        const DirectedEdge* edge = tile->directededge(edgeid);
+        if (!CellPartition::Partitions(edge)) {
+          continue;
+        }
+
+        // Most edges end in the tile they start in, only look up the others
+        graph_tile_ptr end_tile = tile;
+        if (!graphreader.GetGraphTile(edge->endnode(), end_tile)) {
+          continue;
+        }
+        const auto to_cell = CellPartition::CellOf(edge->endnode(),
+                                                   end_tile->get_node_ll(edge->endnode()));
+        if (from_cell != to_cell) {
+          cut_edges.push_back({edgeid, from_cell, to_cell});
+        }
+      }
+      ++nodeid;
+    }
+
+    // Check if we need to clear the tile cache
+    if (graphreader.OverCommitted()) {
+      lock.lock();
+      graphreader.Trim();
+      lock.unlock();
+    }
+  }
+  result.set_value(std::move(cut_edges));
+}
+
+} // namespace
+
+namespace valhalla {
+namespace mjolnir {
+
+void PartitionBuilder::Build(const boost::property_tree::ptree& pt) {
+  const auto partition_file = pt.get<std::string>("mjolnir.partition_file");
+
+  // Create a randomized queue of the tiles of the road levels to work from
+  std::deque<GraphId> tilequeue;
+  GraphReader reader(pt.get_child("mjolnir"));
+  for (const auto& level : TileHierarchy::levels()) {
+    for (const auto& id : reader.GetTileSet(level.level)) {
+      tilequeue.emplace_back(id);
+    }
+  }
+  std::random_device rd;
+  std::shuffle(tilequeue.begin(), tilequeue.end(), std::mt19937(rd()));
+
+  // An mutex we can use to do the synchronization
+  std::mutex lock;
+
+  // Setup threads
+  uint32_t nthreads =
+      std::max(static_cast<unsigned int>(1),
+               pt.get<unsigned int>("mjolnir.concurrency", std::thread::hardware_concurrency()));
+  std::vector<std::shared_ptr<std::thread>> threads(nthreads);
+
+  // Setup promises. Hold the results for the threads
+  std::vector<std::promise<std::vector<CellPartition::cut_edge_t>>> results(nthreads);
+
+  LOG_INFO("Partitioning " + std::to_string(tilequeue.size()) + " tiles with " +
+           std::to_string(nthreads) + " threads...");
+
+  // Spawn the threads
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i].reset(new std::thread(find_cut_edges, std::cref(pt), std::ref(tilequeue),
+                                     std::ref(lock), std::ref(results[i])));
+  }
+
+  // Wait for threads to finish
+  for (auto& thread : threads) {
+    thread->join();
+  }
+
+  // Gather the edges between cells of all the threads
+  std::vector<CellPartition::cut_edge_t> cut_edges;
+  for (auto& result : results) {
+    auto edges = result.get_future().get();
+    cut_edges.insert(cut_edges.end(), edges.begin(), edges.end());
+  }
+  CellPartition partition(std::move(cut_edges));
+  partition.Save(partition_file);
+  LOG_INFO("Wrote " + std::to_string(partition.cell_count()) + " cells with " +
+           std::to_string(partition.cut_edge_count()) + " edges between them to " +
+           partition_file);
+}
+
+} // namespace mjolnir
+} // namespace valhalla
@@ -18,10 +18,6 @@ using namespace valhalla::baldr;
 using namespace valhalla::mjolnir;
 
 namespace {
-// This value controls the initial size of the Id table. If this is exceeded
-// the table will be resized. We should keep this number just higher than
-// reality to maintain performance
-constexpr uint64_t kMaxOSMNodesHint = 1300000000;
 
 struct admin_callback : public OSMPBF::Callback {
 public:
@@ -30,10 +26,9 @@ public:
   virtual ~admin_callback() {
   }
   // Construct PBFAdminParser based on properties file and input PBF extract
-  admin_callback(const boost::property_tree::ptree& pt, OSMAdminData& osmdata)
+  admin_callback(const boost::property_tree::ptree& /*pt*/, OSMAdminData& osmdata)
       : lua_(std::string(lua_admin_lua, lua_admin_lua + lua_admin_lua_len)),
-        shape_(pt.get<unsigned long>("id_table_size", kMaxOSMNodesHint)),
-        members_(pt.get<unsigned long>("id_table_size", kMaxOSMNodesHint)), osm_admin_data_(osmdata) {
+        osm_admin_data_(osmdata) {
   }
 
   virtual void
@@ -125,9 +120,9 @@ public:
   // Lua Tag Transformation class
   LuaTagTransform lua_;
 
-  // Mark the OSM Ids used by the ways and relations
-  // TODO: just use robin_hood::unordered_set<uint64_t> since these are probably relatively small
-  UnorderedIdTable shape_, members_;
+  // Mark the OSM Ids used by the ways and relations. These are set in random order while parsing
+  // one entity type, finished and only queried while parsing the next
+  CompactIdTable shape_, members_;
 
   // Pointer to all the OSM data (for use by callbacks)
   OSMAdminData& osm_admin_data_;
@@ -165,6 +160,7 @@ OSMAdminData PBFAdminParser::Parse(const boost::property_tree::ptree& pt,
                                                         OSMPBF::Interest::CHANGESETS),
                           callback);
   }
+  callback.members_.finish();
   LOG_INFO("Finished with " + std::to_string(osmdata.admins_.size()) +
            " admin polygons comprised of " + std::to_string(osmdata.osm_way_count) + " ways");
 
@@ -176,6 +172,7 @@ OSMAdminData PBFAdminParser::Parse(const boost::property_tree::ptree& pt,
                                                         OSMPBF::Interest::CHANGESETS),
                           callback);
   }
+  callback.shape_.finish();
   LOG_INFO("Finished with " + std::to_string(osmdata.way_map.size()) + " ways comprised of " +
            std::to_string(osmdata.node_count) + " nodes");
 
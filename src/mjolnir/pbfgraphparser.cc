@@ -3,6 +3,7 @@
 #include "mjolnir/util.h"
 
 #include "graph_lua_proc.h"
+#include "mjolnir/compiledtagtransform.h"
 #include "mjolnir/luatagtransform.h"
 #include "mjolnir/osmaccess.h"
 
@@ -168,9 +169,18 @@ public:
     use_rest_area_ = pt.get<bool>("data_processing.use_rest_area", false);
     use_admin_db_ = pt.get<bool>("data_processing.use_admin_db", true);
 
-    empty_node_results_ = lua_.Transform(OSMType::kNode, 0, {});
-    empty_way_results_ = lua_.Transform(OSMType::kWay, 0, {});
-    empty_relation_results_ = lua_.Transform(OSMType::kRelation, 0, {});
+    // the compiled transform mirrors the default lua so it cant be used with a custom script
+    if (pt.get<bool>("data_processing.use_compiled_tag_transform", false)) {
+      if (pt.get_optional<std::string>("graph_lua_name")) {
+        LOG_WARN("Compiled tag transform is disabled when using a custom LUA script");
+      } else {
+        compiled_.reset(new CompiledTagTransform());
+      }
+    }
+
+    empty_node_results_ = Transform(OSMType::kNode, 0, {});
+    empty_way_results_ = Transform(OSMType::kWay, 0, {});
+    empty_relation_results_ = Transform(OSMType::kRelation, 0, {});
 
     tag_handlers_["driving_side"] = [this]() {
       if (!use_admin_db_) {
@@ -882,6 +892,11 @@ public:
     };
   }
 
+  // Transforms the tags natively when enabled and with lua otherwise
+  Tags Transform(OSMType type, uint64_t osmid, const Tags& tags) {
+    return compiled_ ? compiled_->Transform(type, osmid, tags) : lua_.Transform(type, osmid, tags);
+  }
+
   static std::string get_lua(const boost::property_tree::ptree& pt) {
     auto graph_lua_name = pt.get_optional<std::string>("graph_lua_name");
     if (graph_lua_name) {
@@ -910,7 +925,7 @@ public:
     if (bss_nodes_) {
       // Get tags - do't bother with Lua callout if the taglist is empty
       if (tags.size() > 0) {
-        results = lua_.Transform(OSMType::kNode, osmid, tags);
+        results = Transform(OSMType::kNode, osmid, tags);
       } else {
         results = empty_node_results_;
       }
@@ -956,7 +971,7 @@ public:
     // Get tags if not already available.  Don't bother calling Lua if there
     // are no OSM tags to process.
     if (tags.size() > 0) {
-      results = results ? results : lua_.Transform(OSMType::kNode, osmid, tags);
+      results = results ? results : Transform(OSMType::kNode, osmid, tags);
     } else {
       results = results ? results : empty_node_results_;
     }
@@ -1120,7 +1135,7 @@ public:
     // Transform tags. If no results that means the way does not have tags
     // suitable for use in routing.
     Tags results =
-        tags.size() == 0 ? empty_way_results_ : lua_.Transform(OSMType::kWay, osmid_, tags);
+        tags.size() == 0 ? empty_way_results_ : Transform(OSMType::kWay, osmid_, tags);
     if (results.size() == 0) {
       return;
     }
@@ -1601,7 +1616,7 @@ public:
 
     // Get tags
     Tags results =
-        tags.empty() ? empty_relation_results_ : lua_.Transform(OSMType::kRelation, osmid, tags);
+        tags.empty() ? empty_relation_results_ : Transform(OSMType::kRelation, osmid, tags);
     if (results.size() == 0) {
       return;
     }
@@ -2088,6 +2103,9 @@ public:
   // Lua Tag Transformation class
   LuaTagTransform lua_;
 
+  // Optional native replacement for the lua transform, each callback owns its own
+  std::unique_ptr<CompiledTagTransform> compiled_;
+
   // Pointer to all the OSM data (for use by callbacks)
   OSMData& osmdata_;
 
@@ -0,0 +1,318 @@
+#include "mjolnir/trafficbuilder.h"
+#include "baldr/graphreader.h"
+#include "filesystem.h"
+#include "midgard/logging.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace valhalla::baldr;
+
+namespace {
+
+using tar_header_t = valhalla::midgard::tar::header_t;
+static_assert(sizeof(tar_header_t) == 512, "Tar headers are a block");
+
+// writes a regular file entry, its data padded out to the next block
+void write_entry(std::ofstream& out, const std::string& name, const std::string& data) {
+  tar_header_t header{};
+  if (name.size() >= sizeof(header.name)) {
+    throw std::runtime_error("Traffic tile name too long for tar header: " + name);
+  }
+  std::strncpy(header.name, name.c_str(), sizeof(header.name) - 1);
+  std::snprintf(header.mode, sizeof(header.mode), "%07o", 0644);
+  std::snprintf(header.uid, sizeof(header.uid), "%07o", 0);
+  std::snprintf(header.gid, sizeof(header.gid), "%07o", 0);
+  std::snprintf(header.size, sizeof(header.size), "%011llo",
+                static_cast<unsigned long long>(data.size()));
+  std::snprintf(header.mtime, sizeof(header.mtime), "%011llo",
+                static_cast<unsigned long long>(time(nullptr)));
+  header.typeflag = '0';
+  std::memcpy(header.magic, "ustar", sizeof(header.magic));
+  std::memcpy(header.version, "00", sizeof(header.version));
+
+  // the checksum is taken with the checksum field itself blank
+  std::memset(header.chksum, ' ', sizeof(header.chksum));
+  unsigned int sum = 0;
+  for (size_t i = 0; i < sizeof(header); ++i) {
+    sum += reinterpret_cast<const unsigned char*>(&header)[i];
+  }
+  std::snprintf(header.chksum, sizeof(header.chksum), "%06o", sum);
+
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(data.data(), data.size());
+  const std::string padding((sizeof(header) - data.size() % sizeof(header)) % sizeof(header), '\0');
+  out.write(padding.data(), padding.size());
+}
+
+// kph to the 2kph resolution of the tile, empty is unknown
+bool encode_speed(const std::string& field, uint32_t& encoded) {
+  if (field.empty()) {
+    encoded = UNKNOWN_TRAFFIC_SPEED_RAW;
+    return true;
+  }
+  auto kph = std::stof(field);
+  if (!(kph >= 0.f) || kph > MAX_TRAFFIC_SPEED_KPH) {
+    return false;
+  }
+  encoded = static_cast<uint32_t>(std::round(kph / 2.f));
+  return true;
+}
+
+// 0 is unknown so free flow to standstill goes from 1 to 63
+bool encode_congestion(const std::string& field, uint32_t& encoded) {
+  if (field.empty()) {
+    encoded = UNKNOWN_CONGESTION_VAL;
+    return true;
+  }
+  auto congestion = std::stof(field);
+  if (!(congestion >= 0.f) || congestion > 1.f) {
+    return false;
+  }
+  encoded = 1 + static_cast<uint32_t>(std::round(congestion * (MAX_CONGESTION_VAL - 1)));
+  return true;
+}
+
+// fraction of the edge to 255ths of it
+bool encode_breakpoint(const std::string& field, uint32_t& encoded) {
+  auto breakpoint = field.empty() ? 1.f : std::stof(field);
+  if (!(breakpoint >= 0.f) || breakpoint > 1.f) {
+    return false;
+  }
+  encoded = static_cast<uint32_t>(std::round(breakpoint * 255.f));
+  return true;
+}
+
+} // namespace
+
+namespace valhalla {
+namespace mjolnir {
+
+size_t TrafficBuilder::Build(const boost::property_tree::ptree& pt) {
+  const auto traffic_extract = pt.get<std::string>("mjolnir.traffic_extract");
+
+  // the reader shouldnt map the extract we are about to replace
+  auto reader_config = pt.get_child("mjolnir");
+  reader_config.erase("traffic_extract");
+  GraphReader reader(reader_config);
+
+  // write the whole thing off to the side so nothing ever maps half an archive
+  const auto temp_extract = traffic_extract + ".tmp";
+  std::ofstream out(temp_extract, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Could not open " + temp_extract + " for writing");
+  }
+
+  size_t count = 0;
+  for (const auto& tile_id : reader.GetTileSet()) {
+    auto tile = reader.GetGraphTile(tile_id);
+    if (!tile) {
+      continue;
+    }
+
+    // the header followed by a blank speed for every directed edge and two spare words
+    TrafficTileHeader header{};
+    header.tile_id = tile_id.value;
+    header.traffic_tile_version = TRAFFIC_TILE_VERSION;
+    header.directed_edge_count = tile->header()->directededgecount();
+    std::string data(sizeof(header) + header.directed_edge_count * sizeof(TrafficSpeed) +
+                         2 * sizeof(uint32_t),
+                     '\0');
+    std::memcpy(&data[0], &header, sizeof(header));
+    write_entry(out, GraphTile::FileSuffix(tile_id), data);
+    ++count;
+
+    if (reader.OverCommitted()) {
+      reader.Trim();
+    }
+  }
+
+  // tars end with two blank blocks
+  const std::string end(2 * sizeof(tar_header_t), '\0');
+  out.write(end.data(), end.size());
+  out.close();
+  if (!out) {
+    throw std::runtime_error("Could not write " + temp_extract);
+  }
+  if (!filesystem::rename(temp_extract, traffic_extract)) {
+    throw std::runtime_error("Could not move " + temp_extract + " to " + traffic_extract);
+  }
+  LOG_INFO("Wrote " + std::to_string(count) + " traffic tiles to " + traffic_extract);
+  return count;
+}
+
+TrafficUpdater::TrafficUpdater(const std::string& traffic_extract) {
+  // find the tiles using a read only mapping
+  size_t size = 0;
+  {
+    midgard::tar archive(traffic_extract);
+    size = archive.mm.size();
+    for (const auto& entry : archive.contents) {
+      GraphId tile_id;
+      try {
+        tile_id = GraphTile::GetTileId(entry.first);
+      } catch (...) {
+        // not everything in the archive has to be a tile
+        continue;
+      }
+      // a tile has to hold at least as many speeds as its header says
+      const auto* header = reinterpret_cast<const TrafficTileHeader*>(entry.second.first);
+      if (entry.second.second < sizeof(TrafficTileHeader) ||
+          entry.second.second <
+              sizeof(TrafficTileHeader) + header->directed_edge_count * sizeof(TrafficSpeed)) {
+        LOG_WARN("Skipping truncated traffic tile " + entry.first);
+        continue;
+      }
+      if (header->traffic_tile_version != TRAFFIC_TILE_VERSION) {
+        LOG_WARN("Skipping traffic tile " + entry.first + " with version " +
+                 std::to_string(header->traffic_tile_version));
+        continue;
+      }
+      tiles_.emplace(tile_id, entry.second.first - archive.mm.get());
+    }
+  }
+  if (tiles_.empty()) {
+    throw std::runtime_error("Traffic extract " + traffic_extract + " contains no traffic tiles");
+  }
+
+  // and write to it through a shared one so that everyone else mapping it sees the changes
+  memory_.map(traffic_extract, size);
+}
+
+bool TrafficUpdater::Update(const GraphId& edge_id, const TrafficSpeed& speed) {
+  auto found = tiles_.find(edge_id.Tile_Base());
+  if (found == tiles_.cend()) {
+    return false;
+  }
+  auto* tile = memory_.get() + found->second;
+  auto* header = reinterpret_cast<volatile TrafficTileHeader*>(tile);
+  if (edge_id.id() >= header->directed_edge_count) {
+    return false;
+  }
+
+  // incidents are flagged by whoever loads them, not by the speed feed
+  auto* record =
+      reinterpret_cast<volatile uint64_t*>(tile + sizeof(TrafficTileHeader)) + edge_id.id();
+  TrafficSpeed updated = speed;
+  updated.has_incidents = reinterpret_cast<volatile TrafficSpeed*>(record)->has_incidents;
+
+  // records are 8 byte aligned within the tile and tiles are block aligned within the archive so
+  // this is a single store that readers see all or nothing of
+  uint64_t bits;
+  std::memcpy(&bits, &updated, sizeof(bits));
+  *record = bits;
+  header->last_update = static_cast<uint64_t>(time(nullptr));
+  return true;
+}
+
+size_t TrafficUpdater::Update(std::istream& csv) {
+  size_t updated = 0, skipped = 0;
+  std::string line;
+  GraphId edge_id;
+  TrafficSpeed speed;
+  while (std::getline(csv, line)) {
+    if (!Parse(line, edge_id, speed)) {
+      skipped += !line.empty() && line.front() != '#';
+      continue;
+    }
+    if (Update(edge_id, speed)) {
+      ++updated;
+    } else {
+      ++skipped;
+    }
+  }
+  if (skipped) {
+    LOG_WARN("Skipped " + std::to_string(skipped) + " traffic updates");
+  }
+  return updated;
+}
+
+bool TrafficUpdater::Parse(const std::string& line, GraphId& edge_id, TrafficSpeed& speed) {
+  if (line.empty() || line.front() == '#') {
+    return false;
+  }
+
+  // split it keeping the empty fields and ignoring windows line endings
+  const auto trimmed = line.back() == '\r' ? line.substr(0, line.size() - 1) : line;
+  std::vector<std::string> fields;
+  std::stringstream stream(trimmed);
+  std::string field;
+  while (std::getline(stream, field, ',')) {
+    fields.push_back(field);
+  }
+  if (!trimmed.empty() && trimmed.back() == ',') {
+    fields.emplace_back();
+  }
+  if (fields.size() != 2 && fields.size() != 3 && fields.size() != 9) {
+    return false;
+  }
+
+  try {
+    edge_id = fields[0].find('/') != std::string::npos ? GraphId(fields[0])
+                                                        : GraphId(std::stoull(fields[0]));
+    if (!edge_id.Is_Valid()) {
+      return false;
+    }
+
+    // one speed for the whole edge
+    uint32_t s1, s2 = UNKNOWN_TRAFFIC_SPEED_RAW, s3 = UNKNOWN_TRAFFIC_SPEED_RAW;
+    uint32_t c1 = UNKNOWN_CONGESTION_VAL, c2 = UNKNOWN_CONGESTION_VAL, c3 = UNKNOWN_CONGESTION_VAL;
+    uint32_t b1 = 255, b2 = 255;
+    if (fields.size() < 9) {
+      if (!encode_speed(fields[1], s1) ||
+          (fields.size() == 3 && !encode_congestion(fields[2], c1))) {
+        return false;
+      }
+      // unknown is a blank record
+      speed = s1 == UNKNOWN_TRAFFIC_SPEED_RAW ? TrafficSpeed{}
+                                              : TrafficSpeed{s1, s1, s2, s3, b1, b2, c1, c2, c3,
+                                                             false};
+      return true;
+    }
+
+    // or up to three subsegments
+    if (!encode_speed(fields[1], s1) || !encode_congestion(fields[2], c1) ||
+        !encode_breakpoint(fields[3], b1) || !encode_speed(fields[4], s2) ||
+        !encode_congestion(fields[5], c2) || !encode_breakpoint(fields[6], b2) ||
+        !encode_speed(fields[7], s3) || !encode_congestion(fields[8], c3) || b2 < b1) {
+      return false;
+    }
+    // a first breakpoint of 0 marks the record as blank so the first subsegment is never empty
+    b1 = std::max(b1, 1u);
+    b2 = std::max(b2, b1);
+
+    // the overall speed is what it takes to travel the known open parts of the edge
+    const uint32_t speeds[] = {s1, s2, s3};
+    const uint32_t congestions[] = {c1, c2, c3};
+    const uint32_t lengths[] = {b1, b2 - b1, 255 - b2};
+    float length = 0.f, time = 0.f;
+    bool known = false;
+    for (size_t i = 0; i < 3; ++i) {
+      if (lengths[i] == 0 || speeds[i] == UNKNOWN_TRAFFIC_SPEED_RAW) {
+        continue;
+      }
+      known = true;
+      // a standstill is as closed as a speed of 0
+      if (speeds[i] > 0 && congestions[i] != MAX_CONGESTION_VAL) {
+        length += lengths[i];
+        time += lengths[i] / static_cast<float>(speeds[i]);
+      }
+    }
+    if (!known) {
+      speed = TrafficSpeed{};
+      return true;
+    }
+    const uint32_t overall = time > 0.f ? static_cast<uint32_t>(std::round(length / time)) : 0;
+    speed = TrafficSpeed{overall, s1, s2, s3, b1, b2, c1, c2, c3, false};
+    return true;
+  } catch (...) { return false; }
+}
+
+} // namespace mjolnir
+} // namespace valhalla
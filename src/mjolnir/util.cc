@@ -6,6 +6,7 @@
 #include "midgard/logging.h"
 #include "midgard/point2.h"
 #include "midgard/polyline2.h"
+#include "mjolnir/arcflagbuilder.h"
 #include "mjolnir/bssbuilder.h"
 #include "mjolnir/elevationbuilder.h"
 #include "mjolnir/graphbuilder.h"
@@ -13,7 +14,9 @@
 #include "mjolnir/graphfilter.h"
 #include "mjolnir/graphvalidator.h"
 #include "mjolnir/hierarchybuilder.h"
+#include "mjolnir/landmarkbuilder.h"
 #include "mjolnir/osmpbfparser.h"
+#include "mjolnir/partitionbuilder.h"
 #include "mjolnir/pbfgraphparser.h"
 #include "mjolnir/restrictionbuilder.h"
 #include "mjolnir/shortcutbuilder.h"
@@ -381,6 +384,33 @@ bool build_tile_set(const boost::property_tree::ptree& original_config,
     GraphValidator::Validate(config);
   }
 
+  // Split the finished graph into cells for the customizable overlay if a partition file is wanted
+  if (start_stage <= BuildStage::kPartition && BuildStage::kPartition <= end_stage) {
+    if (config.get_optional<std::string>("mjolnir.partition_file")) {
+      PartitionBuilder::Build(config);
+    } else {
+      LOG_INFO("Skipping partition builder");
+    }
+  }
+
+  // Measure the distances to landmarks for the A* heuristic if a landmark file is wanted
+  if (start_stage <= BuildStage::kLandmarks && BuildStage::kLandmarks <= end_stage) {
+    if (config.get_optional<std::string>("mjolnir.landmark_file")) {
+      LandmarkBuilder::Build(config);
+    } else {
+      LOG_INFO("Skipping landmark builder");
+    }
+  }
+
+  // Flag the highway and arterial edges with the regions they lead to if an arc flag file is wanted
+  if (start_stage <= BuildStage::kArcFlags && BuildStage::kArcFlags <= end_stage) {
+    if (config.get_optional<std::string>("mjolnir.arc_flags_file")) {
+      ArcFlagBuilder::Build(config);
+    } else {
+      LOG_INFO("Skipping arc flag builder");
+    }
+  }
+
   // Cleanup bin files
   if (start_stage <= BuildStage::kCleanup && BuildStage::kCleanup <= end_stage) {
     LOG_INFO("Cleaning up temporary *.bin files within " + tile_dir);
@@ -0,0 +1,129 @@
+#include "baldr/rapidjson_utils.h"
+#include "filesystem.h"
+#include "midgard/logging.h"
+#include "midgard/util.h"
+#include "mjolnir/trafficbuilder.h"
+
+#include <boost/optional.hpp>
+#include <boost/program_options.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+namespace bpo = boost::program_options;
+
+int main(int argc, char** argv) {
+  std::string inline_config;
+  std::string config_file_path;
+  std::vector<std::string> updates;
+
+  bpo::options_description options(
+      "valhalla_build_traffic " VALHALLA_VERSION "\n"
+      "\n"
+      " Usage: valhalla_build_traffic [options]\n"
+      "\n"
+      "creates the live traffic extract at mjolnir.traffic_extract and updates the speeds in it. "
+      "Updates are csv lines of edge_id,speed[,congestion] or "
+      "edge_id,speed1,congestion1,breakpoint1,speed2,congestion2,breakpoint2,speed3,congestion3 "
+      "and are written in place, running services see them without a restart."
+      "\n"
+      "\n");
+
+  options.add_options()("help,h", "Print this help message.")("version,v",
+                                                              "Print the version of this software.")(
+      "config,c", boost::program_options::value<std::string>(&config_file_path),
+      "Path to the json configuration file.")("inline-config,i",
+                                              boost::program_options::value<std::string>(
+                                                  &inline_config),
+                                              "Inline json config.")(
+      "create", "Replace the traffic extract with one where every edge has no traffic.")(
+      "update,u", bpo::value<std::vector<std::string>>(&updates),
+      "Csv file of speed updates to apply, - reads them from stdin until it closes. Can be given "
+      "more than once.");
+
+  bpo::positional_options_description pos_options;
+  pos_options.add("update", -1);
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::command_line_parser(argc, argv).options(options).positional(pos_options).run(),
+               vm);
+    bpo::notify(vm);
+  } catch (std::exception& e) {
+    std::cerr << "Unable to parse command line options because: " << e.what() << "\n"
+              << "This is a bug, please report it at " PACKAGE_BUGREPORT << "\n";
+    return EXIT_FAILURE;
+  }
+
+  if (vm.count("help")) {
+    std::cout << options << "\n";
+    return EXIT_SUCCESS;
+  }
+
+  if (vm.count("version")) {
+    std::cout << "valhalla_build_traffic " << VALHALLA_VERSION << "\n";
+    return EXIT_SUCCESS;
+  }
+
+  if (!vm.count("create") && updates.empty()) {
+    std::cerr << "Nothing to do, either --create the extract or --update it\n\n" << options << "\n";
+    return EXIT_FAILURE;
+  }
+
+  // Read the config file
+  boost::property_tree::ptree pt;
+  if (vm.count("inline-config")) {
+    std::stringstream ss;
+    ss << inline_config;
+    rapidjson::read_json(ss, pt);
+  } else if (vm.count("config") && filesystem::is_regular_file(config_file_path)) {
+    rapidjson::read_json(config_file_path, pt);
+  } else {
+    std::cerr << "Configuration is required\n\n" << options << "\n\n";
+    return EXIT_FAILURE;
+  }
+
+  // configure logging
+  boost::optional<boost::property_tree::ptree&> logging_subtree =
+      pt.get_child_optional("mjolnir.logging");
+  if (logging_subtree) {
+    auto logging_config =
+        valhalla::midgard::ToMap<const boost::property_tree::ptree&,
+                                 std::unordered_map<std::string, std::string>>(logging_subtree.get());
+    valhalla::midgard::logging::Configure(logging_config);
+  }
+
+  try {
+    if (vm.count("create")) {
+      valhalla::mjolnir::TrafficBuilder::Build(pt);
+    }
+
+    if (!updates.empty()) {
+      valhalla::mjolnir::TrafficUpdater updater(pt.get<std::string>("mjolnir.traffic_extract"));
+      LOG_INFO("Updating " + std::to_string(updater.size()) + " traffic tiles");
+      for (const auto& update : updates) {
+        size_t count = 0;
+        if (update == "-") {
+          count = updater.Update(std::cin);
+        } else {
+          std::ifstream file(update);
+          if (!file) {
+            LOG_ERROR("Could not open " + update);
+            return EXIT_FAILURE;
+          }
+          count = updater.Update(file);
+        }
+        LOG_INFO("Updated " + std::to_string(count) + " edges from " + update);
+      }
+    }
+  } catch (const std::exception& e) {
+    LOG_ERROR(e.what());
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
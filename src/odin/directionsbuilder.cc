@@ -1,7 +1,9 @@
 #include <iostream>
 #include <unordered_map>
 
+#include "midgard/constants.h"
 #include "midgard/logging.h"
+#include "midgard/profiling.h"
 #include "odin/directionsbuilder.h"
 #include "odin/enhancedtrippath.h"
 #include "odin/maneuversbuilder.h"
@@ -66,6 +68,7 @@ const std::unordered_map<int, DirectionsLeg_TravelMode> translate_travel_mode{
 // calls PopulateDirectionsLeg to transform the maneuver list into the
 // trip directions.
 void DirectionsBuilder::Build(Api& api) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kNarrative);
   const auto& options = api.options();
   for (auto& trip_route : *api.mutable_trip()->mutable_routes()) {
     auto& directions_route = *api.mutable_directions()->mutable_routes()->Add();
@@ -77,24 +80,29 @@ void DirectionsBuilder::Build(Api& api) {
         throw valhalla_exception_t{210};
       }
 
+      // Populate everything but the maneuvers straight from the trip path
+      PopulateDirectionsLegSummary(options, trip_path, trip_directions);
+
+      // Without maneuvers that is all there is to the directions
+      if (options.directions_type() == DirectionsType::none) {
+        continue;
+      }
+
       // Create an enhanced trip path from the specified trip_path
       EnhancedTripLeg etp(trip_path);
 
-      // Produce maneuvers if desired
-      std::list<Maneuver> maneuvers;
-      if (options.directions_type() != DirectionsType::none) {
-        // Update the heading of ~0 length edges
-        UpdateHeading(&etp);
+      // Update the heading of ~0 length edges
+      UpdateHeading(&etp);
 
-        ManeuversBuilder maneuversBuilder(options, &etp);
-        maneuvers = maneuversBuilder.Build();
+      // Produce maneuvers
+      ManeuversBuilder maneuversBuilder(options, &etp);
+      std::list<Maneuver> maneuvers = maneuversBuilder.Build();
 
-        // Create the instructions if desired
-        if (options.directions_type() == DirectionsType::instructions) {
-          std::unique_ptr<NarrativeBuilder> narrative_builder =
-              NarrativeBuilderFactory::Create(options, &etp);
-          narrative_builder->Build(maneuvers);
-        }
+      // Create the instructions if desired
+      if (options.directions_type() == DirectionsType::instructions) {
+        std::unique_ptr<NarrativeBuilder> narrative_builder =
+            NarrativeBuilderFactory::Create(options, &etp);
+        narrative_builder->Build(maneuvers);
       }
 
       // Return trip directions
@@ -128,20 +136,12 @@ void DirectionsBuilder::UpdateHeading(EnhancedTripLeg* etp) {
   }
 }
 
-// Returns the trip directions based on the specified directions options,
+// Populates the maneuvers of the trip directions based on the specified directions options,
 // trip path, and maneuver list.
 void DirectionsBuilder::PopulateDirectionsLeg(const Options& options,
                                               EnhancedTripLeg* etp,
                                               std::list<Maneuver>& maneuvers,
                                               DirectionsLeg& trip_directions) {
-  // Populate trip and leg IDs
-  trip_directions.set_trip_id(etp->trip_id());
-  trip_directions.set_leg_id(etp->leg_id());
-  trip_directions.set_leg_count(etp->leg_count());
-
-  // Populate locations
-  trip_directions.mutable_location()->CopyFrom(etp->location());
-
   // Populate maneuvers
   for (const auto& maneuver : maneuvers) {
     auto* trip_maneuver = trip_directions.add_maneuver();
@@ -385,25 +385,48 @@ void DirectionsBuilder::PopulateDirectionsLeg(const Options& options,
     }
   }
 
-  // Populate summary
-  trip_directions.mutable_summary()->set_length(etp->GetLength(options.units()));
-  trip_directions.mutable_summary()->set_time(
-      etp->node(etp->GetLastNodeIndex()).cost().elapsed_cost().seconds());
-  auto mutable_bbox = trip_directions.mutable_summary()->mutable_bbox();
-  mutable_bbox->mutable_min_ll()->set_lat(etp->bbox().min_ll().lat());
-  mutable_bbox->mutable_min_ll()->set_lng(etp->bbox().min_ll().lng());
-  mutable_bbox->mutable_max_ll()->set_lat(etp->bbox().max_ll().lat());
-  mutable_bbox->mutable_max_ll()->set_lng(etp->bbox().max_ll().lng());
+}
 
-  // Populate shape
-  trip_directions.set_shape(etp->shape());
+// Populates the trip directions with everything but the maneuvers straight from the trip path
+void DirectionsBuilder::PopulateDirectionsLegSummary(const Options& options,
+                                                     const TripLeg& trip_path,
+                                                     DirectionsLeg& trip_directions) {
+  // Populate trip and leg IDs
+  trip_directions.set_trip_id(trip_path.trip_id());
+  trip_directions.set_leg_id(trip_path.leg_id());
+  trip_directions.set_leg_count(trip_path.leg_count());
 
-  // Populate has_time_restrictions
+  // Populate locations
+  trip_directions.mutable_location()->CopyFrom(trip_path.location());
+
+  // Sum the length and check for time restrictions in one pass over the nodes
+  float length = 0.0f;
   bool has_time_restrictions = false;
-  for (const auto& node : etp->node()) {
+  for (const auto& node : trip_path.node()) {
+    if (node.has_edge()) {
+      length += node.edge().length_km();
+    }
     has_time_restrictions = node.edge().has_time_restrictions() || has_time_restrictions;
   }
-  trip_directions.mutable_summary()->set_has_time_restrictions(has_time_restrictions);
+  if (options.units() == Options::miles) {
+    length *= midgard::kMilePerKm;
+  }
+
+  // Populate summary
+  auto* summary = trip_directions.mutable_summary();
+  summary->set_length(length);
+  summary->set_time(trip_path.node(trip_path.node_size() - 1).cost().elapsed_cost().seconds());
+  auto mutable_bbox = summary->mutable_bbox();
+  mutable_bbox->mutable_min_ll()->set_lat(trip_path.bbox().min_ll().lat());
+  mutable_bbox->mutable_min_ll()->set_lng(trip_path.bbox().min_ll().lng());
+  mutable_bbox->mutable_max_ll()->set_lat(trip_path.bbox().max_ll().lat());
+  mutable_bbox->mutable_max_ll()->set_lng(trip_path.bbox().max_ll().lng());
+
+  // Populate shape
+  trip_directions.set_shape(trip_path.shape());
+
+  // Populate has_time_restrictions
+  summary->set_has_time_restrictions(has_time_restrictions);
 }
 
 } // namespace odin
@@ -112,8 +112,13 @@ std::list<Maneuver> ManeuversBuilder::Build() {
   // Confirm maneuver type assignment
   ConfirmManeuverTypeAssignment(maneuvers);
 
+  // Some attributes are only used to form the narrative, skip them when it is not wanted
+  const bool narrate = options_.directions_type() == DirectionsType::instructions;
+
   // Mark the maneuvers that have traversable outbound intersecting edges
-  SetTraversableOutboundIntersectingEdgeFlags(maneuvers);
+  if (narrate) {
+    SetTraversableOutboundIntersectingEdgeFlags(maneuvers);
+  }
 
   // Process roundabouts
   ProcessRoundabouts(maneuvers);
@@ -141,7 +146,9 @@ std::list<Maneuver> ManeuversBuilder::Build() {
   // activate the correct lanes.
   ProcessTurnLanes(maneuvers);
 
-  ProcessVerbalSuccinctTransitionInstruction(maneuvers);
+  if (narrate) {
+    ProcessVerbalSuccinctTransitionInstruction(maneuvers);
+  }
 
 #ifdef LOGGING_LEVEL_TRACE
   int final_man_id = 1;
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <stdexcept>
 
 #include <boost/property_tree/ptree.hpp>
@@ -30,11 +31,89 @@ std::unordered_map<K, V> as_unordered_map(boost::property_tree::ptree const& pt,
   return items;
 }
 
+// The tag strings indexed by PhraseTag
+const std::array<std::string, static_cast<size_t>(valhalla::odin::PhraseTag::kCount)> kPhraseTags{
+    kCardinalDirectionTag,
+    kRelativeDirectionTag,
+    kOrdinalValueTag,
+    kStreetNamesTag,
+    kPreviousStreetNamesTag,
+    kBeginStreetNamesTag,
+    kCrossStreetNamesTag,
+    kRoundaboutExitStreetNamesTag,
+    kRoundaboutExitBeginStreetNamesTag,
+    kRampExitNumbersVisualTag,
+    kLengthTag,
+    kDestinationTag,
+    kCurrentVerbalCueTag,
+    kNextVerbalCueTag,
+    kKilometersTag,
+    kMetersTag,
+    kMilesTag,
+    kTenthsOfMilesTag,
+    kFeetTag,
+    kNumberSignTag,
+    kBranchSignTag,
+    kTowardSignTag,
+    kNameSignTag,
+    kJunctionNameTag,
+    kFerryLabelTag,
+    kTransitPlatformTag,
+    kStationLabelTag,
+    kTimeTag,
+    kTransitNameTag,
+    kTransitHeadSignTag,
+    kTransitPlatformCountTag,
+    kTransitPlatformCountLabelTag,
+};
+
 } // namespace
 
 namespace valhalla {
 namespace odin {
 
+PhraseTemplate::PhraseTemplate(const std::string& phrase) : phrase_(phrase) {
+  constexpr auto kLiteral = static_cast<uint8_t>(PhraseTag::kCount);
+  size_t literal_start = 0;
+  size_t pos = phrase_.find('<');
+  while (pos != std::string::npos) {
+    // A '<' which does not start a known tag is just text
+    auto tag = std::find_if(kPhraseTags.cbegin(), kPhraseTags.cend(), [this, pos](const auto& t) {
+      return phrase_.compare(pos, t.size(), t) == 0;
+    });
+    if (tag == kPhraseTags.cend()) {
+      pos = phrase_.find('<', pos + 1);
+      continue;
+    }
+
+    if (pos > literal_start) {
+      segments_.push_back({static_cast<uint32_t>(literal_start),
+                           static_cast<uint32_t>(pos - literal_start), kLiteral});
+    }
+    segments_.push_back({static_cast<uint32_t>(pos), static_cast<uint32_t>(tag->size()),
+                         static_cast<uint8_t>(tag - kPhraseTags.cbegin())});
+    literal_start = pos + tag->size();
+    pos = phrase_.find('<', literal_start);
+  }
+  if (literal_start < phrase_.size()) {
+    segments_.push_back({static_cast<uint32_t>(literal_start),
+                         static_cast<uint32_t>(phrase_.size() - literal_start), kLiteral});
+  }
+}
+
+void PhraseTemplate::Form(std::string& instruction, const PhraseValues& values) const {
+  instruction.clear();
+  for (const auto& segment : segments_) {
+    const std::string* value =
+        segment.tag < static_cast<uint8_t>(PhraseTag::kCount) ? values.Get(segment.tag) : nullptr;
+    if (value) {
+      instruction.append(*value);
+    } else {
+      instruction.append(phrase_, segment.offset, segment.length);
+    }
+  }
+}
+
 NarrativeDictionary::NarrativeDictionary(const std::string& language_tag,
                                          const boost::property_tree::ptree& narrative_pt) {
   this->language_tag = language_tag;
@@ -320,6 +399,13 @@ void NarrativeDictionary::Load(PhraseSet& phrase_handle,
                                const boost::property_tree::ptree& phrase_pt) {
 
   phrase_handle.phrases = as_unordered_map<std::string, std::string>(phrase_pt, kPhrasesKey);
+
+  // Split up the phrases at their tags so instructions can be formed without searching them
+  phrase_handle.templates.clear();
+  for (const auto& phrase : phrase_handle.phrases) {
+    phrase_handle.templates.emplace(static_cast<uint8_t>(std::stoul(phrase.first)),
+                                    PhraseTemplate(phrase.second));
+  }
 }
 
 void NarrativeDictionary::Load(StartSubset& start_handle,
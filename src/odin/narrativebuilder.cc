@@ -497,14 +497,16 @@ std::string NarrativeBuilder::FormVerbalAlertApproachInstruction(float distance,
   instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.approach_verbal_alert_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.approach_verbal_alert_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kLengthTag,
-                     FormLength(distance, dictionary_.approach_verbal_alert_subset.metric_lengths,
-                                dictionary_.approach_verbal_alert_subset.us_customary_lengths));
-  boost::replace_all(instruction, kCurrentVerbalCueTag, verbal_cue);
+  PhraseValues values;
+  values.Set(PhraseTag::kLength,
+             FormLength(distance, dictionary_.approach_verbal_alert_subset.metric_lengths,
+                        dictionary_.approach_verbal_alert_subset.us_customary_lengths));
+  values.Set(PhraseTag::kCurrentVerbalCue, verbal_cue);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -562,13 +564,15 @@ std::string NarrativeBuilder::FormStartInstruction(Maneuver& maneuver) {
     phrase_id += 16;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.start_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.start_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kCardinalDirectionTag, cardinal_direction);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
+  PhraseValues values;
+  values.Set(PhraseTag::kCardinalDirection, cardinal_direction);
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kBeginStreetNames, begin_street_names);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -649,16 +653,18 @@ std::string NarrativeBuilder::FormVerbalStartInstruction(Maneuver& maneuver,
     phrase_id += 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.start_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.start_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kCardinalDirectionTag, cardinal_direction);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
-  boost::replace_all(instruction, kLengthTag,
-                     FormLength(maneuver, dictionary_.start_verbal_subset.metric_lengths,
-                                dictionary_.start_verbal_subset.us_customary_lengths));
+  PhraseValues values;
+  values.Set(PhraseTag::kCardinalDirection, cardinal_direction);
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kBeginStreetNames, begin_street_names);
+  values.Set(PhraseTag::kLength,
+             FormLength(maneuver, dictionary_.start_verbal_subset.metric_lengths,
+                        dictionary_.start_verbal_subset.us_customary_lengths));
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -702,14 +708,16 @@ std::string NarrativeBuilder::FormDestinationInstruction(Maneuver& maneuver) {
     relative_direction = dictionary_.destination_subset.relative_directions.at(1);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.destination_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.destination_subset.templates.at(phrase_id);
 
+  PhraseValues values;
   if (phrase_id > 0) {
     // Replace phrase tags with values
-    boost::replace_all(instruction, kRelativeDirectionTag, relative_direction);
-    boost::replace_all(instruction, kDestinationTag, destination);
+    values.Set(PhraseTag::kRelativeDirection, relative_direction);
+    values.Set(PhraseTag::kDestination, destination);
   }
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -758,14 +766,16 @@ std::string NarrativeBuilder::FormVerbalAlertDestinationInstruction(Maneuver& ma
     relative_direction = dictionary_.destination_subset.relative_directions.at(1);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.destination_verbal_alert_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.destination_verbal_alert_subset.templates.at(phrase_id);
 
+  PhraseValues values;
   if (phrase_id > 0) {
     // Replace phrase tags with values
-    boost::replace_all(instruction, kRelativeDirectionTag, relative_direction);
-    boost::replace_all(instruction, kDestinationTag, destination);
+    values.Set(PhraseTag::kRelativeDirection, relative_direction);
+    values.Set(PhraseTag::kDestination, destination);
   }
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -814,14 +824,16 @@ std::string NarrativeBuilder::FormVerbalDestinationInstruction(Maneuver& maneuve
     relative_direction = dictionary_.destination_subset.relative_directions.at(1);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.destination_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.destination_verbal_subset.templates.at(phrase_id);
 
+  PhraseValues values;
   if (phrase_id > 0) {
     // Replace phrase tags with values
-    boost::replace_all(instruction, kRelativeDirectionTag, relative_direction);
-    boost::replace_all(instruction, kDestinationTag, destination);
+    values.Set(PhraseTag::kRelativeDirection, relative_direction);
+    values.Set(PhraseTag::kDestination, destination);
   }
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -844,12 +856,14 @@ std::string NarrativeBuilder::FormBecomesInstruction(Maneuver& maneuver, Maneuve
   // Determine which phrase to use
   uint8_t phrase_id = 0;
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.becomes_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.becomes_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kPreviousStreetNamesTag, prev_street_names);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  PhraseValues values;
+  values.Set(PhraseTag::kPreviousStreetNames, prev_street_names);
+  values.Set(PhraseTag::kStreetNames, street_names);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -879,12 +893,14 @@ std::string NarrativeBuilder::FormVerbalBecomesInstruction(Maneuver& maneuver,
   // Determine which phrase to use
   uint8_t phrase_id = 0;
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.becomes_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.becomes_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kPreviousStreetNamesTag, prev_street_names);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  PhraseValues values;
+  values.Set(PhraseTag::kPreviousStreetNames, prev_street_names);
+  values.Set(PhraseTag::kStreetNames, street_names);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -930,13 +946,15 @@ std::string NarrativeBuilder::FormContinueInstruction(Maneuver& maneuver,
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.continue_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.continue_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kJunctionName, junction_name);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -986,13 +1004,15 @@ std::string NarrativeBuilder::FormVerbalAlertContinueInstruction(Maneuver& maneu
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.continue_verbal_alert_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.continue_verbal_alert_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kJunctionName, junction_name);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1051,16 +1071,18 @@ std::string NarrativeBuilder::FormVerbalContinueInstruction(Maneuver& maneuver,
     phrase_id += 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.continue_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.continue_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kLengthTag,
-                     FormLength(maneuver, dictionary_.continue_verbal_subset.metric_lengths,
-                                dictionary_.continue_verbal_subset.us_customary_lengths));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kLength,
+             FormLength(maneuver, dictionary_.continue_verbal_subset.metric_lengths,
+                        dictionary_.continue_verbal_subset.us_customary_lengths));
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kJunctionName, junction_name);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1136,16 +1158,18 @@ std::string NarrativeBuilder::FormTurnInstruction(Maneuver& maneuver,
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = subset->phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = subset->templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeTwoDirection(maneuver.type(), subset->relative_directions));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection,
+             FormRelativeTwoDirection(maneuver.type(), subset->relative_directions));
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kBeginStreetNames, begin_street_names);
+  values.Set(PhraseTag::kJunctionName, junction_name);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1244,16 +1268,18 @@ std::string NarrativeBuilder::FormVerbalTurnInstruction(Maneuver& maneuver,
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = subset->phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = subset->templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeTwoDirection(maneuver.type(), subset->relative_directions));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection,
+             FormRelativeTwoDirection(maneuver.type(), subset->relative_directions));
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kBeginStreetNames, begin_street_names);
+  values.Set(PhraseTag::kJunctionName, junction_name);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1314,17 +1340,18 @@ std::string NarrativeBuilder::FormUturnInstruction(Maneuver& maneuver,
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.uturn_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.uturn_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeTwoDirection(maneuver.type(),
-                                              dictionary_.uturn_subset.relative_directions));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kCrossStreetNamesTag, cross_street_names);
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection,
+             FormRelativeTwoDirection(maneuver.type(), dictionary_.uturn_subset.relative_directions));
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kCrossStreetNames, cross_street_names);
+  values.Set(PhraseTag::kJunctionName, junction_name);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1469,15 +1496,17 @@ std::string NarrativeBuilder::FormVerbalUturnInstruction(uint8_t phrase_id,
   std::string instruction;
   instruction.reserve(kInstructionInitialCapacity);
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.uturn_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.uturn_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_dir);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kCrossStreetNamesTag, cross_street_names);
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection, relative_dir);
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kCrossStreetNames, cross_street_names);
+  values.Set(PhraseTag::kJunctionName, junction_name);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1523,13 +1552,15 @@ std::string NarrativeBuilder::FormRampStraightInstruction(Maneuver& maneuver,
         maneuver.signs().GetExitNameString(element_max_count, limit_by_consecutive_count);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.ramp_straight_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.ramp_straight_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kBranchSign, exit_branch_sign);
+  values.Set(PhraseTag::kTowardSign, exit_toward_sign);
+  values.Set(PhraseTag::kNameSign, exit_name_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1626,13 +1657,15 @@ std::string NarrativeBuilder::FormVerbalRampStraightInstruction(uint8_t phrase_i
   std::string instruction;
   instruction.reserve(kInstructionInitialCapacity);
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.ramp_straight_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.ramp_straight_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kBranchSign, exit_branch_sign);
+  values.Set(PhraseTag::kTowardSign, exit_toward_sign);
+  values.Set(PhraseTag::kNameSign, exit_name_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1700,16 +1733,17 @@ std::string NarrativeBuilder::FormRampInstruction(Maneuver& maneuver,
         maneuver.signs().GetExitNameString(element_max_count, limit_by_consecutive_count);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.ramp_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.ramp_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeTwoDirection(maneuver.type(),
-                                              dictionary_.ramp_subset.relative_directions));
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection,
+             FormRelativeTwoDirection(maneuver.type(), dictionary_.ramp_subset.relative_directions));
+  values.Set(PhraseTag::kBranchSign, exit_branch_sign);
+  values.Set(PhraseTag::kTowardSign, exit_toward_sign);
+  values.Set(PhraseTag::kNameSign, exit_name_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1858,14 +1892,16 @@ std::string NarrativeBuilder::FormVerbalRampInstruction(uint8_t phrase_id,
   std::string instruction;
   instruction.reserve(kInstructionInitialCapacity);
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.ramp_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.ramp_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_dir);
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection, relative_dir);
+  values.Set(PhraseTag::kBranchSign, exit_branch_sign);
+  values.Set(PhraseTag::kTowardSign, exit_toward_sign);
+  values.Set(PhraseTag::kNameSign, exit_name_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1943,17 +1979,18 @@ std::string NarrativeBuilder::FormExitInstruction(Maneuver& maneuver,
         maneuver.signs().GetExitNameString(element_max_count, limit_by_consecutive_count);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.exit_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeTwoDirection(maneuver.type(),
-                                              dictionary_.exit_subset.relative_directions));
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection,
+             FormRelativeTwoDirection(maneuver.type(), dictionary_.exit_subset.relative_directions));
+  values.Set(PhraseTag::kNumberSign, exit_number_sign);
+  values.Set(PhraseTag::kBranchSign, exit_branch_sign);
+  values.Set(PhraseTag::kTowardSign, exit_toward_sign);
+  values.Set(PhraseTag::kNameSign, exit_name_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2110,15 +2147,17 @@ std::string NarrativeBuilder::FormVerbalExitInstruction(uint8_t phrase_id,
   std::string instruction;
   instruction.reserve(kInstructionInitialCapacity);
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.exit_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_dir);
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection, relative_dir);
+  values.Set(PhraseTag::kNumberSign, exit_number_sign);
+  values.Set(PhraseTag::kBranchSign, exit_branch_sign);
+  values.Set(PhraseTag::kTowardSign, exit_toward_sign);
+  values.Set(PhraseTag::kNameSign, exit_name_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2199,16 +2238,18 @@ std::string NarrativeBuilder::FormKeepInstruction(Maneuver& maneuver,
     phrase_id += 4;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.keep_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.keep_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeThreeDirection(maneuver.type(),
-                                                dictionary_.keep_subset.relative_directions));
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kTowardSignTag, toward_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection,
+             FormRelativeThreeDirection(maneuver.type(),
+                                        dictionary_.keep_subset.relative_directions));
+  values.Set(PhraseTag::kNumberSign, exit_number_sign);
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kTowardSign, toward_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2388,14 +2429,16 @@ std::string NarrativeBuilder::FormVerbalKeepInstruction(uint8_t phrase_id,
   std::string instruction;
   instruction.reserve(kInstructionInitialCapacity);
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.keep_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.keep_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_dir);
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kTowardSignTag, toward_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection, relative_dir);
+  values.Set(PhraseTag::kNumberSign, exit_number_sign);
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kTowardSign, toward_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2447,16 +2490,18 @@ std::string NarrativeBuilder::FormKeepToStayOnInstruction(Maneuver& maneuver,
     phrase_id += 2;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.keep_to_stay_on_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.keep_to_stay_on_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeThreeDirection(maneuver.type(), dictionary_.keep_to_stay_on_subset
-                                                                     .relative_directions));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kTowardSignTag, toward_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection,
+             FormRelativeThreeDirection(maneuver.type(),
+                                        dictionary_.keep_to_stay_on_subset.relative_directions));
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kNumberSign, exit_number_sign);
+  values.Set(PhraseTag::kTowardSign, toward_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2543,14 +2588,16 @@ std::string NarrativeBuilder::FormVerbalKeepToStayOnInstruction(uint8_t phrase_i
   std::string instruction;
   instruction.reserve(kInstructionInitialCapacity);
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.keep_to_stay_on_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.keep_to_stay_on_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_dir);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kTowardSignTag, toward_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection, relative_dir);
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kNumberSign, exit_number_sign);
+  values.Set(PhraseTag::kTowardSign, toward_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2601,13 +2648,15 @@ std::string NarrativeBuilder::FormMergeInstruction(Maneuver& maneuver,
         FormRelativeTwoDirection(maneuver.type(), dictionary_.merge_subset.relative_directions);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.merge_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.merge_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_direction);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection, relative_direction);
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2676,13 +2725,15 @@ std::string NarrativeBuilder::FormVerbalMergeInstruction(Maneuver& maneuver,
                                  dictionary_.merge_verbal_subset.relative_directions);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.merge_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.merge_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_direction);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection, relative_direction);
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2799,16 +2850,17 @@ std::string NarrativeBuilder::FormEnterRoundaboutInstruction(Maneuver& maneuver,
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_roundabout_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.enter_roundabout_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kOrdinalValueTag, ordinal_value);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
-  boost::replace_all(instruction, kRoundaboutExitStreetNamesTag, roundabout_exit_street_names);
-  boost::replace_all(instruction, kRoundaboutExitBeginStreetNamesTag,
-                     roundabout_exit_begin_street_names);
+  PhraseValues values;
+  values.Set(PhraseTag::kOrdinalValue, ordinal_value);
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  values.Set(PhraseTag::kRoundaboutExitStreetNames, roundabout_exit_street_names);
+  values.Set(PhraseTag::kRoundaboutExitBeginStreetNames, roundabout_exit_begin_street_names);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2950,16 +3002,17 @@ std::string NarrativeBuilder::FormVerbalEnterRoundaboutInstruction(Maneuver& man
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_roundabout_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.enter_roundabout_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kOrdinalValueTag, ordinal_value);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
-  boost::replace_all(instruction, kRoundaboutExitStreetNamesTag, roundabout_exit_street_names);
-  boost::replace_all(instruction, kRoundaboutExitBeginStreetNamesTag,
-                     roundabout_exit_begin_street_names);
+  PhraseValues values;
+  values.Set(PhraseTag::kOrdinalValue, ordinal_value);
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  values.Set(PhraseTag::kRoundaboutExitStreetNames, roundabout_exit_street_names);
+  values.Set(PhraseTag::kRoundaboutExitBeginStreetNames, roundabout_exit_begin_street_names);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3013,13 +3066,15 @@ std::string NarrativeBuilder::FormExitRoundaboutInstruction(Maneuver& maneuver,
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_roundabout_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.exit_roundabout_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kBeginStreetNames, begin_street_names);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3077,13 +3132,15 @@ std::string NarrativeBuilder::FormVerbalExitRoundaboutInstruction(Maneuver& mane
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_roundabout_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.exit_roundabout_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kBeginStreetNames, begin_street_names);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3127,13 +3184,15 @@ std::string NarrativeBuilder::FormEnterFerryInstruction(Maneuver& maneuver,
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_ferry_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.enter_ferry_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kFerryLabelTag, ferry_label);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kFerryLabel, ferry_label);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3194,13 +3253,15 @@ std::string NarrativeBuilder::FormVerbalEnterFerryInstruction(Maneuver& maneuver
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_ferry_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.enter_ferry_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kFerryLabelTag, ferry_label);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kStreetNames, street_names);
+  values.Set(PhraseTag::kFerryLabel, ferry_label);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3233,12 +3294,14 @@ std::string NarrativeBuilder::FormTransitConnectionStartInstruction(Maneuver& ma
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_connection_start_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.transit_connection_start_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitPlatform, transit_stop);
+  values.Set(PhraseTag::kStationLabel, station_label);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3271,13 +3334,14 @@ std::string NarrativeBuilder::FormVerbalTransitConnectionStartInstruction(Maneuv
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction =
-      dictionary_.transit_connection_start_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.transit_connection_start_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitPlatform, transit_stop);
+  values.Set(PhraseTag::kStationLabel, station_label);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3310,12 +3374,14 @@ std::string NarrativeBuilder::FormTransitConnectionTransferInstruction(Maneuver&
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_connection_transfer_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.transit_connection_transfer_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitPlatform, transit_stop);
+  values.Set(PhraseTag::kStationLabel, station_label);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3348,13 +3414,14 @@ std::string NarrativeBuilder::FormVerbalTransitConnectionTransferInstruction(Man
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction =
-      dictionary_.transit_connection_transfer_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.transit_connection_transfer_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitPlatform, transit_stop);
+  values.Set(PhraseTag::kStationLabel, station_label);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3387,13 +3454,14 @@ std::string NarrativeBuilder::FormTransitConnectionDestinationInstruction(Maneuv
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction =
-      dictionary_.transit_connection_destination_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.transit_connection_destination_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitPlatform, transit_stop);
+  values.Set(PhraseTag::kStationLabel, station_label);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3426,13 +3494,15 @@ std::string NarrativeBuilder::FormVerbalTransitConnectionDestinationInstruction(
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction =
-      dictionary_.transit_connection_destination_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase =
+      dictionary_.transit_connection_destination_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitPlatform, transit_stop);
+  values.Set(PhraseTag::kStationLabel, station_label);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3455,13 +3525,15 @@ std::string NarrativeBuilder::FormDepartInstruction(Maneuver& maneuver) {
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.depart_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.depart_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop_name);
-  boost::replace_all(instruction, kTimeTag,
-                     get_localized_time(maneuver.GetTransitDepartureTime(), dictionary_.GetLocale()));
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitPlatform, transit_stop_name);
+  values.Set(PhraseTag::kTime,
+             get_localized_time(maneuver.GetTransitDepartureTime(), dictionary_.GetLocale()));
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3484,13 +3556,15 @@ std::string NarrativeBuilder::FormVerbalDepartInstruction(Maneuver& maneuver) {
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.depart_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.depart_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop_name);
-  boost::replace_all(instruction, kTimeTag,
-                     get_localized_time(maneuver.GetTransitDepartureTime(), dictionary_.GetLocale()));
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitPlatform, transit_stop_name);
+  values.Set(PhraseTag::kTime,
+             get_localized_time(maneuver.GetTransitDepartureTime(), dictionary_.GetLocale()));
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3513,13 +3587,15 @@ std::string NarrativeBuilder::FormArriveInstruction(Maneuver& maneuver) {
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.arrive_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.arrive_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop_name);
-  boost::replace_all(instruction, kTimeTag,
-                     get_localized_time(maneuver.GetTransitArrivalTime(), dictionary_.GetLocale()));
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitPlatform, transit_stop_name);
+  values.Set(PhraseTag::kTime,
+             get_localized_time(maneuver.GetTransitArrivalTime(), dictionary_.GetLocale()));
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3542,13 +3618,15 @@ std::string NarrativeBuilder::FormVerbalArriveInstruction(Maneuver& maneuver) {
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.arrive_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.arrive_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop_name);
-  boost::replace_all(instruction, kTimeTag,
-                     get_localized_time(maneuver.GetTransitArrivalTime(), dictionary_.GetLocale()));
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitPlatform, transit_stop_name);
+  values.Set(PhraseTag::kTime,
+             get_localized_time(maneuver.GetTransitArrivalTime(), dictionary_.GetLocale()));
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3575,16 +3653,18 @@ std::string NarrativeBuilder::FormTransitInstruction(Maneuver& maneuver) {
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.transit_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitNameTag,
-                     FormTransitName(maneuver, dictionary_.transit_subset.empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
-  boost::replace_all(instruction, kTransitPlatformCountTag,
-                     std::to_string(stop_count)); // TODO: locale specific numerals
-  boost::replace_all(instruction, kTransitPlatformCountLabelTag, stop_count_label);
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitName,
+             FormTransitName(maneuver, dictionary_.transit_subset.empty_transit_name_labels));
+  values.Set(PhraseTag::kTransitHeadSign, transit_headsign);
+  values.Set(PhraseTag::kTransitPlatformCount,
+             std::to_string(stop_count)); // TODO: locale specific numerals
+  values.Set(PhraseTag::kTransitPlatformCountLabel, stop_count_label);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3607,14 +3687,15 @@ std::string NarrativeBuilder::FormVerbalTransitInstruction(Maneuver& maneuver) {
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.transit_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitNameTag,
-                     FormTransitName(maneuver,
-                                     dictionary_.transit_verbal_subset.empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitName,
+             FormTransitName(maneuver, dictionary_.transit_verbal_subset.empty_transit_name_labels));
+  values.Set(PhraseTag::kTransitHeadSign, transit_headsign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3642,17 +3723,19 @@ std::string NarrativeBuilder::FormTransitRemainOnInstruction(Maneuver& maneuver)
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_remain_on_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.transit_remain_on_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitNameTag,
-                     FormTransitName(maneuver,
-                                     dictionary_.transit_remain_on_subset.empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
-  boost::replace_all(instruction, kTransitPlatformCountTag,
-                     std::to_string(stop_count)); // TODO: locale specific numerals
-  boost::replace_all(instruction, kTransitPlatformCountLabelTag, stop_count_label);
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitName,
+             FormTransitName(maneuver,
+                             dictionary_.transit_remain_on_subset.empty_transit_name_labels));
+  values.Set(PhraseTag::kTransitHeadSign, transit_headsign);
+  values.Set(PhraseTag::kTransitPlatformCount,
+             std::to_string(stop_count)); // TODO: locale specific numerals
+  values.Set(PhraseTag::kTransitPlatformCountLabel, stop_count_label);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3675,14 +3758,16 @@ std::string NarrativeBuilder::FormVerbalTransitRemainOnInstruction(Maneuver& man
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_remain_on_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.transit_remain_on_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitNameTag,
-                     FormTransitName(maneuver, dictionary_.transit_remain_on_verbal_subset
-                                                   .empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitName,
+             FormTransitName(maneuver,
+                             dictionary_.transit_remain_on_verbal_subset.empty_transit_name_labels));
+  values.Set(PhraseTag::kTransitHeadSign, transit_headsign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3710,17 +3795,19 @@ std::string NarrativeBuilder::FormTransitTransferInstruction(Maneuver& maneuver)
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_transfer_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.transit_transfer_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitNameTag,
-                     FormTransitName(maneuver,
-                                     dictionary_.transit_transfer_subset.empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
-  boost::replace_all(instruction, kTransitPlatformCountTag,
-                     std::to_string(stop_count)); // TODO: locale specific numerals
-  boost::replace_all(instruction, kTransitPlatformCountLabelTag, stop_count_label);
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitName,
+             FormTransitName(maneuver,
+                             dictionary_.transit_transfer_subset.empty_transit_name_labels));
+  values.Set(PhraseTag::kTransitHeadSign, transit_headsign);
+  values.Set(PhraseTag::kTransitPlatformCount,
+             std::to_string(stop_count)); // TODO: locale specific numerals
+  values.Set(PhraseTag::kTransitPlatformCountLabel, stop_count_label);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3743,14 +3830,16 @@ std::string NarrativeBuilder::FormVerbalTransitTransferInstruction(Maneuver& man
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_transfer_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.transit_transfer_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitNameTag,
-                     FormTransitName(maneuver, dictionary_.transit_transfer_verbal_subset
-                                                   .empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitName,
+             FormTransitName(maneuver,
+                             dictionary_.transit_transfer_verbal_subset.empty_transit_name_labels));
+  values.Set(PhraseTag::kTransitHeadSign, transit_headsign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3791,14 +3880,16 @@ std::string NarrativeBuilder::FormVerbalPostTransitionInstruction(Maneuver& mane
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.post_transition_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.post_transition_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kLengthTag,
-                     FormLength(maneuver, dictionary_.post_transition_verbal_subset.metric_lengths,
-                                dictionary_.post_transition_verbal_subset.us_customary_lengths));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  PhraseValues values;
+  values.Set(PhraseTag::kLength,
+             FormLength(maneuver, dictionary_.post_transition_verbal_subset.metric_lengths,
+                        dictionary_.post_transition_verbal_subset.us_customary_lengths));
+  values.Set(PhraseTag::kStreetNames, street_names);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3819,14 +3910,15 @@ std::string NarrativeBuilder::FormVerbalPostTransitionTransitInstruction(Maneuve
       FormTransitPlatformCountLabel(stop_count, dictionary_.post_transition_transit_verbal_subset
                                                     .transit_stop_count_labels);
 
-  // Set instruction to the determined tagged phrase
-  instruction =
-      dictionary_.post_transition_transit_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.post_transition_transit_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformCountTag,
-                     std::to_string(stop_count)); // TODO: locale specific numerals
-  boost::replace_all(instruction, kTransitPlatformCountLabelTag, stop_count_label);
+  PhraseValues values;
+  values.Set(PhraseTag::kTransitPlatformCount,
+             std::to_string(stop_count)); // TODO: locale specific numerals
+  values.Set(PhraseTag::kTransitPlatformCountLabel, stop_count_label);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3870,14 +3962,16 @@ std::string NarrativeBuilder::FormVerbalSuccinctStartTransitionInstruction(Maneu
     phrase_id += 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.start_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.start_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kCardinalDirectionTag, cardinal_direction);
-  boost::replace_all(instruction, kLengthTag,
-                     FormLength(maneuver, dictionary_.start_verbal_subset.metric_lengths,
-                                dictionary_.start_verbal_subset.us_customary_lengths));
+  PhraseValues values;
+  values.Set(PhraseTag::kCardinalDirection, cardinal_direction);
+  values.Set(PhraseTag::kLength,
+             FormLength(maneuver, dictionary_.start_verbal_subset.metric_lengths,
+                        dictionary_.start_verbal_subset.us_customary_lengths));
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3936,14 +4030,16 @@ NarrativeBuilder::FormVerbalSuccinctTurnTransitionInstruction(Maneuver& maneuver
                                                maneuver.verbal_formatter());
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = subset->phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = subset->templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeTwoDirection(maneuver.type(), subset->relative_directions));
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection,
+             FormRelativeTwoDirection(maneuver.type(), subset->relative_directions));
+  values.Set(PhraseTag::kJunctionName, junction_name);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3982,15 +4078,17 @@ NarrativeBuilder::FormVerbalSuccinctUturnTransitionInstruction(Maneuver& maneuve
         maneuver.signs().GetJunctionNameString(element_max_count, limit_by_consecutive_count, delim,
                                                maneuver.verbal_formatter());
   }
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.uturn_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.uturn_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeTwoDirection(maneuver.type(),
-                                              dictionary_.uturn_verbal_subset.relative_directions));
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection,
+             FormRelativeTwoDirection(maneuver.type(),
+                                      dictionary_.uturn_verbal_subset.relative_directions));
+  values.Set(PhraseTag::kJunctionName, junction_name);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -4034,12 +4132,14 @@ NarrativeBuilder::FormVerbalSuccinctMergeTransitionInstruction(Maneuver& maneuve
                                  dictionary_.merge_verbal_subset.relative_directions);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.merge_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.merge_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_direction);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kRelativeDirection, relative_direction);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -4081,12 +4181,14 @@ std::string NarrativeBuilder::FormVerbalSuccinctEnterRoundaboutTransitionInstruc
                                                         delim, maneuver.verbal_formatter());
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_roundabout_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.enter_roundabout_verbal_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kOrdinalValueTag, ordinal_value);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kOrdinalValue, ordinal_value);
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -4117,10 +4219,12 @@ std::string NarrativeBuilder::FormVerbalSuccinctExitRoundaboutTransitionInstruct
                                                  maneuver.verbal_formatter());
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_roundabout_verbal_subset.phrases.at(std::to_string(phrase_id));
+  // Get the determined tagged phrase
+  const auto& phrase = dictionary_.exit_roundabout_verbal_subset.templates.at(phrase_id);
 
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  PhraseValues values;
+  values.Set(PhraseTag::kTowardSign, guide_sign);
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -4536,14 +4640,16 @@ std::string NarrativeBuilder::FormVerbalMultiCue(Maneuver* maneuver,
   if (maneuver->distant_verbal_multi_cue()) {
     phrase_id = 1;
   }
-  instruction = dictionary_.verbal_multi_cue_subset.phrases.at(std::to_string(phrase_id));
+  const auto& phrase = dictionary_.verbal_multi_cue_subset.templates.at(phrase_id);
 
   // Replace phrase tags with values
-  boost::replace_all(instruction, kCurrentVerbalCueTag, current_verbal_cue);
-  boost::replace_all(instruction, kNextVerbalCueTag, next_verbal_cue);
-  boost::replace_all(instruction, kLengthTag,
-                     FormLength(*maneuver, dictionary_.post_transition_verbal_subset.metric_lengths,
-                                dictionary_.post_transition_verbal_subset.us_customary_lengths));
+  PhraseValues values;
+  values.Set(PhraseTag::kCurrentVerbalCue, current_verbal_cue);
+  values.Set(PhraseTag::kNextVerbalCue, next_verbal_cue);
+  values.Set(PhraseTag::kLength,
+             FormLength(*maneuver, dictionary_.post_transition_verbal_subset.metric_lengths,
+                        dictionary_.post_transition_verbal_subset.us_customary_lengths));
+  phrase.Form(instruction, values);
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
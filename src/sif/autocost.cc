@@ -464,7 +464,8 @@ Cost AutoCost::EdgeCost(const baldr::DirectedEdge* edge,
                         const uint32_t seconds,
                         uint8_t& flow_sources) const {
   // either the computed edge speed or optional top_speed
-  auto edge_speed = tile->GetSpeed(edge, flow_mask_, seconds, false, &flow_sources);
+  auto edge_speed =
+      tile->GetSpeed(edge, flow_mask_, seconds, false, &flow_sources, &predicted_speed_cache_);
   auto final_speed = std::min(edge_speed, top_speed_);
   float sec = edge->length() * speedfactor_[final_speed];
 
@@ -669,37 +670,38 @@ void ParseAutoCostOptions(const rapidjson::Document& doc,
 
     // type (transport_type)
     pbf_costing_options->set_transport_type(
-        rapidjson::get_optional<std::string>(*json_costing_options, "/type").get_value_or("car"));
+        rapidjson::get_optional<std::string>(*json_costing_options, "/type")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, transport_type, "car")));
 
     // alley_factor
-    pbf_costing_options->set_alley_factor(
-        kAlleyFactorRange(rapidjson::get_optional<float>(*json_costing_options, "/alley_factor")
-                              .get_value_or(kDefaultAlleyFactor)));
+    pbf_costing_options->set_alley_factor(kAlleyFactorRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/alley_factor")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, alley_factor, kDefaultAlleyFactor))));
 
     // use_highways
-    pbf_costing_options->set_use_highways(
-        kUseHighwaysRange(rapidjson::get_optional<float>(*json_costing_options, "/use_highways")
-                              .get_value_or(kDefaultUseHighways)));
+    pbf_costing_options->set_use_highways(kUseHighwaysRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/use_highways")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, use_highways, kDefaultUseHighways))));
 
     // use_tolls
-    pbf_costing_options->set_use_tolls(
-        kUseTollsRange(rapidjson::get_optional<float>(*json_costing_options, "/use_tolls")
-                           .get_value_or(kDefaultUseTolls)));
+    pbf_costing_options->set_use_tolls(kUseTollsRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/use_tolls")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, use_tolls, kDefaultUseTolls))));
 
     // use distance
-    pbf_costing_options->set_use_distance(
-        kUseDistanceRange(rapidjson::get_optional<float>(*json_costing_options, "/use_distance")
-                              .get_value_or(kDefaultUseDistance)));
+    pbf_costing_options->set_use_distance(kUseDistanceRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/use_distance")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, use_distance, kDefaultUseDistance))));
 
     // height
-    pbf_costing_options->set_height(
-        kAutoHeightRange(rapidjson::get_optional<float>(*json_costing_options, "/height")
-                             .get_value_or(kDefaultAutoHeight)));
+    pbf_costing_options->set_height(kAutoHeightRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/height")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, height, kDefaultAutoHeight))));
 
     // width
-    pbf_costing_options->set_width(
-        kAutoWidthRange(rapidjson::get_optional<float>(*json_costing_options, "/width")
-                            .get_value_or(kDefaultAutoWidth)));
+    pbf_costing_options->set_width(kAutoWidthRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/width")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, width, kDefaultAutoWidth))));
 
   } else {
     SetDefaultBaseCostOptions(pbf_costing_options, kBaseCostOptsConfig);
@@ -930,7 +932,8 @@ public:
                         const graph_tile_ptr& tile,
                         const uint32_t seconds,
                         uint8_t& flow_sources) const override {
-    auto edge_speed = tile->GetSpeed(edge, flow_mask_, seconds, false, &flow_sources);
+    auto edge_speed =
+        tile->GetSpeed(edge, flow_mask_, seconds, false, &flow_sources, &predicted_speed_cache_);
     auto final_speed = std::min(edge_speed, top_speed_);
 
     float sec = (edge->length() * speedfactor_[final_speed]);
@@ -1106,7 +1109,8 @@ public:
                         const graph_tile_ptr& tile,
                         const uint32_t seconds,
                         uint8_t& flow_sources) const override {
-    auto edge_speed = tile->GetSpeed(edge, flow_mask_, seconds, false, &flow_sources);
+    auto edge_speed =
+        tile->GetSpeed(edge, flow_mask_, seconds, false, &flow_sources, &predicted_speed_cache_);
     auto final_speed = std::min(edge_speed, top_speed_);
 
     float sec = (edge->length() * speedfactor_[final_speed]);
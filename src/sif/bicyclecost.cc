@@ -850,24 +850,26 @@ void ParseBicycleCostOptions(const rapidjson::Document& doc,
     // If specified, parse json and set pbf values
 
     // use_roads
-    pbf_costing_options->set_use_roads(
-        kUseRoadRange(rapidjson::get_optional<float>(*json_costing_options, "/use_roads")
-                          .get_value_or(kDefaultUseRoad)));
+    pbf_costing_options->set_use_roads(kUseRoadRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/use_roads")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, use_roads, kDefaultUseRoad))));
 
     // use_hills
-    pbf_costing_options->set_use_hills(
-        kUseHillsRange(rapidjson::get_optional<float>(*json_costing_options, "/use_hills")
-                           .get_value_or(kDefaultUseHills)));
+    pbf_costing_options->set_use_hills(kUseHillsRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/use_hills")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, use_hills, kDefaultUseHills))));
 
     // avoid_bad_surfaces
     pbf_costing_options->set_avoid_bad_surfaces(kAvoidBadSurfacesRange(
         rapidjson::get_optional<float>(*json_costing_options, "/avoid_bad_surfaces")
-            .get_value_or(kDefaultAvoidBadSurfaces)));
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, avoid_bad_surfaces,
+                                         kDefaultAvoidBadSurfaces))));
 
     // bicycle_type
     pbf_costing_options->set_transport_type(
         rapidjson::get_optional<std::string>(*json_costing_options, "/bicycle_type")
-            .get_value_or(kDefaultBicycleType));
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, transport_type,
+                                         kDefaultBicycleType)));
 
     // convert string to enum, set ranges and defaults based on enum
     BicycleType type;
@@ -889,18 +891,20 @@ void ParseBicycleCostOptions(const rapidjson::Document& doc,
 
     // Set type specific defaults, override with URL inputs
     // cycling_speed
-    pbf_costing_options->set_cycling_speed(
-        kCycleSpeedRange(rapidjson::get_optional<float>(*json_costing_options, "/cycling_speed")
-                             .get_value_or(kDefaultCyclingSpeed[t])));
+    pbf_costing_options->set_cycling_speed(kCycleSpeedRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/cycling_speed")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, cycling_speed,
+                                         kDefaultCyclingSpeed[t]))));
 
     // bss rent cost
-    pbf_costing_options->set_bike_share_cost(
-        kBSSCostRange(rapidjson::get_optional<uint32_t>(*json_costing_options, "/bss_return_cost")
-                          .get_value_or(kDefaultBssCost)));
+    pbf_costing_options->set_bike_share_cost(kBSSCostRange(
+        rapidjson::get_optional<uint32_t>(*json_costing_options, "/bss_return_cost")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, bike_share_cost, kDefaultBssCost))));
 
     pbf_costing_options->set_bike_share_penalty(kBSSPenaltyRange(
         rapidjson::get_optional<uint32_t>(*json_costing_options, "/bss_return_penalty")
-            .get_value_or(kDefaultBssPenalty)));
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, bike_share_penalty,
+                                         kDefaultBssPenalty))));
   } else {
     // Set pbf values to defaults
     SetDefaultBaseCostOptions(pbf_costing_options, kBaseCostOptsConfig);
@@ -343,20 +343,32 @@ void DynamicCost::set_use_living_streets(float use_living_streets) {
 
 void ParseSharedCostOptions(const rapidjson::Value& value, CostingOptions* pbf_costing_options) {
   auto speed_types = rapidjson::get_child_optional(value, "/speed_types");
-  pbf_costing_options->set_flow_mask(SpeedMask_Parse(speed_types));
+  if (speed_types || !pbf_costing_options->has_flow_mask()) {
+    pbf_costing_options->set_flow_mask(SpeedMask_Parse(speed_types));
+  }
 
   pbf_costing_options->set_ignore_restrictions(
-      rapidjson::get<bool>(value, "/ignore_restrictions", false));
-  pbf_costing_options->set_ignore_oneways(rapidjson::get<bool>(value, "/ignore_oneways", false));
-  pbf_costing_options->set_ignore_access(rapidjson::get<bool>(value, "/ignore_access", false));
-  pbf_costing_options->set_ignore_closures(rapidjson::get<bool>(value, "/ignore_closures", false));
+      rapidjson::get<bool>(value, "/ignore_restrictions",
+                           PBF_OR_DEFAULT(pbf_costing_options, ignore_restrictions, false)));
+  pbf_costing_options->set_ignore_oneways(
+      rapidjson::get<bool>(value, "/ignore_oneways",
+                           PBF_OR_DEFAULT(pbf_costing_options, ignore_oneways, false)));
+  pbf_costing_options->set_ignore_access(
+      rapidjson::get<bool>(value, "/ignore_access",
+                           PBF_OR_DEFAULT(pbf_costing_options, ignore_access, false)));
+  pbf_costing_options->set_ignore_closures(
+      rapidjson::get<bool>(value, "/ignore_closures",
+                           PBF_OR_DEFAULT(pbf_costing_options, ignore_closures, false)));
   auto name = rapidjson::get_optional<std::string>(value, "/name");
   if (name) {
     pbf_costing_options->set_name(*name);
   }
-  pbf_costing_options->set_shortest(rapidjson::get<bool>(value, "/shortest", false));
-  pbf_costing_options->set_top_speed(
-      kVehicleSpeedRange(rapidjson::get<uint32_t>(value, "/top_speed", kMaxAssumedSpeed)));
+  pbf_costing_options->set_shortest(
+      rapidjson::get<bool>(value, "/shortest",
+                           PBF_OR_DEFAULT(pbf_costing_options, shortest, false)));
+  pbf_costing_options->set_top_speed(kVehicleSpeedRange(
+      rapidjson::get<uint32_t>(value, "/top_speed",
+                               PBF_OR_DEFAULT(pbf_costing_options, top_speed, kMaxAssumedSpeed))));
 }
 
 void ParseBaseCostOptions(const rapidjson::Value& value,
@@ -364,86 +376,123 @@ void ParseBaseCostOptions(const rapidjson::Value& value,
                           const BaseCostingOptionsConfig& base_cfg) {
   // destination only penalty
   pbf_costing_options->set_destination_only_penalty(base_cfg.dest_only_penalty_(
-      rapidjson::get<float>(value, "/destination_only_penalty", base_cfg.dest_only_penalty_.def)));
+      rapidjson::get<float>(value, "/destination_only_penalty",
+                            PBF_OR_DEFAULT(pbf_costing_options, destination_only_penalty,
+                                           base_cfg.dest_only_penalty_.def))));
 
   // maneuver_penalty
   pbf_costing_options->set_maneuver_penalty(base_cfg.maneuver_penalty_(
-      rapidjson::get<float>(value, "/maneuver_penalty", base_cfg.maneuver_penalty_.def)));
+      rapidjson::get<float>(value, "/maneuver_penalty",
+                            PBF_OR_DEFAULT(pbf_costing_options, maneuver_penalty,
+                                           base_cfg.maneuver_penalty_.def))));
 
   // alley_penalty
   pbf_costing_options->set_alley_penalty(base_cfg.alley_penalty_(
-      rapidjson::get<float>(value, "/alley_penalty", base_cfg.alley_penalty_.def)));
+      rapidjson::get<float>(value, "/alley_penalty",
+                            PBF_OR_DEFAULT(pbf_costing_options, alley_penalty,
+                                           base_cfg.alley_penalty_.def))));
 
   // gate_cost
-  pbf_costing_options->set_gate_cost(
-      base_cfg.gate_cost_(rapidjson::get<float>(value, "/gate_cost", base_cfg.gate_cost_.def)));
+  pbf_costing_options->set_gate_cost(base_cfg.gate_cost_(
+      rapidjson::get<float>(value, "/gate_cost",
+                            PBF_OR_DEFAULT(pbf_costing_options, gate_cost,
+                                           base_cfg.gate_cost_.def))));
 
   // gate_penalty
   pbf_costing_options->set_gate_penalty(base_cfg.gate_penalty_(
-      rapidjson::get<float>(value, "/gate_penalty", base_cfg.gate_penalty_.def)));
+      rapidjson::get<float>(value, "/gate_penalty",
+                            PBF_OR_DEFAULT(pbf_costing_options, gate_penalty,
+                                           base_cfg.gate_penalty_.def))));
 
   // private_access_penalty
   pbf_costing_options->set_private_access_penalty(base_cfg.private_access_penalty_(
-      rapidjson::get<float>(value, "/private_access_penalty", base_cfg.private_access_penalty_.def)));
+      rapidjson::get<float>(value, "/private_access_penalty",
+                            PBF_OR_DEFAULT(pbf_costing_options, private_access_penalty,
+                                           base_cfg.private_access_penalty_.def))));
 
   // country_crossing_cost
   pbf_costing_options->set_country_crossing_cost(base_cfg.country_crossing_cost_(
-      rapidjson::get<float>(value, "/country_crossing_cost", base_cfg.country_crossing_cost_.def)));
+      rapidjson::get<float>(value, "/country_crossing_cost",
+                            PBF_OR_DEFAULT(pbf_costing_options, country_crossing_cost,
+                                           base_cfg.country_crossing_cost_.def))));
 
   // country_crossing_penalty
   pbf_costing_options->set_country_crossing_penalty(base_cfg.country_crossing_penalty_(
       rapidjson::get<float>(value, "/country_crossing_penalty",
-                            base_cfg.country_crossing_penalty_.def)));
+                            PBF_OR_DEFAULT(pbf_costing_options, country_crossing_penalty,
+                                           base_cfg.country_crossing_penalty_.def))));
 
   if (!base_cfg.disable_toll_booth_) {
     // toll_booth_cost
     pbf_costing_options->set_toll_booth_cost(base_cfg.toll_booth_cost_(
-        rapidjson::get<float>(value, "/toll_booth_cost", base_cfg.toll_booth_cost_.def)));
+        rapidjson::get<float>(value, "/toll_booth_cost",
+                              PBF_OR_DEFAULT(pbf_costing_options, toll_booth_cost,
+                                             base_cfg.toll_booth_cost_.def))));
 
     // toll_booth_penalty
     pbf_costing_options->set_toll_booth_penalty(base_cfg.toll_booth_penalty_(
-        rapidjson::get<float>(value, "/toll_booth_penalty", base_cfg.toll_booth_penalty_.def)));
+        rapidjson::get<float>(value, "/toll_booth_penalty",
+                              PBF_OR_DEFAULT(pbf_costing_options, toll_booth_penalty,
+                                             base_cfg.toll_booth_penalty_.def))));
   }
 
   if (!base_cfg.disable_ferry_) {
     // ferry_cost
-    pbf_costing_options->set_ferry_cost(
-        base_cfg.ferry_cost_(rapidjson::get<float>(value, "/ferry_cost", base_cfg.ferry_cost_.def)));
+    pbf_costing_options->set_ferry_cost(base_cfg.ferry_cost_(
+        rapidjson::get<float>(value, "/ferry_cost",
+                              PBF_OR_DEFAULT(pbf_costing_options, ferry_cost,
+                                             base_cfg.ferry_cost_.def))));
 
     // use_ferry
-    pbf_costing_options->set_use_ferry(
-        base_cfg.use_ferry_(rapidjson::get<float>(value, "/use_ferry", base_cfg.use_ferry_.def)));
+    pbf_costing_options->set_use_ferry(base_cfg.use_ferry_(
+        rapidjson::get<float>(value, "/use_ferry",
+                              PBF_OR_DEFAULT(pbf_costing_options, use_ferry,
+                                             base_cfg.use_ferry_.def))));
   }
 
   if (!base_cfg.disable_rail_ferry_) {
     // rail_ferry_cost
     pbf_costing_options->set_rail_ferry_cost(base_cfg.rail_ferry_cost_(
-        rapidjson::get<float>(value, "/rail_ferry_cost", base_cfg.rail_ferry_cost_.def)));
+        rapidjson::get<float>(value, "/rail_ferry_cost",
+                              PBF_OR_DEFAULT(pbf_costing_options, rail_ferry_cost,
+                                             base_cfg.rail_ferry_cost_.def))));
 
     // use_rail_ferry
     pbf_costing_options->set_use_rail_ferry(base_cfg.use_rail_ferry_(
-        rapidjson::get<float>(value, "/use_rail_ferry", base_cfg.use_rail_ferry_.def)));
+        rapidjson::get<float>(value, "/use_rail_ferry",
+                              PBF_OR_DEFAULT(pbf_costing_options, use_rail_ferry,
+                                             base_cfg.use_rail_ferry_.def))));
   }
 
   // service_penalty
   pbf_costing_options->set_service_penalty(base_cfg.service_penalty_(
-      rapidjson::get<float>(value, "/service_penalty", base_cfg.service_penalty_.def)));
+      rapidjson::get<float>(value, "/service_penalty",
+                            PBF_OR_DEFAULT(pbf_costing_options, service_penalty,
+                                           base_cfg.service_penalty_.def))));
 
   // service_factor
   pbf_costing_options->set_service_factor(base_cfg.service_factor_(
-      rapidjson::get<float>(value, "/service_factor", base_cfg.service_factor_.def)));
+      rapidjson::get<float>(value, "/service_factor",
+                            PBF_OR_DEFAULT(pbf_costing_options, service_factor,
+                                           base_cfg.service_factor_.def))));
 
   // use_tracks
-  pbf_costing_options->set_use_tracks(
-      base_cfg.use_tracks_(rapidjson::get<float>(value, "/use_tracks", base_cfg.use_tracks_.def)));
+  pbf_costing_options->set_use_tracks(base_cfg.use_tracks_(
+      rapidjson::get<float>(value, "/use_tracks",
+                            PBF_OR_DEFAULT(pbf_costing_options, use_tracks,
+                                           base_cfg.use_tracks_.def))));
 
   // use_living_streets
   pbf_costing_options->set_use_living_streets(base_cfg.use_living_streets_(
-      rapidjson::get<float>(value, "/use_living_streets", base_cfg.use_living_streets_.def)));
+      rapidjson::get<float>(value, "/use_living_streets",
+                            PBF_OR_DEFAULT(pbf_costing_options, use_living_streets,
+                                           base_cfg.use_living_streets_.def))));
 
   // closure_factor
   pbf_costing_options->set_closure_factor(base_cfg.closure_factor_(
-      rapidjson::get<float>(value, "/closure_factor", base_cfg.closure_factor_.def)));
+      rapidjson::get<float>(value, "/closure_factor",
+                            PBF_OR_DEFAULT(pbf_costing_options, closure_factor,
+                                           base_cfg.closure_factor_.def))));
 }
 
 void SetDefaultBaseCostOptions(CostingOptions* pbf_costing_options,
@@ -501,6 +550,17 @@ void ParseCostingOptions(const rapidjson::Document& doc,
   }
 }
 
+CostingOptions DefaultCostingOptions(const Costing costing) {
+  rapidjson::Document doc;
+  doc.SetObject();
+  CostingOptions costing_options;
+  ParseCostingOptions(doc, "/costing_options/" + Costing_Enum_Name(costing), &costing_options,
+                      costing);
+  costing_options.set_flow_mask(static_cast<uint8_t>(costing_options.flow_mask()) &
+                                ~(kPredictedFlowMask | kCurrentFlowMask));
+  return costing_options;
+}
+
 void ParseCostingOptions(const rapidjson::Document& doc,
                          const std::string& key,
                          CostingOptions* costing_options,
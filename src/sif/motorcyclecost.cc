@@ -396,7 +396,8 @@ Cost MotorcycleCost::EdgeCost(const baldr::DirectedEdge* edge,
                               const graph_tile_ptr& tile,
                               const uint32_t seconds,
                               uint8_t& flow_sources) const {
-  auto edge_speed = tile->GetSpeed(edge, flow_mask_, seconds, false, &flow_sources);
+  auto edge_speed =
+      tile->GetSpeed(edge, flow_mask_, seconds, false, &flow_sources, &predicted_speed_cache_);
   auto final_speed = std::min(edge_speed, top_speed_);
 
   float sec = (edge->length() * speedfactor_[final_speed]);
@@ -576,19 +577,19 @@ void ParseMotorcycleCostOptions(const rapidjson::Document& doc,
     ParseBaseCostOptions(*json_costing_options, pbf_costing_options, kBaseCostOptsConfig);
 
     // use_highways
-    pbf_costing_options->set_use_highways(
-        kUseHighwaysRange(rapidjson::get_optional<float>(*json_costing_options, "/use_highways")
-                              .get_value_or(kDefaultUseHighways)));
+    pbf_costing_options->set_use_highways(kUseHighwaysRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/use_highways")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, use_highways, kDefaultUseHighways))));
 
     // use_tolls
-    pbf_costing_options->set_use_tolls(
-        kUseTollsRange(rapidjson::get_optional<float>(*json_costing_options, "/use_tolls")
-                           .get_value_or(kDefaultUseTolls)));
+    pbf_costing_options->set_use_tolls(kUseTollsRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/use_tolls")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, use_tolls, kDefaultUseTolls))));
 
     // use_trails
-    pbf_costing_options->set_use_trails(
-        kUseTrailsRange(rapidjson::get_optional<float>(*json_costing_options, "/use_trails")
-                            .get_value_or(kDefaultUseTrails)));
+    pbf_costing_options->set_use_trails(kUseTrailsRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/use_trails")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, use_trails, kDefaultUseTrails))));
   } else {
     // Set pbf values to defaults
     SetDefaultBaseCostOptions(pbf_costing_options, kBaseCostOptsConfig);
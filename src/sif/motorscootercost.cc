@@ -414,7 +414,8 @@ Cost MotorScooterCost::EdgeCost(const baldr::DirectedEdge* edge,
                                 const graph_tile_ptr& tile,
                                 const uint32_t seconds,
                                 uint8_t& flow_sources) const {
-  auto speed = tile->GetSpeed(edge, flow_mask_, seconds, false, &flow_sources);
+  auto speed =
+      tile->GetSpeed(edge, flow_mask_, seconds, false, &flow_sources, &predicted_speed_cache_);
 
   if (edge->use() == Use::kFerry) {
     assert(speed < speedfactor_.size());
@@ -599,19 +600,19 @@ void ParseMotorScooterCostOptions(const rapidjson::Document& doc,
     // If specified, parse json and set pbf values
 
     // top_speed; override defaults
-    pbf_costing_options->set_top_speed(
-        kTopSpeedRange(rapidjson::get_optional<uint32_t>(*json_costing_options, "/top_speed")
-                           .get_value_or(kDefaultTopSpeed)));
+    pbf_costing_options->set_top_speed(kTopSpeedRange(
+        rapidjson::get_optional<uint32_t>(*json_costing_options, "/top_speed")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, top_speed, kDefaultTopSpeed))));
 
     // use_hills
-    pbf_costing_options->set_use_hills(
-        kUseHillsRange(rapidjson::get_optional<float>(*json_costing_options, "/use_hills")
-                           .get_value_or(kDefaultUseHills)));
+    pbf_costing_options->set_use_hills(kUseHillsRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/use_hills")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, use_hills, kDefaultUseHills))));
 
     // use_primary
-    pbf_costing_options->set_use_primary(
-        kUsePrimaryRange(rapidjson::get_optional<float>(*json_costing_options, "/use_primary")
-                             .get_value_or(kDefaultUsePrimary)));
+    pbf_costing_options->set_use_primary(kUsePrimaryRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/use_primary")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, use_primary, kDefaultUsePrimary))));
   } else {
     // Set pbf values to defaults
     SetDefaultBaseCostOptions(pbf_costing_options, kBaseCostOptsConfig);
@@ -614,7 +614,8 @@ Cost PedestrianCost::EdgeCost(const baldr::DirectedEdge* edge,
 
   // Ferries are a special case - they use the ferry speed (stored on the edge)
   if (edge->use() == Use::kFerry) {
-    auto speed = tile->GetSpeed(edge, flow_mask_, seconds, false, &flow_sources);
+    auto speed =
+        tile->GetSpeed(edge, flow_mask_, seconds, false, &flow_sources, &predicted_speed_cache_);
     float sec = edge->length() * (kSecPerHour * 0.001f) / static_cast<float>(speed);
     return {sec * ferry_factor_, sec};
   }
@@ -721,100 +722,114 @@ void ParsePedestrianCostOptions(const rapidjson::Document& doc,
 
     // type (transport_type)
     pbf_costing_options->set_transport_type(
-        (rapidjson::get_optional<std::string>(*json_costing_options, "/type").get_value_or("foot")));
+        rapidjson::get_optional<std::string>(*json_costing_options, "/type")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, transport_type, "foot")));
 
     // Set type specific defaults, override with URL inputs
     if (pbf_costing_options->transport_type() == "wheelchair") {
       // max_distance
       pbf_costing_options->set_max_distance(kMaxDistanceWheelchairRange(
           rapidjson::get_optional<uint32_t>(*json_costing_options, "/max_distance")
-              .get_value_or(kMaxDistanceWheelchair)));
+              .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, max_distance,
+                                           kMaxDistanceWheelchair))));
 
       // walking_speed
       pbf_costing_options->set_walking_speed(kSpeedWheelchairRange(
           rapidjson::get_optional<float>(*json_costing_options, "/walking_speed")
-              .get_value_or(kDefaultSpeedWheelchair)));
+              .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, walking_speed,
+                                           kDefaultSpeedWheelchair))));
 
       // step_penalty
       pbf_costing_options->set_step_penalty(kStepPenaltyWheelchairRange(
           rapidjson::get_optional<float>(*json_costing_options, "/step_penalty")
-              .get_value_or(kDefaultStepPenaltyWheelchair)));
+              .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, step_penalty,
+                                           kDefaultStepPenaltyWheelchair))));
 
       // max_grade
       pbf_costing_options->set_max_grade(kMaxGradeWheelchairRange(
           rapidjson::get_optional<uint32_t>(*json_costing_options, "/max_grade")
-              .get_value_or(kDefaultMaxGradeWheelchair)));
+              .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, max_grade,
+                                           kDefaultMaxGradeWheelchair))));
 
     } else {
       // Assume type = foot
       // max_distance
       pbf_costing_options->set_max_distance(kMaxDistanceFootRange(
           rapidjson::get_optional<uint32_t>(*json_costing_options, "/max_distance")
-              .get_value_or(kMaxDistanceFoot)));
+              .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, max_distance, kMaxDistanceFoot))));
 
       // walking_speed
-      pbf_costing_options->set_walking_speed(
-          kSpeedFootRange(rapidjson::get_optional<float>(*json_costing_options, "/walking_speed")
-                              .get_value_or(kDefaultSpeedFoot)));
+      pbf_costing_options->set_walking_speed(kSpeedFootRange(
+          rapidjson::get_optional<float>(*json_costing_options, "/walking_speed")
+              .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, walking_speed,
+                                           kDefaultSpeedFoot))));
 
       // step_penalty
-      pbf_costing_options->set_step_penalty(
-          kStepPenaltyFootRange(rapidjson::get_optional<float>(*json_costing_options, "/step_penalty")
-                                    .get_value_or(kDefaultStepPenaltyFoot)));
+      pbf_costing_options->set_step_penalty(kStepPenaltyFootRange(
+          rapidjson::get_optional<float>(*json_costing_options, "/step_penalty")
+              .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, step_penalty,
+                                           kDefaultStepPenaltyFoot))));
 
       // max_grade
-      pbf_costing_options->set_max_grade(
-          kMaxGradeFootRange(rapidjson::get_optional<uint32_t>(*json_costing_options, "/max_grade")
-                                 .get_value_or(kDefaultMaxGradeFoot)));
+      pbf_costing_options->set_max_grade(kMaxGradeFootRange(
+          rapidjson::get_optional<uint32_t>(*json_costing_options, "/max_grade")
+              .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, max_grade, kDefaultMaxGradeFoot))));
     }
 
     // max_hiking_difficulty
     pbf_costing_options->set_max_hiking_difficulty(kMaxHikingDifficultyRange(
         rapidjson::get_optional<uint32_t>(*json_costing_options, "/max_hiking_difficulty")
-            .get_value_or(kDefaultMaxHikingDifficulty)));
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, max_hiking_difficulty,
+                                         kDefaultMaxHikingDifficulty))));
 
     // mode_factor
-    pbf_costing_options->set_mode_factor(
-        kModeFactorRange(rapidjson::get_optional<float>(*json_costing_options, "/mode_factor")
-                             .get_value_or(kModeFactor)));
+    pbf_costing_options->set_mode_factor(kModeFactorRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/mode_factor")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, mode_factor, kModeFactor))));
 
     // walkway_factor
-    pbf_costing_options->set_walkway_factor(
-        kWalkwayFactorRange(rapidjson::get_optional<float>(*json_costing_options, "/walkway_factor")
-                                .get_value_or(kDefaultWalkwayFactor)));
+    pbf_costing_options->set_walkway_factor(kWalkwayFactorRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/walkway_factor")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, walkway_factor,
+                                         kDefaultWalkwayFactor))));
 
     // sidewalk_factor
-    pbf_costing_options->set_sidewalk_factor(
-        kSideWalkFactorRange(rapidjson::get_optional<float>(*json_costing_options, "/sidewalk_factor")
-                                 .get_value_or(kDefaultSideWalkFactor)));
+    pbf_costing_options->set_sidewalk_factor(kSideWalkFactorRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/sidewalk_factor")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, sidewalk_factor,
+                                         kDefaultSideWalkFactor))));
 
     // alley_factor
-    pbf_costing_options->set_alley_factor(
-        kAlleyFactorRange(rapidjson::get_optional<float>(*json_costing_options, "/alley_factor")
-                              .get_value_or(kDefaultAlleyFactor)));
+    pbf_costing_options->set_alley_factor(kAlleyFactorRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/alley_factor")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, alley_factor, kDefaultAlleyFactor))));
 
     // driveway_factor
-    pbf_costing_options->set_driveway_factor(
-        kDrivewayFactorRange(rapidjson::get_optional<float>(*json_costing_options, "/driveway_factor")
-                                 .get_value_or(kDefaultDrivewayFactor)));
+    pbf_costing_options->set_driveway_factor(kDrivewayFactorRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/driveway_factor")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, driveway_factor,
+                                         kDefaultDrivewayFactor))));
 
     // transit_start_end_max_distance
     pbf_costing_options->set_transit_start_end_max_distance(kTransitStartEndMaxDistanceRange(
         rapidjson::get_optional<uint32_t>(*json_costing_options, "/transit_start_end_max_distance")
-            .get_value_or(kTransitStartEndMaxDistance)));
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, transit_start_end_max_distance,
+                                         kTransitStartEndMaxDistance))));
 
     // transit_transfer_max_distance
     pbf_costing_options->set_transit_transfer_max_distance(kTransitTransferMaxDistanceRange(
         rapidjson::get_optional<uint32_t>(*json_costing_options, "/transit_transfer_max_distance")
-            .get_value_or(kTransitTransferMaxDistance)));
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, transit_transfer_max_distance,
+                                         kTransitTransferMaxDistance))));
 
     // bss rent cost
-    pbf_costing_options->set_bike_share_cost(
-        kBSSCostRange(rapidjson::get_optional<uint32_t>(*json_costing_options, "/bss_rent_cost")
-                          .get_value_or(kDefaultBssCost)));
-    pbf_costing_options->set_bike_share_penalty(
-        kBSSPenaltyRange(rapidjson::get_optional<uint32_t>(*json_costing_options, "/bss_rent_penalty")
-                             .get_value_or(kDefaultBssPenalty)));
+    pbf_costing_options->set_bike_share_cost(kBSSCostRange(
+        rapidjson::get_optional<uint32_t>(*json_costing_options, "/bss_rent_cost")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, bike_share_cost, kDefaultBssCost))));
+    pbf_costing_options->set_bike_share_penalty(kBSSPenaltyRange(
+        rapidjson::get_optional<uint32_t>(*json_costing_options, "/bss_rent_penalty")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, bike_share_penalty,
+                                         kDefaultBssPenalty))));
   } else {
     // Set pbf values to defaults
     SetDefaultBaseCostOptions(pbf_costing_options, kBaseCostOptsConfig);
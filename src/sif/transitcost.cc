@@ -642,42 +642,47 @@ void ParseTransitCostOptions(const rapidjson::Document& doc,
     // If specified, parse json and set pbf values
 
     // mode_factor
-    pbf_costing_options->set_mode_factor(
-        kModeFactorRange(rapidjson::get_optional<float>(*json_costing_options, "/mode_factor")
-                             .get_value_or(kModeFactor)));
+    pbf_costing_options->set_mode_factor(kModeFactorRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/mode_factor")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, mode_factor, kModeFactor))));
 
     // wheelchair
     pbf_costing_options->set_wheelchair(
-        rapidjson::get_optional<bool>(*json_costing_options, "/wheelchair").get_value_or(false));
+        rapidjson::get_optional<bool>(*json_costing_options, "/wheelchair")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, wheelchair, false)));
 
     // bicycle
     pbf_costing_options->set_bicycle(
-        rapidjson::get_optional<bool>(*json_costing_options, "/bicycle").get_value_or(false));
+        rapidjson::get_optional<bool>(*json_costing_options, "/bicycle")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, bicycle, false)));
 
     // use_bus
-    pbf_costing_options->set_use_bus(
-        kUseBusRange(rapidjson::get_optional<float>(*json_costing_options, "/use_bus")
-                         .get_value_or(kDefaultUseBus)));
+    pbf_costing_options->set_use_bus(kUseBusRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/use_bus")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, use_bus, kDefaultUseBus))));
 
     // use_rail
-    pbf_costing_options->set_use_rail(
-        kUseRailRange(rapidjson::get_optional<float>(*json_costing_options, "/use_rail")
-                          .get_value_or(kDefaultUseRail)));
+    pbf_costing_options->set_use_rail(kUseRailRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/use_rail")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, use_rail, kDefaultUseRail))));
 
     // use_transfers
-    pbf_costing_options->set_use_transfers(
-        kUseTransfersRange(rapidjson::get_optional<float>(*json_costing_options, "/use_transfers")
-                               .get_value_or(kDefaultUseTransfers)));
+    pbf_costing_options->set_use_transfers(kUseTransfersRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/use_transfers")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, use_transfers,
+                                         kDefaultUseTransfers))));
 
     // transfer_cost
-    pbf_costing_options->set_transfer_cost(
-        kTransferCostRange(rapidjson::get_optional<float>(*json_costing_options, "/transfer_cost")
-                               .get_value_or(kDefaultTransferCost)));
+    pbf_costing_options->set_transfer_cost(kTransferCostRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/transfer_cost")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, transfer_cost,
+                                         kDefaultTransferCost))));
 
     // transfer_penalty
     pbf_costing_options->set_transfer_penalty(kTransferPenaltyRange(
         rapidjson::get_optional<float>(*json_costing_options, "/transfer_penalty")
-            .get_value_or(kDefaultTransferPenalty)));
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, transfer_penalty,
+                                         kDefaultTransferPenalty))));
 
     // filter_stop_action
     auto filter_stop_action_str =
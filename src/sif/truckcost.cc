@@ -425,7 +425,8 @@ Cost TruckCost::EdgeCost(const baldr::DirectedEdge* edge,
                          const graph_tile_ptr& tile,
                          const uint32_t seconds,
                          uint8_t& flow_sources) const {
-  auto edge_speed = tile->GetSpeed(edge, flow_mask_, seconds, true, &flow_sources);
+  auto edge_speed =
+      tile->GetSpeed(edge, flow_mask_, seconds, true, &flow_sources, &predicted_speed_cache_);
   auto final_speed = std::min(edge_speed, top_speed_);
   float sec = edge->length() * speedfactor_[final_speed];
 
@@ -628,41 +629,43 @@ void ParseTruckCostOptions(const rapidjson::Document& doc,
     // low_class_penalty
     pbf_costing_options->set_low_class_penalty(kLowClassPenaltyRange(
         rapidjson::get_optional<float>(*json_costing_options, "/low_class_penalty")
-            .get_value_or(kDefaultLowClassPenalty)));
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, low_class_penalty,
+                                         kDefaultLowClassPenalty))));
 
     // hazmat
     pbf_costing_options->set_hazmat(
-        rapidjson::get_optional<bool>(*json_costing_options, "/hazmat").get_value_or(false));
+        rapidjson::get_optional<bool>(*json_costing_options, "/hazmat")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, hazmat, false)));
 
     // weight
-    pbf_costing_options->set_weight(
-        kTruckWeightRange(rapidjson::get_optional<float>(*json_costing_options, "/weight")
-                              .get_value_or(kDefaultTruckWeight)));
+    pbf_costing_options->set_weight(kTruckWeightRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/weight")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, weight, kDefaultTruckWeight))));
 
     // axle_load
-    pbf_costing_options->set_axle_load(
-        kTruckAxleLoadRange(rapidjson::get_optional<float>(*json_costing_options, "/axle_load")
-                                .get_value_or(kDefaultTruckAxleLoad)));
+    pbf_costing_options->set_axle_load(kTruckAxleLoadRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/axle_load")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, axle_load, kDefaultTruckAxleLoad))));
 
     // height
-    pbf_costing_options->set_height(
-        kTruckHeightRange(rapidjson::get_optional<float>(*json_costing_options, "/height")
-                              .get_value_or(kDefaultTruckHeight)));
+    pbf_costing_options->set_height(kTruckHeightRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/height")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, height, kDefaultTruckHeight))));
 
     // width
-    pbf_costing_options->set_width(
-        kTruckWidthRange(rapidjson::get_optional<float>(*json_costing_options, "/width")
-                             .get_value_or(kDefaultTruckWidth)));
+    pbf_costing_options->set_width(kTruckWidthRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/width")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, width, kDefaultTruckWidth))));
 
     // length
-    pbf_costing_options->set_length(
-        kTruckLengthRange(rapidjson::get_optional<float>(*json_costing_options, "/length")
-                              .get_value_or(kDefaultTruckLength)));
+    pbf_costing_options->set_length(kTruckLengthRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/length")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, length, kDefaultTruckLength))));
 
     // use_tolls
-    pbf_costing_options->set_use_tolls(
-        kUseTollsRange(rapidjson::get_optional<float>(*json_costing_options, "/use_tolls")
-                           .get_value_or(kDefaultUseTolls)));
+    pbf_costing_options->set_use_tolls(kUseTollsRange(
+        rapidjson::get_optional<float>(*json_costing_options, "/use_tolls")
+            .get_value_or(PBF_OR_DEFAULT(pbf_costing_options, use_tolls, kDefaultUseTolls))));
   } else {
     // Set pbf values to defaults
     SetDefaultBaseCostOptions(pbf_costing_options, kBaseCostOptsConfig);
@@ -1,15 +1,25 @@
 #include "skadi/sample.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstddef>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 #include <limits>
 #include <list>
+#include <mutex>
 #include <regex>
 #include <stdexcept>
 #include <string>
 #include <sys/stat.h>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SKADI_USE_SSE2
+#endif
+
 #include <boost/optional.hpp>
 
 #include "baldr/compression_utils.h"
@@ -33,6 +43,55 @@ constexpr size_t TILE_COUNT = 180 * 360;
 // macro is faster than inline function for this..
 #define out_of_range(v) v > NO_DATA_HIGH || v < NO_DATA_LOW
 
+// how many postings get_all interpolates at once
+constexpr size_t BATCH_SIZE = 64;
+
+// the four neighbouring pixels of a batch of postings along with their weights (0 or 1
+// depending on whether the pixel had data) and the fractional pixel offsets of the postings
+struct batch_t {
+  alignas(16) double a[BATCH_SIZE], b[BATCH_SIZE], c[BATCH_SIZE], d[BATCH_SIZE];
+  alignas(16) double wa[BATCH_SIZE], wb[BATCH_SIZE], wc[BATCH_SIZE], wd[BATCH_SIZE];
+  alignas(16) double u[BATCH_SIZE], v[BATCH_SIZE];
+  alignas(16) double value[BATCH_SIZE], adjust[BATCH_SIZE];
+};
+
+// bilinear interpolation of a whole batch, this is the same math as sample::get but laid out so
+// that it vectorizes: missing pixels have zero weight rather than a branch
+void interpolate(batch_t& batch, size_t count) {
+  size_t i = 0;
+#ifdef SKADI_USE_SSE2
+  const __m128d one = _mm_set1_pd(1.0);
+  for (; i + 2 <= count; i += 2) {
+    const __m128d u_ratio = _mm_load_pd(batch.u + i);
+    const __m128d v_ratio = _mm_load_pd(batch.v + i);
+    const __m128d u_inv = _mm_sub_pd(one, u_ratio);
+    const __m128d v_inv = _mm_sub_pd(one, v_ratio);
+    const __m128d a_coef = _mm_mul_pd(_mm_mul_pd(u_inv, v_inv), _mm_load_pd(batch.wa + i));
+    const __m128d b_coef = _mm_mul_pd(_mm_mul_pd(u_ratio, v_inv), _mm_load_pd(batch.wb + i));
+    const __m128d c_coef = _mm_mul_pd(_mm_mul_pd(u_inv, v_ratio), _mm_load_pd(batch.wc + i));
+    const __m128d d_coef = _mm_mul_pd(_mm_mul_pd(u_ratio, v_ratio), _mm_load_pd(batch.wd + i));
+    const __m128d top = _mm_add_pd(_mm_mul_pd(_mm_load_pd(batch.a + i), a_coef),
+                                   _mm_mul_pd(_mm_load_pd(batch.b + i), b_coef));
+    const __m128d bottom = _mm_add_pd(_mm_mul_pd(_mm_load_pd(batch.c + i), c_coef),
+                                      _mm_mul_pd(_mm_load_pd(batch.d + i), d_coef));
+    _mm_store_pd(batch.value + i, _mm_add_pd(top, bottom));
+    _mm_store_pd(batch.adjust + i,
+                 _mm_add_pd(_mm_add_pd(a_coef, b_coef), _mm_add_pd(c_coef, d_coef)));
+  }
+#endif
+  for (; i < count; ++i) {
+    const double u_inv = 1 - batch.u[i];
+    const double v_inv = 1 - batch.v[i];
+    const double a_coef = u_inv * v_inv * batch.wa[i];
+    const double b_coef = batch.u[i] * v_inv * batch.wb[i];
+    const double c_coef = u_inv * batch.v[i] * batch.wc[i];
+    const double d_coef = batch.u[i] * batch.v[i] * batch.wd[i];
+    batch.value[i] =
+        (batch.a[i] * a_coef + batch.b[i] * b_coef) + (batch.c[i] * c_coef + batch.d[i] * d_coef);
+    batch.adjust[i] = (a_coef + b_coef) + (c_coef + d_coef);
+  }
+}
+
 std::list<std::string> get_files(const std::string& root_dir) {
   std::list<std::string> files;
   if (filesystem::exists(root_dir) && filesystem::is_directory(root_dir)) {
@@ -51,10 +110,10 @@ std::list<std::string> get_files(const std::string& root_dir) {
 
 template <typename fmt_t> uint16_t is_hgt(const std::string& name, fmt_t& fmt) {
   std::smatch m;
-  std::regex e(".*/([NS])([0-9]{2})([WE])([0-9]{3})\\.hgt(\\.gz)?$");
+  std::regex e(".*/([NS])([0-9]{2})([WE])([0-9]{3})\\.hgt(\\.gz|\\.blk)?$");
   if (std::regex_search(name, m, e)) {
-    // enum class format_t{ UNKNOWN = 0, GZIP = 1, RAW = 3 };
-    fmt = static_cast<fmt_t>(m[5].length() ? (m[5] == ".gz" ? 1 : 0) : 3);
+    // enum class format_t{ UNKNOWN = 0, GZIP = 1, BLOCKS = 2, RAW = 3 };
+    fmt = static_cast<fmt_t>(m[5].length() ? (m[5] == ".gz" ? 1 : (m[5] == ".blk" ? 2 : 0)) : 3);
     auto lon = std::stoi(m[4]) * (m[3] == "E" ? 1 : -1) + 180;
     auto lat = std::stoi(m[2]) * (m[1] == "N" ? 1 : -1) + 90;
     if (lon >= 0 && lon < 360 && lat >= 0 && lat < 180) {
@@ -68,6 +127,95 @@ int16_t flip(int16_t value) {
   return ((value & 0xFF) << 8) | ((value >> 8) & 0xFF);
 }
 
+// block compressed tiles, the header is followed by the file offset of each block (plus one for
+// the end of the last block) and then the zlib compressed blocks themselves. blocks are stored
+// row major and hold the pixels (in hgt byte order) of their part of the tile row major, blocks
+// along the right and bottom edges are narrower because 3601 is not a multiple of the block size
+constexpr char BLOCKS_MAGIC[8] = {'S', 'K', 'A', 'D', 'I', 'B', 'L', 'K'};
+constexpr uint32_t BLOCK_DIM = 256;
+struct blocks_header_t {
+  char magic[8];
+  uint32_t block_dim;
+  uint32_t blocks_per_side;
+};
+
+// block ids share the cache key space with whole tiles so we need them to fit under 0xFF
+constexpr uint32_t WHOLE_TILE = 0xFF;
+uint32_t cache_key(uint16_t index, uint32_t block = WHOLE_TILE) {
+  return (static_cast<uint32_t>(index) << 8) | block;
+}
+
+const blocks_header_t* blocks_header(const valhalla::midgard::mem_map<char>& mapped) {
+  if (mapped.size() < sizeof(blocks_header_t)) {
+    return nullptr;
+  }
+  const auto* header = reinterpret_cast<const blocks_header_t*>(mapped.get());
+  if (std::memcmp(header->magic, BLOCKS_MAGIC, sizeof(BLOCKS_MAGIC)) || header->block_dim == 0 ||
+      header->blocks_per_side != (HGT_DIM + header->block_dim - 1) / header->block_dim ||
+      header->blocks_per_side * header->blocks_per_side >= WHOLE_TILE) {
+    return nullptr;
+  }
+  const uint64_t block_count = header->blocks_per_side * header->blocks_per_side;
+  if (mapped.size() < sizeof(blocks_header_t) + (block_count + 1) * sizeof(uint64_t)) {
+    return nullptr;
+  }
+  const auto* offsets = reinterpret_cast<const uint64_t*>(mapped.get() + sizeof(blocks_header_t));
+  return offsets[block_count] == mapped.size() ? header : nullptr;
+}
+
+// pixels of a tile stored contiguously, either mapped raw or inflated from gzip
+struct flat_pixels_t {
+  const int16_t* t;
+  int16_t operator()(size_t x, size_t y) const {
+    return flip(t[y * HGT_DIM + x]);
+  }
+};
+
+// fills in one slot of the batch with the neighbouring pixels of the coordinate
+template <class pixels_t, class coord_t>
+void fill(batch_t& batch, size_t i, const pixels_t& pixels, const coord_t& coord) {
+  // figure out what row and column we need from the array of data
+  // NOTE: data is arranged from upper left to bottom right, so y is flipped
+  auto lon = std::floor(coord.first);
+  auto lat = std::floor(coord.second);
+
+  // fractional pixel
+  double u = (coord.first - lon) * (HGT_DIM - 1);
+  double v = (1.0 - (coord.second - lat)) * (HGT_DIM - 1);
+
+  // integer pixel
+  size_t x = std::floor(u);
+  size_t y = std::floor(v);
+  batch.u[i] = u - x;
+  batch.v[i] = v - y;
+
+  auto a = pixels(x, y);
+  auto b = pixels(x + 1, y);
+  batch.a[i] = a;
+  batch.b[i] = b;
+  batch.wa[i] = out_of_range(a) ? 0 : 1;
+  batch.wb[i] = out_of_range(b) ? 0 : 1;
+
+  // only need the second row if you aren't right on the row, this also protects from a corner
+  // case where you sample past the end of the image
+  if (y < HGT_DIM - 1) {
+    auto c = pixels(x, y + 1);
+    auto d = pixels(x + 1, y + 1);
+    batch.c[i] = c;
+    batch.d[i] = d;
+    batch.wc[i] = out_of_range(c) ? 0 : 1;
+    batch.wd[i] = out_of_range(d) ? 0 : 1;
+  } else {
+    batch.c[i] = batch.d[i] = 0;
+    batch.wc[i] = batch.wd[i] = 0;
+  }
+}
+
+// if we are missing everything then give up, if we were missing some we adjust by that
+double result(const batch_t& batch, size_t i) {
+  return batch.adjust[i] == 0 ? NO_DATA_VALUE : batch.value[i] / batch.adjust[i];
+}
+
 uint64_t file_size(const std::string& file_name) {
   // TODO: detect gzip and actually validate the uncompressed size?
   struct stat s;
@@ -80,20 +228,130 @@ uint64_t file_size(const std::string& file_name) {
 namespace valhalla {
 namespace skadi {
 
-::valhalla::skadi::sample::sample(const std::string& data_source)
-    : unzipped_cache(-1, std::vector<int16_t>()), data_source(data_source) {
+const size_t sample::kDefaultCacheSize = HGT_BYTES * 4;
+
+struct sample::cache_t {
+  using tile_t = std::shared_ptr<const std::vector<int16_t>>;
+  using entry_t = std::pair<uint32_t, tile_t>;
+
+  explicit cache_t(size_t max_bytes) : max_bytes(max_bytes), bytes(0), hits(0), misses(0) {
+  }
+
+  // returns the tile and marks it as most recently used
+  tile_t get(uint32_t key) {
+    std::lock_guard<std::mutex> lock(cache_lock);
+    auto found = lookup.find(key);
+    if (found == lookup.end()) {
+      ++misses;
+      return nullptr;
+    }
+    ++hits;
+    lru.splice(lru.begin(), lru, found->second);
+    return found->second->second;
+  }
+
+  // adds the tile evicting the least recently used ones to stay in budget, if another thread
+  // beat us to it we hand back the one that is already cached
+  tile_t put(uint32_t key, tile_t tile) {
+    std::lock_guard<std::mutex> lock(cache_lock);
+    auto found = lookup.find(key);
+    if (found != lookup.end()) {
+      lru.splice(lru.begin(), lru, found->second);
+      return found->second->second;
+    }
+    const size_t tile_bytes = tile->size() * sizeof(int16_t);
+    while (!lru.empty() && bytes + tile_bytes > max_bytes) {
+      bytes -= lru.back().second->size() * sizeof(int16_t);
+      lookup.erase(lru.back().first);
+      lru.pop_back();
+    }
+    // we always keep at least the one tile we are using, like the old single slot cache did
+    lru.emplace_front(key, tile);
+    lookup.emplace(key, lru.begin());
+    bytes += tile_bytes;
+    return tile;
+  }
+
+  size_t max_bytes;
+  size_t bytes;
+  std::list<entry_t> lru;
+  std::unordered_map<uint32_t, std::list<entry_t>::iterator> lookup;
+  std::mutex cache_lock;
+
+  std::atomic<uint64_t> hits;
+  std::atomic<uint64_t> misses;
+};
+
+struct sample::mapped_t {
+  format_t format;
+  midgard::mem_map<char> map;
+};
+
+struct sample::tiles_t {
+  tiles_t() : slots(TILE_COUNT) {
+  }
+  ~tiles_t() {
+    for (auto& slot : slots) {
+      delete slot.load();
+    }
+  }
+
+  // publishes the tile unless another thread beat us to it, either way returns the published one
+  const mapped_t* publish(uint16_t index, std::unique_ptr<mapped_t> tile) {
+    const mapped_t* published = nullptr;
+    if (slots[index].compare_exchange_strong(published, tile.get())) {
+      return tile.release();
+    }
+    return published;
+  }
+
+  std::vector<std::atomic<const mapped_t*>> slots;
+};
+
+// pixels of a block compressed tile, blocks are inflated (and cached) as they are touched
+struct sample::block_pixels_t {
+  block_pixels_t(const sample& s, uint16_t index, const mapped_t& tile)
+      : s(s), index(index), tile(tile), header(blocks_header(tile.map)), last_block(WHOLE_TILE) {
+  }
+
+  int16_t operator()(size_t x, size_t y) const {
+    const uint32_t bx = x / header->block_dim;
+    const uint32_t by = y / header->block_dim;
+    const uint32_t block = by * header->blocks_per_side + bx;
+    // most neighbouring pixels are in the same block so we remember the last one
+    if (block != last_block) {
+      last = s.block(index, tile, block);
+      last_block = block;
+    }
+    if (!last) {
+      return NO_DATA_VALUE;
+    }
+    const size_t width = std::min<size_t>(header->block_dim, HGT_DIM - bx * header->block_dim);
+    return flip(last.get()[(y - by * header->block_dim) * width + (x - bx * header->block_dim)]);
+  }
+
+  const sample& s;
+  uint16_t index;
+  const mapped_t& tile;
+  const blocks_header_t* header;
+  mutable uint32_t last_block;
+  mutable tile_data last;
+};
+
+::valhalla::skadi::sample::sample(const std::string& data_source, size_t cache_size)
+    : unzipped_cache(std::make_shared<cache_t>(cache_size)), data_source(data_source) {
   // messy but needed
   while (this->data_source.size() &&
          this->data_source.back() == filesystem::path::preferred_separator) {
     this->data_source.pop_back();
   }
 
-  // If data_source is empty, do not allocate/resize mapped cache.
+  // If data_source is empty, do not allocate the mapped tiles.
   if (data_source.empty()) {
     LOG_DEBUG("No elevation data_source was provided");
     return;
   }
-  mapped_cache.resize(TILE_COUNT);
+  mapped_tiles = std::make_shared<tiles_t>();
 
   // check the directory for files that look like what we need
   auto files = get_files(data_source);
@@ -101,151 +359,294 @@ namespace skadi {
     // make sure its a valid index
     format_t format = format_t::UNKNOWN;
     auto index = is_hgt(f, format);
-    if (index < mapped_cache.size() && format != format_t::UNKNOWN) {
+    if (index < TILE_COUNT && format != format_t::UNKNOWN) {
       auto size = file_size(f);
       if (format == format_t::RAW && size != HGT_BYTES) {
         LOG_WARN("Corrupt elevation data: " + f);
         continue;
       }
-      mapped_cache[index].first = format;
-      mapped_cache[index].second.map(f, size, POSIX_MADV_SEQUENTIAL);
+      std::unique_ptr<mapped_t> tile(new mapped_t{format, {}});
+      tile->map.map(f, size,
+                    format == format_t::BLOCKS ? POSIX_MADV_RANDOM : POSIX_MADV_SEQUENTIAL);
+      if (format == format_t::BLOCKS && !blocks_header(tile->map)) {
+        LOG_WARN("Corrupt elevation data: " + f);
+        continue;
+      }
+      // nothing is reading yet so the last file found for a tile wins
+      delete mapped_tiles->slots[index].exchange(tile.release());
     }
   }
 }
 
-const int16_t* sample::source(uint16_t index) const {
+const sample::mapped_t* sample::mapped_tile(uint16_t index) const {
   // bail if its out of bounds
-  if (index >= TILE_COUNT) {
+  if (index >= TILE_COUNT || !mapped_tiles) {
     return nullptr;
   }
 
   // if we dont have anything maybe its lazy loaded
-  auto& mapped = mapped_cache[index];
-  if (mapped.second.get() == nullptr) {
+  const auto* tile = mapped_tiles->slots[index].load();
+  if (tile == nullptr) {
     auto f = data_source + get_hgt_file_name(index);
-    auto size = file_size(f);
-    if (size != HGT_BYTES) {
+    if (file_size(f) != HGT_BYTES) {
       return nullptr;
     }
-    mapped.first = format_t::RAW;
-    mapped.second.map(f, size, POSIX_MADV_SEQUENTIAL);
+    std::unique_ptr<mapped_t> lazy(new mapped_t{format_t::RAW, {}});
+    lazy->map.map(f, HGT_BYTES, POSIX_MADV_SEQUENTIAL);
+    tile = mapped_tiles->publish(index, std::move(lazy));
   }
+  return tile;
+}
 
-  // we have it raw or we dont
-  if (mapped.first == format_t::RAW) {
-    return static_cast<const int16_t*>(static_cast<const void*>(mapped.second.get()));
+sample::tile_data sample::source(uint16_t index, const mapped_t* tile) const {
+  // we have it raw or we dont, blocks are read one at a time with block()
+  if (!tile || (tile->format != format_t::RAW && tile->format != format_t::GZIP)) {
+    return {};
+  }
+  const auto& mapped = tile->map;
+  if (tile->format == format_t::RAW) {
+    return {static_cast<const int16_t*>(static_cast<const void*>(mapped.get()))};
   }
 
   // if we have it already unzipped
-  if (unzipped_cache.first == index) {
-    return unzipped_cache.second.data();
+  auto unzipped = unzipped_cache->get(cache_key(index));
+  if (unzipped) {
+    return {unzipped->data(), unzipped};
   }
 
   // for setting where to read compressed data from
   auto src_func = [&mapped](z_stream& s) -> void {
-    s.next_in = static_cast<Byte*>(static_cast<void*>(mapped.second.get()));
-    s.avail_in = static_cast<unsigned int>(mapped.second.size());
+    s.next_in = static_cast<Byte*>(static_cast<void*>(mapped.get()));
+    s.avail_in = static_cast<unsigned int>(mapped.size());
   };
 
   // for setting where to write the uncompressed data to
-  auto dst_func = [this](z_stream& s) -> int {
-    unzipped_cache.second.resize(HGT_PIXELS);
-    s.next_out = static_cast<Byte*>(static_cast<void*>(unzipped_cache.second.data()));
+  auto inflated = std::make_shared<std::vector<int16_t>>();
+  auto dst_func = [&inflated](z_stream& s) -> int {
+    inflated->resize(HGT_PIXELS);
+    s.next_out = static_cast<Byte*>(static_cast<void*>(inflated->data()));
     s.avail_out = HGT_BYTES;
     return Z_FINISH; // we know the output will hold all the input
   };
 
-  // we have to unzip it
+  // we have to unzip it, we do this outside of the cache lock so other tiles can still be read
   if (!baldr::inflate(src_func, dst_func)) {
     LOG_WARN("Corrupt compressed elevation data");
-    unzipped_cache.first = -1;
-    return nullptr;
+    return {};
   }
 
-  // update the simple cache
-  // TODO: LRU
-  unzipped_cache.first = index;
-  return unzipped_cache.second.data();
+  // update the cache
+  unzipped = unzipped_cache->put(cache_key(index), std::move(inflated));
+  return {unzipped->data(), unzipped};
 }
 
-template <class coord_t> double sample::get(const coord_t& coord) const {
-  // check the cache and load
-  auto lon = std::floor(coord.first);
-  auto lat = std::floor(coord.second);
-  auto index = static_cast<uint16_t>(lat + 90) * 360 + static_cast<uint16_t>(lon + 180);
+sample::tile_data sample::block(uint16_t index, const mapped_t& tile, uint32_t block) const {
+  // if we have it already unzipped
+  auto unzipped = unzipped_cache->get(cache_key(index, block));
+  if (unzipped) {
+    return {unzipped->data(), unzipped};
+  }
 
-  // get the proper source of the data
-  const auto* t = source(index);
-  if (t == nullptr) {
-    return NO_DATA_VALUE;
+  // find the compressed bytes of the block, the header was validated when we mapped it
+  const auto& mapped = tile.map;
+  const auto* header = reinterpret_cast<const blocks_header_t*>(mapped.get());
+  const auto* offsets = reinterpret_cast<const uint64_t*>(mapped.get() + sizeof(blocks_header_t));
+  const uint32_t bx = block % header->blocks_per_side;
+  const uint32_t by = block / header->blocks_per_side;
+  const size_t width = std::min<size_t>(header->block_dim, HGT_DIM - bx * header->block_dim);
+  const size_t height = std::min<size_t>(header->block_dim, HGT_DIM - by * header->block_dim);
+  if (offsets[block] > offsets[block + 1] || offsets[block + 1] > mapped.size()) {
+    LOG_WARN("Corrupt block compressed elevation data");
+    return {};
   }
 
-  // figure out what row and column we need from the array of data
-  // NOTE: data is arranged from upper left to bottom right, so y is flipped
+  auto src_func = [&mapped, offsets, block](z_stream& s) -> void {
+    s.next_in = static_cast<Byte*>(static_cast<void*>(mapped.get() + offsets[block]));
+    s.avail_in = static_cast<unsigned int>(offsets[block + 1] - offsets[block]);
+  };
+  auto inflated = std::make_shared<std::vector<int16_t>>(width * height);
+  auto dst_func = [&inflated](z_stream& s) -> int {
+    s.next_out = static_cast<Byte*>(static_cast<void*>(inflated->data()));
+    s.avail_out = static_cast<unsigned int>(inflated->size() * sizeof(int16_t));
+    return Z_FINISH;
+  };
+  if (!baldr::inflate(src_func, dst_func)) {
+    LOG_WARN("Corrupt block compressed elevation data");
+    return {};
+  }
 
-  // fractional pixel
-  double u = (coord.first - lon) * (HGT_DIM - 1);
-  double v = (1.0 - (coord.second - lat)) * (HGT_DIM - 1);
+  unzipped = unzipped_cache->put(cache_key(index, block), std::move(inflated));
+  return {unzipped->data(), unzipped};
+}
 
-  // integer pixel
-  size_t x = std::floor(u);
-  size_t y = std::floor(v);
+sample::cache_stats_t sample::cache_stats() const {
+  std::lock_guard<std::mutex> lock(unzipped_cache->cache_lock);
+  return {unzipped_cache->hits.load(), unzipped_cache->misses.load(), unzipped_cache->lru.size(),
+          unzipped_cache->bytes};
+}
 
-  // coefficients
-  double u_ratio = u - x;
-  double v_ratio = v - y;
-  double u_inv = 1 - u_ratio;
-  double v_inv = 1 - v_ratio;
-  double a_coef = u_inv * v_inv;
-  double b_coef = u_ratio * v_inv;
-  double c_coef = u_inv * v_ratio;
-  double d_coef = u_ratio * v_ratio;
-
-  // values
-  double adjust = 0;
-  auto a = flip(t[y * HGT_DIM + x]);
-  auto b = flip(t[y * HGT_DIM + x + 1]);
-  if (out_of_range(a)) {
-    a_coef = 0;
-  }
-  if (out_of_range(b)) {
-    b_coef = 0;
-  }
-
-  // first part of the bilinear interpolation
-  auto value = a * a_coef + b * b_coef;
-  adjust += a_coef + b_coef;
-  // LOG_INFO('{' + std::to_string(y * HGT_DIM + x) + ',' + std::to_string(a) + '}');
-  // LOG_INFO('{' + std::to_string(y * HGT_DIM + x + 1) + ',' + std::to_string(b) + '}');
-  // only need the second part if you aren't right on the row
-  // this also protects from a corner case where you sample past the end of the image
-  if (y < HGT_DIM - 1) {
-    auto c = flip(t[(y + 1) * HGT_DIM + x]);
-    auto d = flip(t[(y + 1) * HGT_DIM + x + 1]);
-    if (out_of_range(c)) {
-      c_coef = 0;
+bool sample::load_tile(const std::string& file_name, std::vector<int16_t>& pixels) {
+  format_t format = format_t::UNKNOWN;
+  is_hgt(file_name, format);
+  std::ifstream file(file_name, std::ios::binary);
+  std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  pixels.resize(HGT_PIXELS);
+
+  // raw is just a copy
+  if (format == format_t::RAW) {
+    if (bytes.size() != HGT_BYTES) {
+      return false;
     }
-    if (out_of_range(d)) {
-      d_coef = 0;
+    std::memcpy(pixels.data(), bytes.data(), HGT_BYTES);
+    return true;
+  }
+
+  // gzip has to be inflated
+  if (format == format_t::GZIP) {
+    auto src_func = [&bytes](z_stream& s) -> void {
+      s.next_in = static_cast<Byte*>(static_cast<void*>(&bytes[0]));
+      s.avail_in = static_cast<unsigned int>(bytes.size());
+    };
+    auto dst_func = [&pixels](z_stream& s) -> int {
+      s.next_out = static_cast<Byte*>(static_cast<void*>(pixels.data()));
+      s.avail_out = HGT_BYTES;
+      return Z_FINISH;
+    };
+    return baldr::inflate(src_func, dst_func);
+  }
+
+  return false;
+}
+
+bool sample::store_blocks(const std::string& file_name, const std::vector<int16_t>& pixels) {
+  if (pixels.size() != HGT_PIXELS) {
+    return false;
+  }
+
+  blocks_header_t header{};
+  std::memcpy(header.magic, BLOCKS_MAGIC, sizeof(BLOCKS_MAGIC));
+  header.block_dim = BLOCK_DIM;
+  header.blocks_per_side = (HGT_DIM + BLOCK_DIM - 1) / BLOCK_DIM;
+  const uint32_t block_count = header.blocks_per_side * header.blocks_per_side;
+  std::vector<uint64_t> offsets(block_count + 1);
+  offsets.front() = sizeof(header) + offsets.size() * sizeof(uint64_t);
+
+  // compress each block on its own
+  std::string compressed;
+  std::vector<int16_t> block;
+  for (uint32_t i = 0; i < block_count; ++i) {
+    const size_t x0 = (i % header.blocks_per_side) * BLOCK_DIM;
+    const size_t y0 = (i / header.blocks_per_side) * BLOCK_DIM;
+    const size_t width = std::min<size_t>(BLOCK_DIM, HGT_DIM - x0);
+    const size_t height = std::min<size_t>(BLOCK_DIM, HGT_DIM - y0);
+    block.clear();
+    for (size_t y = y0; y < y0 + height; ++y) {
+      block.insert(block.end(), pixels.begin() + y * HGT_DIM + x0,
+                   pixels.begin() + y * HGT_DIM + x0 + width);
     }
-    // LOG_INFO('{' + std::to_string((y + 1) * HGT_DIM + x) + ',' + std::to_string(c) + '}');
-    // LOG_INFO('{' + std::to_string((y + 1) * HGT_DIM + x + 1) + ',' + std::to_string(d) + '}');
-    value += c * c_coef + d * d_coef;
-    adjust += c_coef + d_coef;
+
+    auto src_func = [&block](z_stream& s) -> int {
+      s.next_in = static_cast<Byte*>(static_cast<void*>(block.data()));
+      s.avail_in = static_cast<unsigned int>(block.size() * sizeof(int16_t));
+      return Z_FINISH;
+    };
+    const size_t start = compressed.size();
+    auto dst_func = [&compressed, start](z_stream& s) -> void {
+      // keep what was written and make room for more
+      compressed.resize(start + s.total_out);
+      if (s.avail_in > 0 || s.avail_out == 0) {
+        compressed.resize(start + s.total_out + BLOCK_DIM * BLOCK_DIM);
+        s.next_out = static_cast<Byte*>(static_cast<void*>(&compressed[start + s.total_out]));
+        s.avail_out = BLOCK_DIM * BLOCK_DIM;
+      }
+    };
+    if (!baldr::deflate(src_func, dst_func, Z_BEST_COMPRESSION, false)) {
+      return false;
+    }
+    offsets[i + 1] = offsets.front() + compressed.size();
   }
-  // if we are missing everything then give up
-  if (adjust == 0) {
+
+  std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+  file.write(static_cast<const char*>(static_cast<const void*>(&header)), sizeof(header));
+  file.write(static_cast<const char*>(static_cast<const void*>(offsets.data())),
+             offsets.size() * sizeof(uint64_t));
+  file.write(compressed.data(), compressed.size());
+  return static_cast<bool>(file);
+}
+
+template <class coord_t> double sample::get(const coord_t& coord) const {
+  // check the cache and load
+  auto lon = std::floor(coord.first);
+  auto lat = std::floor(coord.second);
+  auto index = static_cast<uint16_t>(lat + 90) * 360 + static_cast<uint16_t>(lon + 180);
+
+  // get the proper source of the data, holding on to it keeps it from being evicted
+  batch_t batch;
+  const auto* tile = mapped_tile(index);
+  const auto data = source(index, tile);
+  if (data) {
+    fill(batch, 0, flat_pixels_t{data.get()}, coord);
+  } else if (tile && tile->format == format_t::BLOCKS) {
+    fill(batch, 0, block_pixels_t(*this, index, *tile), coord);
+  } else {
     return NO_DATA_VALUE;
   }
-  // if we were missing some we need to adjust by that
-  return value / adjust;
+
+  interpolate(batch, 1);
+  return result(batch, 0);
 }
 
 template <class coords_t> std::vector<double> sample::get_all(const coords_t& coords) const {
-  std::vector<double> values;
-  values.reserve(coords.size());
+  // group the postings by tile so that each tile is looked up (and maybe inflated) only once
+  using coord_t = typename coords_t::value_type;
+  std::vector<std::pair<uint16_t, const coord_t*>> postings;
+  postings.reserve(coords.size());
   for (const auto& coord : coords) {
-    values.emplace_back(get(coord));
+    postings.emplace_back(get_tile_index(coord), &coord);
+  }
+  std::vector<uint32_t> order(postings.size());
+  for (uint32_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&postings](uint32_t a, uint32_t b) {
+    return postings[a].first < postings[b].first;
+  });
+
+  std::vector<double> values(postings.size(), NO_DATA_VALUE);
+  batch_t batch;
+  uint32_t positions[BATCH_SIZE];
+  for (auto run = order.cbegin(); run != order.cend();) {
+    // find all the postings in this tile
+    const auto index = postings[*run].first;
+    auto run_end = run;
+    while (run_end != order.cend() && postings[*run_end].first == index) {
+      ++run_end;
+    }
+
+    // go through the postings a batch at a time
+    auto interpolate_run = [&](const auto& pixels) {
+      while (run != run_end) {
+        size_t count = 0;
+        for (; run != run_end && count < BATCH_SIZE; ++run, ++count) {
+          positions[count] = *run;
+          fill(batch, count, pixels, *postings[*run].second);
+        }
+        interpolate(batch, count);
+        for (size_t i = 0; i < count; ++i) {
+          values[positions[i]] = result(batch, i);
+        }
+      }
+    };
+
+    // no data for this tile we leave them all as no data
+    const auto* tile = mapped_tile(index);
+    const auto data = source(index, tile);
+    if (data) {
+      interpolate_run(flat_pixels_t{data.get()});
+    } else if (tile && tile->format == format_t::BLOCKS) {
+      interpolate_run(block_pixels_t(*this, index, *tile));
+    }
+    run = run_end;
   }
   return values;
 }
@@ -1,6 +1,7 @@
 #include "thor/astar_bss.h"
 #include "baldr/datetime.h"
 #include "midgard/logging.h"
+#include "midgard/profiling.h"
 #include <algorithm>
 #include <iostream> // TODO remove if not needed
 #include <map>
@@ -252,6 +253,7 @@ AStarBSSAlgorithm::GetBestPath(valhalla::Location& origin,
                                const sif::mode_costing_t& mode_costing,
                                const TravelMode mode,
                                const Options&) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kExpansion);
   // Set the mode and costing
   mode_ = mode;
   pedestrian_costing_ = mode_costing[static_cast<uint32_t>(TravelMode::kPedestrian)];
@@ -521,6 +523,7 @@ uint32_t AStarBSSAlgorithm::SetDestination(GraphReader& graphreader, const valha
 // Form the path from the adjacency list.
 std::vector<PathInfo> AStarBSSAlgorithm::FormPath(baldr::GraphReader& graphreader,
                                                   const uint32_t dest) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kPathFormation);
   // Metrics to track
   LOG_DEBUG("path_cost::" + std::to_string(edgelabels_[dest].cost().cost));
   LOG_DEBUG("path_iterations::" + std::to_string(edgelabels_.size()));
@@ -0,0 +1,89 @@
+#include "thor/astarheuristic.h"
+
+using namespace valhalla::baldr;
+
+namespace valhalla {
+namespace thor {
+
+// By the triangle inequality the distance from a node v to the targets T is at least
+// d(L,T) - d(L,v) for the target closest to each landmark L and d(v,L) - d(T,L) for the target
+// farthest from reaching it. The distance from the targets is at least d(L,v) - d(L,T) for the
+// farthest target and d(T,L) - d(v,L) for the closest. A target that is unreachable is infinitely
+// far, so it only leaves the closest target bounds usable
+bool AStarHeuristic::InitLandmarks(const Landmarks& landmarks,
+                                   const uint32_t table,
+                                   const std::vector<GraphId>& targets,
+                                   const bool forward) {
+  landmarks_ = nullptr;
+  if (targets.empty()) {
+    return false;
+  }
+  std::vector<const Landmarks::distance_t*> target_distances;
+  target_distances.reserve(targets.size());
+  for (const auto& target : targets) {
+    const auto index = landmarks.index(target);
+    if (index == Landmarks::kInvalidNode) {
+      return false;
+    }
+    target_distances.push_back(landmarks.distances(table, index));
+  }
+
+  bounds_.resize(landmarks.landmark_count());
+  for (uint32_t l = 0; l < landmarks.landmark_count(); ++l) {
+    Landmarks::distance_t closest{Landmarks::kUnreachable, Landmarks::kUnreachable};
+    Landmarks::distance_t farthest{0.0f, 0.0f};
+    for (const auto* distances : target_distances) {
+      const auto& distance = distances[l];
+      if (distance.from == Landmarks::kUnreachable || farthest.from == Landmarks::kUnreachable) {
+        farthest.from = Landmarks::kUnreachable;
+      } else {
+        farthest.from = std::max(farthest.from, distance.from);
+      }
+      if (distance.to == Landmarks::kUnreachable || farthest.to == Landmarks::kUnreachable) {
+        farthest.to = Landmarks::kUnreachable;
+      } else {
+        farthest.to = std::max(farthest.to, distance.to);
+      }
+      if (distance.from != Landmarks::kUnreachable &&
+          (closest.from == Landmarks::kUnreachable || distance.from < closest.from)) {
+        closest.from = distance.from;
+      }
+      if (distance.to != Landmarks::kUnreachable &&
+          (closest.to == Landmarks::kUnreachable || distance.to < closest.to)) {
+        closest.to = distance.to;
+      }
+    }
+    bounds_[l] = forward ? Landmarks::distance_t{closest.from, farthest.to}
+                         : Landmarks::distance_t{farthest.from, closest.to};
+  }
+
+  landmarks_ = &landmarks;
+  table_ = table;
+  forward_ = forward;
+  return true;
+}
+
+float AStarHeuristic::GetLandmarkDistance(const GraphId& node) const {
+  const auto index = landmarks_->index(node);
+  if (index == Landmarks::kInvalidNode) {
+    return 0.0f;
+  }
+  const auto* distances = landmarks_->distances(table_, index);
+  float distance = 0.0f;
+  for (size_t l = 0; l < bounds_.size(); ++l) {
+    const auto& node_distance = distances[l];
+    const auto& bound = bounds_[l];
+    if (node_distance.from != Landmarks::kUnreachable && bound.from != Landmarks::kUnreachable) {
+      distance = std::max(distance, forward_ ? bound.from - node_distance.from
+                                             : node_distance.from - bound.from);
+    }
+    if (node_distance.to != Landmarks::kUnreachable && bound.to != Landmarks::kUnreachable) {
+      distance =
+          std::max(distance, forward_ ? node_distance.to - bound.to : bound.to - node_distance.to);
+    }
+  }
+  return distance;
+}
+
+} // namespace thor
+} // namespace valhalla
@@ -1,163 +1,218 @@
 #include <thor/attributes_controller.h>
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace valhalla {
 namespace thor {
+namespace {
+
+struct attribute_t {
+  std::string name;
+  bool enabled;
+};
 
 /*
- * Map of attributes that a user can request to enable or disable, and their defaults.
- * Most attributes are enabled by default but a few additional attributes are disabled
- * unless explicitly included with the filter attributes request option.
+ * Attributes that a user can request to enable or disable, and their defaults, in the same order
+ * as the Attribute enum. Most attributes are enabled by default but a few additional attributes
+ * are disabled unless explicitly included with the filter attributes request option.
  */
-const std::unordered_map<std::string, bool> AttributesController::kDefaultAttributes = {
+const attribute_t kAttributes[] = {
     // Edge keys
-    {kEdgeNames, true},
-    {kEdgeLength, true},
-    {kEdgeSpeed, true},
-    {kEdgeRoadClass, true},
-    {kEdgeBeginHeading, true},
-    {kEdgeEndHeading, true},
-    {kEdgeBeginShapeIndex, true},
-    {kEdgeEndShapeIndex, true},
-    {kEdgeTraversability, true},
-    {kEdgeUse, true},
-    {kEdgeToll, true},
-    {kEdgeUnpaved, true},
-    {kEdgeTunnel, true},
-    {kEdgeBridge, true},
-    {kEdgeRoundabout, true},
-    {kEdgeInternalIntersection, true},
-    {kEdgeDriveOnRight, true},
-    {kEdgeSurface, true},
-    {kEdgeSignExitNumber, true},
-    {kEdgeSignExitBranch, true},
-    {kEdgeSignExitToward, true},
-    {kEdgeSignExitName, true},
-    {kEdgeSignGuideBranch, true},
-    {kEdgeSignGuideToward, true},
-    {kEdgeSignJunctionName, true},
-    {kEdgeSignGuidanceViewJunction, true},
-    {kEdgeSignGuidanceViewSignboard, true},
-    {kEdgeTravelMode, true},
-    {kEdgeVehicleType, true},
-    {kEdgePedestrianType, true},
-    {kEdgeBicycleType, true},
-    {kEdgeTransitType, true},
-    {kEdgeTransitRouteInfoOnestopId, true},
-    {kEdgeTransitRouteInfoBlockId, true},
-    {kEdgeTransitRouteInfoTripId, true},
-    {kEdgeTransitRouteInfoShortName, true},
-    {kEdgeTransitRouteInfoLongName, true},
-    {kEdgeTransitRouteInfoHeadsign, true},
-    {kEdgeTransitRouteInfoColor, true},
-    {kEdgeTransitRouteInfoTextColor, true},
-    {kEdgeTransitRouteInfoDescription, true},
-    {kEdgeTransitRouteInfoOperatorOnestopId, true},
-    {kEdgeTransitRouteInfoOperatorName, true},
-    {kEdgeTransitRouteInfoOperatorUrl, true},
-    {kEdgeId, true},
-    {kEdgeWayId, true},
-    {kEdgeWeightedGrade, true},
-    {kEdgeMaxUpwardGrade, true},
-    {kEdgeMaxDownwardGrade, true},
-    {kEdgeMeanElevation, true},
-    {kEdgeLaneCount, true},
-    {kEdgeLaneConnectivity, true},
-    {kEdgeCycleLane, true},
-    {kEdgeBicycleNetwork, true},
-    {kEdgeSacScale, true},
-    {kEdgeShoulder, true},
-    {kEdgeSidewalk, true},
-    {kEdgeDensity, true},
-    {kEdgeSpeedLimit, true},
-    {kEdgeTruckSpeed, true},
-    {kEdgeTruckRoute, true},
-    {kEdgeDefaultSpeed, true},
-    {kEdgeDestinationOnly, true},
-    {kEdgeIsUrban, false},
-    {kEdgeTaggedNames, true},
+    {"edge.names", true},
+    {"edge.length", true},
+    {"edge.speed", true},
+    {"edge.road_class", true},
+    {"edge.begin_heading", true},
+    {"edge.end_heading", true},
+    {"edge.begin_shape_index", true},
+    {"edge.end_shape_index", true},
+    {"edge.traversability", true},
+    {"edge.use", true},
+    {"edge.toll", true},
+    {"edge.unpaved", true},
+    {"edge.tunnel", true},
+    {"edge.bridge", true},
+    {"edge.roundabout", true},
+    {"edge.internal_intersection", true},
+    {"edge.drive_on_right", true},
+    {"edge.surface", true},
+    {"edge.sign.exit_number", true},
+    {"edge.sign.exit_branch", true},
+    {"edge.sign.exit_toward", true},
+    {"edge.sign.exit_name", true},
+    {"edge.sign.guide_branch", true},
+    {"edge.sign.guide_toward", true},
+    {"edge.sign.junction_name", true},
+    {"edge.sign.guidance_view_junction", true},
+    {"edge.sign.guidance_view_signboard", true},
+    {"edge.travel_mode", true},
+    {"edge.vehicle_type", true},
+    {"edge.pedestrian_type", true},
+    {"edge.bicycle_type", true},
+    {"edge.transit_type", true},
+    {"edge.transit_route_info.onestop_id", true},
+    {"edge.transit_route_info.block_id", true},
+    {"edge.transit_route_info.trip_id", true},
+    {"edge.transit_route_info.short_name", true},
+    {"edge.transit_route_info.long_name", true},
+    {"edge.transit_route_info.headsign", true},
+    {"edge.transit_route_info.color", true},
+    {"edge.transit_route_info.text_color", true},
+    {"edge.transit_route_info.description", true},
+    {"edge.transit_route_info.operator_onestop_id", true},
+    {"edge.transit_route_info.operator_name", true},
+    {"edge.transit_route_info.operator_url", true},
+    {"edge.id", true},
+    {"edge.way_id", true},
+    {"edge.weighted_grade", true},
+    {"edge.max_upward_grade", true},
+    {"edge.max_downward_grade", true},
+    {"edge.mean_elevation", true},
+    {"edge.lane_count", true},
+    {"edge.lane_connectivity", true},
+    {"edge.cycle_lane", true},
+    {"edge.bicycle_network", true},
+    {"edge.sac_scale", true},
+    {"edge.shoulder", true},
+    {"edge.sidewalk", true},
+    {"edge.density", true},
+    {"edge.speed_limit", true},
+    {"edge.truck_speed", true},
+    {"edge.truck_route", true},
+    {"edge.default_speed", true},
+    {"edge.destination_only", true},
+    {"edge.is_urban", false},
+    {"edge.tagged_names", true},
 
     // Node keys
-    {kIncidents, false},
-    {kNodeIntersectingEdgeBeginHeading, true},
-    {kNodeIntersectingEdgeFromEdgeNameConsistency, true},
-    {kNodeIntersectingEdgeToEdgeNameConsistency, true},
-    {kNodeIntersectingEdgeDriveability, true},
-    {kNodeIntersectingEdgeCyclability, true},
-    {kNodeIntersectingEdgeWalkability, true},
-    {kNodeIntersectingEdgeUse, true},
-    {kNodeIntersectingEdgeRoadClass, true},
-    {kNodeIntersectingEdgeLaneCount, true},
-    {kNodeIntersectingEdgeSignInfo, true},
-    {kNodeElapsedTime, true},
-    {kNodeAdminIndex, true},
-    {kNodeType, true},
-    {kNodeFork, true},
-    {kNodeTransitPlatformInfoType, true},
-    {kNodeTransitPlatformInfoOnestopId, true},
-    {kNodeTransitPlatformInfoName, true},
-    {kNodeTransitPlatformInfoStationOnestopId, true},
-    {kNodeTransitPlatformInfoStationName, true},
-    {kNodeTransitPlatformInfoArrivalDateTime, true},
-    {kNodeTransitPlatformInfoDepartureDateTime, true},
-    {kNodeTransitPlatformInfoIsParentStop, true},
-    {kNodeTransitPlatformInfoAssumedSchedule, true},
-    {kNodeTransitPlatformInfoLatLon, true},
-    {kNodeTransitStationInfoOnestopId, true},
-    {kNodeTransitStationInfoName, true},
-    {kNodeTransitStationInfoLatLon, true},
-    {kNodeTransitEgressInfoOnestopId, true},
-    {kNodeTransitEgressInfoName, true},
-    {kNodeTransitEgressInfoLatLon, true},
-    {kNodeTimeZone, true},
-    {kNodeTransitionTime, true},
-
-    // Top level: admin list, full shape, and shape bounding box keys
-    {kOsmChangeset, true},
-    {kAdminCountryCode, true},
-    {kAdminCountryText, true},
-    {kAdminStateCode, true},
-    {kAdminStateText, true},
-    {kShape, true},
-    {kMatchedPoint, true},
-    {kMatchedType, true},
-    {kMatchedEdgeIndex, true},
-    {kMatchedBeginRouteDiscontinuity, true},
-    {kMatchedEndRouteDiscontinuity, true},
-    {kMatchedDistanceAlongEdge, true},
-    {kMatchedDistanceFromTracePoint, true},
-    {kConfidenceScore, true},
-    {kRawScore, true},
+    {"node.intersecting_edge.begin_heading", true},
+    {"node.intersecting_edge.from_edge_name_consistency", true},
+    {"node.intersecting_edge.to_edge_name_consistency", true},
+    {"node.intersecting_edge.driveability", true},
+    {"node.intersecting_edge.cyclability", true},
+    {"node.intersecting_edge.walkability", true},
+    {"node.intersecting_edge.use", true},
+    {"node.intersecting_edge.road_class", true},
+    {"node.intersecting_edge.lane_count", true},
+    {"node.intersecting_edge.sign_info", true},
+    {"node.elapsed_time", true},
+    {"node.admin_index", true},
+    {"node.type", true},
+    {"node.fork", true},
+    {"node.transit_platform_info.type", true},
+    {"node.transit_platform_info.onestop_id", true},
+    {"node.transit_platform_info.name", true},
+    {"node.transit_platform_info.station_onestop_id", true},
+    {"node.transit_platform_info.station_name", true},
+    {"node.transit_platform_info.arrival_date_time", true},
+    {"node.transit_platform_info.departure_date_time", true},
+    {"node.transit_platform_info.is_parent_stop", true},
+    {"node.transit_platform_info.assumed_schedule", true},
+    {"node.transit_platform_info.lat_lon", true},
+    {"node.transit_station_info.onestop_id", true},
+    {"node.transit_station_info.name", true},
+    {"node.transit_station_info.lat_lon", true},
+    {"node.transit_egress_info.onestop_id", true},
+    {"node.transit_egress_info.name", true},
+    {"node.transit_egress_info.lat_lon", true},
+    {"node.time_zone", true},
+    {"node.transition_time", true},
+
+    // Top level: osm changeset, admin list, and full shape keys
+    {"osm_changeset", true},
+    {"admin.country_code", true},
+    {"admin.country_text", true},
+    {"admin.state_code", true},
+    {"admin.state_text", true},
+    {"shape", true},
+    {"incidents", false},
+
+    // Map matching ones nested to points and top level ones
+    {"matched.point", true},
+    {"matched.type", true},
+    {"matched.edge_index", true},
+    {"matched.begin_route_discontinuity", true},
+    {"matched.end_route_discontinuity", true},
+    {"matched.distance_along_edge", true},
+    {"matched.distance_from_trace_point", true},
+    {"confidence_score", true},
+    {"raw_score", true},
 
     // Per-shape attributes
-    {kShapeAttributesTime, false},
-    {kShapeAttributesLength, false},
-    {kShapeAttributesSpeed, false},
-    {kShapeAttributesSpeedLimit, false},
-    {kShapeAttributesClosure, false},
+    {"shape_attributes.time", false},
+    {"shape_attributes.length", false},
+    {"shape_attributes.speed", false},
+    {"shape_attributes.speed_limit", false},
+    {"shape_attributes.closure", false},
 };
+static_assert(sizeof(kAttributes) / sizeof(kAttributes[0]) == kAttributeCount,
+              "Every Attribute needs a name and default");
+
+// the name prefix of each category, in the same order as the AttributeCategory enum
+const std::string kCategoryPrefixes[] = {"edge.", "node.", "admin.", "matched.",
+                                         "shape_attributes."};
+static_assert(sizeof(kCategoryPrefixes) / sizeof(kCategoryPrefixes[0]) == kAttributeCategoryCount,
+              "Every AttributeCategory needs a prefix");
+
+AttributeSet default_attributes() {
+  AttributeSet defaults;
+  for (size_t i = 0; i < kAttributeCount; ++i) {
+    defaults[i] = kAttributes[i].enabled;
+  }
+  return defaults;
+}
+
+// bits of all the attributes whose name starts with the category prefix
+const AttributeSet& category_mask(AttributeCategory category) {
+  static const auto masks = []() {
+    std::vector<AttributeSet> masks(kAttributeCategoryCount);
+    for (size_t c = 0; c < kAttributeCategoryCount; ++c) {
+      for (size_t i = 0; i < kAttributeCount; ++i) {
+        masks[c][i] = kAttributes[i].name.compare(0, kCategoryPrefixes[c].size(),
+                                                  kCategoryPrefixes[c]) == 0;
+      }
+    }
+    return masks;
+  }();
+  return masks[category];
+}
+
+} // namespace
 
-AttributesController::AttributesController() {
-  attributes = kDefaultAttributes;
+const AttributeSet AttributesController::kDefaultAttributes = default_attributes();
+
+AttributesController::AttributesController() : attributes(kDefaultAttributes) {
 }
 
 void AttributesController::disable_all() {
-  for (auto& pair : attributes) {
-    pair.second = false;
-  }
+  attributes.reset();
 }
 
 // Used to check if any keys starting with the `category` string are enabled.
-bool AttributesController::category_attribute_enabled(const std::string& category) const {
-  for (const auto& pair : attributes) {
-    // if the key starts with the specified category and it is enabled
-    // then return true
-    if ((pair.first.compare(0, category.size(), category) == 0) && pair.second) {
-      return true;
+bool AttributesController::category_attribute_enabled(AttributeCategory category) const {
+  return (attributes & category_mask(category)).any();
+}
+
+bool AttributesController::set(const std::string& name, bool enabled) {
+  static const auto ids = []() {
+    std::unordered_map<std::string, Attribute> ids;
+    for (size_t i = 0; i < kAttributeCount; ++i) {
+      ids.emplace(kAttributes[i].name, static_cast<Attribute>(i));
     }
+    return ids;
+  }();
+  auto found = ids.find(name);
+  if (found == ids.cend()) {
+    return false;
   }
-  return false;
+  attributes[found->second] = enabled;
+  return true;
+}
+
+const std::string& AttributesController::name(Attribute attribute) {
+  return kAttributes[attribute].name;
 }
 
 } // namespace thor
@@ -1,14 +1,19 @@
 #include "thor/bidirectional_astar.h"
+#include "baldr/cellpartition.h"
 #include "baldr/datetime.h"
 #include "baldr/directededge.h"
 #include "baldr/graphid.h"
 #include "midgard/encoded.h"
 #include "midgard/logging.h"
+#include "midgard/profiling.h"
 #include "sif/edgelabel.h"
 #include "sif/recost.h"
 #include "thor/alternates.h"
 #include <algorithm>
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
 using namespace valhalla::midgard;
 using namespace valhalla::baldr;
 using namespace valhalla::sif;
@@ -39,6 +44,16 @@ inline float find_percent_along(const valhalla::Location& location, const GraphI
   throw std::logic_error("Could not find candidate edge for the location");
 }
 
+// Serializes costing options deterministically so equal options are equal bytes
+std::string serialize(const valhalla::CostingOptions& costing_options) {
+  std::string bytes;
+  google::protobuf::io::StringOutputStream stream(&bytes);
+  google::protobuf::io::CodedOutputStream coded(&stream);
+  coded.SetSerializationDeterministic(true);
+  costing_options.SerializeToCodedStream(&coded);
+  return bytes;
+}
+
 } // namespace
 
 namespace valhalla {
@@ -58,6 +73,9 @@ BidirectionalAStar::BidirectionalAStar(const boost::property_tree::ptree& config
   cost_diff_ = 0.0f;
   pruning_disabled_at_origin_ = false;
   pruning_disabled_at_destination_ = false;
+  arc_flags_target_radius_ = kDefaultArcFlagsTargetRadius;
+  arc_flag_pruning_ = false;
+  origin_regions_ = destination_regions_ = ArcFlags::kAllRegions;
 }
 
 // Destructor
@@ -90,6 +108,11 @@ void BidirectionalAStar::Clear() {
   // reset origin & destination pruning states
   pruning_disabled_at_origin_ = false;
   pruning_disabled_at_destination_ = false;
+  // forget the metric of the last route
+  metric_.reset();
+  endpoint_cells_.clear();
+  jumps_forward_.clear();
+  jumps_reverse_.clear();
 }
 
 // Initialize the A* heuristic and adjacency lists for both the forward
@@ -158,6 +181,7 @@ inline bool BidirectionalAStar::ExpandInner(baldr::GraphReader& graphreader,
                                             const baldr::TimeInfo& time_info) {
   constexpr bool FORWARD = expansion_direction == ExpansionType::forward;
   auto& hierarchy_limits = FORWARD ? hierarchy_limits_forward_ : hierarchy_limits_reverse_;
+
   // Skip shortcut edges until we have stopped expanding on the next level. Use regular
   // edges while still expanding on the next level since we can still transition down to
   // that level. If using a shortcut, set the shortcuts mask. Skip if this is a regular
@@ -201,6 +225,15 @@ inline bool BidirectionalAStar::ExpandInner(baldr::GraphReader& graphreader,
     opp_edge = t2->directededge(opp_edge_id);
   }
 
+  // Skip the edges of the upper levels that aren't on a shortest path towards the other end. The
+  // reverse search moves against the edge it came across, which has to come from the origin
+  if (arc_flag_pruning_) {
+    const auto* flags = arc_flags_->flags(FORWARD ? meta.edge_id : opp_edge_id);
+    if (flags && !(FORWARD ? flags->to & destination_regions_ : flags->from & origin_regions_)) {
+      return false;
+    }
+  }
+
   // Skip this edge if no access is allowed (based on costing method)
   // or if a complex restriction prevents transition onto this edge.
   // if its not time dependent set to 0 for Allowed and Restricted methods below
@@ -275,8 +308,10 @@ inline bool BidirectionalAStar::ExpandInner(baldr::GraphReader& graphreader,
   float dist = 0.0f;
   float sortcost =
       newcost.cost + (FORWARD
-                          ? astarheuristic_forward_.Get(t2->get_node_ll(meta.edge->endnode()), dist)
-                          : astarheuristic_reverse_.Get(t2->get_node_ll(meta.edge->endnode()), dist));
+                          ? astarheuristic_forward_.Get(meta.edge->endnode(),
+                                                        t2->get_node_ll(meta.edge->endnode()), dist)
+                          : astarheuristic_reverse_.Get(meta.edge->endnode(),
+                                                        t2->get_node_ll(meta.edge->endnode()), dist));
 
   // not_thru_pruning_ is only set to false on the 2nd pass in route_action.
   bool thru = not_thru_pruning_ ? (pred.not_thru_pruning() || !meta.edge->not_thru()) : false;
@@ -451,6 +486,7 @@ BidirectionalAStar::GetBestPath(valhalla::Location& origin,
                                 const sif::mode_costing_t& mode_costing,
                                 const sif::TravelMode mode,
                                 const Options& options) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kExpansion);
   // Set the mode and costing
   mode_ = mode;
   costing_ = mode_costing[static_cast<uint32_t>(mode_)];
@@ -465,11 +501,14 @@ BidirectionalAStar::GetBestPath(valhalla::Location& origin,
   PointLL origin_new(origin.path_edges(0).ll().lng(), origin.path_edges(0).ll().lat());
   PointLL destination_new(destination.path_edges(0).ll().lng(), destination.path_edges(0).ll().lat());
   Init(origin_new, destination_new);
+  InitLandmarks(graphreader, origin, destination, options);
 
   // Get time information for forward and backward searches
   bool invariant = options.has_date_time_type() && options.date_time_type() == Options::invariant;
   auto forward_time_info = TimeInfo::make(origin, graphreader, &tz_cache_);
   auto reverse_time_info = TimeInfo::make(destination, graphreader, &tz_cache_);
+  InitArcFlags(graphreader, origin, destination, options,
+               forward_time_info.valid || reverse_time_info.valid);
 
   // When a timedependent route is too long in distance it gets sent to this algorithm. It used to be
   // the case that this algorithm called EdgeCost without a time component. This would result in
@@ -483,6 +522,17 @@ BidirectionalAStar::GetBestPath(valhalla::Location& origin,
   //    reverse_time_info = TimeInfo::make(d, graphreader, &tz_cache_);
   //  }
 
+  // Jump across the cells away from the origin and destination when the overlay has a metric for
+  // the costing. Metrics are customized without a time of day and for the first pass only
+  metric_ = nullptr;
+  endpoint_cells_.clear();
+  if (overlay_ && costing_->pass() == 0 && !forward_time_info.valid && !reverse_time_info.valid) {
+    metric_ = overlay_->GetMetric(options);
+  }
+  if (metric_) {
+    SetEndpointCells(graphreader, origin, destination);
+  }
+
   // Set origin and destination locations - seeds the adj. lists
   // Note: because we can correlate to more than one place for a given
   // PathLocation using edges.front here means we are only setting the
@@ -638,9 +688,11 @@ BidirectionalAStar::GetBestPath(valhalla::Location& origin,
         continue;
       }
 
-      // Expand from the end node in forward direction.
-      Expand<ExpansionType::forward>(graphreader, fwd_pred.endnode(), fwd_pred, forward_pred_idx,
-                                     nullptr, forward_time_info, invariant);
+      // Expand from the end node in forward direction or jump across the cell it is in
+      if (!JumpCell<ExpansionType::forward>(graphreader, fwd_pred, forward_pred_idx)) {
+        Expand<ExpansionType::forward>(graphreader, fwd_pred.endnode(), fwd_pred, forward_pred_idx,
+                                       nullptr, forward_time_info, invariant);
+      }
     } else {
       // Expand reverse - set to get next edge from reverse adj. list on the next pass
       expand_forward = false;
@@ -657,6 +709,11 @@ BidirectionalAStar::GetBestPath(valhalla::Location& origin,
         continue;
       }
 
+      // Jump back across the cell the end node is in if we can
+      if (JumpCell<ExpansionType::reverse>(graphreader, rev_pred, reverse_pred_idx)) {
+        continue;
+      }
+
       // Get the opposing predecessor directed edge. Need to make sure we get
       // the correct one if a transition occurred
       const auto rev_pred_tile = graphreader.GetGraphTile(rev_pred.opp_edgeid());
@@ -806,6 +863,240 @@ bool BidirectionalAStar::SetReverseConnection(GraphReader& graphreader, const BD
   return true;
 }
 
+// Every path leaves the origin through the end node of one of its edges and reaches the
+// destination through the start node of one of its edges, unless both are on the same edge. Those
+// nodes are the targets the landmarks bound the distances to.
+void BidirectionalAStar::InitLandmarks(GraphReader& graphreader,
+                                       const valhalla::Location& origin,
+                                       const valhalla::Location& destination,
+                                       const Options& options) {
+  if (!landmarks_) {
+    return;
+  }
+
+  // The landmarks only used the edges the costing can use with its default access
+  const uint32_t table = landmarks_->table(options.costing());
+  const auto& costing_options = options.costing_options(static_cast<int>(options.costing()));
+  if (table == Landmarks::kInvalidTable || costing_options.ignore_access() ||
+      costing_options.ignore_oneways()) {
+    return;
+  }
+
+  std::vector<GraphId> origin_nodes, destination_nodes;
+  graph_tile_ptr tile;
+  for (const auto& edge : origin.path_edges()) {
+    origin_nodes.push_back(graphreader.GetDirectedEdgeNodes(GraphId(edge.graph_id()), tile).second);
+  }
+  for (const auto& edge : destination.path_edges()) {
+    for (const auto& origin_edge : origin.path_edges()) {
+      if (edge.graph_id() == origin_edge.graph_id()) {
+        return;
+      }
+    }
+    destination_nodes.push_back(
+        graphreader.GetDirectedEdgeNodes(GraphId(edge.graph_id()), tile).first);
+  }
+  astarheuristic_forward_.InitLandmarks(*landmarks_, table, destination_nodes, true);
+  astarheuristic_reverse_.InitLandmarks(*landmarks_, table, origin_nodes, false);
+}
+
+// The flags are built with the default options of their costing, which are kept to compare the
+// options of each route with.
+void BidirectionalAStar::set_arc_flags(const std::shared_ptr<const ArcFlags>& arc_flags,
+                                       const float target_radius) {
+  arc_flags_ = arc_flags;
+  arc_flags_target_radius_ = target_radius;
+  arc_flags_costing_options_ =
+      arc_flags_ ? serialize(DefaultCostingOptions(arc_flags_->costing())) : std::string();
+}
+
+// The regions of a route end are the ones within the target radius of its location and the ones
+// the nodes of its edges are in, an edge has to lead to or come from one of them to be expanded.
+void BidirectionalAStar::InitArcFlags(GraphReader& graphreader,
+                                      const valhalla::Location& origin,
+                                      const valhalla::Location& destination,
+                                      const Options& options,
+                                      const bool time_dependent) {
+  // The flags are for the costs of the default options of their costing without a time of day,
+  // the second pass and alternates expand the whole graph
+  arc_flag_pruning_ = false;
+  origin_regions_ = destination_regions_ = ArcFlags::kAllRegions;
+  const auto costing_index = static_cast<int>(options.costing());
+  if (!arc_flags_ || arc_flags_->costing() != options.costing() || costing_->pass() > 0 ||
+      desired_paths_count_ > 1 || time_dependent ||
+      costing_index >= options.costing_options_size() ||
+      serialize(options.costing_options(costing_index)) != arc_flags_costing_options_) {
+    return;
+  }
+
+  auto regions = [this, &graphreader](const valhalla::Location& location) {
+    const PointLL ll(location.ll().lng(), location.ll().lat());
+    ArcFlags::flags_t regions = arc_flags_->Regions(ll, arc_flags_target_radius_);
+    graph_tile_ptr tile;
+    for (const auto& edge : location.path_edges()) {
+      const auto nodes = graphreader.GetDirectedEdgeNodes(GraphId(edge.graph_id()), tile);
+      for (const auto& node : {nodes.first, nodes.second}) {
+        const NodeInfo* nodeinfo = graphreader.nodeinfo(node, tile);
+        if (nodeinfo != nullptr) {
+          const auto region = arc_flags_->Region(nodeinfo->latlng(tile->header()->base_ll()));
+          regions |= ArcFlags::flags_t(1) << region;
+        }
+      }
+    }
+    return regions;
+  };
+  origin_regions_ = regions(origin);
+  destination_regions_ = regions(destination);
+  arc_flag_pruning_ = true;
+}
+
+// Jumps across the cell the predecessor enters in the forward search or leaves in the reverse
+// search, labeling the edges on the far side of the cell with the costs of the metric.
+template <const ExpansionType expansion_direction>
+bool BidirectionalAStar::JumpCell(GraphReader& graphreader,
+                                  const BDEdgeLabel& pred,
+                                  const uint32_t pred_idx) {
+  constexpr bool FORWARD = expansion_direction == ExpansionType::forward;
+  if (!metric_) {
+    return false;
+  }
+
+  // Going forward the edge enters the cell, in reverse its opposing edge leaves the cell. The cells
+  // around the origin and destination are expanded normally
+  const auto& partition = overlay_->partition();
+  uint32_t cell, index;
+  if (!(FORWARD ? partition.FindEntry(pred.edgeid(), cell, index)
+                : partition.FindExit(pred.opp_edgeid(), cell, index)) ||
+      std::find(endpoint_cells_.cbegin(), endpoint_cells_.cend(), cell) != endpoint_cells_.cend()) {
+    return false;
+  }
+
+  // Going forward we label the exits of the cell, in reverse the opposing edges of its entries
+  auto& edgelabels = FORWARD ? edgelabels_forward_ : edgelabels_reverse_;
+  auto& adjacencylist = FORWARD ? adjacencylist_forward_ : adjacencylist_reverse_;
+  auto& edgestatus = FORWARD ? edgestatus_forward_ : edgestatus_reverse_;
+  auto& astarheuristic = FORWARD ? astarheuristic_forward_ : astarheuristic_reverse_;
+  auto& jumps = FORWARD ? jumps_forward_ : jumps_reverse_;
+  const GraphId* edges = FORWARD ? partition.exits(cell) : partition.entries(cell);
+  const uint32_t count = FORWARD ? partition.exit_count(cell) : partition.entry_count(cell);
+  bool restricted = false;
+  for (uint32_t i = 0; i < count; ++i) {
+    const Cost& through =
+        FORWARD ? metric_->through(cell, index, i) : metric_->through(cell, i, index);
+    if (through.cost == overlay_t::kUnreachable) {
+      continue;
+    }
+    // the ways through the cell with a complex restriction on them are left to the expansion
+    if (FORWARD ? metric_->restricted(cell, index, i) : metric_->restricted(cell, i, index)) {
+      restricted = true;
+      continue;
+    }
+
+    // Get the edge, its opposing edge and which of them we label
+    graph_tile_ptr tile = graphreader.GetGraphTile(edges[i]);
+    if (tile == nullptr) {
+      continue;
+    }
+    const DirectedEdge* edge = tile->directededge(edges[i]);
+    graph_tile_ptr end_tile =
+        edge->leaves_tile() ? graphreader.GetGraphTile(edge->endnode()) : tile;
+    if (end_tile == nullptr) {
+      continue;
+    }
+    const GraphId opp_edge_id = end_tile->GetOpposingEdgeId(edge);
+    const GraphId edgeid = FORWARD ? edges[i] : opp_edge_id;
+    const graph_tile_ptr& label_tile = FORWARD ? tile : end_tile;
+    const DirectedEdge* label_edge = FORWARD ? edge : end_tile->directededge(opp_edge_id);
+
+    EdgeStatusInfo* edge_status = edgestatus.GetPtr(edgeid, label_tile);
+    if (edge_status->set() == EdgeSet::kPermanent) {
+      continue;
+    }
+    Cost newcost = pred.cost() + through +
+                   (FORWARD ? metric_->exit_cost(cell, i) : metric_->entry_cost(cell, i));
+
+    // The way through the cell is the transition so the connection costs stay right
+    if (edge_status->set() == EdgeSet::kTemporary) {
+      BDEdgeLabel& lab = edgelabels[edge_status->index()];
+      if (newcost.cost < lab.cost().cost) {
+        float newsortcost = lab.sortcost() - (lab.cost().cost - newcost.cost);
+        adjacencylist.decrease(edge_status->index(), newsortcost);
+        lab.Update(pred_idx, newcost, newsortcost, through, -1);
+        jumps[edge_status->index()] = pred_idx;
+      }
+      continue;
+    }
+
+    // The labeled edge ends at the end of the exit or the start of the entry
+    const PointLL ll = FORWARD ? end_tile->get_node_ll(edge->endnode())
+                               : tile->get_node_ll(label_edge->endnode());
+    float dist = 0.0f;
+    float sortcost = newcost.cost + astarheuristic.Get(label_edge->endnode(), ll, dist);
+    bool thru = not_thru_pruning_ ? (pred.not_thru_pruning() || !label_edge->not_thru()) : false;
+    uint32_t idx = edgelabels.size();
+    edgelabels.emplace_back(pred_idx, edgeid, FORWARD ? opp_edge_id : edges[i], label_edge, newcost,
+                            sortcost, dist, mode_, through, thru,
+                            (pred.closure_pruning() || !costing_->IsClosed(label_edge, label_tile)),
+                            false, sif::InternalTurn::kNoTurn, -1);
+    adjacencylist.add(idx);
+    *edge_status = {EdgeSet::kTemporary, idx};
+    jumps[idx] = pred_idx;
+
+    // setting this edge as reached
+    if (expansion_callback_) {
+      expansion_callback_(graphreader, "bidirectional_astar", edges[i], "r", false);
+    }
+  }
+  return !restricted;
+}
+
+// Finds the cells of the nodes of the edges at the origin and destination.
+void BidirectionalAStar::SetEndpointCells(GraphReader& graphreader,
+                                          const valhalla::Location& origin,
+                                          const valhalla::Location& dest) {
+  const auto& partition = overlay_->partition();
+  graph_tile_ptr tile;
+  for (const auto* location : {&origin, &dest}) {
+    for (const auto& edge : location->path_edges()) {
+      auto nodes = graphreader.GetDirectedEdgeNodes(GraphId(edge.graph_id()), tile);
+      for (const auto& node : {nodes.first, nodes.second}) {
+        graph_tile_ptr node_tile = node.Is_Valid() ? graphreader.GetGraphTile(node) : nullptr;
+        if (node_tile == nullptr) {
+          continue;
+        }
+        auto cell = partition.Find(CellPartition::CellOf(node, node_tile->get_node_ll(node)));
+        if (cell != CellPartition::kInvalidCell &&
+            std::find(endpoint_cells_.cbegin(), endpoint_cells_.cend(), cell) ==
+                endpoint_cells_.cend()) {
+          endpoint_cells_.push_back(cell);
+        }
+      }
+    }
+  }
+}
+
+// Replaces the jumps across cells in a path with the edges inside the cells.
+bool BidirectionalAStar::UnpackCells(GraphReader& graphreader,
+                                     std::vector<GraphId>& path_edges,
+                                     const std::unordered_set<GraphId>& jumped) const {
+  // A jump goes straight from an entry of a cell to one of its exits
+  const auto& partition = overlay_->partition();
+  std::vector<GraphId> unpacked;
+  unpacked.reserve(path_edges.size());
+  for (size_t i = 0; i < path_edges.size(); ++i) {
+    uint32_t cell, index;
+    if (i > 0 && jumped.count(path_edges[i - 1]) &&
+        (!partition.FindEntry(path_edges[i - 1], cell, index) ||
+         !overlay_->Unpack(graphreader, costing_, cell, path_edges[i - 1], path_edges[i],
+                           unpacked))) {
+      return false;
+    }
+    unpacked.push_back(path_edges[i]);
+  }
+  path_edges = std::move(unpacked);
+  return true;
+}
+
 // Add edges at the origin to the forward adjacency list.
 void BidirectionalAStar::SetOrigin(GraphReader& graphreader,
                                    valhalla::Location& origin,
@@ -861,7 +1152,7 @@ void BidirectionalAStar::SetOrigin(GraphReader& graphreader,
     // TODO: assumes 1m/s which is a maximum penalty this could vary per costing model
     cost.cost += edge.distance();
     float dist = astarheuristic_forward_.GetDistance(nodeinfo->latlng(endtile->header()->base_ll()));
-    float sortcost = cost.cost + astarheuristic_forward_.Get(dist);
+    float sortcost = cost.cost + astarheuristic_forward_.Get(directededge->endnode(), dist);
 
     // Add EdgeLabel to the adjacency list. Set the predecessor edge index
     // to invalid to indicate the origin of the path.
@@ -952,7 +1243,7 @@ void BidirectionalAStar::SetDestination(GraphReader& graphreader,
     // TODO: assumes 1m/s which is a maximum penalty this could vary per costing model
     cost.cost += edge.distance();
     float dist = astarheuristic_reverse_.GetDistance(tile->get_node_ll(opp_dir_edge->endnode()));
-    float sortcost = cost.cost + astarheuristic_reverse_.Get(dist);
+    float sortcost = cost.cost + astarheuristic_reverse_.Get(opp_dir_edge->endnode(), dist);
 
     // Add EdgeLabel to the adjacency list. Set the predecessor edge index
     // to invalid to indicate the origin of the path. Make sure the opposing
@@ -993,6 +1284,7 @@ std::vector<std::vector<PathInfo>> BidirectionalAStar::FormPath(GraphReader& gra
                                                                 const valhalla::Location& dest,
                                                                 const baldr::TimeInfo& time_info,
                                                                 const bool invariant) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kPathFormation);
   LOG_DEBUG("Found connections before stretch filter: " + std::to_string(best_connections_.size()));
 
   if (desired_paths_count_ > 1) {
@@ -1054,6 +1346,9 @@ std::vector<std::vector<PathInfo>> BidirectionalAStar::FormPath(GraphReader& gra
     // set of edges recovered from shortcuts (excluding shortcut's start edges)
     std::unordered_set<GraphId> recovered_inner_edges;
 
+    // the edges entering the cells the searches jumped across
+    std::unordered_set<GraphId> jumped;
+
     // A place to keep the path
     std::vector<GraphId> path_edges;
     path_edges.reserve(static_cast<size_t>(paths.empty() ? 0.f : paths.back().size() * 1.2f));
@@ -1069,6 +1364,12 @@ std::vector<std::vector<PathInfo>> BidirectionalAStar::FormPath(GraphReader& gra
         throw tile_gone_error_t("BidirectionalAStar::FormPath failed", edgelabel.edgeid());
       }
 
+      // the label was jumped to from the edge entering the cell
+      auto jump = jumps_forward_.find(edgelabel_index);
+      if (jump != jumps_forward_.cend() && jump->second == edgelabel.predecessor()) {
+        jumped.insert(edgelabels_forward_[jump->second].edgeid());
+      }
+
       if (edge->is_shortcut()) {
         auto superseded = graphreader.RecoverShortcut(edgelabel.edgeid());
         recovered_inner_edges.insert(superseded.begin() + 1, superseded.end());
@@ -1088,6 +1389,11 @@ std::vector<std::vector<PathInfo>> BidirectionalAStar::FormPath(GraphReader& gra
     // Append the reverse path from the destination - use opposing edges
     // The first edge on the reverse path is the same as the last on the forward
     // path, so get the predecessor.
+    auto connection = jumps_reverse_.find(idx2);
+    if (connection != jumps_reverse_.cend() &&
+        connection->second == edgelabels_reverse_[idx2].predecessor()) {
+      jumped.insert(best_connection->edgeid);
+    }
     for (auto edgelabel_index = edgelabels_reverse_[idx2].predecessor();
          edgelabel_index != kInvalidLabel;
          edgelabel_index = edgelabels_reverse_[edgelabel_index].predecessor()) {
@@ -1098,6 +1404,12 @@ std::vector<std::vector<PathInfo>> BidirectionalAStar::FormPath(GraphReader& gra
         throw tile_gone_error_t("BidirectionalAStar::FormPath failed", edgelabel.edgeid());
       }
 
+      // the label is the opposing edge of the entry of a cell jumped to from the exit
+      auto jump = jumps_reverse_.find(edgelabel_index);
+      if (jump != jumps_reverse_.cend() && jump->second == edgelabel.predecessor()) {
+        jumped.insert(opp_edge_id);
+      }
+
       if (opp_edge->is_shortcut()) {
         auto superseded = graphreader.RecoverShortcut(opp_edge_id);
         recovered_inner_edges.insert(superseded.begin() + 1, superseded.end());
@@ -1111,6 +1423,12 @@ std::vector<std::vector<PathInfo>> BidirectionalAStar::FormPath(GraphReader& gra
       }
     }
 
+    // Fill in the cells the searches jumped across
+    if (metric_ && !UnpackCells(graphreader, path_edges, jumped)) {
+      LOG_ERROR("Bi-directional astar failed to unpack the overlay cells of the path");
+      continue;
+    }
+
     // bidirectional a* has a bug where it fails trivial routes in which you are on a one way edge and
     // the origin is near the end of the edge and the destination is near the beginning, in other
     // words a route that looks trivial but actually needs to go around the block to complete
@@ -2,7 +2,9 @@
 #include <cmath>
 #include <vector>
 
+#include "midgard/constants.h"
 #include "midgard/logging.h"
+#include "midgard/profiling.h"
 #include "thor/costmatrix.h"
 #include "worker.h"
 
@@ -21,6 +23,25 @@ int GetThreshold(const TravelMode mode, const int n) {
   return (mode == TravelMode::kDrive) ? std::min(2700, std::max(100, n / 3)) : 500;
 }
 
+// A conservative speed estimate (in meters per second) for each travel mode. Used to approximate
+// the time at the locations of a time dependent matrix that were not given one
+float EstimatedSpeed(const TravelMode mode) {
+  switch (mode) {
+    case TravelMode::kBicycle:
+      return 10.0f * valhalla::midgard::kMPHtoMetersPerSec;
+    case TravelMode::kPedestrian:
+    case TravelMode::kPublicTransit:
+      return 2.0f * valhalla::midgard::kMPHtoMetersPerSec;
+    case TravelMode::kDrive:
+    default:
+      return 35.0f * valhalla::midgard::kMPHtoMetersPerSec;
+  }
+}
+
+valhalla::midgard::PointLL to_ll(const valhalla::LatLng& ll) {
+  return {ll.lng(), ll.lat()};
+}
+
 bool equals(const valhalla::LatLng& a, const valhalla::LatLng& b) {
   return a.has_lat() == b.has_lat() && a.has_lng() == b.has_lng() &&
          (!a.has_lat() || a.lat() == b.lat()) && (!a.has_lng() || a.lng() == b.lng());
@@ -36,7 +57,8 @@ class CostMatrix::TargetMap : public robin_hood::unordered_map<uint64_t, std::ve
 // Constructor with cost threshold.
 CostMatrix::CostMatrix()
     : mode_(TravelMode::kDrive), access_mode_(kAutoAccess), source_count_(0), remaining_sources_(0),
-      target_count_(0), remaining_targets_(0), current_cost_threshold_(0), targets_{new TargetMap} {
+      target_count_(0), remaining_targets_(0), current_cost_threshold_(0), invariant_(false),
+      targets_{new TargetMap} {
 }
 
 CostMatrix::~CostMatrix() {
@@ -82,6 +104,8 @@ void CostMatrix::Clear() {
   target_hierarchy_limits_.clear();
   source_status_.clear();
   target_status_.clear();
+  source_time_info_.clear();
+  target_time_info_.clear();
 }
 
 // Form a time distance matrix from the set of source locations
@@ -92,16 +116,20 @@ std::vector<TimeDistance> CostMatrix::SourceToTarget(
     GraphReader& graphreader,
     const sif::mode_costing_t& mode_costing,
     const TravelMode mode,
-    const float max_matrix_distance) {
+    const float max_matrix_distance,
+    const bool invariant) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kExpansion);
   // Set the mode and costing
   mode_ = mode;
   costing_ = mode_costing[static_cast<uint32_t>(mode_)];
   access_mode_ = costing_->access_mode();
+  invariant_ = invariant;
 
   current_cost_threshold_ = GetCostThreshold(max_matrix_distance);
 
-  // Set the source and target locations
+  // Set the source and target locations and the times at them
   Clear();
+  SetTimeInfo(graphreader, source_location_list, target_location_list);
   SetSources(graphreader, source_location_list);
   SetTargets(graphreader, target_location_list);
 
@@ -260,6 +288,11 @@ void CostMatrix::ForwardSearch(const uint32_t index, const uint32_t n, GraphRead
     return;
   }
 
+  // The time of day at the end node, set once we know its timezone. If the time isnt valid this
+  // is the constrained flow second of day and 0 for the time restrictions
+  TimeInfo offset_time = source_time_info_[index];
+  uint64_t localtime = 0;
+
   // lambda to expand search forward from the end node
   std::function<void(graph_tile_ptr, const GraphId&, const NodeInfo*, BDEdgeLabel&, const uint32_t,
                      const bool)>
@@ -294,8 +327,10 @@ void CostMatrix::ForwardSearch(const uint32_t index, const uint32_t n, GraphRead
       // Skip this edge if no access is allowed (based on costing method)
       // or if a complex restriction prevents transition onto this edge.
       uint8_t restriction_idx = -1;
-      if (!costing_->Allowed(directededge, false, pred, tile, edgeid, 0, 0, restriction_idx) ||
-          costing_->Restricted(directededge, pred, edgelabels, tile, edgeid, true)) {
+      if (!costing_->Allowed(directededge, false, pred, tile, edgeid, localtime,
+                             offset_time.timezone_index, restriction_idx) ||
+          costing_->Restricted(directededge, pred, edgelabels, tile, edgeid, true, nullptr,
+                               localtime, offset_time.timezone_index)) {
         continue;
       }
 
@@ -304,7 +339,7 @@ void CostMatrix::ForwardSearch(const uint32_t index, const uint32_t n, GraphRead
       uint8_t flow_sources;
       Cost newcost =
           pred.cost() + tc +
-          costing_->EdgeCost(directededge, tile, kConstrainedFlowSecondOfDay, flow_sources);
+          costing_->EdgeCost(directededge, tile, offset_time.second_of_week, flow_sources);
 
       // Check if edge is temporarily labeled and this path has less cost. If
       // less cost the predecessor is updated along with new cost and distance.
@@ -366,6 +401,10 @@ void CostMatrix::ForwardSearch(const uint32_t index, const uint32_t n, GraphRead
   if (tile != nullptr) {
     const NodeInfo* nodeinfo = tile->node(node);
     if (costing_->Allowed(nodeinfo)) {
+      // Update the time information even if time is invariant to account for timezones
+      offset_time = offset_time.forward(invariant_ ? 0.f : pred.cost().secs,
+                                        static_cast<int>(nodeinfo->timezone()));
+      localtime = offset_time.valid ? offset_time.local_time : 0;
       expand(tile, node, nodeinfo, pred, pred_idx, false);
     }
   }
@@ -533,6 +572,11 @@ void CostMatrix::BackwardSearch(const uint32_t index, GraphReader& graphreader)
     return;
   }
 
+  // The time of day at the end node, set once we know its timezone. If the time isnt valid this
+  // is the constrained flow second of day and 0 for the time restrictions
+  TimeInfo offset_time = target_time_info_[index];
+  uint64_t localtime = 0;
+
   // Expand from node in reverse direction.
   std::function<void(graph_tile_ptr, const GraphId&, const NodeInfo*, const uint32_t, BDEdgeLabel&,
                      const uint32_t, const DirectedEdge*, const bool)>
@@ -578,9 +622,10 @@ void CostMatrix::BackwardSearch(const uint32_t index, GraphReader& graphreader)
       // or if a complex restriction prevents transition onto this edge.
       const DirectedEdge* opp_edge = t2->directededge(oppedge);
       uint8_t restriction_idx = -1;
-      if (!costing_->AllowedReverse(directededge, pred, opp_edge, t2, oppedge, 0, 0,
-                                    restriction_idx) ||
-          costing_->Restricted(directededge, pred, edgelabels, tile, edgeid, false)) {
+      if (!costing_->AllowedReverse(directededge, pred, opp_edge, t2, oppedge, localtime,
+                                    offset_time.timezone_index, restriction_idx) ||
+          costing_->Restricted(directededge, pred, edgelabels, tile, edgeid, false, nullptr,
+                               localtime, offset_time.timezone_index)) {
         continue;
       }
 
@@ -591,7 +636,7 @@ void CostMatrix::BackwardSearch(const uint32_t index, GraphReader& graphreader)
                                                 pred.internal_turn());
       uint8_t flow_sources;
       Cost newcost = pred.cost() + tc +
-                     costing_->EdgeCost(opp_edge, tile, kConstrainedFlowSecondOfDay, flow_sources);
+                     costing_->EdgeCost(opp_edge, t2, offset_time.second_of_week, flow_sources);
 
       // Check if edge is temporarily labeled and this path has less cost. If
       // less cost the predecessor is updated along with new cost and distance.
@@ -658,11 +703,69 @@ void CostMatrix::BackwardSearch(const uint32_t index, GraphReader& graphreader)
         opp_pred_edge =
             graphreader.GetGraphTile(pred.opp_edgeid().Tile_Base())->directededge(pred.opp_edgeid());
       }
+      // Update the time information even if time is invariant to account for timezones
+      offset_time = offset_time.reverse(invariant_ ? 0.f : pred.cost().secs,
+                                        static_cast<int>(nodeinfo->timezone()));
+      localtime = offset_time.valid ? offset_time.local_time : 0;
       expand(tile, node, nodeinfo, index, pred, pred_idx, opp_pred_edge, false);
     }
   }
 }
 
+// Sets the times at the sources and targets, approximating them on the side that has none.
+void CostMatrix::SetTimeInfo(
+    GraphReader& graphreader,
+    const google::protobuf::RepeatedPtrField<valhalla::Location>& sources,
+    const google::protobuf::RepeatedPtrField<valhalla::Location>& targets) {
+  // The times given with the locations. TimeInfo::make replaces current with the actual time so
+  // it gets a copy of the location
+  auto make = [&](const google::protobuf::RepeatedPtrField<valhalla::Location>& locations,
+                  std::vector<TimeInfo>& time_infos) {
+    bool any_valid = false;
+    for (const auto& location : locations) {
+      if (location.has_date_time()) {
+        valhalla::Location copy(location);
+        time_infos.push_back(TimeInfo::make(copy, graphreader, &tz_cache_));
+      } else {
+        time_infos.push_back(TimeInfo::invalid());
+      }
+      any_valid = any_valid || time_infos.back().valid;
+    }
+    return any_valid;
+  };
+  bool departures = make(sources, source_time_info_);
+  bool arrivals = make(targets, target_time_info_);
+  if (!departures && !arrivals) {
+    return;
+  }
+
+  // Fill in the side without times from the nearest location on the side with them
+  const auto& known = departures ? sources : targets;
+  const auto& unknown = departures ? targets : sources;
+  const auto& known_time_info = departures ? source_time_info_ : target_time_info_;
+  auto& unknown_time_info = departures ? target_time_info_ : source_time_info_;
+  const float speed = EstimatedSpeed(mode_);
+  for (int i = 0; i < unknown.size(); ++i) {
+    if (unknown_time_info[i].valid) {
+      continue;
+    }
+    auto ll = to_ll(unknown.Get(i).ll());
+    float nearest = std::numeric_limits<float>::max();
+    for (int j = 0; j < known.size(); ++j) {
+      float distance = ll.Distance(to_ll(known.Get(j).ll()));
+      if (!known_time_info[j].valid || distance >= nearest) {
+        continue;
+      }
+      nearest = distance;
+      float secs = invariant_ ? 0.f : distance / speed;
+      const auto& time_info = known_time_info[j];
+      unknown_time_info[i] =
+          departures ? time_info.forward(secs, static_cast<int>(time_info.timezone_index))
+                     : time_info.reverse(secs, static_cast<int>(time_info.timezone_index));
+    }
+  }
+}
+
 // Sets the source/origin locations. Search expands forward from these
 // locations.
 void CostMatrix::SetSources(GraphReader& graphreader,
@@ -705,8 +808,8 @@ void CostMatrix::SetSources(GraphReader& graphreader,
 
       // Get cost. Get distance along the remainder of this edge.
       uint8_t flow_sources;
-      Cost edgecost =
-          costing_->EdgeCost(directededge, tile, kConstrainedFlowSecondOfDay, flow_sources);
+      Cost edgecost = costing_->EdgeCost(directededge, tile,
+                                         source_time_info_[index].second_of_week, flow_sources);
       Cost cost = edgecost * (1.0f - edge.percent_along());
       uint32_t d = std::round(directededge->length() * (1.0f - edge.percent_along()));
 
@@ -791,8 +894,8 @@ void CostMatrix::SetTargets(baldr::GraphReader& graphreader,
       // Use the directed edge for costing, as this is the forward direction
       // along the destination edge.
       uint8_t flow_sources;
-      Cost edgecost =
-          costing_->EdgeCost(directededge, tile, kConstrainedFlowSecondOfDay, flow_sources);
+      Cost edgecost = costing_->EdgeCost(directededge, tile,
+                                         target_time_info_[index].second_of_week, flow_sources);
       Cost cost = edgecost * edge.percent_along();
       uint32_t d = std::round(directededge->length() * edge.percent_along());
 
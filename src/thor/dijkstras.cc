@@ -2,6 +2,7 @@
 #include "baldr/datetime.h"
 #include "midgard/distanceapproximator.h"
 #include "midgard/logging.h"
+#include "midgard/profiling.h"
 #include <algorithm>
 #include <map>
 
@@ -298,6 +299,7 @@ void Dijkstras::Expand(const ExpansionType expansion_type,
                        baldr::GraphReader& reader,
                        const sif::mode_costing_t& costings,
                        const sif::TravelMode mode) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kExpansion);
   // compute the expansion
   switch (expansion_type) {
     case ExpansionType::forward:
@@ -41,15 +41,16 @@ std::string thor_worker_t::matrix(Api& request) {
   json::MapPtr json;
   // do the real work
   std::vector<TimeDistance> time_distances;
+  const bool invariant = options.date_time_type() == Options::invariant;
   auto costmatrix = [&]() {
     thor::CostMatrix matrix;
     return matrix.SourceToTarget(options.sources(), options.targets(), *reader, mode_costing, mode,
-                                 max_matrix_distance.find(costing)->second);
+                                 max_matrix_distance.find(costing)->second, invariant);
   };
   auto timedistancematrix = [&]() {
     thor::TimeDistanceMatrix matrix;
     return matrix.SourceToTarget(options.sources(), options.targets(), *reader, mode_costing, mode,
-                                 max_matrix_distance.find(costing)->second);
+                                 max_matrix_distance.find(costing)->second, invariant);
   };
   if (costing == "bikeshare") {
     thor::TimeDistanceBSSMatrix matrix;
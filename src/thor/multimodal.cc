@@ -1,6 +1,7 @@
 #include "thor/multimodal.h"
 #include "baldr/datetime.h"
 #include "midgard/logging.h"
+#include "midgard/profiling.h"
 #include "worker.h"
 #include <algorithm>
 #include <map>
@@ -102,6 +103,7 @@ MultiModalPathAlgorithm::GetBestPath(valhalla::Location& origin,
                                      const sif::mode_costing_t& mode_costing,
                                      const TravelMode mode,
                                      const Options&) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kExpansion);
   // For pedestrian costing - set flag allowing use of transit connections
   // Set pedestrian costing to use max distance. TODO - need for other modes
   const auto& pc = mode_costing[static_cast<uint32_t>(TravelMode::kPedestrian)];
@@ -836,6 +838,7 @@ bool MultiModalPathAlgorithm::CanReachDestination(const valhalla::Location& dest
 
 // Form the path from the adjacency list.
 std::vector<PathInfo> MultiModalPathAlgorithm::FormPath(const uint32_t dest) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kPathFormation);
   // Metrics to track
   LOG_DEBUG("path_cost::" + std::to_string(edgelabels_[dest].cost().cost));
   LOG_DEBUG("path_iterations::" + std::to_string(edgelabels_.size()));
@@ -0,0 +1,465 @@
+#include "thor/overlay.h"
+#include "baldr/double_bucket_queue.h"
+#include "midgard/logging.h"
+#include "proto_conversions.h"
+#include "sif/costfactory.h"
+#include "sif/edgelabel.h"
+#include "thor/edgestatus.h"
+#include "thor/pathalgorithm.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+using namespace valhalla::baldr;
+using namespace valhalla::sif;
+using namespace valhalla::thor;
+
+namespace {
+
+// whether a complex restriction for the mode of the costing starts or ends on an edge
+bool complex_restriction(const DirectedEdge* edge, const std::shared_ptr<DynamicCost>& costing) {
+  return ((edge->start_restriction() | edge->end_restriction()) & costing->access_mode()) != 0;
+}
+
+/**
+ * An edge based Dijkstra from the end of an edge entering a cell that never leaves the cell. The
+ * edges leaving the cell are labeled but not expanded from. The labels lead back to the first
+ * label, which is the entry.
+ */
+class cell_search_t {
+public:
+  /**
+   * Searches the cell from one of its entries
+   * @param reader     graph reader
+   * @param costing    the costing
+   * @param partition  the partition the cell is in
+   * @param entry      the edge entering the cell
+   * @param settled    called with the number of each exit of the cell as it is settled and the
+   *                   index of its label, returns true to stop the search
+   */
+  void Run(GraphReader& reader,
+           const std::shared_ptr<DynamicCost>& costing,
+           const CellPartition& partition,
+           const GraphId& entry,
+           const std::function<bool(uint32_t, uint32_t)>& settled) {
+    labels_.clear();
+    restricted_.clear();
+    edgestatus_.clear();
+    const uint32_t bucketsize = costing->UnitSize();
+    adjacencylist_.clear();
+    adjacencylist_.reuse(0.0f, kBucketCount * bucketsize, bucketsize, &labels_);
+
+    graph_tile_ptr tile = reader.GetGraphTile(entry);
+    if (tile == nullptr) {
+      return;
+    }
+    const DirectedEdge* edge = tile->directededge(entry);
+    restricted_.push_back(complex_restriction(edge, costing));
+    labels_.emplace_back(kInvalidLabel, entry, edge, Cost{}, 0.0f, 0.0f, costing->travel_mode(), 0,
+                         Cost{}, -1, true, false, InternalTurn::kNoTurn);
+    edgestatus_.Set(entry, EdgeSet::kPermanent, 0, tile);
+    Expand(reader, costing, edge->endnode(), 0);
+
+    uint32_t pred_idx;
+    while ((pred_idx = adjacencylist_.pop()) != kInvalidLabel) {
+      const GraphId edgeid = labels_[pred_idx].edgeid();
+      edgestatus_.Update(edgeid, EdgeSet::kPermanent);
+
+      // the exits are as far as we go
+      uint32_t cell, exit;
+      if (partition.FindExit(edgeid, cell, exit)) {
+        if (settled(exit, pred_idx)) {
+          return;
+        }
+        continue;
+      }
+      Expand(reader, costing, labels_[pred_idx].endnode(), pred_idx);
+    }
+  }
+
+  const std::vector<EdgeLabel>& labels() const {
+    return labels_;
+  }
+
+  // whether a complex restriction starts or ends on any of the edges from the entry to a label
+  bool restricted(const uint32_t label) const {
+    return restricted_[label];
+  }
+
+protected:
+  std::vector<EdgeLabel> labels_;
+  std::vector<uint8_t> restricted_;
+  DoubleBucketQueue<EdgeLabel> adjacencylist_;
+  EdgeStatus edgestatus_;
+
+  // expands from a node in the cell and the nodes on other levels at the same place
+  void Expand(GraphReader& reader,
+              const std::shared_ptr<DynamicCost>& costing,
+              const GraphId& node,
+              const uint32_t pred_idx) {
+    graph_tile_ptr tile = reader.GetGraphTile(node);
+    if (tile == nullptr) {
+      return;
+    }
+    const NodeInfo* nodeinfo = tile->node(node);
+    const EdgeLabel pred = labels_[pred_idx];
+
+    // a node we cant pass through only lets us turn around
+    if (!costing->Allowed(nodeinfo)) {
+      const DirectedEdge* opp_edge = nullptr;
+      graph_tile_ptr opp_tile = tile;
+      const GraphId opp_edge_id = reader.GetOpposingEdgeId(pred.edgeid(), opp_edge, opp_tile);
+      if (opp_edge != nullptr) {
+        ExpandEdge(costing, opp_edge, opp_edge_id, opp_tile, nodeinfo, pred, pred_idx);
+      }
+      return;
+    }
+
+    // leave turning around for when there is nothing else to do
+    bool expanded = false;
+    const DirectedEdge* uturn = nullptr;
+    GraphId uturn_id;
+    GraphId edgeid(node.tileid(), node.level(), nodeinfo->edge_index());
+    const DirectedEdge* edge = tile->directededge(nodeinfo->edge_index());
+    for (uint32_t i = 0; i < nodeinfo->edge_count(); ++i, ++edge, ++edgeid) {
+      if (pred.opp_local_idx() == edge->localedgeidx()) {
+        uturn = edge;
+        uturn_id = edgeid;
+        continue;
+      }
+      expanded = ExpandEdge(costing, edge, edgeid, tile, nodeinfo, pred, pred_idx) || expanded;
+    }
+
+    // nodes on other levels are at the same place so they are always in the same cell
+    const NodeTransition* trans = tile->transition(nodeinfo->transition_index());
+    for (uint32_t i = 0; i < nodeinfo->transition_count(); ++i, ++trans) {
+      graph_tile_ptr trans_tile = reader.GetGraphTile(trans->endnode());
+      if (trans_tile == nullptr) {
+        continue;
+      }
+      const NodeInfo* trans_node = trans_tile->node(trans->endnode());
+      GraphId trans_id(trans->endnode().tileid(), trans->endnode().level(),
+                       trans_node->edge_index());
+      const DirectedEdge* trans_edge = trans_tile->directededge(trans_node->edge_index());
+      for (uint32_t j = 0; j < trans_node->edge_count(); ++j, ++trans_edge, ++trans_id) {
+        expanded =
+            ExpandEdge(costing, trans_edge, trans_id, trans_tile, trans_node, pred, pred_idx) ||
+            expanded;
+      }
+    }
+
+    if (!expanded && uturn != nullptr) {
+      labels_[pred_idx].set_deadend(true);
+      const EdgeLabel deadend = labels_[pred_idx];
+      ExpandEdge(costing, uturn, uturn_id, tile, nodeinfo, deadend, pred_idx);
+    }
+  }
+
+  // labels an edge from a node, returns true if it could be taken
+  bool ExpandEdge(const std::shared_ptr<DynamicCost>& costing,
+                  const DirectedEdge* edge,
+                  const GraphId& edgeid,
+                  const graph_tile_ptr& tile,
+                  const NodeInfo* nodeinfo,
+                  const EdgeLabel& pred,
+                  const uint32_t pred_idx) {
+    if (!CellPartition::Partitions(edge)) {
+      return false;
+    }
+    EdgeStatusInfo* status = edgestatus_.GetPtr(edgeid, tile);
+    if (status->set() == EdgeSet::kPermanent) {
+      return true;
+    }
+    uint8_t restriction_idx = -1;
+    if (!costing->Allowed(edge, false, pred, tile, edgeid, 0, 0, restriction_idx) ||
+        costing->Restricted(edge, pred, labels_, tile, edgeid, true, &edgestatus_)) {
+      return false;
+    }
+
+    Cost transition_cost = costing->TransitionCost(edge, nodeinfo, pred);
+    Cost newcost = pred.cost() + transition_cost + costing->EdgeCost(edge, tile);
+    const bool restricted = restricted_[pred_idx] || complex_restriction(edge, costing);
+    if (status->set() == EdgeSet::kTemporary) {
+      EdgeLabel& label = labels_[status->index()];
+      if (newcost.cost < label.cost().cost) {
+        adjacencylist_.decrease(status->index(), newcost.cost);
+        label.Update(pred_idx, newcost, newcost.cost, transition_cost, restriction_idx);
+        restricted_[status->index()] = restricted;
+      }
+      return true;
+    }
+
+    uint32_t idx = labels_.size();
+    labels_.emplace_back(pred_idx, edgeid, edge, newcost, newcost.cost, 0.0f, pred.mode(), 0,
+                         transition_cost, restriction_idx, true, false, InternalTurn::kNoTurn);
+    restricted_.push_back(restricted);
+    *status = {EdgeSet::kTemporary, idx};
+    adjacencylist_.add(idx);
+    return true;
+  }
+};
+
+} // namespace
+
+namespace valhalla {
+namespace thor {
+
+constexpr float overlay_t::kUnreachable;
+
+overlay_t::overlay_t(const boost::property_tree::ptree& config)
+    : mjolnir_config_(config.get_child("mjolnir")),
+      partition_(CellPartition::Load(config.get<std::string>("mjolnir.partition_file"))),
+      max_metrics_(std::max(config.get<size_t>("thor.overlay.max_metrics", 4), size_t(1))),
+      ttl_(config.get<uint32_t>("thor.overlay.metric_ttl_seconds", 0)),
+      concurrency_(config.get<uint32_t>("thor.overlay.customization_concurrency", 0)) {
+  if (concurrency_ == 0) {
+    concurrency_ = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  auto costings = config.get_child_optional("thor.overlay.costings");
+  if (!costings) {
+    costings_.insert("auto");
+  } else {
+    for (const auto& kv : *costings) {
+      costings_.insert(kv.second.get_value<std::string>());
+    }
+  }
+}
+
+overlay_t::~overlay_t() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (customizing_.valid()) {
+    auto customizing = std::move(customizing_);
+    lock.unlock();
+    customizing.wait();
+  }
+}
+
+std::shared_ptr<overlay_t> overlay_t::get_instance(const boost::property_tree::ptree& config) {
+  static std::shared_ptr<overlay_t> instance = [&config]() -> std::shared_ptr<overlay_t> {
+    if (!config.get_optional<std::string>("mjolnir.partition_file")) {
+      return nullptr;
+    }
+    try {
+      return std::make_shared<overlay_t>(config);
+    } catch (const std::exception& e) {
+      LOG_ERROR(std::string("Overlay disabled: ") + e.what());
+      return nullptr;
+    }
+  }();
+  return instance;
+}
+
+std::string overlay_t::make_key(const Options& options) const {
+  // serializing deterministically makes sure equal costing options are equal bytes
+  std::string key;
+  google::protobuf::io::StringOutputStream stream(&key);
+  google::protobuf::io::CodedOutputStream coded(&stream);
+  coded.SetSerializationDeterministic(true);
+  options.costing_options(static_cast<int>(options.costing())).SerializeToCodedStream(&coded);
+  return key;
+}
+
+std::shared_ptr<const overlay_t::metric_t> overlay_t::GetMetric(const Options& options) {
+  // the edges a request excludes are its own, a metric with them would be no use to anyone else
+  const auto costing_index = static_cast<int>(options.costing());
+  if (!options.has_costing() || costing_index >= options.costing_options_size() ||
+      options.costing_options(costing_index).exclude_edges_size() > 0 ||
+      costings_.find(Costing_Enum_Name(options.costing())) == costings_.cend()) {
+    return nullptr;
+  }
+  auto key = make_key(options);
+  auto now = std::chrono::steady_clock::now();
+
+  // see if it has been customized already
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = metrics_.find(key);
+  if (found != metrics_.end() && ttl_.count() && found->second.expires <= now) {
+    recency_.erase(found->second.position);
+    metrics_.erase(found);
+    found = metrics_.end();
+  }
+  if (found != metrics_.end()) {
+    recency_.splice(recency_.begin(), recency_, found->second.position);
+    return found->second.metric;
+  }
+
+  // customizing takes a while and the whole machine so there is only ever one at a time and no
+  // request waits for it, the ones after it will find it
+  if (customizing_.valid() &&
+      customizing_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    return nullptr;
+  }
+  const auto costing_options = options.costing_options(costing_index);
+  customizing_ = std::async(std::launch::async, [this, key, costing_options]() {
+    std::shared_ptr<const metric_t> metric;
+    try {
+      metric = Customize(costing_options);
+    } catch (const std::exception& e) {
+      LOG_ERROR(std::string("Failed to customize overlay metric: ") + e.what());
+    }
+
+    // publish it and make room for it
+    std::lock_guard<std::mutex> lock(mutex_);
+    recency_.push_front(key);
+    auto& entry = metrics_[key];
+    entry.metric = std::move(metric);
+    entry.expires = std::chrono::steady_clock::now() + ttl_;
+    entry.position = recency_.begin();
+    evict();
+  });
+  return nullptr;
+}
+
+void overlay_t::evict() {
+  // requests still using an evicted metric keep it alive until they are done with it
+  while (metrics_.size() > max_metrics_) {
+    metrics_.erase(recency_.back());
+    recency_.pop_back();
+  }
+}
+
+std::shared_ptr<const overlay_t::metric_t>
+overlay_t::Customize(const CostingOptions& costing_options) const {
+  const auto start = std::chrono::steady_clock::now();
+  auto metric = std::make_shared<metric_t>();
+  const uint32_t cell_count = partition_.cell_count();
+  metric->offsets_.reserve(cell_count + 1);
+  metric->offsets_.push_back(0);
+  for (uint32_t cell = 0; cell < cell_count; ++cell) {
+    metric->exit_counts_.push_back(partition_.exit_count(cell));
+    metric->entry_offsets_.push_back(partition_.entry_offset(cell));
+    metric->exit_offsets_.push_back(partition_.exit_offset(cell));
+    const uint64_t size =
+        static_cast<uint64_t>(partition_.entry_count(cell)) * partition_.exit_count(cell);
+    metric->offsets_.push_back(metric->offsets_.back() + size);
+  }
+  const Cost unreachable(kUnreachable, kUnreachable);
+  metric->through_.assign(metric->offsets_.back(), unreachable);
+  metric->entry_costs_.assign(partition_.cut_edge_count(), unreachable);
+  metric->exit_costs_.assign(partition_.cut_edge_count(), unreachable);
+  metric->restricted_.assign(metric->offsets_.back(), false);
+
+  // the cells dont share anything they write so each thread just takes the next one
+  std::atomic<uint32_t> next_cell(0);
+  std::vector<std::exception_ptr> errors(std::min(concurrency_, std::max(cell_count, 1u)));
+  auto customize = [&](std::exception_ptr& error) {
+    try {
+      GraphReader reader(mjolnir_config_);
+      auto costing = CostFactory().Create(costing_options);
+      costing->set_allow_destination_only(false);
+      cell_search_t search;
+      graph_tile_ptr tile;
+      for (uint32_t cell; (cell = next_cell++) < cell_count;) {
+        const auto* entries = partition_.entries(cell);
+        const auto* exits = partition_.exits(cell);
+        auto* entry_costs = metric->entry_costs_.data() + partition_.entry_offset(cell);
+        auto* exit_costs = metric->exit_costs_.data() + partition_.exit_offset(cell);
+        for (uint32_t j = 0; j < partition_.exit_count(cell); ++j) {
+          if (reader.GetGraphTile(exits[j], tile)) {
+            exit_costs[j] = costing->EdgeCost(tile->directededge(exits[j]), tile);
+          }
+        }
+
+        // the costs through the cell from each entry to all the exits
+        for (uint32_t i = 0; i < partition_.entry_count(cell); ++i) {
+          if (!reader.GetGraphTile(entries[i], tile)) {
+            continue;
+          }
+          const DirectedEdge* edge = tile->directededge(entries[i]);
+          if (!costing->Allowed(edge, tile)) {
+            continue;
+          }
+          entry_costs[i] = costing->EdgeCost(edge, tile);
+          const uint64_t offset =
+              metric->offsets_[cell] + static_cast<uint64_t>(i) * partition_.exit_count(cell);
+          auto* through = metric->through_.data() + offset;
+          // a restriction that reaches over the boundary needs the edges on both sides of it, so
+          // searches have to go through the cell rather than jump on the ways it is on
+          auto* restricted = metric->restricted_.data() + offset;
+          uint32_t remaining = partition_.exit_count(cell);
+          search.Run(reader, costing, partition_, entries[i],
+                     [&](uint32_t exit, uint32_t label) {
+                       if (through[exit].cost == kUnreachable) {
+                         through[exit] = search.labels()[label].cost() - exit_costs[exit];
+                         restricted[exit] = search.restricted(label);
+                         --remaining;
+                       }
+                       return remaining == 0;
+                     });
+        }
+
+        // Check if we need to clear the tile cache
+        if (reader.OverCommitted()) {
+          reader.Trim();
+        }
+      }
+    } catch (...) { error = std::current_exception(); }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(errors.size());
+  for (auto& error : errors) {
+    threads.emplace_back(customize, std::ref(error));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  LOG_INFO("Customized " + costing_options.name() + " overlay metric of " +
+           std::to_string(cell_count) + " cells with " + std::to_string(errors.size()) +
+           " threads in " +
+           std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::steady_clock::now() - start)
+                              .count()) +
+           "ms");
+  return metric;
+}
+
+bool overlay_t::Unpack(GraphReader& reader,
+                       const std::shared_ptr<DynamicCost>& costing,
+                       const uint32_t cell,
+                       const GraphId& entry,
+                       const GraphId& exit,
+                       std::vector<GraphId>& edges) const {
+  uint32_t exit_cell, exit_index;
+  if (!partition_.FindExit(exit, exit_cell, exit_index) || exit_cell != cell) {
+    return false;
+  }
+
+  // the same search that customized the metric finds the same way through the cell
+  cell_search_t search;
+  uint32_t found = kInvalidLabel;
+  search.Run(reader, costing, partition_, entry,
+             [exit_index, &found](uint32_t settled, uint32_t label) {
+               if (settled == exit_index) {
+                 found = label;
+               }
+               return found != kInvalidLabel;
+             });
+  if (found == kInvalidLabel) {
+    return false;
+  }
+
+  // walk back from the exit to the entry, leaving both of them out
+  const auto& labels = search.labels();
+  const auto size = edges.size();
+  for (auto idx = labels[found].predecessor(); idx != 0 && idx != kInvalidLabel;
+       idx = labels[idx].predecessor()) {
+    edges.push_back(labels[idx].edgeid());
+  }
+  std::reverse(edges.begin() + size, edges.end());
+  return true;
+}
+
+} // namespace thor
+} // namespace valhalla
@@ -0,0 +1,648 @@
+#include "thor/raptor.h"
+#include "baldr/datetime.h"
+#include "midgard/logging.h"
+#include "midgard/profiling.h"
+#include "worker.h"
+#include <algorithm>
+#include <limits>
+
+using namespace valhalla::baldr;
+using namespace valhalla::sif;
+
+namespace {
+
+constexpr uint32_t kDefaultMaxRounds = 5;
+constexpr uint32_t kInitialWalkLabelCount = 200000;
+constexpr uint32_t kNoArrival = std::numeric_limits<uint32_t>::max();
+
+// a trip along an edge, each is only ridden once per round
+struct trip_edge_hash {
+  size_t operator()(const std::pair<uint32_t, uint64_t>& trip_edge) const {
+    return std::hash<uint64_t>{}(trip_edge.second ^ (static_cast<uint64_t>(trip_edge.first) << 40));
+  }
+};
+using trip_edges_t = std::unordered_set<std::pair<uint32_t, uint64_t>, trip_edge_hash>;
+
+bool is_stop(const NodeInfo* node) {
+  return node && node->type() == NodeType::kMultiUseTransitPlatform;
+}
+
+void unique_stops(std::vector<GraphId>& stops) {
+  std::sort(stops.begin(), stops.end(),
+            [](const GraphId& a, const GraphId& b) { return a.value < b.value; });
+  stops.erase(std::unique(stops.begin(), stops.end()), stops.end());
+}
+
+} // namespace
+
+namespace valhalla {
+namespace thor {
+
+RaptorPathAlgorithm::RaptorPathAlgorithm(const boost::property_tree::ptree& config)
+    : PathAlgorithm(), max_rounds_(config.get<uint32_t>("raptor_max_rounds", kDefaultMaxRounds)),
+      max_reserved_labels_count_(
+          config.get<uint32_t>("max_reserved_labels_count", kInitialWalkLabelCount)),
+      max_transfer_distance_(0), date_set_(false), date_before_tile_(false), day_(0), dow_(0),
+      start_time_(0) {
+}
+
+// Clear the temporary information generated during path construction.
+void RaptorPathAlgorithm::Clear() {
+  if (walk_labels_.size() > max_reserved_labels_count_) {
+    walk_labels_.resize(max_reserved_labels_count_);
+    walk_labels_.shrink_to_fit();
+    walk_sources_.resize(max_reserved_labels_count_);
+    walk_sources_.shrink_to_fit();
+  }
+  walk_labels_.clear();
+  walk_sources_.clear();
+  adjacencylist_.clear();
+  edgestatus_.clear();
+  rounds_.clear();
+  best_arrival_.clear();
+  rides_.clear();
+  ride_edges_.clear();
+  destinations_.clear();
+  egress_.clear();
+  processed_tiles_.clear();
+  has_ferry_ = false;
+}
+
+// Find the earliest arrival with each number of trips
+std::vector<std::vector<PathInfo>>
+RaptorPathAlgorithm::GetBestPath(valhalla::Location& origin,
+                                 valhalla::Location& destination,
+                                 GraphReader& graphreader,
+                                 const sif::mode_costing_t& mode_costing,
+                                 const TravelMode mode,
+                                 const Options& options) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kExpansion);
+  // Walking to and from the stops uses the max multimodal distance and transit connections
+  const auto& pc = mode_costing[static_cast<uint32_t>(TravelMode::kPedestrian)];
+  pc->SetAllowTransitConnections(true);
+  pc->UseMaxMultiModalDistance();
+  const auto& tc = mode_costing[static_cast<uint32_t>(TravelMode::kPublicTransit)];
+  max_transfer_distance_ = mode_costing[static_cast<uint32_t>(mode)]->GetMaxTransferDistanceMM();
+
+  // For now the date_time must be set on the origin.
+  if (!origin.has_date_time()) {
+    return {};
+  }
+
+  // The destination edges and the cost of the part of them past the destination
+  bool has_other_edges =
+      std::any_of(destination.path_edges().begin(), destination.path_edges().end(),
+                  [](const valhalla::Location::PathEdge& e) { return !e.begin_node(); });
+  for (const auto& edge : destination.path_edges()) {
+    if (has_other_edges && edge.begin_node()) {
+      continue;
+    }
+    GraphId edgeid(edge.graph_id());
+    graph_tile_ptr tile = graphreader.GetGraphTile(edgeid);
+    if (!tile || pc->AvoidAsDestinationEdge(edgeid, edge.percent_along())) {
+      continue;
+    }
+    destinations_[edgeid.value] =
+        pc->EdgeCost(tile->directededge(edgeid), tile) * (1.0f - edge.percent_along());
+  }
+
+  // Walk back from the destination to find the stops within walking distance of it. Pedestrian
+  // access is the same in both directions so we walk forward along the opposing edges
+  const uint32_t bucketsize = pc->UnitSize();
+  adjacencylist_.reuse(0.0f, kBucketCount * bucketsize, bucketsize, &walk_labels_);
+  edgestatus_.clear();
+  for (const auto& edge : destination.path_edges()) {
+    GraphId edgeid(edge.graph_id());
+    if (destinations_.find(edgeid.value) == destinations_.end()) {
+      continue;
+    }
+    graph_tile_ptr tile;
+    const DirectedEdge* opp_edge = nullptr;
+    GraphId opp_edgeid = graphreader.GetOpposingEdgeId(edgeid, opp_edge, tile);
+    if (!opp_edge) {
+      continue;
+    }
+    const float ratio = edge.percent_along();
+    Cost cost = pc->EdgeCost(opp_edge, tile) * ratio;
+    uint32_t idx = walk_labels_.size();
+    walk_labels_.emplace_back(kInvalidLabel, opp_edgeid, opp_edge, cost, cost.secs, 0.0f,
+                              TravelMode::kPedestrian, opp_edge->length() * ratio, Cost{},
+                              baldr::kInvalidRestriction, true, false, InternalTurn::kNoTurn);
+    walk_sources_.emplace_back();
+    edgestatus_.Set(opp_edgeid, EdgeSet::kTemporary, idx, tile);
+    adjacencylist_.add(idx);
+  }
+  Walk(graphreader, pc, std::numeric_limits<uint32_t>::max(),
+       [this](uint32_t idx, const NodeInfo* node) {
+         if (is_stop(node)) {
+           egress_.emplace(walk_labels_[idx].endnode().value, idx);
+         }
+       });
+
+  // Without stops near the destination we can only walk there
+  if (egress_.empty()) {
+    midgard::PointLL ll1(origin.ll().lng(), origin.ll().lat());
+    midgard::PointLL ll2(destination.ll().lng(), destination.ll().lat());
+    if (ll1.Distance(ll2) > 2000.0f) {
+      throw valhalla_exception_t{440};
+    }
+  }
+
+  // Walk from the origin to the stops within walking distance of it, and maybe the destination
+  edgestatus_.clear();
+  adjacencylist_.clear();
+  adjacencylist_.reuse(0.0f, kBucketCount * bucketsize, bucketsize, &walk_labels_);
+  has_other_edges = std::any_of(origin.path_edges().begin(), origin.path_edges().end(),
+                                [](const valhalla::Location::PathEdge& e) { return !e.end_node(); });
+  const NodeInfo* closest_node = nullptr;
+  for (const auto& edge : origin.path_edges()) {
+    GraphId edgeid(edge.graph_id());
+    if ((has_other_edges && edge.end_node()) || pc->AvoidAsOriginEdge(edgeid, edge.percent_along())) {
+      continue;
+    }
+    graph_tile_ptr tile = graphreader.GetGraphTile(edgeid);
+    if (!tile) {
+      continue;
+    }
+    const DirectedEdge* directededge = tile->directededge(edgeid);
+    auto endtile = graphreader.GetGraphTile(directededge->endnode());
+    if (!endtile) {
+      continue;
+    }
+    if (!closest_node) {
+      closest_node = endtile->node(directededge->endnode());
+    }
+    const float ratio = 1.0f - edge.percent_along();
+    Cost cost = pc->EdgeCost(directededge, tile) * ratio;
+    uint32_t idx = walk_labels_.size();
+    walk_labels_.emplace_back(kInvalidLabel, edgeid, directededge, cost, cost.secs, 0.0f,
+                              TravelMode::kPedestrian, directededge->length() * ratio, Cost{},
+                              baldr::kInvalidRestriction, true, false, InternalTurn::kNoTurn);
+    walk_labels_.back().set_origin();
+    walk_sources_.emplace_back();
+    adjacencylist_.add(idx);
+  }
+
+  // Set the origin timezone and the start time
+  if (closest_node != nullptr && origin.date_time() == "current") {
+    origin.set_date_time(
+        DateTime::iso_date_time(DateTime::get_tz_db().from_index(closest_node->timezone())));
+  }
+  origin_date_time_ = origin.date_time();
+  start_time_ = DateTime::seconds_from_midnight(origin_date_time_);
+  date_set_ = false;
+  date_before_tile_ = false;
+  day_ = 0;
+
+  // Round 0 is walking, to the stops or all the way
+  std::vector<journey_t> journeys;
+  journey_t walk{0, {}, kNoArrival, kInvalidLabel};
+  std::vector<GraphId> marked;
+  rounds_.emplace_back();
+  Walk(graphreader, pc, std::numeric_limits<uint32_t>::max(),
+       [&](uint32_t idx, const NodeInfo* node) {
+         const auto& label = walk_labels_[idx];
+         const uint32_t arrival = start_time_ + static_cast<uint32_t>(label.cost().secs);
+         auto dest = destinations_.find(label.edgeid().value);
+         if (dest != destinations_.end() &&
+             (label.predecessor() != kInvalidLabel ||
+              IsTrivial(label.edgeid(), origin, destination))) {
+           const uint32_t remainder = static_cast<uint32_t>(dest->second.secs);
+           if (arrival - std::min(arrival, remainder) < walk.arrival) {
+             walk.arrival = arrival - std::min(arrival, remainder);
+             walk.walk_index = idx;
+           }
+         }
+         if (is_stop(node) &&
+             Improve(0, label.endnode(), {arrival, reached_t::kWalk, idx, 0}, kNoArrival)) {
+           marked.push_back(label.endnode());
+         }
+       });
+  uint32_t best_dest = walk.arrival;
+  if (walk.walk_index != kInvalidLabel) {
+    journeys.push_back(walk);
+  }
+  unique_stops(marked);
+
+  // Each round takes one more trip
+  for (uint32_t round = 1; round <= max_rounds_ && !marked.empty() && !egress_.empty(); ++round) {
+    if (interrupt) {
+      (*interrupt)();
+    }
+    rounds_.emplace_back();
+    auto improved = Ride(graphreader, tc, round, marked, best_dest);
+    Transfer(graphreader, pc, round, improved, best_dest);
+
+    // Keep the journey if walking from one of the improved stops gets there sooner
+    journey_t journey{round, {}, best_dest, kInvalidLabel};
+    for (const auto& stop : improved) {
+      auto egress = egress_.find(stop.value);
+      if (egress == egress_.end()) {
+        continue;
+      }
+      uint32_t arrival = rounds_[round][stop.value].arrival +
+                         static_cast<uint32_t>(walk_labels_[egress->second].cost().secs);
+      if (arrival < journey.arrival) {
+        journey.stop = stop;
+        journey.arrival = arrival;
+      }
+    }
+    if (journey.stop.Is_Valid()) {
+      best_dest = journey.arrival;
+      journeys.push_back(journey);
+    }
+    marked.swap(improved);
+  }
+
+  if (journeys.empty()) {
+    LOG_ERROR("Transit route failed after rounds = " + std::to_string(rounds_.size() - 1));
+    return {};
+  }
+
+  // The last journey arrives first, the ones before it take fewer trips
+  std::vector<std::vector<PathInfo>> paths;
+  for (auto journey = journeys.rbegin();
+       journey != journeys.rend() && paths.size() <= static_cast<size_t>(options.alternates());
+       ++journey) {
+    paths.emplace_back(FormPath(graphreader, *journey));
+  }
+  return paths;
+}
+
+// Walk until there is nothing left to walk to
+void RaptorPathAlgorithm::Walk(GraphReader& graphreader,
+                               const std::shared_ptr<DynamicCost>& pc,
+                               const uint32_t max_distance,
+                               const std::function<void(uint32_t, const NodeInfo*)>& settled) {
+  size_t settled_count = 0;
+  uint32_t predindex;
+  while ((predindex = adjacencylist_.pop()) != kInvalidLabel) {
+    if (interrupt && ++settled_count % kInterruptIterationsInterval == 0) {
+      (*interrupt)();
+    }
+
+    // Copy the label since expanding adds to the labels
+    const EdgeLabel pred = walk_labels_[predindex];
+    edgestatus_.Update(pred.edgeid(), EdgeSet::kPermanent);
+
+    auto tile = graphreader.GetGraphTile(pred.endnode());
+    const NodeInfo* node = tile ? tile->node(pred.endnode()) : nullptr;
+    settled(predindex, node);
+    if (node) {
+      ExpandWalk(graphreader, pred.endnode(), pred, predindex, walk_sources_[predindex], pc,
+                 max_distance, false);
+    }
+  }
+}
+
+// Add the edges that can be walked from a node
+void RaptorPathAlgorithm::ExpandWalk(GraphReader& graphreader,
+                                     const GraphId& node,
+                                     const EdgeLabel& pred,
+                                     const uint32_t pred_idx,
+                                     const GraphId& source,
+                                     const std::shared_ptr<DynamicCost>& pc,
+                                     const uint32_t max_distance,
+                                     const bool from_transition) {
+  auto tile = graphreader.GetGraphTile(node);
+  if (tile == nullptr) {
+    return;
+  }
+  const NodeInfo* nodeinfo = tile->node(node);
+  if (!pc->Allowed(nodeinfo)) {
+    return;
+  }
+
+  GraphId edgeid(node.tileid(), node.level(), nodeinfo->edge_index());
+  EdgeStatusInfo* es = edgestatus_.GetPtr(edgeid, tile);
+  const DirectedEdge* directededge = tile->directededge(nodeinfo->edge_index());
+  for (uint32_t i = 0; i < nodeinfo->edge_count(); i++, directededge++, ++edgeid, ++es) {
+    // Transit lines are ridden, not walked
+    if (directededge->IsTransitLine() || directededge->is_shortcut() ||
+        es->set() == EdgeSet::kPermanent) {
+      continue;
+    }
+
+    // Going from one transit connection directly to another is entering a station and leaving
+    // it without getting on anything
+    if (nodeinfo->type() == NodeType::kTransitEgress && pred.use() == Use::kTransitConnection &&
+        directededge->use() == Use::kTransitConnection) {
+      continue;
+    }
+
+    uint8_t restriction_idx = baldr::kInvalidRestriction;
+    const uint32_t walking_distance = pred.path_distance() + directededge->length();
+    if (walking_distance > max_distance ||
+        !pc->Allowed(directededge, false, pred, tile, edgeid, 0, 0, restriction_idx)) {
+      continue;
+    }
+
+    // Walks find the earliest arrival so they are sorted by time
+    auto transition_cost = pc->TransitionCost(directededge, nodeinfo, pred);
+    Cost newcost = pred.cost() + pc->EdgeCost(directededge, tile) + transition_cost;
+    if (es->set() == EdgeSet::kTemporary) {
+      EdgeLabel& lab = walk_labels_[es->index()];
+      if (newcost.secs < lab.cost().secs) {
+        adjacencylist_.decrease(es->index(), newcost.secs);
+        lab.Update(pred_idx, newcost, newcost.secs, walking_distance, transition_cost,
+                   restriction_idx);
+        walk_sources_[es->index()] = source;
+      }
+      continue;
+    }
+
+    uint32_t idx = walk_labels_.size();
+    walk_labels_.emplace_back(pred_idx, edgeid, directededge, newcost, newcost.secs, 0.0f,
+                              TravelMode::kPedestrian, walking_distance, transition_cost,
+                              restriction_idx, true, false, InternalTurn::kNoTurn);
+    walk_sources_.push_back(source);
+    *es = {EdgeSet::kTemporary, idx};
+    adjacencylist_.add(idx);
+  }
+
+  // Handle transitions - expand from the end node each transition
+  if (!from_transition && nodeinfo->transition_count() > 0) {
+    const NodeTransition* trans = tile->transition(nodeinfo->transition_index());
+    for (uint32_t i = 0; i < nodeinfo->transition_count(); ++i, ++trans) {
+      ExpandWalk(graphreader, trans->endnode(), pred, pred_idx, source, pc, max_distance, true);
+    }
+  }
+}
+
+// Ride the trips leaving the stops marked in the previous round
+std::vector<GraphId> RaptorPathAlgorithm::Ride(GraphReader& graphreader,
+                                               const std::shared_ptr<DynamicCost>& tc,
+                                               const uint32_t round,
+                                               const std::vector<GraphId>& marked,
+                                               const uint32_t best_dest) {
+  std::vector<GraphId> improved;
+  trip_edges_t ridden;
+  const auto& previous = rounds_[round - 1];
+  graph_tile_ptr tile;
+  for (const auto& stop : marked) {
+    auto label = previous.find(stop.value);
+    if (label == previous.end() || !graphreader.GetGraphTile(stop, tile)) {
+      continue;
+    }
+    const NodeInfo* nodeinfo = tile->node(stop);
+    if (processed_tiles_.emplace(tile->id().tileid()).second) {
+      tc->AddToExcludeList(tile);
+    }
+    if (tc->IsExcluded(tile, nodeinfo)) {
+      continue;
+    }
+    SetDate(tile);
+
+    // Getting off one trip and on another at the same stop takes the default transfer time,
+    // walking there from another stop takes the full transfer time
+    const uint32_t board_time =
+        label->second.arrival + (round > 1 && label->second.how == reached_t::kWalk
+                                     ? static_cast<uint32_t>(tc->TransferCost().secs)
+                                     : static_cast<uint32_t>(tc->DefaultTransferCost().secs));
+
+    GraphId edgeid(stop.tileid(), stop.level(), nodeinfo->edge_index());
+    const DirectedEdge* directededge = tile->directededge(nodeinfo->edge_index());
+    for (uint32_t i = 0; i < nodeinfo->edge_count(); i++, directededge++, ++edgeid) {
+      uint8_t restriction_idx = baldr::kInvalidRestriction;
+      if (!directededge->IsTransitLine() ||
+          !tc->Allowed(directededge, false, EdgeLabel{}, tile, edgeid, 0, 0, restriction_idx) ||
+          tc->IsExcluded(tile, directededge)) {
+        continue;
+      }
+
+      // Board the next departure unless an earlier stop of this round already boarded its trip
+      uint32_t departure_time;
+      uint32_t departure =
+          tile->GetTransitDepartureIndex().Find(directededge->lineid(), board_time, day_, dow_,
+                                                date_before_tile_, tc->wheelchair(), tc->bicycle(),
+                                                departure_time);
+      if (departure == TransitDepartureIndex::kNotFound) {
+        continue;
+      }
+      const uint32_t tripid = tile->GetTransitDepartureAt(departure)->tripid();
+      if (ridden.find({tripid, edgeid.value}) != ridden.end()) {
+        continue;
+      }
+
+      // Ride the trip until it ends or reaches an edge this round already rode it along
+      const uint32_t ride_idx = rides_.size();
+      rides_.push_back({stop, tripid, static_cast<uint32_t>(ride_edges_.size())});
+      graph_tile_ptr ride_tile = tile;
+      const DirectedEdge* ride_edge = directededge;
+      GraphId ride_edgeid = edgeid;
+      for (uint32_t count = 1;; ++count) {
+        ridden.emplace(tripid, ride_edgeid.value);
+        const uint32_t arrival =
+            departure_time + ride_tile->GetTransitDepartureAt(departure)->elapsed_time();
+        ride_edges_.push_back({ride_edgeid, arrival});
+
+        // Label the stop at the end of the edge
+        const GraphId end = ride_edge->endnode();
+        auto end_tile = ride_tile;
+        if (!graphreader.GetGraphTile(end, end_tile)) {
+          break;
+        }
+        const NodeInfo* end_node = end_tile->node(end);
+        if (processed_tiles_.emplace(end_tile->id().tileid()).second) {
+          tc->AddToExcludeList(end_tile);
+        }
+        if (!tc->IsExcluded(end_tile, end_node) &&
+            Improve(round, end, {arrival, reached_t::kRide, ride_idx, count}, best_dest)) {
+          improved.push_back(end);
+        }
+
+        // Find where the trip goes next
+        bool goes_on = false;
+        GraphId next_edgeid(end.tileid(), end.level(), end_node->edge_index());
+        const DirectedEdge* next_edge = end_tile->directededge(end_node->edge_index());
+        for (uint32_t j = 0; j < end_node->edge_count() && !goes_on;
+             j++, next_edge++, ++next_edgeid) {
+          if (next_edge->IsTransitLine()) {
+            departure = end_tile->GetTransitDepartureIndex().FindTrip(next_edge->lineid(), tripid,
+                                                                      arrival, departure_time);
+            goes_on = departure != TransitDepartureIndex::kNotFound;
+            if (goes_on) {
+              ride_tile = end_tile;
+              ride_edge = next_edge;
+              ride_edgeid = next_edgeid;
+            }
+          }
+        }
+        if (!goes_on || ridden.find({tripid, ride_edgeid.value}) != ridden.end()) {
+          break;
+        }
+      }
+    }
+  }
+  unique_stops(improved);
+  return improved;
+}
+
+// Walk from the stops improved by riding to others
+void RaptorPathAlgorithm::Transfer(GraphReader& graphreader,
+                                   const std::shared_ptr<DynamicCost>& pc,
+                                   const uint32_t round,
+                                   std::vector<GraphId>& improved,
+                                   const uint32_t best_dest) {
+  if (improved.empty()) {
+    return;
+  }
+
+  // The walks start at the time each stop was arrived at
+  auto& labels = rounds_[round];
+  uint32_t earliest = kNoArrival;
+  for (const auto& stop : improved) {
+    earliest = std::min(earliest, labels[stop.value].arrival);
+  }
+  const uint32_t bucketsize = pc->UnitSize();
+  edgestatus_.clear();
+  adjacencylist_.clear();
+  adjacencylist_.reuse(earliest - start_time_, kBucketCount * bucketsize, bucketsize,
+                       &walk_labels_);
+
+  // Walk away from the edge the trip arrived on
+  graph_tile_ptr tile;
+  for (const auto& stop : improved) {
+    const auto& label = labels[stop.value];
+    const auto& ride = rides_[label.index];
+    const GraphId& ride_edgeid = ride_edges_[ride.first_edge + label.count - 1].edgeid;
+    const DirectedEdge* ride_edge = graphreader.directededge(ride_edgeid, tile);
+    if (!ride_edge) {
+      continue;
+    }
+    const float secs = label.arrival - start_time_;
+    EdgeLabel pred(kInvalidLabel, ride_edgeid, ride_edge, {secs, secs}, secs, 0.0f,
+                   TravelMode::kPublicTransit, 0, Cost{}, baldr::kInvalidRestriction, true, false,
+                   InternalTurn::kNoTurn);
+    ExpandWalk(graphreader, stop, pred, kInvalidLabel, stop, pc, max_transfer_distance_, false);
+  }
+
+  std::vector<GraphId> walked;
+  Walk(graphreader, pc, max_transfer_distance_, [&](uint32_t idx, const NodeInfo* node) {
+    const auto& label = walk_labels_[idx];
+    if (is_stop(node) && label.endnode() != walk_sources_[idx] &&
+        Improve(round, label.endnode(),
+                {start_time_ + static_cast<uint32_t>(label.cost().secs), reached_t::kWalk, idx, 0},
+                best_dest)) {
+      walked.push_back(label.endnode());
+    }
+  });
+  improved.insert(improved.end(), walked.begin(), walked.end());
+  unique_stops(improved);
+}
+
+// Label a stop if this is the earliest it has been reached
+bool RaptorPathAlgorithm::Improve(const uint32_t round,
+                                  const GraphId& stop,
+                                  const stop_label_t& label,
+                                  const uint32_t best_dest) {
+  // Nothing arriving after the destination was reached can improve on it
+  if (label.arrival >= best_dest) {
+    return false;
+  }
+  auto best = best_arrival_.emplace(stop.value, label.arrival);
+  if (!best.second) {
+    if (label.arrival >= best.first->second) {
+      return false;
+    }
+    best.first->second = label.arrival;
+  }
+  rounds_[round][stop.value] = label;
+  return true;
+}
+
+// The schedules are relative to the date the transit tiles were created
+void RaptorPathAlgorithm::SetDate(const graph_tile_ptr& tile) {
+  if (date_set_) {
+    return;
+  }
+  uint32_t date = DateTime::days_from_pivot_date(DateTime::get_formatted_date(origin_date_time_));
+  dow_ = DateTime::day_of_week_mask(origin_date_time_);
+  uint32_t date_created = tile->header()->date_created();
+  if (date < date_created) {
+    date_before_tile_ = true;
+  } else {
+    day_ = date - date_created;
+  }
+  date_set_ = true;
+}
+
+// Add the edges of a walk in reverse, returns the stop the walk started from
+GraphId RaptorPathAlgorithm::FormWalk(const uint32_t walk_index, std::vector<PathInfo>& path) const {
+  GraphId source;
+  for (auto idx = walk_index; idx != kInvalidLabel; idx = walk_labels_[idx].predecessor()) {
+    const auto& label = walk_labels_[idx];
+    path.emplace_back(TravelMode::kPedestrian, Cost{label.cost().secs, label.cost().secs},
+                      label.edgeid(), 0, 0.0f, label.restriction_idx(), label.transition_cost());
+    source = walk_sources_[idx];
+  }
+  return source;
+}
+
+// Form the path of a journey from the destination back to the origin
+std::vector<PathInfo> RaptorPathAlgorithm::FormPath(GraphReader& graphreader,
+                                                    const journey_t& journey) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kPathFormation);
+  std::vector<PathInfo> path;
+  if (!journey.stop.Is_Valid()) {
+    FormWalk(journey.walk_index, path);
+  } else {
+    // The walk from the last stop was found walking back from the destination along the opposing
+    // edges, so the first label is at the destination and the last one at the stop
+    const uint32_t arrival = rounds_[journey.round].at(journey.stop.value).arrival;
+    std::vector<uint32_t> egress;
+    for (auto idx = egress_.at(journey.stop.value); idx != kInvalidLabel;
+         idx = walk_labels_[idx].predecessor()) {
+      egress.push_back(idx);
+    }
+    const float walk_secs = walk_labels_[egress.front()].cost().secs;
+    for (auto idx = egress.rbegin(); idx != egress.rend(); ++idx) {
+      const auto& label = walk_labels_[*idx];
+      const float before = label.predecessor() == kInvalidLabel
+                               ? 0.0f
+                               : walk_labels_[label.predecessor()].cost().secs;
+      const float secs = arrival - start_time_ + walk_secs - before;
+      path.emplace_back(TravelMode::kPedestrian, Cost{secs, secs},
+                        graphreader.GetOpposingEdgeId(label.edgeid()), 0, 0.0f);
+    }
+
+    // Back through the rounds, a ride goes back to the round before and a transfer to the stop
+    // the trip before it arrived at
+    GraphId stop = journey.stop;
+    uint32_t round = journey.round;
+    while (true) {
+      const auto& label = rounds_[round].at(stop.value);
+      if (label.how == reached_t::kWalk) {
+        stop = FormWalk(label.index, path);
+        if (!stop.Is_Valid()) {
+          break;
+        }
+        continue;
+      }
+      const auto& ride = rides_[label.index];
+      for (uint32_t i = label.count; i > 0; --i) {
+        const auto& ride_edge = ride_edges_[ride.first_edge + i - 1];
+        const float secs = ride_edge.arrival - start_time_;
+        path.emplace_back(TravelMode::kPublicTransit, Cost{secs, secs}, ride_edge.edgeid,
+                          ride.tripid, 0.0f);
+      }
+      stop = ride.board_stop;
+      --round;
+    }
+  }
+  std::reverse(path.begin(), path.end());
+
+  // The walks each counted their own distance
+  float distance = 0.0f;
+  graph_tile_ptr tile;
+  for (auto& info : path) {
+    const DirectedEdge* edge = graphreader.directededge(info.edgeid, tile);
+    distance += edge ? edge->length() : 0.0f;
+    info.path_distance = distance;
+    has_ferry_ = has_ferry_ || (edge && edge->use() == Use::kFerry);
+  }
+  return path;
+}
+
+} // namespace thor
+} // namespace valhalla
@@ -1,5 +1,9 @@
 #include "thor/worker.h"
+#include <atomic>
 #include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
 
 #include "baldr/json.h"
 #include "baldr/rapidjson_utils.h"
@@ -27,6 +31,29 @@ namespace {
 // A* can take excessive time for longer paths - so exclude them to protect the service.
 constexpr float kPedestrianMultipassThreshold = 50000.0f; // 50km
 
+// Rounds in which all of the remaining legs of a route are computed concurrently from estimates
+// of their origins. After that the legs are computed one after the other like path_depart_at does
+constexpr size_t kMaxSpeculativeLegRounds = 3;
+
+/**
+ * Moves a local date time by as many seconds as separate two other local date times. All of them
+ * are wall clock times of the same route so timezones dont come into play. If either of the
+ * reference times isnt a valid date time (eg "current") the date time is returned as is
+ */
+std::string shift_date_time(const std::string& date_time,
+                            const std::string& from,
+                            const std::string& to) {
+  if (from == to || !DateTime::is_iso_valid(from) || !DateTime::is_iso_valid(to) ||
+      !DateTime::is_iso_valid(date_time)) {
+    return date_time;
+  }
+  const auto* utc = DateTime::get_tz_db().from_index(DateTime::get_tz_db().to_index("Etc/UTC"));
+  auto seconds = static_cast<int64_t>(DateTime::seconds_since_epoch(date_time, utc)) +
+                 static_cast<int64_t>(DateTime::seconds_since_epoch(to, utc)) -
+                 static_cast<int64_t>(DateTime::seconds_since_epoch(from, utc));
+  return DateTime::seconds_to_date(static_cast<uint64_t>(seconds), utc, false);
+}
+
 /**
  * Check if the paths meet at opposing edges (but not at a node). If so, add a route discontinuity
  * so that the shape / distance along the path is adjusted at the location.
@@ -214,6 +241,7 @@ std::string thor_worker_t::expansion(Api& request) {
   // tell all the algorithms how to track expansion
   for (auto* alg : std::vector<PathAlgorithm*>{
            &multi_modal_astar,
+           &raptor,
            &timedep_forward,
            &timedep_reverse,
            &bidir_astar,
@@ -232,6 +260,7 @@ std::string thor_worker_t::expansion(Api& request) {
   // tell all the algorithms to stop tracking the expansion
   for (auto* alg : std::vector<PathAlgorithm*>{
            &multi_modal_astar,
+           &raptor,
            &timedep_forward,
            &timedep_reverse,
            &bidir_astar,
@@ -291,7 +320,7 @@ void thor_worker_t::route(Api& request) {
   // get all the legs
   if (options.has_date_time_type() && options.date_time_type() == Options::arrive_by) {
     path_arrive_by(request, costing);
-  } else {
+  } else if (!path_depart_at_parallel(request, costing)) {
     path_depart_at(request, costing);
   }
   // log admin areas
@@ -311,6 +340,7 @@ thor::PathAlgorithm* thor_worker_t::get_path_algorithm(const std::string& routet
   // make sure they are all cancelable
   for (auto* alg : std::vector<PathAlgorithm*>{
            &multi_modal_astar,
+           &raptor,
            &timedep_forward,
            &timedep_reverse,
            &bidir_astar,
@@ -321,7 +351,7 @@ thor::PathAlgorithm* thor_worker_t::get_path_algorithm(const std::string& routet
 
   // Have to use multimodal for transit based routing
   if (routetype == "multimodal" || routetype == "transit") {
-    return &multi_modal_astar;
+    return raptor_transit ? static_cast<PathAlgorithm*>(&raptor) : &multi_modal_astar;
   }
 
   // Have to use bike share station algorithm
@@ -568,7 +598,7 @@ void thor_worker_t::path_arrive_by(Api& api, const std::string& costing) {
   *api.mutable_options()->mutable_locations() = std::move(correlated);
 }
 
-void thor_worker_t::path_depart_at(Api& api, const std::string& costing) {
+void thor_worker_t::path_depart_at(Api& api, const std::string& costing, bool allow_retry) {
   // Things we'll need
   TripRoute* route = nullptr;
   GraphId last_edge;
@@ -662,7 +692,6 @@ void thor_worker_t::path_depart_at(Api& api, const std::string& costing) {
   };
 
   auto correlated = options.locations();
-  bool allow_retry = true;
 
   // For each pair of locations
   auto destination = ++correlated.begin();
@@ -705,6 +734,181 @@ void thor_worker_t::path_depart_at(Api& api, const std::string& costing) {
   *api.mutable_options()->mutable_locations() = std::move(correlated);
 }
 
+bool thor_worker_t::path_depart_at_parallel(Api& api, const std::string& costing) {
+  const Options& options = api.options();
+  if (leg_concurrency < 2 || options.alternates() > 0 || options.action() == Options::expansion) {
+    return false;
+  }
+
+  // Split the route at the plain break locations. A break_through restricts the edge the next leg
+  // leaves on to the one the previous leg arrived on so it cant be used to split the route
+  std::vector<int> breaks{0};
+  for (int i = 1; i < options.locations_size() - 1; ++i) {
+    if (options.locations(i).type() == valhalla::Location::kBreak) {
+      breaks.push_back(i);
+    }
+  }
+  breaks.push_back(options.locations_size() - 1);
+  if (breaks.size() < 3) {
+    return false;
+  }
+
+  // Every leg is computed as a request of its own made of the locations from one break to the next
+  Options leg_options(options);
+  leg_options.clear_locations();
+  struct leg_t {
+    Api api;                // the request for this leg, the results are added to it
+    std::string origin;     // the serialized origin the leg was computed from
+    std::string departure;  // the date time of that origin
+    bool computed = false;
+  };
+  std::vector<leg_t> legs(breaks.size() - 1);
+
+  size_t verified = 0; // the legs before this one were computed from the same origin as they
+                       // would have been one after the other
+  for (size_t round = 0; verified < legs.size(); ++round) {
+    // Estimate the origin of each remaining leg from the destination the leg before it ended up
+    // at. If that leg has been given a different departure since it was computed its arrival is
+    // moved by the same amount
+    std::vector<size_t> todo;
+    std::string departure;
+    valhalla::Location arrival;    // where the leg before ended up when it was last computed
+    std::string arrival_departure; // and the departure it was computed with
+    bool has_arrival = false;
+    if (verified > 0) {
+      departure = arrival_departure = legs[verified - 1].departure;
+      arrival = *legs[verified - 1].api.options().locations().rbegin();
+      has_arrival = true;
+    }
+    for (size_t i = verified; i < legs.size(); ++i) {
+      valhalla::Location origin;
+      if (i == 0) {
+        origin = options.locations(0);
+      } else if (has_arrival) {
+        origin = arrival;
+        if (origin.has_date_time()) {
+          origin.set_date_time(shift_date_time(origin.date_time(), arrival_departure, departure));
+        }
+      } else {
+        // nothing is known about the leg before so assume it takes no time at all
+        origin = options.locations(breaks[i]);
+        if (!origin.has_date_time() && !departure.empty() &&
+            options.date_time_type() != Options::invariant) {
+          origin.set_date_time(departure);
+        }
+      }
+      departure = origin.date_time();
+
+      // Remember where this leg ended up before it is computed again
+      auto& leg = legs[i];
+      has_arrival = leg.computed;
+      if (has_arrival) {
+        arrival = *leg.api.options().locations().rbegin();
+        arrival_departure = leg.departure;
+      }
+
+      // Only compute the legs whose origin changed
+      auto key = origin.SerializeAsString();
+      if (leg.computed && leg.origin == key) {
+        continue;
+      }
+      leg.api.Clear();
+      auto& request = *leg.api.mutable_options();
+      request = leg_options;
+      *request.add_locations() = std::move(origin);
+      for (int j = breaks[i] + 1; j <= breaks[i + 1]; ++j) {
+        *request.add_locations() = options.locations(j);
+      }
+      leg.origin = std::move(key);
+      leg.departure = departure;
+      leg.computed = false;
+      todo.push_back(i);
+    }
+    if (todo.empty()) {
+      return false;
+    }
+
+    // Past a few rounds the estimates are not getting any better, do the next leg on its own
+    if (round >= kMaxSpeculativeLegRounds) {
+      todo.resize(1);
+    }
+
+    // Compute the legs on this thread and as many helpers from the pool as are useful
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex error_lock;
+    std::function<void(thor_worker_t&)> compute = [&](thor_worker_t& worker) {
+      // helpers work on behalf of this request
+      if (&worker != this) {
+        worker.controller = controller;
+        worker.interrupt = interrupt;
+      }
+      for (size_t i = next++; i < todo.size() && !failed; i = next++) {
+        auto& leg = legs[todo[i]];
+        try {
+          worker.parse_costing(leg.api);
+          worker.path_depart_at(leg.api, costing, false);
+          leg.computed = true;
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(error_lock);
+          if (!error) {
+            error = std::current_exception();
+          }
+          failed = true;
+        }
+      }
+    };
+    if (!leg_pool) {
+      leg_pool.reset(new leg_pool_t(config, reader, leg_concurrency - 1));
+    }
+    leg_pool->run(compute, *this, std::min(leg_concurrency, todo.size()) - 1);
+
+    // The route is retried as a whole when a leg has no route, like path_depart_at would
+    if (error) {
+      try {
+        std::rethrow_exception(error);
+      } catch (const valhalla_exception_t& e) {
+        if (e.code == 442) {
+          return false;
+        }
+        throw;
+      }
+    }
+
+    // Keep every leg that was computed from the destination of the verified leg before it
+    for (; verified < legs.size() && legs[verified].computed; ++verified) {
+      if (verified > 0 &&
+          legs[verified].origin !=
+              legs[verified - 1].api.options().locations().rbegin()->SerializeAsString()) {
+        break;
+      }
+    }
+  }
+
+  // Splice the legs together, the breaks between them are the origins of the later leg since it
+  // has seen them last. Whatever the legs reported about themselves goes along with them
+  auto& locations = *api.mutable_options()->mutable_locations();
+  auto& info = *api.mutable_info();
+  auto& route = *api.mutable_trip()->mutable_routes()->Add();
+  route.mutable_legs()->Reserve(options.locations_size());
+  for (size_t i = 0; i < legs.size(); ++i) {
+    for (auto& leg : *legs[i].api.mutable_trip()->mutable_routes(0)->mutable_legs()) {
+      route.mutable_legs()->Add()->Swap(&leg);
+    }
+    const auto& leg_locations = legs[i].api.options().locations();
+    for (int j = 0; j < leg_locations.size(); ++j) {
+      *locations.Mutable(breaks[i] + j) = leg_locations.Get(j);
+    }
+    const auto& leg_info = legs[i].api.info();
+    info.mutable_statistics()->MergeFrom(leg_info.statistics());
+    if (leg_info.error()) {
+      info.set_error(true);
+    }
+  }
+  return true;
+}
+
 /**
  * offset a time in one timezone by some number of seconds to a time in another timezone
  *
@@ -1,5 +1,6 @@
 #include "thor/timedistancebssmatrix.h"
 #include "midgard/logging.h"
+#include "midgard/profiling.h"
 #include <algorithm>
 #include <vector>
 
@@ -449,6 +450,7 @@ std::vector<TimeDistance> TimeDistanceBSSMatrix::SourceToTarget(
     const sif::mode_costing_t& mode_costing,
     const sif::TravelMode _,
     const float max_matrix_distance) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kExpansion);
   // Run a series of one to many calls and concatenate the results.
   std::vector<TimeDistance> many_to_many;
   if (source_location_list.size() <= target_location_list.size()) {
@@ -1,5 +1,6 @@
 #include "thor/timedistancematrix.h"
 #include "midgard/logging.h"
+#include "midgard/profiling.h"
 #include <algorithm>
 #include <vector>
 
@@ -28,7 +29,8 @@ namespace thor {
 
 // Constructor with cost threshold.
 TimeDistanceMatrix::TimeDistanceMatrix()
-    : mode_(TravelMode::kDrive), settled_count_(0), current_cost_threshold_(0) {
+    : mode_(TravelMode::kDrive), settled_count_(0), current_cost_threshold_(0),
+      time_info_(TimeInfo::invalid()), invariant_(false) {
 }
 
 // Compute a cost threshold in seconds based on average speed for the travel mode.
@@ -52,6 +54,17 @@ float TimeDistanceMatrix::GetCostThreshold(const float max_matrix_distance) cons
   return max_matrix_distance / (average_speed_mph * kMPHtoMetersPerSec);
 }
 
+// Set the time at the location the search starts from. TimeInfo::make replaces
+// current with the actual time so it gets a copy of the location
+void TimeDistanceMatrix::SetTimeInfo(GraphReader& graphreader, const valhalla::Location& location) {
+  if (!location.has_date_time()) {
+    time_info_ = TimeInfo::invalid();
+    return;
+  }
+  valhalla::Location copy(location);
+  time_info_ = TimeInfo::make(copy, graphreader, &tz_cache_);
+}
+
 // Clear the temporary information generated during time + distance matrix
 // construction.
 void TimeDistanceMatrix::Clear() {
@@ -84,6 +97,11 @@ void TimeDistanceMatrix::ExpandForward(GraphReader& graphreader,
     return;
   }
 
+  // Update the time information even if time is invariant to account for timezones
+  auto seconds_offset = invariant_ ? 0.f : pred.cost().secs;
+  auto offset_time = time_info_.forward(seconds_offset, static_cast<int>(nodeinfo->timezone()));
+  const uint64_t localtime = offset_time.valid ? offset_time.local_time : 0;
+
   // Expand from end node.
   GraphId edgeid(node.tileid(), node.level(), nodeinfo->edge_index());
   EdgeStatusInfo* es = edgestatus_.GetPtr(edgeid, tile);
@@ -100,17 +118,20 @@ void TimeDistanceMatrix::ExpandForward(GraphReader& graphreader,
     uint8_t restriction_idx = -1;
     const bool is_dest = dest_edges_.find(edgeid) != dest_edges_.cend();
     if (es->set() == EdgeSet::kPermanent ||
-        !costing_->Allowed(directededge, is_dest, pred, tile, edgeid, 0, 0, restriction_idx) ||
-        costing_->Restricted(directededge, pred, edgelabels_, tile, edgeid, true)) {
+        !costing_->Allowed(directededge, is_dest, pred, tile, edgeid, localtime,
+                           offset_time.timezone_index, restriction_idx) ||
+        costing_->Restricted(directededge, pred, edgelabels_, tile, edgeid, true, nullptr,
+                             localtime, offset_time.timezone_index)) {
       continue;
     }
 
     // Get cost and update distance
     auto transition_cost = costing_->TransitionCost(directededge, nodeinfo, pred);
     uint8_t flow_sources;
-    Cost newcost = pred.cost() +
-                   costing_->EdgeCost(directededge, tile, kConstrainedFlowSecondOfDay, flow_sources) +
-                   transition_cost;
+    Cost newcost =
+        pred.cost() +
+        costing_->EdgeCost(directededge, tile, offset_time.second_of_week, flow_sources) +
+        transition_cost;
     uint32_t distance = pred.path_distance() + directededge->length();
 
     // Check if edge is temporarily labeled and this path has less cost. If
@@ -154,11 +175,13 @@ TimeDistanceMatrix::OneToMany(const valhalla::Location& origin,
                               GraphReader& graphreader,
                               const sif::mode_costing_t& mode_costing,
                               const TravelMode mode,
-                              const float max_matrix_distance) {
+                              const float max_matrix_distance,
+                              const bool invariant) {
   // Set the mode and costing
   mode_ = mode;
   costing_ = mode_costing[static_cast<uint32_t>(mode_)];
   current_cost_threshold_ = GetCostThreshold(max_matrix_distance);
+  invariant_ = invariant;
 
   // Construct adjacency list, edge status, and done set. Set bucket size and
   // cost range based on DynamicCost. Initialize A* heuristic with 0 cost
@@ -170,6 +193,7 @@ TimeDistanceMatrix::OneToMany(const valhalla::Location& origin,
 
   // Initialize the origin and destination locations
   settled_count_ = 0;
+  SetTimeInfo(graphreader, origin);
   SetOriginOneToMany(graphreader, origin);
   SetDestinations(graphreader, locations);
 
@@ -234,6 +258,11 @@ void TimeDistanceMatrix::ExpandReverse(GraphReader& graphreader,
     return;
   }
 
+  // Update the time information even if time is invariant to account for timezones
+  auto seconds_offset = invariant_ ? 0.f : pred.cost().secs;
+  auto offset_time = time_info_.reverse(seconds_offset, static_cast<int>(nodeinfo->timezone()));
+  const uint64_t localtime = offset_time.valid ? offset_time.local_time : 0;
+
   // Get the opposing predecessor directed edge
   const DirectedEdge* opp_pred_edge = tile->directededge(nodeinfo->edge_index());
   for (uint32_t i = 0; i < nodeinfo->edge_count(); i++, opp_pred_edge++) {
@@ -265,7 +294,8 @@ void TimeDistanceMatrix::ExpandReverse(GraphReader& graphreader,
     const DirectedEdge* opp_edge = t2->directededge(oppedge);
     uint8_t restriction_idx = -1;
     if (opp_edge == nullptr ||
-        !costing_->AllowedReverse(directededge, pred, opp_edge, t2, oppedge, 0, 0, restriction_idx)) {
+        !costing_->AllowedReverse(directededge, pred, opp_edge, t2, oppedge, localtime,
+                                  offset_time.timezone_index, restriction_idx)) {
       continue;
     }
 
@@ -276,7 +306,7 @@ void TimeDistanceMatrix::ExpandReverse(GraphReader& graphreader,
                                         pred.internal_turn());
     uint8_t flow_sources;
     Cost newcost = pred.cost() +
-                   costing_->EdgeCost(opp_edge, t2, kConstrainedFlowSecondOfDay, flow_sources) +
+                   costing_->EdgeCost(opp_edge, t2, offset_time.second_of_week, flow_sources) +
                    transition_cost;
     uint32_t distance = pred.path_distance() + directededge->length();
 
@@ -322,11 +352,13 @@ TimeDistanceMatrix::ManyToOne(const valhalla::Location& dest,
                               GraphReader& graphreader,
                               const sif::mode_costing_t& mode_costing,
                               const TravelMode mode,
-                              const float max_matrix_distance) {
+                              const float max_matrix_distance,
+                              const bool invariant) {
   // Set the mode and costing
   mode_ = mode;
   costing_ = mode_costing[static_cast<uint32_t>(mode_)];
   current_cost_threshold_ = GetCostThreshold(max_matrix_distance);
+  invariant_ = invariant;
 
   // Construct adjacency list, edge status, and done set. Set bucket size and
   // cost range based on DynamicCost. Initialize A* heuristic with 0 cost
@@ -338,6 +370,7 @@ TimeDistanceMatrix::ManyToOne(const valhalla::Location& dest,
 
   // Initialize the origin and destination locations
   settled_count_ = 0;
+  SetTimeInfo(graphreader, dest);
   SetOriginManyToOne(graphreader, dest);
   SetDestinationsManyToOne(graphreader, locations);
 
@@ -402,21 +435,39 @@ std::vector<TimeDistance> TimeDistanceMatrix::SourceToTarget(
     baldr::GraphReader& graphreader,
     const sif::mode_costing_t& mode_costing,
     const sif::TravelMode mode,
-    const float max_matrix_distance) {
+    const float max_matrix_distance,
+    const bool invariant) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kExpansion);
   // Run a series of one to many calls and concatenate the results.
+  // A time dependent search has to start where the time is known, otherwise expand from
+  // whichever side has fewer locations
+  auto has_date_time = [](const google::protobuf::RepeatedPtrField<valhalla::Location>& locations) {
+    return std::any_of(locations.begin(), locations.end(),
+                       [](const valhalla::Location& location) { return location.has_date_time(); });
+  };
+  bool forward = has_date_time(source_location_list) ||
+                 (!has_date_time(target_location_list) &&
+                  source_location_list.size() <= target_location_list.size());
+
   std::vector<TimeDistance> many_to_many;
-  if (source_location_list.size() <= target_location_list.size()) {
+  if (forward) {
     for (const auto& origin : source_location_list) {
       std::vector<TimeDistance> td = OneToMany(origin, target_location_list, graphreader,
-                                               mode_costing, mode, max_matrix_distance);
+                                               mode_costing, mode, max_matrix_distance, invariant);
       many_to_many.insert(many_to_many.end(), td.begin(), td.end());
       Clear();
     }
   } else {
-    for (const auto& destination : target_location_list) {
-      std::vector<TimeDistance> td = ManyToOne(destination, source_location_list, graphreader,
-                                               mode_costing, mode, max_matrix_distance);
-      many_to_many.insert(many_to_many.end(), td.begin(), td.end());
+    // Each many to one search fills in a column of the matrix
+    const size_t target_count = target_location_list.size();
+    many_to_many.resize(source_location_list.size() * target_count);
+    for (size_t target = 0; target < target_count; ++target) {
+      std::vector<TimeDistance> td =
+          ManyToOne(target_location_list.Get(target), source_location_list, graphreader,
+                    mode_costing, mode, max_matrix_distance, invariant);
+      for (size_t source = 0; source < td.size(); ++source) {
+        many_to_many[source * target_count + target] = td[source];
+      }
       Clear();
     }
   }
@@ -460,7 +511,7 @@ void TimeDistanceMatrix::SetOriginOneToMany(GraphReader& graphreader,
     // Get cost. Use this as sortcost since A* is not used for time+distance
     // matrix computations. . Get distance along the remainder of this edge.
     uint8_t flow_sources;
-    Cost cost = costing_->EdgeCost(directededge, tile, kConstrainedFlowSecondOfDay, flow_sources) *
+    Cost cost = costing_->EdgeCost(directededge, tile, time_info_.second_of_week, flow_sources) *
                 (1.0f - edge.percent_along());
     uint32_t d = static_cast<uint32_t>(directededge->length() * (1.0f - edge.percent_along()));
 
@@ -513,7 +564,7 @@ void TimeDistanceMatrix::SetOriginManyToOne(GraphReader& graphreader,
     // Get cost. Use this as sortcost since A* is not used for time
     // distance matrix computations. Get the distance along the edge.
     uint8_t flow_sources;
-    Cost cost = costing_->EdgeCost(opp_dir_edge, endtile, kConstrainedFlowSecondOfDay, flow_sources) *
+    Cost cost = costing_->EdgeCost(opp_dir_edge, endtile, time_info_.second_of_week, flow_sources) *
                 edge.percent_along();
     uint32_t d = static_cast<uint32_t>(directededge->length() * edge.percent_along());
 
@@ -3,6 +3,7 @@
 #include "baldr/graphconstants.h"
 #include "midgard/constants.h"
 #include "midgard/logging.h"
+#include "midgard/profiling.h"
 #include <algorithm>
 
 using namespace valhalla::baldr;
@@ -330,6 +331,7 @@ inline bool UnidirectionalAStar<expansion_direction, FORWARD>::ExpandInner(
 // Form the path from the adjacency list in the _forward_ direction
 template <>
 std::vector<PathInfo> UnidirectionalAStar<ExpansionType::forward>::FormPath(const uint32_t dest) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kPathFormation);
   // Metrics to track
   LOG_DEBUG("path_cost::" + std::to_string(edgelabels_[dest].cost().cost));
   LOG_DEBUG("path_iterations::" + std::to_string(edgelabels_.size()));
@@ -357,6 +359,7 @@ std::vector<PathInfo> UnidirectionalAStar<ExpansionType::forward>::FormPath(cons
 // Form the path from the adjacency list in the _reverse_ direction
 template <>
 std::vector<PathInfo> UnidirectionalAStar<ExpansionType::reverse>::FormPath(const uint32_t dest) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kPathFormation);
   // Metrics to track
   LOG_DEBUG("path_cost::" + std::to_string(edgelabels_[dest].cost().cost));
   LOG_DEBUG("path_iterations::" + std::to_string(edgelabels_.size()));
@@ -411,6 +414,7 @@ std::vector<std::vector<PathInfo>> UnidirectionalAStar<expansion_direction, FORW
     const sif::mode_costing_t& mode_costing,
     const TravelMode mode,
     const Options& /*options*/) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kExpansion);
   // Set the mode and costing
   mode_ = mode;
   costing_ = mode_costing[static_cast<uint32_t>(mode_)];
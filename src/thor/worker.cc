@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <sstream>
@@ -48,6 +49,41 @@ const std::unordered_map<std::string, float> kMaxDistances = {
 // a scale factor to apply to the score so that we bias towards closer results more
 constexpr float kDistanceScale = 10.f;
 
+// The landmarks for the A* heuristic are loaded once and shared by all the workers of the process
+std::shared_ptr<const Landmarks> get_landmarks(const boost::property_tree::ptree& config) {
+  static const auto landmarks = [&config]() -> std::shared_ptr<const Landmarks> {
+    auto landmark_file = config.get_optional<std::string>("mjolnir.landmark_file");
+    if (!landmark_file) {
+      return nullptr;
+    }
+    try {
+      return std::make_shared<const Landmarks>(Landmarks::Load(*landmark_file));
+    } catch (const std::exception& e) {
+      LOG_ERROR("Not using landmarks: " + std::string(e.what()));
+      return nullptr;
+    }
+  }();
+  return landmarks;
+}
+
+// The arc flags are loaded once and shared by all the workers of the process, pruning with them
+// has to be turned on
+std::shared_ptr<const ArcFlags> get_arc_flags(const boost::property_tree::ptree& config) {
+  static const auto arc_flags = [&config]() -> std::shared_ptr<const ArcFlags> {
+    auto arc_flags_file = config.get_optional<std::string>("mjolnir.arc_flags_file");
+    if (!config.get<bool>("thor.arc_flag_pruning", false) || !arc_flags_file) {
+      return nullptr;
+    }
+    try {
+      return std::make_shared<const ArcFlags>(ArcFlags::Load(*arc_flags_file));
+    } catch (const std::exception& e) {
+      LOG_ERROR("Not pruning with arc flags: " + std::string(e.what()));
+      return nullptr;
+    }
+  }();
+  return arc_flags;
+}
+
 #ifdef HAVE_HTTP
 std::string serialize_to_pbf(Api& request) {
   std::string buf;
@@ -68,13 +104,24 @@ thor_worker_t::thor_worker_t(const boost::property_tree::ptree& config,
                              const std::shared_ptr<baldr::GraphReader>& graph_reader)
     : service_worker_t(config), mode(valhalla::sif::TravelMode::kPedestrian),
       bidir_astar(config.get_child("thor")), bss_astar(config.get_child("thor")),
-      multi_modal_astar(config.get_child("thor")), timedep_forward(config.get_child("thor")),
-      timedep_reverse(config.get_child("thor")), isochrone_gen(config.get_child("thor")),
-      matcher_factory(config, graph_reader), reader(graph_reader), controller{} {
+      multi_modal_astar(config.get_child("thor")), raptor(config.get_child("thor")),
+      timedep_forward(config.get_child("thor")), timedep_reverse(config.get_child("thor")),
+      isochrone_gen(config.get_child("thor")), matcher_factory(config, graph_reader),
+      reader(graph_reader), controller{}, config(config),
+      leg_concurrency(config.get<size_t>("thor.leg_concurrency", 1)),
+      admission(admission_control_t::get_instance(config)) {
   // If we weren't provided with a graph reader make our own
   if (!reader)
     reader = matcher_factory.graphreader();
 
+  // The helpers computing legs concurrently share our graph reader so its cache has to be safe to
+  // use from several threads
+  if (leg_concurrency > 1 && !config.get<bool>("mjolnir.global_synchronized_cache", false)) {
+    LOG_WARN("thor.leg_concurrency needs mjolnir.global_synchronized_cache, computing legs one "
+             "after the other");
+    leg_concurrency = 1;
+  }
+
   // Select the matrix algorithm based on the conf file (defaults to
   // select_optimal if not present)
   auto conf_algorithm = config.get<std::string>("thor.source_to_target_algorithm", "select_optimal");
@@ -99,6 +146,16 @@ thor_worker_t::thor_worker_t(const boost::property_tree::ptree& config,
     source_to_target_algorithm = SELECT_OPTIMAL;
   }
 
+  // Select the transit algorithm, the multimodal astar unless raptor is asked for
+  raptor_transit = config.get<std::string>("thor.multimodal_algorithm", "multimodal") == "raptor";
+
+  // Let bidirectional a* jump across the cells of the overlay if there is a partition to use
+  bidir_astar.set_overlay(overlay_t::get_instance(config));
+  bidir_astar.set_landmarks(get_landmarks(config));
+  bidir_astar.set_arc_flags(get_arc_flags(config),
+                            config.get<float>("thor.arc_flags_target_radius",
+                                              kDefaultArcFlagsTargetRadius));
+
   max_timedep_distance =
       config.get<float>("service_limits.max_timedep_distance", kDefaultMaxTimeDependentDistance);
 
@@ -132,6 +189,10 @@ thor_worker_t::work(const std::list<zmq::message_t>& job,
     // Set the interrupt function
     service_worker_t::set_interrupt(&interrupt_function);
 
+    // wait for a slot to work on it, or get turned away if we are too busy
+    auto ticket = admission ? admission->admit(request, &interrupt_function)
+                            : admission_control_t::ticket_t{};
+
     // do request specific processing
     switch (options.action()) {
       case Options::sources_to_targets:
@@ -318,17 +379,17 @@ void thor_worker_t::parse_filter_attributes(const Api& request, bool is_strict_f
         if (is_strict_filter)
           controller.disable_all();
         for (const auto& filter_attribute : options.filter_attributes()) {
-          try {
-            controller.attributes.at(filter_attribute) = true;
-          } catch (...) { LOG_ERROR("Invalid filter attribute " + filter_attribute); }
+          if (!controller.set(filter_attribute, true)) {
+            LOG_ERROR("Invalid filter attribute " + filter_attribute);
+          }
         }
         break;
       }
       case (FilterAction::exclude): {
         for (const auto& filter_attribute : options.filter_attributes()) {
-          try {
-            controller.attributes.at(filter_attribute) = false;
-          } catch (...) { LOG_ERROR("Invalid filter attribute " + filter_attribute); }
+          if (!controller.set(filter_attribute, false)) {
+            LOG_ERROR("Invalid filter attribute " + filter_attribute);
+          }
         }
         break;
       }
@@ -342,6 +403,7 @@ void thor_worker_t::cleanup() {
   timedep_forward.Clear();
   timedep_reverse.Clear();
   multi_modal_astar.Clear();
+  raptor.Clear();
   bss_astar.Clear();
   trace.clear();
   isochrone_gen.Clear();
@@ -350,11 +412,84 @@ void thor_worker_t::cleanup() {
   if (reader->OverCommitted()) {
     reader->Trim();
   }
+  if (leg_pool) {
+    leg_pool->cleanup();
+  }
 }
 
 void thor_worker_t::set_interrupt(const std::function<void()>* interrupt_function) {
   interrupt = interrupt_function;
   reader->SetInterrupt(interrupt);
 }
+
+thor_worker_t::leg_pool_t::leg_pool_t(const boost::property_tree::ptree& config,
+                                      const std::shared_ptr<baldr::GraphReader>& reader,
+                                      size_t size)
+    : job(nullptr), job_count(0), job_number(0), running(0), stopping(false) {
+  workers.reserve(size);
+  threads.reserve(size);
+  for (size_t i = 0; i < size; ++i) {
+    workers.emplace_back(new thor_worker_t(config, reader));
+    threads.emplace_back(&leg_pool_t::serve, this, i);
+  }
+}
+
+thor_worker_t::leg_pool_t::~leg_pool_t() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  started.notify_all();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+void thor_worker_t::leg_pool_t::run(const std::function<void(thor_worker_t&)>& job,
+                                    thor_worker_t& caller,
+                                    size_t count) {
+  count = std::min(count, workers.size());
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->job = &job;
+    job_count = count;
+    running = count;
+    ++job_number;
+  }
+  started.notify_all();
+  job(caller);
+  std::unique_lock<std::mutex> lock(mutex);
+  finished.wait(lock, [this]() { return running == 0; });
+  this->job = nullptr;
+}
+
+void thor_worker_t::leg_pool_t::cleanup() {
+  for (auto& worker : workers) {
+    worker->cleanup();
+  }
+}
+
+void thor_worker_t::leg_pool_t::serve(size_t index) {
+  size_t seen = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    started.wait(lock, [this, seen]() { return stopping || job_number != seen; });
+    if (stopping) {
+      return;
+    }
+    seen = job_number;
+    if (index >= job_count) {
+      continue;
+    }
+    // run the job without holding the lock so the others can too
+    const auto* current = job;
+    lock.unlock();
+    (*current)(*workers[index]);
+    lock.lock();
+    if (--running == 0) {
+      finished.notify_one();
+    }
+  }
+}
 } // namespace thor
 } // namespace valhalla
@@ -1,4 +1,5 @@
 #include "tyr/actor.h"
+#include "tyr/response_cache.h"
 #include "baldr/rapidjson_utils.h"
 #include "loki/worker.h"
 #include "odin/worker.h"
@@ -16,13 +17,16 @@ namespace tyr {
 struct actor_t::pimpl_t {
   pimpl_t(const boost::property_tree::ptree& config)
       : reader(new baldr::GraphReader(config.get_child("mjolnir"))), loki_worker(config, reader),
-        thor_worker(config, reader), odin_worker(config) {
+        thor_worker(config, reader), odin_worker(config),
+        cache(tyr::response_cache_t::get_instance(config, *reader)) {
   }
   pimpl_t(const boost::property_tree::ptree& config, baldr::GraphReader& graph_reader)
       : reader(&graph_reader, [](baldr::GraphReader*) {}), loki_worker(config, reader),
-        thor_worker(config, reader), odin_worker(config) {
+        thor_worker(config, reader), odin_worker(config),
+        cache(tyr::response_cache_t::get_instance(config, *reader)) {
   }
   void set_interrupts(const std::function<void()>* interrupt_function) {
+    interrupt = interrupt_function;
     loki_worker.set_interrupt(interrupt_function);
     thor_worker.set_interrupt(interrupt_function);
     odin_worker.set_interrupt(interrupt_function);
@@ -32,10 +36,19 @@ struct actor_t::pimpl_t {
     thor_worker.cleanup();
     odin_worker.cleanup();
   }
+  std::string cached(const Api& request, const std::function<std::string()>& compute) {
+    if (!cache) {
+      return compute();
+    }
+    bool hit;
+    return cache->get(request, compute, hit, interrupt);
+  }
   std::shared_ptr<baldr::GraphReader> reader;
   loki::loki_worker_t loki_worker;
   thor::thor_worker_t thor_worker;
   odin_worker_t odin_worker;
+  std::shared_ptr<tyr::response_cache_t> cache;
+  const std::function<void()>* interrupt = nullptr;
 };
 
 actor_t::actor_t(const boost::property_tree::ptree& config, bool auto_cleanup)
@@ -58,12 +71,15 @@ actor_t::route(const std::string& request_str, const std::function<void()>* inte
   // parse the request
   Api request;
   ParseApi(request_str, Options::route, request);
-  // check the request and locate the locations in the graph
-  pimpl->loki_worker.route(request);
-  // route between the locations in the graph to find the best path
-  pimpl->thor_worker.route(request);
-  // get some directions back from them and serialize
-  auto bytes = pimpl->odin_worker.narrate(request);
+  // an identical request may already have been answered
+  auto bytes = pimpl->cached(request, [this, &request]() {
+    // check the request and locate the locations in the graph
+    pimpl->loki_worker.route(request);
+    // route between the locations in the graph to find the best path
+    pimpl->thor_worker.route(request);
+    // get some directions back from them and serialize
+    return pimpl->odin_worker.narrate(request);
+  });
   // if they want you do to do the cleanup automatically
   if (auto_cleanup) {
     cleanup();
@@ -102,10 +118,13 @@ actor_t::matrix(const std::string& request_str, const std::function<void()>* int
   // parse the request
   Api request;
   ParseApi(request_str, Options::sources_to_targets, request);
-  // check the request and locate the locations in the graph
-  pimpl->loki_worker.matrix(request);
-  // compute the matrix
-  auto json = pimpl->thor_worker.matrix(request);
+  // an identical request may already have been answered
+  auto json = pimpl->cached(request, [this, &request]() {
+    // check the request and locate the locations in the graph
+    pimpl->loki_worker.matrix(request);
+    // compute the matrix
+    return pimpl->thor_worker.matrix(request);
+  });
   // if they want you do to do the cleanup automatically
   if (auto_cleanup) {
     cleanup();
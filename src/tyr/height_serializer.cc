@@ -1,6 +1,7 @@
 #include <sstream>
 
 #include "baldr/json.h"
+#include "midgard/profiling.h"
 #include "skadi/sample.h"
 #include "tyr/serializers.h"
 
@@ -71,6 +72,7 @@ namespace tyr {
 std::string serializeHeight(const Api& request,
                             const std::vector<double>& heights,
                             const std::vector<double>& ranges) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kSerialization);
   auto json = json::map({});
 
   // get the precision to use for returned heights
@@ -2,6 +2,7 @@
 #include "baldr/json.h"
 #include "midgard/point2.h"
 #include "midgard/pointll.h"
+#include "midgard/profiling.h"
 #include "tyr/serializers.h"
 
 #include <cmath>
@@ -12,41 +13,84 @@ using namespace valhalla::baldr::json;
 
 namespace {
 using rgba_t = std::tuple<float, float, float>;
+
+// the supplied color of the interval or one spread over the hue range by its index
+std::string contour_color(const valhalla::midgard::GriddedData<2>::contour_interval_t& interval,
+                          size_t index,
+                          size_t count) {
+  // color was supplied
+  std::stringstream hex;
+  if (!std::get<3>(interval).empty()) {
+    hex << std::get<3>(interval);
+  } // or we computed it..
+  else {
+    auto h = index * (150.f / count);
+    auto c = .5f;
+    auto x = c * (1 - std::abs(std::fmod(h / 60.f, 2.f) - 1));
+    auto m = .25f;
+    rgba_t color = h < 60 ? rgba_t{m + c, m + x, m}
+                          : (h < 120 ? rgba_t{m + x, m + c, m} : rgba_t{m, m + c, m + x});
+    hex << std::hex << static_cast<int>(std::get<0>(color) * 255 + .5f) << std::hex
+        << static_cast<int>(std::get<1>(color) * 255 + .5f) << std::hex
+        << static_cast<int>(std::get<2>(color) * 255 + .5f);
+  }
+  return hex.str();
 }
 
+std::string
+serialize_pbf(valhalla::Api& request,
+              const std::vector<valhalla::midgard::GriddedData<2>::contour_interval_t>& intervals,
+              const valhalla::midgard::GriddedData<2>::contours_t& contours) {
+  auto& isochrone = *request.mutable_isochrone();
+  for (size_t contour_index = 0; contour_index < intervals.size(); ++contour_index) {
+    const auto& interval = intervals[contour_index];
+    auto color = contour_color(interval, contour_index, intervals.size());
+    for (const auto& feature : contours[contour_index]) {
+      auto* contour = isochrone.add_contours();
+      contour->set_metric(std::get<2>(interval));
+      contour->set_value(std::get<1>(interval));
+      contour->set_color(color);
+      // delta encode the coordinates in micro degrees, they are mostly tiny steps
+      for (const auto& line : feature) {
+        auto* coords = contour->add_geometries()->mutable_coords();
+        coords->Reserve(line.size() * 2);
+        int32_t lon = 0, lat = 0;
+        for (const auto& coord : line) {
+          int32_t x = std::round(coord.first * 1e6), y = std::round(coord.second * 1e6);
+          coords->Add(x - lon);
+          coords->Add(y - lat);
+          lon = x;
+          lat = y;
+        }
+      }
+    }
+  }
+  return valhalla::tyr::serializePbf(request);
+}
+} // namespace
+
 namespace valhalla {
 namespace tyr {
 
-std::string serializeIsochrones(const Api& request,
+std::string serializeIsochrones(Api& request,
                                 std::vector<midgard::GriddedData<2>::contour_interval_t>& intervals,
                                 midgard::GriddedData<2>::contours_t& contours,
                                 bool polygons,
                                 bool show_locations) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kSerialization);
+  assert(intervals.size() == contours.size());
+  // the locations, if they are wanted, are already in the options
+  if (request.options().format() == Options::pbf) {
+    return serialize_pbf(request, intervals, contours);
+  }
+
   // for each contour interval
-  int i = 0;
   auto features = array({});
-  assert(intervals.size() == contours.size());
   for (size_t contour_index = 0; contour_index < intervals.size(); ++contour_index) {
     const auto& interval = intervals[contour_index];
     const auto& feature_collection = contours[contour_index];
 
-    // color was supplied
-    std::stringstream hex;
-    if (!std::get<3>(interval).empty()) {
-      hex << "#" << std::get<3>(interval);
-    } // or we computed it..
-    else {
-      auto h = i * (150.f / intervals.size());
-      auto c = .5f;
-      auto x = c * (1 - std::abs(std::fmod(h / 60.f, 2.f) - 1));
-      auto m = .25f;
-      rgba_t color = h < 60 ? rgba_t{m + c, m + x, m}
-                            : (h < 120 ? rgba_t{m + x, m + c, m} : rgba_t{m, m + c, m + x});
-      hex << "#" << std::hex << static_cast<int>(std::get<0>(color) * 255 + .5f) << std::hex
-          << static_cast<int>(std::get<1>(color) * 255 + .5f) << std::hex
-          << static_cast<int>(std::get<2>(color) * 255 + .5f);
-    }
-    ++i;
+    auto hex = "#" + contour_color(interval, contour_index, intervals.size());
 
     // for each feature on that interval
     for (const auto& feature : feature_collection) {
@@ -76,9 +120,9 @@ std::string serializeIsochrones(const Api& request,
           {"properties", map({
                              {"metric", std::get<2>(interval)},
                              {"contour", baldr::json::float_t{std::get<1>(interval)}},
-                             {"color", hex.str()},               // lines
-                             {"fill", hex.str()},                // geojson.io polys
-                             {"fillColor", hex.str()},           // leaflet polys
+                             {"color", hex},                     // lines
+                             {"fill", hex},                      // geojson.io polys
+                             {"fillColor", hex},                 // leaflet polys
                              {"opacity", fixed_t{.33f, 2}},      // lines
                              {"fill-opacity", fixed_t{.33f, 2}}, // geojson.io polys
                              {"fillOpacity", fixed_t{.33f, 2}},  // leaflet polys
@@ -1,5 +1,6 @@
 #include "baldr/json.h"
 #include "baldr/openlr.h"
+#include "midgard/profiling.h"
 #include "tyr/serializers.h"
 #include <cstdint>
 
@@ -184,6 +185,7 @@ std::string serializeLocate(const Api& request,
                             const std::vector<baldr::Location>& locations,
                             const std::unordered_map<baldr::Location, PathLocation>& projections,
                             GraphReader& reader) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kSerialization);
   auto json = json::array({});
   for (const auto& location : locations) {
     try {
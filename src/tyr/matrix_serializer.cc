@@ -1,6 +1,8 @@
 #include <cstdint>
+#include <limits>
 
-#include "baldr/json.h"
+#include "baldr/rapidjson_utils.h"
+#include "midgard/profiling.h"
 #include "proto_conversions.h"
 #include "thor/costmatrix.h"
 #include "tyr/serializers.h"
@@ -12,63 +14,56 @@ using namespace valhalla::thor;
 
 namespace osrm_serializers {
 
-json::ArrayPtr
-serialize_duration(const std::vector<TimeDistance>& tds, size_t start_td, const size_t td_count) {
-  auto time = json::array({});
-  for (size_t i = start_td; i < start_td + td_count; ++i) {
-    // check to make sure a route was found; if not, return null for time in matrix result
-    if (tds[i].time != kMaxCost) {
-      time->emplace_back(static_cast<uint64_t>(tds[i].time));
-    } else {
-      time->emplace_back(static_cast<std::nullptr_t>(nullptr));
-    }
-  }
-  return time;
-}
-
-json::ArrayPtr serialize_distance(const std::vector<TimeDistance>& tds,
-                                  size_t start_td,
-                                  const size_t td_count,
-                                  const size_t /* source_index */,
-                                  const size_t /* target_index */,
-                                  double distance_scale) {
-  auto distance = json::array({});
-  for (size_t i = start_td; i < start_td + td_count; ++i) {
-    // check to make sure a route was found; if not, return null for distance in matrix result
-    if (tds[i].time != kMaxCost) {
-      distance->emplace_back(json::fixed_t{tds[i].dist * distance_scale, 3});
-    } else {
-      distance->emplace_back(static_cast<std::nullptr_t>(nullptr));
-    }
-  }
-  return distance;
-}
-
 // Serialize route response in OSRM compatible format.
-json::MapPtr serialize(const Api& request,
-                       const std::vector<TimeDistance>& time_distances,
-                       double distance_scale) {
-  auto json = json::map({});
-  auto time = json::array({});
-  auto distance = json::array({});
+void serialize(const Api& request,
+               const std::vector<TimeDistance>& time_distances,
+               double distance_scale,
+               rapidjson::writer_wrapper_t& writer) {
   const auto& options = request.options();
 
   // If here then the matrix succeeded. Set status code to OK and serialize
   // waypoints (locations).
-  json->emplace("code", std::string("Ok"));
-  json->emplace("sources", osrm::waypoints(options.sources()));
-  json->emplace("destinations", osrm::waypoints(options.targets()));
+  writer.start_object();
+  writer("code", "Ok");
+  writer.start_array("sources");
+  osrm::waypoints(options.sources(), writer);
+  writer.end_array();
+  writer.start_array("destinations");
+  osrm::waypoints(options.targets(), writer);
+  writer.end_array();
+
+  // check to make sure a route was found; if not, return null for time in matrix result
+  writer.start_array("durations");
+  for (size_t source_index = 0; source_index < options.sources_size(); ++source_index) {
+    writer.start_array();
+    for (size_t i = source_index * options.targets_size();
+         i < (source_index + 1) * options.targets_size(); ++i) {
+      if (time_distances[i].time != kMaxCost) {
+        writer(static_cast<uint64_t>(time_distances[i].time));
+      } else {
+        writer(std::nullptr_t());
+      }
+    }
+    writer.end_array();
+  }
+  writer.end_array();
 
+  // check to make sure a route was found; if not, return null for distance in matrix result
+  writer.start_array("distances");
   for (size_t source_index = 0; source_index < options.sources_size(); ++source_index) {
-    time->emplace_back(serialize_duration(time_distances, source_index * options.targets_size(),
-                                          options.targets_size()));
-    distance->emplace_back(serialize_distance(time_distances, source_index * options.targets_size(),
-                                              options.targets_size(), source_index, 0,
-                                              distance_scale));
+    writer.start_array();
+    for (size_t i = source_index * options.targets_size();
+         i < (source_index + 1) * options.targets_size(); ++i) {
+      if (time_distances[i].time != kMaxCost) {
+        writer(time_distances[i].dist * distance_scale, 3);
+      } else {
+        writer(std::nullptr_t());
+      }
+    }
+    writer.end_array();
   }
-  json->emplace("durations", time);
-  json->emplace("distances", distance);
-  return json;
+  writer.end_array();
+  writer.end_object();
 }
 } // namespace osrm_serializers
 
@@ -79,77 +74,112 @@ valhalla output looks like this:
 
 */
 
-json::ArrayPtr locations(const google::protobuf::RepeatedPtrField<valhalla::Location>& correlated) {
-  auto input_locs = json::array({});
-  for (size_t i = 0; i < correlated.size(); i++) {
-    input_locs->emplace_back(json::map({{"lat", json::fixed_t{correlated.Get(i).ll().lat(), 6}},
-                                        {"lon", json::fixed_t{correlated.Get(i).ll().lng(), 6}}}));
+void locations(const google::protobuf::RepeatedPtrField<valhalla::Location>& correlated,
+               rapidjson::writer_wrapper_t& writer) {
+  writer.start_array();
+  for (const auto& location : correlated) {
+    writer.start_object();
+    writer("lat", location.ll().lat(), 6);
+    writer("lon", location.ll().lng(), 6);
+    writer.end_object();
   }
-  return input_locs;
+  writer.end_array();
 }
 
-json::ArrayPtr serialize_row(const std::vector<TimeDistance>& tds,
-                             size_t start_td,
-                             const size_t td_count,
-                             const size_t source_index,
-                             const size_t target_index,
-                             double distance_scale) {
-  auto row = json::array({});
+void serialize_row(const std::vector<TimeDistance>& tds,
+                   size_t start_td,
+                   const size_t td_count,
+                   const size_t source_index,
+                   const size_t target_index,
+                   double distance_scale,
+                   rapidjson::writer_wrapper_t& writer) {
+  writer.start_array();
   for (size_t i = start_td; i < start_td + td_count; ++i) {
     // check to make sure a route was found; if not, return null for distance & time in matrix
     // result
+    writer.start_object();
+    writer("from_index", static_cast<uint64_t>(source_index));
+    writer("to_index", static_cast<uint64_t>(target_index + (i - start_td)));
     if (tds[i].time != kMaxCost) {
-      row->emplace_back(json::map({{"from_index", static_cast<uint64_t>(source_index)},
-                                   {"to_index", static_cast<uint64_t>(target_index + (i - start_td))},
-                                   {"time", static_cast<uint64_t>(tds[i].time)},
-                                   {"distance", json::fixed_t{tds[i].dist * distance_scale, 3}}}));
+      writer("time", static_cast<uint64_t>(tds[i].time));
+      writer("distance", tds[i].dist * distance_scale, 3);
     } else {
-      row->emplace_back(json::map({{"from_index", static_cast<uint64_t>(source_index)},
-                                   {"to_index", static_cast<uint64_t>(target_index + (i - start_td))},
-                                   {"time", static_cast<std::nullptr_t>(nullptr)},
-                                   {"distance", static_cast<std::nullptr_t>(nullptr)}}));
+      writer("time", std::nullptr_t());
+      writer("distance", std::nullptr_t());
     }
+    writer.end_object();
   }
-  return row;
+  writer.end_array();
 }
 
-json::MapPtr serialize(const Api& request,
-                       const std::vector<TimeDistance>& time_distances,
-                       double distance_scale) {
-  json::ArrayPtr matrix = json::array({});
+void serialize(const Api& request,
+               const std::vector<TimeDistance>& time_distances,
+               double distance_scale,
+               rapidjson::writer_wrapper_t& writer) {
   const auto& options = request.options();
+  writer.start_object();
+  writer.start_array("sources_to_targets");
   for (size_t source_index = 0; source_index < options.sources_size(); ++source_index) {
-    matrix->emplace_back(serialize_row(time_distances, source_index * options.targets_size(),
-                                       options.targets_size(), source_index, 0, distance_scale));
+    serialize_row(time_distances, source_index * options.targets_size(), options.targets_size(),
+                  source_index, 0, distance_scale, writer);
   }
-  auto json = json::map({
-      {"sources_to_targets", matrix},
-      {"units", Options_Units_Enum_Name(options.units())},
-  });
-  json->emplace("targets", json::array({locations(options.targets())}));
-  json->emplace("sources", json::array({locations(options.sources())}));
+  writer.end_array();
+  writer("units", Options_Units_Enum_Name(options.units()));
+
+  writer.start_array("targets");
+  locations(options.targets(), writer);
+  writer.end_array();
+  writer.start_array("sources");
+  locations(options.sources(), writer);
+  writer.end_array();
 
   if (options.has_id()) {
-    json->emplace("id", options.id());
+    writer("id", options.id());
   }
-  return json;
+  writer.end_object();
 }
 } // namespace valhalla_serializers
 
+namespace pbf_serializers {
+
+void serialize(Api& request,
+               const std::vector<TimeDistance>& time_distances,
+               double distance_scale) {
+  auto& matrix = *request.mutable_matrix();
+  matrix.mutable_times()->Reserve(time_distances.size());
+  matrix.mutable_distances()->Reserve(time_distances.size());
+  for (const auto& td : time_distances) {
+    if (td.time != kMaxCost) {
+      matrix.add_times(td.time);
+      matrix.add_distances(td.dist * distance_scale);
+    } else {
+      matrix.add_times(std::numeric_limits<uint32_t>::max());
+      matrix.add_distances(0);
+    }
+  }
+}
+} // namespace pbf_serializers
+
 namespace valhalla {
 namespace tyr {
 
-std::string serializeMatrix(const Api& request,
+std::string serializeMatrix(Api& request,
                             const std::vector<TimeDistance>& time_distances,
                             double distance_scale) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kSerialization);
+  if (request.options().format() == Options::pbf) {
+    pbf_serializers::serialize(request, time_distances, distance_scale);
+    return serializePbf(request);
+  }
 
-  auto json = request.options().format() == Options::osrm
-                  ? osrm_serializers::serialize(request, time_distances, distance_scale)
-                  : valhalla_serializers::serialize(request, time_distances, distance_scale);
-
-  std::stringstream ss;
-  ss << *json;
-  return ss.str();
+  // stream the json straight into one buffer sized for the whole matrix
+  rapidjson::writer_wrapper_t writer(4096 + time_distances.size() * 96);
+  if (request.options().format() == Options::osrm) {
+    osrm_serializers::serialize(request, time_distances, distance_scale, writer);
+  } else {
+    valhalla_serializers::serialize(request, time_distances, distance_scale, writer);
+  }
+  return writer.get_buffer();
 }
 
 } // namespace tyr
@@ -0,0 +1,199 @@
+#include "tyr/pipeline.h"
+#include "midgard/logging.h"
+#include "tyr/serializers.h"
+
+namespace valhalla {
+namespace tyr {
+
+pipeline_worker_t::pipeline_worker_t(const boost::property_tree::ptree& config,
+                                     const std::shared_ptr<baldr::GraphReader>& graph_reader)
+    : service_worker_t(config),
+      reader(graph_reader ? graph_reader
+                          : std::make_shared<baldr::GraphReader>(config.get_child("mjolnir"))),
+      loki_worker(config, reader), thor_worker(config, reader), odin_worker(config),
+      cache(response_cache_t::get_instance(config, *reader)),
+      admission(admission_control_t::get_instance(config)) {
+  // we answer for loki so we support exactly what it is configured to support
+  Options::Action action;
+  for (const auto& kv : config.get_child("loki.actions")) {
+    auto path = kv.second.get_value<std::string>();
+    if (!Options_Action_Enum_Parse(path, &action)) {
+      throw std::runtime_error("Action not supported " + path);
+    }
+    actions.insert(action);
+    action_str.append("'/" + path + "' ");
+  }
+  if (action_str.empty()) {
+    throw std::runtime_error("The config actions for Loki are incorrectly loaded");
+  }
+
+  // signal that the worker started successfully
+  started();
+}
+
+void pipeline_worker_t::cleanup() {
+  loki_worker.cleanup();
+  thor_worker.cleanup();
+  odin_worker.cleanup();
+}
+
+void pipeline_worker_t::set_interrupt(const std::function<void()>* interrupt_function) {
+  service_worker_t::set_interrupt(interrupt_function);
+  loki_worker.set_interrupt(interrupt_function);
+  thor_worker.set_interrupt(interrupt_function);
+  odin_worker.set_interrupt(interrupt_function);
+}
+
+std::string pipeline_worker_t::cached(Api& request,
+                                      const std::function<std::string()>& compute) {
+  if (!cache || !response_cache_t::cacheable(request.options().action())) {
+    return compute();
+  }
+
+  bool hit;
+  auto response = cache->get(request, compute, hit, interrupt);
+  const auto& action = Options_Action_Enum_Name(request.options().action());
+  auto* stat = request.mutable_info()->mutable_statistics()->Add();
+  stat->set_key(action + ".info." + service_name() + (hit ? ".cache_hit" : ".cache_miss"));
+  stat->set_value(1);
+  stat->set_type(count);
+  return response;
+}
+
+#ifdef HAVE_HTTP
+prime_server::worker_t::result_t
+pipeline_worker_t::work(const std::list<zmq::message_t>& job,
+                        void* request_info,
+                        const std::function<void()>& interrupt_function) {
+
+  // grab the request info and make sure to record any metrics before we are done
+  auto& info = *static_cast<prime_server::http_request_info_t*>(request_info);
+  LOG_INFO("Got Pipeline Request " + std::to_string(info.id));
+  Api request;
+  prime_server::worker_t::result_t result{false, {}, ""};
+  try {
+    // request parsing
+    auto http_request =
+        prime_server::http_request_t::from_string(static_cast<const char*>(job.front().data()),
+                                                  job.front().size());
+    ParseApi(http_request, request);
+    const auto& options = request.options();
+
+    // check there is a valid action
+    if (!options.has_action() || actions.find(options.action()) == actions.cend()) {
+      throw valhalla_exception_t{106, action_str};
+    }
+
+    // Set the interrupt function on every stage
+    set_interrupt(&interrupt_function);
+
+    // wait for a slot to work on it, or get turned away if we are too busy
+    auto ticket = admission ? admission->admit(request, &interrupt_function)
+                            : admission_control_t::ticket_t{};
+    // do request specific processing, the same hops the proxied pipeline would take
+    const bool as_gpx = options.format() == Options::gpx;
+    const auto& narrative_mime = as_gpx ? worker::GPX_MIME : worker::JSON_MIME;
+    switch (options.action()) {
+      case Options::route: {
+        auto response = cached(request, [this, &request]() {
+          loki_worker.route(request);
+          thor_worker.route(request);
+          return odin_worker.narrate(request);
+        });
+        result = to_response(response, info, request, narrative_mime, as_gpx);
+        break;
+      }
+      case Options::expansion:
+        loki_worker.route(request);
+        result = to_response(thor_worker.expansion(request), info, request);
+        break;
+      case Options::centroid:
+        loki_worker.route(request);
+        thor_worker.centroid(request);
+        result = to_response(odin_worker.narrate(request), info, request, narrative_mime, as_gpx);
+        break;
+      case Options::locate:
+        result = to_response(loki_worker.locate(request), info, request);
+        break;
+      case Options::sources_to_targets: {
+        auto response = cached(request, [this, &request]() {
+          loki_worker.matrix(request);
+          return thor_worker.matrix(request);
+        });
+        result = to_response(response, info, request);
+        break;
+      }
+      case Options::optimized_route:
+        loki_worker.matrix(request);
+        thor_worker.optimized_route(request);
+        result = to_response(odin_worker.narrate(request), info, request, narrative_mime, as_gpx);
+        break;
+      case Options::isochrone:
+        loki_worker.isochrones(request);
+        result = to_response(thor_worker.isochrones(request), info, request);
+        break;
+      case Options::trace_route:
+        loki_worker.trace(request);
+        thor_worker.trace_route(request);
+        result = to_response(odin_worker.narrate(request), info, request, narrative_mime, as_gpx);
+        break;
+      case Options::trace_attributes:
+        loki_worker.trace(request);
+        result = to_response(thor_worker.trace_attributes(request), info, request);
+        break;
+      case Options::height:
+        result = to_response(loki_worker.height(request), info, request);
+        break;
+      case Options::transit_available:
+        result = to_response(loki_worker.transit_available(request), info, request);
+        break;
+      case Options::status:
+        loki_worker.status(request);
+        thor_worker.status(request);
+        odin_worker.status(request);
+        result = to_response(tyr::serializeStatus(request), info, request);
+        break;
+      default:
+        // apparently you wanted something that we figured we'd support but havent written yet
+        throw valhalla_exception_t{107};
+    }
+  } catch (const valhalla_exception_t& e) {
+    LOG_WARN("400::" + std::string(e.what()) + " request_id=" + std::to_string(info.id));
+    result = jsonify_error(e, info, request);
+  } catch (const std::exception& e) {
+    LOG_ERROR("400::" + std::string(e.what()) + " request_id=" + std::to_string(info.id));
+    result = jsonify_error({199, std::string(e.what())}, info, request);
+  }
+
+  // everything goes straight back to the client so always keep track of the metrics
+  enqueue_statistics(request);
+
+  return result;
+}
+
+void run_service(const boost::property_tree::ptree& config) {
+  // gracefully shutdown when asked via SIGTERM
+  prime_server::quiesce(config.get<unsigned int>("httpd.service.drain_seconds", 28),
+                        config.get<unsigned int>("httpd.service.shutting_seconds", 1));
+
+  // gets requests from the http server
+  auto upstream_endpoint = config.get<std::string>("loki.service.proxy") + "_out";
+  // and always returns the finished response back to the server
+  auto loopback_endpoint = config.get<std::string>("httpd.service.loopback");
+  auto interrupt_endpoint = config.get<std::string>("httpd.service.interrupt");
+
+  // listen for requests
+  zmq::context_t context;
+  pipeline_worker_t pipeline_worker(config);
+  prime_server::worker_t worker(context, upstream_endpoint, "ipc:///dev/null", loopback_endpoint,
+                                interrupt_endpoint,
+                                std::bind(&pipeline_worker_t::work, std::ref(pipeline_worker),
+                                          std::placeholders::_1, std::placeholders::_2,
+                                          std::placeholders::_3),
+                                std::bind(&pipeline_worker_t::cleanup, std::ref(pipeline_worker)));
+  worker.work();
+}
+#endif
+
+} // namespace tyr
+} // namespace valhalla
@@ -0,0 +1,183 @@
+#include "tyr/response_cache.h"
+#include "filesystem.h"
+
+#include <algorithm>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+namespace {
+
+// how often requests waiting on someone elses computation check whether their client is still there
+constexpr auto kWaitSlice = std::chrono::milliseconds(50);
+
+uint64_t dataset_id(valhalla::baldr::GraphReader& reader) {
+  // every tile of a build carries the same dataset id so the first one we find will do
+  for (const auto& tile_id : reader.GetTileSet(0)) {
+    auto tile = reader.GetGraphTile(tile_id);
+    if (tile) {
+      return tile->header()->dataset_id();
+    }
+  }
+  return 0;
+}
+
+} // namespace
+
+namespace valhalla {
+namespace tyr {
+
+response_cache_t::response_cache_t(const boost::property_tree::ptree& config,
+                                   baldr::GraphReader& reader)
+    : max_bytes_(config.get<size_t>("tyr.response_cache.max_bytes", 0)),
+      ttl_(config.get<uint32_t>("tyr.response_cache.ttl_seconds", 30)),
+      max_wait_(config.get<uint32_t>("tyr.response_cache.max_wait_ms", 1000)),
+      traffic_epoch_seconds_(0), dataset_id_(dataset_id(reader)), bytes_(0) {
+  // live traffic changes underneath us so responses are only shared within the same epoch
+  auto traffic_extract = config.get<std::string>("mjolnir.traffic_extract", "");
+  if (!traffic_extract.empty() && filesystem::exists(traffic_extract)) {
+    traffic_epoch_seconds_ =
+        std::max(config.get<uint32_t>("tyr.response_cache.traffic_epoch_seconds", 60), 1u);
+  }
+}
+
+std::shared_ptr<response_cache_t>
+response_cache_t::get_instance(const boost::property_tree::ptree& config,
+                               baldr::GraphReader& reader) {
+  static std::shared_ptr<response_cache_t> cache(
+      config.get<size_t>("tyr.response_cache.max_bytes", 0) ? new response_cache_t(config, reader)
+                                                             : nullptr);
+  return cache;
+}
+
+bool response_cache_t::cacheable(Options::Action action) {
+  return action == Options::route || action == Options::sources_to_targets;
+}
+
+std::string response_cache_t::make_key(const Options& options) const {
+  // parsing the request already normalized things like whitespace, key order and the spelling of
+  // numbers, serializing deterministically makes sure equal options are equal bytes
+  std::string key;
+  {
+    google::protobuf::io::StringOutputStream stream(&key);
+    google::protobuf::io::CodedOutputStream coded(&stream);
+    coded.SetSerializationDeterministic(true);
+    options.SerializeToCodedStream(&coded);
+  }
+
+  // a different set of tiles or traffic can give a different answer
+  uint64_t epoch = 0;
+  if (traffic_epoch_seconds_) {
+    epoch = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count() /
+            traffic_epoch_seconds_;
+  }
+  key.append(reinterpret_cast<const char*>(&dataset_id_), sizeof(dataset_id_));
+  key.append(reinterpret_cast<const char*>(&epoch), sizeof(epoch));
+  return key;
+}
+
+std::string response_cache_t::get(const Api& request,
+                                  const std::function<std::string()>& compute,
+                                  bool& hit,
+                                  const std::function<void()>* interrupt) {
+  auto key = make_key(request.options());
+  auto now = std::chrono::steady_clock::now();
+
+  // see if someone has already computed or is computing it
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto found = entries_.find(key);
+  if (found != entries_.end() && found->second.ready && found->second.expires <= now) {
+    bytes_ -= found->second.bytes;
+    recency_.erase(found->second.position);
+    entries_.erase(found);
+    found = entries_.end();
+  }
+  if (found != entries_.end()) {
+    recency_.splice(recency_.begin(), recency_, found->second.position);
+    auto response = found->second.response;
+    lock.unlock();
+    // we only wait so long for someone else and stop waiting as soon as our own client goes away
+    auto start = std::chrono::steady_clock::now();
+    while (response.wait_for(kWaitSlice) != std::future_status::ready) {
+      if (interrupt) {
+        (*interrupt)();
+      }
+      if (max_wait_.count() && std::chrono::steady_clock::now() - start > max_wait_) {
+        hit = false;
+        return compute();
+      }
+    }
+    try {
+      auto result = response.get();
+      hit = true;
+      return result;
+    } catch (...) {
+      // whoever was computing it failed, maybe just because their client went away, so we try
+      // ourselves and let our own exceptions propagate
+      hit = false;
+      return compute();
+    }
+  }
+
+  // its on us to compute it, anyone who shows up in the meantime will wait on the promise
+  hit = false;
+  std::promise<std::string> promise;
+  recency_.push_front(key);
+  auto& entry = entries_[key];
+  entry.response = promise.get_future().share();
+  entry.bytes = key.size();
+  entry.ready = false;
+  entry.position = recency_.begin();
+  bytes_ += entry.bytes;
+  lock.unlock();
+
+  std::string response;
+  try {
+    response = compute();
+  } catch (...) {
+    lock.lock();
+    auto failed = entries_.find(key);
+    bytes_ -= failed->second.bytes;
+    recency_.erase(failed->second.position);
+    entries_.erase(failed);
+    lock.unlock();
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+
+  // publish it and make room for it
+  lock.lock();
+  promise.set_value(response);
+  auto computed = entries_.find(key);
+  computed->second.ready = true;
+  computed->second.expires = std::chrono::steady_clock::now() + ttl_;
+  computed->second.bytes += response.size();
+  bytes_ += response.size();
+  evict();
+  return response;
+}
+
+size_t response_cache_t::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+void response_cache_t::evict() {
+  // drop the least recently used finished responses, in flight ones are only a key in size
+  auto position = recency_.end();
+  while (bytes_ > max_bytes_ && position != recency_.begin()) {
+    --position;
+    auto entry = entries_.find(*position);
+    if (!entry->second.ready) {
+      continue;
+    }
+    bytes_ -= entry->second.bytes;
+    position = recency_.erase(position);
+    entries_.erase(entry);
+  }
+}
+
+} // namespace tyr
+} // namespace valhalla
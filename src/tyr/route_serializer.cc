@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "midgard/encoded.h"
+#include "midgard/profiling.h"
 #include "midgard/util.h"
 #include "route_serializer_osrm.cc"
 #include "route_serializer_valhalla.cc"
@@ -76,6 +77,7 @@ namespace valhalla {
 namespace tyr {
 
 std::string serializeDirections(Api& request) {
+  midgard::profiling::ScopedTimer timer(midgard::profiling::Stage::kSerialization);
   // serialize them
   switch (request.options().format()) {
     case Options_Format_osrm:
@@ -84,6 +86,8 @@ std::string serializeDirections(Api& request) {
       return pathToGPX(request.trip().routes(0).legs());
     case Options_Format_json:
       return valhalla_serializers::serialize(request);
+    case Options_Format_pbf:
+      return serializePbf(request);
     default:
       throw;
   }
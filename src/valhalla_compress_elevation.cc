@@ -0,0 +1,95 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "config.h"
+#include "filesystem.h"
+#include "midgard/logging.h"
+#include "skadi/sample.h"
+
+namespace bpo = boost::program_options;
+
+int main(int argc, char** argv) {
+  std::string output_dir;
+  std::vector<std::string> input_files;
+
+  bpo::options_description options(
+      "valhalla_compress_elevation " VALHALLA_VERSION "\n"
+      "\n"
+      " Usage: valhalla_compress_elevation [options] <hgt_file>...\n"
+      "\n"
+      "Converts raw (.hgt) or gzipped (.hgt.gz) elevation tiles to the seekable block compressed "
+      "(.hgt.blk) format. Tiles are written to the output directory using the same layout "
+      "sample expects, ie output_dir/N40/N40W077.hgt.blk"
+      "\n"
+      "\n");
+
+  auto adder = options.add_options();
+  adder("help,h", "Print this help message.");
+  adder("version,v", "Print the version of this software.");
+  adder("output-dir,o", bpo::value<std::string>(&output_dir),
+        "Directory in which to write the block compressed tiles.");
+  adder("input-files", bpo::value<std::vector<std::string>>(&input_files)->multitoken(),
+        "Raw or gzipped elevation tiles to convert.");
+
+  bpo::positional_options_description pos_options;
+  pos_options.add("input-files", -1);
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::command_line_parser(argc, argv).options(options).positional(pos_options).run(),
+               vm);
+    bpo::notify(vm);
+  } catch (std::exception& e) {
+    std::cerr << "Unable to parse command line options because: " << e.what() << "\n"
+              << "This is a bug, please report it at " PACKAGE_BUGREPORT << "\n";
+    return EXIT_FAILURE;
+  }
+
+  if (vm.count("help")) {
+    std::cout << options << "\n";
+    return EXIT_SUCCESS;
+  }
+
+  if (vm.count("version")) {
+    std::cout << "valhalla_compress_elevation " << VALHALLA_VERSION << "\n";
+    return EXIT_SUCCESS;
+  }
+
+  if (output_dir.empty() || input_files.empty()) {
+    std::cerr << "You must provide an output directory and at least one elevation tile\n\n"
+              << options << "\n\n";
+    return EXIT_FAILURE;
+  }
+
+  size_t failed = 0;
+  std::vector<int16_t> pixels;
+  for (const auto& input_file : input_files) {
+    // N40W077.hgt.gz becomes output_dir/N40/N40W077.hgt.blk
+    auto name = filesystem::path(input_file).filename().string();
+    if (name.size() > 3 && name.compare(name.size() - 3, 3, ".gz") == 0) {
+      name.resize(name.size() - 3);
+    }
+    filesystem::path dir(output_dir);
+    dir /= name.substr(0, 3);
+    auto output_file = dir;
+    output_file /= name + ".blk";
+
+    if (!valhalla::skadi::sample::load_tile(input_file, pixels)) {
+      LOG_ERROR("Could not read elevation tile " + input_file);
+      ++failed;
+      continue;
+    }
+    filesystem::create_directories(dir);
+    if (!valhalla::skadi::sample::store_blocks(output_file.string(), pixels)) {
+      LOG_ERROR("Could not write elevation tile " + output_file.string());
+      ++failed;
+      continue;
+    }
+    LOG_INFO("Wrote " + output_file.string());
+  }
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
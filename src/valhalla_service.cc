@@ -26,6 +26,7 @@ using namespace prime_server;
 #include "odin/worker.h"
 #include "thor/worker.h"
 #include "tyr/actor.h"
+#include "tyr/pipeline.h"
 
 int main(int argc, char** argv) {
 #ifdef HAVE_HTTP
@@ -176,6 +177,8 @@ int main(int argc, char** argv) {
   if (argc > 2) {
     worker_concurrency = std::stoul(argv[2]);
   }
+  // admission control keeps waiting requests from blocking all of them
+  config.put("httpd.service.worker_concurrency", worker_concurrency);
 
   // setup the cluster within this process
   zmq::context_t context;
@@ -183,10 +186,23 @@ int main(int argc, char** argv) {
       std::thread(std::bind(&http_server_t::serve, http_server_t(context, listen, loki_proxy + "_in",
                                                                  loopback, interrupt, true)));
 
-  // loki layer
+  // every request enters through the loki proxy
   std::thread loki_proxy_thread(
       std::bind(&proxy_t::forward, proxy_t(context, loki_proxy + "_in", loki_proxy + "_out")));
   loki_proxy_thread.detach();
+
+  // single node deployments can skip the hops between stages and run them all in each worker
+  if (config.get<bool>("httpd.service.in_process", false)) {
+    std::list<std::thread> pipeline_worker_threads;
+    for (size_t i = 0; i < worker_concurrency; ++i) {
+      pipeline_worker_threads.emplace_back(valhalla::tyr::run_service, config);
+      pipeline_worker_threads.back().detach();
+    }
+    server_thread.join();
+    return 0;
+  }
+
+  // loki layer
   std::list<std::thread> loki_worker_threads;
   for (size_t i = 0; i < worker_concurrency; ++i) {
     loki_worker_threads.emplace_back(valhalla::loki::run_service, config);
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <iostream>
+#include <random>
 #include <sstream>
 #include <typeinfo>
 #include <unordered_map>
@@ -9,6 +11,7 @@
 #include "loki/worker.h"
 #include "midgard/encoded.h"
 #include "midgard/logging.h"
+#include "midgard/profiling.h"
 #include "midgard/util.h"
 #include "odin/util.h"
 #include "odin/worker.h"
@@ -17,6 +20,7 @@
 #include "thor/worker.h"
 #include "worker.h"
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <cpp-statsd-client/StatsdClient.hpp>
 
@@ -41,6 +45,7 @@ constexpr const char* OSRM_INVALID_VALUE = R"({"code":"InvalidValue","message":"
 constexpr const char* OSRM_NO_ROUTE = R"({"code":"NoRoute","message":"Impossible route between points"})";
 constexpr const char* OSRM_NO_SEGMENT = R"({"code":"NoSegment","message":"One of the supplied input coordinates could not snap to street segment."})";
 constexpr const char* OSRM_SHUTDOWN = R"({"code":"ServiceUnavailable","message":"The service is shutting down."})";
+constexpr const char* OSRM_OVERLOADED = R"({"code":"ServiceUnavailable","message":"The service is overloaded."})";
 constexpr const char* OSRM_SERVER_ERROR = R"({"code":"InvalidUrl","message":"Failed to serialize route."})";
 constexpr const char* OSRM_DISTANCE_EXCEEDED = R"({"code":"DistanceExceeded","message":"Path distance exceeds the max distance limit."})";
 constexpr const char* OSRM_PERIMETER_EXCEEDED = R"({"code":"PerimeterExceeded","message":"Perimeter of avoid polygons exceeds the max limit."})";
@@ -51,6 +56,7 @@ const std::unordered_map<unsigned, valhalla::valhalla_exception_t> error_codes{
     {100, {100, "Failed to parse json request", 400, HTTP_400, OSRM_INVALID_URL, "json_parse_failed"}},
     {101, {101, "Try a POST or GET request instead", 405, HTTP_405, OSRM_INVALID_URL, "wrong_http_method"}},
     {102, {102, "The service is shutting down", 503, HTTP_503, OSRM_SHUTDOWN, "shutting_down"}},
+    {103, {103, "The service is overloaded, try again later", 503, HTTP_503, OSRM_OVERLOADED, "overloaded"}},
     {106, {106, "Try any of", 404, HTTP_404, OSRM_INVALID_SERVICE, "wrong_action"}},
     {107, {107, "Not Implemented", 501, HTTP_501, OSRM_INVALID_SERVICE, "empty_action"}},
     {110, {110, "Insufficiently specified required parameter 'locations'", 400, HTTP_400, OSRM_INVALID_OPTIONS, "locations_parse_failed"}},
@@ -78,6 +84,7 @@ const std::unordered_map<unsigned, valhalla::valhalla_exception_t> error_codes{
     {141, {141, "Arrive by for multimodal not implemented yet", 501, HTTP_501, OSRM_INVALID_VALUE, "no_arrive_by_multimodal"}},
     {142, {142, "Arrive by not implemented for isochrones", 501, HTTP_501, OSRM_INVALID_VALUE, "no_arrive_by_isochrones"}},
     {143, {143, "ignore_closures in costing and exclude_closures in search_filter cannot both be specified", 400, HTTP_400, OSRM_INVALID_VALUE, "closures_conflict"}},
+    {144, {144, "Action does not support the pbf format", 400, HTTP_400, OSRM_INVALID_VALUE, "no_pbf"}},
     {150, {150, "Exceeded max locations", 400, HTTP_400, OSRM_INVALID_VALUE, "too_many_locations"}},
     {151, {151, "Exceeded max time", 400, HTTP_400, OSRM_INVALID_VALUE, "too_large_time"}},
     {152, {152, "Exceeded max contours", 400, HTTP_400, OSRM_INVALID_VALUE, "too_many_contours"}},
@@ -150,7 +157,31 @@ rapidjson::Document from_string(const std::string& json, const valhalla_exceptio
 }
 
 void add_date_to_locations(Options& options,
-                           google::protobuf::RepeatedPtrField<valhalla::Location>& locations) {
+                           google::protobuf::RepeatedPtrField<valhalla::Location>& locations,
+                           const std::string& node) {
+  // a matrix departs from every source or arrives at every target at the same time
+  if (options.has_date_time() && (node == "sources" || node == "targets")) {
+    bool sources = node == "sources";
+    switch (options.date_time_type()) {
+      case Options::current:
+      case Options::depart_at:
+        if (!sources)
+          return;
+        break;
+      case Options::arrive_by:
+        if (sources)
+          return;
+        break;
+      case Options::invariant:
+        break;
+      default:
+        return;
+    }
+    for (auto& loc : locations)
+      loc.set_date_time(options.date_time());
+    return;
+  }
+
   // otherwise we do what the person was asking for
   if (options.has_date_time() && !locations.empty()) {
     switch (options.date_time_type()) {
@@ -194,6 +225,39 @@ void parse_ring(ring_pbf_t& ring, const rapidjson::Value& coord_array) {
   }
 }
 
+// Defaults which apply to a list of locations however the request was parsed
+void finish_locations(Options& options,
+                      google::protobuf::RepeatedPtrField<valhalla::Location>& locations,
+                      const std::string& node,
+                      bool had_date_time) {
+  if (locations.empty()) {
+    return;
+  }
+
+  // first and last locations get the default type of break no matter what
+  locations.Mutable(0)->set_type(valhalla::Location::kBreak);
+  locations.Mutable(locations.size() - 1)->set_type(valhalla::Location::kBreak);
+
+  // push the date time information down into the locations
+  if (!had_date_time) {
+    add_date_to_locations(options, locations, node);
+  }
+
+  // If any of the locations had search_filter.exclude_closures set to false,
+  // we tell the costing to let all closed roads through, so that we can do
+  // a secondary per-location filtering using loki's search_filter
+  // functionality
+  bool exclude_closures_disabled =
+      std::any_of(locations.cbegin(), locations.cend(), [](const valhalla::Location& location) {
+        return !location.search_filter().exclude_closures();
+      });
+  if (exclude_closures_disabled) {
+    for (auto& costing : *options.mutable_costing_options()) {
+      costing.set_filter_closures(false);
+    }
+  }
+}
+
 void parse_locations(const rapidjson::Document& doc,
                      Options& options,
                      const std::string& node,
@@ -218,7 +282,6 @@ void parse_locations(const rapidjson::Document& doc,
   }
 
   bool had_date_time = false;
-  bool exclude_closures_disabled = false;
   auto request_locations =
       rapidjson::get_optional<rapidjson::Value::ConstArray>(doc, std::string("/" + node).c_str());
   if (request_locations) {
@@ -401,11 +464,6 @@ void parse_locations(const rapidjson::Document& doc,
         // NOTE: that ignore_closures takes precedence
         location->mutable_search_filter()->set_exclude_closures(
             ignore_closures ? !(*ignore_closures) : exclude_closures ? *exclude_closures : true);
-        // set exclude_closures_disabled if any of the locations has the
-        // search_filter.exclude_closures set as false
-        if (!location->search_filter().exclude_closures()) {
-          exclude_closures_disabled = true;
-        }
       }
       // Forward valhalla_exception_t types as-is, since they contain a more
       // specific error message
@@ -414,26 +472,7 @@ void parse_locations(const rapidjson::Document& doc,
       } catch (...) { throw valhalla_exception_t{location_parse_error_code}; }
     }
 
-    // first and last locations get the default type of break no matter what
-    if (locations->size()) {
-      locations->Mutable(0)->set_type(valhalla::Location::kBreak);
-      locations->Mutable(locations->size() - 1)->set_type(valhalla::Location::kBreak);
-    }
-
-    // push the date time information down into the locations
-    if (!had_date_time) {
-      add_date_to_locations(options, *locations);
-    }
-
-    // If any of the locations had search_filter.exclude_closures set to false,
-    // we tell the costing to let all closed roads through, so that we can do
-    // a secondary per-location filtering using loki's search_filter
-    // functionality
-    if (exclude_closures_disabled) {
-      for (auto& costing : *options.mutable_costing_options()) {
-        costing.set_filter_closures(false);
-      }
-    }
+    finish_locations(options, *locations, node, had_date_time);
   }
 }
 
@@ -448,12 +487,7 @@ void parse_contours(const rapidjson::Document& doc,
       auto t = rapidjson::get_optional<float>(json_contour, "/time");
       auto d = rapidjson::get_optional<float>(json_contour, "/distance");
 
-      // You need at least something
-      if (!t && !d) {
-        throw valhalla_exception_t{111};
-      }
-
-      // Set contour time/distance
+      // Set contour time/distance, check_options makes sure there is at least one of them
       auto* contour = contours->Add();
       if (t) {
         contour->set_time(*t);
@@ -471,6 +505,150 @@ void parse_contours(const rapidjson::Document& doc,
   }
 }
 
+// actions whose results can be returned as a serialized Api
+bool supports_pbf(Options::Action action) {
+  switch (action) {
+    case Options::route:
+    case Options::optimized_route:
+    case Options::trace_route:
+    case Options::sources_to_targets:
+    case Options::isochrone:
+    case Options::trace_attributes:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// checks that the date_time goes with its type and the rest of the request, a transit request
+// without one leaves now
+void check_date_time(Options& options) {
+  if (options.has_date_time_type()) {
+    // check the value exists for depart at and arrive by
+    if (options.date_time_type() == Options::current) {
+      options.set_date_time("current");
+    } else if (!options.has_date_time()) {
+      if (options.date_time_type() == Options::depart_at)
+        throw valhalla_exception_t{160};
+      else if (options.date_time_type() == Options::arrive_by)
+        throw valhalla_exception_t{161};
+      else if (options.date_time_type() == Options::invariant)
+        throw valhalla_exception_t{165};
+    }
+    // check the value is sane
+    if (options.date_time() != "current" && !baldr::DateTime::is_iso_valid(options.date_time()))
+      throw valhalla_exception_t{162};
+  } // not specified but you want transit, then we default to current
+  else if (options.has_costing() &&
+           (options.costing() == multimodal || options.costing() == transit)) {
+    options.set_date_time_type(Options::current);
+    options.set_date_time("current");
+  }
+
+  // failure scenarios with respect to time dependence
+  if (options.has_date_time_type()) {
+    if (options.date_time_type() == Options::arrive_by ||
+        options.date_time_type() == Options::invariant) {
+      if (options.costing() == multimodal || options.costing() == transit)
+        throw valhalla_exception_t{141};
+      if (options.action() == Options::isochrone)
+        throw valhalla_exception_t{142};
+    }
+  }
+}
+
+// turns the encoded_polyline into the shape
+void decode_shape(Options& options) {
+  // Set the precision to use when decoding the polyline. For height actions (only)
+  // either polyline6 (default) or polyline5 are supported. All other actions only
+  // support polyline6 inputs at this time.
+  double precision = 1e-6;
+  if (options.action() == Options::height) {
+    precision = options.shape_format() == valhalla::polyline5 ? 1e-5 : 1e-6;
+  }
+
+  auto decoded =
+      midgard::decode<std::vector<midgard::PointLL>>(options.encoded_polyline(), precision);
+  for (const auto& ll : decoded) {
+    auto* sll = options.mutable_shape()->Add();
+    sll->mutable_ll()->set_lat(ll.lat());
+    sll->mutable_ll()->set_lng(ll.lng());
+    // set type to via by default
+    sll->set_type(valhalla::Location::kVia);
+  }
+  // first and last always get type break
+  if (options.shape_size()) {
+    options.mutable_shape(0)->set_type(valhalla::Location::kBreak);
+    options.mutable_shape(options.shape_size() - 1)->set_type(valhalla::Location::kBreak);
+  }
+  // add the date time
+  add_date_to_locations(options, *options.mutable_shape(), "shape");
+}
+
+// Throw an error if use_timestamps is set to true but there are no timestamps in the
+// trace (or no durations present)
+void check_timestamps(const Options& options) {
+  if (options.use_timestamps()) {
+    bool has_time = false;
+    for (const auto& s : options.shape()) {
+      if (s.has_time()) {
+        has_time = true;
+        break;
+      }
+    }
+    if (!has_time) {
+      throw valhalla_exception_t{159};
+    }
+  }
+}
+
+// if not a time dependent route/mapmatch disable time dependent edge speed/flow data sources
+void disable_time_dependent_flows(Options& options) {
+  if (!options.has_date_time_type() && (options.shape_size() == 0 || options.shape(0).time() == -1)) {
+    for (auto& costing : *options.mutable_costing_options()) {
+      costing.set_flow_mask(
+          static_cast<uint8_t>(costing.flow_mask()) &
+          ~(valhalla::baldr::kPredictedFlowMask | valhalla::baldr::kCurrentFlowMask));
+    }
+  }
+}
+
+// Checks and defaults of the parsed options which don't depend on how they were parsed
+void check_options(Options& options) {
+  // unsupported languages fall back to the default one
+  if (odin::get_locales().find(options.language()) == odin::get_locales().end()) {
+    options.clear_language();
+  }
+
+  // recostings are found by their names
+  for (const auto& recosting : options.recostings()) {
+    if (!recosting.has_name()) {
+      throw valhalla_exception_t{127};
+    }
+  }
+
+  // Elevation service options
+  constexpr uint32_t MAX_HEIGHT_PRECISION = 2;
+  if (options.height_precision() > MAX_HEIGHT_PRECISION) {
+    options.clear_height_precision();
+  }
+
+  // make sure the isoline definitions are valid, you need at least something
+  for (const auto& contour : options.contours()) {
+    if (!contour.has_time() && !contour.has_distance()) {
+      throw valhalla_exception_t{111};
+    }
+  }
+  if (options.has_denoise()) {
+    options.set_denoise(std::max(std::min(options.denoise(), 1.f), 0.f));
+  }
+
+  // no alternates for multi point routes
+  if (options.locations_size() > 2) {
+    options.set_alternates(0);
+  }
+}
+
 void from_json(rapidjson::Document& doc, Options& options) {
   // TODO: stop doing this after a sufficient amount of time has passed
   // move anything nested in deprecated directions_options up to the top level
@@ -492,6 +670,9 @@ void from_json(rapidjson::Document& doc, Options& options) {
   if (fmt && Options_Format_Enum_Parse(*fmt, &format)) {
     options.set_format(format);
   }
+  if (options.format() == Options::pbf && !supports_pbf(options.action())) {
+    throw valhalla_exception_t{144, "'" + Options_Action_Enum_Name(options.action()) + "'"};
+  }
 
   auto id = rapidjson::get_optional<std::string>(doc, "/id");
   if (id) {
@@ -513,7 +694,7 @@ void from_json(rapidjson::Document& doc, Options& options) {
   }
 
   auto language = rapidjson::get_optional<std::string>(doc, "/language");
-  if (language && odin::get_locales().find(*language) != odin::get_locales().end()) {
+  if (language) {
     options.set_language(*language);
   }
 
@@ -537,39 +718,12 @@ void from_json(rapidjson::Document& doc, Options& options) {
     if (v >= Options::DateTimeType_ARRAYSIZE)
       throw valhalla_exception_t{163};
     options.set_date_time_type(static_cast<Options::DateTimeType>(v));
-    // check the value exists for depart at and arrive by
-    auto date_time_value = v != Options::current
-                               ? rapidjson::get_optional<std::string>(doc, "/date_time/value")
-                               : std::string("current");
-    if (!date_time_value) {
-      if (v == Options::depart_at)
-        throw valhalla_exception_t{160};
-      else if (v == Options::arrive_by)
-        throw valhalla_exception_t{161};
-      else if (v == Options::invariant)
-        throw valhalla_exception_t{165};
-    }
-    // check the value is sane
-    if (*date_time_value != "current" && !baldr::DateTime::is_iso_valid(*date_time_value))
-      throw valhalla_exception_t{162};
-    options.set_date_time(*date_time_value);
-  } // not specified but you want transit, then we default to current
-  else if (options.has_costing() &&
-           (options.costing() == multimodal || options.costing() == transit)) {
-    options.set_date_time_type(Options::current);
-    options.set_date_time("current");
-  }
-
-  // failure scenarios with respect to time dependence
-  if (options.has_date_time_type()) {
-    if (options.date_time_type() == Options::arrive_by ||
-        options.date_time_type() == Options::invariant) {
-      if (options.costing() == multimodal || options.costing() == transit)
-        throw valhalla_exception_t{141};
-      if (options.action() == Options::isochrone)
-        throw valhalla_exception_t{142};
+    auto date_time_value = rapidjson::get_optional<std::string>(doc, "/date_time/value");
+    if (date_time_value) {
+      options.set_date_time(*date_time_value);
     }
   }
+  check_date_time(options);
 
   // Set the output precision for shape/geometry (polyline encoding). Defaults to polyline6
   // This also controls the input precision for encoded_polyline in height action
@@ -636,30 +790,7 @@ void from_json(rapidjson::Document& doc, Options& options) {
   auto encoded_polyline = rapidjson::get_optional<std::string>(doc, "/encoded_polyline");
   if (encoded_polyline) {
     options.set_encoded_polyline(*encoded_polyline);
-
-    // Set the precision to use when decoding the polyline. For height actions (only)
-    // either polyline6 (default) or polyline5 are supported. All other actions only
-    // support polyline6 inputs at this time.
-    double precision = 1e-6;
-    if (options.action() == Options::height) {
-      precision = options.shape_format() == valhalla::polyline5 ? 1e-5 : 1e-6;
-    }
-
-    auto decoded = midgard::decode<std::vector<midgard::PointLL>>(*encoded_polyline, precision);
-    for (const auto& ll : decoded) {
-      auto* sll = options.mutable_shape()->Add();
-      sll->mutable_ll()->set_lat(ll.lat());
-      sll->mutable_ll()->set_lng(ll.lng());
-      // set type to via by default
-      sll->set_type(valhalla::Location::kVia);
-    }
-    // first and last always get type break
-    if (options.shape_size()) {
-      options.mutable_shape(0)->set_type(valhalla::Location::kBreak);
-      options.mutable_shape(options.shape_size() - 1)->set_type(valhalla::Location::kBreak);
-    }
-    // add the date time
-    add_date_to_locations(options, *options.mutable_shape());
+    decode_shape(options);
   } // fall back from encoded polyline to array of locations
   else {
     parse_locations(doc, options, "shape", 134, ignore_closures);
@@ -704,29 +835,15 @@ void from_json(rapidjson::Document& doc, Options& options) {
   options.set_use_timestamps(
       rapidjson::get_optional<bool>(doc, "/use_timestamps").get_value_or(false));
 
-  // Throw an error if use_timestamps is set to true but there are no timestamps in the
-  // trace (or no durations present)
-  if (options.use_timestamps()) {
-    bool has_time = false;
-    for (const auto& s : options.shape()) {
-      if (s.has_time()) {
-        has_time = true;
-        break;
-      }
-    }
-    if (!has_time) {
-      throw valhalla_exception_t{159};
-    }
-  }
+  check_timestamps(options);
 
   // TODO: remove this?
   options.set_do_not_track(rapidjson::get_optional<bool>(doc, "/healthcheck").get_value_or(false));
 
   // Elevation service options
   options.set_range(rapidjson::get(doc, "/range", false));
-  constexpr uint32_t MAX_HEIGHT_PRECISION = 2;
   auto height_precision = rapidjson::get_optional<unsigned int>(doc, "/height_precision");
-  if (height_precision && *height_precision <= MAX_HEIGHT_PRECISION) {
+  if (height_precision) {
     options.set_height_precision(*height_precision);
   }
 
@@ -750,9 +867,6 @@ void from_json(rapidjson::Document& doc, Options& options) {
       // parse the options
       std::string key = "/recostings/" + std::to_string(i);
       sif::ParseCostingOptions(doc, key, options.add_recostings());
-      if (!options.recostings().rbegin()->has_name()) {
-        throw valhalla_exception_t{127};
-      }
     }
     // TODO: throw if not all names are unique?
   }
@@ -787,14 +901,7 @@ void from_json(rapidjson::Document& doc, Options& options) {
     } catch (...) { throw valhalla_exception_t{137}; }
   }
 
-  // if not a time dependent route/mapmatch disable time dependent edge speed/flow data sources
-  if (!options.has_date_time_type() && (options.shape_size() == 0 || options.shape(0).time() == -1)) {
-    for (auto& costing : *options.mutable_costing_options()) {
-      costing.set_flow_mask(
-          static_cast<uint8_t>(costing.flow_mask()) &
-          ~(valhalla::baldr::kPredictedFlowMask | valhalla::baldr::kCurrentFlowMask));
-    }
-  }
+  disable_time_dependent_flows(options);
 
   // get some parameters
   auto resample_distance = rapidjson::get_optional<double>(doc, "/resample_distance");
@@ -814,7 +921,7 @@ void from_json(rapidjson::Document& doc, Options& options) {
   // if specified, get the denoise in there
   auto denoise = rapidjson::get_optional<float>(doc, "/denoise");
   if (denoise) {
-    options.set_denoise(std::max(std::min(*denoise, 1.f), 0.f));
+    options.set_denoise(*denoise);
   }
 
   // if specified, get the generalize value in there
@@ -894,10 +1001,8 @@ void from_json(rapidjson::Document& doc, Options& options) {
     }
   }
 
-  // how many alternates are desired, default to none and if its multi point its also none
+  // how many alternates are desired, default to none
   options.set_alternates(rapidjson::get<uint32_t>(doc, "/alternates", 0));
-  if (options.locations_size() > 2)
-    options.set_alternates(0);
 
   // whether to return guidance_views, default false
   auto guidance_views = rapidjson::get_optional<bool>(doc, "/guidance_views");
@@ -912,6 +1017,8 @@ void from_json(rapidjson::Document& doc, Options& options) {
     options.set_roundabout_exits(*roundabout_exits);
   }
 
+  check_options(options);
+
   // force these into the output so its obvious what we did to the user
   doc.AddMember({"language", allocator}, {options.language(), allocator}, allocator);
   doc.AddMember({"format", allocator},
@@ -976,6 +1083,146 @@ std::string jsonify_error(const valhalla_exception_t& exception, Api& request) {
 }
 
 #ifdef HAVE_HTTP
+namespace {
+
+// Validates the costing options of a pbf request like the json parser would. The parsers see an
+// empty json object for each option the request gave, so they keep its values where valid and
+// fill in the rest, while the costings left out get the same defaults as in json
+void fill_costing_options(Options& options) {
+  rapidjson::Document none;
+  none.SetObject();
+  Options defaults;
+  sif::ParseCostingOptions(none, "/costing_options", defaults);
+
+  rapidjson::Document empty;
+  empty.Parse(R"({"given":{}})");
+  auto parse = [&empty](const CostingOptions& given, Costing costing) {
+    CostingOptions parsed = given;
+    sif::ParseCostingOptions(empty, "/given", &parsed, costing);
+    // the parsers name the options after their costing unless the json said otherwise
+    if (given.has_name()) {
+      parsed.set_name(given.name());
+    }
+    return parsed;
+  };
+
+  // costing options are found by their costing, or by their position if they dont say
+  auto costing_options = defaults.costing_options();
+  for (int i = 0; i < options.costing_options_size(); ++i) {
+    const auto& given = options.costing_options(i);
+    const int index = given.has_costing() ? static_cast<int>(given.costing()) : i;
+    const auto costing = static_cast<Costing>(index);
+    if (index < costing_options.size() && !Costing_Enum_Name(costing).empty()) {
+      *costing_options.Mutable(index) = parse(given, costing);
+    }
+  }
+  options.mutable_costing_options()->Swap(&costing_options);
+
+  // recostings have to say which costing they are, just like in json
+  for (auto& recosting : *options.mutable_recostings()) {
+    if (!recosting.has_costing()) {
+      throw valhalla_exception_t{127};
+    }
+    recosting = parse(recosting, recosting.costing());
+  }
+}
+
+// The checks and defaults parse_locations applies to the locations it parses
+void check_locations(Options& options,
+                     google::protobuf::RepeatedPtrField<valhalla::Location>& locations,
+                     const std::string& node,
+                     unsigned location_parse_error_code,
+                     bool ignore_closures) {
+  bool had_date_time = false;
+  for (int i = 0; i < locations.size(); ++i) {
+    auto& location = *locations.Mutable(i);
+    if (!location.has_original_index()) {
+      location.set_original_index(i);
+    }
+
+    if (!location.has_ll() || !location.ll().has_lat() || !location.ll().has_lng() ||
+        location.ll().lat() < -90.0 || location.ll().lat() > 90.0) {
+      throw valhalla_exception_t{location_parse_error_code};
+    }
+    location.mutable_ll()->set_lng(
+        midgard::circular_range_clamp<double>(location.ll().lng(), -180, 180));
+
+    // trace attributes does not support legs or breaks at discontinuities and trace_route
+    // defaults to via
+    if (options.action() == Options::trace_attributes ||
+        (options.action() == Options::trace_route && !location.has_type())) {
+      location.set_type(valhalla::Location::kVia);
+    }
+
+    had_date_time = had_date_time || location.has_date_time();
+
+    // ignore_closures takes precedence, a location cannot ask for the opposite
+    if (ignore_closures) {
+      if (location.search_filter().has_exclude_closures() &&
+          location.search_filter().exclude_closures()) {
+        throw valhalla_exception_t{143};
+      }
+      location.mutable_search_filter()->set_exclude_closures(false);
+    } else {
+      location.mutable_search_filter()->set_exclude_closures(
+          location.search_filter().exclude_closures());
+    }
+  }
+
+  finish_locations(options, locations, node, had_date_time);
+}
+
+void from_pbf(const http_request_t& request, valhalla::Api& api) {
+  if (!api.ParseFromString(request.body)) {
+    throw valhalla_exception_t{100, "Failed to parse pbf request"};
+  }
+  auto& options = *api.mutable_options();
+
+  // the path decides the action just like it does for json requests
+  Options::Action action;
+  if (!request.path.empty() && Options_Action_Enum_Parse(request.path.substr(1), &action)) {
+    options.set_action(action);
+  }
+  if (options.format() == Options::pbf && !supports_pbf(options.action())) {
+    throw valhalla_exception_t{144, "'" + Options_Action_Enum_Name(options.action()) + "'"};
+  }
+
+  // from here on the same checks and defaults a json request gets
+  check_date_time(options);
+
+  if (options.has_encoded_polyline() && options.shape_size() == 0) {
+    decode_shape(options);
+  }
+  check_timestamps(options);
+
+  fill_costing_options(options);
+  const bool ignore_closures =
+      options.costing() != multimodal &&
+      options.costing_options(static_cast<int>(options.costing())).ignore_closures();
+
+  check_locations(options, *options.mutable_shape(), "shape", 134, ignore_closures);
+  check_locations(options, *options.mutable_trace(), "trace", 135, ignore_closures);
+  check_locations(options, *options.mutable_locations(), "locations", 130, ignore_closures);
+  check_locations(options, *options.mutable_sources(), "sources", 131, ignore_closures);
+  check_locations(options, *options.mutable_targets(), "targets", 132, ignore_closures);
+  check_locations(options, *options.mutable_exclude_locations(), "exclude_locations", 133,
+                  ignore_closures);
+
+  for (auto& ring : *options.mutable_exclude_polygons()) {
+    for (auto& ll : *ring.mutable_coords()) {
+      if (ll.lat() < -90.0 || ll.lat() > 90.0) {
+        throw valhalla_exception_t{137};
+      }
+      ll.set_lng(midgard::circular_range_clamp<double>(ll.lng(), -180, 180));
+    }
+  }
+
+  disable_time_dependent_flows(options);
+  check_options(options);
+}
+
+} // namespace
+
 void ParseApi(const http_request_t& request, valhalla::Api& api) {
   api.Clear();
 
@@ -984,6 +1231,17 @@ void ParseApi(const http_request_t& request, valhalla::Api& api) {
     throw valhalla_exception_t{101};
   };
 
+  // service to service requests may send an already parsed Api instead of json
+  auto content_type =
+      std::find_if(request.headers.cbegin(), request.headers.cend(), [](const auto& header) {
+        return boost::iequals(header.first, "Content-Type");
+      });
+  if (request.method == method_t::POST && content_type != request.headers.cend() &&
+      boost::istarts_with(content_type->second, "application/x-protobuf")) {
+    from_pbf(request, api);
+    return;
+  }
+
   rapidjson::Document document;
   auto& allocator = document.GetAllocator();
   // parse the input
@@ -1052,6 +1310,28 @@ worker_t::result_t jsonify_error(const valhalla_exception_t& exception,
   return result;
 }
 
+namespace {
+// sampled requests get their timings back in a header so that json, pbf and gpx alike can carry them
+// the keys look like action.info.worker.metric and we only need the worker.metric part
+headers_t::value_type server_timing(const Api& request) {
+  std::ostringstream timings;
+  timings.precision(3);
+  timings << std::fixed;
+  for (const auto& stat : request.info().statistics()) {
+    auto pos = stat.key().find(".info.");
+    if (stat.type() != timing || pos == std::string::npos)
+      continue;
+    auto name = stat.key().substr(pos + 6);
+    if (boost::algorithm::ends_with(name, "_ms"))
+      name.resize(name.size() - 3);
+    if (timings.tellp() > 0)
+      timings << ", ";
+    timings << name << ";dur=" << stat.value();
+  }
+  return {"Server-Timing", timings.str()};
+}
+} // namespace
+
 worker_t::result_t to_response(const std::string& data,
                                http_request_info_t& request_info,
                                const Api& request,
@@ -1059,7 +1339,8 @@ worker_t::result_t to_response(const std::string& data,
                                const bool as_attachment) {
 
   worker_t::result_t result{false, std::list<std::string>(), ""};
-  if (request.options().has_jsonp()) {
+  const bool as_pbf = request.options().format() == Options::pbf;
+  if (request.options().has_jsonp() && !as_pbf) {
     std::ostringstream stream;
     stream << request.options().jsonp() << '(';
     stream << data;
@@ -1068,14 +1349,18 @@ worker_t::result_t to_response(const std::string& data,
     headers_t headers{CORS, worker::JS_MIME};
     if (as_attachment)
       headers.insert(ATTACHMENT);
+    if (request.info().stage_timings())
+      headers.insert(server_timing(request));
 
     http_response_t response(200, "OK", stream.str(), headers);
     response.from_info(request_info);
     result.messages.emplace_back(response.to_string());
   } else {
-    headers_t headers{CORS, mime_type};
+    headers_t headers{CORS, as_pbf ? worker::PBF_MIME : mime_type};
     if (as_attachment)
       headers.insert(ATTACHMENT);
+    if (request.info().stage_timings())
+      headers.insert(server_timing(request));
     http_response_t response(200, "OK", data, headers);
     response.from_info(request_info);
     result.messages.emplace_back(response.to_string());
@@ -1111,7 +1396,8 @@ struct statsd_client_t : public Statsd::StatsdClient {
 };
 
 service_worker_t::service_worker_t(const boost::property_tree::ptree& config)
-    : interrupt(nullptr), statsd_client(new statsd_client_t(config)) {
+    : interrupt(nullptr), statsd_client(new statsd_client_t(config)),
+      stage_sample_rate(config.get<float>("statsd.stage_sample_rate", 0.f)) {
 }
 service_worker_t::~service_worker_t() {
 }
@@ -1159,17 +1445,50 @@ void service_worker_t::enqueue_statistics(Api& api) const {
   }
 }
 midgard::Finally<std::function<void()>> service_worker_t::measure_scope_time(Api& api) const {
+  // the first stage to see the request decides whether its stages are broken down, the rest follow
+  if (stage_sample_rate > 0.f && !api.info().has_stage_timings()) {
+    static thread_local std::mt19937 generator(std::random_device{}());
+    std::uniform_real_distribution<float> distribution(0.f, 1.f);
+    api.mutable_info()->set_stage_timings(distribution(generator) < stage_sample_rate);
+  }
+  // only the outermost scope on this thread collects the profile
+  bool profiled = api.info().stage_timings() && midgard::profiling::start();
+
   // we copy the captures that could go out of scope
   auto start = std::chrono::steady_clock::now();
-  return midgard::Finally<std::function<void()>>([this, &api, start]() {
+  return midgard::Finally<std::function<void()>>([this, &api, start, profiled]() {
     auto elapsed = std::chrono::steady_clock::now() - start;
     auto e = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(elapsed).count();
     const auto& action = Options_Action_Enum_Name(api.options().action());
+    const auto prefix = action + ".info." + service_name();
 
     auto* stat = api.mutable_info()->mutable_statistics()->Add();
-    stat->set_key(action + ".info." + service_name() + ".latency_ms");
+    stat->set_key(prefix + ".latency_ms");
     stat->set_value(e);
     stat->set_type(timing);
+
+    if (!profiled)
+      return;
+    const auto& profile = midgard::profiling::thread_profile();
+    for (size_t i = 0; i < profile.elapsed_ms.size(); ++i) {
+      if (profile.elapsed_ms[i] <= 0.)
+        continue;
+      stat = api.mutable_info()->mutable_statistics()->Add();
+      stat->set_key(prefix + ".stage." +
+                    midgard::profiling::to_string(static_cast<midgard::profiling::Stage>(i)) + "_ms");
+      stat->set_value(profile.elapsed_ms[i]);
+      stat->set_type(timing);
+    }
+    for (size_t i = 0; i < profile.counts.size(); ++i) {
+      if (profile.counts[i] == 0)
+        continue;
+      stat = api.mutable_info()->mutable_statistics()->Add();
+      stat->set_key(prefix + ".stage." +
+                    midgard::profiling::to_string(static_cast<midgard::profiling::Counter>(i)));
+      stat->set_value(profile.counts[i]);
+      stat->set_type(count);
+    }
+    midgard::profiling::stop();
   });
 }
 
@@ -0,0 +1,196 @@
+#include "admission_control.h"
+#include "test.h"
+#include "worker.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace valhalla;
+
+namespace {
+
+boost::property_tree::ptree lane_config(const std::string& action,
+                                        const std::unordered_map<std::string, std::string>& limits) {
+  boost::property_tree::ptree config;
+  config.put("httpd.service.worker_concurrency", 8);
+  for (const auto& limit : limits) {
+    config.put("httpd.service.admission." + action + "." + limit.first, limit.second);
+  }
+  return config;
+}
+
+Api make_request(Options::Action action, size_t locations, double spacing = 0.) {
+  Api request;
+  request.mutable_options()->set_action(action);
+  for (size_t i = 0; i < locations; ++i) {
+    auto* ll = request.mutable_options()->add_locations()->mutable_ll();
+    ll->set_lat(52.);
+    ll->set_lng(5. + i * spacing);
+  }
+  return request;
+}
+
+bool has_stat(const Api& request, const std::string& key) {
+  for (const auto& stat : request.info().statistics()) {
+    if (stat.key() == key) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+TEST(AdmissionControl, estimate_cost) {
+  // close together locations cost about as much as there are of them
+  auto close = make_request(Options::route, 2);
+  EXPECT_FLOAT_EQ(admission_control_t::estimate_cost(close.options()), 2.f);
+  // the further apart they are the more they cost
+  auto near = make_request(Options::route, 2, .1);
+  auto far = make_request(Options::route, 2, 1.);
+  EXPECT_GT(admission_control_t::estimate_cost(far.options()),
+            admission_control_t::estimate_cost(near.options()));
+  EXPECT_NEAR(admission_control_t::estimate_cost(far.options()), 2 * 68.5, 2.);
+
+  // matrices cost their pairs
+  Api matrix;
+  matrix.mutable_options()->set_action(Options::sources_to_targets);
+  for (int i = 0; i < 3; ++i) {
+    matrix.mutable_options()->add_sources()->mutable_ll()->set_lat(52.);
+    matrix.mutable_options()->add_targets()->mutable_ll()->set_lat(52.);
+  }
+  EXPECT_FLOAT_EQ(admission_control_t::estimate_cost(matrix.options()), 9.f);
+
+  // isochrones cost their largest contour
+  auto isochrone = make_request(Options::isochrone, 1);
+  isochrone.mutable_options()->add_contours()->set_time(10);
+  isochrone.mutable_options()->add_contours()->set_time(30);
+  EXPECT_FLOAT_EQ(admission_control_t::estimate_cost(isochrone.options()), 30.f);
+}
+
+TEST(AdmissionControl, unconfigured_actions_pass) {
+  admission_control_t admission(lane_config("route", {{"concurrency", "0"}}));
+  auto request = make_request(Options::route, 2);
+  admission.admit(request);
+  EXPECT_FALSE(request.has_info());
+}
+
+TEST(AdmissionControl, sheds_when_queue_full) {
+  admission_control_t admission(lane_config("route", {{"concurrency", "1"}, {"max_queue", "0"}}));
+  auto first = make_request(Options::route, 2);
+  auto ticket = admission.admit(first);
+  EXPECT_TRUE(has_stat(first, "route.info.admission.wait_ms"));
+
+  // nothing else fits
+  auto second = make_request(Options::route, 2);
+  try {
+    admission.admit(second);
+    FAIL() << "Expected to be shed";
+  } catch (const valhalla_exception_t& e) { EXPECT_EQ(e.code, 103); }
+  EXPECT_TRUE(has_stat(second, "route.info.admission.shed"));
+
+  // other actions dont care
+  auto matrix = make_request(Options::sources_to_targets, 2);
+  admission.admit(matrix);
+}
+
+TEST(AdmissionControl, queue_leaves_worker_threads) {
+  // two threads, one of them running the request, so only one more may wait even though the
+  // default queue is much larger
+  auto config = lane_config("route", {{"concurrency", "1"}, {"max_wait_ms", "2000"}});
+  config.put("httpd.service.worker_concurrency", 2);
+  admission_control_t admission(config);
+  auto first = make_request(Options::route, 2);
+  std::unique_ptr<admission_control_t::ticket_t> ticket(
+      new admission_control_t::ticket_t(admission.admit(first)));
+
+  std::thread waiter([&admission]() {
+    auto second = make_request(Options::route, 2);
+    admission.admit(second);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  auto third = make_request(Options::route, 2);
+  try {
+    admission.admit(third);
+    FAIL() << "Expected to be shed";
+  } catch (const valhalla_exception_t& e) { EXPECT_EQ(e.code, 103); }
+  EXPECT_TRUE(has_stat(third, "route.info.admission.shed"));
+
+  ticket.reset();
+  waiter.join();
+}
+
+TEST(AdmissionControl, sheds_after_max_wait) {
+  admission_control_t admission(
+      lane_config("route", {{"concurrency", "1"}, {"max_wait_ms", "100"}}));
+  auto first = make_request(Options::route, 2);
+  auto ticket = admission.admit(first);
+  auto second = make_request(Options::route, 2);
+  EXPECT_THROW(admission.admit(second), valhalla_exception_t);
+}
+
+TEST(AdmissionControl, waits_for_a_slot) {
+  admission_control_t admission(lane_config("route", {{"concurrency", "1"}}));
+  std::atomic<bool> released(false);
+  std::thread holder([&]() {
+    auto request = make_request(Options::route, 2);
+    auto ticket = admission.admit(request);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    released = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  auto request = make_request(Options::route, 2);
+  auto ticket = admission.admit(request);
+  EXPECT_TRUE(released);
+  holder.join();
+}
+
+TEST(AdmissionControl, cheap_requests_go_first) {
+  admission_control_t admission(
+      lane_config("route", {{"concurrency", "1"}, {"expensive_cost", "100"}}));
+  auto holder_request = make_request(Options::route, 2);
+  std::unique_ptr<admission_control_t::ticket_t> holder(
+      new admission_control_t::ticket_t(admission.admit(holder_request)));
+
+  // an expensive request starts waiting before a cheap one
+  std::vector<std::string> order;
+  std::mutex order_mutex;
+  auto run = [&](Api request, const std::string& name) {
+    auto ticket = admission.admit(request);
+    std::lock_guard<std::mutex> lock(order_mutex);
+    order.push_back(name);
+  };
+  std::thread expensive(run, make_request(Options::route, 2, 5.), "expensive");
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  std::thread cheap(run, make_request(Options::route, 2), "cheap");
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // but the cheap one gets the slot first
+  holder.reset();
+  expensive.join();
+  cheap.join();
+  ASSERT_EQ(order.size(), 2);
+  EXPECT_EQ(order.front(), "cheap");
+}
+
+TEST(AdmissionControl, sheds_expensive_when_behind) {
+  admission_control_t admission(lane_config("route", {{"concurrency", "2"},
+                                                      {"expensive_cost", "100"},
+                                                      {"latency_slo_ms", "10"}}));
+  // a slow request drags the latency estimate over the target
+  {
+    auto slow = make_request(Options::route, 2);
+    auto ticket = admission.admit(slow);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  }
+
+  // while something is running expensive requests are turned away and cheap ones are not
+  auto running = make_request(Options::route, 2);
+  auto ticket = admission.admit(running);
+  auto expensive = make_request(Options::route, 2, 5.);
+  EXPECT_THROW(admission.admit(expensive), valhalla_exception_t);
+  auto cheap = make_request(Options::route, 2);
+  admission.admit(cheap);
+}
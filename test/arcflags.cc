@@ -0,0 +1,85 @@
+#include "baldr/arcflags.h"
+
+#include <fstream>
+
+#include "test.h"
+
+using namespace valhalla;
+using namespace valhalla::baldr;
+using namespace valhalla::midgard;
+
+namespace {
+
+// a degree square split into 8x8 regions of an eighth of a degree each, with two tiles of edges
+ArcFlags make_arc_flags() {
+  ArcFlags arc_flags(Costing::auto_, AABB2<PointLL>(4.0, 52.0, 5.0, 53.0),
+                     {{GraphId(5, 1, 0).value, 0, 3}, {GraphId(1, 1, 0).value, 0, 2}});
+  for (uint32_t i = 0; i < arc_flags.edge_count(); ++i) {
+    arc_flags.flags(i) = {ArcFlags::flags_t(1) << i, ArcFlags::flags_t(1) << (63 - i)};
+  }
+  return arc_flags;
+}
+
+TEST(ArcFlags, region) {
+  const auto arc_flags = make_arc_flags();
+  EXPECT_EQ(arc_flags.Region({4.01, 52.01}), 0);
+  EXPECT_EQ(arc_flags.Region({4.2, 52.01}), 1);
+  EXPECT_EQ(arc_flags.Region({4.01, 52.2}), 8);
+  EXPECT_EQ(arc_flags.Region({4.99, 52.99}), 63);
+
+  // locations outside of the area are in the closest region
+  EXPECT_EQ(arc_flags.Region({3.0, 52.01}), 0);
+  EXPECT_EQ(arc_flags.Region({6.0, 54.0}), 63);
+}
+
+TEST(ArcFlags, regions) {
+  const auto arc_flags = make_arc_flags();
+  // well inside a region only its own bit is set
+  EXPECT_EQ(arc_flags.Regions({4.0625, 52.0625}, 100), ArcFlags::flags_t(1));
+
+  // close to the corner of four regions all of them are
+  const auto corner = arc_flags.Regions({4.125, 52.125}, 100);
+  EXPECT_EQ(corner, ArcFlags::flags_t(1) | ArcFlags::flags_t(1) << 1 | ArcFlags::flags_t(1) << 8 |
+                        ArcFlags::flags_t(1) << 9);
+
+  // far enough around the center it covers the whole area
+  EXPECT_EQ(arc_flags.Regions({4.5, 52.5}, 100000), ArcFlags::kAllRegions);
+}
+
+TEST(ArcFlags, flags) {
+  const auto arc_flags = make_arc_flags();
+  EXPECT_EQ(arc_flags.edge_count(), 5);
+
+  // the tiles are numbered in the order of their ids
+  ASSERT_NE(arc_flags.flags(GraphId(1, 1, 1)), nullptr);
+  EXPECT_EQ(arc_flags.flags(GraphId(1, 1, 1))->to, ArcFlags::flags_t(1) << 1);
+  ASSERT_NE(arc_flags.flags(GraphId(5, 1, 0)), nullptr);
+  EXPECT_EQ(arc_flags.flags(GraphId(5, 1, 0))->from, ArcFlags::flags_t(1) << 61);
+
+  // edges of other tiles or past the end of a tile have no flags
+  EXPECT_EQ(arc_flags.flags(GraphId(5, 1, 3)), nullptr);
+  EXPECT_EQ(arc_flags.flags(GraphId(7, 1, 0)), nullptr);
+  EXPECT_EQ(arc_flags.flags(GraphId(5, 2, 0)), nullptr);
+}
+
+TEST(ArcFlags, save_and_load) {
+  const std::string file_name = "test/data/arcflags.bin";
+  make_arc_flags().Save(file_name);
+  const auto arc_flags = ArcFlags::Load(file_name);
+  EXPECT_EQ(arc_flags.costing(), Costing::auto_);
+  EXPECT_EQ(arc_flags.edge_count(), 5);
+  EXPECT_EQ(arc_flags.Region({4.99, 52.01}), 7);
+  ASSERT_NE(arc_flags.flags(GraphId(5, 1, 2)), nullptr);
+  EXPECT_EQ(arc_flags.flags(GraphId(5, 1, 2))->to, ArcFlags::flags_t(1) << 4);
+
+  EXPECT_THROW(ArcFlags::Load("test/data/does_not_exist.bin"), std::runtime_error);
+  std::ofstream(file_name, std::ios::binary | std::ios::trunc) << "not an arc flag file";
+  EXPECT_THROW(ArcFlags::Load(file_name), std::runtime_error);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -21,15 +21,27 @@ void TryArgCtor(size_t expected_size) {
 }
 
 TEST(AttrController, TestArgCtor) {
-  TryArgCtor(AttributesController::kDefaultAttributes.size());
+  TryArgCtor(kAttributeCount);
+}
+
+TEST(AttrController, TestDefaults) {
+  AttributesController controller;
+  EXPECT_TRUE(controller(kEdgeNames));
+  EXPECT_TRUE(controller(kShape));
+  EXPECT_FALSE(controller(kEdgeIsUrban));
+  EXPECT_FALSE(controller(kIncidents));
+  EXPECT_FALSE(controller(kShapeAttributesTime));
+  EXPECT_FALSE(controller(kShapeAttributesClosure));
 }
 
 void TryDisableAll() {
   AttributesController controller;
   controller.disable_all();
-  for (auto& pair : controller.attributes) {
-    // If any pair value is true then throw error
-    EXPECT_FALSE(pair.second) << ("Incorrect disable_all value for " + pair.first);
+  for (size_t i = 0; i < kAttributeCount; ++i) {
+    // If any attribute is enabled then throw error
+    auto attribute = static_cast<Attribute>(i);
+    EXPECT_FALSE(controller(attribute))
+        << ("Incorrect disable_all value for " + AttributesController::name(attribute));
   }
 }
 
@@ -38,7 +50,7 @@ TEST(AttrController, TestDisableAll) {
 }
 
 void TryCategoryAttributeEnabled(const AttributesController& controller,
-                                 const std::string& category,
+                                 AttributeCategory category,
                                  bool expected_response) {
   // If category_attribute_enabled does not equal expected response then throw error
   EXPECT_EQ(controller.category_attribute_enabled(category), expected_response);
@@ -55,18 +67,68 @@ TEST(AttrController, TestNodeAttributeEnabled) {
   TryCategoryAttributeEnabled(controller, kNodeCategory, false);
 
   // Test one node enabled
-  controller.attributes.at(kNodeType) = true;
+  controller.attributes.set(kNodeType);
   TryCategoryAttributeEnabled(controller, kNodeCategory, true);
 
   // Test some node enabled
-  controller.attributes.at(kNodeType) = false;
-  controller.attributes.at(kNodeIntersectingEdgeBeginHeading) = true;
-  controller.attributes.at(kNodeTransitPlatformInfoType) = true;
-  controller.attributes.at(kNodeElapsedTime) = true;
-  controller.attributes.at(kNodeFork) = true;
+  controller.attributes.reset(kNodeType);
+  controller.attributes.set(kNodeIntersectingEdgeBeginHeading);
+  controller.attributes.set(kNodeTransitPlatformInfoType);
+  controller.attributes.set(kNodeElapsedTime);
+  controller.attributes.set(kNodeFork);
   TryCategoryAttributeEnabled(controller, kNodeCategory, true);
 }
 
+TEST(AttrController, TestSetByName) {
+  AttributesController controller;
+  EXPECT_TRUE(controller.set("edge.names", false));
+  EXPECT_FALSE(controller(kEdgeNames));
+  EXPECT_TRUE(controller.set("shape_attributes.closure", true));
+  EXPECT_TRUE(controller(kShapeAttributesClosure));
+  EXPECT_FALSE(controller.set("edge.not_an_attribute", true));
+  EXPECT_FALSE(controller.set("edge.", true));
+
+  // every attribute can be set by its name and names are unique
+  for (size_t i = 0; i < kAttributeCount; ++i) {
+    auto attribute = static_cast<Attribute>(i);
+    controller.disable_all();
+    EXPECT_TRUE(controller.set(AttributesController::name(attribute), true));
+    EXPECT_EQ(controller.attributes.count(), 1u);
+    EXPECT_TRUE(controller(attribute)) << AttributesController::name(attribute);
+  }
+
+  // spot check that the names line up with the ids
+  EXPECT_EQ(AttributesController::name(kEdgeNames), "edge.names");
+  EXPECT_EQ(AttributesController::name(kEdgeTaggedNames), "edge.tagged_names");
+  EXPECT_EQ(AttributesController::name(kNodeTransitionTime), "node.transition_time");
+  EXPECT_EQ(AttributesController::name(kIncidents), "incidents");
+  EXPECT_EQ(AttributesController::name(kRawScore), "raw_score");
+  EXPECT_EQ(AttributesController::name(kShapeAttributesClosure), "shape_attributes.closure");
+}
+
+TEST(AttrController, TestCategoryMembership) {
+  // each attribute only turns on the category its name starts with
+  const std::vector<std::pair<AttributeCategory, std::string>> categories{
+      {kEdgeCategory, "edge."},
+      {kNodeCategory, "node."},
+      {kAdminCategory, "admin."},
+      {kMatchedCategory, "matched."},
+      {kShapeAttributesCategory, "shape_attributes."},
+  };
+  AttributesController controller;
+  for (size_t i = 0; i < kAttributeCount; ++i) {
+    auto attribute = static_cast<Attribute>(i);
+    const auto& name = AttributesController::name(attribute);
+    controller.disable_all();
+    controller.attributes.set(attribute);
+    for (const auto& category : categories) {
+      EXPECT_EQ(controller.category_attribute_enabled(category.first),
+                name.compare(0, category.second.size(), category.second) == 0)
+          << name << " " << category.second;
+    }
+  }
+}
+
 TEST(AttrController, TestAdminAttributeEnabled) {
   AttributesController controller;
 
@@ -78,14 +140,14 @@ TEST(AttrController, TestAdminAttributeEnabled) {
   TryCategoryAttributeEnabled(controller, kAdminCategory, false);
 
   // Test one admin enabled
-  controller.attributes.at(kAdminCountryCode) = true;
+  controller.attributes.set(kAdminCountryCode);
   TryCategoryAttributeEnabled(controller, kAdminCategory, true);
 
   // Test some admin enabled
-  controller.attributes.at(kAdminCountryCode) = false;
-  controller.attributes.at(kAdminCountryText) = true;
-  controller.attributes.at(kAdminStateCode) = false;
-  controller.attributes.at(kAdminStateText) = true;
+  controller.attributes.reset(kAdminCountryCode);
+  controller.attributes.set(kAdminCountryText);
+  controller.attributes.reset(kAdminStateCode);
+  controller.attributes.set(kAdminStateText);
   TryCategoryAttributeEnabled(controller, kAdminCategory, true);
 }
 
@@ -0,0 +1,105 @@
+#include "baldr/cellpartition.h"
+#include "baldr/tilehierarchy.h"
+
+#include <fstream>
+
+#include "test.h"
+
+using namespace valhalla::baldr;
+
+namespace {
+
+// cells 10, 20 and 30 in a row with edges both ways between neighbours and one from 10 to 30
+std::vector<CellPartition::cut_edge_t> make_cut_edges() {
+  return {
+      {{5, 2, 7}, 20, 10}, {{1, 2, 3}, 10, 20}, {{9, 2, 1}, 20, 30},
+      {{2, 2, 4}, 30, 20}, {{4, 2, 2}, 10, 30}, {{1, 2, 3}, 10, 20},
+  };
+}
+
+std::vector<GraphId> edges(const GraphId* begin, uint32_t count) {
+  return std::vector<GraphId>(begin, begin + count);
+}
+
+void check(const CellPartition& partition) {
+  ASSERT_EQ(partition.cell_count(), 3);
+  EXPECT_EQ(partition.cut_edge_count(), 5);
+  EXPECT_EQ(partition.Find(20), 1);
+  EXPECT_EQ(partition.id(1), 20);
+  EXPECT_EQ(partition.Find(15), CellPartition::kInvalidCell);
+  EXPECT_EQ(partition.Find(40), CellPartition::kInvalidCell);
+
+  // cell 20 is entered from both sides and left towards both of them, the edges of a cell are in
+  // the order of their ids
+  auto cell = partition.Find(20);
+  EXPECT_EQ(edges(partition.entries(cell), partition.entry_count(cell)),
+            (std::vector<GraphId>{{1, 2, 3}, {2, 2, 4}}));
+  EXPECT_EQ(edges(partition.exits(cell), partition.exit_count(cell)),
+            (std::vector<GraphId>{{9, 2, 1}, {5, 2, 7}}));
+  cell = partition.Find(10);
+  EXPECT_EQ(partition.entry_count(cell), 1);
+  EXPECT_EQ(partition.exit_count(cell), 2);
+  EXPECT_EQ(partition.exit_offset(cell), 0);
+  EXPECT_EQ(partition.exit_offset(partition.Find(20)), 2);
+
+  uint32_t index = 0;
+  EXPECT_TRUE(partition.FindEntry({2, 2, 4}, cell, index));
+  EXPECT_EQ(partition.id(cell), 20);
+  EXPECT_EQ(index, 1);
+  EXPECT_TRUE(partition.FindExit({4, 2, 2}, cell, index));
+  EXPECT_EQ(partition.id(cell), 10);
+  EXPECT_EQ(index, 0);
+  EXPECT_TRUE(partition.FindEntry({4, 2, 2}, cell, index));
+  EXPECT_EQ(partition.id(cell), 30);
+  EXPECT_FALSE(partition.FindEntry({4, 2, 3}, cell, index));
+  EXPECT_FALSE(partition.FindExit({0, 0, 0}, cell, index));
+}
+
+TEST(CellPartition, build) {
+  check(CellPartition(make_cut_edges()));
+
+  CellPartition empty;
+  EXPECT_EQ(empty.cell_count(), 0);
+  EXPECT_EQ(empty.cut_edge_count(), 0);
+  EXPECT_EQ(empty.Find(10), CellPartition::kInvalidCell);
+
+  auto cut_edges = make_cut_edges();
+  cut_edges.push_back({{3, 2, 3}, 20, 20});
+  EXPECT_THROW(CellPartition{cut_edges}, std::runtime_error);
+}
+
+TEST(CellPartition, save_and_load) {
+  const std::string file_name = "test/data/cellpartition.bin";
+  CellPartition(make_cut_edges()).Save(file_name);
+  check(CellPartition::Load(file_name));
+
+  EXPECT_THROW(CellPartition::Load("test/data/does_not_exist.bin"), std::runtime_error);
+
+  // a partition thats cut short or isnt a partition at all
+  std::ifstream in(file_name, std::ios::binary);
+  std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  std::ofstream(file_name, std::ios::binary | std::ios::trunc)
+      << contents.substr(0, contents.size() - 8);
+  EXPECT_THROW(CellPartition::Load(file_name), std::runtime_error);
+  std::ofstream(file_name, std::ios::binary | std::ios::trunc) << "not a partition file";
+  EXPECT_THROW(CellPartition::Load(file_name), std::runtime_error);
+}
+
+TEST(CellPartition, cell_of) {
+  const auto& local = TileHierarchy::levels().back();
+  const valhalla::midgard::PointLL ll(5.1, 52.1);
+  const uint32_t tileid = local.tiles.TileId(ll);
+
+  // local nodes are in the cell of their tile, the others in the cell they are located in
+  EXPECT_EQ(CellPartition::CellOf({tileid, local.level, 12}, ll), tileid);
+  EXPECT_EQ(CellPartition::CellOf({tileid, local.level, 12}, {0, 0}), tileid);
+  const auto& highway = TileHierarchy::levels().front();
+  EXPECT_EQ(CellPartition::CellOf(GraphId(highway.tiles.TileId(ll), highway.level, 3), ll), tileid);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -34,7 +34,6 @@ namespace {
 
 const std::string pbf_file = {VALHALLA_SOURCE_DIR "test/data/harrisburg.osm.pbf"};
 const std::string tile_dir = "test/data/graphbuilder_tiles";
-const size_t id_table_size = 1000;
 
 const std::string access_file = "test_access_harrisburg.bin";
 const std::string bss_file = "test_bss_nodes_harrisburg.bin";
@@ -116,7 +115,6 @@ public:
   void SetUp() override {
     ptree config;
     config.put<std::string>("mjolnir.tile_dir", tile_dir);
-    config.put<size_t>("mjolnir.id_table_size", id_table_size);
     const auto& mjolnir_config = config.get_child("mjolnir");
     const std::vector<std::string>& input_files = {pbf_file};
     OSMData osmdata = PBFGraphParser::ParseWays(mjolnir_config, input_files, ways_file,
@@ -1,7 +1,10 @@
+#include "baldr/datetime.h"
 #include "baldr/directededge.h"
 #include "baldr/graphid.h"
 #include "baldr/graphreader.h"
+#include "baldr/graphtile.h"
 #include "baldr/rapidjson_utils.h"
+#include "baldr/tilehierarchy.h"
 #include "filesystem.h"
 #include "loki/worker.h"
 #include "midgard/constants.h"
@@ -9,8 +12,10 @@
 #include "midgard/logging.h"
 #include "midgard/pointll.h"
 #include "midgard/util.h"
+#include "mjolnir/converttransit.h"
 #include "mjolnir/util.h"
 #include "odin/worker.h"
+#include "proto/transit.pb.h"
 #include "proto/trip.pb.h"
 #include "thor/worker.h"
 #include "tyr/actor.h"
@@ -397,6 +402,86 @@ inline void build_pbf(const nodelayout& node_locations,
   writer.close();
 }
 
+void build_transit_pbf(const nodelayout& node_locations,
+                       const transit::feed& feed,
+                       const std::string& transit_dir) {
+  const auto tile_id = baldr::TileHierarchy::GetGraphId(node_locations.at(feed.stations.front()),
+                                                        baldr::TileHierarchy::levels().back().level);
+  auto node_id = [&tile_id](uint32_t index) {
+    return baldr::GraphId(tile_id.tileid(), tile_id.level(), index).value;
+  };
+
+  // each station is an egress, the station and its platform in that order
+  mjolnir::Transit transit;
+  std::unordered_map<std::string, uint64_t> platforms;
+  for (const auto& station : feed.stations) {
+    const auto& ll = node_locations.at(station);
+    if (baldr::TileHierarchy::GetGraphId(ll, tile_id.level()) != tile_id) {
+      throw std::runtime_error("Transit station " + station + " is not in the first one's tile");
+    }
+    for (const auto type : {baldr::NodeType::kTransitEgress, baldr::NodeType::kTransitStation,
+                            baldr::NodeType::kMultiUseTransitPlatform}) {
+      const uint32_t index = transit.nodes_size();
+      auto* node = transit.add_nodes();
+      node->set_lon(ll.lng());
+      node->set_lat(ll.lat());
+      node->set_type(static_cast<uint32_t>(type));
+      node->set_graphid(node_id(index));
+      // egresses point to their station, stations to their egress and platforms to their station
+      node->set_prev_type_graphid(
+          node_id(type == baldr::NodeType::kTransitEgress ? index + 1 : index - 1));
+      node->set_name(station);
+      node->set_onestop_id("s-" + station + "-" + std::to_string(index));
+      node->set_timezone("America/New_York");
+      node->set_wheelchair_boarding(true);
+      node->set_traversability(static_cast<uint32_t>(baldr::Traversability::kBoth));
+    }
+    platforms[station] = node_id(transit.nodes_size() - 1);
+  }
+
+  for (const auto type : feed.routes) {
+    auto* route = transit.add_routes();
+    route->set_name("route " + std::to_string(transit.routes_size()));
+    route->set_onestop_id("r-" + std::to_string(transit.routes_size()));
+    route->set_vehicle_type(static_cast<mjolnir::Transit::VehicleType>(type));
+  }
+
+  // the tiles are dated the day they are converted
+  const auto* tz = baldr::DateTime::get_tz_db().from_index(
+      baldr::DateTime::get_tz_db().to_index("America/New_York"));
+  const uint32_t today = baldr::DateTime::days_from_pivot_date(
+      baldr::DateTime::get_formatted_date(baldr::DateTime::iso_date_time(tz)));
+  for (const auto& pair : feed.stop_pairs) {
+    auto* stop_pair = transit.add_stop_pairs();
+    stop_pair->set_trip_id(pair.trip);
+    stop_pair->set_route_index(pair.route);
+    stop_pair->set_block_id(0);
+    stop_pair->set_origin_graphid(platforms.at(pair.origin));
+    stop_pair->set_origin_onestop_id("s-" + pair.origin);
+    stop_pair->set_destination_graphid(platforms.at(pair.destination));
+    stop_pair->set_destination_onestop_id("s-" + pair.destination);
+    stop_pair->set_origin_departure_time(pair.departure);
+    stop_pair->set_destination_arrival_time(pair.arrival);
+    stop_pair->set_service_start_date(today - 1);
+    stop_pair->set_service_end_date(today + 30);
+    for (int i = 0; i < 7; ++i) {
+      stop_pair->add_service_days_of_week(true);
+    }
+    stop_pair->set_bikes_allowed(true);
+    stop_pair->set_wheelchair_accessible(true);
+    stop_pair->set_trip_headsign(pair.destination);
+  }
+
+  auto suffix = baldr::GraphTile::FileSuffix(tile_id);
+  filesystem::path file_name(transit_dir + filesystem::path::preferred_separator +
+                             suffix.substr(0, suffix.size() - 3) + "pbf");
+  filesystem::create_directories(file_name.parent_path());
+  std::ofstream file(file_name.string(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!transit.SerializeToOstream(&file)) {
+    throw std::runtime_error("Could not write " + file_name.string());
+  }
+}
+
 std::string
 to_string(const ::google::protobuf::RepeatedPtrField<::valhalla::StreetName>& street_names) {
   std::string str;
@@ -449,7 +534,16 @@ map buildtiles(const nodelayout& layout,
                const relations& relations,
                const std::string& workdir,
                const std::unordered_map<std::string, std::string>& config_options) {
+  return buildtiles(layout, ways, nodes, relations, transit::feed{}, workdir, config_options);
+}
 
+map buildtiles(const nodelayout& layout,
+               const ways& ways,
+               const nodes& nodes,
+               const relations& relations,
+               const transit::feed& feed,
+               const std::string& workdir,
+               const std::unordered_map<std::string, std::string>& config_options) {
   map result;
   result.config = test::make_config(workdir, config_options);
   result.nodes = layout;
@@ -470,6 +564,16 @@ map buildtiles(const nodelayout& layout,
             << std::endl;
   midgard::logging::Configure({{"type", ""}});
 
+  // the transit tiles are converted first so building the tiles connects them to the roads
+  if (!feed.stations.empty()) {
+    const auto transit_dir = result.config.get<std::string>("mjolnir.transit_dir");
+    std::cerr << "[          ] converting transit in " << transit_dir << std::endl;
+    detail::build_transit_pbf(result.nodes, feed, transit_dir);
+    auto transit_config = result.config;
+    transit_config.put("mjolnir.tile_dir", transit_dir);
+    mjolnir::ConvertTransit::Build(transit_config);
+  }
+
   mjolnir::build_tile_set(result.config, {pbf_filename}, mjolnir::BuildStage::kInitialize,
                           mjolnir::BuildStage::kValidate, false);
 
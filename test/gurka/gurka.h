@@ -9,6 +9,7 @@
  *   4. Verify the expected route
  ******************************************************************************/
 #include "baldr/directededge.h"
+#include "baldr/graphconstants.h"
 #include "baldr/graphid.h"
 #include "baldr/graphreader.h"
 #include "baldr/rapidjson_utils.h"
@@ -68,6 +69,27 @@ struct relation {
 
 using relations = std::vector<relation>;
 
+namespace transit {
+
+// a trip from one station to the next, the times are seconds from midnight
+struct stop_pair {
+  uint32_t trip;
+  uint32_t route;
+  std::string origin;
+  uint32_t departure;
+  std::string destination;
+  uint32_t arrival;
+};
+
+// the stations are at nodes of the layout and each has one egress and one platform there
+struct feed {
+  std::vector<std::string> stations;
+  std::vector<baldr::TransitType> routes;
+  std::vector<stop_pair> stop_pairs;
+};
+
+} // namespace transit
+
 namespace detail {
 
 /**
@@ -91,6 +113,18 @@ void build_pbf(const nodelayout& node_locations,
                const std::string& filename,
                const uint64_t initial_osm_id = 0);
 
+/**
+ * Writes a transit feed to a transit pbf tile, like the transit fetcher does. The schedules run
+ * every day for a month from the day before today.
+ *
+ * @param node_locations the locations of the stations
+ * @param feed the stations, routes and trips, the stations all have to be in one tile
+ * @param transit_dir where the transit pbf tiles go
+ */
+void build_transit_pbf(const nodelayout& node_locations,
+                       const transit::feed& feed,
+                       const std::string& transit_dir);
+
 /**
  * Extract list of edge names from route result.
  * @param result the result of a /route or /match request
@@ -122,6 +156,28 @@ map buildtiles(const nodelayout& layout,
                const std::unordered_map<std::string, std::string>& config_options = {
                    {"mjolnir.concurrency", "1"}});
 
+/**
+ * Like the above but converts a transit feed into transit tiles before building the tiles, so
+ * the transit stage connects the stations to the closest roads.
+ *
+ * @param layout the locations of all the nodes
+ * @param ways the way definitions (which nodes are connected, and their properties
+ * @param nodes properties on any of the defined nodes
+ * @param relations OSM relations that related nodes and ways together
+ * @param feed the stations, routes and trips of the transit
+ * @param workdir where to build the PBF and the tiles
+ * @param config_options optional key value pairs to put into the config
+ * @return a map object that contains the Valhalla config and node layout
+ */
+map buildtiles(const nodelayout& layout,
+               const ways& ways,
+               const nodes& nodes,
+               const relations& relations,
+               const transit::feed& feed,
+               const std::string& workdir,
+               const std::unordered_map<std::string, std::string>& config_options = {
+                   {"mjolnir.concurrency", "1"}});
+
 /**
  * Finds a directed edge in the generated map.  Helpful because the IDs assigned
  * to edges depends on the shape of the map.
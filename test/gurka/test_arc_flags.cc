@@ -0,0 +1,155 @@
+#include "gurka.h"
+#include "baldr/arcflags.h"
+#include "loki/worker.h"
+#include "mjolnir/arcflagbuilder.h"
+#include "sif/costfactory.h"
+#include "thor/bidirectional_astar.h"
+
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+using namespace valhalla;
+
+class ArcFlagPruning : public ::testing::Test {
+protected:
+  static gurka::map map;
+  static std::shared_ptr<const baldr::ArcFlags> arc_flags;
+
+  static void SetUpTestSuite() {
+    // a grid of highway and arterial roads, big enough to cover many regions, with a oneway and
+    // turn restrictions so the costs depend on more than the distance. The fast local road from P
+    // to T is cheaper than the slow arterial one, and one of the restrictions is over a via way
+    const std::string ascii_map = R"(
+      A-----B-----C-----D-----E
+      |     |     |     |     |
+      F-----G-----H-----I-----J
+      |     |     |     |     |
+      K-----L-----M-----N-----O
+      |     |     |     |     |
+      P-----Q-----R-----S-----T
+      |     |  Z  |     |     |
+      U-----V-----W-----X-----Y
+    )";
+    const gurka::ways ways = {
+        {"ABC", {{"highway", "primary"}}},
+        {"CDE", {{"highway", "primary"}}},
+        {"FGH", {{"highway", "secondary"}, {"oneway", "yes"}}},
+        {"HIJ", {{"highway", "secondary"}, {"oneway", "yes"}}},
+        {"KLMNO", {{"highway", "primary"}}},
+        {"PQRST", {{"highway", "tertiary"}, {"maxspeed", "40"}}},
+        {"UVWXY", {{"highway", "secondary"}}},
+        {"AFKPU", {{"highway", "secondary"}}},
+        {"BGLQV", {{"highway", "tertiary"}}},
+        {"CH", {{"highway", "primary"}}},
+        {"HMRW", {{"highway", "primary"}}},
+        {"DINSX", {{"highway", "secondary"}}},
+        {"EJOTY", {{"highway", "tertiary"}}},
+        {"PZT", {{"highway", "residential"}, {"maxspeed", "100"}}},
+    };
+    const gurka::relations relations = {
+        {{
+             {gurka::way_member, "KLMNO", "from"},
+             {gurka::way_member, "HMRW", "to"},
+             {gurka::node_member, "M", "via"},
+         },
+         {
+             {"type", "restriction"},
+             {"restriction", "no_left_turn"},
+         }},
+        {{
+             {gurka::way_member, "ABC", "from"},
+             {gurka::way_member, "CH", "via"},
+             {gurka::way_member, "HIJ", "to"},
+         },
+         {
+             {"type", "restriction"},
+             {"restriction", "no_left_turn"},
+         }},
+    };
+    const auto layout = gurka::detail::map_to_coordinates(ascii_map, 2000);
+    map = gurka::buildtiles(layout, ways, {}, relations, "test/data/gurka_arc_flags");
+    map.config.put("mjolnir.arc_flags_file", "test/data/gurka_arc_flags/arc_flags.bin");
+    mjolnir::ArcFlagBuilder::Build(map.config);
+    arc_flags = std::make_shared<const baldr::ArcFlags>(
+        baldr::ArcFlags::Load(map.config.get<std::string>("mjolnir.arc_flags_file")));
+  }
+
+  // the path bidirectional a* finds with or without pruning, counting the edges it settles
+  std::vector<thor::PathInfo> route(const std::string& from,
+                                    const std::string& to,
+                                    const bool prune,
+                                    const std::string& extra_json,
+                                    size_t& settled) {
+    const auto& origin = map.nodes.at(from);
+    const auto& destination = map.nodes.at(to);
+    Api api;
+    ParseApi(R"({"locations":[{"lat":)" + std::to_string(origin.lat()) + R"(,"lon":)" +
+                 std::to_string(origin.lng()) + R"(},{"lat":)" +
+                 std::to_string(destination.lat()) + R"(,"lon":)" +
+                 std::to_string(destination.lng()) + R"(}],"costing":"auto")" + extra_json + "}",
+             Options::route, api);
+    loki::loki_worker_t(map.config).route(api);
+
+    auto& options = *api.mutable_options();
+    sif::TravelMode mode;
+    auto mode_costing = sif::CostFactory().CreateModeCosting(options, mode);
+    baldr::GraphReader reader(map.config.get_child("mjolnir"));
+    thor::BidirectionalAStar astar(map.config.get_child("thor"));
+    // a small radius around the ends leaves the regions in between to prune with
+    if (prune) {
+      astar.set_arc_flags(arc_flags, 100.0f);
+    }
+    astar.set_track_expansion([&settled](baldr::GraphReader&, const char*, baldr::GraphId,
+                                         const char* status, bool) {
+      settled += std::strcmp(status, "s") == 0;
+    });
+    auto paths = astar.GetBestPath(*options.mutable_locations(0), *options.mutable_locations(1),
+                                   reader, mode_costing, mode, options);
+    EXPECT_EQ(paths.size(), 1) << from << " to " << to;
+    return paths.empty() ? std::vector<thor::PathInfo>{} : paths.front();
+  }
+
+  // routes between all the pairs of some nodes with and without pruning and expects the same costs,
+  // returns how many edges were settled with and without pruning
+  std::pair<size_t, size_t> expect_same_costs(const std::string& extra_json = "") {
+    size_t settled = 0, pruned_settled = 0;
+    const std::string nodes = "ACEGIKMOPSTUWY";
+    for (const char from : nodes) {
+      for (const char to : nodes) {
+        if (from == to) {
+          continue;
+        }
+        const auto expected = route({from}, {to}, false, extra_json, settled);
+        const auto actual = route({from}, {to}, true, extra_json, pruned_settled);
+        if (expected.empty() || actual.empty()) {
+          continue;
+        }
+        EXPECT_NEAR(actual.back().elapsed_cost.cost, expected.back().elapsed_cost.cost, 0.01)
+            << from << " to " << to;
+        EXPECT_NEAR(actual.back().elapsed_cost.secs, expected.back().elapsed_cost.secs, 0.01)
+            << from << " to " << to;
+      }
+    }
+    return {settled, pruned_settled};
+  }
+};
+
+gurka::map ArcFlagPruning::map = {};
+std::shared_ptr<const baldr::ArcFlags> ArcFlagPruning::arc_flags = {};
+
+TEST_F(ArcFlagPruning, same_costs_with_default_options) {
+  const auto settled = expect_same_costs();
+  // the flags are for these options so pruning has to skip some edges
+  EXPECT_LT(settled.second, settled.first);
+}
+
+TEST_F(ArcFlagPruning, not_pruned_with_other_options) {
+  const auto settled = expect_same_costs(R"(,"costing_options":{"auto":{"use_highways":0.1}})");
+  EXPECT_EQ(settled.second, settled.first);
+}
+
+TEST_F(ArcFlagPruning, not_pruned_when_time_dependent) {
+  const auto settled = expect_same_costs(R"(,"date_time":{"type":1,"value":"2021-08-03T08:00"})");
+  EXPECT_EQ(settled.second, settled.first);
+}
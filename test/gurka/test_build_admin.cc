@@ -182,7 +182,6 @@ TEST(AdminTest, TestBuildAdminFromPBF) {
 
   boost::property_tree::ptree& pt = admin_map.config;
   pt.put("mjolnir.concurrency", 1);
-  pt.put("mjolnir.id_table_size", 1000);
   pt.put("mjolnir.tile_dir", workdir + "/tiles");
   pt.put("mjolnir.admin", workdir + "/admin.sqlite");
   pt.put("mjolnir.timezone", workdir + "/not_needed.sqlite");
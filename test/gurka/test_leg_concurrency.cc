@@ -0,0 +1,73 @@
+#include "gurka.h"
+
+#include <gtest/gtest.h>
+
+using namespace valhalla;
+
+class LegConcurrency : public ::testing::Test {
+protected:
+  static gurka::map map;
+
+  static void SetUpTestSuite() {
+    // a grid of different kinds of roads so the legs have more than one way to go
+    const std::string ascii_map = R"(
+      A-----B-----C-----D
+      |     |     |     |
+      E-----F-----G-----H
+      |     |     |     |
+      I-----J-----K-----L
+    )";
+    const gurka::ways ways = {
+        {"ABCD", {{"highway", "primary"}}},     {"EFGH", {{"highway", "residential"}}},
+        {"IJKL", {{"highway", "secondary"}}},   {"AEI", {{"highway", "tertiary"}}},
+        {"BFJ", {{"highway", "residential"}}},  {"CGK", {{"highway", "unclassified"}}},
+        {"DHL", {{"highway", "tertiary"}}},
+    };
+    const auto layout = gurka::detail::map_to_coordinates(ascii_map, 100);
+    map = gurka::buildtiles(layout, ways, {}, {}, "test/data/gurka_leg_concurrency",
+                            {{"mjolnir.global_synchronized_cache", "true"}});
+  }
+
+  // routes once with the legs one after the other and once with them computed concurrently
+  void expect_same_legs(const std::unordered_map<std::string, std::string>& options = {}) {
+    const std::vector<std::string> waypoints{"A", "G", "L", "E", "C", "J"};
+    auto sequential = gurka::do_action(Options::route, map, waypoints, "auto", options);
+
+    auto parallel_map = map;
+    parallel_map.config.put("thor.leg_concurrency", 3);
+    auto parallel = gurka::do_action(Options::route, parallel_map, waypoints, "auto", options);
+
+    ASSERT_EQ(sequential.trip().routes_size(), 1);
+    ASSERT_EQ(parallel.trip().routes_size(), 1);
+    const auto& expected = sequential.trip().routes(0);
+    const auto& actual = parallel.trip().routes(0);
+    ASSERT_EQ(expected.legs_size(), static_cast<int>(waypoints.size()) - 1);
+    ASSERT_EQ(actual.legs_size(), expected.legs_size());
+    for (int i = 0; i < expected.legs_size(); ++i) {
+      const auto& expected_leg = expected.legs(i);
+      const auto& actual_leg = actual.legs(i);
+      EXPECT_EQ(actual_leg.shape(), expected_leg.shape()) << "leg " << i;
+      ASSERT_EQ(actual_leg.location_size(), expected_leg.location_size());
+      for (int j = 0; j < expected_leg.location_size(); ++j) {
+        EXPECT_EQ(actual_leg.location(j).date_time(), expected_leg.location(j).date_time())
+            << "leg " << i << " location " << j;
+      }
+      ASSERT_EQ(actual_leg.node_size(), expected_leg.node_size()) << "leg " << i;
+      const auto& expected_cost = expected_leg.node().rbegin()->cost().elapsed_cost();
+      const auto& actual_cost = actual_leg.node().rbegin()->cost().elapsed_cost();
+      EXPECT_EQ(actual_cost.seconds(), expected_cost.seconds()) << "leg " << i;
+      EXPECT_EQ(actual_cost.cost(), expected_cost.cost()) << "leg " << i;
+    }
+  }
+};
+
+gurka::map LegConcurrency::map = {};
+
+TEST_F(LegConcurrency, same_as_sequential) {
+  expect_same_legs();
+}
+
+TEST_F(LegConcurrency, same_as_sequential_depart_at) {
+  // each leg departs when the one before it arrives
+  expect_same_legs({{"/date_time/type", "1"}, {"/date_time/value", "2020-10-30T09:00"}});
+}
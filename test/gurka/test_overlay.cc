@@ -0,0 +1,182 @@
+#include "gurka.h"
+#include "baldr/tilehierarchy.h"
+#include "loki/worker.h"
+#include "mjolnir/partitionbuilder.h"
+#include "sif/costfactory.h"
+#include "thor/bidirectional_astar.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+using namespace valhalla;
+
+class Overlay : public ::testing::Test {
+protected:
+  static gurka::map map;
+  static std::shared_ptr<thor::overlay_t> overlay;
+
+  static void SetUpTestSuite() {
+    // two roads, one above the other, that each cross three cells: the lower one can jump across
+    // its middle cell, the upper one cant go straight on at D after coming from A over the
+    // boundary. The side streets make nodes of R, S, P and Q so the end edges stay in the end cells
+    const std::string ascii_map = R"(
+      A-------------------R---------C---D---------------E------S--B
+                          T             |               |      U
+                                        F---------------G
+
+      H-------------------P---------J---K---------------L------Q--I
+                          V             |               |      W
+                                        M---------------N
+    )";
+    const gurka::ways ways = {
+        {"ARC", {{"highway", "residential"}}},     {"CD", {{"highway", "residential"}}},
+        {"DE", {{"highway", "residential"}}},      {"ESB", {{"highway", "residential"}}},
+        {"DFGE", {{"highway", "residential"}}},    {"HPJKLQI", {{"highway", "residential"}}},
+        {"KMNL", {{"highway", "residential"}}},    {"RT", {{"highway", "residential"}}},
+        {"SU", {{"highway", "residential"}}},      {"PV", {{"highway", "residential"}}},
+        {"QW", {{"highway", "residential"}}},
+    };
+    const gurka::relations relations = {
+        {{
+             {gurka::way_member, "ARC", "from"},
+             {gurka::way_member, "CD", "via"},
+             {gurka::way_member, "DE", "to"},
+         },
+         {
+             {"type", "restriction"},
+             {"restriction", "no_straight_on"},
+         }},
+    };
+
+    // the cells are the local tiles so the grid is big enough for the roads to cross them, the
+    // upper road is in the row of tiles above the lower one
+    const auto layout = gurka::detail::map_to_coordinates(ascii_map, 1000, {0.01, 0.275});
+    map = gurka::buildtiles(layout, ways, {}, relations, "test/data/gurka_overlay");
+    map.config.put("mjolnir.partition_file", "test/data/gurka_overlay/partition.bin");
+    mjolnir::PartitionBuilder::Build(map.config);
+    overlay = std::make_shared<thor::overlay_t>(map.config);
+    ASSERT_NE(wait_for_metric(make_request("A", "B").options()), nullptr);
+  }
+
+  // a route request between two nodes of the map with its locations found
+  static Api make_request(const std::string& from, const std::string& to) {
+    const auto& origin = map.nodes.at(from);
+    const auto& destination = map.nodes.at(to);
+    Api api;
+    ParseApi(R"({"locations":[{"lat":)" + std::to_string(origin.lat()) + R"(,"lon":)" +
+                 std::to_string(origin.lng()) + R"(},{"lat":)" +
+                 std::to_string(destination.lat()) + R"(,"lon":)" +
+                 std::to_string(destination.lng()) + R"(}],"costing":"auto"})",
+             Options::route, api);
+    loki::loki_worker_t(map.config).route(api);
+    return api;
+  }
+
+  // metrics are customized in the background, asking for one the first time only starts that
+  static std::shared_ptr<const thor::overlay_t::metric_t> wait_for_metric(const Options& options) {
+    for (size_t i = 0; i < 600; ++i) {
+      auto metric = overlay->GetMetric(options);
+      if (metric) {
+        return metric;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return nullptr;
+  }
+
+  // whether the way through a cell from the edge of one way to the edge of another is restricted
+  bool restricted(const std::shared_ptr<const thor::overlay_t::metric_t>& metric,
+                  const std::string& entry_way,
+                  const std::string& entry_node,
+                  const std::string& exit_way,
+                  const std::string& exit_node) {
+    baldr::GraphReader reader(map.config.get_child("mjolnir"));
+    const auto entry = std::get<0>(gurka::findEdge(reader, map.nodes, entry_way, entry_node));
+    const auto exit = std::get<0>(gurka::findEdge(reader, map.nodes, exit_way, exit_node));
+    uint32_t cell, entry_index, exit_cell, exit_index;
+    EXPECT_TRUE(overlay->partition().FindEntry(entry, cell, entry_index));
+    EXPECT_TRUE(overlay->partition().FindExit(exit, exit_cell, exit_index));
+    EXPECT_EQ(cell, exit_cell);
+    return metric->restricted(cell, entry_index, exit_index);
+  }
+
+  // the path bidirectional a* finds with or without the overlay
+  std::vector<thor::PathInfo>
+  route(const std::string& from, const std::string& to, bool use_overlay) {
+    auto api = make_request(from, to);
+    auto& options = *api.mutable_options();
+    sif::TravelMode mode;
+    auto mode_costing = sif::CostFactory().CreateModeCosting(options, mode);
+    baldr::GraphReader reader(map.config.get_child("mjolnir"));
+    thor::BidirectionalAStar astar(map.config.get_child("thor"));
+    if (use_overlay) {
+      astar.set_overlay(overlay);
+    }
+    auto paths = astar.GetBestPath(*options.mutable_locations(0), *options.mutable_locations(1),
+                                   reader, mode_costing, mode, options);
+    EXPECT_EQ(paths.size(), 1);
+    return paths.empty() ? std::vector<thor::PathInfo>{} : paths.front();
+  }
+
+  // routes with and without the overlay and expects the same edges at the same cost
+  std::vector<baldr::GraphId> expect_same_path(const std::string& from, const std::string& to) {
+    const auto expected = route(from, to, false);
+    const auto actual = route(from, to, true);
+    std::vector<baldr::GraphId> expected_edges, actual_edges;
+    for (const auto& info : expected) {
+      expected_edges.push_back(info.edgeid);
+    }
+    for (const auto& info : actual) {
+      actual_edges.push_back(info.edgeid);
+    }
+    EXPECT_EQ(actual_edges, expected_edges) << from << " to " << to;
+    if (!expected.empty() && !actual.empty()) {
+      EXPECT_NEAR(actual.back().elapsed_cost.cost, expected.back().elapsed_cost.cost, 0.1);
+      EXPECT_NEAR(actual.back().elapsed_cost.secs, expected.back().elapsed_cost.secs, 0.1);
+    }
+    return actual_edges;
+  }
+
+  // the index in the partition of the cell a node of the map is in, the cells are the local tiles
+  uint32_t cell_of(const std::string& node) {
+    const auto& local = baldr::TileHierarchy::levels().back();
+    return overlay->partition().Find(local.tiles.TileId(map.nodes.at(node)));
+  }
+};
+
+gurka::map Overlay::map = {};
+std::shared_ptr<thor::overlay_t> Overlay::overlay = {};
+
+TEST_F(Overlay, ways_with_restrictions_are_not_jumped) {
+  const auto metric = wait_for_metric(make_request("A", "B").options());
+  ASSERT_NE(metric, nullptr);
+  // only the way the restriction is on, the other way through the same cell is still jumped
+  EXPECT_TRUE(restricted(metric, "ARC", "C", "ESB", "S"));
+  EXPECT_FALSE(restricted(metric, "ESB", "E", "ARC", "R"));
+  EXPECT_FALSE(restricted(metric, "HPJKLQI", "J", "HPJKLQI", "Q"));
+  EXPECT_NE(cell_of("D"), cell_of("K"));
+}
+
+TEST_F(Overlay, only_configured_costings) {
+  auto api = make_request("A", "B");
+  api.mutable_options()->set_costing(Costing::pedestrian);
+  EXPECT_EQ(overlay->GetMetric(api.options()), nullptr);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(overlay->GetMetric(api.options()), nullptr);
+}
+
+TEST_F(Overlay, same_as_bidirectional_astar) {
+  expect_same_path("H", "I");
+  expect_same_path("I", "H");
+  expect_same_path("B", "A");
+}
+
+TEST_F(Overlay, restriction_across_cell_boundary) {
+  // coming from the cell before, the restriction at D sends both searches around F and G
+  const auto edges = expect_same_path("A", "B");
+  baldr::GraphReader reader(map.config.get_child("mjolnir"));
+  const auto detour = gurka::findEdge(reader, map.nodes, "DFGE", "E");
+  EXPECT_NE(std::find(edges.begin(), edges.end(), std::get<0>(detour)), edges.end());
+}
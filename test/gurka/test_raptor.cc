@@ -0,0 +1,141 @@
+#include "gurka.h"
+#include "mjolnir/servicedays.h"
+
+#include <gtest/gtest.h>
+
+using namespace valhalla;
+using namespace valhalla::baldr;
+
+namespace {
+
+// seconds from midnight of some minutes after 8am
+uint32_t at(uint32_t minutes) {
+  return (8 * 60 + minutes) * 60;
+}
+
+// a rail line from p to r and a bus line from r to s, each runs twice half an hour apart
+const gurka::transit::feed kFeed = {
+    {"p", "q", "r", "s"},
+    {TransitType::kRail, TransitType::kBus},
+    {
+        {1, 0, "p", at(10), "q", at(14)},
+        {1, 0, "q", at(15), "r", at(18)},
+        {11, 0, "p", at(40), "q", at(44)},
+        {11, 0, "q", at(45), "r", at(48)},
+        {2, 1, "r", at(25), "s", at(30)},
+        {12, 1, "r", at(55), "s", at(60)},
+    },
+};
+
+// the trips a route rides, how often it changes between them, the time it arrives at its last
+// stop and the elapsed time at the end
+struct journey_t {
+  std::string shape;
+  std::vector<uint32_t> trips;
+  size_t transfers;
+  std::string arrival;
+  double seconds;
+};
+
+journey_t get_journey(const valhalla::Api& api) {
+  journey_t journey{};
+  EXPECT_EQ(api.trip().routes_size(), 1);
+  EXPECT_EQ(api.trip().routes(0).legs_size(), 1);
+  const auto& leg = api.trip().routes(0).legs(0);
+  journey.shape = leg.shape();
+  journey.seconds = leg.node().rbegin()->cost().elapsed_cost().seconds();
+  bool riding = false;
+  for (const auto& node : leg.node()) {
+    if (node.transit_platform_info().has_arrival_date_time()) {
+      journey.arrival = node.transit_platform_info().arrival_date_time();
+    }
+    const bool transit = node.has_edge() && node.edge().travel_mode() == TripLeg::kTransit;
+    const uint32_t trip = node.edge().transit_route_info().trip_id();
+    if (transit && (!riding || journey.trips.back() != trip)) {
+      journey.trips.push_back(trip);
+    }
+    riding = transit;
+  }
+  journey.transfers = journey.trips.empty() ? 0 : journey.trips.size() - 1;
+  return journey;
+}
+
+} // namespace
+
+class Raptor : public ::testing::Test {
+protected:
+  static gurka::map map;
+  static std::string date;
+
+  static void SetUpTestSuite() {
+    // a main street with a station by each side street
+    const std::string ascii_map = R"(
+           w                   x                   y                   z
+        o  |                   |                 m |                   | n
+      A----b-------------------c-------------------d-------------------e----B
+           p                   q                   r                   s
+    )";
+    const gurka::ways ways = {
+        {"AbcdeB", {{"highway", "residential"}}}, {"bw", {{"highway", "residential"}}},
+        {"cx", {{"highway", "residential"}}},     {"dy", {{"highway", "residential"}}},
+        {"ez", {{"highway", "residential"}}},
+    };
+    const auto layout = gurka::detail::map_to_coordinates(ascii_map, 100, {-73.95, 40.7});
+    map = gurka::buildtiles(layout, ways, {}, {}, kFeed, "test/data/gurka_raptor",
+                            {{"mjolnir.concurrency", "1"},
+                             {"mjolnir.timezone", VALHALLA_BUILD_DIR "test/data/tz.sqlite"}});
+
+    // a day the schedules run on
+    date = mjolnir::get_testing_date_time().substr(0, 10);
+  }
+
+  // routes with raptor and with the multimodal astar and expects the same journey from both
+  journey_t expect_same_journey(const std::vector<std::string>& waypoints,
+                                const std::string& time) {
+    const std::unordered_map<std::string, std::string> options = {{"/date_time/type", "1"},
+                                                                  {"/date_time/value",
+                                                                   date + "T" + time}};
+    auto multimodal = gurka::do_action(Options::route, map, waypoints, "multimodal", options);
+
+    auto raptor_map = map;
+    raptor_map.config.put("thor.multimodal_algorithm", "raptor");
+    auto raptor = gurka::do_action(Options::route, raptor_map, waypoints, "multimodal", options);
+
+    const auto expected = get_journey(multimodal);
+    const auto actual = get_journey(raptor);
+    EXPECT_EQ(actual.shape, expected.shape);
+    EXPECT_EQ(actual.trips, expected.trips);
+    EXPECT_EQ(actual.transfers, expected.transfers);
+    EXPECT_EQ(actual.arrival, expected.arrival);
+    EXPECT_NEAR(actual.seconds, expected.seconds, 1.0);
+    return actual;
+  }
+};
+
+gurka::map Raptor::map = {};
+std::string Raptor::date = {};
+
+TEST_F(Raptor, same_as_multimodal_without_transfers) {
+  const auto journey = expect_same_journey({"o", "m"}, "08:00");
+  EXPECT_EQ(journey.trips, std::vector<uint32_t>({1}));
+  EXPECT_EQ(journey.transfers, 0);
+  ASSERT_GE(journey.arrival.size(), 16);
+  EXPECT_EQ(journey.arrival.substr(11, 5), "08:18");
+}
+
+TEST_F(Raptor, same_as_multimodal_with_a_transfer) {
+  const auto journey = expect_same_journey({"o", "n"}, "08:00");
+  EXPECT_EQ(journey.trips, std::vector<uint32_t>({1, 2}));
+  EXPECT_EQ(journey.transfers, 1);
+  ASSERT_GE(journey.arrival.size(), 16);
+  EXPECT_EQ(journey.arrival.substr(11, 5), "08:30");
+}
+
+TEST_F(Raptor, same_as_multimodal_later_trips) {
+  // the first rail trip leaves before we get to the station
+  const auto journey = expect_same_journey({"o", "n"}, "08:15");
+  EXPECT_EQ(journey.trips, std::vector<uint32_t>({11, 12}));
+  EXPECT_EQ(journey.transfers, 1);
+  ASSERT_GE(journey.arrival.size(), 16);
+  EXPECT_EQ(journey.arrival.substr(11, 5), "09:00");
+}
@@ -180,12 +180,13 @@ struct test_reader : public baldr::GraphReader {
     tile_extract_.reset(new baldr::GraphReader::tile_extract_t(pt));
     enable_incidents_ = true;
   }
-  virtual std::shared_ptr<const valhalla::IncidentsTile>
-  GetIncidentTile(const baldr::GraphId& tile_id) const override {
+  virtual std::shared_ptr<const baldr::IncidentIndex>
+  GetIncidentIndex(const baldr::GraphId& tile_id) const override {
     auto i = incidents.find(tile_id.Tile_Base());
     if (i == incidents.cend())
       return {};
-    return std::shared_ptr<valhalla::IncidentsTile>(&i->second, [](valhalla::IncidentsTile*) {});
+    return std::make_shared<const baldr::IncidentIndex>(
+        std::shared_ptr<valhalla::IncidentsTile>(&i->second, [](valhalla::IncidentsTile*) {}));
   }
   void add(const baldr::GraphId& id,
            valhalla::IncidentsTile::Location&& _incident_location,
@@ -58,6 +58,79 @@ TEST(UnorderedIdTable, SerializeDeserialize) {
   EXPECT_EQ(a, b);
 }
 
+TEST(CompactIdTable, SetGet) {
+  CompactIdTable t(1000);
+  std::unordered_set<uint64_t> ids;
+  for (uint64_t i = 0; i < kTableSize; ++i) {
+    uint64_t r = (static_cast<uint64_t>(rand()) << 16) ^ rand();
+    if (rand() % 2) {
+      ids.emplace(r);
+      t.set(r);
+    }
+  }
+
+  // the ids set so far have to be merged in before the table can be read
+  EXPECT_THROW(t.get(0), std::logic_error);
+  t.finish();
+  EXPECT_EQ(t.size(), ids.size());
+  for (const auto id : ids) {
+    EXPECT_TRUE(t.get(id));
+  }
+  for (uint64_t i = 0; i < kTableSize; ++i) {
+    uint64_t r = (static_cast<uint64_t>(rand()) << 16) ^ rand();
+    EXPECT_EQ(ids.find(r) != ids.end(), t.get(r));
+  }
+}
+
+TEST(CompactIdTable, DenseIndex) {
+  CompactIdTable t;
+  for (uint64_t i = 0; i < kTableSize; ++i) {
+    t.push_back(i * 3 + 7);
+  }
+  t.finish();
+
+  // a copy, gtest takes its arguments by reference and the header only class has no definition
+  const uint64_t npos = CompactIdTable::npos;
+  EXPECT_EQ(t.size(), kTableSize);
+  EXPECT_EQ(t.index(0), npos);
+  for (uint64_t i = 0; i < kTableSize; ++i) {
+    EXPECT_EQ(t.index(i * 3 + 7), i);
+    EXPECT_EQ(t.index(i * 3 + 8), npos);
+  }
+
+  uint64_t expected = 7;
+  t.for_each([&expected](uint64_t id) {
+    EXPECT_EQ(id, expected);
+    expected += 3;
+  });
+
+  EXPECT_THROW(t.push_back(5), std::logic_error);
+}
+
+TEST(CompactIdTable, SerializeMap) {
+  CompactIdTable a;
+  for (uint64_t i = 0; i < kTableSize; ++i) {
+    a.set(i * i);
+  }
+  a.finish();
+  ASSERT_TRUE(a.serialize("compact.bar"));
+
+  CompactIdTable b;
+  ASSERT_TRUE(b.deserialize("compact.bar"));
+  EXPECT_EQ(a, b);
+
+  CompactIdTable c;
+  ASSERT_TRUE(c.map("compact.bar"));
+  EXPECT_EQ(a, c);
+  for (uint64_t i = 0; i < kTableSize; ++i) {
+    EXPECT_TRUE(c.get(i * i));
+    EXPECT_EQ(c.index(i * i), i);
+  }
+
+  // compact tables are much smaller than the raw ids
+  EXPECT_LT(a.encoded_size(), kTableSize * sizeof(uint64_t) / 2);
+}
+
 int main(int argc, char* argv[]) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,93 @@
+#include "baldr/incidentindex.h"
+
+#include "test.h"
+
+using namespace valhalla;
+using namespace valhalla::baldr;
+
+namespace {
+
+void add_location(IncidentsTile& tile, uint32_t edge_index, uint32_t metadata_index) {
+  auto* location = tile.mutable_locations()->Add();
+  location->set_edge_index(edge_index);
+  location->set_start_offset(0);
+  location->set_end_offset(1);
+  location->set_metadata_index(metadata_index);
+}
+
+std::shared_ptr<const IncidentsTile> make_tile() {
+  auto tile = std::make_shared<IncidentsTile>();
+  tile->mutable_metadata()->Add()->set_id(1);
+  auto* closure = tile->mutable_metadata()->Add();
+  closure->set_id(2);
+  closure->set_road_closed(true);
+
+  // edge 3 has one incident, edge 7 has three and one of them closes the road, edge 12 points at
+  // metadata that doesnt exist
+  add_location(*tile, 3, 0);
+  add_location(*tile, 7, 0);
+  add_location(*tile, 7, 1);
+  add_location(*tile, 7, 0);
+  add_location(*tile, 12, 5);
+  return tile;
+}
+
+TEST(IncidentIndex, find) {
+  IncidentIndex index(make_tile());
+  EXPECT_EQ(index.size(), 3);
+  EXPECT_EQ(index.find(3), std::make_pair(0, 1));
+  EXPECT_EQ(index.find(7), std::make_pair(1, 4));
+  EXPECT_EQ(index.find(12), std::make_pair(4, 5));
+
+  // before, between and after the edges with incidents
+  for (uint32_t edge_index : {0, 4, 8, 13, 2000000}) {
+    auto range = index.find(edge_index);
+    EXPECT_EQ(range.first, range.second) << " edge " << edge_index << " has no incidents";
+  }
+}
+
+TEST(IncidentIndex, closed) {
+  IncidentIndex index(make_tile());
+  EXPECT_FALSE(index.closed(3));
+  EXPECT_TRUE(index.closed(7));
+  EXPECT_FALSE(index.closed(12));
+  EXPECT_FALSE(index.closed(0));
+  EXPECT_FALSE(index.closed(100));
+}
+
+TEST(IncidentIndex, sorting) {
+  IncidentsTile tile;
+  add_location(tile, 9, 0);
+  add_location(tile, 2, 1);
+  add_location(tile, 9, 2);
+  add_location(tile, 2, 3);
+  EXPECT_THROW(IncidentIndex(std::make_shared<const IncidentsTile>(tile)), std::runtime_error);
+
+  // sorting keeps the order of the locations on each edge
+  EXPECT_TRUE(IncidentIndex::sort_locations(tile));
+  EXPECT_FALSE(IncidentIndex::sort_locations(tile));
+  std::vector<uint32_t> metadata;
+  for (const auto& location : tile.locations()) {
+    metadata.push_back(location.metadata_index());
+  }
+  EXPECT_EQ(metadata, (std::vector<uint32_t>{1, 3, 0, 2}));
+
+  IncidentIndex index(std::make_shared<const IncidentsTile>(tile));
+  EXPECT_EQ(index.find(2), std::make_pair(0, 2));
+  EXPECT_EQ(index.find(9), std::make_pair(2, 4));
+}
+
+TEST(IncidentIndex, empty) {
+  IncidentIndex index(std::make_shared<const IncidentsTile>());
+  EXPECT_EQ(index.size(), 0);
+  EXPECT_EQ(index.find(0), std::make_pair(0, 0));
+  EXPECT_FALSE(index.closed(0));
+  EXPECT_THROW(IncidentIndex(nullptr), std::invalid_argument);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -85,7 +85,7 @@ TEST_F(incident_loading, update_tile) {
   ASSERT_TRUE(state->cache.find(baldr::GraphId(0))->second == nullptr) << " tile should be null";
 
   // slot exists already
-  std::shared_ptr<const IncidentsTile> tile{new IncidentsTile()};
+  auto tile = std::make_shared<const baldr::IncidentIndex>(std::make_shared<const IncidentsTile>());
   ASSERT_TRUE(testable_singleton::update_tile(state, baldr::GraphId(0), std::move(tile)))
       << " unable to update existing tile";
   ASSERT_TRUE(state->cache.count(baldr::GraphId(0))) << " cannot find updated tile in cache";
@@ -120,16 +120,25 @@ TEST_F(incident_loading, watch) {
   // both configs
   auto log_path = scratch_dir + "log";
   for (const auto& conf :
-       std::vector<std::tuple<std::string, std::string, std::unordered_set<baldr::GraphId>>>{
-           {"incident_dir", scratch_dir, {}},
-           {"incident_log", log_path, {}},
-           {"incident_dir", scratch_dir, {baldr::GraphId{11, 1, 0}, baldr::GraphId{66, 2, 0}}},
-           {"incident_log", log_path, {baldr::GraphId{11, 1, 0}, baldr::GraphId{66, 2, 0}}},
+       std::vector<std::tuple<std::string, std::string, std::unordered_set<baldr::GraphId>, bool>>{
+           {"incident_dir", scratch_dir, {}, true},
+           {"incident_dir", scratch_dir, {}, false},
+           {"incident_log", log_path, {}, false},
+           {"incident_dir",
+            scratch_dir,
+            {baldr::GraphId{11, 1, 0}, baldr::GraphId{66, 2, 0}},
+            true},
+           {"incident_dir",
+            scratch_dir,
+            {baldr::GraphId{11, 1, 0}, baldr::GraphId{66, 2, 0}},
+            false},
+           {"incident_log", log_path, {baldr::GraphId{11, 1, 0}, baldr::GraphId{66, 2, 0}}, false},
        }) {
     // build config
     boost::property_tree::ptree config;
     config.put(std::get<0>(conf), std::get<1>(conf));
     config.put("incident_max_loading_latency", 0);
+    config.put("incident_dir_notify", std::get<3>(conf));
 
     // map a log file
     baldr::GraphId snake_eyes{11, 1, 0};
@@ -186,7 +195,7 @@ TEST_F(incident_loading, watch) {
           EXPECT_EQ(state->cache.size(), tileset.empty() ? 1 : 2) << " wrong number of cache entries";
           EXPECT_EQ(state->cache.count(snake_eyes), 1) << " there should be one tile in here now";
           EXPECT_TRUE(state->cache[snake_eyes]) << " the tile pointer should be non null";
-          EXPECT_TRUE(test::pbf_equals(snake_eyes_tile, *state->cache[snake_eyes]))
+          EXPECT_TRUE(test::pbf_equals(snake_eyes_tile, *state->cache[snake_eyes]->tile()))
               << " the tile should be equal to the one written";
           // update it
           auto* loc = snake_eyes_tile.mutable_locations()->Add();
@@ -215,7 +224,7 @@ TEST_F(incident_loading, watch) {
           EXPECT_EQ(state->cache.size(), tileset.empty() ? 1 : 2) << " wrong number of cache entries";
           EXPECT_EQ(state->cache.count(snake_eyes), 1) << " should still be in there";
           EXPECT_TRUE(state->cache[snake_eyes]) << " should still be not null";
-          EXPECT_TRUE(test::pbf_equals(snake_eyes_tile, *state->cache[snake_eyes]))
+          EXPECT_TRUE(test::pbf_equals(snake_eyes_tile, *state->cache[snake_eyes]->tile()))
               << " should have all the changes that were made";
           // remove one
           EXPECT_TRUE(filesystem::remove(snake_eyes_name)) << " couldnt remove file";
@@ -262,11 +271,11 @@ TEST_F(incident_loading, watch) {
           EXPECT_EQ(state->cache.size(), 2) << " wrong number of cache entries";
           EXPECT_EQ(state->cache.count(snake_eyes), 1) << " both should be there";
           EXPECT_TRUE(state->cache[snake_eyes]) << " should be not null";
-          EXPECT_TRUE(test::pbf_equals(snake_eyes_tile, *state->cache[snake_eyes]))
+          EXPECT_TRUE(test::pbf_equals(snake_eyes_tile, *state->cache[snake_eyes]->tile()))
               << " should be equivalent";
           EXPECT_EQ(state->cache.count(box_cars), 1) << " both should be there";
           EXPECT_TRUE(state->cache[box_cars]) << " should be not null";
-          EXPECT_TRUE(test::pbf_equals(box_cars_tile, *state->cache[box_cars]))
+          EXPECT_TRUE(test::pbf_equals(box_cars_tile, *state->cache[box_cars]->tile()))
               << " should be equivalent";
           // remove one
           EXPECT_TRUE(filesystem::remove(snake_eyes_name)) << " couldnt remove file";
@@ -281,7 +290,7 @@ TEST_F(incident_loading, watch) {
           EXPECT_FALSE(state->cache[snake_eyes]) << " should be null now";
           EXPECT_EQ(state->cache.count(box_cars), 1) << " should also be this one";
           EXPECT_TRUE(state->cache[box_cars]) << " should be not null";
-          EXPECT_TRUE(test::pbf_equals(box_cars_tile, *state->cache[box_cars]))
+          EXPECT_TRUE(test::pbf_equals(box_cars_tile, *state->cache[box_cars]->tile()))
               << " should be equivalent";
           // remove the dir and quit before next update
           filesystem::remove_all(scratch_dir);
@@ -300,10 +309,90 @@ TEST_F(incident_loading, watch) {
     EXPECT_FALSE(state->cache[snake_eyes]) << " should be null now";
     EXPECT_EQ(state->cache.count(box_cars), 1) << " should also be this one";
     EXPECT_TRUE(state->cache[box_cars]) << " should be not null";
-    EXPECT_TRUE(test::pbf_equals(box_cars_tile, *state->cache[box_cars])) << " should be equivalent";
+    EXPECT_TRUE(test::pbf_equals(box_cars_tile, *state->cache[box_cars]->tile()))
+        << " should be equivalent";
   }
 }
 
+TEST_F(incident_loading, watch_events) {
+  boost::property_tree::ptree config;
+  config.put("incident_dir", scratch_dir);
+  config.put("incident_max_loading_latency", 0);
+
+  // the tile and the directories it lives in dont exist until after we start watching
+  baldr::GraphId box_cars{66, 2, 0};
+  auto box_cars_name = scratch_dir + baldr::GraphTile::FileSuffix(box_cars, ".pbf");
+  auto level_dir = scratch_dir + "2";
+  auto moved_dir = scratch_dir + "moved";
+  IncidentsTile box_cars_tile;
+  auto* loc = box_cars_tile.mutable_locations()->Add();
+  loc->set_edge_index(12);
+  loc->set_start_offset(0.31);
+  loc->set_end_offset(0.321);
+  loc->set_metadata_index(0);
+
+  baldr::GraphId other{67, 2, 0};
+  auto other_name = scratch_dir + baldr::GraphTile::FileSuffix(other, ".pbf");
+  std::unique_ptr<std::ofstream> writing;
+
+  std::shared_ptr<testable_singleton::state_t> state{new testable_singleton::state_t{}};
+  testable_singleton::watch(config, {}, state, [&](size_t i) -> bool {
+    switch (i) {
+      case 1: {
+        EXPECT_TRUE(state->cache.empty()) << " nothing should be loaded yet";
+        // write it off to the side and move it into place like a well behaved publisher would
+        EXPECT_TRUE(filesystem::create_directories(filesystem::path(box_cars_name).parent_path()));
+        {
+          std::ofstream f(box_cars_name + ".tmp", std::ofstream::out | std::ofstream::binary);
+          EXPECT_TRUE(f.is_open());
+          f << box_cars_tile.SerializeAsString();
+        }
+        EXPECT_TRUE(filesystem::rename(box_cars_name + ".tmp", box_cars_name));
+        // something that isnt a tile
+        std::ofstream(scratch_dir + "README") << "not a tile";
+        return false;
+      }
+      case 2: {
+        EXPECT_EQ(state->cache.size(), 1) << " only the tile should be loaded";
+        EXPECT_TRUE(state->cache[box_cars]) << " the new tile should be loaded";
+        EXPECT_TRUE(test::pbf_equals(box_cars_tile, *state->cache[box_cars]->tile()));
+        EXPECT_GE(state->update_latency.load(), 0) << " latency should be measured";
+        EXPECT_LT(state->update_latency.load(), 5000) << " the tile should load right away";
+        // moving a directory away doesnt say what was in it
+        EXPECT_TRUE(filesystem::rename(level_dir, moved_dir));
+        return false;
+      }
+      case 3: {
+        EXPECT_FALSE(state->cache[box_cars]) << " the tile moved away with its directory";
+        // moving it back brings the old tile back even though its timestamp is old
+        EXPECT_TRUE(filesystem::rename(moved_dir, level_dir));
+        return false;
+      }
+      case 4: {
+        EXPECT_TRUE(state->cache[box_cars]) << " the tile moved back with its directory";
+        EXPECT_TRUE(test::pbf_equals(box_cars_tile, *state->cache[box_cars]->tile()));
+        // a tile written in place is only read once the writer closes it
+        writing.reset(new std::ofstream(other_name, std::ofstream::out | std::ofstream::binary));
+        EXPECT_TRUE(writing->is_open());
+        return false;
+      }
+      case 5: {
+        EXPECT_EQ(state->cache.count(other), 0) << " the tile is still being written";
+        *writing << box_cars_tile.SerializeAsString();
+        writing.reset();
+        return false;
+      }
+      case 6: {
+        EXPECT_TRUE(state->cache[other]) << " the tile should be loaded once it was closed";
+        EXPECT_TRUE(test::pbf_equals(box_cars_tile, *state->cache[other]->tile()));
+        return true;
+      }
+      default:
+        throw std::logic_error("This code should never be reached");
+    }
+  });
+}
+
 TEST_F(incident_loading, constructor) {
   boost::property_tree::ptree config;
   config.put("incident_max_loading_latency", 1);
@@ -343,7 +432,7 @@ TEST_F(incident_loading, get) {
   config.put("incident_dir", scratch_dir);
   auto got = incident_singleton_t::get(box_cars, config, {});
   ASSERT_TRUE(got);
-  ASSERT_TRUE(test::pbf_equals(box_cars_tile, *got));
+  ASSERT_TRUE(test::pbf_equals(box_cars_tile, *got->tile()));
 
   // get the one that isnt there
   got = incident_singleton_t::get({});
@@ -0,0 +1,99 @@
+#include "baldr/landmarks.h"
+#include "thor/astarheuristic.h"
+
+#include <fstream>
+
+#include "test.h"
+
+using namespace valhalla;
+using namespace valhalla::baldr;
+
+namespace {
+
+// two tiles with the nodes of a road 1km long between the two landmarks at its ends, the road
+// can be driven both ways so the distances to and from a landmark are the same
+Landmarks make_landmarks() {
+  Landmarks landmarks({Costing::auto_, Costing::pedestrian}, 2,
+                      {{GraphId(5, 2, 0).value, 0, 3}, {GraphId(1, 2, 0).value, 0, 2}});
+  const std::vector<float> positions{0, 100, 300, 600, 1000};
+  for (uint32_t table = 0; table < 2; ++table) {
+    landmarks.landmarks(table)[0] = {1, 2, 0};
+    landmarks.landmarks(table)[1] = {5, 2, 2};
+    for (uint32_t i = 0; i < positions.size(); ++i) {
+      landmarks.distances(table, i)[0] = {positions[i], positions[i]};
+      landmarks.distances(table, i)[1] = {1000 - positions[i], 1000 - positions[i]};
+    }
+  }
+  return landmarks;
+}
+
+TEST(Landmarks, index) {
+  const auto landmarks = make_landmarks();
+  EXPECT_EQ(landmarks.node_count(), 5);
+  EXPECT_EQ(landmarks.landmark_count(), 2);
+  EXPECT_EQ(landmarks.table(Costing::pedestrian), 1);
+  EXPECT_EQ(landmarks.table(Costing::bicycle), Landmarks::kInvalidTable);
+
+  // the tiles are numbered in the order of their ids
+  EXPECT_EQ(landmarks.index({1, 2, 1}), 1);
+  EXPECT_EQ(landmarks.index({5, 2, 1}), 3);
+  EXPECT_EQ(landmarks.index({5, 2, 3}), Landmarks::kInvalidNode);
+  EXPECT_EQ(landmarks.index({7, 2, 0}), Landmarks::kInvalidNode);
+  EXPECT_EQ(landmarks.index({5, 1, 0}), Landmarks::kInvalidNode);
+}
+
+TEST(Landmarks, save_and_load) {
+  const std::string file_name = "test/data/landmarks.bin";
+  make_landmarks().Save(file_name);
+  const auto landmarks = Landmarks::Load(file_name);
+  EXPECT_EQ(landmarks.node_count(), 5);
+  EXPECT_EQ(landmarks.index({5, 2, 2}), 4);
+  EXPECT_EQ(landmarks.landmarks(1)[1], GraphId(5, 2, 2));
+  EXPECT_EQ(landmarks.distances(1, 3)[1].from, 400);
+
+  EXPECT_THROW(Landmarks::Load("test/data/does_not_exist.bin"), std::runtime_error);
+  std::ofstream(file_name, std::ios::binary | std::ios::trunc) << "not a landmark file";
+  EXPECT_THROW(Landmarks::Load(file_name), std::runtime_error);
+}
+
+TEST(Landmarks, heuristic) {
+  auto landmarks = make_landmarks();
+  thor::AStarHeuristic heuristic;
+  heuristic.Init({5.1, 52.1}, 0.5f);
+
+  // going to the end of the road the node 100m along it has 900m to go
+  EXPECT_TRUE(heuristic.InitLandmarks(landmarks, 0, {{5, 2, 2}}, true));
+  EXPECT_EQ(heuristic.GetLandmarkDistance({1, 2, 1}), 900);
+  EXPECT_EQ(heuristic.Get(GraphId(1, 2, 1), 10.f), 450);
+  EXPECT_EQ(heuristic.Get(GraphId(1, 2, 1), 2000.f), 1000);
+  // nodes without landmarks only have the great circle distance
+  EXPECT_EQ(heuristic.Get(GraphId(7, 2, 1), 10.f), 5);
+
+  // coming from the end of the road or from either of two nodes on it
+  EXPECT_TRUE(heuristic.InitLandmarks(landmarks, 0, {{5, 2, 2}}, false));
+  EXPECT_EQ(heuristic.GetLandmarkDistance({1, 2, 1}), 900);
+  EXPECT_TRUE(heuristic.InitLandmarks(landmarks, 0, {{5, 2, 0}, {5, 2, 2}}, false));
+  EXPECT_EQ(heuristic.GetLandmarkDistance({1, 2, 1}), 200);
+
+  // landmarks that cant be reached are left out
+  landmarks.distances(0, 1)[1] = {Landmarks::kUnreachable, Landmarks::kUnreachable};
+  EXPECT_TRUE(heuristic.InitLandmarks(landmarks, 0, {{5, 2, 2}}, true));
+  EXPECT_EQ(heuristic.GetLandmarkDistance({1, 2, 1}), 900);
+  landmarks.distances(0, 4)[0] = {Landmarks::kUnreachable, Landmarks::kUnreachable};
+  EXPECT_TRUE(heuristic.InitLandmarks(landmarks, 0, {{5, 2, 2}}, true));
+  EXPECT_EQ(heuristic.GetLandmarkDistance({1, 2, 1}), 0);
+
+  // without landmarks for the target they arent used
+  EXPECT_FALSE(heuristic.InitLandmarks(landmarks, 0, {{7, 2, 0}}, true));
+  EXPECT_EQ(heuristic.Get(GraphId(1, 2, 1), 10.f), 5);
+  EXPECT_TRUE(heuristic.InitLandmarks(landmarks, 0, {{5, 2, 2}}, true));
+  heuristic.Init({5.1, 52.1}, 0.5f);
+  EXPECT_EQ(heuristic.Get(GraphId(1, 2, 1), 10.f), 5);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
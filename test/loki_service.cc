@@ -534,6 +534,127 @@ TEST(LokiService, test_actions_whitelist) {
   }
 }
 
+http_request_t pbf_request(const std::string& path, const Api& api) {
+  http_request_t request(POST, path, api.SerializeAsString());
+  request.headers.emplace("Content-Type", "application/x-protobuf");
+  return request;
+}
+
+Api pbf_api(Costing costing, const std::vector<std::pair<double, double>>& lls) {
+  Api api;
+  auto& options = *api.mutable_options();
+  options.set_costing(costing);
+  for (const auto& ll : lls) {
+    auto* location = options.add_locations();
+    location->mutable_ll()->set_lat(ll.first);
+    location->mutable_ll()->set_lng(ll.second);
+  }
+  return api;
+}
+
+void expect_pbf_error(const std::string& path, const Api& api, unsigned code) {
+  Api parsed;
+  try {
+    ParseApi(pbf_request(path, api), parsed);
+    FAIL() << "Expected error " << code;
+  } catch (const valhalla_exception_t& e) { EXPECT_EQ(e.code, code); }
+}
+
+TEST(LokiService, pbf_route_defaults_like_json) {
+  auto api = pbf_api(Costing::auto_, {{52.09, 5.1}, {52.1, 5.12}});
+  auto* costing_options = api.mutable_options()->add_costing_options();
+  costing_options->set_costing(Costing::auto_);
+  costing_options->set_use_highways(0.25f);
+  // out of range values snap to the default like they do in json
+  costing_options = api.mutable_options()->add_costing_options();
+  costing_options->set_costing(Costing::bicycle);
+  costing_options->set_cycling_speed(500.f);
+  api.mutable_options()->set_language("xx-XX");
+  Api pbf;
+  ParseApi(pbf_request("/route", api), pbf);
+
+  Api json;
+  ParseApi(R"({"locations":[{"lat":52.09,"lon":5.1},{"lat":52.1,"lon":5.12}],"costing":"auto",
+               "costing_options":{"auto":{"use_highways":0.25},"bicycle":{"cycling_speed":500}},
+               "language":"xx-XX"})",
+           Options::route, json);
+
+  const auto& options = pbf.options();
+  EXPECT_EQ(options.action(), Options::route);
+  EXPECT_EQ(options.language(), json.options().language());
+  ASSERT_EQ(options.costing_options_size(), json.options().costing_options_size());
+  for (int i = 0; i < options.costing_options_size(); ++i) {
+    EXPECT_EQ(options.costing_options(i).SerializeAsString(),
+              json.options().costing_options(i).SerializeAsString())
+        << "costing options of " << Costing_Enum_Name(static_cast<Costing>(i));
+  }
+  EXPECT_EQ(options.costing_options(Costing::auto_).use_highways(), 0.25f);
+  ASSERT_EQ(options.locations_size(), json.options().locations_size());
+  for (int i = 0; i < options.locations_size(); ++i) {
+    EXPECT_EQ(options.locations(i).SerializeAsString(),
+              json.options().locations(i).SerializeAsString());
+  }
+}
+
+TEST(LokiService, pbf_route_checks_like_json) {
+  auto api = pbf_api(Costing::auto_, {{91, 5.1}, {52.1, 5.12}});
+  expect_pbf_error("/route", api, 130);
+
+  api = pbf_api(Costing::auto_, {{52.09, 5.1}, {52.1, 5.12}});
+  api.mutable_options()->set_date_time_type(Options::depart_at);
+  expect_pbf_error("/route", api, 160);
+  api.mutable_options()->set_date_time("yesterday");
+  expect_pbf_error("/route", api, 162);
+
+  api = pbf_api(Costing::auto_, {{52.09, 5.1}, {52.1, 5.12}});
+  auto* costing_options = api.mutable_options()->add_costing_options();
+  costing_options->set_costing(Costing::auto_);
+  costing_options->set_ignore_closures(true);
+  api.mutable_options()->mutable_locations(0)->mutable_search_filter()->set_exclude_closures(true);
+  expect_pbf_error("/route", api, 143);
+
+  api = pbf_api(Costing::auto_, {{52.09, 5.1}, {52.1, 5.12}, {52.2, 5.2}});
+  api.mutable_options()->set_alternates(2);
+  Api parsed;
+  ParseApi(pbf_request("/route", api), parsed);
+  EXPECT_EQ(parsed.options().alternates(), 0) << "No alternates for multi point routes";
+  EXPECT_EQ(parsed.options().locations(1).original_index(), 1);
+}
+
+TEST(LokiService, pbf_isochrone_checks_like_json) {
+  auto api = pbf_api(Costing::pedestrian, {{52.09, 5.1}});
+  api.mutable_options()->add_contours();
+  expect_pbf_error("/isochrone", api, 111);
+
+  api = pbf_api(Costing::pedestrian, {{52.09, 5.1}});
+  api.mutable_options()->add_contours()->set_time(10);
+  api.mutable_options()->set_date_time_type(Options::arrive_by);
+  api.mutable_options()->set_date_time("2021-07-20T08:00");
+  expect_pbf_error("/isochrone", api, 142);
+
+  api.mutable_options()->set_date_time_type(Options::depart_at);
+  api.mutable_options()->set_denoise(3.f);
+  Api pbf;
+  ParseApi(pbf_request("/isochrone", api), pbf);
+
+  Api json;
+  ParseApi(R"({"locations":[{"lat":52.09,"lon":5.1}],"costing":"pedestrian",
+               "contours":[{"time":10}],"denoise":3,
+               "date_time":{"type":1,"value":"2021-07-20T08:00"}})",
+           Options::isochrone, json);
+
+  const auto& options = pbf.options();
+  EXPECT_EQ(options.action(), Options::isochrone);
+  EXPECT_EQ(options.denoise(), json.options().denoise());
+  ASSERT_EQ(options.locations_size(), 1);
+  EXPECT_EQ(options.locations(0).date_time(), "2021-07-20T08:00");
+  EXPECT_EQ(options.locations(0).SerializeAsString(),
+            json.options().locations(0).SerializeAsString());
+  ASSERT_EQ(options.costing_options_size(), json.options().costing_options_size());
+  EXPECT_EQ(options.costing_options(Costing::pedestrian).SerializeAsString(),
+            json.options().costing_options(Costing::pedestrian).SerializeAsString());
+}
+
 } // namespace
 
 class LokiServiceEnv : public ::testing::Environment {
@@ -1,10 +1,13 @@
 #include "test.h"
 
+#include <fstream>
 #include <string>
 
+#include "mjolnir/compiledtagtransform.h"
 #include "mjolnir/graph_lua_proc.h"
 #include "mjolnir/luatagtransform.h"
 #include "mjolnir/osmdata.h"
+#include "mjolnir/osmpbfparser.h"
 
 using namespace valhalla;
 
@@ -103,6 +106,111 @@ TEST(Lua, NumberDoublePeriod) {
   // ... but that the results aren't completely empty
   ASSERT_TRUE(results.size() > 0);
 }
+// runs every node, way and relation of an extract through both transforms and compares them
+struct equivalence_callback : public OSMPBF::Callback {
+  equivalence_callback()
+      : lua(std::string(lua_graph_lua, lua_graph_lua + lua_graph_lua_len)), count(0) {
+  }
+  void node_callback(const uint64_t osmid,
+                     const double /*lng*/,
+                     const double /*lat*/,
+                     const OSMPBF::Tags& tags) override {
+    compare(mjolnir::OSMType::kNode, osmid, tags);
+  }
+  void way_callback(const uint64_t osmid,
+                    const OSMPBF::Tags& tags,
+                    const std::vector<uint64_t>& /*nodes*/) override {
+    compare(mjolnir::OSMType::kWay, osmid, tags);
+  }
+  void relation_callback(const uint64_t osmid,
+                         const OSMPBF::Tags& tags,
+                         const std::vector<OSMPBF::Member>& /*members*/) override {
+    compare(mjolnir::OSMType::kRelation, osmid, tags);
+  }
+  void changeset_callback(const uint64_t /*changeset_id*/) override {
+  }
+  void compare(mjolnir::OSMType type, uint64_t osmid, const mjolnir::Tags& tags) {
+    ++count;
+    auto expected = lua.Transform(type, osmid, tags);
+    auto actual = compiled.Transform(type, osmid, tags);
+    EXPECT_EQ(expected, actual) << (type == mjolnir::OSMType::kNode
+                                        ? "node "
+                                        : (type == mjolnir::OSMType::kWay ? "way " : "relation "))
+                                << osmid;
+  }
+  mjolnir::LuaTagTransform lua;
+  mjolnir::CompiledTagTransform compiled;
+  size_t count;
+};
+
+TEST(Lua, CompiledEquivalence) {
+  equivalence_callback callback;
+  std::ifstream file(VALHALLA_SOURCE_DIR "test/data/liechtenstein-latest.osm.pbf",
+                     std::ios::binary);
+  ASSERT_TRUE(file.is_open());
+  OSMPBF::Parser::parse(file,
+                        static_cast<OSMPBF::Interest>(OSMPBF::Interest::NODES |
+                                                      OSMPBF::Interest::WAYS |
+                                                      OSMPBF::Interest::RELATIONS),
+                        callback);
+  EXPECT_GT(callback.count, 0u);
+
+  // and a few hand made cases covering the less common branches
+  std::vector<std::pair<mjolnir::OSMType, mjolnir::Tags>> cases{
+      {mjolnir::OSMType::kNode, {}},
+      {mjolnir::OSMType::kNode, {{"barrier", "bollard"}, {"bollard", "rising"}}},
+      {mjolnir::OSMType::kNode, {{"barrier", "sump_buster"}, {"motorcar", "yes"}}},
+      {mjolnir::OSMType::kNode, {{"access", "psv"}, {"psv", "no"}, {"motor_vehicle", "no"}}},
+      {mjolnir::OSMType::kNode, {{"access", "private"}, {"emergency", "yes"}, {"hov", "lane"}}},
+      {mjolnir::OSMType::kNode, {{"toll", "no"}, {"payment:coins", "yes"}, {"fee", "yes"}}},
+      {mjolnir::OSMType::kNode,
+       {{"highway", "traffic_signals"},
+        {"name", "Main"},
+        {"traffic_signals:direction", "forward"}}},
+      {mjolnir::OSMType::kNode, {{"iso:3166_2", "DE-BY"}, {"crossing", "zebra"}}},
+      {mjolnir::OSMType::kNode, {{"iso:3166_2", "FRIDF"}, {"mofa", "yes"}}},
+      {mjolnir::OSMType::kWay, {}},
+      {mjolnir::OSMType::kWay, {{"building", "yes"}}},
+      {mjolnir::OSMType::kWay, {{"highway", "proposed"}, {"name", "Main"}}},
+      {mjolnir::OSMType::kWay,
+       {{"highway", "primary"}, {"oneway", "-1"}, {"oneway:bicycle", "no"},
+        {"cycleway:right", "lane"}, {"maxspeed", "30 mph"}, {"lanes", "02"}}},
+      {mjolnir::OSMType::kWay,
+       {{"highway", "residential"}, {"junction", "roundabout"}, {"oneway:bus", "-1"},
+        {"bus:backward", "yes"}, {"lanes:psv", "2"}, {"shoulder:right", "yes"}}},
+      {mjolnir::OSMType::kWay,
+       {{"highway", "service"}, {"service", "driveway"}, {"maxweight", "7500 kg"},
+        {"maxaxleload", "4000lbs"}, {"maxheight", "12'6\""}, {"maxwidth:physical", "2,5 m"}}},
+      {mjolnir::OSMType::kWay,
+       {{"highway", "track"}, {"tracktype", "grade3"}, {"sac_scale", "hiking"},
+        {"hazmat:B", "no"}}},
+      {mjolnir::OSMType::kWay,
+       {{"highway", "footway"}, {"footway", "crossing"}, {"oneway", "yes"}, {"oneway:foot", "-1"}}},
+      {mjolnir::OSMType::kWay,
+       {{"highway", "motorway"}, {"hov", "designated"}, {"hov:lanes", "designated|designated"},
+        {"unsigned_ref", "I 5"}, {"maxspeed", "none"}, {"toll", "yes"}}},
+      {mjolnir::OSMType::kWay,
+       {{"highway", "cycleway"}, {"segregated", "yes"}, {"foot", "designated"}, {"lcn_ref", "7"},
+        {"mtb", "yes"}}},
+      {mjolnir::OSMType::kWay,
+       {{"highway", "tertiary"}, {"access", "hov"}, {"oneway", "reversible"}, {"bus", "yes"}}},
+      {mjolnir::OSMType::kWay, {{"route", "ferry"}, {"vehicle", "no"}, {"hgv", "yes"}}},
+      {mjolnir::OSMType::kWay, {{"route", "shuttle_train"}, {"railway", "rail"}}},
+      {mjolnir::OSMType::kWay, {{"highway", "tertiary"}, {"maxweight", "."}}},
+      {mjolnir::OSMType::kRelation, {{"type", "connectivity"}}},
+      {mjolnir::OSMType::kRelation,
+       {{"type", "restriction"}, {"restriction:conditional", "no_u_turn @ (Mo-Fr 07:00-09:00)"}}},
+      {mjolnir::OSMType::kRelation,
+       {{"type", "restriction"}, {"restriction", "no_left_turn"}, {"restriction:bus", "no_entry"}}},
+      {mjolnir::OSMType::kRelation, {{"type", "route"}, {"route", "mtb"}, {"network", "lcn"}}},
+      {mjolnir::OSMType::kRelation, {{"type", "route"}, {"restriction", "no_exit"}}},
+      {mjolnir::OSMType::kRelation, {{"type", "multipolygon"}}},
+  };
+  for (const auto& c : cases) {
+    callback.compare(c.first, 0, c.second);
+  }
+}
+
 } // namespace
 
 // TODO: sweet jesus add more tests of this class!
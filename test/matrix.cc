@@ -1,6 +1,7 @@
 #include "test.h"
 
 #include <iostream>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -10,6 +11,7 @@
 #include "thor/costmatrix.h"
 #include "thor/timedistancematrix.h"
 #include "thor/worker.h"
+#include "tyr/serializers.h"
 
 using namespace valhalla;
 using namespace valhalla::thor;
@@ -24,7 +26,7 @@ namespace {
 // Quick costing class derived for testing so that any changes to regular costing
 // won't change the outcome of the tests. Some of the logic for this class is just
 // copy pasted from AutoCost as it stands when this test was written.
-class SimpleCost final : public DynamicCost {
+class SimpleCost : public DynamicCost {
 public:
   /**
    * Constructor.
@@ -120,6 +122,25 @@ cost_ptr_t CreateSimpleCost(const CostingOptions& options) {
   return std::make_shared<SimpleCost>(options);
 }
 
+// Same as above but the roads are twice as slow on mondays
+class MondayCost final : public SimpleCost {
+public:
+  MondayCost(const CostingOptions& options) : SimpleCost(options) {
+  }
+
+  using SimpleCost::EdgeCost;
+  Cost EdgeCost(const DirectedEdge* edge,
+                const graph_tile_ptr& tile,
+                const uint32_t seconds,
+                uint8_t& flow_sources) const override {
+    auto cost = SimpleCost::EdgeCost(edge, tile, seconds, flow_sources);
+    if (seconds != kConstrainedFlowSecondOfDay && seconds < kSecondsPerDay) {
+      cost.secs *= 2.f;
+    }
+    return cost;
+  }
+};
+
 // Maximum edge score - base this on costing type.
 // Large values can cause very bad performance. Setting this back
 // to 2 hours for bike and pedestrian and 12 hours for driving routes.
@@ -256,6 +277,65 @@ TEST(Matrix, test_matrix) {
   }
 }
 
+// Runs both matrices with costing that is slow on mondays leaving (or arriving) at the given time
+void test_time_dependent(const std::string& date_time, bool monday) {
+  loki_worker_t loki_worker(config);
+
+  Api request;
+  auto json = std::string(test_request);
+  json.insert(json.rfind('}'), R"(,"date_time":)" + date_time);
+  ParseApi(json, Options::sources_to_targets, request);
+  loki_worker.matrix(request);
+  adjust_scores(*request.mutable_options());
+
+  GraphReader reader(config.get_child("mjolnir"));
+
+  sif::mode_costing_t mode_costing;
+  mode_costing[0] = std::make_shared<MondayCost>(
+      request.options().costing_options(static_cast<int>(request.options().costing())));
+
+  auto check = [&](const std::vector<TimeDistance>& results, const std::string& name) {
+    ASSERT_EQ(results.size(), matrix_answers.size());
+    for (uint32_t i = 0; i < results.size(); ++i) {
+      EXPECT_NEAR(results[i].dist, matrix_answers[i].dist, kThreshold)
+          << "result " << i << "'s distance is off for " << name;
+      // the edge part of the time doubles while the transitions stay the same
+      if (monday && matrix_answers[i].time > 0) {
+        EXPECT_GT(results[i].time, matrix_answers[i].time + kThreshold)
+            << "result " << i << " wasnt slowed down on monday for " << name;
+        EXPECT_LE(results[i].time, matrix_answers[i].time * 2 + kThreshold)
+            << "result " << i << " was slowed down too much for " << name;
+      } else {
+        EXPECT_NEAR(results[i].time, matrix_answers[i].time, kThreshold)
+            << "result " << i << "'s time is off for " << name;
+      }
+    }
+  };
+
+  CostMatrix cost_matrix;
+  check(cost_matrix.SourceToTarget(request.options().sources(), request.options().targets(),
+                                   reader, mode_costing, TravelMode::kDrive, 400000.0),
+        "CostMatrix");
+
+  TimeDistanceMatrix timedist_matrix;
+  check(timedist_matrix.SourceToTarget(request.options().sources(), request.options().targets(),
+                                       reader, mode_costing, TravelMode::kDrive, 400000.0),
+        "TimeDistanceMatrix");
+}
+
+TEST(Matrix, depart_at_monday) {
+  test_time_dependent(R"({"type":1,"value":"2021-07-19T08:00"})", true);
+}
+
+TEST(Matrix, depart_at_tuesday) {
+  test_time_dependent(R"({"type":1,"value":"2021-07-20T08:00"})", false);
+}
+
+TEST(Matrix, arrive_by_monday) {
+  // also checks that the backward searches fill in the matrix a column at a time
+  test_time_dependent(R"({"type":2,"value":"2021-07-19T20:00"})", true);
+}
+
 // TODO: it was commented before. Why?
 TEST(Matrix, DISABLED_test_matrix_osrm) {
   loki_worker_t loki_worker(config);
@@ -300,6 +380,80 @@ TEST(Matrix, DISABLED_test_matrix_osrm) {
   }
 }
 
+namespace {
+
+Api serialize_request(Options::Format format) {
+  Api request;
+  auto& options = *request.mutable_options();
+  options.set_format(format);
+  options.set_id("matrix");
+  auto add = [](google::protobuf::RepeatedPtrField<valhalla::Location>* locations, double lat,
+                double lon, const std::string& name) {
+    auto* location = locations->Add();
+    location->mutable_ll()->set_lat(lat);
+    location->mutable_ll()->set_lng(lon);
+    auto* edge = location->add_path_edges();
+    edge->mutable_ll()->set_lat(lat);
+    edge->mutable_ll()->set_lng(lon);
+    if (!name.empty())
+      edge->add_names(name);
+  };
+  add(options.mutable_sources(), 52.09, 5.1, "Main Street");
+  add(options.mutable_targets(), 52.1, 5.12, "");
+  add(options.mutable_targets(), 52.2, 5.2, "");
+  return request;
+}
+
+const std::vector<TimeDistance> serialize_results = {{100, 1500},
+                                                     {static_cast<uint32_t>(kMaxCost), 0}};
+
+} // namespace
+
+TEST(Matrix, serialize_valhalla) {
+  auto request = serialize_request(Options::json);
+  auto json = serializeMatrix(request, serialize_results, 1.0);
+  EXPECT_EQ(json, R"({"sources_to_targets":[[)"
+                  R"({"from_index":0,"to_index":0,"time":100,"distance":1500.000},)"
+                  R"({"from_index":0,"to_index":1,"time":null,"distance":null}]],)"
+                  R"("units":"kilometers",)"
+                  R"("targets":[[{"lat":52.100000,"lon":5.120000},)"
+                  R"({"lat":52.200000,"lon":5.200000}]],)"
+                  R"("sources":[[{"lat":52.090000,"lon":5.100000}]],"id":"matrix"})");
+}
+
+TEST(Matrix, serialize_osrm) {
+  auto request = serialize_request(Options::osrm);
+  auto json = serializeMatrix(request, serialize_results, 1.0);
+  EXPECT_EQ(json, R"({"code":"Ok",)"
+                  R"("sources":[{"location":[5.100000,52.090000],"name":"Main Street",)"
+                  R"("distance":0.000}],)"
+                  R"("destinations":[{"location":[5.120000,52.100000],"name":"","distance":0.000},)"
+                  R"({"location":[5.200000,52.200000],"name":"","distance":0.000}],)"
+                  R"("durations":[[100,null]],"distances":[[1500.000,null]]})");
+}
+
+TEST(Matrix, serialize_pbf) {
+  auto request = serialize_request(Options::pbf);
+  request.mutable_info()->set_error(false);
+  auto bytes = serializeMatrix(request, serialize_results, 0.001);
+
+  Api response;
+  ASSERT_TRUE(response.ParseFromString(bytes));
+  EXPECT_FALSE(response.has_info()) << "Statistics should not be sent back";
+  EXPECT_TRUE(request.has_info()) << "Statistics should still be there for the worker";
+  EXPECT_EQ(response.options().id(), "matrix");
+  EXPECT_EQ(response.options().sources_size(), 1);
+  EXPECT_EQ(response.options().targets_size(), 2);
+
+  const auto& matrix = response.matrix();
+  ASSERT_EQ(matrix.times_size(), 2);
+  ASSERT_EQ(matrix.distances_size(), 2);
+  EXPECT_EQ(matrix.times(0), 100);
+  EXPECT_FLOAT_EQ(matrix.distances(0), 1.5f);
+  EXPECT_EQ(matrix.times(1), std::numeric_limits<uint32_t>::max());
+  EXPECT_EQ(matrix.distances(1), 0.f);
+}
+
 int main(int argc, char* argv[]) {
   logging::Configure({{"type", ""}}); // silence logs
   testing::InitGoogleTest(&argc, argv);
@@ -1,7 +1,12 @@
 #include <map>
+#include <sstream>
 #include <string>
 #include <vector>
 
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "baldr/rapidjson_utils.h"
 #include "midgard/logging.h"
 #include "odin/narrative_dictionary.h"
 #include "odin/util.h"
@@ -1338,6 +1343,117 @@ TEST(NarrativeDictionary, test_en_US_approach_verbal_alert) {
   validate(us_customary_lengths, kExpectedUsCustomaryLengths);
 }
 
+// The tag strings in the order of PhraseTag
+const std::vector<std::string> kPhraseTags = {
+    kCardinalDirectionTag,
+    kRelativeDirectionTag,
+    kOrdinalValueTag,
+    kStreetNamesTag,
+    kPreviousStreetNamesTag,
+    kBeginStreetNamesTag,
+    kCrossStreetNamesTag,
+    kRoundaboutExitStreetNamesTag,
+    kRoundaboutExitBeginStreetNamesTag,
+    kRampExitNumbersVisualTag,
+    kLengthTag,
+    kDestinationTag,
+    kCurrentVerbalCueTag,
+    kNextVerbalCueTag,
+    kKilometersTag,
+    kMetersTag,
+    kMilesTag,
+    kTenthsOfMilesTag,
+    kFeetTag,
+    kNumberSignTag,
+    kBranchSignTag,
+    kTowardSignTag,
+    kNameSignTag,
+    kJunctionNameTag,
+    kFerryLabelTag,
+    kTransitPlatformTag,
+    kStationLabelTag,
+    kTimeTag,
+    kTransitNameTag,
+    kTransitHeadSignTag,
+    kTransitPlatformCountTag,
+    kTransitPlatformCountLabelTag,
+};
+
+TEST(NarrativeDictionary, test_phrase_template) {
+  std::string instruction = "left over";
+  PhraseValues values;
+  std::string street_names = "Main Street";
+  values.Set(PhraseTag::kRelativeDirection, std::string("left"));
+  values.Set(PhraseTag::kStreetNames, street_names);
+
+  // Tags without a value and text that only looks like a tag are kept as they are
+  PhraseTemplate("Turn <RELATIVE_DIRECTION> onto <STREET_NAMES> toward <TOWARD_SIGN>.")
+      .Form(instruction, values);
+  EXPECT_EQ(instruction, "Turn left onto Main Street toward <TOWARD_SIGN>.");
+  PhraseTemplate("<<RELATIVE_DIRECTION>> <STREET_NAME><STREET_NAMES>").Form(instruction, values);
+  EXPECT_EQ(instruction, "<left> <STREET_NAME>Main Street");
+  PhraseTemplate("").Form(instruction, values);
+  EXPECT_EQ(instruction, "");
+  PhraseTemplate("Continue.").Form(instruction, values);
+  EXPECT_EQ(instruction, "Continue.");
+
+  // Values are referenced
+  street_names = "Broadway";
+  PhraseTemplate("<STREET_NAMES>").Form(instruction, values);
+  EXPECT_EQ(instruction, "Broadway");
+}
+
+TEST(NarrativeDictionary, test_phrase_templates_all_locales) {
+  // A value for every tag
+  ASSERT_EQ(kPhraseTags.size(), static_cast<size_t>(PhraseTag::kCount));
+  std::vector<std::string> tag_values;
+  for (size_t i = 0; i < kPhraseTags.size(); ++i) {
+    tag_values.push_back("value " + std::to_string(i));
+  }
+  PhraseValues values;
+  for (size_t i = 0; i < tag_values.size(); ++i) {
+    values.Set(static_cast<PhraseTag>(i), tag_values[i]);
+  }
+
+  // Every phrase of every locale forms the same instruction as replacing the tags one by one
+  std::string instruction;
+  for (const auto& locale : get_locales_json()) {
+    std::stringstream ss;
+    ss << locale.second;
+    boost::property_tree::ptree narrative_pt;
+    rapidjson::read_json(ss, narrative_pt);
+    for (const auto& subset : narrative_pt.get_child("instructions")) {
+      const auto phrases = subset.second.get_child_optional("phrases");
+      if (!phrases) {
+        continue;
+      }
+      for (const auto& phrase : *phrases) {
+        std::string expected = phrase.second.get_value<std::string>();
+        for (size_t i = 0; i < kPhraseTags.size(); ++i) {
+          boost::replace_all(expected, kPhraseTags[i], tag_values[i]);
+        }
+        PhraseTemplate(phrase.second.get_value<std::string>()).Form(instruction, values);
+        EXPECT_EQ(instruction, expected) << locale.first << " " << subset.first << " "
+                                         << phrase.first;
+      }
+    }
+  }
+
+  // And the dictionaries have a template for each of their phrases
+  for (const auto& locale : get_locales()) {
+    for (const auto* subset : std::vector<const PhraseSet*>{&locale.second->start_subset,
+                                                            &locale.second->turn_subset,
+                                                            &locale.second->exit_verbal_subset,
+                                                            &locale.second->transit_subset}) {
+      EXPECT_EQ(subset->templates.size(), subset->phrases.size()) << locale.first;
+      for (const auto& phrase : subset->phrases) {
+        EXPECT_EQ(subset->templates.at(std::stoi(phrase.first)).phrase(), phrase.second)
+            << locale.first;
+      }
+    }
+  }
+}
+
 } // namespace
 
 int main(int argc, char* argv[]) {
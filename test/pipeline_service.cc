@@ -0,0 +1,100 @@
+#include "test.h"
+#include "tyr/actor.h"
+#include "tyr/pipeline.h"
+
+#include <boost/property_tree/ptree.hpp>
+#include <prime_server/http_protocol.hpp>
+#include <prime_server/prime_server.hpp>
+
+#include <thread>
+#include <unistd.h>
+
+using namespace valhalla;
+using namespace prime_server;
+
+namespace {
+
+const auto config = test::make_config("test/data/utrecht_tiles", {},
+                                      {"additional_data", "mjolnir.traffic_extract",
+                                       "mjolnir.tile_extract"});
+
+const std::string route_request =
+    R"({"locations":[{"lat":52.09620,"lon":5.11385},{"lat":52.07893,"lon":5.11532}],)"
+    R"("costing":"auto"})";
+const std::string locate_request =
+    R"({"locations":[{"lat":52.09620,"lon":5.11385}],"costing":"auto"})";
+const std::string matrix_request =
+    R"({"sources":[{"lat":52.09620,"lon":5.11385}],"targets":[{"lat":52.07893,"lon":5.11532},)"
+    R"({"lat":52.09110,"lon":5.11860}],"costing":"auto"})";
+
+zmq::context_t context;
+void start_service() {
+  // server
+  std::thread server(std::bind(&http_server_t::serve,
+                               http_server_t(context, config.get<std::string>("httpd.service.listen"),
+                                             config.get<std::string>("loki.service.proxy") + "_in",
+                                             config.get<std::string>("httpd.service.loopback"),
+                                             config.get<std::string>("httpd.service.interrupt"))));
+  server.detach();
+
+  // load balancer
+  std::thread proxy(std::bind(&proxy_t::forward,
+                              proxy_t(context, config.get<std::string>("loki.service.proxy") + "_in",
+                                      config.get<std::string>("loki.service.proxy") + "_out")));
+  proxy.detach();
+
+  // a couple of workers running the whole pipeline
+  for (size_t i = 0; i < 2; ++i) {
+    std::thread worker(valhalla::tyr::run_service, config);
+    worker.detach();
+  }
+}
+
+} // namespace
+
+TEST(PipelineService, matches_actor) {
+  // whatever the actor says is what the service should say too
+  tyr::actor_t actor(config, true);
+  const std::vector<std::pair<http_request_t, std::pair<unsigned, std::string>>> requests{
+      {http_request_t(POST, "/route", route_request), {200, actor.route(route_request)}},
+      {http_request_t(POST, "/locate", locate_request), {200, actor.locate(locate_request)}},
+      {http_request_t(POST, "/sources_to_targets", matrix_request),
+       {200, actor.matrix(matrix_request)}},
+      {http_request_t(GET, "/route?json=" + route_request), {200, actor.route(route_request)}},
+      {http_request_t(POST, "/nonsense", route_request), {404, ""}},
+  };
+
+  // start up the service
+  start_service();
+
+  // client makes requests and gets back responses in a batch fashion
+  auto request = requests.cbegin();
+  std::string request_str;
+  http_client_t client(context, config.get<std::string>("httpd.service.listen"),
+                       [&requests, &request, &request_str]() {
+                         // we dont have any more requests so bail
+                         if (request == requests.cend())
+                           return std::make_pair<const void*, size_t>(nullptr, 0);
+                         // get the string of bytes to send formatted for http protocol
+                         request_str = request->first.to_string();
+                         ++request;
+                         return std::make_pair<const void*, size_t>(request_str.c_str(),
+                                                                    request_str.size());
+                       },
+                       [&requests, &request](const void* data, size_t size) {
+                         auto response =
+                             http_response_t::from_string(static_cast<const char*>(data), size);
+                         const auto& expected = std::prev(request)->second;
+                         EXPECT_EQ(response.code, expected.first);
+                         if (!expected.second.empty())
+                           EXPECT_EQ(response.body, expected.second);
+                         return request != requests.cend();
+                       },
+                       1);
+
+  // make this whole thing bail if it doesnt finish fast
+  alarm(120);
+
+  // request and receive
+  client.batch();
+}
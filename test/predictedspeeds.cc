@@ -283,6 +283,66 @@ TEST_F(EncoderDecoderTest, test_speeds_decoder) {
       << "Incorrect decoded coefficients";
 }
 
+TEST(PredictedSpeeds, test_decompress_matches_reference) {
+  // coefficients across the whole int16 range so the widening to float is exercised
+  std::array<int16_t, kCoefficientCount> coefficients;
+  for (int i = 0; i < static_cast<int>(coefficients.size()); ++i)
+    coefficients[i] = static_cast<int16_t>((i * 7919 % 65536 - 32768) / (i + 1));
+
+  // the plain DCT-III in double precision
+  for (uint32_t bucket = 0; bucket < kBucketsPerWeek; ++bucket) {
+    double expected = coefficients[0] / sqrt(2.0);
+    for (uint32_t c = 1; c < kCoefficientCount; ++c)
+      expected += coefficients[c] * cos(M_PI / kBucketsPerWeek * (bucket + 0.5) * c);
+    expected *= sqrt(2.0 / kBucketsPerWeek);
+    ASSERT_NEAR(decompress_speed_bucket(coefficients.data(), bucket), expected, 1e-2)
+        << "Wrong speed in bucket " << bucket;
+  }
+}
+
+TEST(PredictedSpeeds, test_speed_cache) {
+  PredictedSpeedCache cache(4);
+  float speed = -1.f;
+  EXPECT_FALSE(cache.get(42, 7, speed));
+
+  cache.put(42, 7, 33.f);
+  ASSERT_TRUE(cache.get(42, 7, speed));
+  EXPECT_EQ(speed, 33.f);
+
+  // neither another bucket nor another edge should hit
+  EXPECT_FALSE(cache.get(42, 8, speed));
+  EXPECT_FALSE(cache.get(43, 7, speed));
+
+  // whatever collides replaces what was there but never returns the wrong speed
+  for (uint64_t edge = 0; edge < 64; ++edge)
+    cache.put(edge, 7, static_cast<float>(edge));
+  for (uint64_t edge = 0; edge < 64; ++edge) {
+    if (cache.get(edge, 7, speed))
+      EXPECT_EQ(speed, static_cast<float>(edge));
+  }
+
+  cache.clear();
+  EXPECT_FALSE(cache.get(63, 7, speed));
+}
+
+TEST(PredictedSpeeds, test_cached_speed) {
+  std::array<int16_t, kCoefficientCount> coefficients;
+  for (size_t i = 0; i < coefficients.size(); ++i)
+    coefficients[i] = static_cast<int16_t>(1000 / (i + 1));
+  uint32_t offset = 0;
+  PredictedSpeeds pred_speeds;
+  pred_speeds.set_offset(&offset);
+  pred_speeds.set_profiles(coefficients.data());
+
+  // the cached speed is the same the first time and every time after
+  PredictedSpeedCache cache;
+  for (uint32_t secs = 0; secs < kSecondsPerWeek; secs += 1000) {
+    const auto expected = pred_speeds.speed(0, secs);
+    EXPECT_EQ(pred_speeds.speed(0, secs, 1234, cache), expected);
+    EXPECT_EQ(pred_speeds.speed(0, secs, 1234, cache), expected);
+  }
+}
+
 } // namespace
 
 int main(int argc, char* argv[]) {
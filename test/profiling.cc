@@ -0,0 +1,91 @@
+#include "midgard/profiling.h"
+
+#include <chrono>
+#include <thread>
+
+#include "test.h"
+
+using namespace valhalla::midgard::profiling;
+
+namespace {
+
+void sleep_ms(int ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+double elapsed(Stage stage) {
+  return thread_profile().elapsed_ms[static_cast<size_t>(stage)];
+}
+
+uint64_t counted(Counter counter) {
+  return thread_profile().counts[static_cast<size_t>(counter)];
+}
+
+} // namespace
+
+TEST(Profiling, disabled_does_nothing) {
+  {
+    ScopedTimer timer(Stage::kSearch);
+    count(Counter::kTileCacheHit);
+    sleep_ms(5);
+  }
+  EXPECT_EQ(elapsed(Stage::kSearch), 0.);
+  EXPECT_EQ(counted(Counter::kTileCacheHit), 0);
+}
+
+TEST(Profiling, nested_stages_are_exclusive) {
+  ASSERT_TRUE(start());
+  {
+    ScopedTimer outer(Stage::kExpansion);
+    sleep_ms(20);
+    {
+      ScopedTimer inner(Stage::kTileLoad);
+      count(Counter::kTileCacheMiss);
+      sleep_ms(40);
+    }
+    {
+      // the same stage again doesnt count twice
+      ScopedTimer again(Stage::kExpansion);
+      sleep_ms(10);
+    }
+  }
+  stop();
+
+  EXPECT_GE(elapsed(Stage::kTileLoad), 40.);
+  EXPECT_GE(elapsed(Stage::kExpansion), 30.);
+  EXPECT_LT(elapsed(Stage::kExpansion), 40. + 30.);
+  EXPECT_EQ(elapsed(Stage::kSearch), 0.);
+  EXPECT_EQ(counted(Counter::kTileCacheMiss), 1);
+  EXPECT_EQ(thread_profile().current, Stage::kCount);
+}
+
+TEST(Profiling, start_only_once) {
+  ASSERT_TRUE(start());
+  count(Counter::kTileCacheHit, 3);
+  // the outer scope keeps its results
+  EXPECT_FALSE(start());
+  EXPECT_EQ(counted(Counter::kTileCacheHit), 3);
+  stop();
+  // and a new one starts from scratch
+  ASSERT_TRUE(start());
+  EXPECT_EQ(counted(Counter::kTileCacheHit), 0);
+  stop();
+}
+
+TEST(Profiling, per_thread) {
+  ASSERT_TRUE(start());
+  std::thread other([]() {
+    count(Counter::kTileCacheHit);
+    ScopedTimer timer(Stage::kSearch);
+    EXPECT_FALSE(thread_profile().enabled);
+  });
+  other.join();
+  EXPECT_EQ(counted(Counter::kTileCacheHit), 0);
+  stop();
+}
+
+TEST(Profiling, names) {
+  EXPECT_STREQ(to_string(Stage::kPathFormation), "path_formation");
+  EXPECT_STREQ(to_string(Stage::kSerialization), "serialization");
+  EXPECT_STREQ(to_string(Counter::kTileCacheMiss), "tile_cache_miss");
+}
@@ -0,0 +1,182 @@
+#include "test.h"
+#include "tyr/response_cache.h"
+#include "worker.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+using namespace valhalla;
+
+namespace {
+
+boost::property_tree::ptree cache_config(size_t max_bytes, uint32_t ttl_seconds) {
+  return test::make_config("test/data/response_cache",
+                           {{"tyr.response_cache.max_bytes", std::to_string(max_bytes)},
+                            {"tyr.response_cache.ttl_seconds", std::to_string(ttl_seconds)}});
+}
+
+Api make_request(const std::string& request_str, Options::Action action = Options::route) {
+  Api request;
+  ParseApi(request_str, action, request);
+  return request;
+}
+
+const std::string kRequest =
+    R"({"locations":[{"lat":52.09620,"lon":5.11385},{"lat":52.07893,"lon":5.11532}],)"
+    R"("costing":"auto"})";
+// same request just spelled differently
+const std::string kRequestReordered =
+    R"({"costing":"auto","locations":[{"lon":5.113850,"lat":52.0962},)"
+    R"({"lon":5.11532,"lat":52.07893}]})";
+const std::string kOtherRequest =
+    R"({"locations":[{"lat":52.09620,"lon":5.11385},{"lat":52.07893,"lon":5.11532}],)"
+    R"("costing":"pedestrian"})";
+
+} // namespace
+
+TEST(ResponseCache, hits_on_equivalent_requests) {
+  auto config = cache_config(1 << 20, 60);
+  baldr::GraphReader reader(config.get_child("mjolnir"));
+  tyr::response_cache_t cache(config, reader);
+
+  size_t computed = 0;
+  auto compute = [&computed]() {
+    ++computed;
+    return std::string("response ") + std::to_string(computed);
+  };
+
+  bool hit;
+  EXPECT_EQ(cache.get(make_request(kRequest), compute, hit), "response 1");
+  EXPECT_FALSE(hit);
+  EXPECT_EQ(cache.get(make_request(kRequest), compute, hit), "response 1");
+  EXPECT_TRUE(hit);
+  EXPECT_EQ(cache.get(make_request(kRequestReordered), compute, hit), "response 1");
+  EXPECT_TRUE(hit);
+  EXPECT_EQ(cache.get(make_request(kOtherRequest), compute, hit), "response 2");
+  EXPECT_FALSE(hit);
+  EXPECT_EQ(cache.get(make_request(kRequest, Options::sources_to_targets), compute, hit),
+            "response 3");
+  EXPECT_FALSE(hit);
+  EXPECT_EQ(computed, 3);
+}
+
+TEST(ResponseCache, expires) {
+  auto config = cache_config(1 << 20, 0);
+  baldr::GraphReader reader(config.get_child("mjolnir"));
+  tyr::response_cache_t cache(config, reader);
+
+  size_t computed = 0;
+  auto compute = [&computed]() { return std::to_string(++computed); };
+
+  bool hit;
+  EXPECT_EQ(cache.get(make_request(kRequest), compute, hit), "1");
+  EXPECT_EQ(cache.get(make_request(kRequest), compute, hit), "2");
+  EXPECT_FALSE(hit);
+}
+
+TEST(ResponseCache, evicts_least_recently_used) {
+  // room for two and a half entries
+  const auto entry_size = make_request(kRequest).options().ByteSizeLong() + 16 + 100;
+  auto config = cache_config(5 * entry_size / 2, 60);
+  baldr::GraphReader reader(config.get_child("mjolnir"));
+  tyr::response_cache_t cache(config, reader);
+  auto compute = []() { return std::string(100, 'x'); };
+
+  bool hit;
+  cache.get(make_request(kRequest), compute, hit);
+  cache.get(make_request(kOtherRequest), compute, hit);
+  // touch the first so the second is the oldest
+  cache.get(make_request(kRequest), compute, hit);
+  EXPECT_TRUE(hit);
+  cache.get(make_request(kRequest, Options::sources_to_targets), compute, hit);
+  EXPECT_FALSE(hit);
+  EXPECT_LE(cache.size(), config.get<size_t>("tyr.response_cache.max_bytes"));
+
+  cache.get(make_request(kRequest), compute, hit);
+  EXPECT_TRUE(hit);
+  cache.get(make_request(kOtherRequest), compute, hit);
+  EXPECT_FALSE(hit);
+}
+
+TEST(ResponseCache, failures_are_not_cached) {
+  auto config = cache_config(1 << 20, 60);
+  baldr::GraphReader reader(config.get_child("mjolnir"));
+  tyr::response_cache_t cache(config, reader);
+
+  bool hit;
+  EXPECT_THROW(cache.get(make_request(kRequest),
+                         []() -> std::string { throw std::runtime_error("no route"); }, hit),
+               std::runtime_error);
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(cache.get(make_request(kRequest), []() { return std::string("route"); }, hit),
+            "route");
+  EXPECT_FALSE(hit);
+}
+
+TEST(ResponseCache, coalesces_concurrent_requests) {
+  auto config = cache_config(1 << 20, 60);
+  baldr::GraphReader reader(config.get_child("mjolnir"));
+  tyr::response_cache_t cache(config, reader);
+
+  // the first computation holds on until everyone else has had a chance to show up
+  std::atomic<size_t> computed(0);
+  auto compute = [&computed]() {
+    ++computed;
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    return std::string("route");
+  };
+
+  std::atomic<size_t> hits(0);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 8; ++i) {
+    threads.emplace_back([&]() {
+      bool hit;
+      EXPECT_EQ(cache.get(make_request(kRequest), compute, hit), "route");
+      hits += hit;
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(computed, 1);
+  EXPECT_EQ(hits, 7);
+}
+
+TEST(ResponseCache, stops_waiting_for_slow_requests) {
+  auto config = cache_config(1 << 20, 60);
+  config.put("tyr.response_cache.max_wait_ms", 100);
+  baldr::GraphReader reader(config.get_child("mjolnir"));
+  tyr::response_cache_t cache(config, reader);
+
+  // the first computation takes far longer than anyone is willing to wait for it
+  std::atomic<bool> started(false);
+  std::thread slow([&]() {
+    bool hit;
+    cache.get(make_request(kRequest),
+              [&started]() {
+                started = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+                return std::string("slow");
+              },
+              hit);
+  });
+  while (!started) {
+    std::this_thread::yield();
+  }
+
+  bool hit;
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(cache.get(make_request(kRequest), []() { return std::string("fast"); }, hit), "fast");
+  EXPECT_FALSE(hit);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(1000));
+
+  // and a waiter whose client went away stops right away
+  std::function<void()> interrupt = []() { throw std::runtime_error("client went away"); };
+  EXPECT_THROW(cache.get(make_request(kRequest), []() { return std::string("fast"); }, hit,
+                         &interrupt),
+               std::runtime_error);
+  slow.join();
+}
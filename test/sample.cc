@@ -8,6 +8,7 @@
 #include <cmath>
 #include <fstream>
 #include <list>
+#include <thread>
 
 #include "test.h"
 
@@ -67,6 +68,13 @@ TEST(Sample, create_tile) {
 
   // gzip it
   EXPECT_TRUE(baldr::deflate(src_func, dst_func)) << "Can't write gzipped elevation tile";
+
+  // block compressed from the gzipped one
+  std::vector<int16_t> loaded;
+  ASSERT_TRUE(skadi::sample::load_tile("test/data/samplegz/N40/N40W077.hgt.gz", loaded));
+  EXPECT_EQ(loaded, tile);
+  EXPECT_TRUE(skadi::sample::store_blocks("test/data/samplebl/N40/N40W077.hgt.blk", loaded))
+      << "Can't write block compressed elevation tile";
 }
 
 void _get(const std::string& location) {
@@ -103,6 +111,93 @@ TEST(Sample, getgz) {
   _get("test/data/samplegz");
 };
 
+TEST(Sample, getbl) {
+  _get("test/data/samplebl");
+};
+
+TEST(Sample, blocks_match_raw) {
+  skadi::sample raw("test/data/sample");
+  skadi::sample blocks("test/data/samplebl");
+  // postings all over the tile including block edges, the bottom row and the right column
+  std::vector<std::pair<double, double>> postings{{-76.5, 41.0 - 1e-9}, {-76.0 - 1e-9, 40.5}};
+  for (int i = 0; i < 1000; ++i) {
+    postings.emplace_back(-77.0 + (i % 37) * 0.027, 40.0 + (i % 23) * 0.0434);
+  }
+  for (int i = 0; i <= 15; ++i) {
+    postings.emplace_back(-77.0 + i * 256.0 / 3600, 40.0 + (3600 - i * 256.0) / 3600);
+  }
+
+  auto expected = raw.get_all(postings);
+  auto actual = blocks.get_all(postings);
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < postings.size(); ++i) {
+    EXPECT_EQ(actual[i], expected[i]) << "posting " << i;
+    EXPECT_EQ(blocks.get(postings[i]), expected[i]) << "posting " << i;
+  }
+
+  // only a block at a time is inflated
+  skadi::sample single("test/data/samplebl");
+  EXPECT_NEAR(490, single.get(std::make_pair(-76.503915, 40.678783)), 1.0);
+  auto stats = single.cache_stats();
+  EXPECT_EQ(stats.tiles, 1);
+  EXPECT_LE(stats.bytes, 256 * 256 * sizeof(int16_t));
+}
+
+TEST(Sample, get_all_matches_get) {
+  skadi::sample s("test/data/sample");
+  // postings in and around the tile, out of order, including the bottom row and no data
+  std::vector<std::pair<double, double>> postings{{200.0, 200.0}, {-76.5, 41.0 - 1e-9}};
+  for (int i = 0; i < 1000; ++i) {
+    postings.emplace_back(-77.2 + (i % 37) * 0.04, 39.9 + (i % 23) * 0.05);
+  }
+  postings.emplace_back(-76.5, 40.0);
+
+  auto batch = s.get_all(postings);
+  ASSERT_EQ(batch.size(), postings.size());
+  for (size_t i = 0; i < postings.size(); ++i) {
+    EXPECT_EQ(batch[i], s.get(postings[i])) << "posting " << i;
+  }
+}
+
+TEST(Sample, gz_cache) {
+  skadi::sample s("test/data/samplegz");
+  EXPECT_NEAR(490, s.get(std::make_pair(-76.503915, 40.678783)), 1.0);
+  EXPECT_NEAR(134, s.get(std::make_pair(-76.9, 40.0)), 1.0);
+  auto stats = s.cache_stats();
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.tiles, 1);
+  EXPECT_EQ(stats.bytes, 3601 * 3601 * sizeof(int16_t));
+
+  // a cache too small for a single tile still keeps the one in use
+  skadi::sample tiny("test/data/samplegz", 0);
+  EXPECT_NEAR(490, tiny.get(std::make_pair(-76.503915, 40.678783)), 1.0);
+  EXPECT_NEAR(490, tiny.get(std::make_pair(-76.503915, 40.678783)), 1.0);
+  EXPECT_EQ(tiny.cache_stats().tiles, 1);
+}
+
+TEST(Sample, gz_threads) {
+  skadi::sample s("test/data/samplegz");
+  std::vector<std::thread> threads;
+  std::vector<double> heights(4);
+  for (size_t i = 0; i < heights.size(); ++i) {
+    threads.emplace_back([&s, &heights, i]() {
+      for (int j = 0; j < 10; ++j) {
+        heights[i] += s.get(std::make_pair(-76.503915, 40.678783));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto height : heights) {
+    EXPECT_NEAR(4900, height, 10.0);
+  }
+  auto stats = s.cache_stats();
+  EXPECT_EQ(stats.hits + stats.misses, 40);
+  EXPECT_EQ(stats.tiles, 1);
+}
+
 struct testable_sample_t : public skadi::sample {
   testable_sample_t(const std::string& dir) : sample(dir) {
     {
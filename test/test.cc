@@ -228,7 +228,6 @@ boost::property_tree::ptree make_config(const std::string& path_prefix,
         },
         "global_synchronized_cache": false,
         "hierarchy": true,
-        "id_table_size": 1300000000,
         "import_bike_share_stations": false,
         "include_bicycle": true,
         "include_driveways": true,
@@ -0,0 +1,165 @@
+#include "mjolnir/trafficbuilder.h"
+#include "baldr/traffictile.h"
+#include "midgard/sequence.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "microtar.h"
+#include "test.h"
+
+using namespace valhalla::baldr;
+using namespace valhalla::mjolnir;
+
+namespace {
+
+const std::string kExtract = "traffic_updater.tar";
+const GraphId kTile(2, 1, 0);
+
+// one tile with a few blank edges, the last of which has an incident on it
+void write_extract(uint32_t edge_count) {
+  TrafficTileHeader header{};
+  header.tile_id = kTile.value;
+  header.traffic_tile_version = TRAFFIC_TILE_VERSION;
+  header.directed_edge_count = edge_count;
+  std::string data(sizeof(header) + edge_count * sizeof(TrafficSpeed) + 2 * sizeof(uint32_t), '\0');
+  std::memcpy(&data[0], &header, sizeof(header));
+  TrafficSpeed incident{};
+  incident.has_incidents = true;
+  std::memcpy(&data[sizeof(header) + (edge_count - 1) * sizeof(TrafficSpeed)], &incident,
+              sizeof(incident));
+
+  mtar_t tar;
+  ASSERT_EQ(mtar_open(&tar, kExtract.c_str(), "w"), MTAR_ESUCCESS);
+  mtar_write_file_header(&tar, GraphTile::FileSuffix(kTile).c_str(), data.size());
+  mtar_write_data(&tar, data.data(), data.size());
+  mtar_finalize(&tar);
+  mtar_close(&tar);
+}
+
+// what a reader mapping the extract sees
+TrafficSpeed read_speed(uint32_t id) {
+  valhalla::midgard::tar extract(kExtract);
+  auto entry = extract.contents.find(GraphTile::FileSuffix(kTile));
+  EXPECT_NE(entry, extract.contents.cend());
+  TrafficSpeed speed;
+  std::memcpy(&speed, entry->second.first + sizeof(TrafficTileHeader) + id * sizeof(TrafficSpeed),
+              sizeof(speed));
+  return speed;
+}
+
+TEST(TrafficUpdater, parse_overall_speed) {
+  GraphId edge_id;
+  TrafficSpeed speed;
+  ASSERT_TRUE(TrafficUpdater::Parse("1/2/3,50", edge_id, speed));
+  EXPECT_EQ(edge_id, GraphId(2, 1, 3));
+  EXPECT_TRUE(speed.speed_valid());
+  EXPECT_EQ(speed.get_overall_speed(), 50);
+  EXPECT_EQ(speed.get_speed(0), 50);
+  EXPECT_EQ(speed.breakpoint1, 255);
+  EXPECT_EQ(speed.congestion1, UNKNOWN_CONGESTION_VAL);
+
+  // numeric ids, congestion and windows line endings
+  ASSERT_TRUE(TrafficUpdater::Parse(std::to_string(GraphId(2, 1, 3).value) + ",20,1\r", edge_id,
+                                    speed));
+  EXPECT_EQ(edge_id, GraphId(2, 1, 3));
+  EXPECT_EQ(speed.get_overall_speed(), 20);
+  EXPECT_EQ(speed.congestion1, MAX_CONGESTION_VAL);
+  ASSERT_TRUE(TrafficUpdater::Parse("1/2/3,20,0", edge_id, speed));
+  EXPECT_EQ(speed.congestion1, 1);
+
+  // closures and unknowns
+  ASSERT_TRUE(TrafficUpdater::Parse("1/2/3,0", edge_id, speed));
+  EXPECT_TRUE(speed.closed());
+  ASSERT_TRUE(TrafficUpdater::Parse("1/2/3,", edge_id, speed));
+  EXPECT_FALSE(speed.speed_valid());
+}
+
+TEST(TrafficUpdater, parse_subsegments) {
+  GraphId edge_id;
+  TrafficSpeed speed;
+  ASSERT_TRUE(TrafficUpdater::Parse("1/2/3,40,0.5,0.5,,,1,,", edge_id, speed));
+  EXPECT_EQ(speed.get_overall_speed(), 40);
+  EXPECT_EQ(speed.breakpoint1, 128);
+  EXPECT_EQ(speed.breakpoint2, 255);
+  EXPECT_EQ(speed.encoded_speed2, UNKNOWN_TRAFFIC_SPEED_RAW);
+
+  // the time it takes to get through both halves
+  ASSERT_TRUE(TrafficUpdater::Parse("1/2/3,20,,0.5,60,,1,,", edge_id, speed));
+  EXPECT_NEAR(speed.get_overall_speed(), 30, 2);
+  EXPECT_EQ(speed.get_speed(0), 20);
+  EXPECT_EQ(speed.get_speed(1), 60);
+
+  // nothing known at all
+  ASSERT_TRUE(TrafficUpdater::Parse("1/2/3,,,0.5,,,1,,", edge_id, speed));
+  EXPECT_FALSE(speed.speed_valid());
+}
+
+TEST(TrafficUpdater, parse_garbage) {
+  GraphId edge_id;
+  TrafficSpeed speed;
+  EXPECT_FALSE(TrafficUpdater::Parse("", edge_id, speed));
+  EXPECT_FALSE(TrafficUpdater::Parse("# edge_id,speed", edge_id, speed));
+  EXPECT_FALSE(TrafficUpdater::Parse("1/2/3", edge_id, speed));
+  EXPECT_FALSE(TrafficUpdater::Parse("1/2/3,fast", edge_id, speed));
+  EXPECT_FALSE(TrafficUpdater::Parse("1/2/3,-5", edge_id, speed));
+  EXPECT_FALSE(TrafficUpdater::Parse("1/2/3,500", edge_id, speed));
+  EXPECT_FALSE(TrafficUpdater::Parse("1/2/3,50,2", edge_id, speed));
+  EXPECT_FALSE(TrafficUpdater::Parse("1/2/3,50,,1,", edge_id, speed));
+  // breakpoints have to go forward
+  EXPECT_FALSE(TrafficUpdater::Parse("1/2/3,20,,0.8,60,,0.2,,", edge_id, speed));
+}
+
+TEST(TrafficUpdater, update_in_place) {
+  write_extract(3);
+  TrafficUpdater updater(kExtract);
+  EXPECT_EQ(updater.size(), 1);
+
+  std::stringstream csv;
+  csv << "# edge_id,speed,congestion\n"
+      << "1/2/0,50,0.25\n"
+      << "1/2/2,30\n"
+      << "1/2/3,30\n"   // past the end of the tile
+      << "1/3/0,30\n"   // not in the extract
+      << "nonsense\n";
+  EXPECT_EQ(updater.Update(csv), 2);
+
+  auto first = read_speed(0);
+  EXPECT_TRUE(first.speed_valid());
+  EXPECT_EQ(first.get_overall_speed(), 50);
+  EXPECT_FALSE(first.has_incidents);
+  EXPECT_FALSE(read_speed(1).speed_valid());
+
+  // the speed changed but the incident stayed
+  auto last = read_speed(2);
+  EXPECT_EQ(last.get_overall_speed(), 30);
+  EXPECT_TRUE(last.has_incidents);
+
+  // and the tile knows when
+  valhalla::midgard::tar extract(kExtract);
+  const auto* header = reinterpret_cast<const TrafficTileHeader*>(
+      extract.contents.find(GraphTile::FileSuffix(kTile))->second.first);
+  EXPECT_GT(header->last_update, 0);
+
+  // back to unknown
+  csv.clear();
+  csv.str("1/2/0,\n");
+  EXPECT_EQ(updater.Update(csv), 1);
+  EXPECT_FALSE(read_speed(0).speed_valid());
+  std::remove(kExtract.c_str());
+}
+
+TEST(TrafficUpdater, no_tiles) {
+  mtar_t tar;
+  ASSERT_EQ(mtar_open(&tar, kExtract.c_str(), "w"), MTAR_ESUCCESS);
+  mtar_write_file_header(&tar, "not_a_tile.txt", 3);
+  mtar_write_data(&tar, "abc", 3);
+  mtar_finalize(&tar);
+  mtar_close(&tar);
+  EXPECT_THROW(TrafficUpdater updater(kExtract), std::runtime_error);
+  std::remove(kExtract.c_str());
+}
+
+} // namespace
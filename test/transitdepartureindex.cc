@@ -0,0 +1,188 @@
+#include "baldr/transitdepartureindex.h"
+
+#include <algorithm>
+#include <random>
+
+#include "test.h"
+
+using namespace valhalla::baldr;
+
+namespace {
+
+// Walks every departure of the line the way the tile used to once it had found the line
+uint32_t find_by_scanning(const std::vector<TransitDeparture>& departures,
+                          const std::vector<TransitSchedule>& schedules,
+                          uint32_t lineid,
+                          uint32_t current_time,
+                          uint32_t day,
+                          uint32_t dow,
+                          bool date_before_tile,
+                          bool wheelchair,
+                          bool bicycle,
+                          uint32_t& departure_time) {
+  for (uint32_t i = 0; i < departures.size(); ++i) {
+    const auto& d = departures[i];
+    if (d.lineid() != lineid || !schedules[d.schedule_index()].IsValid(day, dow, date_before_tile) ||
+        (wheelchair && !d.wheelchair_accessible()) || (bicycle && !d.bicycle_accessible())) {
+      continue;
+    }
+    uint32_t time = d.departure_time();
+    if (d.type() == kFixedSchedule) {
+      if (time >= current_time) {
+        departure_time = time;
+        return i;
+      }
+      continue;
+    }
+    while (time < current_time && time < d.end_time()) {
+      time += d.frequency();
+    }
+    if (time >= current_time && time < d.end_time()) {
+      departure_time = time;
+      return i;
+    }
+  }
+  return TransitDepartureIndex::kNotFound;
+}
+
+TEST(TransitDepartureIndex, fixed_and_frequency) {
+  std::vector<TransitSchedule> schedules{{~0ULL, kAllDaysOfWeek, 63}, {1ULL << 2, kMonday, 10}};
+  // line 5 has fixed departures at 9000, 10000 and 12000 followed by a bus every 10 minutes from
+  // 8000 until 18000, only the departure at 10000 takes bikes and the one at 12000 runs on day 2
+  std::vector<TransitDeparture> departures{
+      {1, 1, 1, 1, 0, 7000, 60, 0, false, false},
+      {5, 2, 1, 1, 0, 9000, 60, 0, false, false},
+      {5, 3, 1, 1, 0, 10000, 60, 0, false, true},
+      {5, 4, 1, 1, 0, 12000, 60, 1, false, false},
+      {5, 5, 1, 1, 0, 8000, 18000, 600, 60, 0, false, false},
+      {9, 6, 1, 1, 0, 7000, 60, 0, true, false},
+  };
+  TransitDepartureIndex index(departures.data(), departures.size(), schedules.data(),
+                              schedules.size());
+  EXPECT_EQ(index.lines(), 3);
+
+  uint32_t time = 0;
+  EXPECT_EQ(index.Find(5, 8500, 0, kSunday, false, false, false, time), 1);
+  EXPECT_EQ(time, 9000);
+  EXPECT_EQ(index.Find(5, 9000, 0, kSunday, false, false, false, time), 1);
+  EXPECT_EQ(index.Find(5, 9001, 0, kSunday, false, false, false, time), 2);
+  EXPECT_EQ(time, 10000);
+  EXPECT_EQ(index.Find(5, 8500, 0, kSunday, false, false, true, time), 2);
+
+  // the departure at 12000 doesnt run today so we get the next bus
+  EXPECT_EQ(index.Find(5, 10001, 0, kSunday, false, false, false, time), 4);
+  EXPECT_EQ(time, 10400);
+  EXPECT_EQ(index.Find(5, 10001, 2, kSunday, false, false, false, time), 3);
+  EXPECT_EQ(time, 12000);
+
+  // past the end day only the days of the week count
+  EXPECT_EQ(index.Find(5, 10001, 20, kMonday, false, false, false, time), 3);
+  EXPECT_EQ(index.Find(5, 10001, 2, kMonday, true, false, false, time), 3);
+  EXPECT_EQ(index.Find(5, 10001, 2, kSunday, true, false, false, time), 4);
+
+  // the last bus leaves before 18000
+  EXPECT_EQ(index.Find(5, 17600, 0, kSunday, false, false, false, time), 4);
+  EXPECT_EQ(time, 17600);
+  EXPECT_EQ(index.Find(5, 17601, 0, kSunday, false, false, false, time),
+            TransitDepartureIndex::kNotFound);
+
+  // following a trip ignores its schedule
+  EXPECT_EQ(index.FindTrip(5, 4, 9001, time), 3);
+  EXPECT_EQ(time, 12000);
+  EXPECT_EQ(index.FindTrip(5, 5, 10001, time), 4);
+  EXPECT_EQ(time, 10400);
+  EXPECT_EQ(index.FindTrip(5, 2, 9001, time), TransitDepartureIndex::kNotFound);
+  EXPECT_EQ(index.FindTrip(5, 6, 0, time), TransitDepartureIndex::kNotFound);
+
+  EXPECT_EQ(index.Find(9, 0, 0, kSunday, false, true, false, time), 5);
+  EXPECT_EQ(index.Find(9, 0, 0, kSunday, false, false, true, time),
+            TransitDepartureIndex::kNotFound);
+  for (uint32_t lineid : {0, 2, 6, 10, 1000}) {
+    EXPECT_EQ(index.Find(lineid, 0, 0, kSunday, false, false, false, time),
+              TransitDepartureIndex::kNotFound)
+        << "line " << lineid << " has no departures";
+  }
+}
+
+TEST(TransitDepartureIndex, bad_input) {
+  std::vector<TransitSchedule> schedules{{~0ULL, kAllDaysOfWeek, 63}};
+  std::vector<TransitDeparture> departures{{4, 1, 1, 1, 0, 7000, 60, 0, false, false},
+                                           {4, 2, 1, 1, 0, 8000, 60, 7, false, false}};
+  TransitDepartureIndex index(departures.data(), departures.size(), schedules.data(),
+                              schedules.size());
+
+  // the departure with a missing schedule is never taken
+  uint32_t time = 0;
+  EXPECT_EQ(index.Find(4, 7500, 0, kSunday, false, false, false, time),
+            TransitDepartureIndex::kNotFound);
+
+  std::reverse(departures.begin(), departures.end());
+  departures.front() = {5, 2, 1, 1, 0, 8000, 60, 0, false, false};
+  EXPECT_THROW(TransitDepartureIndex(departures.data(), departures.size(), schedules.data(),
+                                     schedules.size()),
+               std::runtime_error);
+
+  TransitDepartureIndex empty;
+  EXPECT_EQ(empty.lines(), 0);
+  EXPECT_EQ(empty.Find(4, 0, 0, kSunday, false, false, false, time),
+            TransitDepartureIndex::kNotFound);
+  EXPECT_EQ(TransitDepartureIndex(nullptr, 0, nullptr, 0).Find(4, 0, 0, kSunday, false, false,
+                                                                false, time),
+            TransitDepartureIndex::kNotFound);
+}
+
+TEST(TransitDepartureIndex, matches_scanning) {
+  std::mt19937 generator(17);
+  auto random = [&generator](uint32_t n) {
+    return std::uniform_int_distribution<uint32_t>(0, n - 1)(generator);
+  };
+
+  std::vector<TransitSchedule> schedules;
+  for (int i = 0; i < 20; ++i) {
+    schedules.emplace_back((uint64_t(generator()) << 32) | generator(), random(128), random(64));
+  }
+  std::vector<TransitDeparture> departures;
+  for (uint32_t i = 0; i < 5000; ++i) {
+    uint32_t lineid = random(60) * 3;
+    uint32_t departure_time = random(86400);
+    if (random(5) == 0) {
+      departures.emplace_back(lineid, i, 1, 1, 0, departure_time,
+                              departure_time + random(20000) + 1, random(1800) + 1, 60,
+                              random(schedules.size()), random(2), random(2));
+    } else {
+      departures.emplace_back(lineid, i, 1, 1, 0, departure_time, 60, random(schedules.size()),
+                              random(2), random(2));
+    }
+  }
+  std::sort(departures.begin(), departures.end());
+  TransitDepartureIndex index(departures.data(), departures.size(), schedules.data(),
+                              schedules.size());
+
+  for (int i = 0; i < 20000; ++i) {
+    uint32_t lineid = random(185), current_time = random(100000), day = random(70),
+             dow = 1 << random(7);
+    bool date_before_tile = random(4) == 0, wheelchair = random(2), bicycle = random(2);
+    uint32_t expected_time = 0, time = 0;
+    auto expected = find_by_scanning(departures, schedules, lineid, current_time, day, dow,
+                                     date_before_tile, wheelchair, bicycle, expected_time);
+    auto found =
+        index.Find(lineid, current_time, day, dow, date_before_tile, wheelchair, bicycle, time);
+    ASSERT_EQ(found, expected) << "line " << lineid << " at " << current_time;
+    if (found != TransitDepartureIndex::kNotFound) {
+      ASSERT_EQ(time, expected_time) << "line " << lineid << " at " << current_time;
+    }
+
+    // the trip of the departure found is also found when following it
+    if (found != TransitDepartureIndex::kNotFound) {
+      ASSERT_EQ(index.FindTrip(lineid, departures[found].tripid(), current_time, time), found);
+      ASSERT_EQ(time, expected_time);
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
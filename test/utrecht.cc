@@ -52,7 +52,6 @@ OSMWay GetWay(uint32_t way_id, sequence<OSMWay>& ways) {
 TEST(Utrecth, TestBike) {
   boost::property_tree::ptree conf;
   conf.put<std::string>("mjolnir.tile_dir", "test/data/parser_tiles");
-  conf.put<unsigned long>("mjolnir.id_table_size", 1000);
 
   sequence<OSMWay> ways(ways_file, false);
   ways.sort(way_predicate);
@@ -191,7 +190,6 @@ TEST(Utrecth, TestBike) {
 TEST(Utrecht, TestBus) {
   boost::property_tree::ptree conf;
   conf.put<std::string>("mjolnir.tile_dir", "test/data/parser_tiles");
-  conf.put<unsigned long>("mjolnir.id_table_size", 1000);
 
   sequence<OSMWay> ways(ways_file, false);
   ways.sort(way_predicate);
@@ -215,7 +213,6 @@ public:
   void SetUp() override {
     boost::property_tree::ptree conf;
     conf.put<std::string>("mjolnir.tile_dir", "test/data/parser_tiles");
-    conf.put<unsigned long>("mjolnir.id_table_size", 1000);
 
     auto osmdata =
         PBFGraphParser::ParseWays(conf.get_child("mjolnir"),
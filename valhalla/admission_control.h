@@ -0,0 +1,89 @@
+#ifndef __VALHALLA_ADMISSION_CONTROL_H__
+#define __VALHALLA_ADMISSION_CONTROL_H__
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <valhalla/proto/api.pb.h>
+
+namespace valhalla {
+
+/**
+ * Limits how many requests of each action are worked on at the same time within a process. Each
+ * configured action gets a lane with a fixed number of slots, requests beyond that wait in the
+ * lane until a slot frees up. Requests are given a rough cost from how many locations they have
+ * and how far apart those are, expensive ones only get a slot once no cheap requests are waiting
+ * and are turned away outright while the lane is missing its latency target. Anything waiting too
+ * long or arriving to a full queue is turned away as well (error 103). Since waiting requests block
+ * their worker thread the queue never holds more than the worker threads the lanes concurrency
+ * leaves over (httpd.service.worker_concurrency, set by the service).
+ *
+ * Queue depth, wait time and shed requests are added to the requests statistics so they go out to
+ * statsd with everything else.
+ */
+class admission_control_t {
+public:
+  struct lane_t;
+
+  /**
+   * Holds a slot in a lane until it is destroyed. Tickets for unconfigured actions hold nothing.
+   */
+  class ticket_t {
+  public:
+    ticket_t() : lane(nullptr) {
+    }
+    ticket_t(ticket_t&& other) : lane(other.lane), arrived(other.arrived) {
+      other.lane = nullptr;
+    }
+    ticket_t(const ticket_t&) = delete;
+    ticket_t& operator=(const ticket_t&) = delete;
+    ~ticket_t();
+
+  protected:
+    friend class admission_control_t;
+    lane_t* lane;
+    std::chrono::steady_clock::time_point arrived;
+  };
+
+  /**
+   * @param config  the whole service config, lanes are read from httpd.service.admission
+   */
+  admission_control_t(const boost::property_tree::ptree& config);
+  ~admission_control_t();
+
+  /**
+   * Returns the one admission controller for this process or nullptr if no action has a lane
+   * @param config  the whole service config, only the first call configures it
+   */
+  static std::shared_ptr<admission_control_t>
+  get_instance(const boost::property_tree::ptree& config);
+
+  /**
+   * A rough measure of how much work a request is, the number of locations (or source target pairs,
+   * or contours) times the distance in kilometers spanned by them
+   * @param options  the parsed request options
+   * @return the cost
+   */
+  static float estimate_cost(const Options& options);
+
+  /**
+   * Waits for a slot in the lane of the requests action. Throws valhalla_exception_t{103} if the
+   * request is shed and whatever the interrupt throws if the client gives up while waiting.
+   *
+   * @param request    the request, queue and wait statistics are added to it
+   * @param interrupt  called periodically while waiting, may be nullptr
+   * @return the ticket holding the slot, the slot is given back when it goes out of scope
+   */
+  ticket_t admit(Api& request, const std::function<void()>* interrupt = nullptr);
+
+protected:
+  std::unordered_map<int, std::unique_ptr<lane_t>> lanes;
+};
+
+} // namespace valhalla
+
+#endif //__VALHALLA_ADMISSION_CONTROL_H__
@@ -0,0 +1,135 @@
+#ifndef VALHALLA_BALDR_ARCFLAGS_H_
+#define VALHALLA_BALDR_ARCFLAGS_H_
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/midgard/aabb2.h>
+#include <valhalla/midgard/pointll.h>
+#include <valhalla/proto/options.pb.h>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * Arc flags for the edges of the highway and arterial levels. The area the graph covers is split
+ * into a grid of regions and every edge gets a bit per region, set if the edge is on a shortest
+ * path to a node in the region (to) or from one (from). A search towards a destination can then
+ * skip the edges that aren't flagged to the regions around it.
+ *
+ * The flags of the edges of a tile are kept in a side array of its own, in the order of the edges
+ * of the tile. Shortcuts have all their flags set.
+ */
+class ArcFlags {
+public:
+  using flags_t = uint64_t;
+  static constexpr uint32_t kRegionColumns = 8;
+  static constexpr uint32_t kRegionRows = 8;
+  static constexpr flags_t kAllRegions = std::numeric_limits<flags_t>::max();
+
+  // The regions an edge leads to and comes from on shortest paths
+  struct edge_flags_t {
+    flags_t to;
+    flags_t from;
+  };
+
+  // A tile and the number of edges in it
+  struct tile_t {
+    uint64_t id;
+    uint32_t offset;
+    uint32_t edge_count;
+  };
+
+  /**
+   * Empty flags, without any tiles
+   */
+  ArcFlags();
+
+  /**
+   * Makes room for the flags of the edges of the tiles, none of them set
+   * @param costing  the costing the shortest paths are for
+   * @param bounds   the area the regions split up
+   * @param tiles    the tiles and their edge counts, the offsets are filled in
+   */
+  ArcFlags(const Costing costing,
+           const midgard::AABB2<midgard::PointLL>& bounds,
+           std::vector<tile_t> tiles);
+
+  /**
+   * Reads arc flags written by Save. Throws std::runtime_error if the file cannot be read or does
+   * not hold arc flags
+   * @param file_name  the arc flag file
+   */
+  static ArcFlags Load(const std::string& file_name);
+
+  /**
+   * Writes the arc flags, throws std::runtime_error if the file cannot be written
+   * @param file_name  the arc flag file
+   */
+  void Save(const std::string& file_name) const;
+
+  /**
+   * @return the costing the shortest paths are for
+   */
+  Costing costing() const {
+    return static_cast<Costing>(costing_);
+  }
+
+  /**
+   * The region a location is in, locations outside of the area are in the closest region
+   * @param ll  the location
+   * @return the number of the region
+   */
+  uint32_t Region(const midgard::PointLL& ll) const;
+
+  /**
+   * The regions within a distance of a location
+   * @param ll      the location
+   * @param radius  the distance in meters
+   * @return a bit for each of the regions
+   */
+  flags_t Regions(const midgard::PointLL& ll, const float radius) const;
+
+  /**
+   * @return the tiles sorted by id with the offsets of their edges
+   */
+  const std::vector<tile_t>& tiles() const {
+    return tiles_;
+  }
+
+  /**
+   * @return the number of edges in all the tiles
+   */
+  uint32_t edge_count() const {
+    return flags_.size();
+  }
+
+  /**
+   * The flags of an edge
+   * @param edgeid  the edge
+   * @return its flags or nullptr if its tile doesnt have any
+   */
+  const edge_flags_t* flags(const GraphId& edgeid) const;
+
+  /**
+   * The flags of an edge by its number, the offset of its tile plus its id
+   */
+  edge_flags_t& flags(const uint32_t index) {
+    return flags_[index];
+  }
+
+protected:
+  uint32_t costing_;
+  double min_lng_, min_lat_, max_lng_, max_lat_;
+  // sorted by tile id
+  std::vector<tile_t> tiles_;
+  std::vector<edge_flags_t> flags_;
+};
+
+} // namespace baldr
+} // namespace valhalla
+
+#endif // VALHALLA_BALDR_ARCFLAGS_H_
@@ -0,0 +1,176 @@
+#ifndef VALHALLA_BALDR_CELLPARTITION_H_
+#define VALHALLA_BALDR_CELLPARTITION_H_
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <valhalla/baldr/directededge.h>
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/midgard/pointll.h>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * Splits the graph into cells, one per tile of the local (most detailed) level. Every node of every
+ * level belongs to the cell its location falls in, so transitions between levels never leave a
+ * cell. The edges that go from one cell to another are its boundary: they are the exits of the cell
+ * they start in and the entries of the cell they end in. An overlay can then replace the inside of
+ * a cell with the costs of getting from each of its entries to each of its exits.
+ *
+ * Shortcuts and edges to or from the transit level are not part of the partition.
+ */
+class CellPartition {
+public:
+  static constexpr uint32_t kInvalidCell = std::numeric_limits<uint32_t>::max();
+
+  // An edge that goes from one cell to another
+  struct cut_edge_t {
+    GraphId edgeid;
+    uint32_t from_cell; // the id of the cell its start node is in
+    uint32_t to_cell;   // the id of the cell its end node is in
+  };
+
+  /**
+   * An empty partition
+   */
+  CellPartition();
+
+  /**
+   * Builds the partition from the edges between cells, in any order
+   * @param cut_edges  the edges whose start and end nodes are in different cells
+   */
+  explicit CellPartition(std::vector<cut_edge_t> cut_edges);
+
+  /**
+   * Reads a partition written by Save. Throws std::runtime_error if the file cannot be read or is
+   * not a partition
+   * @param file_name  the partition file
+   */
+  static CellPartition Load(const std::string& file_name);
+
+  /**
+   * Writes the partition, throws std::runtime_error if the file cannot be written
+   * @param file_name  the partition file
+   */
+  void Save(const std::string& file_name) const;
+
+  /**
+   * Whether an edge can be part of the partition
+   * @param edge  the directed edge
+   */
+  static bool Partitions(const DirectedEdge* edge);
+
+  /**
+   * The id of the cell a node is in
+   * @param node  the node
+   * @param ll    its location, only used when the node isnt on the local level
+   */
+  static uint32_t CellOf(const GraphId& node, const midgard::PointLL& ll);
+
+  /**
+   * @return the number of cells that have edges to or from other cells
+   */
+  uint32_t cell_count() const {
+    return cells_.size() - 1;
+  }
+
+  /**
+   * Finds a cell by id
+   * @param cell_id  the id of the cell, see CellOf
+   * @return its index or kInvalidCell if no edges enter or leave it
+   */
+  uint32_t Find(const uint32_t cell_id) const;
+
+  /**
+   * @param cell  the index of the cell
+   * @return the id of the cell
+   */
+  uint32_t id(const uint32_t cell) const {
+    return cells_[cell].id;
+  }
+
+  /**
+   * The edges entering a cell, they are numbered from 0 within each cell and from entry_offset
+   * over all the cells
+   */
+  const GraphId* entries(const uint32_t cell) const {
+    return entries_.data() + cells_[cell].entry_begin;
+  }
+  uint32_t entry_count(const uint32_t cell) const {
+    return cells_[cell + 1].entry_begin - cells_[cell].entry_begin;
+  }
+  uint32_t entry_offset(const uint32_t cell) const {
+    return cells_[cell].entry_begin;
+  }
+
+  /**
+   * The edges leaving a cell, they are numbered from 0 within each cell and from exit_offset over
+   * all the cells
+   */
+  const GraphId* exits(const uint32_t cell) const {
+    return exits_.data() + cells_[cell].exit_begin;
+  }
+  uint32_t exit_count(const uint32_t cell) const {
+    return cells_[cell + 1].exit_begin - cells_[cell].exit_begin;
+  }
+  uint32_t exit_offset(const uint32_t cell) const {
+    return cells_[cell].exit_begin;
+  }
+
+  /**
+   * @return the number of edges between cells
+   */
+  uint32_t cut_edge_count() const {
+    return entries_.size();
+  }
+
+  /**
+   * Finds the cell an edge enters
+   * @param edgeid  the edge
+   * @param cell    set to the index of the cell it enters
+   * @param index   set to its number among the entries of that cell
+   * @return false if the edge doesnt go from one cell to another
+   */
+  bool FindEntry(const GraphId& edgeid, uint32_t& cell, uint32_t& index) const;
+
+  /**
+   * Finds the cell an edge leaves
+   * @param edgeid  the edge
+   * @param cell    set to the index of the cell it leaves
+   * @param index   set to its number among the exits of that cell
+   * @return false if the edge doesnt go from one cell to another
+   */
+  bool FindExit(const GraphId& edgeid, uint32_t& cell, uint32_t& index) const;
+
+protected:
+  struct cell_t {
+    uint32_t id;
+    uint32_t entry_begin;
+    uint32_t exit_begin;
+  };
+  struct boundary_t {
+    uint64_t edgeid;
+    uint32_t cell;
+    uint32_t index;
+  };
+
+  // fills in the lookups from the cells, entries and exits
+  void Index();
+
+  // sorted by id with a sentinel at the end that marks the end of the last cell's edges
+  std::vector<cell_t> cells_;
+  // the boundary edges of each cell, sorted by edge id within the cell
+  std::vector<GraphId> entries_;
+  std::vector<GraphId> exits_;
+  // the boundary edges of all cells sorted by edge id
+  std::vector<boundary_t> entry_lookup_;
+  std::vector<boundary_t> exit_lookup_;
+};
+
+} // namespace baldr
+} // namespace valhalla
+
+#endif // VALHALLA_BALDR_CELLPARTITION_H_
@@ -12,6 +12,7 @@
 #include <valhalla/baldr/curler.h>
 #include <valhalla/baldr/graphid.h>
 #include <valhalla/baldr/graphtile.h>
+#include <valhalla/baldr/incidentindex.h>
 #include <valhalla/baldr/tilegetter.h>
 #include <valhalla/baldr/tilehierarchy.h>
 
@@ -891,12 +892,19 @@ public:
    */
   int GetTimezone(const baldr::GraphId& node, graph_tile_ptr& tile);
 
+  /**
+   * Returns the index of the incident tile for the given tile id
+   * @param tile_id  the tile id for which incidents should be returned
+   * @return the index of the incident tile for the tile id, empty if there are no incidents
+   */
+  virtual std::shared_ptr<const IncidentIndex> GetIncidentIndex(const GraphId& tile_id) const;
+
   /**
    * Returns an incident tile for the given tile id
    * @param tile_id  the tile id for which incidents should be returned
    * @return the incident tile for the tile id
    */
-  virtual std::shared_ptr<const IncidentsTile> GetIncidentTile(const GraphId& tile_id) const;
+  std::shared_ptr<const IncidentsTile> GetIncidentTile(const GraphId& tile_id) const;
 
   /**
    * Returns a vector of incidents for the given edge
@@ -906,6 +914,15 @@ public:
    */
   IncidentResult GetIncidents(const GraphId& edge_id, graph_tile_ptr& tile);
 
+  /**
+   * Returns whether an incident closes the road somewhere along the given edge. This is only an
+   * 8 byte binary search on top of the has_incidents check so it can be used during expansion
+   * @param edge_id   which edge you need to know about
+   * @param tile      which tile the edge lives in, is updated if not correct
+   * @return true if one of the edge's incidents has its road_closed flag set
+   */
+  bool IsClosedByIncident(const GraphId& edge_id, graph_tile_ptr& tile);
+
 protected:
   // (Tar) extract of tiles - the contents are empty if not being used
   struct tile_extract_t {
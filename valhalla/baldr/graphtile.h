@@ -20,6 +20,7 @@
 #include <valhalla/baldr/signinfo.h>
 #include <valhalla/baldr/traffictile.h>
 #include <valhalla/baldr/transitdeparture.h>
+#include <valhalla/baldr/transitdepartureindex.h>
 #include <valhalla/baldr/transitroute.h>
 #include <valhalla/baldr/transitschedule.h>
 #include <valhalla/baldr/transitstop.h>
@@ -469,6 +470,23 @@ public:
    */
   const TransitRoute* GetTransitRoute(const uint32_t idx) const;
 
+  /**
+   * Get the next departure lookup of a transit tile. Departures are found by their index within
+   * the tile, see GetTransitDepartureAt, so frequency based ones are not copied.
+   * @return  Returns the departure index, empty if the tile has no departures.
+   */
+  const TransitDepartureIndex& GetTransitDepartureIndex() const {
+    return departure_index_;
+  }
+
+  /**
+   * Get the transit departure given its index.
+   * @param   idx     Departure index within the tile.
+   * @return  Returns a pointer to the transit departure as it is stored in the tile. For frequency
+   *          based departures this is the first trip.
+   */
+  const TransitDeparture* GetTransitDepartureAt(const uint32_t idx) const;
+
   /**
    * Get the transit schedule given its schedule index.
    * @param   idx     Schedule index within the tile.
@@ -523,13 +541,16 @@ public:
    *                       week so we modulus the time to day based seconds
    * @param  flow_sources  Which speed sources were used in this speed calculation. Optional pointer,
    *                       if nullptr is passed in flow_sources does nothing.
+   * @param  speed_cache   Remembers decoded predicted speeds across calls. Optional pointer, if
+   *                       nullptr is passed in predicted speeds are decoded every time.
    * @return Returns the speed for the edge.
    */
   inline uint32_t GetSpeed(const DirectedEdge* de,
                            uint8_t flow_mask = kConstrainedFlowMask,
                            uint32_t seconds = kInvalidSecondsOfWeek,
                            bool is_truck = false,
-                           uint8_t* flow_sources = nullptr) const {
+                           uint8_t* flow_sources = nullptr,
+                           PredictedSpeedCache* speed_cache = nullptr) const {
     // if they dont want source info we bind it to a temp and no one will miss it
     uint8_t temp_sources;
     if (!flow_sources)
@@ -577,7 +598,9 @@ public:
     if (!invalid_time && (flow_mask & kPredictedFlowMask) && de->has_predicted_speed()) {
       seconds %= midgard::kSecondsPerWeek;
       uint32_t idx = de - directededges_;
-      float speed = predictedspeeds_.speed(idx, seconds);
+      float speed = speed_cache
+                        ? predictedspeeds_.speed(idx, seconds, (id() + idx).value, *speed_cache)
+                        : predictedspeeds_.speed(idx, seconds);
       if (valid_speed(speed)) {
         *flow_sources |= kPredictedFlowMask;
         return static_cast<uint32_t>(partial_live_speed * partial_live_pct +
@@ -769,6 +792,9 @@ protected:
   // Map of operator one stops in this tile.
   std::unordered_map<std::string, std::list<GraphId>> oper_one_stops;
 
+  // Next departure lookup for transit tiles, built when the tile is loaded
+  TransitDepartureIndex departure_index_;
+
   // Pointer to live traffic data (can be nullptr if not active)
   TrafficTile traffic_tile{nullptr};
 
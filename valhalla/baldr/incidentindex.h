@@ -0,0 +1,83 @@
+#ifndef VALHALLA_BALDR_INCIDENTINDEX_H_
+#define VALHALLA_BALDR_INCIDENTINDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <valhalla/proto/incidents.pb.h>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * A compact index over the locations of an incidents tile. There is one 8 byte entry per edge that
+ * has incidents, sorted by edge index, so finding the incidents of an edge is a binary search over
+ * a small contiguous array rather than over the protobuf's repeated field of pointers to messages.
+ * Each entry also records whether one of the edge's incidents closes the road so that costing can
+ * check for incident closures without looking at the metadata. The index keeps the tile alive.
+ */
+class IncidentIndex {
+public:
+  /**
+   * Builds the index. The locations of the tile must be sorted by edge index, see sort_locations
+   * @param tile  the incidents tile to index, must not be null
+   */
+  explicit IncidentIndex(std::shared_ptr<const IncidentsTile> tile);
+
+  /**
+   * Sorts the locations of a tile by edge index, keeping the order of locations on the same edge,
+   * if they are not sorted already. Incident tiles should come sorted but we cant rely on it
+   * @param tile  the tile to sort
+   * @return true if the tile had to be sorted
+   */
+  static bool sort_locations(IncidentsTile& tile);
+
+  /**
+   * Finds the incidents of an edge
+   * @param edge_index  the index of the edge within the tile
+   * @return the range [first, second) of indices into the tile's locations, empty if there are none
+   */
+  std::pair<int, int> find(uint32_t edge_index) const;
+
+  /**
+   * @param edge_index  the index of the edge within the tile
+   * @return true if an incident on the edge has its road_closed flag set
+   */
+  bool closed(uint32_t edge_index) const;
+
+  /**
+   * @return the incidents tile that the index points into
+   */
+  const std::shared_ptr<const IncidentsTile>& tile() const {
+    return tile_;
+  }
+
+  /**
+   * @return the number of edges with incidents on them
+   */
+  size_t size() const {
+    return entries_.size() - 1;
+  }
+
+protected:
+  struct entry_t {
+    uint32_t edge_index;    // the edge within the tile
+    uint32_t location : 31; // the first of the edge's locations, the next entry has the last + 1
+    uint32_t closed : 1;    // whether one of them closes the road
+  };
+  static_assert(sizeof(entry_t) == 8, "Incident index entries should stay compact");
+
+  // the first entry with an edge index that isnt less than the one given
+  std::vector<entry_t>::const_iterator lower_bound(uint32_t edge_index) const;
+
+  std::shared_ptr<const IncidentsTile> tile_;
+  // sorted by edge index with a sentinel at the end that marks the end of the last range
+  std::vector<entry_t> entries_;
+};
+
+} // namespace baldr
+} // namespace valhalla
+
+#endif // VALHALLA_BALDR_INCIDENTINDEX_H_
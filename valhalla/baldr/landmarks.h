@@ -0,0 +1,143 @@
+#ifndef VALHALLA_BALDR_LANDMARKS_H_
+#define VALHALLA_BALDR_LANDMARKS_H_
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/proto/options.pb.h>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * The network distances between every node of the road levels and a few landmarks, one table of
+ * them per costing. They are measured along the edges the costing can use with its default options,
+ * in meters rather than in costs so that they stay a lower bound when the costing options change
+ * the speeds or penalties. By the triangle inequality the distances to and from a landmark bound the
+ * distance between any two nodes from below (the ALT heuristic), which is much tighter than the
+ * great circle distance where the roads have to go around mountains or water.
+ *
+ * The nodes of a tile are numbered from the offset of the tile, the distances of a node are stored
+ * together for all the landmarks.
+ */
+class Landmarks {
+public:
+  static constexpr uint32_t kInvalidTable = std::numeric_limits<uint32_t>::max();
+  static constexpr uint32_t kInvalidNode = std::numeric_limits<uint32_t>::max();
+  // the distance of a node that cant reach or be reached from the landmark
+  static constexpr float kUnreachable = -1.0f;
+
+  // The distances (meters) between a landmark and a node
+  struct distance_t {
+    float from; // from the landmark to the node
+    float to;   // from the node to the landmark
+  };
+
+  // A tile and the number of nodes in it
+  struct tile_t {
+    uint64_t id;
+    uint32_t offset;
+    uint32_t node_count;
+  };
+
+  /**
+   * Empty landmarks, without any tables
+   */
+  Landmarks();
+
+  /**
+   * Makes room for the distances of the nodes of the tiles, all of them unreachable
+   * @param costings        the costings to have a table for
+   * @param landmark_count  the number of landmarks of each table
+   * @param tiles           the tiles and their node counts, the offsets are filled in
+   */
+  Landmarks(const std::vector<Costing>& costings,
+            const uint32_t landmark_count,
+            std::vector<tile_t> tiles);
+
+  /**
+   * Reads landmarks written by Save. Throws std::runtime_error if the file cannot be read or does
+   * not hold landmarks
+   * @param file_name  the landmark file
+   */
+  static Landmarks Load(const std::string& file_name);
+
+  /**
+   * Writes the landmarks, throws std::runtime_error if the file cannot be written
+   * @param file_name  the landmark file
+   */
+  void Save(const std::string& file_name) const;
+
+  /**
+   * @param costing  the costing
+   * @return the index of the table for the costing or kInvalidTable if there isnt one
+   */
+  uint32_t table(const Costing costing) const;
+
+  /**
+   * @return the number of landmarks of each table
+   */
+  uint32_t landmark_count() const {
+    return landmark_count_;
+  }
+
+  /**
+   * @return the number of nodes in all the tiles
+   */
+  uint32_t node_count() const {
+    return node_count_;
+  }
+
+  /**
+   * @return the tiles sorted by id with the offsets of their nodes
+   */
+  const std::vector<tile_t>& tiles() const {
+    return tiles_;
+  }
+
+  /**
+   * Numbers a node of the tiles
+   * @param node  the node
+   * @return its number or kInvalidNode if its tile isnt in the landmarks
+   */
+  uint32_t index(const GraphId& node) const;
+
+  /**
+   * The landmarks of a table
+   */
+  GraphId* landmarks(const uint32_t table) {
+    return landmarks_.data() + static_cast<size_t>(table) * landmark_count_;
+  }
+  const GraphId* landmarks(const uint32_t table) const {
+    return landmarks_.data() + static_cast<size_t>(table) * landmark_count_;
+  }
+
+  /**
+   * The distances between a node and each landmark of a table
+   * @param table  the index of the table
+   * @param index  the number of the node, see index()
+   */
+  distance_t* distances(const uint32_t table, const uint32_t index) {
+    return distances_.data() + (static_cast<size_t>(table) * node_count_ + index) * landmark_count_;
+  }
+  const distance_t* distances(const uint32_t table, const uint32_t index) const {
+    return distances_.data() + (static_cast<size_t>(table) * node_count_ + index) * landmark_count_;
+  }
+
+protected:
+  std::vector<uint32_t> costings_;
+  uint32_t landmark_count_;
+  uint32_t node_count_;
+  // sorted by tile id
+  std::vector<tile_t> tiles_;
+  std::vector<GraphId> landmarks_;
+  std::vector<distance_t> distances_;
+};
+
+} // namespace baldr
+} // namespace valhalla
+
+#endif // VALHALLA_BALDR_LANDMARKS_H_
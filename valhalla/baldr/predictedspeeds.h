@@ -2,6 +2,8 @@
 #define VALHALLA_BALDR_PREDICTEDSPEEDS_H_
 
 #include <array>
+#include <vector>
+
 #include <valhalla/midgard/util.h>
 
 namespace valhalla {
@@ -47,6 +49,83 @@ std::string encode_compressed_speeds(const int16_t* coefficients);
  */
 std::array<int16_t, kCoefficientCount> decode_compressed_speeds(const std::string& encoded);
 
+/**
+ * Remembers the predicted speeds already decoded for an edge and bucket of the week. Time dependent
+ * searches evaluate the same edges in the same bucket over and over and decoding is a 200 term dot
+ * product each time. This is direct mapped so a lookup is a single compare, colliding entries just
+ * replace each other. It is meant to live for the duration of a request and is not thread safe.
+ */
+class PredictedSpeedCache {
+public:
+  /**
+   * Constructor.
+   * @param  log2_size  The cache holds 2^log2_size speeds, the memory is only allocated on first use
+   */
+  explicit PredictedSpeedCache(uint32_t log2_size = 13) : log2_size_(log2_size) {
+  }
+
+  /**
+   * Get a speed that was put into the cache before.
+   * @param  edge_id  The GraphId value of the directed edge.
+   * @param  bucket   The bucket of the week.
+   * @param  speed    Set to the speed if it is cached.
+   * @return Returns true if the speed was cached.
+   */
+  bool get(const uint64_t edge_id, const uint32_t bucket, float& speed) const {
+    if (entries_.empty()) {
+      return false;
+    }
+    const auto key = make_key(edge_id, bucket);
+    const auto& entry = entries_[index(key)];
+    if (entry.key != key) {
+      return false;
+    }
+    speed = entry.speed;
+    return true;
+  }
+
+  /**
+   * Remember a speed, replacing whatever was cached in its slot.
+   * @param  edge_id  The GraphId value of the directed edge.
+   * @param  bucket   The bucket of the week.
+   * @param  speed    The decoded speed.
+   */
+  void put(const uint64_t edge_id, const uint32_t bucket, const float speed) {
+    if (entries_.empty()) {
+      entries_.resize(size_t(1) << log2_size_);
+    }
+    const auto key = make_key(edge_id, bucket);
+    entries_[index(key)] = {key, speed};
+  }
+
+  /**
+   * Forget everything and give the memory back.
+   */
+  void clear() {
+    std::vector<entry_t>().swap(entries_);
+  }
+
+protected:
+  struct entry_t {
+    uint64_t key = kEmpty;
+    float speed = 0.f;
+  };
+  static constexpr uint64_t kEmpty = ~uint64_t(0);
+
+  // graph ids only use the lower 46 bits so the bucket goes above them
+  static uint64_t make_key(const uint64_t edge_id, const uint32_t bucket) {
+    return edge_id | (static_cast<uint64_t>(bucket) << 46);
+  }
+
+  // fibonacci hashing spreads neighbouring edges across the table
+  size_t index(const uint64_t key) const {
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> (64 - log2_size_));
+  }
+
+  uint32_t log2_size_;
+  std::vector<entry_t> entries_;
+};
+
 /**
  * Class to access predicted speed information within a tile.
  */
@@ -90,6 +169,27 @@ public:
     return decompress_speed_bucket(coefficients, seconds_of_week / kSpeedBucketSizeSeconds);
   }
 
+  /**
+   * Get the speed given the edge Id and the seconds of the week, looking it up in the cache first
+   * and remembering it there if it had to be decoded.
+   * @param  idx  Directed edge index.
+   * @param  seconds_of_week  Seconds from start of the week (local time).
+   * @param  edge_id  The GraphId value of the directed edge, used as the cache key.
+   * @param  cache  The cache to use.
+   */
+  float speed(const uint32_t idx,
+              const uint32_t seconds_of_week,
+              const uint64_t edge_id,
+              PredictedSpeedCache& cache) const {
+    const uint32_t bucket = seconds_of_week / kSpeedBucketSizeSeconds;
+    float speed;
+    if (!cache.get(edge_id, bucket, speed)) {
+      speed = decompress_speed_bucket(profiles_ + offset_[idx], bucket);
+      cache.put(edge_id, bucket, speed);
+    }
+    return speed;
+  }
+
 protected:
   const uint32_t* offset_;  // Offset into the array of compressed speed profiles
                             // for each directed edge
@@ -1,6 +1,8 @@
 #ifndef VALHALLA_BALDR_RAPIDJSON_UTILS_H_
 #define VALHALLA_BALDR_RAPIDJSON_UTILS_H_
 
+#include <cmath>
+#include <cstdio>
 #include <fstream>
 #include <istream>
 #include <locale>
@@ -313,6 +315,29 @@ public:
     writer.SetMaxDecimalPlaces(precision);
   }
 
+  // numbers with exactly precision decimal places, trailing zeros and all, like json::fixed_t
+  inline void operator()(const char* key, const double value, const int precision) {
+    writer.String(key);
+    operator()(value, precision);
+  }
+
+  inline void operator()(const std::string& key, const double value, const int precision) {
+    writer.String(key);
+    operator()(value, precision);
+  }
+
+  inline void operator()(const double value, const int precision) {
+    char number[64];
+    const int length = std::snprintf(number, sizeof(number), "%.*f", precision, value);
+    if (length < 0 || length >= static_cast<int>(sizeof(number))) {
+      writer.Double(value);
+    } else if (std::isfinite(value)) {
+      writer.RawValue(number, length, rapidjson::kNumberType);
+    } else {
+      writer.String(number, length);
+    }
+  }
+
   inline void operator()(const char* key, const char* value) {
     writer.String(key);
     writer.String(value);
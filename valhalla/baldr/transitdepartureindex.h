@@ -0,0 +1,120 @@
+#ifndef VALHALLA_BALDR_TRANSITDEPARTUREINDEX_H_
+#define VALHALLA_BALDR_TRANSITDEPARTUREINDEX_H_
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <valhalla/baldr/transitdeparture.h>
+#include <valhalla/baldr/transitschedule.h>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * Lookup structure for the departures of a transit tile, built when the tile is loaded. The tile
+ * stores its departures sorted by line, then fixed before frequency based and then by departure
+ * time, each pointing at a schedule record elsewhere in the tile. Finding the next departure of a
+ * line meant a binary search over those 24 byte records, which assumed the times of a line only
+ * grow, followed by a walk that looked up the schedule of every candidate.
+ *
+ * Here each line is a range of a few parallel arrays in the same order as the tile's departures:
+ * the latest time each departure (or any earlier one on the line) can still be taken, which only
+ * grows so a single branchless binary search finds the first candidate, and a 16 byte record per
+ * departure with the service days, days of week, accessibility and times copied out of the
+ * departure and its schedule, so checking the candidates walks one contiguous array.
+ */
+class TransitDepartureIndex {
+public:
+  static constexpr uint32_t kNotFound = std::numeric_limits<uint32_t>::max();
+
+  TransitDepartureIndex() = default;
+
+  /**
+   * Builds the index
+   * @param departures      the tile's departures, sorted by line id
+   * @param count           the number of departures
+   * @param schedules       the tile's schedules
+   * @param schedule_count  the number of schedules
+   */
+  TransitDepartureIndex(const TransitDeparture* departures,
+                        uint32_t count,
+                        const TransitSchedule* schedules,
+                        uint32_t schedule_count);
+
+  /**
+   * Finds the next departure of a line at or after the current time, see
+   * GraphTile::GetNextDeparture for the meaning of the arguments
+   * @param departure_time  set to the time of the departure found, for frequency based departures
+   *                        this is the first trip at or after the current time
+   * @return the index of the departure within the tile or kNotFound
+   */
+  uint32_t Find(const uint32_t lineid,
+                const uint32_t current_time,
+                const uint32_t day,
+                const uint32_t dow,
+                bool date_before_tile,
+                bool wheelchair,
+                bool bicycle,
+                uint32_t& departure_time) const;
+
+  /**
+   * Finds the departure of a trip along a line at or after the current time, see
+   * GraphTile::GetTransitDeparture. The schedule is not checked since the trip was already taken
+   * @param departure_time  set to the time of the departure found
+   * @return the index of the departure within the tile or kNotFound
+   */
+  uint32_t FindTrip(const uint32_t lineid,
+                    const uint32_t tripid,
+                    const uint32_t current_time,
+                    uint32_t& departure_time) const;
+
+  /**
+   * @return the number of lines with departures
+   */
+  size_t lines() const {
+    return lines_.empty() ? 0 : lines_.size() - 1;
+  }
+
+protected:
+  struct line_t {
+    uint32_t lineid;
+    uint32_t begin; // the first of the line's departures, the next line has the last + 1
+  };
+
+  struct service_t {
+    uint64_t days;                 // days the departure runs relative to the tile creation date
+    uint32_t departure_time : 17;  // seconds from midnight, the first trip if frequency based
+    uint32_t end_day : 6;          // after this day only the days of the week apply
+    uint32_t days_of_week : 7;     // days of the week mask
+    uint32_t wheelchair : 1;       // wheelchair accessible
+    uint32_t bicycle : 1;          // bicycle accessible
+    uint32_t end_time : 17;        // no trips at or after this for frequency based departures
+    uint32_t frequency : 13;       // seconds between trips, 0 when fixed
+    uint32_t frequency_based : 1;  // frequency based rather than fixed
+    uint32_t spare : 1;
+  };
+  static_assert(sizeof(service_t) == 16, "Departure service records should stay compact");
+
+  // the range of departures of a line that could be taken at the current time
+  std::pair<uint32_t, uint32_t> Candidates(const uint32_t lineid, const uint32_t current_time) const;
+
+  // whether the departure leaves at or after the current time and when
+  static bool
+  Departs(const service_t& service, const uint32_t current_time, uint32_t& departure_time);
+
+  // sorted by line id with a sentinel at the end that marks the end of the last line
+  std::vector<line_t> lines_;
+  // per departure, the latest time it or any earlier departure of its line can be taken
+  std::vector<uint32_t> latest_;
+  // per departure, everything needed to decide whether it can be taken
+  std::vector<service_t> services_;
+  // per departure, the trip it is part of
+  std::vector<uint32_t> trips_;
+};
+
+} // namespace baldr
+} // namespace valhalla
+
+#endif // VALHALLA_BALDR_TRANSITDEPARTUREINDEX_H_
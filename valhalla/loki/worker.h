@@ -97,7 +97,7 @@ protected:
   float max_search_radius;
   unsigned int max_best_paths;
   size_t max_best_paths_shape;
-  skadi::sample sample;
+  std::shared_ptr<const skadi::sample> sample;
   size_t max_elevation_shape;
   float min_resample;
   unsigned int max_alternates;
@@ -0,0 +1,119 @@
+#ifndef VALHALLA_MIDGARD_PROFILING_H_
+#define VALHALLA_MIDGARD_PROFILING_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace valhalla {
+namespace midgard {
+
+namespace profiling {
+
+// the parts of a request we break its time down into
+enum class Stage : uint8_t {
+  kTileLoad,
+  kSearch,
+  kExpansion,
+  kPathFormation,
+  kTripLeg,
+  kNarrative,
+  kSerialization,
+  kCount
+};
+
+// the things we count along the way
+enum class Counter : uint8_t { kTileCacheHit, kTileCacheMiss, kCount };
+
+/**
+ * @return the name of the stage as it shows up in the statistics
+ */
+const char* to_string(Stage stage);
+
+/**
+ * @return the name of the counter as it shows up in the statistics
+ */
+const char* to_string(Counter counter);
+
+/**
+ * The timings and counts accumulated by the current thread since profiling was last started on it.
+ * Stage times are exclusive, time spent in a stage nested within another is only counted for the
+ * inner one, so loading tiles during an expansion doesnt make the expansion look slower.
+ */
+struct Profile {
+  bool enabled = false;
+  Stage current = Stage::kCount;
+  std::array<double, static_cast<size_t>(Stage::kCount)> elapsed_ms{};
+  std::array<uint64_t, static_cast<size_t>(Counter::kCount)> counts{};
+};
+
+/**
+ * @return the profile of the calling thread
+ */
+inline Profile& thread_profile() {
+  static thread_local Profile profile;
+  return profile;
+}
+
+/**
+ * Clears and enables profiling on the calling thread
+ * @return false if it was already enabled, in which case nothing was cleared
+ */
+bool start();
+
+/**
+ * Disables profiling on the calling thread, its results stay around until the next start
+ */
+void stop();
+
+/**
+ * Adds to a counter of the calling thread if profiling is enabled on it
+ */
+inline void count(Counter counter, uint64_t amount = 1) {
+  auto& profile = thread_profile();
+  if (profile.enabled) {
+    profile.counts[static_cast<size_t>(counter)] += amount;
+  }
+}
+
+/**
+ * Adds the time between its construction and destruction to a stage of the calling threads profile.
+ * When profiling isnt enabled it costs a thread local lookup and a branch.
+ */
+class ScopedTimer {
+public:
+  explicit ScopedTimer(Stage stage) : profile_(thread_profile()), stage_(stage) {
+    if (!profile_.enabled) {
+      return;
+    }
+    parent_ = profile_.current;
+    profile_.current = stage_;
+    start_ = std::chrono::steady_clock::now();
+  }
+  ~ScopedTimer() {
+    if (!profile_.enabled || profile_.current != stage_) {
+      return;
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_;
+    profile_.elapsed_ms[static_cast<size_t>(stage_)] += elapsed.count();
+    if (parent_ != Stage::kCount) {
+      profile_.elapsed_ms[static_cast<size_t>(parent_)] -= elapsed.count();
+    }
+    profile_.current = parent_;
+  }
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+protected:
+  Profile& profile_;
+  Stage stage_;
+  Stage parent_ = Stage::kCount;
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace profiling
+
+} // namespace midgard
+} // namespace valhalla
+
+#endif // VALHALLA_MIDGARD_PROFILING_H_
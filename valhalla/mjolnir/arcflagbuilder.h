@@ -0,0 +1,24 @@
+#ifndef VALHALLA_MJOLNIR_ARCFLAGBUILDER_H
+#define VALHALLA_MJOLNIR_ARCFLAGBUILDER_H
+
+#include <boost/property_tree/ptree.hpp>
+
+namespace valhalla {
+namespace mjolnir {
+
+/**
+ * Class used to flag the edges of the highway and arterial levels of the finished graph with the
+ * regions they are on shortest paths to and from, which bidirectional A* in thor can prune with.
+ */
+class ArcFlagBuilder {
+public:
+  /**
+   * Computes the arc flags of the auto costing and writes them to mjolnir.arc_flags_file.
+   */
+  static void Build(const boost::property_tree::ptree& pt);
+};
+
+} // namespace mjolnir
+} // namespace valhalla
+
+#endif // VALHALLA_MJOLNIR_ARCFLAGBUILDER_H
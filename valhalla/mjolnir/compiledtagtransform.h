@@ -0,0 +1,54 @@
+#ifndef VALHALLA_MJOLNIR_COMPILEDTAGTRANSFORM_H
+#define VALHALLA_MJOLNIR_COMPILEDTAGTRANSFORM_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <valhalla/mjolnir/osmdata.h>
+
+namespace valhalla {
+namespace mjolnir {
+
+using Tags = std::unordered_map<std::string, std::string>;
+
+/**
+ * A native implementation of the node, way and relation processing found in lua/graph.lua. The
+ * lookup tables from the lua (access, highway, foot_node, restriction etc) are declared as static
+ * rule tables and compiled into perfect hash tables when the object is constructed so that the
+ * per entity work is a handful of hash probes rather than a round trip through a lua_State.
+ *
+ * Objects hold no shared state, parsing threads should each construct their own.
+ */
+class CompiledTagTransform {
+public:
+  CompiledTagTransform();
+  ~CompiledTagTransform();
+
+  /**
+   * Transforms the tags the same way the nodes_proc/ways_proc/rels_proc functions of
+   * lua/graph.lua do.
+   * @param type    the OSM type
+   * @param osmid   the OSM id of the entity (used for error reporting)
+   * @param tags    the tags of the entity
+   * @return the transformed tags, empty if the entity should be filtered out
+   */
+  Tags Transform(OSMType type, uint64_t osmid, const Tags& tags) const;
+
+protected:
+  Tags TransformNode(const Tags& tags) const;
+  Tags TransformWay(uint64_t osmid, const Tags& tags) const;
+  Tags TransformRelation(const Tags& tags) const;
+
+  // see filter_tags_generic in lua/graph.lua, returns true if the way should be filtered out
+  bool FilterWay(Tags& kv) const;
+
+  struct rules_t;
+  std::unique_ptr<const rules_t> rules_;
+};
+
+} // namespace mjolnir
+} // namespace valhalla
+
+#endif // VALHALLA_MJOLNIR_COMPILEDTAGTRANSFORM_H
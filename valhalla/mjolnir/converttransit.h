@@ -0,0 +1,30 @@
+#ifndef VALHALLA_MJOLNIR_CONVERTTRANSIT_H
+#define VALHALLA_MJOLNIR_CONVERTTRANSIT_H
+
+#include <boost/property_tree/ptree.hpp>
+#include <unordered_set>
+
+#include <valhalla/baldr/graphid.h>
+
+namespace valhalla {
+namespace mjolnir {
+
+/**
+ * Class used to convert the fetched transit data into transit graph tiles.
+ */
+class ConvertTransit {
+public:
+  /**
+   * Convert the transit pbf tiles in mjolnir.transit_dir into transit level graph tiles written
+   * to mjolnir.tile_dir.
+   * @param pt   Property tree containing the hierarchy configuration
+   *             and other configuration needed to convert transit.
+   * @return the ids of the local level tiles that had transit pbf tiles
+   */
+  static std::unordered_set<baldr::GraphId> Build(const boost::property_tree::ptree& pt);
+};
+
+} // namespace mjolnir
+} // namespace valhalla
+
+#endif // VALHALLA_MJOLNIR_CONVERTTRANSIT_H
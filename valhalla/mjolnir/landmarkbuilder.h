@@ -0,0 +1,25 @@
+#ifndef VALHALLA_MJOLNIR_LANDMARKBUILDER_H
+#define VALHALLA_MJOLNIR_LANDMARKBUILDER_H
+
+#include <boost/property_tree/ptree.hpp>
+
+namespace valhalla {
+namespace mjolnir {
+
+/**
+ * Class used to pick landmarks in the finished graph and measure the distances between them and
+ * every node, which the A* heuristic in thor uses to bound the distance left to go.
+ */
+class LandmarkBuilder {
+public:
+  /**
+   * Measures mjolnir.landmark_count landmarks for the auto and pedestrian costings and writes them
+   * to mjolnir.landmark_file.
+   */
+  static void Build(const boost::property_tree::ptree& pt);
+};
+
+} // namespace mjolnir
+} // namespace valhalla
+
+#endif // VALHALLA_MJOLNIR_LANDMARKBUILDER_H
@@ -0,0 +1,24 @@
+#ifndef VALHALLA_MJOLNIR_PARTITIONBUILDER_H
+#define VALHALLA_MJOLNIR_PARTITIONBUILDER_H
+
+#include <boost/property_tree/ptree.hpp>
+
+namespace valhalla {
+namespace mjolnir {
+
+/**
+ * Class used to split the finished graph into the cells of a baldr::CellPartition, which the
+ * customizable overlay in thor is built on.
+ */
+class PartitionBuilder {
+public:
+  /**
+   * Finds the edges between cells in all the tiles and writes them to mjolnir.partition_file.
+   */
+  static void Build(const boost::property_tree::ptree& pt);
+};
+
+} // namespace mjolnir
+} // namespace valhalla
+
+#endif // VALHALLA_MJOLNIR_PARTITIONBUILDER_H
@@ -0,0 +1,99 @@
+#ifndef VALHALLA_MJOLNIR_TRAFFICBUILDER_H
+#define VALHALLA_MJOLNIR_TRAFFICBUILDER_H
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <unordered_map>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/baldr/traffictile.h>
+#include <valhalla/midgard/sequence.h>
+
+namespace valhalla {
+namespace mjolnir {
+
+/**
+ * Class used to create the live traffic extract that GraphReader maps from mjolnir.traffic_extract
+ */
+class TrafficBuilder {
+public:
+  /**
+   * Writes a traffic extract with one blank traffic tile for each graph tile, sized to the number
+   * of directed edges in the graph tile. The archive is written next to mjolnir.traffic_extract and
+   * moved over it once complete, processes that already mapped the old one keep using it until they
+   * are restarted.
+   * @param pt  the config, mjolnir.tile_dir or mjolnir.tile_extract name the tile set
+   * @return the number of traffic tiles written
+   */
+  static size_t Build(const boost::property_tree::ptree& pt);
+};
+
+/**
+ * Class used to change the speeds in an existing traffic extract in place. Every record is written
+ * with a single 64 bit store into the shared mapping of the archive, so processes reading the same
+ * extract see each edge either before or after an update and never halfway, without reloading
+ * anything.
+ */
+class TrafficUpdater {
+public:
+  /**
+   * Maps the traffic extract for writing
+   * @param traffic_extract  the path to the archive
+   */
+  explicit TrafficUpdater(const std::string& traffic_extract);
+
+  /**
+   * Sets the speed of an edge keeping its incident flag. Also marks the tile as updated now.
+   * @param edge_id  the directed edge
+   * @param speed    the new speeds, congestion and breakpoints of the edge
+   * @return false if the edge isnt in the extract
+   */
+  bool Update(const baldr::GraphId& edge_id, const baldr::TrafficSpeed& speed);
+
+  /**
+   * Applies updates read from csv lines of one of these forms:
+   *
+   *   edge_id,speed
+   *   edge_id,speed,congestion
+   *   edge_id,speed1,congestion1,breakpoint1,speed2,congestion2,breakpoint2,speed3,congestion3
+   *
+   * The edge_id is either the numeric GraphId value or level/tile_id/id. Speeds are in kph, an
+   * empty speed is unknown and 0 closes the edge (or subsegment). Congestion goes from 0 (free
+   * flow) to 1 (standstill, also a closure) and may be empty when unknown. Breakpoints are the
+   * fraction of the edge length where a subsegment ends. Lines that start with # and lines that
+   * cant be parsed are skipped. The stream is read until it ends so it can be a pipe from a live
+   * feed.
+   * @param csv  the lines to read
+   * @return the number of edges updated
+   */
+  size_t Update(std::istream& csv);
+
+  /**
+   * Parses a csv line as described above
+   * @param line     the csv line
+   * @param edge_id  the edge the speed is for
+   * @param speed    the parsed speed
+   * @return false if the line could not be parsed
+   */
+  static bool Parse(const std::string& line, baldr::GraphId& edge_id, baldr::TrafficSpeed& speed);
+
+  /**
+   * @return the number of traffic tiles in the extract
+   */
+  size_t size() const {
+    return tiles_.size();
+  }
+
+protected:
+  midgard::mem_map<char> memory_;
+  // where in the mapping each traffic tile starts
+  std::unordered_map<baldr::GraphId, size_t> tiles_;
+};
+
+} // namespace mjolnir
+} // namespace valhalla
+
+#endif // VALHALLA_MJOLNIR_TRAFFICBUILDER_H
@@ -38,7 +38,10 @@ enum class BuildStage : int8_t {
   kRestrictions = 12,
   kElevation = 13,
   kValidate = 14,
-  kCleanup = 15
+  kPartition = 15,
+  kLandmarks = 16,
+  kArcFlags = 17,
+  kCleanup = 18
 };
 
 // Convert string to BuildStage
@@ -59,6 +62,9 @@ inline BuildStage string_to_buildstage(const std::string& s) {
        {"restrictions", BuildStage::kRestrictions},
        {"elevation", BuildStage::kElevation},
        {"validate", BuildStage::kValidate},
+       {"partition", BuildStage::kPartition},
+       {"landmarks", BuildStage::kLandmarks},
+       {"arcflags", BuildStage::kArcFlags},
        {"cleanup", BuildStage::kCleanup}};
 
   auto i = stringToBuildStage.find(s);
@@ -83,6 +89,9 @@ inline std::string to_string(BuildStage stg) {
        {static_cast<int8_t>(BuildStage::kRestrictions), "restrictions"},
        {static_cast<int8_t>(BuildStage::kElevation), "elevation"},
        {static_cast<int8_t>(BuildStage::kValidate), "validate"},
+       {static_cast<int8_t>(BuildStage::kPartition), "partition"},
+       {static_cast<int8_t>(BuildStage::kLandmarks), "landmarks"},
+       {static_cast<int8_t>(BuildStage::kArcFlags), "arcflags"},
        {static_cast<int8_t>(BuildStage::kCleanup), "cleanup"}};
 
   auto i = BuildStageStrings.find(static_cast<int8_t>(stg));
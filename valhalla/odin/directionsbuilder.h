@@ -37,7 +37,7 @@ protected:
   static void UpdateHeading(EnhancedTripLeg* etp);
 
   /**
-   * Returns the trip directions based on the specified directions options,
+   * Populates the maneuvers of the trip directions based on the specified directions options,
    * trip path, and maneuver list.
    * @param options The directions options such as: units and
    *                           language.
@@ -50,6 +50,17 @@ protected:
                                     EnhancedTripLeg* etp,
                                     std::list<Maneuver>& maneuvers,
                                     DirectionsLeg& trip_directions);
+
+  /**
+   * Populates everything but the maneuvers of the trip directions (ids, locations, summary and
+   * shape) straight from the trip path, so it needs no enhanced trip path or maneuvers.
+   * @param options The directions options such as: units.
+   * @param trip_path The trip path - list of nodes, edges, attributes and shape.
+   * @param trip_directions The trip directions to populate.
+   */
+  static void PopulateDirectionsLegSummary(const Options& options,
+                                           const TripLeg& trip_path,
+                                           DirectionsLeg& trip_directions);
 };
 
 } // namespace odin
@@ -1,6 +1,8 @@
 #ifndef VALHALLA_ODIN_NARRATIVE_DICTIONARY_H_
 #define VALHALLA_ODIN_NARRATIVE_DICTIONARY_H_
 
+#include <array>
+#include <cstdint>
 #include <locale>
 #include <string>
 #include <unordered_map>
@@ -157,8 +159,117 @@ constexpr auto kTransitPlatformCountLabelTag = "<TRANSIT_STOP_COUNT_LABEL>";
 namespace valhalla {
 namespace odin {
 
+// The tags which are replaced with values when an instruction is formed from a phrase, in the
+// same order as the tag strings above
+enum class PhraseTag : uint8_t {
+  kCardinalDirection = 0,
+  kRelativeDirection,
+  kOrdinalValue,
+  kStreetNames,
+  kPreviousStreetNames,
+  kBeginStreetNames,
+  kCrossStreetNames,
+  kRoundaboutExitStreetNames,
+  kRoundaboutExitBeginStreetNames,
+  kRampExitNumbersVisual,
+  kLength,
+  kDestination,
+  kCurrentVerbalCue,
+  kNextVerbalCue,
+  kKilometers,
+  kMeters,
+  kMiles,
+  kTenthsOfMiles,
+  kFeet,
+  kNumberSign,
+  kBranchSign,
+  kTowardSign,
+  kNameSign,
+  kJunctionName,
+  kFerryLabel,
+  kTransitPlatform,
+  kStationLabel,
+  kTime,
+  kTransitName,
+  kTransitHeadSign,
+  kTransitPlatformCount,
+  kTransitPlatformCountLabel,
+  kCount
+};
+
+/**
+ * The values to replace the tags of a phrase with. Values are referenced rather than copied
+ * unless they are temporaries, so named values must outlive the forming of the instruction.
+ */
+class PhraseValues {
+public:
+  void Set(PhraseTag tag, const std::string& value) {
+    values_[static_cast<size_t>(tag)] = &value;
+  }
+
+  void Set(PhraseTag tag, std::string&& value) {
+    auto& owned = owned_[static_cast<size_t>(tag)];
+    owned = std::move(value);
+    values_[static_cast<size_t>(tag)] = &owned;
+  }
+
+  const std::string* Get(size_t tag) const {
+    return values_[tag];
+  }
+
+protected:
+  std::array<const std::string*, static_cast<size_t>(PhraseTag::kCount)> values_{};
+  std::array<std::string, static_cast<size_t>(PhraseTag::kCount)> owned_;
+};
+
+/**
+ * A localized phrase which is split up at its tags when the dictionary is loaded so that an
+ * instruction can be formed in a single pass over the phrase rather than a search and replace
+ * of the whole instruction for every tag.
+ */
+class PhraseTemplate {
+public:
+  PhraseTemplate() = default;
+
+  /**
+   * Splits up the phrase at the tags it contains.
+   *
+   * @param  phrase  The tagged phrase, ie: "Turn <RELATIVE_DIRECTION> onto <STREET_NAMES>."
+   */
+  explicit PhraseTemplate(const std::string& phrase);
+
+  /**
+   * Forms an instruction from the phrase by replacing its tags with the specified values. Tags
+   * without a value are left in the instruction as they are in the phrase.
+   *
+   * @param  instruction  The instruction to form, its previous contents are replaced.
+   * @param  values  The values to replace the tags with.
+   */
+  void Form(std::string& instruction, const PhraseValues& values) const;
+
+  /**
+   * Returns the tagged phrase.
+   */
+  const std::string& phrase() const {
+    return phrase_;
+  }
+
+protected:
+  // A run of literal text or a tag within the phrase
+  struct Segment {
+    uint32_t offset;
+    uint32_t length;
+    uint8_t tag; // PhraseTag::kCount for literal text
+  };
+
+  std::string phrase_;
+  std::vector<Segment> segments_;
+};
+
 struct PhraseSet {
   std::unordered_map<std::string, std::string> phrases;
+  // The phrases split up at their tags, keyed by phrase id
+  std::unordered_map<uint8_t, PhraseTemplate> templates;
 };
 
 struct StartSubset : PhraseSet {
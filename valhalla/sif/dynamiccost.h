@@ -872,6 +872,9 @@ protected:
   // A mask which determines which flow data the costing should use from the tile
   uint8_t flow_mask_;
 
+  // Predicted speeds already decoded for this request, costings are per request so this is too
+  mutable baldr::PredictedSpeedCache predicted_speed_cache_;
+
   // Whether or not to do shortest (by length) routes
   // Note: hierarchy pruning means some costings (auto, truck, etc) won't do absolute shortest
   bool shortest_;
@@ -1072,6 +1075,15 @@ struct BaseCostingOptionsConfig {
   ranged_default_t<float> closure_factor_;
 };
 
+/**
+ * The value of an option that was already set in the pbf (ie. by a protobuf request) or else the
+ * default. The parsers use this as the fallback for options missing from the json so that the
+ * options of protobuf requests are validated and clamped the same way as json ones.
+ */
+#define PBF_OR_DEFAULT(pbf_costing_options, option_name, default_value)                           \
+  ((pbf_costing_options)->has_##option_name() ? (pbf_costing_options)->option_name()              \
+                                              : (default_value))
+
 /**
  * Parses the cost options from json and stores values in pbf.
  * @param object The json request represented as a DOM tree.
@@ -1124,6 +1136,14 @@ void ParseCostingOptions(const rapidjson::Document& doc,
                          CostingOptions* costing_options,
                          Costing costing = static_cast<Costing>(Costing_ARRAYSIZE));
 
+/**
+ * The costing options of a request that gives none of them and has no date_time, which leaves out
+ * the speeds that depend on the time like the request would
+ * @param costing  the costing to get the options of
+ * @return its default options
+ */
+CostingOptions DefaultCostingOptions(const Costing costing);
+
 } // namespace sif
 
 } // namespace valhalla
@@ -25,8 +25,12 @@ public:
   /**
    * Constructor
    * @param data_source  directory name of the datasource from which to sample
+   * @param cache_size   maximum number of bytes of decompressed tiles to keep in memory
    */
-  sample(const std::string& data_source);
+  sample(const std::string& data_source, size_t cache_size = kDefaultCacheSize);
+
+  // by default keep enough decompressed tiles around to cross a couple of tile boundaries
+  static const size_t kDefaultCacheSize;
 
   /**
    * Get a single sample from the datasource
@@ -45,6 +49,35 @@ public:
    */
   static double get_no_data_value();
 
+  struct cache_stats_t {
+    uint64_t hits;
+    uint64_t misses;
+    size_t tiles;
+    size_t bytes;
+  };
+  /**
+   * @return the hit/miss counts and current usage of the decompressed tile cache
+   */
+  cache_stats_t cache_stats() const;
+
+  /**
+   * Reads the pixels of a raw (.hgt) or gzipped (.hgt.gz) tile
+   * @param file_name  the file to read
+   * @param pixels     the pixels of the tile, in hgt (big endian) byte order
+   * @return true if the file was a complete tile
+   */
+  static bool load_tile(const std::string& file_name, std::vector<int16_t>& pixels);
+
+  /**
+   * Writes a tile in the seekable block compressed (.hgt.blk) format. The tile is cut into
+   * fixed size square blocks which are compressed independently so that sampling a few postings
+   * only needs to inflate the blocks they touch rather than the whole tile
+   * @param file_name  the file to write
+   * @param pixels     the pixels of the tile, in hgt (big endian) byte order
+   * @return true if the file was written
+   */
+  static bool store_blocks(const std::string& file_name, const std::vector<int16_t>& pixels);
+
 protected:
   /**
    * @return A tile index value from a coordinate
@@ -57,28 +90,67 @@ protected:
   static std::string get_hgt_file_name(uint16_t index);
 
   /**
+   * A view of the pixels of a tile. For compressed tiles it shares ownership of the decompressed
+   * pixels so that they stay valid even if the tile is evicted from the cache while in use.
+   */
+  class tile_data {
+  public:
+    tile_data() : data(nullptr) {
+    }
+    tile_data(const int16_t* data, std::shared_ptr<const std::vector<int16_t>> unzipped = {})
+        : data(data), unzipped(std::move(unzipped)) {
+    }
+    const int16_t* get() const {
+      return data;
+    }
+    explicit operator bool() const {
+      return data != nullptr;
+    }
+
+  protected:
+    const int16_t* data;
+    std::shared_ptr<const std::vector<int16_t>> unzipped;
+  };
+
+  enum class format_t { UNKNOWN = 0, GZIP = 1, BLOCKS = 2, RAW = 3 };
+
+  // a memory mapped tile, it is never changed once it is published
+  struct mapped_t;
+
+  /**
+   * Finds the mapped tile, lazily mapping raw tiles which were not there at start up. Lookups are
+   * a single atomic load of the tile's slot so concurrent requests never wait on each other
    * @param  index  the index of the data tile being requested
-   * @return the array of data or nullptr if there was none
+   * @return the mapped tile or nullptr if there is none
    */
-  const int16_t* source(uint16_t index) const;
+  const mapped_t* mapped_tile(uint16_t index) const;
 
-  enum class format_t { UNKNOWN = 0, GZIP = 1, RAW = 3 };
   /**
-   * maps a new source, used at start up and called periodically
-   * for lazily loaded sources
-   *
-   * @param  index  the index of the data tile being mapped
-   * @param  format the format of the data tile being mapped
-   * @param  file   the file name of the data tile being mapped
+   * @param  index  the index of the data tile being requested
+   * @param  tile   the tile mapped_tile found for it
+   * @return the array of data or an empty tile_data if there was none
    */
-  void map(uint16_t index, format_t format, const std::string& file);
+  tile_data source(uint16_t index, const mapped_t* tile) const;
+
+  /**
+   * @param  index  the index of the block compressed data tile being requested
+   * @param  tile   the mapped block compressed tile
+   * @param  block  the row major index of the block within the tile
+   * @return the pixels of the block or an empty tile_data if there were none
+   */
+  tile_data block(uint16_t index, const mapped_t& tile, uint32_t block) const;
+
+  // reads pixels of block compressed tiles through block()
+  struct block_pixels_t;
 
-  // using memory maps
-  mutable std::vector<std::pair<format_t, midgard::mem_map<char>>> mapped_cache;
+  // one slot per tile holding an atomic pointer to its mapping, tiles found at start up are
+  // published by the constructor and raw tiles which show up later by the first lookup to see them
+  struct tiles_t;
+  std::shared_ptr<tiles_t> mapped_tiles;
 
-  // TODO: make an LRU
-  using unzipped_t = std::pair<int16_t, std::vector<int16_t>>;
-  mutable unzipped_t unzipped_cache;
+  // thread safe byte bounded lru of decompressed tiles
+  struct cache_t;
+  std::shared_ptr<cache_t> unzipped_cache;
 
   std::string data_source;
 };
@@ -1,6 +1,11 @@
 #ifndef VALHALLA_THOR_ASTARHEURISTIC_H_
 #define VALHALLA_THOR_ASTARHEURISTIC_H_
 
+#include <algorithm>
+#include <vector>
+
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/baldr/landmarks.h>
 #include <valhalla/midgard/distanceapproximator.h>
 #include <valhalla/midgard/pointll.h>
 #include <valhalla/midgard/util.h>
@@ -10,14 +15,17 @@ namespace thor {
 
 /**
  * Class to calculate A* cost heuristics based on distances of nodes from
- * a destination within the shortest path computation.
+ * a destination within the shortest path computation. The distance is the
+ * great circle distance unless landmarks are set, then it is the larger of
+ * it and the network distance the landmarks bound from below (ALT).
  */
 class AStarHeuristic {
 public:
   /**
    * Constructor.
    */
-  AStarHeuristic() : distapprox_({}), costfactor_(1.0f) {
+  AStarHeuristic()
+      : distapprox_({}), costfactor_(1.0f), landmarks_(nullptr), table_(0), forward_(true) {
   }
 
   /**
@@ -33,8 +41,31 @@ public:
   void Init(const midgard::PointLL& ll, const float factor) {
     distapprox_.SetTestPoint(ll);
     costfactor_ = factor;
+    landmarks_ = nullptr;
   }
 
+  /**
+   * Also bounds the distance to the destination with landmarks, for the nodes that have landmark
+   * distances. Call it after Init.
+   * @param  landmarks  Landmarks with a table for the costing.
+   * @param  table      Index of the table of the costing.
+   * @param  targets    Nodes one of which every path to the destination goes through, or every
+   *                    path from the origin for a reverse search.
+   * @param  forward    True if the search goes to the targets, false if it comes from them.
+   * @return Returns false if the targets have no landmark distances, the landmarks are not used.
+   */
+  bool InitLandmarks(const baldr::Landmarks& landmarks,
+                     const uint32_t table,
+                     const std::vector<baldr::GraphId>& targets,
+                     const bool forward);
+
+  /**
+   * Get the network distance to the destination the landmarks bound from below.
+   * @param   node  Node to get the distance from.
+   * @return  Returns the distance (meters) or 0 if there are no landmarks for the node.
+   */
+  float GetLandmarkDistance(const baldr::GraphId& node) const;
+
   /**
    * Get the distance to the destination given the lat,lng.
    * @param   ll  Current latitude, longitude.
@@ -77,10 +108,44 @@ public:
     return dist * costfactor_;
   }
 
+  /**
+   * Get the A* heuristic of a node given its distance to the destination,
+   * strengthened with the landmarks if there are any.
+   * @param   node      Node.
+   * @param   distance  Distance (meters) to the destination.
+   * @return  Returns an estimate of the cost to the destination.
+   *          For A* shortest path this MUST UNDERESTIMATE the true cost.
+   */
+  float Get(const baldr::GraphId& node, const float distance) const {
+    return (landmarks_ ? std::max(distance, GetLandmarkDistance(node)) : distance) * costfactor_;
+  }
+
+  /**
+   * Get the A* heuristic of a node given its lat,lng, strengthened with the
+   * landmarks if there are any. Also return the great circle distance via an
+   * argument.
+   * @param   node  Node.
+   * @param   ll    Lat,lng of the node.
+   * @param   dist  Distance (meters) to the destination.
+   * @return  Returns an estimate of the cost to the destination.
+   *          For A* shortest path this MUST UNDERESTIMATE the true cost.
+   */
+  float Get(const baldr::GraphId& node, const midgard::PointLL& ll, float& dist) const {
+    dist = sqrtf(distapprox_.DistanceSquared(ll));
+    return Get(node, dist);
+  }
+
 private:
   midgard::DistanceApproximator<midgard::PointLL> distapprox_; // Distance approximation
   float costfactor_; // Cost factor - ensures the cost estimate
                      // underestimates the true cost.
+
+  const baldr::Landmarks* landmarks_; // Landmarks, nullptr if not used
+  uint32_t table_;                    // Table of the costing in the landmarks
+  bool forward_;                      // Whether the search goes to the targets
+  // Per landmark the distances of the targets that bound the distances of
+  // the nodes, kUnreachable if they cant be used
+  std::vector<baldr::Landmarks::distance_t> bounds_;
 };
 
 } // namespace thor
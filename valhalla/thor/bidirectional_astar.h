@@ -5,9 +5,11 @@
 #include <map>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include <valhalla/baldr/arcflags.h>
 #include <valhalla/baldr/double_bucket_queue.h>
 #include <valhalla/baldr/time_info.h>
 #include <valhalla/proto/api.pb.h>
@@ -15,11 +17,15 @@
 #include <valhalla/sif/hierarchylimits.h>
 #include <valhalla/thor/astarheuristic.h>
 #include <valhalla/thor/edgestatus.h>
+#include <valhalla/thor/overlay.h>
 #include <valhalla/thor/pathalgorithm.h>
 
 namespace valhalla {
 namespace thor {
 
+// The distance in meters around the origin and destination whose regions the arc flags target
+constexpr float kDefaultArcFlagsTargetRadius = 10000.0f;
+
 /**
  * Candidate connections - a directed edge and its opposing directed edge
  * are both temporarily labeled. Store the edge Ids and its cost.
@@ -84,6 +90,35 @@ public:
    */
   void Clear() override;
 
+  /**
+   * Sets the overlay to jump across cells with, routes without a date time on their first pass
+   * use it when it has a metric for their costing
+   * @param overlay  the overlay or nullptr to always expand the whole graph
+   */
+  void set_overlay(const std::shared_ptr<overlay_t>& overlay) {
+    overlay_ = overlay;
+  }
+
+  /**
+   * Sets the landmarks that strengthen the A* heuristic, routes use them when they have a table
+   * for their costing and their options dont ignore access or oneways
+   * @param landmarks  the landmarks or nullptr to only use the great circle distance
+   */
+  void set_landmarks(const std::shared_ptr<const baldr::Landmarks>& landmarks) {
+    landmarks_ = landmarks;
+  }
+
+  /**
+   * Sets the arc flags that prune the highway and arterial edges which dont lead towards the other
+   * end of the route. They are built with the default options of their costing, so the first pass
+   * of the routes that are not time dependent and use exactly those options prunes with them
+   * @param arc_flags      the arc flags or nullptr to expand every edge
+   * @param target_radius  meters around the origin and destination whose regions the edges have to
+   *                       be flagged for
+   */
+  void set_arc_flags(const std::shared_ptr<const baldr::ArcFlags>& arc_flags,
+                     const float target_radius = kDefaultArcFlagsTargetRadius);
+
 protected:
   // Access mode used by the costing method
   uint32_t access_mode_;
@@ -133,6 +168,26 @@ protected:
   // edge)
   bool pruning_disabled_at_origin_, pruning_disabled_at_destination_;
 
+  // The overlay, the metric of the current route when it uses the overlay and the cells around
+  // the origin and destination which are expanded rather than jumped across. The labels a jump
+  // made last are kept with the label it jumped from, to tell them apart from expanded ones
+  std::shared_ptr<overlay_t> overlay_;
+  std::shared_ptr<const overlay_t::metric_t> metric_;
+  std::vector<uint32_t> endpoint_cells_;
+  std::unordered_map<uint32_t, uint32_t> jumps_forward_;
+  std::unordered_map<uint32_t, uint32_t> jumps_reverse_;
+
+  // Landmark distances for the A* heuristics
+  std::shared_ptr<const baldr::Landmarks> landmarks_;
+
+  // Arc flags and the regions the edges of the current route have to lead to going forward and
+  // come from going in reverse, when it prunes with them
+  std::shared_ptr<const baldr::ArcFlags> arc_flags_;
+  std::string arc_flags_costing_options_;
+  float arc_flags_target_radius_;
+  bool arc_flag_pruning_;
+  baldr::ArcFlags::flags_t origin_regions_, destination_regions_;
+
   /**
    * Initialize the A* heuristic and adjacency lists for both the forward
    * and reverse search.
@@ -181,6 +236,66 @@ protected:
                           uint32_t& shortcuts,
                           const graph_tile_ptr& tile,
                           const baldr::TimeInfo& time_info);
+  /**
+   * Bounds the distances the A* heuristics estimate with the landmarks, if they can be used
+   * @param graphreader  to access graph data
+   * @param origin       the origin of the route
+   * @param destination  the destination of the route
+   * @param options      the request options, the landmarks need a table for their costing
+   */
+  void InitLandmarks(baldr::GraphReader& graphreader,
+                     const valhalla::Location& origin,
+                     const valhalla::Location& destination,
+                     const Options& options);
+
+  /**
+   * Picks the regions around the origin and destination the arc flags prune towards, if they can
+   * be used
+   * @param graphreader     to access graph data
+   * @param origin          the origin of the route
+   * @param destination     the destination of the route
+   * @param options         the request options, the arc flags are for one costing
+   * @param time_dependent  whether the route has a time, the flags dont
+   */
+  void InitArcFlags(baldr::GraphReader& graphreader,
+                    const valhalla::Location& origin,
+                    const valhalla::Location& destination,
+                    const Options& options,
+                    const bool time_dependent);
+
+  /**
+   * Jumps across the cell the predecessor enters in the forward search or leaves in the reverse
+   * search, labeling the edges on the far side of the cell with the costs of the metric
+   * @param graphreader  to access graph data
+   * @param pred         the settled edge label
+   * @param pred_idx     the index of the label in the label set
+   * @return false if the label has to be expanded normally, because there is no metric, the
+   *         cell is around the origin or destination or a complex restriction is on one of the
+   *         ways through it
+   */
+  template <const ExpansionType expansion_direction>
+  bool JumpCell(baldr::GraphReader& graphreader,
+                const sif::BDEdgeLabel& pred,
+                const uint32_t pred_idx);
+
+  /**
+   * Finds the cells of the nodes of the edges at the origin and destination
+   */
+  void SetEndpointCells(baldr::GraphReader& graphreader,
+                        const valhalla::Location& origin,
+                        const valhalla::Location& dest);
+
+  /**
+   * Replaces the jumps across cells in a path with the edges inside the cells
+   * @param graphreader  to access graph data
+   * @param path_edges   the edges of the path, from origin to destination
+   * @param jumped       the edges of the path that entered a cell which was jumped across
+   * @return false if a jump could not be unpacked
+   */
+  bool UnpackCells(baldr::GraphReader& graphreader,
+                   std::vector<baldr::GraphId>& path_edges,
+                   const std::unordered_set<baldr::GraphId>& jumped) const;
+
   /**
    * Add edges at the origin to the forward adjacency list.
    * @param graphreader  Graph tile reader.
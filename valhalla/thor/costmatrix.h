@@ -11,6 +11,7 @@
 #include <valhalla/baldr/double_bucket_queue.h>
 #include <valhalla/baldr/graphid.h>
 #include <valhalla/baldr/graphreader.h>
+#include <valhalla/baldr/time_info.h>
 #include <valhalla/proto/tripcommon.pb.h>
 #include <valhalla/sif/dynamiccost.h>
 #include <valhalla/sif/edgelabel.h>
@@ -103,6 +104,7 @@ public:
    * @param  mode_costing          Costing methods.
    * @param  mode                  Travel mode to use.
    * @param  max_matrix_distance   Maximum arc-length distance for current mode.
+   * @param  invariant             Static date_time, dont offset the time as the paths lengthen.
    * @return time/distance from origin index to all other locations
    */
   std::vector<TimeDistance>
@@ -111,7 +113,8 @@ public:
                  baldr::GraphReader& graphreader,
                  const sif::mode_costing_t& mode_costing,
                  const sif::TravelMode mode,
-                 const float max_matrix_distance);
+                 const float max_matrix_distance,
+                 const bool invariant = false);
 
   /**
    * Clear the temporary information generated during time+distance
@@ -159,6 +162,16 @@ protected:
   // List of best connections found so far
   std::vector<BestCandidate> best_connection_;
 
+  // The departure time at each source and the arrival time at each target. These are invalid
+  // unless the matrix is time dependent, in which case the searches offset them by the time
+  // elapsed to each node to get the time of day at which to cost the edges leaving it
+  std::vector<baldr::TimeInfo> source_time_info_;
+  std::vector<baldr::TimeInfo> target_time_info_;
+  bool invariant_;
+
+  // Cache of timezone offsets for when the searches cross timezones
+  baldr::DateTime::tz_sys_info_cache_t tz_cache_;
+
   /**
    * Get the cost threshold based on the current mode and the max arc-length distance
    * for that mode.
@@ -206,6 +219,19 @@ protected:
    */
   void BackwardSearch(const uint32_t index, baldr::GraphReader& graphreader);
 
+  /**
+   * Sets the departure time at the sources and the arrival time at the targets. Times are only
+   * known on one side, a depart_at matrix has them on the sources and an arrive_by matrix on the
+   * targets. The other side gets an approximate time from the nearest location that has one,
+   * offset by how long it would take to cover the straight line distance between them.
+   * @param  graphreader   Graph reader for accessing routing graph.
+   * @param  sources       List of source/origin locations.
+   * @param  targets       List of target locations.
+   */
+  void SetTimeInfo(baldr::GraphReader& graphreader,
+                   const google::protobuf::RepeatedPtrField<valhalla::Location>& sources,
+                   const google::protobuf::RepeatedPtrField<valhalla::Location>& targets);
+
   /**
    * Sets the source/origin locations. Search expands forward from these
    * locations.
@@ -0,0 +1,173 @@
+#ifndef VALHALLA_THOR_OVERLAY_H_
+#define VALHALLA_THOR_OVERLAY_H_
+
+#include <boost/property_tree/ptree.hpp>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <valhalla/baldr/cellpartition.h>
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/baldr/graphreader.h>
+#include <valhalla/proto/options.pb.h>
+#include <valhalla/sif/costconstants.h>
+#include <valhalla/sif/dynamiccost.h>
+
+namespace valhalla {
+namespace thor {
+
+/**
+ * The customizable overlay over a baldr::CellPartition. A metric holds, for one set of costing
+ * options, the cost of getting through every cell from each of the edges entering it to each of
+ * the edges leaving it. With it a search only has to expand the cells around its origin and
+ * destination and can jump across all the others. Metrics are only customized for the costings
+ * configured in thor.overlay.costings. The first request with a new set of costing options starts
+ * customizing its metric in the background, with the cells spread over threads, and it is kept for
+ * the requests that follow with the same options once it is done.
+ */
+class overlay_t {
+public:
+  // The costs of getting through the cells of the partition for one set of costing options
+  class metric_t {
+  public:
+    /**
+     * The cost from the end of an entry of a cell to the start of one of its exits, including the
+     * transition onto the exit. Its cost is kUnreachable if the exit cant be reached from the entry
+     * @param cell   the index of the cell in the partition
+     * @param entry  the number of the entry within the cell
+     * @param exit   the number of the exit within the cell
+     */
+    const sif::Cost& through(const uint32_t cell, const uint32_t entry, const uint32_t exit) const {
+      return through_[offsets_[cell] + static_cast<uint64_t>(entry) * exit_counts_[cell] + exit];
+    }
+
+    /**
+     * The cost of an edge entering a cell
+     */
+    const sif::Cost& entry_cost(const uint32_t cell, const uint32_t entry) const {
+      return entry_costs_[entry_offsets_[cell] + entry];
+    }
+
+    /**
+     * The cost of an edge leaving a cell
+     */
+    const sif::Cost& exit_cost(const uint32_t cell, const uint32_t exit) const {
+      return exit_costs_[exit_offsets_[cell] + exit];
+    }
+
+    /**
+     * Whether a complex restriction starts or ends on the way through a cell from an entry to an
+     * exit, the entry and exit included. Checking one takes the edges before and after the cell,
+     * which a jump doesnt have, so the way has to be expanded rather than jumped
+     * @param cell   the index of the cell in the partition
+     * @param entry  the number of the entry within the cell
+     * @param exit   the number of the exit within the cell
+     */
+    bool restricted(const uint32_t cell, const uint32_t entry, const uint32_t exit) const {
+      return restricted_[offsets_[cell] + static_cast<uint64_t>(entry) * exit_counts_[cell] + exit];
+    }
+
+  protected:
+    friend class overlay_t;
+
+    std::vector<uint64_t> offsets_;
+    std::vector<uint32_t> exit_counts_;
+    std::vector<uint32_t> entry_offsets_;
+    std::vector<uint32_t> exit_offsets_;
+    std::vector<sif::Cost> through_;
+    std::vector<sif::Cost> entry_costs_;
+    std::vector<sif::Cost> exit_costs_;
+    std::vector<uint8_t> restricted_;
+  };
+
+  static constexpr float kUnreachable = std::numeric_limits<float>::max();
+
+  /**
+   * Loads the partition, throws if it cant be read
+   * @param config  the whole service config, the partition is read from mjolnir.partition_file and
+   *                the rest of the settings come from thor.overlay
+   */
+  explicit overlay_t(const boost::property_tree::ptree& config);
+
+  /**
+   * Waits for the metric being customized, if any
+   */
+  ~overlay_t();
+
+  /**
+   * Returns the one overlay for this process or nullptr if mjolnir.partition_file isnt configured
+   * or cant be loaded
+   * @param config  the whole service config, only the first call configures the overlay
+   */
+  static std::shared_ptr<overlay_t> get_instance(const boost::property_tree::ptree& config);
+
+  /**
+   * @return the partition the metrics are for
+   */
+  const baldr::CellPartition& partition() const {
+    return partition_;
+  }
+
+  /**
+   * Returns the metric for the costing options of a request. If there is none yet its customization
+   * is started in the background, unless another metric is already being customized, and the
+   * request has to do without it.
+   * @param options  the request options, the metric is for the options of their costing
+   * @return the metric or nullptr if it isnt ready or the options cant use one, for example when
+   *         their costing isnt configured or they exclude edges
+   */
+  std::shared_ptr<const metric_t> GetMetric(const Options& options);
+
+  /**
+   * Finds the edges inside a cell that a jump from one of its entries to one of its exits takes
+   * @param reader   graph reader
+   * @param costing  the costing of the metric the jump was made with
+   * @param cell     the index of the cell
+   * @param entry    the edge entering the cell
+   * @param exit     the edge leaving the cell
+   * @param edges    the edges from the end of the entry to the start of the exit are appended
+   * @return false if the exit cant be reached from the entry
+   */
+  bool Unpack(baldr::GraphReader& reader,
+              const std::shared_ptr<sif::DynamicCost>& costing,
+              const uint32_t cell,
+              const baldr::GraphId& entry,
+              const baldr::GraphId& exit,
+              std::vector<baldr::GraphId>& edges) const;
+
+protected:
+  std::string make_key(const Options& options) const;
+  std::shared_ptr<const metric_t> Customize(const CostingOptions& costing_options) const;
+  void evict();
+
+  // metrics that failed to customize are kept as nullptr so they arent tried over and over
+  struct entry_t {
+    std::shared_ptr<const metric_t> metric;
+    std::chrono::steady_clock::time_point expires;
+    std::list<std::string>::iterator position;
+  };
+
+  boost::property_tree::ptree mjolnir_config_;
+  baldr::CellPartition partition_;
+  size_t max_metrics_;
+  std::chrono::seconds ttl_;
+  uint32_t concurrency_;
+  std::unordered_set<std::string> costings_;
+
+  mutable std::mutex mutex_;
+  std::list<std::string> recency_;
+  std::unordered_map<std::string, entry_t> metrics_;
+  std::future<void> customizing_;
+};
+
+} // namespace thor
+} // namespace valhalla
+
+#endif // VALHALLA_THOR_OVERLAY_H_
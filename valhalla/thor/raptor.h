@@ -0,0 +1,236 @@
+#ifndef VALHALLA_THOR_RAPTOR_H_
+#define VALHALLA_THOR_RAPTOR_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <valhalla/baldr/double_bucket_queue.h>
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/baldr/graphreader.h>
+#include <valhalla/proto/tripcommon.pb.h>
+#include <valhalla/sif/dynamiccost.h>
+#include <valhalla/sif/edgelabel.h>
+#include <valhalla/thor/edgestatus.h>
+#include <valhalla/thor/pathalgorithm.h>
+#include <valhalla/thor/pathinfo.h>
+
+namespace valhalla {
+namespace thor {
+
+/**
+ * Round based public transit routing (RAPTOR). Rather than one Dijkstra over the combined walking
+ * and transit graph, round k finds the earliest arrival at every transit stop using at most k
+ * trips. Each round boards the next departure of every line leaving the stops improved in the
+ * previous round, rides each trip to the end, and then walks from the stops the rides improved to
+ * the stops within the maximum transfer distance. Walking to the first stops and from the last
+ * ones uses the pedestrian costing.
+ *
+ * Every round that arrives at the destination earlier than the rounds before it gives a journey
+ * with one more trip, so the results are Pareto optimal in arrival time and number of transfers.
+ * The earliest arrival is returned first and the journeys with fewer transfers follow it as
+ * alternates.
+ */
+class RaptorPathAlgorithm : public PathAlgorithm {
+public:
+  /**
+   * Constructor.
+   * @param config A config object of key, value pairs
+   */
+  explicit RaptorPathAlgorithm(const boost::property_tree::ptree& config = {});
+
+  /**
+   * Form transit journeys between an origin and destination location, the origin must have its
+   * date_time set.
+   * @param  origin        Origin location
+   * @param  dest          Destination location
+   * @param  graphreader   Graph reader for accessing routing graph.
+   * @param  mode_costing  An array of costing methods, one per TravelMode.
+   * @param  mode          Travel mode from the origin.
+   * @param  options       The request options, alternates sets how many journeys with fewer
+   *                       transfers to return after the earliest arrival
+   * @return Returns the path edges of each journey (and elapsed time/modes at the end of each
+   *         edge), the earliest arrival first.
+   */
+  std::vector<std::vector<PathInfo>>
+  GetBestPath(valhalla::Location& origin,
+              valhalla::Location& dest,
+              baldr::GraphReader& graphreader,
+              const sif::mode_costing_t& mode_costing,
+              const sif::TravelMode mode,
+              const Options& options = Options::default_instance()) override;
+
+  /**
+   * Returns the name of the algorithm
+   * @return the name of the algorithm
+   */
+  virtual const char* name() const override {
+    return "Raptor";
+  }
+
+  /**
+   * Clear the temporary information generated during path construction.
+   */
+  void Clear() override;
+
+protected:
+  // How a stop was reached in a round
+  enum class reached_t : uint8_t { kWalk, kRide };
+  struct stop_label_t {
+    uint32_t arrival; // seconds from midnight
+    reached_t how;
+    uint32_t index; // the last walk label into the stop or the ride
+    uint32_t count; // the number of the ride's edges up to the stop
+  };
+
+  // A trip boarded at a stop, its edges are the next ones in ride_edges_
+  struct ride_t {
+    baldr::GraphId board_stop;
+    uint32_t tripid;
+    uint32_t first_edge;
+  };
+  struct ride_edge_t {
+    baldr::GraphId edgeid;
+    uint32_t arrival; // seconds from midnight at the end of the edge
+  };
+
+  // A way to the destination with a given number of trips
+  struct journey_t {
+    uint32_t round;
+    baldr::GraphId stop; // invalid when walking all the way
+    uint32_t arrival;
+    uint32_t walk_index; // the last walk label when walking all the way
+  };
+
+  using stop_labels_t = std::unordered_map<uint64_t, stop_label_t>;
+
+  uint32_t max_rounds_;
+  uint32_t max_reserved_labels_count_;
+  uint32_t max_transfer_distance_;
+
+  // the day the transit tiles are relative to, set from the first stop
+  bool date_set_;
+  bool date_before_tile_;
+  uint32_t day_;
+  uint32_t dow_;
+  uint32_t start_time_;
+  std::string origin_date_time_;
+  std::unordered_set<uint32_t> processed_tiles_;
+
+  // the labels of every stop that improved in each round
+  std::vector<stop_labels_t> rounds_;
+  // the earliest arrival at each stop over all the rounds so far
+  std::unordered_map<uint64_t, uint32_t> best_arrival_;
+  std::vector<ride_t> rides_;
+  std::vector<ride_edge_t> ride_edges_;
+
+  // Walking labels of all the walks, the stop each walk started from and the state of the current
+  // walk. Walks to the stops and between them start at the time of day they leave and cost seconds
+  // since the start of the route, walks from the stops to the destination start at 0
+  std::vector<sif::EdgeLabel> walk_labels_;
+  std::vector<baldr::GraphId> walk_sources_;
+  baldr::DoubleBucketQueue<sif::EdgeLabel> adjacencylist_;
+  EdgeStatus edgestatus_;
+
+  // destination edges and the cost of the part of them past the destination
+  std::unordered_map<uint64_t, sif::Cost> destinations_;
+  // the walk label that reached each stop walking back from the destination
+  std::unordered_map<uint64_t, uint32_t> egress_;
+
+  /**
+   * Walks from the labels already in the queue until it is empty
+   * @param graphreader  Graph reader
+   * @param pc           Pedestrian costing
+   * @param max_distance Maximum walking distance from where each label's walk started
+   * @param settled      Called with the index of each label as it is settled and its end node,
+   *                     which can be null when its tile is missing
+   */
+  void Walk(baldr::GraphReader& graphreader,
+            const std::shared_ptr<sif::DynamicCost>& pc,
+            const uint32_t max_distance,
+            const std::function<void(uint32_t, const baldr::NodeInfo*)>& settled);
+
+  /**
+   * Adds the edges that can be walked from a node to the queue
+   * @param graphreader  Graph reader
+   * @param node         The node to walk from
+   * @param pred         The label of the edge arriving at the node
+   * @param pred_idx     Its index in the walk labels, kInvalidLabel for the first edges of a walk
+   * @param source       The stop the walk started from, invalid when it didnt start at a stop
+   * @param pc           Pedestrian costing
+   * @param max_distance Maximum walking distance
+   * @param from_transition True if this is called from a transition edge
+   */
+  void ExpandWalk(baldr::GraphReader& graphreader,
+                  const baldr::GraphId& node,
+                  const sif::EdgeLabel& pred,
+                  const uint32_t pred_idx,
+                  const baldr::GraphId& source,
+                  const std::shared_ptr<sif::DynamicCost>& pc,
+                  const uint32_t max_distance,
+                  const bool from_transition);
+
+  /**
+   * Rides every trip that can be boarded at the stops marked in the previous round and labels the
+   * stops they arrive at in this one
+   * @param graphreader  Graph reader
+   * @param tc           Transit costing
+   * @param round        The round, at least 1
+   * @param marked       The stops improved in the previous round
+   * @param best_dest    The earliest arrival at the destination so far, for pruning
+   * @return the stops improved by riding
+   */
+  std::vector<baldr::GraphId> Ride(baldr::GraphReader& graphreader,
+                                   const std::shared_ptr<sif::DynamicCost>& tc,
+                                   const uint32_t round,
+                                   const std::vector<baldr::GraphId>& marked,
+                                   const uint32_t best_dest);
+
+  /**
+   * Walks from the stops improved by riding to the stops within the maximum transfer distance
+   * @param graphreader  Graph reader
+   * @param pc           Pedestrian costing
+   * @param round        The round
+   * @param improved     The stops improved by riding, stops improved by walking are added
+   * @param best_dest    The earliest arrival at the destination so far, for pruning
+   */
+  void Transfer(baldr::GraphReader& graphreader,
+                const std::shared_ptr<sif::DynamicCost>& pc,
+                const uint32_t round,
+                std::vector<baldr::GraphId>& improved,
+                const uint32_t best_dest);
+
+  /**
+   * Labels a stop in a round if it improves on the earliest arrival there
+   * @return true if the stop was improved
+   */
+  bool Improve(const uint32_t round,
+               const baldr::GraphId& stop,
+               const stop_label_t& label,
+               const uint32_t best_dest);
+
+  /**
+   * Sets the day of the transit schedules from the tile of the first stop
+   */
+  void SetDate(const baldr::graph_tile_ptr& tile);
+
+  /**
+   * Forms the path of a journey, walking to the first stop, riding and transferring from round
+   * to round and walking from the last stop to the destination
+   */
+  std::vector<PathInfo> FormPath(baldr::GraphReader& graphreader, const journey_t& journey);
+
+  /**
+   * Adds the path of a walk ending at the given label, returns the stop it started from
+   */
+  baldr::GraphId FormWalk(const uint32_t walk_index, std::vector<PathInfo>& path) const;
+};
+
+} // namespace thor
+} // namespace valhalla
+
+#endif // VALHALLA_THOR_RAPTOR_H_
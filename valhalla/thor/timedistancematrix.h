@@ -11,6 +11,7 @@
 #include <valhalla/baldr/double_bucket_queue.h>
 #include <valhalla/baldr/graphid.h>
 #include <valhalla/baldr/graphreader.h>
+#include <valhalla/baldr/time_info.h>
 #include <valhalla/sif/dynamiccost.h>
 #include <valhalla/sif/edgelabel.h>
 #include <valhalla/thor/astarheuristic.h>
@@ -40,6 +41,7 @@ public:
    * @param  mode_costing  Costing methods.
    * @param  mode          Travel mode to use.
    * @param  max_matrix_distance   Maximum arc-length distance for current mode.
+   * @param  invariant     Static date_time, dont offset the time as the path lengthens.
    * @return time/distance from origin index to all other locations
    */
   std::vector<TimeDistance>
@@ -48,7 +50,8 @@ public:
             baldr::GraphReader& graphreader,
             const sif::mode_costing_t& mode_costing,
             const sif::TravelMode mode,
-            const float max_matrix_distance);
+            const float max_matrix_distance,
+            const bool invariant = false);
 
   /**
    * Many to one time and distance cost matrix. Computes time and distance
@@ -59,6 +62,7 @@ public:
    * @param  mode_costing  Costing methods.
    * @param  mode          Travel mode to use.
    * @param  max_matrix_distance   Maximum arc-length distance for current mode.
+   * @param  invariant     Static date_time, dont offset the time as the path lengthens.
    * @return time/distance to the destination index from all other locations
    */
   std::vector<TimeDistance>
@@ -67,7 +71,8 @@ public:
             baldr::GraphReader& graphreader,
             const sif::mode_costing_t& mode_costing,
             const sif::TravelMode mode,
-            const float max_matrix_distance);
+            const float max_matrix_distance,
+            const bool invariant = false);
 
   /**
    * Many to many time and distance cost matrix. Computes time and distance
@@ -88,13 +93,17 @@ public:
 
   /**
    * Forms a time distance matrix from the set of source locations
-   * to the set of target locations.
+   * to the set of target locations. When the sources have a departure time
+   * the searches go forward from each of them and when the targets have an
+   * arrival time they go backward from each target, so that every edge is
+   * costed at the time of day it is reached.
    * @param  source_location_list  List of source/origin locations.
    * @param  target_location_list  List of target/destination locations.
    * @param  graphreader           Graph reader for accessing routing graph.
    * @param  mode_costing          Costing methods.
    * @param  mode                  Travel mode to use.
    * @param  max_matrix_distance   Maximum arc-length distance for current mode.
+   * @param  invariant             Static date_time, dont offset the time as the paths lengthen.
    * @return time/distance from origin index to all other locations
    */
   std::vector<TimeDistance>
@@ -103,7 +112,8 @@ public:
                  baldr::GraphReader& graphreader,
                  const sif::mode_costing_t& mode_costing,
                  const sif::TravelMode mode,
-                 const float max_matrix_distance);
+                 const float max_matrix_distance,
+                 const bool invariant = false);
 
   /**
    * Clear the temporary information generated during time+distance
@@ -142,6 +152,21 @@ protected:
 
   sif::TravelMode mode_;
 
+  // The departure time at the origin (or arrival time at the destination of a many to one search)
+  // which is invalid unless the matrix is time dependent
+  baldr::TimeInfo time_info_;
+  bool invariant_;
+
+  // Cache of timezone offsets for when the search crosses timezones
+  baldr::DateTime::tz_sys_info_cache_t tz_cache_;
+
+  /**
+   * Sets the time at the location the search starts from.
+   * @param  graphreader   Graph reader for accessing routing graph.
+   * @param  location      The origin of a one to many or destination of a many to one search.
+   */
+  void SetTimeInfo(baldr::GraphReader& graphreader, const valhalla::Location& location);
+
   /**
    * Expand from the node along the forward search path. Immediately expands
    * from the end node of any transition edge (so no transition edges are added
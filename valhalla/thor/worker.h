@@ -1,11 +1,17 @@
 #ifndef __VALHALLA_THOR_SERVICE_H__
 #define __VALHALLA_THOR_SERVICE_H__
 
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <tuple>
 #include <vector>
 
 #include <boost/property_tree/ptree.hpp>
+#include <valhalla/admission_control.h>
 
 #include <valhalla/baldr/directededge.h>
 #include <valhalla/baldr/graphid.h>
@@ -24,6 +30,7 @@
 #include <valhalla/thor/centroid.h>
 #include <valhalla/thor/isochrone.h>
 #include <valhalla/thor/multimodal.h>
+#include <valhalla/thor/raptor.h>
 #include <valhalla/thor/triplegbuilder.h>
 #include <valhalla/thor/unidirectional_astar.h>
 #include <valhalla/tyr/actor.h>
@@ -89,7 +96,21 @@ protected:
   std::vector<std::tuple<float, float, std::vector<meili::MatchResult>>> map_match(Api& request);
 
   void path_arrive_by(Api& api, const std::string& costing);
-  void path_depart_at(Api& api, const std::string& costing);
+  void path_depart_at(Api& api, const std::string& costing, bool allow_retry = true);
+
+  /**
+   * Computes the legs between the break locations of a route on several threads at once, each
+   * leg with the path algorithms and costing of a helper from the leg pool. Legs are
+   * first computed from an estimate of their origin (its departure time for time dependent
+   * routes) and then checked in order against the destination of the leg before them. Any leg
+   * whose estimate was off is computed again, so the result is the same as path_depart_at's
+   *
+   * @param api      the request, the legs are added to its trip like path_depart_at does
+   * @param costing  the costing of the request
+   * @return false if the request cant be split up or no route was found for one of the legs, in
+   *         which case the caller should fall back to path_depart_at
+   */
+  bool path_depart_at_parallel(Api& api, const std::string& costing);
 
   void parse_locations(Api& request);
   void parse_measurements(const Api& request);
@@ -119,6 +140,7 @@ protected:
   BidirectionalAStar bidir_astar;
   AStarBSSAlgorithm bss_astar;
   MultiModalPathAlgorithm multi_modal_astar;
+  RaptorPathAlgorithm raptor;
   TimeDepForward timedep_forward;
   TimeDepReverse timedep_reverse;
 
@@ -127,11 +149,59 @@ protected:
   float max_timedep_distance;
   std::unordered_map<std::string, float> max_matrix_distance;
   SOURCE_TO_TARGET_ALGORITHM source_to_target_algorithm;
+  // whether transit routes use raptor rather than the multimodal astar
+  bool raptor_transit;
   meili::MapMatcherFactory matcher_factory;
   std::shared_ptr<baldr::GraphReader> reader;
   AttributesController controller;
   Centroid centroid_gen;
 
+  /**
+   * A fixed set of helper threads that compute the legs of a route together with the worker that
+   * owns them. Each helper has a worker of its own for the path algorithms and costing but they
+   * all use the graph reader, and so the tile cache, of the owning worker
+   */
+  class leg_pool_t {
+  public:
+    leg_pool_t(const boost::property_tree::ptree& config,
+               const std::shared_ptr<baldr::GraphReader>& reader,
+               size_t size);
+    ~leg_pool_t();
+
+    /**
+     * Runs the job on some of the helpers and the calling thread at the same time and returns
+     * once all of them are done with it. The job must not throw
+     *
+     * @param job     what to run, it is given the worker of the thread that runs it
+     * @param caller  the worker of the calling thread
+     * @param count   how many of the helpers should run the job
+     */
+    void run(const std::function<void(thor_worker_t&)>& job, thor_worker_t& caller, size_t count);
+
+    void cleanup();
+
+  protected:
+    void serve(size_t index);
+
+    std::vector<std::unique_ptr<thor_worker_t>> workers;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable started;
+    std::condition_variable finished;
+    const std::function<void(thor_worker_t&)>* job;
+    size_t job_count;  // how many helpers run the current job
+    size_t job_number; // counts up with every job so helpers know when there is a new one
+    size_t running;    // how many helpers still run the current job
+    bool stopping;
+  };
+
+  // helpers to compute the legs of a route concurrently, created on first use
+  boost::property_tree::ptree config;
+  size_t leg_concurrency;
+  std::unique_ptr<leg_pool_t> leg_pool;
+  // limits how many requests of each action the process works on at once, null when unlimited
+  std::shared_ptr<admission_control_t> admission;
+
 private:
   std::string service_name() const override {
     return "thor";
@@ -0,0 +1,75 @@
+#ifndef VALHALLA_TYR_PIPELINE_H_
+#define VALHALLA_TYR_PIPELINE_H_
+
+#include <boost/property_tree/ptree.hpp>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+#include <valhalla/admission_control.h>
+#include <valhalla/baldr/graphreader.h>
+#include <valhalla/loki/worker.h>
+#include <valhalla/odin/worker.h>
+#include <valhalla/proto/api.pb.h>
+#include <valhalla/thor/worker.h>
+#include <valhalla/tyr/response_cache.h>
+#include <valhalla/worker.h>
+
+namespace valhalla {
+namespace tyr {
+
+#ifdef HAVE_HTTP
+/**
+ * Runs a worker which answers http requests by running every stage of the pipeline in the same
+ * thread. It pulls from the loki proxy and always replies to the loopback directly.
+ * @param config  the service config
+ */
+void run_service(const boost::property_tree::ptree& config);
+#endif
+
+/**
+ * A worker which owns a loki, thor and odin worker sharing one graph reader and drives a request
+ * through all of them in a single call to work(). This is what actor_t does for library users but
+ * exposed to prime_server so that single node deployments dont have to serialize the request to
+ * protobuf and bounce it through two extra proxies for every stage.
+ */
+class pipeline_worker_t : public service_worker_t {
+public:
+  pipeline_worker_t(const boost::property_tree::ptree& config,
+                    const std::shared_ptr<baldr::GraphReader>& graph_reader = {});
+#ifdef HAVE_HTTP
+  virtual prime_server::worker_t::result_t work(const std::list<zmq::message_t>& job,
+                                                void* request_info,
+                                                const std::function<void()>& interrupt) override;
+#endif
+  virtual void cleanup() override;
+
+  virtual void set_interrupt(const std::function<void()>* interrupt) override;
+
+protected:
+  std::string service_name() const override {
+    return "pipeline";
+  }
+
+  /**
+   * Answers the request from the response cache if there is one, otherwise just computes it
+   * @param request  the parsed request, hits and misses are added to its statistics
+   * @param compute  runs the stages to produce the response
+   * @return the response
+   */
+  std::string cached(Api& request, const std::function<std::string()>& compute);
+
+  std::shared_ptr<baldr::GraphReader> reader;
+  loki::loki_worker_t loki_worker;
+  thor::thor_worker_t thor_worker;
+  odin::odin_worker_t odin_worker;
+  std::shared_ptr<response_cache_t> cache;
+  std::shared_ptr<admission_control_t> admission;
+  std::unordered_set<Options::Action> actions;
+  std::string action_str;
+};
+
+} // namespace tyr
+} // namespace valhalla
+
+#endif // VALHALLA_TYR_PIPELINE_H_
@@ -0,0 +1,99 @@
+#ifndef VALHALLA_TYR_RESPONSE_CACHE_H_
+#define VALHALLA_TYR_RESPONSE_CACHE_H_
+
+#include <boost/property_tree/ptree.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <valhalla/baldr/graphreader.h>
+#include <valhalla/proto/api.pb.h>
+
+namespace valhalla {
+namespace tyr {
+
+/**
+ * A process wide cache of serialized responses keyed on the parsed request options along with the
+ * version of the tiles and, when live traffic is in use, the current traffic epoch. Identical
+ * requests arriving while the first one is still being computed wait for its result rather than
+ * computing it again. Entries expire after a ttl and the least recently used are evicted to stay
+ * under a byte limit.
+ */
+class response_cache_t {
+public:
+  /**
+   * @param config  the whole service config, the limits are read from tyr.response_cache
+   * @param reader  used to find the dataset id of the tiles
+   */
+  response_cache_t(const boost::property_tree::ptree& config, baldr::GraphReader& reader);
+
+  /**
+   * Returns the one cache for this process or nullptr if tyr.response_cache.max_bytes is 0
+   * @param config  the whole service config, only the first call configures the cache
+   * @param reader  used to find the dataset id of the tiles
+   */
+  static std::shared_ptr<response_cache_t> get_instance(const boost::property_tree::ptree& config,
+                                                        baldr::GraphReader& reader);
+
+  /**
+   * Whether responses for this action are cached
+   * @param action  the requests action
+   */
+  static bool cacheable(Options::Action action);
+
+  /**
+   * Returns the cached response for the request or computes, caches and returns it. If the same
+   * request is being computed by someone else we wait for and return their result. Should their
+   * computation fail (or be interrupted) or take longer than tyr.response_cache.max_wait_ms we
+   * compute it ourselves without caching it.
+   *
+   * @param request    the request, only the options are looked at and they should be as parsed
+   * @param compute    produces the response for the request, any exception it throws propagates
+   * @param hit        set to true if the response came from the cache or another request
+   * @param interrupt  called periodically while waiting on another request, throws to stop waiting
+   * @return the response
+   */
+  std::string get(const Api& request,
+                  const std::function<std::string()>& compute,
+                  bool& hit,
+                  const std::function<void()>* interrupt = nullptr);
+
+  /**
+   * @return the number of bytes of keys and responses currently in the cache
+   */
+  size_t size() const;
+
+protected:
+  std::string make_key(const Options& options) const;
+  void evict();
+
+  struct entry_t {
+    std::shared_future<std::string> response;
+    std::chrono::steady_clock::time_point expires;
+    size_t bytes;
+    bool ready;
+    std::list<std::string>::iterator position;
+  };
+
+  size_t max_bytes_;
+  std::chrono::seconds ttl_;
+  std::chrono::milliseconds max_wait_;
+  uint32_t traffic_epoch_seconds_;
+  uint64_t dataset_id_;
+
+  mutable std::mutex mutex_;
+  size_t bytes_;
+  std::list<std::string> recency_;
+  std::unordered_map<std::string, entry_t> entries_;
+};
+
+} // namespace tyr
+} // namespace valhalla
+
+#endif // VALHALLA_TYR_RESPONSE_CACHE_H_
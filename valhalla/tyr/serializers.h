@@ -30,7 +30,7 @@ std::string serializeDirections(Api& request);
 /**
  * Turn a time distance matrix into json that one can look up location pair results from
  */
-std::string serializeMatrix(const Api& request,
+std::string serializeMatrix(Api& request,
                             const std::vector<thor::TimeDistance>& time_distances,
                             double distance_scale);
 
@@ -40,7 +40,7 @@ std::string serializeMatrix(const Api& request,
  * @param grid_contours    the contours generated from the grid
  * @param colors           the #ABC123 hex string color used in geojson fill color
  */
-std::string serializeIsochrones(const Api& request,
+std::string serializeIsochrones(Api& request,
                                 std::vector<midgard::GriddedData<2>::contour_interval_t>& intervals,
                                 midgard::GriddedData<2>::contours_t& contours,
                                 bool polygons = true,
@@ -91,10 +91,18 @@ std::string serializeTransitAvailable(const Api& request,
  * @param results     The vector of trip paths and match results for each match found
  */
 std::string serializeTraceAttributes(
-    const Api& request,
+    Api& request,
     const thor::AttributesController& controller,
     std::vector<std::tuple<float, float, std::vector<meili::MatchResult>>>& results);
 
+/**
+ * Serialize the whole Api, minus the statistics, for requests with the pbf format. The results of
+ * the action must already have been filled out in the request
+ * @param request  the proto request with the results attached
+ * @return the serialized protobuf
+ */
+std::string serializePbf(Api& request);
+
 /**
  * Turn proto with status information into json
  * @param request  the proto request with status info attached
@@ -119,24 +127,34 @@ namespace osrm {
  * Serialize a location into a osrm waypoint
  * http://project-osrm.org/docs/v5.5.1/api/#waypoint-object
  */
-valhalla::baldr::json::MapPtr
+void waypoint(const valhalla::Location& location,
+              rapidjson::writer_wrapper_t& writer,
+              bool is_tracepoint = false,
+              bool is_optimized = false);
+valhalla::baldr::json::RawJSON
 waypoint(const valhalla::Location& location, bool is_tracepoint = false, bool is_optimized = false);
 
-valhalla::baldr::json::MapPtr serialize_via_waypoint(valhalla::Location& location,
-                                                     const uint64_t geometry_idx,
-                                                     double distance_from_leg_start);
+void serialize_via_waypoint(const valhalla::Location& location,
+                            const uint64_t geometry_idx,
+                            double distance_from_leg_start,
+                            rapidjson::writer_wrapper_t& writer);
 
 /*
- * Serialize locations into osrm waypoints
+ * Stream locations as osrm waypoints into the currently open array of the writer
  */
-valhalla::baldr::json::ArrayPtr
-waypoints(const google::protobuf::RepeatedPtrField<valhalla::Location>& locations,
-          bool tracepoints = false);
-valhalla::baldr::json::ArrayPtr waypoints(const valhalla::Trip& locations);
-valhalla::baldr::json::ArrayPtr via_waypoints(valhalla::Options options,
-                                              const std::vector<PointLL>& shape);
-
-void serializeIncidentProperties(rapidjson::Writer<rapidjson::StringBuffer>& writer,
+void waypoints(const google::protobuf::RepeatedPtrField<valhalla::Location>& locations,
+               rapidjson::writer_wrapper_t& writer,
+               bool tracepoints = false);
+void waypoints(const valhalla::Trip& trip, rapidjson::writer_wrapper_t& writer);
+
+/*
+ * Stream the via waypoints found along the leg shape into the currently open array of the writer
+ */
+void via_waypoints(valhalla::Options options,
+                   const std::vector<PointLL>& shape,
+                   rapidjson::writer_wrapper_t& writer);
+
+void serializeIncidentProperties(rapidjson::writer_wrapper_t& writer,
                                  const valhalla::IncidentsTile::Metadata& incident_metadata,
                                  const int begin_shape_index,
                                  const int end_shape_index,
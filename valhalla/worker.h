@@ -65,6 +65,7 @@ const content_type JSON_MIME{"Content-type", "application/json;charset=utf-8"};
 const content_type JS_MIME{"Content-type", "application/javascript;charset=utf-8"};
 const content_type XML_MIME{"Content-type", "text/xml;charset=utf-8"};
 const content_type GPX_MIME{"Content-type", "application/gpx+xml;charset=utf-8"};
+const content_type PBF_MIME{"Content-type", "application/x-protobuf"};
 } // namespace worker
 
 prime_server::worker_t::result_t
@@ -127,7 +128,9 @@ protected:
 
   /**
    * Used to measure the time it takes to do an action in the current stage of the pipeline.
-   * This should be called at the top of the scope in each major action of each worker
+   * This should be called at the top of the scope in each major action of each worker. For the
+   * sampled fraction of requests (statsd.stage_sample_rate) it also breaks the time down by stage,
+   * see midgard/profiling.h
    *
    * @param api  The request object where we store the timing information
    * @return an object whose destructor records the elapsed time since construction as a stat
@@ -141,6 +144,7 @@ protected:
 
   const std::function<void()>* interrupt;
   std::unique_ptr<statsd_client_t> statsd_client;
+  float stage_sample_rate;
 };
 } // namespace valhalla
 